@@ -0,0 +1,79 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include <functional>
+
+#include "command.h"
+#include "datatype.h"
+#include "image_io/fetch_store.h"
+
+#include "benchmark/harness.h"
+
+using namespace MR;
+using namespace App;
+
+void usage ()
+{
+  AUTHOR = "J-Donald Tournier (jdtournier@gmail.com)";
+
+  SYNOPSIS = "Benchmark raw datatype conversion bandwidth";
+
+  DESCRIPTION
+  + "Times the fetch & store conversion functions used to read & write "
+    "voxel values from memory-mapped files, for a range of on-disk "
+    "datatypes, using both the per-value functions and their batched "
+    "scanline equivalents. "
+    "Results are written to standard output as JSON, one object per line.";
+}
+
+
+void run ()
+{
+  const size_t count = 1 << 20;
+  vector<uint8_t> raw (count * sizeof (double), 0);
+  vector<float> values (count, 0.0f);
+
+  const DataType datatypes[] = { DataType::UInt8, DataType::Int16LE, DataType::Int16BE,
+                                 DataType::Float32LE, DataType::Float32BE, DataType::Float64LE };
+  for (const DataType& datatype : datatypes) {
+
+    std::function<float(const void*,size_t,default_type,default_type)> fetch;
+    std::function<void(float,void*,size_t,default_type,default_type)> store;
+    __set_fetch_store_functions<float> (fetch, store, datatype);
+
+    std::function<void(float*,const void*,size_t,size_t,default_type,default_type)> fetch_scanline;
+    std::function<void(const float*,void*,size_t,size_t,default_type,default_type)> store_scanline;
+    __set_fetch_store_scanline_functions<float> (fetch_scanline, store_scanline, datatype);
+
+    const std::string suffix (datatype.specifier());
+
+    Benchmark::run ("fetch_" + suffix, count, [&] {
+        for (size_t n = 0; n != count; ++n)
+          values[n] = fetch (raw.data(), n, 0.0, 1.0);
+      });
+
+    Benchmark::run ("store_" + suffix, count, [&] {
+        for (size_t n = 0; n != count; ++n)
+          store (values[n], raw.data(), n, 0.0, 1.0);
+      });
+
+    Benchmark::run ("fetch_scanline_" + suffix, count, [&] {
+        fetch_scanline (values.data(), raw.data(), 0, count, 0.0, 1.0);
+      });
+
+    Benchmark::run ("store_scanline_" + suffix, count, [&] {
+        store_scanline (values.data(), raw.data(), 0, count, 0.0, 1.0);
+      });
+  }
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "command.h"
+#include "header.h"
+#include "image.h"
+#include "algo/loop.h"
+#include "interp/cubic.h"
+#include "interp/linear.h"
+#include "math/rng.h"
+
+#include "benchmark/harness.h"
+
+using namespace MR;
+using namespace App;
+
+void usage ()
+{
+  AUTHOR = "J-Donald Tournier (jdtournier@gmail.com)";
+
+  SYNOPSIS = "Benchmark interpolation throughput";
+
+  DESCRIPTION
+  + "Times cubic and linear interpolation of a random scratch image at "
+    "random in-bounds voxel positions, reporting samples per second. "
+    "Results are written to standard output as JSON, one object per line.";
+
+  OPTIONS
+  + Option ("size", "dimensions of the scratch image (default: 64)")
+  +   Argument ("value").type_integer (8);
+}
+
+
+void run ()
+{
+  const int dim = get_option_value ("size", 64);
+
+  Header header;
+  header.ndim() = 3;
+  for (size_t n = 0; n < 3; ++n) {
+    header.size(n) = dim;
+    header.spacing(n) = 1.0f;
+  }
+  header.datatype() = DataType::Float32;
+  auto image = Image<float>::scratch (header, "benchmark scratch");
+
+  Math::RNG rng;
+  std::normal_distribution<float> normal;
+  for (auto l = Loop (image) (image); l; ++l)
+    image.value() = normal (rng);
+
+  const size_t nsamples = 1 << 20;
+  std::uniform_real_distribution<double> uniform (2.0, dim - 3.0);
+  vector<Eigen::Vector3d> positions (nsamples);
+  for (size_t n = 0; n != nsamples; ++n)
+    positions[n] = Eigen::Vector3d (uniform (rng), uniform (rng), uniform (rng));
+
+  double sum = 0.0;
+
+  Interp::Cubic<Image<float>> cubic (image);
+  Benchmark::run ("cubic_interp", nsamples, [&] {
+      for (size_t n = 0; n != nsamples; ++n) {
+        if (cubic.voxel (positions[n]))
+          sum += cubic.value();
+      }
+    });
+
+  Interp::Linear<Image<float>> linear (image);
+  Benchmark::run ("linear_interp", nsamples, [&] {
+      for (size_t n = 0; n != nsamples; ++n) {
+        if (linear.voxel (positions[n]))
+          sum += linear.value();
+      }
+    });
+
+  // Referencing the accumulated sum prevents the sampling loops from
+  //   being optimised away entirely
+  if (!std::isfinite (sum))
+    WARN ("non-finite interpolated values encountered");
+}
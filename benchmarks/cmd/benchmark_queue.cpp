@@ -0,0 +1,68 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "command.h"
+#include "thread_queue.h"
+
+#include "benchmark/harness.h"
+
+using namespace MR;
+using namespace App;
+
+void usage ()
+{
+  AUTHOR = "J-Donald Tournier (jdtournier@gmail.com)";
+
+  SYNOPSIS = "Benchmark Thread::Queue item throughput";
+
+  DESCRIPTION
+  + "Passes trivial items through a single-producer, multi-consumer "
+    "run_queue pipeline, with and without item batching, so the figures "
+    "reported reflect queue synchronisation overhead per item. "
+    "Results are written to standard output as JSON, one object per line.";
+
+  OPTIONS
+  + Option ("count", "number of items to pass per run (default: 4194304)")
+  +   Argument ("value").type_integer (1);
+}
+
+
+void run ()
+{
+  const size_t count = get_option_value ("count", 4194304);
+
+  auto sink = [] (const size_t& /*in*/) { return true; };
+
+  Benchmark::run ("queue_unbatched", count, [&] {
+      size_t n = 0;
+      auto source = [&] (size_t& out) {
+        if (n == count)
+          return false;
+        out = n++;
+        return true;
+      };
+      Thread::run_queue (source, size_t(), Thread::multi (sink));
+    });
+
+  Benchmark::run ("queue_batched", count, [&] {
+      size_t n = 0;
+      auto source = [&] (size_t& out) {
+        if (n == count)
+          return false;
+        out = n++;
+        return true;
+      };
+      Thread::run_queue (source, Thread::batch (size_t()), Thread::multi (sink));
+    });
+}
@@ -0,0 +1,87 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "command.h"
+#include "math/math.h"
+#include "math/rng.h"
+#include "math/SH.h"
+
+#include "benchmark/harness.h"
+
+using namespace MR;
+using namespace App;
+
+void usage ()
+{
+  AUTHOR = "J-Donald Tournier (jdtournier@gmail.com)";
+
+  SYNOPSIS = "Benchmark Math::SH::Transform throughput";
+
+  DESCRIPTION
+  + "Times the spherical harmonic forward (SH2A) and inverse (A2SH) "
+    "transforms over a batch of synthetic voxels, both as a single "
+    "matrix-matrix product over the whole batch and one voxel at a time. "
+    "Results are written to standard output as JSON, one object per line.";
+
+  OPTIONS
+  + Option ("lmax", "maximum spherical harmonic order (default: 8)")
+  +   Argument ("order").type_integer (0, 30)
+
+  + Option ("directions", "number of directions (default: 300)")
+  +   Argument ("number").type_integer (6);
+}
+
+
+void run ()
+{
+  const int lmax = get_option_value ("lmax", 8);
+  const int ndirs = get_option_value ("directions", 300);
+  const size_t nvoxels = 4096;
+
+  Math::RNG rng;
+  std::uniform_real_distribution<double> uniform;
+  Eigen::MatrixXd dirs (ndirs, 2);
+  for (int n = 0; n != ndirs; ++n) {
+    dirs(n,0) = 2.0 * Math::pi * uniform (rng);
+    dirs(n,1) = std::acos (2.0 * uniform (rng) - 1.0);
+  }
+  Math::SH::Transform<double> sht (dirs, lmax);
+
+  const size_t nSH = Math::SH::NforL (lmax);
+  Eigen::MatrixXd sh = Eigen::MatrixXd::Random (nSH, nvoxels);
+  Eigen::MatrixXd amplitudes (ndirs, nvoxels);
+  Eigen::MatrixXd sh_out (nSH, nvoxels);
+
+  Benchmark::run ("SH2A_batch", nvoxels, [&] {
+      sht.SH2A (amplitudes, sh);
+    });
+
+  Benchmark::run ("A2SH_batch", nvoxels, [&] {
+      sht.A2SH (sh_out, amplitudes);
+    });
+
+  Benchmark::run ("SH2A_per_voxel", nvoxels, [&] {
+      for (size_t n = 0; n != nvoxels; ++n) {
+        auto a = amplitudes.col (n);
+        sht.SH2A (a, sh.col (n));
+      }
+    });
+
+  Benchmark::run ("A2SH_per_voxel", nvoxels, [&] {
+      for (size_t n = 0; n != nvoxels; ++n) {
+        auto s = sh_out.col (n);
+        sht.A2SH (s, amplitudes.col (n));
+      }
+    });
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "command.h"
+#include "header.h"
+#include "image.h"
+#include "algo/loop.h"
+#include "algo/threaded_loop.h"
+
+#include "benchmark/harness.h"
+
+using namespace MR;
+using namespace App;
+
+void usage ()
+{
+  AUTHOR = "J-Donald Tournier (jdtournier@gmail.com)";
+
+  SYNOPSIS = "Benchmark ThreadedLoop dispatch overhead";
+
+  DESCRIPTION
+  + "Times loops with a trivial per-voxel body over a scratch image, so that "
+    "the figures reported predominantly reflect loop dispatch and thread "
+    "synchronisation costs rather than useful work. A single-threaded Loop "
+    "over the same image is included for reference. Results are written to "
+    "standard output as JSON, one object per line.";
+
+  OPTIONS
+  + Option ("size", "dimensions of the scratch image (default: 256)")
+  +   Argument ("value").type_integer (1);
+}
+
+
+void run ()
+{
+  const int dim = get_option_value ("size", 256);
+
+  Header header;
+  header.ndim() = 3;
+  for (size_t n = 0; n < 3; ++n) {
+    header.size(n) = dim;
+    header.spacing(n) = 1.0f;
+  }
+  header.datatype() = DataType::Float32;
+  auto image = Image<float>::scratch (header, "benchmark scratch");
+  const size_t voxels = voxel_count (image);
+
+  Benchmark::run ("threaded_loop_increment", voxels, [&] {
+      ThreadedLoop (image).run ([] (Image<float>& v) { v.value() += 1.0f; }, image);
+    });
+
+  Benchmark::run ("loop_increment", voxels, [&] {
+      for (auto l = Loop (image) (image); l; ++l)
+        image.value() += 1.0f;
+    });
+}
@@ -0,0 +1,72 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __benchmark_harness_h__
+#define __benchmark_harness_h__
+
+#include <iostream>
+#include <string>
+
+#include "mrtrix.h"
+#include "timer.h"
+
+namespace MR
+{
+  namespace Benchmark
+  {
+
+
+    /* Repeatedly invoke \a functor until at least \a min_duration seconds
+     * have elapsed (after one untimed warm-up call), then emit a single
+     * JSON object on standard output summarising the run:
+     *
+     *   { "name": ..., "calls": ..., "items": ...,
+     *     "seconds": ..., "items_per_second": ..., "cycles_per_item": ... }
+     *
+     * \a items_per_call is the number of elementary operations (voxels,
+     * samples, queue items, ...) that one invocation of \a functor
+     * performs; rates are reported in terms of these. One object is
+     * printed per line, so the output of several benchmark runs can be
+     * concatenated and tracked release-to-release. */
+    template <class Functor>
+      inline void run (const std::string& name, const size_t items_per_call, Functor&& functor, const double min_duration = 1.0)
+      {
+        functor();
+
+        size_t calls = 0;
+        Timer timer;
+        const uint64_t cycles_from = Timer::current_cycle_count();
+        double seconds = 0.0;
+        do {
+          functor();
+          ++calls;
+          seconds = timer.elapsed();
+        } while (seconds < min_duration);
+        const uint64_t cycles = Timer::current_cycle_count() - cycles_from;
+
+        const double items = double (calls) * double (items_per_call);
+        std::cout << "{ \"name\": \"" << name << "\""
+                  << ", \"calls\": " << calls
+                  << ", \"items\": " << size_t (items)
+                  << ", \"seconds\": " << seconds
+                  << ", \"items_per_second\": " << (items / seconds)
+                  << ", \"cycles_per_item\": " << (double (cycles) / items)
+                  << " }\n";
+      }
+
+
+  }
+}
+
+#endif
@@ -14,6 +14,8 @@
 
 #include "command.h"
 #include "memory.h"
+#include "progressbar.h"
+#include "thread_queue.h"
 #include "dwi/fmls.h"
 #include "dwi/tractography/file.h"
 #include "dwi/tractography/properties.h"
@@ -76,7 +78,9 @@ void usage ()
                           "a voxel are traversed by the pathway of interest, by default the fixel with the "
                           "greatest streamlines density is selected to contribute to the AFD in that voxel. "
                           "If this option is provided, then ALL fixels with non-zero streamlines density "
-                          "will contribute to the result, even if multiple fixels per voxel are selected.");
+                          "will contribute to the result, even if multiple fixels per voxel are selected.")
+
+  + DWI::FMLS::FMLSCacheOption;
 
 }
 
@@ -111,7 +115,7 @@ class Fixel : public FixelBase
 class AFDConnectivity : public DWI::Tractography::SIFT::ModelBase<Fixel>
 { MEMALIGN(AFDConnectivity)
   public:
-    AFDConnectivity (Image<value_type>& fod_buffer, const DWI::Directions::FastLookupSet& dirs, const std::string& tck_path, const std::string& wbft_path) :
+    AFDConnectivity (Image<value_type>& fod_buffer, const DWI::Directions::FastLookupSet& dirs, const std::string& tck_path, const std::string& wbft_path, const std::string& cache_path) :
         DWI::Tractography::SIFT::ModelBase<Fixel> (fod_buffer, dirs),
         have_wbft (wbft_path.size()),
         all_fixels (false),
@@ -123,6 +127,8 @@ class AFDConnectivity : public DWI::Tractography::SIFT::ModelBase<Fixel>
         map_streamlines (wbft_path);
       } else {
         fmls.reset (new DWI::FMLS::Segmenter (dirs, Math::SH::LforN (fod_buffer.size (3))));
+        if (cache_path.size())
+          load_via_cache (fod_buffer, cache_path);
       }
       mapper.set_upsample_ratio (DWI::Tractography::Mapping::determine_upsample_ratio (fod_buffer, tck_path, 0.1));
       mapper.set_use_precise_mapping (true);
@@ -145,10 +151,37 @@ class AFDConnectivity : public DWI::Tractography::SIFT::ModelBase<Fixel>
 
     using Fixel_map<Fixel>::accessor;
 
+    void load_via_cache (Image<value_type>&, const std::string&);
+
 };
 
 
 
+// Rather than segmenting FODs lazily as voxels are traversed, either replay a
+//   matching segmentation cache into the fixel map, or segment the whole image
+//   up front so that the cache written is complete and reusable by subsequent
+//   commands (e.g. fod2fixel). Any voxel not covered by the cache still falls
+//   back to lazy segmentation in get().
+void AFDConnectivity::load_via_cache (Image<value_type>& fod_buffer, const std::string& cache_path)
+{
+  DWI::FMLS::Cache cache (cache_path, fod_buffer, *fmls);
+  if (cache.ready()) {
+    ProgressBar progress ("reloading cached FOD segmentation");
+    DWI::FMLS::FOD_lobes lobes;
+    while (cache.read (lobes)) {
+      (*this) (lobes);
+      ++progress;
+    }
+  } else {
+    DWI::FMLS::FODQueueWriter writer (fod_buffer);
+    DWI::FMLS::CachingReceiver<AFDConnectivity> sink (cache, *this);
+    Thread::run_queue (writer, Thread::batch (DWI::FMLS::SH_coefs()), Thread::multi (*fmls), Thread::batch (DWI::FMLS::FOD_lobes()), sink);
+    cache.commit ();
+  }
+}
+
+
+
 value_type AFDConnectivity::get (const std::string& path)
 {
 
@@ -290,11 +323,18 @@ void run ()
   auto opt = get_options ("wbft");
   const std::string wbft_path = opt.size() ? str(opt[0][0]) : "";
 
+  opt = get_options ("fmls_cache");
+  std::string cache_path = opt.size() ? str(opt[0][0]) : "";
+  if (cache_path.size() && wbft_path.size()) {
+    WARN ("Option -fmls_cache ignored: FOD segmentation for whole-brain fibre-tracking is restricted to the processing mask, and hence is not cacheable");
+    cache_path.clear();
+  }
+
   DWI::Directions::FastLookupSet dirs (1281);
   auto fod = Image<value_type>::open (argument[0]);
   Math::SH::check (fod);
   check_3D_nonunity (fod);
-  AFDConnectivity model (fod, dirs, argument[1], wbft_path);
+  AFDConnectivity model (fod, dirs, argument[1], wbft_path, cache_path);
 
   opt = get_options ("all_fixels");
   model.set_all_fixels (opt.size());
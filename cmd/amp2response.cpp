@@ -12,12 +12,16 @@
  */
 
 
+#include <array>
+#include <atomic>
+
 #include <Eigen/Dense>
 
 #include "command.h"
 #include "header.h"
 #include "image.h"
 #include "image_helpers.h"
+#include "thread.h"
 #include "types.h"
 
 #include "math/constrained_least_squares.h"
@@ -84,9 +88,8 @@ void usage ()
 
 
 
-Eigen::Matrix<default_type, 3, 3> gen_rotation_matrix (const Eigen::Vector3& dir)
+Eigen::Matrix<default_type, 3, 3> gen_rotation_matrix (const Eigen::Vector3& dir, Math::RNG::Normal<default_type>& rng)
 {
-  static Math::RNG::Normal<default_type> rng;
   // Generates a matrix that will rotate a unit vector into a new frame of reference,
   //   where the peak direction of the FOD is aligned in Z (3rd dimension)
   // Previously this was done using the tensor eigenvectors
@@ -198,111 +201,151 @@ void run ()
 
   Eigen::MatrixXd responses (dirs_azel.size(), Math::ZSH::NforL (max_lmax));
 
+  // The mask does not change across shells: record the position of every
+  //   single-fibre voxel once
+  vector<std::array<ssize_t,3>> sf_positions;
+  for (auto l = Loop (mask) (mask); l; ++l)
+    if (mask.value())
+      sf_positions.push_back ({{ mask.index(0), mask.index(1), mask.index(2) }});
+  const size_t sf_counter = sf_positions.size();
+
   for (size_t shell_index = 0; shell_index != dirs_azel.size(); ++shell_index) {
 
     std::string shell_desc = (dirs_azel.size() > 1) ? ("_shell" + str(shell_index)) : "";
 
     Eigen::MatrixXd dirs_cartesian = Math::Sphere::spherical2cartesian (dirs_azel[shell_index]);
 
-    // All directions from all SF voxels get concatenated into a single large matrix
-    Eigen::MatrixXd cat_transforms;
-    Eigen::VectorXd cat_data;
+    // All directions from all SF voxels get concatenated into a single large matrix;
+    //   since the contributing voxels are known up front, this is allocated in
+    //   one go, and each voxel's block of rows filled independently across threads
+    const size_t rows_per_voxel = dirs_azel[shell_index].rows();
+    Eigen::MatrixXd cat_transforms (rows_per_voxel * sf_counter, Math::ZSH::NforL (lmax[shell_index]));
+    Eigen::VectorXd cat_data (rows_per_voxel * sf_counter);
 
 #ifdef AMP2RESPONSE_DEBUG
     // To make sure we've got our data rotated correctly, let's generate a scatterplot of
     //   elevation vs. amplitude
-    Eigen::MatrixXd scatter;
+    Eigen::MatrixXd scatter (rows_per_voxel * sf_counter, 2);
 #endif
 
-    size_t sf_counter = 0;
-    for (auto l = Loop (mask) (image, mask, dir_image); l; ++l) {
-      if (mask.value()) {
-
-        // Grab the image data
-        Eigen::VectorXd data (dirs_azel[shell_index].rows());
-        for (size_t i = 0; i != volumes[shell_index].size(); ++i) {
-          image.index(3) = volumes[shell_index][i];
-          data[i] = image.value();
+    {
+      std::atomic<size_t> voxel_counter (0);
+
+      struct FillThread { MEMALIGN(FillThread)
+        const vector<std::array<ssize_t,3>>& positions;
+        const vector<size_t>& volumes;
+        const Eigen::MatrixXd& dirs_cartesian;
+        const int lmax;
+        const size_t rows_per_voxel;
+        Eigen::MatrixXd& cat_transforms;
+        Eigen::VectorXd& cat_data;
+#ifdef AMP2RESPONSE_DEBUG
+        Eigen::MatrixXd& scatter;
+#endif
+#ifdef AMP2RESPONSE_PERVOXEL_IMAGES
+        const Header& header;
+        const std::string shell_desc;
+#endif
+        std::atomic<size_t>& voxel_counter;
+        Image<float> image;
+        Image<float> dir_image;
+        Math::RNG::Normal<default_type> rng;
+
+        void execute () {
+          for (size_t n = voxel_counter++; n < positions.size(); n = voxel_counter++)
+            fill (n);
         }
 
-        // Grab the fibre direction
-        Eigen::Vector3 fibre_dir;
-        for (dir_image.index(3) = 0; dir_image.index(3) != 3; ++dir_image.index(3))
-          fibre_dir[dir_image.index(3)] = dir_image.value();
-        fibre_dir.normalize();
-
-        // Rotate the directions into a new reference frame,
-        //   where the Z axis is defined by the specified direction
-        Eigen::Matrix<default_type, 3, 3> R = gen_rotation_matrix (fibre_dir);
-        Eigen::Matrix<default_type, Eigen::Dynamic, 3> rotated_dirs_cartesian (dirs_cartesian.rows(), 3);
-        Eigen::Vector3 vec (3), rot (3);
-        for (ssize_t row = 0; row != dirs_azel[shell_index].rows(); ++row) {
-          vec = dirs_cartesian.row (row);
-          rot = R * vec;
-          rotated_dirs_cartesian.row (row) = rot;
-        }
+        void fill (const size_t n) {
+          image.index(0) = dir_image.index(0) = positions[n][0];
+          image.index(1) = dir_image.index(1) = positions[n][1];
+          image.index(2) = dir_image.index(2) = positions[n][2];
 
-        // Convert directions from Euclidean space to azimuth/elevation pairs
-        Eigen::MatrixXd rotated_dirs_azel = Math::Sphere::cartesian2spherical (rotated_dirs_cartesian);
-
-        // Constrain elevations to between 0 and pi/2
-        for (ssize_t i = 0; i != rotated_dirs_azel.rows(); ++i) {
-          if (rotated_dirs_azel (i, 1) > Math::pi_2) {
-            if (rotated_dirs_azel (i, 0) > Math::pi)
-              rotated_dirs_azel (i, 0) -= Math::pi;
-            else
-              rotated_dirs_azel (i, 0) += Math::pi;
-            rotated_dirs_azel (i, 1) = Math::pi - rotated_dirs_azel (i, 1);
+          // Grab the image data
+          Eigen::VectorXd data (rows_per_voxel);
+          for (size_t i = 0; i != volumes.size(); ++i) {
+            image.index(3) = volumes[i];
+            data[i] = image.value();
+          }
+
+          // Grab the fibre direction
+          Eigen::Vector3 fibre_dir;
+          for (dir_image.index(3) = 0; dir_image.index(3) != 3; ++dir_image.index(3))
+            fibre_dir[dir_image.index(3)] = dir_image.value();
+          fibre_dir.normalize();
+
+          // Rotate the directions into a new reference frame,
+          //   where the Z axis is defined by the specified direction;
+          //   applied to all directions at once as a single matrix product
+          Eigen::Matrix<default_type, 3, 3> R = gen_rotation_matrix (fibre_dir, rng);
+          Eigen::Matrix<default_type, Eigen::Dynamic, 3> rotated_dirs_cartesian = dirs_cartesian * R.transpose();
+
+          // Convert directions from Euclidean space to azimuth/elevation pairs
+          Eigen::MatrixXd rotated_dirs_azel = Math::Sphere::cartesian2spherical (rotated_dirs_cartesian);
+
+          // Constrain elevations to between 0 and pi/2
+          for (ssize_t i = 0; i != rotated_dirs_azel.rows(); ++i) {
+            if (rotated_dirs_azel (i, 1) > Math::pi_2) {
+              if (rotated_dirs_azel (i, 0) > Math::pi)
+                rotated_dirs_azel (i, 0) -= Math::pi;
+              else
+                rotated_dirs_azel (i, 0) += Math::pi;
+              rotated_dirs_azel (i, 1) = Math::pi - rotated_dirs_azel (i, 1);
+            }
           }
-        }
 
 #ifdef AMP2RESPONSE_PERVOXEL_IMAGES
-        // For the sake of generating a figure, output the original and rotated signals to a dixel ODF image
-        Header rotated_header (header);
-        rotated_header.size(0) = rotated_header.size(1) = rotated_header.size(2) = 1;
-        rotated_header.size(3) = volumes[shell_index].size();
-        Header nonrotated_header (rotated_header);
-        nonrotated_header.size(3) = header.size(3);
-        Eigen::MatrixXd rotated_grad (volumes[shell_index].size(), 4);
-        for (size_t i = 0; i != volumes.size(); ++i) {
-          rotated_grad.block<1,3>(i, 0) = rotated_dirs_cartesian.row(i);
-          rotated_grad(i, 3) = 1000.0;
-        }
-        DWI::set_DW_scheme (rotated_header, rotated_grad);
-        Image<float> out_rotated = Image<float>::create ("rotated_amps_" + str(sf_counter) + shell_desc + ".mif", rotated_header);
-        Image<float> out_nonrotated = Image<float>::create ("nonrotated_amps_" + str(sf_counter) + shell_desc + ".mif", nonrotated_header);
-        out_rotated.index(0) = out_rotated.index(1) = out_rotated.index(2) = 0;
-        out_nonrotated.index(0) = out_nonrotated.index(1) = out_nonrotated.index(2) = 0;
-        for (size_t i = 0; i != volumes[shell_index].size(); ++i) {
-          image.index(3) = volumes[shell_index][i];
-          out_rotated.index(3) = i;
-          out_rotated.value() = image.value();
-        }
-        for (ssize_t i = 0; i != header.size(3); ++i) {
-          image.index(3) = out_nonrotated.index(3) = i;
-          out_nonrotated.value() = image.value();
-        }
+          // For the sake of generating a figure, output the original and rotated signals to a dixel ODF image
+          Header rotated_header (header);
+          rotated_header.size(0) = rotated_header.size(1) = rotated_header.size(2) = 1;
+          rotated_header.size(3) = volumes.size();
+          Header nonrotated_header (rotated_header);
+          nonrotated_header.size(3) = header.size(3);
+          Eigen::MatrixXd rotated_grad (volumes.size(), 4);
+          for (size_t i = 0; i != volumes.size(); ++i) {
+            rotated_grad.block<1,3>(i, 0) = rotated_dirs_cartesian.row(i);
+            rotated_grad(i, 3) = 1000.0;
+          }
+          DWI::set_DW_scheme (rotated_header, rotated_grad);
+          Image<float> out_rotated = Image<float>::create ("rotated_amps_" + str(n) + shell_desc + ".mif", rotated_header);
+          Image<float> out_nonrotated = Image<float>::create ("nonrotated_amps_" + str(n) + shell_desc + ".mif", nonrotated_header);
+          out_rotated.index(0) = out_rotated.index(1) = out_rotated.index(2) = 0;
+          out_nonrotated.index(0) = out_nonrotated.index(1) = out_nonrotated.index(2) = 0;
+          for (size_t i = 0; i != volumes.size(); ++i) {
+            image.index(3) = volumes[i];
+            out_rotated.index(3) = i;
+            out_rotated.value() = image.value();
+          }
+          for (ssize_t i = 0; i != header.size(3); ++i) {
+            image.index(3) = out_nonrotated.index(3) = i;
+            out_nonrotated.value() = image.value();
+          }
 #endif
 
-        // Generate the ZSH -> amplitude transform
-        Eigen::MatrixXd transform = Math::ZSH::init_amp_transform<default_type> (rotated_dirs_azel.col(1), lmax[shell_index]);
-
-        // Concatenate these data to the ICLS matrices
-        const size_t old_rows = cat_transforms.rows();
-        cat_transforms.conservativeResize (old_rows + transform.rows(), transform.cols());
-        cat_transforms.block (old_rows, 0, transform.rows(), transform.cols()) = transform;
-        cat_data.conservativeResize (old_rows + data.size());
-        cat_data.tail (data.size()) = data;
+          // Generate the ZSH -> amplitude transform, writing straight into
+          //   this voxel's block of rows
+          cat_transforms.block (n * rows_per_voxel, 0, rows_per_voxel, cat_transforms.cols()) =
+              Math::ZSH::init_amp_transform<default_type> (rotated_dirs_azel.col(1), lmax);
+          cat_data.segment (n * rows_per_voxel, rows_per_voxel) = data;
 
 #ifdef AMP2RESPONSE_DEBUG
-        scatter.conservativeResize (cat_data.size(), 2);
-        scatter.block (old_rows, 0, data.size(), 1) = rotated_dirs_azel.col(1);
-        scatter.block (old_rows, 1, data.size(), 1) = data;
+          scatter.block (n * rows_per_voxel, 0, rows_per_voxel, 1) = rotated_dirs_azel.col(1);
+          scatter.block (n * rows_per_voxel, 1, rows_per_voxel, 1) = data;
 #endif
+        }
+      } worker = { sf_positions, volumes[shell_index], dirs_cartesian, lmax[shell_index], rows_per_voxel, cat_transforms, cat_data,
+#ifdef AMP2RESPONSE_DEBUG
+        scatter,
+#endif
+#ifdef AMP2RESPONSE_PERVOXEL_IMAGES
+        header, shell_desc,
+#endif
+        voxel_counter, image, dir_image, Math::RNG::Normal<default_type>() };
 
-        ++sf_counter;
-
-      }
+      if (Thread::number_of_threads() == 0)
+        worker.execute();
+      else
+        Thread::run (Thread::multi (worker), "fill threads").wait();
     }
 
 #ifdef AMP2RESPONSE_DEBUG
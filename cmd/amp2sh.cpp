@@ -76,6 +76,9 @@ void usage ()
 
 #define RICIAN_POWER 2.25
 
+// Number of voxels gathered into each batched transform
+#define BATCH_SIZE 256
+
 
 using value_type = float;
 
@@ -104,18 +107,35 @@ class Amp2SHCommon { MEMALIGN(Amp2SHCommon)
 
 class Amp2SH { MEMALIGN(Amp2SH)
   public:
-    Amp2SH (const Amp2SHCommon& common) : 
-      C (common), 
+    Amp2SH (const Amp2SHCommon& common) :
+      C (common),
       a (common.amp2sh.cols()),
       s (common.amp2sh.rows()),
-      c (common.amp2sh.rows()) { }
+      c (common.amp2sh.rows()),
+      a_batch (common.amp2sh.cols(), BATCH_SIZE),
+      c_batch (common.amp2sh.rows(), BATCH_SIZE),
+      pos (3, BATCH_SIZE),
+      filled (0) { }
+
+    ~Amp2SH ()
+    {
+      if (filled)
+        flush();
+    }
 
-    template <class SHImageType, class AmpImageType>
-      void operator() (SHImageType& SH, AmpImageType& amp) 
+    // Voxels are gathered into column batches, so that the fit runs as a
+    //   matrix-matrix product rather than one matrix-vector product per voxel
+    void operator() (Image<value_type>& SH, Image<value_type>& amp)
       {
+        if (!SH_out.valid())
+          SH_out = SH;
         get_amps (amp);
-        c.noalias() = C.amp2sh * a;
-        write_SH (SH);
+        a_batch.col (filled) = a;
+        pos(0, filled) = SH.index(0);
+        pos(1, filled) = SH.index(1);
+        pos(2, filled) = SH.index(2);
+        if (++filled == BATCH_SIZE)
+          flush();
       }
 
 
@@ -150,6 +170,22 @@ class Amp2SH { MEMALIGN(Amp2SH)
     Eigen::VectorXd a, s, c, w, ap;
     Eigen::MatrixXd Q, sh2amp;
     Eigen::LLT<Eigen::MatrixXd> llt;
+    Eigen::MatrixXd a_batch, c_batch;
+    Eigen::Matrix<ssize_t, 3, Eigen::Dynamic> pos;
+    size_t filled;
+    Image<value_type> SH_out;
+
+    void flush () {
+      c_batch.leftCols (filled).noalias() = C.amp2sh * a_batch.leftCols (filled);
+      for (size_t n = 0; n != filled; ++n) {
+        SH_out.index(0) = pos(0, n);
+        SH_out.index(1) = pos(1, n);
+        SH_out.index(2) = pos(2, n);
+        for (auto l = Loop(3) (SH_out); l; ++l)
+          SH_out.value() = c_batch (SH_out.index(3), n);
+      }
+      filled = 0;
+    }
 
     template <class AmpImageType>
       void get_amps (AmpImageType& amp) {
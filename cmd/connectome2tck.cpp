@@ -333,6 +333,7 @@ void run ()
         ++progress;
       }
     }
+    writer.finish();
 
   }
 
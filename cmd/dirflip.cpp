@@ -21,6 +21,7 @@
 #include "dwi/directions/file.h"
 
 #define DEFAULT_PERMUTATIONS 1e8
+#define SYNC_INTERVAL 10000
 
 
 using namespace MR;
@@ -60,7 +61,25 @@ class Shared { MEMALIGN(Shared)
     Shared (const Eigen::MatrixXd& directions, size_t target_num_permutations) :
       directions (directions), target_num_permutations (target_num_permutations), num_permutations(0),
       progress ("optimising directions for eddy-currents", target_num_permutations),
-      best_signs (directions.rows(), 1), best_eddy (std::numeric_limits<value_type>::max()) { }
+      best_signs (directions.rows(), 1), best_eddy (std::numeric_limits<value_type>::max()) {
+        // precompute the pairwise terms once: for each pair, the energy is
+        // 1/|a-b| if the two polarities match, 1/|a+b| otherwise, so the
+        // total can be expressed via the sum and (signed) difference of the
+        // two, allowing incremental O(N) updates per flip
+        const ssize_t n = directions.rows();
+        pair_diff.setZero (n, n);
+        sum_of_pairs = 0.0;
+        for (ssize_t i = 0; i < n; ++i) {
+          for (ssize_t j = i+1; j < n; ++j) {
+            const vector3_type a = { directions(i,0), directions(i,1), directions(i,2) };
+            const vector3_type b = { directions(j,0), directions(j,1), directions(j,2) };
+            const value_type same = 1.0 / (a-b).norm();
+            const value_type opposite = 1.0 / (a+b).norm();
+            pair_diff(i,j) = pair_diff(j,i) = same - opposite;
+            sum_of_pairs += same + opposite;
+          }
+        }
+      }
 
     bool update (value_type eddy, const vector<int>& signs) 
     {
@@ -77,14 +96,17 @@ class Shared { MEMALIGN(Shared)
 
 
 
-    value_type eddy (size_t i, size_t j, const vector<int>& signs) const {
-      vector3_type a = { directions(i,0), directions(i,1), directions(i,2) };
-      vector3_type b = { directions(j,0), directions(j,1), directions(j,2) };
-      if (signs[i] < 0) a = -a;
-      if (signs[j] < 0) b = -b;
-      return 1.0 / (a-b).norm();
+    //! total energy for sign configuration \a signs (as a +/-1 vector)
+    value_type total_eddy (const Eigen::VectorXd& signs) const {
+      return 0.5 * sum_of_pairs + 0.25 * signs.dot (pair_diff * signs);
     }
 
+    const Eigen::MatrixXd& pair_diff_matrix () const { return pair_diff; }
+
+    void get_best (vector<int>& signs) const {
+      std::lock_guard<std::mutex> lock (mutex);
+      signs = best_signs;
+    }
 
     vector<int> get_init_signs () const { return vector<int> (directions.rows(), 1); }
     const vector<int>& get_best_signs () const { return best_signs; }
@@ -97,8 +119,10 @@ class Shared { MEMALIGN(Shared)
     ProgressBar progress;
     vector<int> best_signs;
     value_type best_eddy;
-    std::mutex mutex;
-  
+    Eigen::MatrixXd pair_diff;
+    value_type sum_of_pairs;
+    mutable std::mutex mutex;
+
 };
 
 
@@ -110,33 +134,51 @@ class Processor { MEMALIGN(Processor)
     Processor (Shared& shared) :
       shared (shared),
       signs (shared.get_init_signs()),
+      sign_f (Eigen::VectorXd::Ones (signs.size())),
+      current_eddy (shared.total_eddy (sign_f)),
+      since_sync (0),
       uniform (0, signs.size()-1) { }
 
     void execute () {
-      while (eval()); 
+      while (eval());
     }
 
 
-    void next_permutation ()
+    size_t next_permutation ()
     {
-      signs[uniform(rng)] *= -1;
+      const size_t n = uniform (rng);
+      signs[n] *= -1;
+      sign_f[n] = -sign_f[n];
+      return n;
     }
 
     bool eval ()
     {
-      next_permutation();
+      // periodically adopt the best configuration found by any chain, and
+      // recompute its energy in full to flush the round-off accumulated by
+      // the incremental updates:
+      if (++since_sync >= SYNC_INTERVAL) {
+        since_sync = 0;
+        shared.get_best (signs);
+        for (size_t n = 0; n < signs.size(); ++n)
+          sign_f[n] = signs[n];
+        current_eddy = shared.total_eddy (sign_f);
+      }
 
-      value_type eddy = 0.0;
-      for (size_t i = 0; i < signs.size(); ++i) 
-        for (size_t j = i+1; j < signs.size(); ++j) 
-          eddy += shared.eddy (i, j, signs);
+      const size_t n = next_permutation();
+      // flipping direction n swaps the parallel/anti-parallel contribution
+      // of every pair involving n, leaving all other terms unchanged:
+      current_eddy += sign_f[n] * shared.pair_diff_matrix().col (n).dot (sign_f);
 
-      return shared.update (eddy, signs);
+      return shared.update (current_eddy, signs);
     }
 
   protected:
     Shared& shared;
     vector<int> signs;
+    Eigen::VectorXd sign_f;
+    value_type current_eddy;
+    size_t since_sync;
     Math::RNG rng;
     std::uniform_int_distribution<int> uniform;
 };
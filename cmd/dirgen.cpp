@@ -103,11 +103,11 @@ class Energy { MEMALIGN(Energy)
       ndirs (to<int> (argument[0])),
       bipolar (!(get_options ("unipolar").size())),
       power (0),
-      directions (3 * ndirs) { }
-
-    FORCE_INLINE double fast_pow (double x, int p) {
-      return p == 1 ? x : fast_pow (x*x, p/2);
-    }
+      directions (3 * ndirs),
+      diff (3, ndirs > 1 ? ndirs-1 : 0),
+      inv_r2 (ndirs > 1 ? ndirs-1 : 0),
+      e (ndirs > 1 ? ndirs-1 : 0),
+      w (ndirs > 1 ? ndirs-1 : 0) { }
 
     using value_type = double;
 
@@ -136,31 +136,44 @@ class Energy { MEMALIGN(Energy)
       double E = 0.0;
       g.setZero();
 
-      for (size_t i = 0; i < ndirs-1; ++i) {
-        auto d1 = x.segment (3*i, 3);
-        auto g1 = g.segment (3*i, 3);
-        for (size_t j = i+1; j < ndirs; ++j) {
-          auto d2 = x.segment (3*j, 3);
-          auto g2 = g.segment (3*j, 3);
-
-          Eigen::Vector3d r = d1-d2;
-          double _1_r2 = 1.0 / r.squaredNorm();
-          double _1_r = std::sqrt (_1_r2);
-          double e = fast_pow (_1_r, power); 
-          E += e;
-          g1 -= (power * e * _1_r2) * r; 
-          g2 += (power * e * _1_r2) * r; 
-
-          if (bipolar) {
-            r = d1+d2;
-            _1_r2 = 1.0 / r.squaredNorm();
-            _1_r = std::sqrt (_1_r2);
-            e = fast_pow (_1_r, power); 
-            E += e;
-            g1 -= (power * e * _1_r2) * r; 
-            g2 -= (power * e * _1_r2) * r; 
-          }
-
+      // structure-of-arrays view of the packed [ x y z ] triplets: one
+      // direction per column, so that each charge can be evaluated against
+      // all subsequent charges using column-wise array expressions (which
+      // Eigen maps onto SIMD operations), rather than pair by pair:
+      Eigen::Map<const Eigen::Matrix3Xd> D (x.data(), 3, ndirs);
+      Eigen::Map<Eigen::Matrix3Xd> G (g.data(), 3, ndirs);
+
+      for (ssize_t i = 0; i < ssize_t (ndirs)-1; ++i) {
+        const ssize_t m = ndirs-1-i;
+        auto r = diff.leftCols (m);
+        auto _1_r2 = inv_r2.head (m);
+        auto _e = e.head (m);
+        auto _w = w.head (m);
+
+        r = D.middleCols (i+1, m).colwise() - D.col (i);
+        _1_r2 = r.colwise().squaredNorm().array().inverse();
+        // 1/r^power, with power a power of 2: square log2(power) times
+        _e = _1_r2.sqrt();
+        for (int p = power; p > 1; p /= 2)
+          _e *= _e;
+        E += _e.sum();
+        _w = power * _e * _1_r2;
+        // NB: r holds d_j - d_i (the negation of the pairwise difference as
+        //   evaluated charge by charge), hence the application signs are
+        //   swapped relative to the symmetric sum term below
+        G.col (i).noalias() += r * _w.matrix().transpose();
+        G.middleCols (i+1, m).array() -= r.array().rowwise() * _w;
+
+        if (bipolar) {
+          r = D.middleCols (i+1, m).colwise() + D.col (i);
+          _1_r2 = r.colwise().squaredNorm().array().inverse();
+          _e = _1_r2.sqrt();
+          for (int p = power; p > 1; p /= 2)
+            _e *= _e;
+          E += _e.sum();
+          _w = power * _e * _1_r2;
+          G.col (i).noalias() -= r * _w.matrix().transpose();
+          G.middleCols (i+1, m).array() -= r.array().rowwise() * _w;
         }
       }
 
@@ -228,6 +241,11 @@ class Energy { MEMALIGN(Energy)
     Eigen::VectorXd directions;
     double E;
 
+    // per-instance workspace for the vectorised pairwise kernel, sized
+    // once to avoid allocating within the optimiser's inner loop:
+    Eigen::Matrix3Xd diff;
+    Eigen::Array<double, 1, Eigen::Dynamic> inv_r2, e, w;
+
     static std::mutex mutex;
     static std::atomic<size_t> current_start;
 };
@@ -16,6 +16,7 @@
 #include "progressbar.h"
 #include "math/rng.h"
 #include "dwi/directions/file.h"
+#include "dwi/directions/metrics.h"
 #include "file/ofstream.h"
 
 #include <array>
@@ -115,37 +116,31 @@ void run ()
     dirs[b][p].erase (dirs[b][p].begin()+n); 
   };
 
-  auto energy_pair = [&](const Direction& a, const Direction& b) 
-  {
-    // use combination of mono- and bi-polar electrostatic repulsion models 
-    // to ensure adequate coverage of eddy-current space as well as 
-    // orientation space. Use a moderate bias, favouring the bipolar model.
-
-    return (unipolar_weight+bipolar_weight) / (b-a).norm()
-         + bipolar_weight / (b+a).norm();
-  };
-
-  auto energy = [&](size_t b, size_t p, size_t n) 
-  { 
-    value_type E = 0.0;
-    for (auto& d : merged) 
-      if (d.b == b) 
-        E += energy_pair (d.d, dirs[b][p][n]);
-    return E;
-  };
-
   auto find_lowest_energy_direction = [&](size_t b, size_t p)
   {
-    size_t best = 0;
-    value_type bestE = std::numeric_limits<value_type>::max();
-    for (size_t n = 0; n < dirs[b][p].size(); ++n) {
-      value_type E = energy (b, p, n);
-      if (E < bestE) {
-        bestE = E;
-        best = n;
-      }
-    }
-    return best;
+    // use combination of mono- and bi-polar electrostatic repulsion models
+    // to ensure adequate coverage of eddy-current space as well as
+    // orientation space. Use a moderate bias, favouring the bipolar model.
+    // The energies of all remaining candidates against the directions
+    // already selected on this shell are evaluated in one matrix product
+    if (dirs[b][p].empty())
+      return size_t (0);
+    Eigen::MatrixXd candidates (dirs[b][p].size(), 3);
+    for (size_t n = 0; n < dirs[b][p].size(); ++n)
+      candidates.row(n) = dirs[b][p][n];
+    size_t num_selected = 0;
+    for (auto& d : merged)
+      if (d.b == b)
+        ++num_selected;
+    Eigen::MatrixXd selected (num_selected, 3);
+    num_selected = 0;
+    for (auto& d : merged)
+      if (d.b == b)
+        selected.row(num_selected++) = d.d;
+    const Eigen::VectorXd E = DWI::Directions::electrostatic_energy (selected, candidates, unipolar_weight, bipolar_weight);
+    Eigen::Index best = 0;
+    E.minCoeff (&best);
+    return size_t (best);
   };
 
 
@@ -19,6 +19,7 @@
 #include "dwi/directions/file.h"
 
 #define DEFAULT_PERMUTATIONS 1e8
+#define SYNC_INTERVAL 10000
 
 
 using namespace MR;
@@ -59,6 +60,16 @@ class Shared { MEMALIGN(Shared)
           subset[s++].push_back (n);
           if (s >= num_subsets) s = 0;
         }
+        // precompute all pairwise energies once: each candidate swap then
+        // only needs table lookups for the pairs it actually affects
+        pair_energy.setZero (directions.rows(), directions.rows());
+        for (ssize_t i = 0; i < directions.rows(); ++i) {
+          for (ssize_t j = i+1; j < directions.rows(); ++j) {
+            const vector3_type a = { directions(i,0), directions(i,1), directions(i,2) };
+            const vector3_type b = { directions(j,0), directions(j,1), directions(j,2) };
+            pair_energy(i,j) = pair_energy(j,i) = 1.0 / (a-b).norm() + 1.0 / (a+b).norm();
+          }
+        }
         INFO ("split " + str(directions.rows()) + " directions into subsets with " + 
             str([&]{ vector<size_t> c; for (auto& x : subset) c.push_back (x.size()); return c; }()) + " volumes");
       }
@@ -83,11 +94,16 @@ class Shared { MEMALIGN(Shared)
 
 
     value_type energy (size_t i, size_t j) const {
-      vector3_type a = { directions(i,0), directions(i,1), directions(i,2) };
-      vector3_type b = { directions(j,0), directions(j,1), directions(j,2) };
-      return 1.0 / (a-b).norm() + 1.0 / (a+b).norm();
+      return pair_energy (i, j);
     }
 
+    bool get_best (vector<vector<size_t>>& set) const {
+      std::lock_guard<std::mutex> lock (mutex);
+      if (best_subset.empty())
+        return false;
+      set = best_subset;
+      return true;
+    }
 
     const vector<vector<size_t>>& get_init_subset () const { return subset; }
     const vector<vector<size_t>>& get_best_subset () const { return best_subset; }
@@ -95,7 +111,8 @@ class Shared { MEMALIGN(Shared)
 
   protected:
     const Eigen::MatrixXd& directions;
-    std::mutex mutex;
+    Eigen::MatrixXd pair_energy;
+    mutable std::mutex mutex;
     vector<vector<size_t>> subset, best_subset;
     value_type best_energy;
     const size_t target_num_permutations;
@@ -111,15 +128,35 @@ class Shared { MEMALIGN(Shared)
 
 class EnergyCalculator { MEMALIGN(EnergyCalculator)
   public:
-    EnergyCalculator (Shared& shared) : shared (shared), subset (shared.get_init_subset()) { }
+    EnergyCalculator (Shared& shared) : shared (shared), subset (shared.get_init_subset()), since_sync (0) {
+      recalculate();
+    }
 
     void execute () {
-      while (eval()); 
+      while (eval());
     }
 
 
-    void next_permutation ()
+    void recalculate ()
+    {
+      subset_energy.assign (subset.size(), 0.0);
+      for (size_t s = 0; s < subset.size(); ++s)
+        for (size_t i = 0; i < subset[s].size(); ++i)
+          for (size_t j = i+1; j < subset[s].size(); ++j)
+            subset_energy[s] += shared.energy (subset[s][i], subset[s][j]);
+    }
+
+    bool eval ()
     {
+      // periodically adopt the best configuration found by any chain, and
+      // recompute its energies in full to flush the round-off accumulated
+      // by the incremental updates:
+      if (++since_sync >= SYNC_INTERVAL) {
+        since_sync = 0;
+        if (shared.get_best (subset))
+          recalculate();
+      }
+
       size_t i,j;
       std::uniform_int_distribution<size_t> dist(0, subset.size()-1);
       do {
@@ -130,21 +167,22 @@ class EnergyCalculator { MEMALIGN(EnergyCalculator)
       size_t n_i = std::uniform_int_distribution<size_t> (0, subset[i].size()-1) (rng);
       size_t n_j = std::uniform_int_distribution<size_t> (0, subset[j].size()-1) (rng);
 
+      // swapping one element between two subsets only affects the pairwise
+      // terms involving the swapped elements within those two subsets, so
+      // only those terms need (re)computing:
+      const size_t u = subset[i][n_i], v = subset[j][n_j];
+      value_type delta_i = -shared.energy (u, v), delta_j = delta_i;
+      for (auto x : subset[i])
+        delta_i += shared.energy (v, x) - shared.energy (u, x);
+      for (auto x : subset[j])
+        delta_j += shared.energy (u, x) - shared.energy (v, x);
       std::swap (subset[i][n_i], subset[j][n_j]);
-    }
-
-    bool eval ()
-    {
-      next_permutation();
+      subset_energy[i] += delta_i;
+      subset_energy[j] += delta_j;
 
       value_type energy = 0.0;
-      for (auto& s: subset) {
-        value_type current_energy = 0.0;
-        for (size_t i = 0; i < s.size(); ++i) 
-          for (size_t j = i+1; j < s.size(); ++j) 
-            current_energy += shared.energy (s[i], s[j]);
-        energy = std::max (energy, current_energy);
-      }
+      for (auto e : subset_energy)
+        energy = std::max (energy, e);
 
       return shared.update (energy, subset);
     }
@@ -152,6 +190,8 @@ class EnergyCalculator { MEMALIGN(EnergyCalculator)
   protected:
     Shared& shared;
     vector<vector<size_t>> subset;
+    vector<value_type> subset_energy;
+    size_t since_sync;
     Math::RNG rng;
 };
 
@@ -15,6 +15,7 @@
 #include "command.h"
 #include "progressbar.h"
 #include "dwi/directions/file.h"
+#include "dwi/directions/metrics.h"
 #include "dwi/gradient.h"
 
 
@@ -39,37 +40,11 @@ int precision = 6;
 
 
 
-void report (const std::string& title, const Eigen::MatrixXd& directions) 
+void report (const std::string& title, const Eigen::MatrixXd& directions)
 {
-  vector<double> NN_bipolar (directions.rows(), -1.0);
-  vector<double> NN_unipolar (directions.rows(), -1.0);
-
-  vector<double> E_bipolar (directions.rows(), 0.0);
-  vector<double> E_unipolar (directions.rows(), 0.0);
-
-  for (ssize_t i = 0; i < directions.rows()-1; ++i) {
-    for (ssize_t j = i+1; j < directions.rows(); ++j) {
-      double cos_angle = directions.row(i).head(3).normalized().dot (directions.row(j).head(3).normalized());
-      NN_unipolar[i] = std::max (NN_unipolar[i], cos_angle);
-      NN_unipolar[j] = std::max (NN_unipolar[j], cos_angle);
-      cos_angle = std::abs (cos_angle);
-      NN_bipolar[i] = std::max (NN_bipolar[i], cos_angle);
-      NN_bipolar[j] = std::max (NN_bipolar[j], cos_angle);
-
-      double E = 1.0 / (directions.row(i).head(3) - directions.row(j).head(3)).norm();
-
-      E_unipolar[i] += E;
-      E_unipolar[j] += E;
-
-      E += 1.0 / (directions.row(i).head(3) + directions.row(j).head(3)).norm();
-
-      E_bipolar[i] += E;
-      E_bipolar[j] += E;
-
-    }
-  }
-
-
+  // all pairwise dot products are computed as blocked matrix products,
+  // with the per-direction statistics derived from them across threads
+  const auto metrics = DWI::Directions::pairwise_metrics (directions);
 
 
   auto report_NN = [](const vector<double>& NN) {
@@ -107,12 +82,12 @@ void report (const std::string& title, const Eigen::MatrixXd& directions)
   print (title + " [ " + str(directions.rows(), precision) + " directions ]\n\n");
 
   print ("  Bipolar electrostatic repulsion model:\n");
-  report_NN (NN_bipolar);
-  report_E (E_bipolar);
+  report_NN (metrics.NN_bipolar);
+  report_E (metrics.E_bipolar);
 
   print ("\n  Unipolar electrostatic repulsion model:\n");
-  report_NN (NN_unipolar);
-  report_E (E_unipolar);
+  report_NN (metrics.NN_unipolar);
+  report_E (metrics.E_unipolar);
 
   std::string lmax_results;
   for (size_t lmax = 2; lmax <= Math::SH::LforN (directions.rows()); lmax += 2) 
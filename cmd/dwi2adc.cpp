@@ -48,28 +48,38 @@ using value_type = float;
 class DWI2ADC { MEMALIGN(DWI2ADC)
   public:
     DWI2ADC (const Eigen::MatrixXd& binv, size_t dwi_axis) :
-      dwi (binv.cols()),
-      adc (2), 
-      binv (binv), 
+      binv (binv),
       dwi_axis (dwi_axis) { }
 
+    // operates on a whole row of voxels along axis 0 at a time: the
+    // log-signals of the row are gathered into a single matrix, so that
+    // applying the precomputed pseudoinverse to all of them is one
+    // matrix-matrix product rather than a matrix-vector solve per voxel
     template <class DWIType, class ADCType>
       void operator() (DWIType& dwi_image, ADCType& adc_image) {
-        for (auto l = Loop (dwi_axis) (dwi_image); l; ++l) {
-          value_type val = dwi_image.value();
-          dwi[dwi_image.index (dwi_axis)] = val ? std::log (val) : 1.0e-12;
+        const ssize_t row_length = dwi_image.size (0);
+        if (dwi.cols() != row_length) {
+          dwi.resize (binv.cols(), row_length);
+          adc.resize (2, row_length);
         }
 
-        adc = binv * dwi;
+        for (auto l = Loop ({ 0, dwi_axis }) (dwi_image); l; ++l)
+          dwi (dwi_image.index (dwi_axis), dwi_image.index (0)) = dwi_image.value();
+        dwi = (dwi.array() != 0.0).select (dwi.array().log(), 1.0e-12).matrix();
 
-        adc_image.index(3) = 0;
-        adc_image.value() = std::exp (adc[0]);
-        adc_image.index(3) = 1;
-        adc_image.value() = adc[1];
+        adc.noalias() = binv * dwi;
+
+        for (auto l = Loop (0) (adc_image); l; ++l) {
+          const ssize_t x = adc_image.index (0);
+          adc_image.index(3) = 0;
+          adc_image.value() = std::exp (adc (0, x));
+          adc_image.index(3) = 1;
+          adc_image.value() = adc (1, x);
+        }
       }
 
   protected:
-    Eigen::VectorXd dwi, adc;
+    Eigen::MatrixXd dwi, adc;
     const Eigen::MatrixXd& binv;
     const size_t dwi_axis;
 };
@@ -103,7 +113,7 @@ void run () {
 
   auto adc = Image<value_type>::create (argument[1], header);
 
-  ThreadedLoop ("computing ADC values", dwi, 0, 3)
+  ThreadedLoop ("computing ADC values", dwi, 1, 3)
     .run (DWI2ADC (binv, dwi_axis), dwi, adc);
 }
 
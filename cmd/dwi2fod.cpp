@@ -255,7 +255,10 @@ void run ()
 
     CSD_Processor processor (shared, mask);
     auto dwi = header_in.get_image<float>().with_direct_io (3);
+    // guided scheduling: voxels outside the mask are skipped at negligible
+    //   cost, so the per-position workload is highly non-uniform
     ThreadedLoop ("performing constrained spherical deconvolution", dwi, 0, 3)
+        .guided()
         .run (processor, dwi, fod);
 
   } else if (algorithm == 1) {
@@ -293,6 +296,7 @@ void run ()
     MSMT_Processor processor (shared, mask, odfs);
     auto dwi = header_in.get_image<float>().with_direct_io (3);
     ThreadedLoop ("performing multi-shell, multi-tissue CSD", dwi, 0, 3)
+        .guided()
         .run (processor, dwi);
 
   } else {
@@ -67,7 +67,9 @@ void run ()
 {
   WARN ("Command dwi2noise is deprecated. Try using dwidenoise with -noise option instead.");
   
-  auto dwi_in = Image<value_type>::open (argument[0]);
+  // Ensure the volume axis is contiguous in memory, so that streaming each
+  //   voxel's amplitudes into the residual workspace is sequential access
+  auto dwi_in = Image<value_type>::open (argument[0]).with_direct_io (3);
   const auto grad = DWI::get_valid_DW_scheme (dwi_in);
 
   vector<size_t> dwis;
@@ -84,8 +84,18 @@ class Processor { MEMALIGN(Processor)
       w(b.rows()),
       work(b.cols(),b.cols()),
       llt(work.rows()),
+      llt0(work.rows()),
       b(b),
-      maxit(iter) { }
+      maxit(iter)
+    {
+      // the design matrix is constant, so the factorisation of the
+      //   unweighted normal matrix can be computed once up front and shared
+      //   across all voxels; only the reweighted iterations need to
+      //   re-factorise per voxel
+      work.setZero();
+      work.selfadjointView<Eigen::Lower>().rankUpdate (b.transpose());
+      llt0.compute (work.selfadjointView<Eigen::Lower>());
+    }
 
     template <class DWIType, class DTType>
       void operator() (DWIType& dwi_image, DTType& dt_image)
@@ -106,9 +116,7 @@ class Processor { MEMALIGN(Processor)
           dwi[i] = std::log (dwi[i]);
         }
         
-        work.setZero();
-        work.selfadjointView<Eigen::Lower>().rankUpdate (b.transpose());
-        p = llt.compute (work.selfadjointView<Eigen::Lower>()).solve(b.transpose()*dwi);
+        p = llt0.solve(b.transpose()*dwi);
         for (int it = 0; it < maxit; it++) {
           w = (b*p).array().exp();
           work.setZero();
@@ -153,6 +161,7 @@ class Processor { MEMALIGN(Processor)
     Eigen::VectorXd w;
     Eigen::MatrixXd work;
     Eigen::LLT<Eigen::MatrixXd> llt;
+    Eigen::LLT<Eigen::MatrixXd> llt0; // factorisation of the constant unweighted normal matrix
     const Eigen::MatrixXd& b;
     const int maxit;
 };
@@ -19,6 +19,11 @@
 
 #define DEFAULT_SIZE 5
 
+// When fewer volumes than patch voxels, the covariance is maintained by
+//   rank-1 updates as the window slides; rebuild it from scratch at this
+//   interval to bound accumulation of floating-point drift
+#define SLIDE_REFRESH_INTERVAL 64
+
 using namespace MR;
 using namespace App;
 
@@ -95,33 +100,44 @@ class DenoisingFunctor { MEMALIGN(DenoisingFunctor)
       m (dwi.size(3)),
       n (extent[0]*extent[1]*extent[2]),
       r ((m<n) ? m : n),
-      X (m,n), 
-      pos {{0, 0, 0}}, 
+      X (m,n),
+      XtX (r,r),
+      Xc (m),
+      dots (n),
+      pos {{0, 0, 0}},
+      prev {{-1, -1, -1}},
+      slides (0),
       mask (mask),
       noise (noise)
   { }
-  
+
   void operator () (ImageType& dwi, ImageType& out)
   {
     if (mask.valid()) {
       assign_pos_of (dwi).to (mask);
-      if (!mask.value())
+      if (!mask.value()) {
+        // window no longer contiguous with the previous voxel:
+        prev = {{ -1, -1, -1 }};
         return;
+      }
     }
 
-    // Load data in local window
-    load_data (dwi);
+    // Update data in local window: adjacent voxels share all but one slab
+    //   of the patch, so slide the window (updating the covariance
+    //   incrementally) where possible, and rebuild from scratch otherwise
+    pos[0] = dwi.index(0); pos[1] = dwi.index(1); pos[2] = dwi.index(2);
+    if (pos[0] == prev[0]+1 && pos[1] == prev[1] && pos[2] == prev[2] &&
+        (m > n || slides < SLIDE_REFRESH_INTERVAL))
+      slide_window (dwi);
+    else
+      load_data (dwi);
+    prev = pos;
 
     // Compute Eigendecomposition:
-    Eigen::MatrixXf XtX (r,r);
-    if (m <= n)
-      XtX.template triangularView<Eigen::Lower>() = X * X.transpose();
-    else 
-      XtX.template triangularView<Eigen::Lower>() = X.transpose() * X;
     Eigen::SelfAdjointEigenSolver<Eigen::MatrixXf> eig (XtX);
     // eigenvalues provide squared singular values:
     Eigen::VectorXf s = eig.eigenvalues();
-   
+
     // Marchenko-Pastur optimal threshold
     const double lam_r = s[0] / n;
     double clam = 0.0;
@@ -138,23 +154,27 @@ class DenoisingFunctor { MEMALIGN(DenoisingFunctor)
       if (sigsq2 < sigsq1) {
         sigma2 = sigsq1;
         cutoff_p = p+1;
-      } 
+      }
     }
 
+    const ssize_t centre = centre_index();
     if (cutoff_p > 0) {
-      // recombine data using only eigenvectors above threshold:
-      s.head (cutoff_p).setZero();
-      s.tail (r-cutoff_p).setOnes();
-      if (m <= n) 
-        X.col (n/2) = eig.eigenvectors() * ( s.asDiagonal() * ( eig.eigenvectors().adjoint() * X.col(n/2) ));
-      else 
-        X.col (n/2) = X * ( eig.eigenvectors() * ( s.asDiagonal() * eig.eigenvectors().adjoint().col(n/2) ));
+      // recombine data using only the eigenvectors above threshold;
+      //   typically few components carry signal, so project onto that
+      //   block alone rather than multiplying by the full basis:
+      const ssize_t q = r - cutoff_p;
+      if (m <= n)
+        Xc.noalias() = eig.eigenvectors().rightCols(q) * ( eig.eigenvectors().rightCols(q).adjoint() * X.col(centre) );
+      else
+        Xc.noalias() = X * ( eig.eigenvectors().rightCols(q) * eig.eigenvectors().adjoint().col(centre).tail(q) );
     }
+    else
+      Xc = X.col (centre);
 
     // Store output
     assign_pos_of(dwi).to(out);
     for (auto l = Loop (3) (out); l; ++l)
-      out.value() = X(out.index(3), n/2);
+      out.value() = Xc[out.index(3)];
 
     // store noise map if requested:
     if (noise.valid()) {
@@ -162,33 +182,96 @@ class DenoisingFunctor { MEMALIGN(DenoisingFunctor)
       noise.value() = value_type (std::sqrt(sigma2));
     }
   }
-  
-  
+
+
   void load_data (ImageType& dwi)
   {
-    pos[0] = dwi.index(0); pos[1] = dwi.index(1); pos[2] = dwi.index(2);
     X.setZero();
-    ssize_t k = 0;
     for (dwi.index(2) = pos[2]-extent[2]; dwi.index(2) <= pos[2]+extent[2]; ++dwi.index(2))
       for (dwi.index(1) = pos[1]-extent[1]; dwi.index(1) <= pos[1]+extent[1]; ++dwi.index(1))
-        for (dwi.index(0) = pos[0]-extent[0]; dwi.index(0) <= pos[0]+extent[0]; ++dwi.index(0), ++k)
+        for (dwi.index(0) = pos[0]-extent[0]; dwi.index(0) <= pos[0]+extent[0]; ++dwi.index(0))
           if (! is_out_of_bounds(dwi,0,3))
-            X.col(k) = dwi.row(3);
+            X.col (slot (dwi.index(0), dwi.index(1), dwi.index(2))) = dwi.row(3);
     // reset image position
     dwi.index(0) = pos[0];
     dwi.index(1) = pos[1];
     dwi.index(2) = pos[2];
+
+    if (m <= n)
+      XtX.template triangularView<Eigen::Lower>() = X * X.transpose();
+    else
+      XtX.noalias() = X.transpose() * X;
+    slides = 0;
   }
-  
+
+  void slide_window (ImageType& dwi)
+  {
+    // The patch columns are held in a layout circular along axis 0, so the
+    //   entering slab occupies exactly the slots vacated by the leaving one
+    ++slides;
+    const ssize_t x = pos[0] + extent[0];
+
+    if (m <= n) {
+      // downdate the covariance by the leaving columns before overwriting:
+      for (dwi.index(2) = pos[2]-extent[2]; dwi.index(2) <= pos[2]+extent[2]; ++dwi.index(2))
+        for (dwi.index(1) = pos[1]-extent[1]; dwi.index(1) <= pos[1]+extent[1]; ++dwi.index(1))
+          XtX.template selfadjointView<Eigen::Lower>().rankUpdate (X.col (slot (x, dwi.index(1), dwi.index(2))), -1.0f);
+    }
+
+    dwi.index(0) = x;
+    for (dwi.index(2) = pos[2]-extent[2]; dwi.index(2) <= pos[2]+extent[2]; ++dwi.index(2)) {
+      for (dwi.index(1) = pos[1]-extent[1]; dwi.index(1) <= pos[1]+extent[1]; ++dwi.index(1)) {
+        const ssize_t k = slot (x, dwi.index(1), dwi.index(2));
+        if (is_out_of_bounds (dwi, 0, 3))
+          X.col (k).setZero();
+        else
+          X.col (k) = dwi.row(3);
+      }
+    }
+
+    for (dwi.index(2) = pos[2]-extent[2]; dwi.index(2) <= pos[2]+extent[2]; ++dwi.index(2)) {
+      for (dwi.index(1) = pos[1]-extent[1]; dwi.index(1) <= pos[1]+extent[1]; ++dwi.index(1)) {
+        const ssize_t k = slot (x, dwi.index(1), dwi.index(2));
+        if (m <= n) {
+          XtX.template selfadjointView<Eigen::Lower>().rankUpdate (X.col(k), 1.0f);
+        } else {
+          // only the dot products involving the entering columns change:
+          dots.noalias() = X.transpose() * X.col(k);
+          XtX.col(k) = dots;
+          XtX.row(k) = dots.transpose();
+        }
+      }
+    }
+
+    // reset image position
+    dwi.index(0) = pos[0];
+    dwi.index(1) = pos[1];
+    dwi.index(2) = pos[2];
+  }
+
 private:
   const std::array<ssize_t, 3> extent;
   const ssize_t m, n, r;
   Eigen::MatrixXf X;
-  std::array<ssize_t, 3> pos;
+  Eigen::MatrixXf XtX;
+  Eigen::VectorXf Xc, dots;
+  std::array<ssize_t, 3> pos, prev;
+  size_t slides;
   double sigma2;
   Image<bool> mask;
   ImageType noise;
-  
+
+  // column slot of voxel (x,y,z) within the circular patch layout
+  ssize_t slot (const ssize_t x, const ssize_t y, const ssize_t z) const {
+    const ssize_t w0 = 2*extent[0]+1;
+    return ((x % w0) + w0) % w0
+        + w0 * ((y - (pos[1]-extent[1])) + (2*extent[1]+1) * (z - (pos[2]-extent[2])));
+  }
+
+  ssize_t centre_index () const {
+    return slot (pos[0], pos[1], pos[2]);
+  }
+
 };
 
 
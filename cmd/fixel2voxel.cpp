@@ -503,12 +503,16 @@ class SplitDir : protected Base
 
 void run ()
 {
-  auto in_data = Fixel::open_fixel_data_file<typename FixelDataType::value_type> (argument[0]);
+  // Load the fixel data and index with direct I/O: every voxel processed
+  //   involves an indirection through the index into the data file, and with
+  //   the reduction threaded these are best served as contiguous in-memory
+  //   reads rather than going through the buffered per-value access path
+  auto in_data = Fixel::open_fixel_data_file<typename FixelDataType::value_type> (argument[0]).with_direct_io();
   if (in_data.size(2) != 1)
     throw Exception ("Input fixel data file must have a single scalar value per fixel (i.e. have dimensions Nx1x1)");
 
   Header in_index_header = Fixel::find_index_header (Fixel::get_fixel_directory (argument[0]));
-  auto in_index_image = in_index_header.get_image<typename FixelIndexType::value_type>();
+  auto in_index_image = in_index_header.get_image<typename FixelIndexType::value_type>().with_direct_io (3);
 
   Image<float> in_directions;
 
@@ -550,7 +554,7 @@ void run ()
   FixelDataType in_vol;
   auto opt = get_options ("weighted");
   if (opt.size()) {
-    in_vol = FixelDataType::open (opt[0][0]);
+    in_vol = FixelDataType::open (opt[0][0]).with_direct_io();
     check_dimensions (in_data, in_vol);
   }
 
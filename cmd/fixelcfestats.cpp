@@ -332,23 +332,23 @@ void run() {
 #ifndef NDEBUG
           // Even if this fixel is within the mask, it should still not
           //   connect to any fixel that is outside the mask
-          mask.index(0) = it.first;
+          mask.index(0) = it.index();
           assert (mask.value());
 #endif
-          const connectivity_value_type connectivity = it.second.value / connectivity_value_type (fixel_TDI[fixel]);
+          const connectivity_value_type connectivity = it.value() / connectivity_value_type (fixel_TDI[fixel]);
           if (connectivity >= connectivity_threshold) {
             if (do_smoothing) {
-              const value_type distance = std::sqrt (Math::pow2 (positions[fixel][0] - positions[it.first][0]) +
-                                                     Math::pow2 (positions[fixel][1] - positions[it.first][1]) +
-                                                     Math::pow2 (positions[fixel][2] - positions[it.first][2]));
+              const value_type distance = std::sqrt (Math::pow2 (positions[fixel][0] - positions[it.index()][0]) +
+                                                     Math::pow2 (positions[fixel][1] - positions[it.index()][1]) +
+                                                     Math::pow2 (positions[fixel][2] - positions[it.index()][2]));
               const connectivity_value_type smoothing_weight = connectivity * gaussian_const1 * std::exp (-Math::pow2 (distance) / gaussian_const2);
               if (smoothing_weight >= connectivity_threshold) {
-                smoothing_weights[row].push_back (Stats::CFE::NormMatrixElement (fixel2row[it.first], smoothing_weight));
+                smoothing_weights[row].push_back (Stats::CFE::NormMatrixElement (fixel2row[it.index()], smoothing_weight));
                 sum_weights += smoothing_weight;
               }
             }
             // Here we pre-exponentiate each connectivity value by C
-            norm_connectivity_matrix[row].push_back (Stats::CFE::NormMatrixElement (fixel2row[it.first], std::pow (connectivity, cfe_c)));
+            norm_connectivity_matrix[row].push_back (Stats::CFE::NormMatrixElement (fixel2row[it.index()], std::pow (connectivity, cfe_c)));
           }
         }
 
@@ -363,7 +363,7 @@ void run() {
           i.normalise (norm_factor);
 
         // Force deallocation of memory used for this fixel in the original matrix
-        std::map<uint32_t, Stats::CFE::connectivity>().swap (connectivity_matrix[fixel]);
+        Stats::CFE::init_matrix_row_type().swap (connectivity_matrix[fixel]);
 
       } else {
 
@@ -15,6 +15,7 @@
 #include "command.h"
 #include "progressbar.h"
 #include "algo/loop.h"
+#include "algo/threaded_loop.h"
 #include "image.h"
 #include "fixel/helpers.h"
 #include "fixel/keys.h"
@@ -46,6 +47,79 @@ void usage ()
 }
 
 
+using direction_matrix_type = Eigen::Matrix<float, Eigen::Dynamic, 3>;
+
+
+// Load all fixel directions into memory as a contiguous matrix of unit
+//   vectors, so that the matching stage can evaluate whole voxels' worth of
+//   dot products as vectorised matrix-vector expressions rather than
+//   following per-fixel indirections into the data file
+direction_matrix_type load_directions (Image<float>& directions)
+{
+  direction_matrix_type result (directions.size(0), 3);
+  for (ssize_t i = 0; i != directions.size(0); ++i) {
+    directions.index(0) = i;
+    Eigen::Vector3f dir = directions.row(1);
+    dir.normalize();
+    result.row(i) = dir;
+  }
+  return result;
+}
+
+
+// Matches the template fixels of one voxel to the subject fixels of the same
+//   voxel; voxels are independent, and each template fixel maps to a unique
+//   location in the output data file, so these can safely run in parallel
+class CorrespondenceMapper { MEMALIGN(CorrespondenceMapper)
+  public:
+    CorrespondenceMapper (const direction_matrix_type& subject_dirs,
+                          const direction_matrix_type& template_dirs,
+                          const Image<float>& subject_data,
+                          const Image<float>& output_data,
+                          const float angular_threshold_dp) :
+        subject_dirs (subject_dirs),
+        template_dirs (template_dirs),
+        subject_data (subject_data),
+        output_data (output_data),
+        angular_threshold_dp (angular_threshold_dp) { }
+
+    void operator() (Image<uint32_t>& template_index, Image<uint32_t>& subject_index)
+    {
+      template_index.index(3) = 0;
+      const uint32_t nfixels_template = template_index.value();
+      template_index.index(3) = 1;
+      const uint32_t template_offset = template_index.value();
+
+      subject_index.index(3) = 0;
+      const uint32_t nfixels_subject = subject_index.value();
+      subject_index.index(3) = 1;
+      const uint32_t subject_offset = subject_index.value();
+
+      if (!nfixels_template || !nfixels_subject)
+        return;
+
+      const auto subject_block = subject_dirs.middleRows (subject_offset, nfixels_subject);
+      for (size_t t = 0; t < nfixels_template; ++t) {
+        const Eigen::VectorXf dp = (subject_block * template_dirs.row (template_offset + t).transpose()).cwiseAbs();
+        Eigen::Index index_of_closest_fixel = 0;
+        const float largest_dp = dp.maxCoeff (&index_of_closest_fixel);
+        if (largest_dp > angular_threshold_dp) {
+          output_data.index(0) = template_offset + t;
+          subject_data.index(0) = subject_offset + index_of_closest_fixel;
+          output_data.value() = subject_data.value();
+        }
+      }
+    }
+
+  private:
+    const direction_matrix_type& subject_dirs;
+    const direction_matrix_type& template_dirs;
+    Image<float> subject_data;
+    Image<float> output_data;
+    const float angular_threshold_dp;
+};
+
+
 void run ()
 {
   const float angular_threshold = get_option_value ("angle", DEFAULT_ANGLE_THRESHOLD);
@@ -75,42 +149,11 @@ void run ()
   output_data_header.size(1) = 1;
   auto output_data = Image<float>::create (Path::join (output_fixel_directory, argument[3]), output_data_header);
 
-  for (auto i = Loop ("mapping subject fixels data to template fixels", template_index, 0, 3)(template_index, subject_index); i; ++i) {
-    template_index.index(3) = 0;
-    uint32_t nfixels_template = template_index.value();
-    template_index.index(3) = 1;
-    uint32_t template_offset = template_index.value();
+  const direction_matrix_type subject_dirs = load_directions (subject_directions);
+  const direction_matrix_type template_dirs = load_directions (template_directions);
 
-    for (size_t t = 0; t < nfixels_template; ++t) {
-
-      float largest_dp = 0.0;
-      int index_of_closest_fixel = -1;
-
-      subject_index.index(3) = 0;
-      uint32_t nfixels_subject = subject_index.value();
-      subject_index.index(3) = 1;
-      uint32_t subject_offset = subject_index.value();
-
-      template_directions.index(0) = template_offset + t;
-      for (size_t s = 0; s < nfixels_subject; ++s) {
-        subject_directions.index(0) = subject_offset + s;
-
-        Eigen::Vector3f templatedir = template_directions.row(1);
-        templatedir.normalize();
-        Eigen::Vector3f subjectdir = subject_directions.row(1);
-        subjectdir.normalize();
-        float dp = std::abs (templatedir.dot (subjectdir));
-        if (dp > largest_dp) {
-          largest_dp = dp;
-          index_of_closest_fixel = s;
-        }
-      }
-      if (largest_dp > angular_threshold_dp) {
-        output_data.index(0) = template_offset + t;
-        subject_data.index(0) = subject_offset + index_of_closest_fixel;
-        output_data.value() = subject_data.value();
-      }
-    }
-  }
+  CorrespondenceMapper mapper (subject_dirs, template_dirs, subject_data, output_data, angular_threshold_dp);
+  ThreadedLoop ("mapping subject fixels data to template fixels", template_index, 0, 3)
+      .run (mapper, template_index, subject_index);
 }
 
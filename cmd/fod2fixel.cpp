@@ -89,6 +89,8 @@ void usage ()
 
   + FMLSSegmentOption
 
+  + FMLSCacheOption
+
   + Option ("nii", "output the directions and index file in nii format (instead of the default mif)")
 
   + Option ("dirpeak", "define the fixel direction as the peak lobe direction as opposed to the lobe mean");
@@ -335,13 +337,33 @@ void run ()
 
   Fixel::check_fixel_directory (fixel_directory_path, true, true);
 
-  FMLS::FODQueueWriter writer (fod_data, mask);
-
   const DWI::Directions::Set dirs (1281);
   Segmenter fmls (dirs, Math::SH::LforN (H.size(3)));
   load_fmls_thresholds (fmls);
 
-  Thread::run_queue (writer, Thread::batch (SH_coefs()), Thread::multi (fmls), Thread::batch (FOD_lobes()), receiver);
+  std::unique_ptr<Cache> cache;
+  opt = get_options ("fmls_cache");
+  if (opt.size())
+    cache.reset (new Cache (std::string (opt[0][0]), fod_data, fmls, mask));
+
+  if (cache && cache->ready()) {
+    ProgressBar progress ("reloading cached FOD segmentation");
+    FOD_lobes lobes;
+    while (cache->read (lobes)) {
+      receiver (lobes);
+      ++progress;
+    }
+  }
+  else if (cache) {
+    FMLS::FODQueueWriter writer (fod_data, mask);
+    CachingReceiver<Segmented_FOD_receiver> sink (*cache, receiver);
+    Thread::run_queue (writer, Thread::batch (SH_coefs()), Thread::multi (fmls), Thread::batch (FOD_lobes()), sink);
+    cache->commit ();
+  }
+  else {
+    FMLS::FODQueueWriter writer (fod_data, mask);
+    Thread::run_queue (writer, Thread::batch (SH_coefs()), Thread::multi (fmls), Thread::batch (FOD_lobes()), receiver);
+  }
   receiver.commit ();
 }
 
@@ -421,17 +421,40 @@ class BinaryEvaluator : public Evaluator { NOMEMALIGN
 
     virtual Chunk& evaluate (Chunk& a, Chunk& b) const {
       Chunk& out (a.size() ? a : b);
+      // resolve the chunk / constant distinction once per chunk rather than
+      //   per element, so that each loop below is tight enough for the
+      //   compiler to vectorise:
       if (operands[0].is_complex() || operands[1].is_complex()) {
-        for (size_t n = 0; n < out.size(); ++n) 
-          out[n] = op.Z (
-              a.size() ? a[n] : a.value, 
-              b.size() ? b[n] : b.value );
+        if (a.size() && b.size()) {
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.Z (a[n], b[n]);
+        }
+        else if (a.size()) {
+          const complex_type b_val (b.value);
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.Z (a[n], b_val);
+        }
+        else {
+          const complex_type a_val (a.value);
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.Z (a_val, b[n]);
+        }
       }
       else {
-        for (size_t n = 0; n < out.size(); ++n) 
-          out[n] = op.R (
-              a.size() ? a[n].real() : a.value.real(), 
-              b.size() ? b[n].real() : b.value.real() );
+        if (a.size() && b.size()) {
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.R (a[n].real(), b[n].real());
+        }
+        else if (a.size()) {
+          const real_type b_val (b.value.real());
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.R (a[n].real(), b_val);
+        }
+        else {
+          const real_type a_val (a.value.real());
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.R (a_val, b[n].real());
+        }
       }
       return out;
     }
@@ -455,19 +478,44 @@ class TernaryEvaluator : public Evaluator { NOMEMALIGN
 
     virtual Chunk& evaluate (Chunk& a, Chunk& b, Chunk& c) const {
       Chunk& out (a.size() ? a : (b.size() ? b : c));
+      // specialise the common patterns (all chunks; chunk with two
+      //   constants, e.g. "-if mask val1 val2") so their loops vectorise;
+      //   other combinations fall through to the generic loop:
       if (operands[0].is_complex() || operands[1].is_complex() || operands[2].is_complex()) {
-        for (size_t n = 0; n < out.size(); ++n) 
-          out[n] = op.Z (
-              a.size() ? a[n] : a.value,
-              b.size() ? b[n] : b.value,
-              c.size() ? c[n] : c.value );
+        if (a.size() && b.size() && c.size()) {
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.Z (a[n], b[n], c[n]);
+        }
+        else if (a.size() && !b.size() && !c.size()) {
+          const complex_type b_val (b.value), c_val (c.value);
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.Z (a[n], b_val, c_val);
+        }
+        else {
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.Z (
+                a.size() ? a[n] : a.value,
+                b.size() ? b[n] : b.value,
+                c.size() ? c[n] : c.value );
+        }
       }
       else {
-        for (size_t n = 0; n < out.size(); ++n) 
-          out[n] = op.R (
-              a.size() ? a[n].real() : a.value.real(), 
-              b.size() ? b[n].real() : b.value.real(), 
-              c.size() ? c[n].real() : c.value.real() );
+        if (a.size() && b.size() && c.size()) {
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.R (a[n].real(), b[n].real(), c[n].real());
+        }
+        else if (a.size() && !b.size() && !c.size()) {
+          const real_type b_val (b.value.real()), c_val (c.value.real());
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.R (a[n].real(), b_val, c_val);
+        }
+        else {
+          for (size_t n = 0; n < out.size(); ++n)
+            out[n] = op.R (
+                a.size() ? a[n].real() : a.value.real(),
+                b.size() ? b[n].real() : b.value.real(),
+                c.size() ? c[n].real() : c.value.real() );
+        }
       }
       return out;
     }
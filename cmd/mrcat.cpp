@@ -53,6 +53,73 @@ OPTIONS
 using value_type = float;
 
 
+namespace {
+
+  // Splice the raw data block of one input directly into the output region
+  //   starting at axis_offset along the concatenation axis, bypassing the
+  //   per-voxel conversion loop. This applies when input and output share
+  //   the on-file datatype and intensity scaling, the concatenation axis is
+  //   the slowest-varying axis of the output (so each input contributes one
+  //   contiguous block), and all other strides agree with no reversed axes.
+  //   Returns false (leaving the output untouched) when any of this does
+  //   not hold, in which case the caller falls back to the generic loop.
+  bool splice (Image<value_type>& in, Image<value_type>& out, const int axis, const int axis_offset)
+  {
+    if (in.is_direct_io() || out.is_direct_io())
+      return false;
+    const auto& hin (*in.buffer);
+    const auto& hout (*out.buffer);
+    if (hin.datatype() != hout.datatype() || hin.datatype() == DataType::Bit)
+      return false;
+    if (hin.intensity_offset() != hout.intensity_offset() || hin.intensity_scale() != hout.intensity_scale())
+      return false;
+
+    for (size_t n = 0; n < out.ndim(); ++n) {
+      if (out.stride (n) < 1)
+        return false;
+      if (int(n) == axis)
+        continue;
+      if (out.stride (n) > out.stride (axis))
+        return false;
+      if (out.size (n) != (n < in.ndim() ? in.size (n) : 1))
+        return false;
+      if (n < in.ndim() && in.stride (n) != out.stride (n))
+        return false;
+    }
+    for (size_t n = 0; n < in.ndim(); ++n) {
+      if (in.stride (n) < 1)
+        return false;
+    }
+    if (axis < int(in.ndim()) && in.stride (axis) != out.stride (axis))
+      return false;
+
+    // proceed segment by segment on whichever side next reaches a
+    //   boundary, so differing file segmentations are handled
+    const size_t value_bytes = hin.datatype().bytes();
+    ImageIO::Base* io_in (in.buffer->get_io());
+    ImageIO::Base* io_out (out.buffer->get_io());
+    const size_t in_segment_bytes = io_in->segment_size() * value_bytes;
+    const size_t out_segment_bytes = io_out->segment_size() * value_bytes;
+    size_t src_offset = 0;
+    size_t dest_offset = size_t (out.stride (axis)) * size_t (axis_offset) * value_bytes;
+    size_t remaining = voxel_count (in) * value_bytes;
+    while (remaining) {
+      const size_t in_seg = src_offset / in_segment_bytes;
+      const size_t in_within = src_offset - in_seg*in_segment_bytes;
+      const size_t out_seg = dest_offset / out_segment_bytes;
+      const size_t out_within = dest_offset - out_seg*out_segment_bytes;
+      const size_t n = std::min (remaining, std::min (in_segment_bytes - in_within, out_segment_bytes - out_within));
+      memcpy (io_out->segment (out_seg) + out_within, io_in->segment (in_seg) + in_within, n);
+      src_offset += n;
+      dest_offset += n;
+      remaining -= n;
+    }
+    return true;
+  }
+
+}
+
+
 void run () {
   int axis = get_option_value ("axis", -1);
 
@@ -181,14 +248,19 @@ void run () {
   for (int i = 0; i < num_images; i++) {
     auto image_in = in[i].get_image<value_type>();
 
-    auto copy_func = [&axis, &axis_offset](decltype(image_in)& in, decltype(image_out)& out)
-    {
-      out.index (axis) = axis < int(in.ndim()) ? in.index (axis) + axis_offset : axis_offset;
-      out.value() = in.value();
-    };
-
-    ThreadedLoop ("concatenating \"" + image_in.name() + "\"", image_in, 0, std::min<size_t> (image_in.ndim(), image_out.ndim()))
-      .run (copy_func, image_in, image_out);
+    if (splice (image_in, image_out, axis, axis_offset)) {
+      INFO ("spliced \"" + image_in.name() + "\" into output as a raw data block");
+    }
+    else {
+      auto copy_func = [&axis, &axis_offset](decltype(image_in)& in, decltype(image_out)& out)
+      {
+        out.index (axis) = axis < int(in.ndim()) ? in.index (axis) + axis_offset : axis_offset;
+        out.value() = in.value();
+      };
+
+      ThreadedLoop ("concatenating \"" + image_in.name() + "\"", image_in, 0, std::min<size_t> (image_in.ndim(), image_out.ndim()))
+        .run (copy_func, image_in, image_out);
+    }
     if (axis < int(image_in.ndim()))
       axis_offset += image_in.size (axis);
     else {
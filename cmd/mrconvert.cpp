@@ -17,6 +17,7 @@
 #include "image.h"
 #include "phase_encoding.h"
 #include "transform.h"
+#include "algo/stream_copy.h"
 #include "algo/threaded_copy.h"
 #include "adapter/extract.h"
 #include "adapter/permute_axes.h"
@@ -228,8 +229,24 @@ inline void copy_permute (Header& header_in, Header& header_out, const vector<ve
     DWI::export_grad_commandline (out);
     PhaseEncoding::export_commandline (out);
 
-    auto perm = Adapter::make <Adapter::PermuteAxes> (in, axes);
-    threaded_copy_with_progress (perm, out, 0, std::numeric_limits<size_t>::max(), 2);
+    bool identity = true;
+    for (size_t n = 0; n < axes.size(); ++n) {
+      if (axes[n] != int(n)) {
+        identity = false;
+        break;
+      }
+    }
+    if (identity) {
+      // no extraction or axis permutation required: this is a plain copy
+      //   (datatype and/or format conversion), which can stream through
+      //   bounded slab buffers with prefetch rather than traversing both
+      //   images voxel-by-voxel
+      stream_copy_with_progress_message ("copying from \"" + shorten (in.name()) + "\" to \"" + shorten (out.name()) + "\"", in, out);
+    }
+    else {
+      auto perm = Adapter::make <Adapter::PermuteAxes> (in, axes);
+      threaded_transpose_copy_with_progress (perm, out);
+    }
 
   } else {
 
@@ -239,8 +256,22 @@ inline void copy_permute (Header& header_in, Header& header_out, const vector<ve
     DWI::export_grad_commandline (out);
     PhaseEncoding::export_commandline (out);
 
-    auto perm = Adapter::make <Adapter::PermuteAxes> (extract, axes);
-    threaded_copy_with_progress (perm, out, 0, std::numeric_limits<size_t>::max(), 2);
+    bool identity = true;
+    for (size_t n = 0; n < axes.size(); ++n) {
+      if (axes[n] != int(n)) {
+        identity = false;
+        break;
+      }
+    }
+    if (identity) {
+      // no axis permutation required: copy through the extraction adapter
+      //   directly, so that contiguous runs can be block-copied
+      threaded_copy_with_progress (extract, out);
+    }
+    else {
+      auto perm = Adapter::make <Adapter::PermuteAxes> (extract, axes);
+      threaded_transpose_copy_with_progress (perm, out);
+    }
 
   }
 
@@ -56,6 +56,67 @@ void usage ()
 
 
 
+namespace {
+
+  // When the crop leaves every axis except the slowest-varying one
+  //   untouched, the cropped region is a single contiguous range of the
+  //   input's storage, which can be copied between the IO buffers in bulk
+  //   rather than voxel by voxel - the common case of trimming end volumes
+  //   from a long 4D series. Returns false (leaving the output untouched)
+  //   if the crop does not qualify, in which case the caller performs the
+  //   generic adapter copy.
+  bool crop_splice (Image<float>& in, Image<float>& out, const vector<size_t>& from)
+  {
+    if (in.is_direct_io() || out.is_direct_io())
+      return false;
+    const auto& hin (*in.buffer);
+    const auto& hout (*out.buffer);
+    if (hin.datatype() != hout.datatype() || hin.datatype() == DataType::Bit)
+      return false;
+    if (hin.intensity_offset() != hout.intensity_offset() || hin.intensity_scale() != hout.intensity_scale())
+      return false;
+
+    size_t slowest = 0;
+    for (size_t n = 0; n < in.ndim(); ++n) {
+      if (in.stride (n) < 1 || out.stride (n) != in.stride (n))
+        return false;
+      if (in.stride (n) > in.stride (slowest))
+        slowest = n;
+    }
+    for (size_t n = 0; n < in.ndim(); ++n) {
+      if (n != slowest && (from[n] || out.size (n) != in.size (n)))
+        return false;
+    }
+
+    // proceed segment by segment on whichever side next reaches a
+    //   boundary, so differing file segmentations are handled
+    const size_t value_bytes = hin.datatype().bytes();
+    ImageIO::Base* io_in (in.buffer->get_io());
+    ImageIO::Base* io_out (out.buffer->get_io());
+    const size_t in_segment_bytes = io_in->segment_size() * value_bytes;
+    const size_t out_segment_bytes = io_out->segment_size() * value_bytes;
+    size_t src_offset = size_t (in.stride (slowest)) * from[slowest] * value_bytes;
+    size_t dest_offset = 0;
+    size_t remaining = voxel_count (out) * value_bytes;
+    while (remaining) {
+      const size_t in_seg = src_offset / in_segment_bytes;
+      const size_t in_within = src_offset - in_seg*in_segment_bytes;
+      const size_t out_seg = dest_offset / out_segment_bytes;
+      const size_t out_within = dest_offset - out_seg*out_segment_bytes;
+      const size_t n = std::min (remaining, std::min (in_segment_bytes - in_within, out_segment_bytes - out_within));
+      memcpy (io_out->segment (out_seg) + out_within, io_in->segment (in_seg) + in_within, n);
+      src_offset += n;
+      dest_offset += n;
+      remaining -= n;
+    }
+    return true;
+  }
+
+}
+
+
+
+
 void run ()
 {
 
@@ -136,6 +197,11 @@ void run ()
 
   auto cropped = Adapter::make<Adapter::Subset> (in, from, size);
   auto out = Image<float>::create (argument[1], cropped);
-  threaded_copy_with_progress_message ("cropping image...", cropped, out);
+  if (crop_splice (in, out, from)) {
+    INFO ("cropped region copied as a single raw data block");
+  }
+  else {
+    threaded_copy_with_progress_message ("cropping image...", cropped, out);
+  }
 }
 
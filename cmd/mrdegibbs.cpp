@@ -131,13 +131,16 @@ class ComputeSlice
     const vector<size_t>& outer_axes;
     const vector<size_t>& slice_axes;
     const int nsh, minW, maxW;
-    Image<value_type> in, out; 
+    Image<value_type> in, out;
+    // the FFT object caches its plans by transform size, so all slices
+    //   handled by this thread re-use the plans set up for the first one
     Eigen::FFT<double> fft;
-    Eigen::MatrixXcd im1, im2, shifted;
+    Eigen::MatrixXcd im1, im2, shifted, tbuf;
     Eigen::VectorXcd v;
 
     void prealloc_FFT () {
-      // needed to avoid within-thread allocations, 
+      v.resize (std::max (im1.rows(), im1.cols()));
+      // needed to avoid within-thread allocations,
       // which aren't thread-safe in FFTW:
 #ifdef EIGEN_FFTW_DEFAULT
       Eigen::VectorXcd tmp (im1.rows());
@@ -146,17 +149,33 @@ class ComputeSlice
       tmp.resize (im1.cols());
       FFT (tmp);
       iFFT (tmp);
+      tbuf.resize (im1.cols(), im1.rows());
 #endif
     }
 
-    template <typename Derived> FORCE_INLINE void FFT      (Eigen::MatrixBase<Derived>&& vec) { fft.fwd (v, vec); vec = v; }
-    template <typename Derived> FORCE_INLINE void FFT      (Eigen::MatrixBase<Derived>& vec) { FFT (std::move (vec)); }
-    template <typename Derived> FORCE_INLINE void iFFT     (Eigen::MatrixBase<Derived>&& vec) { fft.inv (v, vec); vec = v; } 
-    template <typename Derived> FORCE_INLINE void iFFT     (Eigen::MatrixBase<Derived>& vec) { iFFT (std::move (vec)); }
-    template <typename Derived> FORCE_INLINE void row_FFT  (Eigen::MatrixBase<Derived>& mat) { for (auto n = 0; n < mat.rows(); ++n)  FFT (mat.row(n)); } 
-    template <typename Derived> FORCE_INLINE void row_iFFT (Eigen::MatrixBase<Derived>& mat) { for (auto n = 0; n < mat.rows(); ++n) iFFT (mat.row(n)); }
-    template <typename Derived> FORCE_INLINE void col_FFT  (Eigen::MatrixBase<Derived>& mat) { for (auto n = 0; n < mat.cols(); ++n)  FFT (mat.col(n)); } 
-    template <typename Derived> FORCE_INLINE void col_iFFT (Eigen::MatrixBase<Derived>& mat) { for (auto n = 0; n < mat.cols(); ++n) iFFT (mat.col(n)); }
+    FORCE_INLINE void FFT  (Eigen::VectorXcd& vec) { fft.fwd (v.data(), vec.data(), vec.size()); vec = v.head (vec.size()); }
+    FORCE_INLINE void iFFT (Eigen::VectorXcd& vec) { fft.inv (v.data(), vec.data(), vec.size()); vec = v.head (vec.size()); }
+
+    // transform the columns in place via the raw-pointer plan interface:
+    //   the columns are contiguous in memory, so this involves no strided
+    //   copies or per-line temporaries
+    FORCE_INLINE void col_FFT (Eigen::MatrixXcd& mat) {
+      for (ssize_t n = 0; n < mat.cols(); ++n) {
+        fft.fwd (v.data(), mat.col(n).data(), mat.rows());
+        mat.col(n) = v.head (mat.rows());
+      }
+    }
+    FORCE_INLINE void col_iFFT (Eigen::MatrixXcd& mat) {
+      for (ssize_t n = 0; n < mat.cols(); ++n) {
+        fft.inv (v.data(), mat.col(n).data(), mat.rows());
+        mat.col(n) = v.head (mat.rows());
+      }
+    }
+    // row-wise transforms run on the transpose, batching the strided
+    //   accesses into the two transpose passes rather than paying them
+    //   once per line
+    FORCE_INLINE void row_FFT  (Eigen::MatrixXcd& mat) { tbuf = mat.transpose(); col_FFT  (tbuf); mat = tbuf.transpose(); }
+    FORCE_INLINE void row_iFFT (Eigen::MatrixXcd& mat) { tbuf = mat.transpose(); col_iFFT (tbuf); mat = tbuf.transpose(); }
 
 
 
@@ -100,8 +100,14 @@ void run ()
   auto H = Header::open (argument[0]);
   auto in = H.get_image<float> (inplace); // Need to set read/write flag
   Image<float> out;
+  ImageIO::Base* io = nullptr;
   if (inplace) {
     out = Image<float> (in);
+    // edits are sparse relative to the image: declare each modified voxel
+    //   so that write-back (where one is needed at all) covers only the
+    //   touched region rather than rewriting the whole image
+    io = out.buffer->get_io();
+    io->restrict_writeback();
   } else {
     if (std::string(argument[1]) == std::string(argument[0])) // Not ideal test - could be different paths to the same file
       throw Exception ("Do not provide same image as input and output; instad specify image to be edited in-place");
@@ -109,6 +115,18 @@ void run ()
     copy (in, out);
   }
 
+  const bool bitwise = (H.datatype() == DataType::Bit);
+  const int64_t value_bytes = H.datatype().bytes();
+  auto touched = [&]()
+  {
+    if (!io)
+      return;
+    if (bitwise)
+      io->mark_modified (out.offset()/8, 1);
+    else
+      io->mark_modified (out.offset() * value_bytes, value_bytes);
+  };
+
   Transform transform (H);
   const bool scanner = get_options ("scanner").size();
   if (scanner && H.ndim() < 3)
@@ -132,8 +150,10 @@ void run ()
     for (auto c : coords) {
       out.index (axis) = c;
       for (auto outer = Loop(loop_axes[0]) (out); outer; ++outer) {
-        for (auto inner = Loop(loop_axes[1]) (out); inner; ++inner)
+        for (auto inner = Loop(loop_axes[1]) (out); inner; ++inner) {
           out.value() = value;
+          touched();
+        }
       }
     }
   }
@@ -168,6 +188,7 @@ void run ()
         if (!is_out_of_bounds (H, v)) {
           assign_pos_of (v).to (out);
           out.value() = value;
+          touched();
         }
         for (size_t i = 0; i != 6; ++i) {
           const Vox v_adj (v + voxel_offsets[i]);
@@ -205,6 +226,7 @@ void run ()
       }
     }
     out.value() = value;
+    touched();
   }
 
   if (!operation_count) {
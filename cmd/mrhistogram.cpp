@@ -16,6 +16,7 @@
 #include "header.h"
 #include "image.h"
 #include "algo/histogram.h"
+#include "algo/threaded_loop.h"
 
 using namespace MR;
 using namespace App;
@@ -77,18 +78,20 @@ class Volume_loop { MEMALIGN(Volume_loop)
 
 
 
-template <class Functor>
-void run_volume (Functor& functor, Image<float>& data, Image<bool>& mask)
+void run_volume (Algo::Histogram::Calibrator& calibrator, Image<float>& data, Image<bool>& mask)
 {
-  if (mask.valid()) {
-    for (auto l = Loop(0,3) (data, mask); l; ++l) {
-      if (mask.value())
-        functor (float(data.value()));
-    }
-  } else {
-    for (auto l = Loop(0,3) (data); l; ++l)
-      functor (float(data.value()));
-  }
+  if (mask.valid())
+    ThreadedLoop (data, 0, 3).run (Algo::Histogram::CalibratorKernel (calibrator), data, mask);
+  else
+    ThreadedLoop (data, 0, 3).run (Algo::Histogram::CalibratorKernel (calibrator), data);
+}
+
+void run_volume (Algo::Histogram::Data& histogram, Image<float>& data, Image<bool>& mask)
+{
+  if (mask.valid())
+    ThreadedLoop (data, 0, 3).run (Algo::Histogram::DataKernel (histogram), data, mask);
+  else
+    ThreadedLoop (data, 0, 3).run (Algo::Histogram::DataKernel (histogram), data);
 }
 
 
@@ -176,20 +176,24 @@ class NORM2 { NOMEMALIGN
 
 class Var { NOMEMALIGN
   public:
-    Var () : sum (0.0), sum_sqr (0.0), count (0) { }
-    void operator() (value_type val) { 
+    Var () : mean (0.0), m2 (0.0), count (0) { }
+    void operator() (value_type val) {
       if (std::isfinite (val)) {
-        sum += val;
-        sum_sqr += Math::pow2 (val);
+        // Welford's online algorithm: unlike the sum & sum-of-squares
+        //   formulation, this does not suffer catastrophic cancellation
+        //   when the variance is small relative to the mean
         ++count;
+        const double delta = val - mean;
+        mean += delta / static_cast<double> (count);
+        m2 += delta * (val - mean);
       }
     }
-    value_type result () const { 
-      if (count < 2) 
+    value_type result () const {
+      if (count < 2)
         return NAN;
-      return  (sum_sqr - Math::pow2 (sum) / static_cast<double> (count)) / (static_cast<double> (count) - 1.0);
+      return m2 / (static_cast<double> (count) - 1.0);
     }
-    double sum, sum_sqr;
+    double mean, m2;
     size_t count;
 };
 
@@ -330,6 +334,41 @@ class ImageKernel : public ImageKernelBase { NOMEMALIGN
 
 
 
+// The median cannot be computed by accumulating one input image at a time:
+//   collecting every value at every voxel requires memory proportional to
+//   voxel count times image count. Instead, keep all inputs open
+//   (memory-mapped, so resident memory is managed by the OS) and gather the
+//   values for one voxel at a time into a small re-usable buffer; each
+//   thread receives its own copy of this class, so memory use is bounded by
+//   the number of inputs times the number of threads
+class MedianImageKernel { NOMEMALIGN
+  public:
+    MedianImageKernel (vector<Header>& headers) {
+      inputs.reserve (headers.size());
+      for (auto& header : headers)
+        inputs.push_back (header.get_image<value_type>());
+      values.reserve (inputs.size());
+    }
+
+    void operator() (Image<value_type>& out) {
+      values.clear();
+      for (auto& in : inputs) {
+        assign_pos_of (out).to (in);
+        const value_type val = in.value();
+        if (!std::isnan (val))
+          values.push_back (val);
+      }
+      out.value() = Math::median (values);
+    }
+
+  protected:
+    vector<Image<value_type>> inputs;
+    vector<value_type> values;
+};
+
+
+
+
 void run ()
 {
   const size_t num_inputs = argument.size() - 2;
@@ -424,11 +463,20 @@ void run ()
     header.keyval().erase ("dw_scheme");
     PhaseEncoding::clear_scheme (header);
 
+    // The median is handled separately, since it cannot be computed by
+    //   per-image accumulation
+    if (op == 1) {
+      MedianImageKernel median_kernel (headers_in);
+      auto out = Header::create (output_path, header).get_image<value_type>();
+      ThreadedLoop (std::string("computing median across ") + str(headers_in.size()) + " images", out)
+        .run (median_kernel, out);
+      return;
+    }
+
     // Instantiate a kernel depending on the operation requested
     std::unique_ptr<ImageKernelBase> kernel;
     switch (op) {
       case 0:  kernel.reset (new ImageKernel<Mean>    (header)); break;
-      case 1:  kernel.reset (new ImageKernel<Median>  (header)); break;
       case 2:  kernel.reset (new ImageKernel<Sum>     (header)); break;
       case 3:  kernel.reset (new ImageKernel<Product> (header)); break;
       case 4:  kernel.reset (new ImageKernel<RMS>     (header)); break;
@@ -12,6 +12,8 @@
  */
 
 
+#include <mutex>
+
 #include "command.h"
 #include "image.h"
 #include "algo/loop.h"
@@ -76,6 +78,81 @@ void reslice(size_t interp, ImageType1& input, ImageType2& output, const Transfo
   }
 }
 
+// Accumulates the squared differences over one thread's share of the voxel
+//   grid; per-thread partial sums are merged into the shared totals on
+//   destruction, so the only synchronisation cost is one mutex acquisition
+//   per thread. Volumes of a 4D image pair are accumulated as vectorised
+//   Eigen array expressions over the (contiguous) volume axis.
+template <class InType1, class InType2, class MaskType1, class MaskType2>
+  class MeanSquaredKernel { MEMALIGN(MeanSquaredKernel<InType1,InType2,MaskType1,MaskType2>)
+    public:
+      using value_type = typename InType1::value_type;
+
+      MeanSquaredKernel (const MaskType1& in1mask,
+                         const MaskType2& in2mask,
+                         const bool use_mask1,
+                         const bool use_mask2,
+                         const size_t dimensions,
+                         ssize_t& global_n_voxels,
+                         Eigen::VectorXd& global_sos,
+                         std::mutex& mutex) :
+          in1mask (in1mask), in2mask (in2mask),
+          use_mask1 (use_mask1), use_mask2 (use_mask2),
+          dimensions (dimensions),
+          global_n_voxels (global_n_voxels), global_sos (global_sos), mutex (mutex),
+          n_voxels (0),
+          sos (Eigen::Matrix<value_type, Eigen::Dynamic, 1>::Zero (global_sos.size())),
+          a (global_sos.size()), b (global_sos.size()) { }
+
+      MeanSquaredKernel (const MeanSquaredKernel& that) :
+          in1mask (that.in1mask), in2mask (that.in2mask),
+          use_mask1 (that.use_mask1), use_mask2 (that.use_mask2),
+          dimensions (that.dimensions),
+          global_n_voxels (that.global_n_voxels), global_sos (that.global_sos), mutex (that.mutex),
+          n_voxels (0),
+          sos (Eigen::Matrix<value_type, Eigen::Dynamic, 1>::Zero (that.sos.size())),
+          a (that.sos.size()), b (that.sos.size()) { }
+
+      ~MeanSquaredKernel () {
+        std::lock_guard<std::mutex> lock (mutex);
+        global_n_voxels += n_voxels;
+        global_sos += sos.template cast<double>();
+      }
+
+      void operator() (InType1& in1, InType2& in2)
+      {
+        if (use_mask1) {
+          assign_pos_of (in1, 0, 3).to (in1mask);
+          if (!in1mask.value())
+            return;
+        }
+        if (use_mask2) {
+          assign_pos_of (in2, 0, 3).to (in2mask);
+          if (!in2mask.value())
+            return;
+        }
+        ++n_voxels;
+        if (dimensions == 3) {
+          meansquared<value_type>(in1.value(), in2.value(), sos);
+        } else { // 4D
+          a = in1.row(3);
+          b = in2.row(3);
+          meansquared<value_type>(a, b, sos);
+        }
+      }
+
+    private:
+      MaskType1 in1mask;
+      MaskType2 in2mask;
+      const bool use_mask1, use_mask2;
+      const size_t dimensions;
+      ssize_t& global_n_voxels;
+      Eigen::VectorXd& global_sos;
+      std::mutex& mutex;
+      ssize_t n_voxels;
+      Eigen::Matrix<value_type, Eigen::Dynamic, 1> sos, a, b;
+  };
+
 template <class InType1, class InType2, class MaskType1, class MaskType2>
   void evaluate_voxelwise_msq ( InType1& in1,
                             InType2& in2,
@@ -87,77 +164,15 @@ template <class InType1, class InType2, class MaskType1, class MaskType2>
                             ssize_t& n_voxels,
                             Eigen::VectorXd& sos) {
 
-    using value_type = typename InType1::value_type;
-
-    if (use_mask1 or use_mask2)
-      n_voxels = 0;
-    if (use_mask1 and use_mask2) {
-      if (dimensions == 3) {
-        for (auto i = Loop() (in1, in2, in1mask, in2mask); i ;++i)
-          if (in1mask.value() and in2mask.value()) {
-            ++n_voxels;
-            meansquared<value_type>(in1.value(), in2.value(), sos);
-          }
-      } else { // 4D
-        Eigen::Matrix<value_type,Eigen::Dynamic,1> a (in1.size(3)), b (in2.size(3));
-        for (auto i = Loop(0, 3) (in1, in2, in1mask, in2mask); i ;++i) {
-          if (in1mask.value() and in2mask.value()) {
-            ++n_voxels;
-            a = in1.row(3);
-            b = in2.row(3);
-            meansquared<value_type>(a, b, sos);
-          }
-        }
-      }
-    } else if (use_mask1) {
-      if (dimensions == 3) {
-        for (auto i = Loop() (in1, in2, in1mask); i ;++i)
-          if (in1mask.value()){
-            ++n_voxels;
-            meansquared<value_type>(in1.value(), in2.value(), sos);
-          }
-      } else { // 4D
-        Eigen::Matrix<value_type,Eigen::Dynamic,1> a (in1.size(3)), b (in2.size(3));
-        for (auto i = Loop(0, 3) (in1, in2, in1mask); i ;++i) {
-          if (in1mask.value()){
-            ++n_voxels;
-            a = in1.row(3);
-            b = in2.row(3);
-            meansquared<value_type>(a, b, sos);
-          }
-        }
-      }
-    } else if (use_mask2) {
-      if (dimensions == 3) {
-        for (auto i = Loop() (in1, in2, in2mask); i ;++i)
-          if (in2mask.value()){
-            ++n_voxels;
-            meansquared<value_type>(in1.value(), in2.value(), sos);
-          }
-      } else { // 4D
-        Eigen::Matrix<value_type,Eigen::Dynamic,1> a (in1.size(3)), b (in2.size(3));
-        for (auto i = Loop(0, 3) (in1, in2, in2mask); i ;++i) {
-          if (in2mask.value()){
-            ++n_voxels;
-            a = in1.row(3);
-            b = in2.row(3);
-            meansquared<value_type>(a, b, sos);
-          }
-        }
-      }
-    } else {
-      if (dimensions == 3) {
-        for (auto i = Loop() (in1, in2); i ;++i)
-          meansquared<value_type>(in1.value(), in2.value(), sos);
-      } else { // 4D
-        Eigen::Matrix<value_type,Eigen::Dynamic,1> a (in1.size(3)), b (in2.size(3));
-        for (auto i = Loop(0, 3) (in1, in2); i ;++i) {
-          a = in1.row(3);
-          b = in2.row(3);
-          meansquared<value_type>(a, b, sos);
-        }
-      }
+    ssize_t count (0);
+    std::mutex mutex;
+    {
+      MeanSquaredKernel<InType1, InType2, MaskType1, MaskType2> kernel
+        (in1mask, in2mask, use_mask1, use_mask2, dimensions, count, sos, mutex);
+      ThreadedLoop (in1, 0, 3).run (kernel, in1, in2);
     }
+    if (use_mask1 or use_mask2)
+      n_voxels = count;
   }
 
 enum MetricType {MeanSquared, CrossCorrelation};
@@ -171,11 +186,15 @@ void usage ()
   SYNOPSIS = "Computes a dissimilarity metric between two images";
 
   DESCRIPTION
-  + "Currently only the mean squared difference is implemented.";
+  + "Currently only the mean squared difference is implemented."
+
+  + "If multiple comparison images are provided, the metric is computed between "
+    "the first image and each of them in turn, with one line of output per pair; "
+    "the first image is only read once.";
 
   ARGUMENTS
   + Argument ("image1", "the first input image.").type_image_in ()
-  + Argument ("image2", "the second input image.").type_image_in ();
+  + Argument ("image2", "the second input image.").type_image_in ().allow_multiple ();
 
   OPTIONS
   + Option ("space",
@@ -212,33 +231,18 @@ void usage ()
 using value_type = double;
 using MaskType = Image<bool>;
 
-void run ()
+void evaluate_pair (Image<value_type>& input1,
+                    Image<value_type>& input2,
+                    MaskType& mask1,
+                    MaskType& mask2,
+                    const bool use_mask1,
+                    const bool use_mask2,
+                    const int space,
+                    const int interp,
+                    const MetricType metric_type,
+                    const bool nonormalisation,
+                    const bool show_overlap)
 {
-  int space = 0;  // voxel
-  auto opt = get_options ("space");
-  if (opt.size())
-    space = opt[0][0];
-
-  int interp = 1;  // linear
-  opt = get_options ("interp");
-  if (opt.size())
-    interp = opt[0][0];
-
-  MetricType metric_type = MetricType::MeanSquared;
-  opt = get_options ("metric");
-  if (opt.size()) {
-    if (int(opt[0][0]) == 1) { // CC
-      if (space != 3)
-        throw Exception ("CC metric only implemented for use in average space");
-      if (interp != 1 and interp != 2)
-        throw Exception ("CC metric only implemented for use with linear and cubic interpolation");
-      metric_type = MetricType::CrossCorrelation;
-    }
-  }
-
-  auto input1 = Image<value_type>::open (argument[0]).with_direct_io (Stride::contiguous_along_axis (3));
-  auto input2 = Image<value_type>::open (argument[1]).with_direct_io (Stride::contiguous_along_axis (3));
-
   const size_t dimensions = input1.ndim();
   if (input1.ndim() != input2.ndim())
     throw Exception ("both images have to have the same number of dimensions");
@@ -257,23 +261,6 @@ void run ()
   }
   INFO ("volumes: " + str(volumes));
 
-  MaskType mask1;
-  bool use_mask1 = get_options ("mask1").size()==1;
-  if (use_mask1) {
-    mask1 = Image<bool>::open (get_options ("mask1")[0][0]);
-    if (mask1.ndim() != 3) throw Exception ("mask has to be 3D");
-  }
-
-  MaskType mask2;
-  bool use_mask2 = get_options ("mask2").size()==1;
-  if (use_mask2){
-    mask2 = Image<bool>::open (get_options ("mask2")[0][0]);
-    if (mask2.ndim() != 3) throw Exception ("mask has to be 3D");
-  }
-
-  bool nonormalisation = false;
-  if (get_options ("nonormalisation").size())
-    nonormalisation = true;
   ssize_t n_voxels = input1.size(0) * input1.size(1) * input1.size(2);
 
   value_type out_of_bounds_value = 0.0;
@@ -476,8 +463,62 @@ void run ()
     sos.array() /= static_cast<value_type>(n_voxels);
   std::cout << str(sos.transpose());
 
-  if (get_options ("overlap").size())
+  if (show_overlap)
     std::cout << " " << str(n_voxels);
   std::cout << std::endl;
 }
 
+void run ()
+{
+  int space = 0;  // voxel
+  auto opt = get_options ("space");
+  if (opt.size())
+    space = opt[0][0];
+
+  int interp = 1;  // linear
+  opt = get_options ("interp");
+  if (opt.size())
+    interp = opt[0][0];
+
+  MetricType metric_type = MetricType::MeanSquared;
+  opt = get_options ("metric");
+  if (opt.size()) {
+    if (int(opt[0][0]) == 1) { // CC
+      if (space != 3)
+        throw Exception ("CC metric only implemented for use in average space");
+      if (interp != 1 and interp != 2)
+        throw Exception ("CC metric only implemented for use with linear and cubic interpolation");
+      metric_type = MetricType::CrossCorrelation;
+    }
+  }
+
+  MaskType mask1;
+  bool use_mask1 = get_options ("mask1").size()==1;
+  if (use_mask1) {
+    mask1 = Image<bool>::open (get_options ("mask1")[0][0]);
+    if (mask1.ndim() != 3) throw Exception ("mask has to be 3D");
+  }
+
+  MaskType mask2;
+  bool use_mask2 = get_options ("mask2").size()==1;
+  if (use_mask2){
+    mask2 = Image<bool>::open (get_options ("mask2")[0][0]);
+    if (mask2.ndim() != 3) throw Exception ("mask has to be 3D");
+  }
+
+  bool nonormalisation = false;
+  if (get_options ("nonormalisation").size())
+    nonormalisation = true;
+  const bool show_overlap = get_options ("overlap").size();
+
+  // image1 is opened (and, given direct I/O, read into memory) only once,
+  //   however many comparison images follow it on the command line
+  auto input1 = Image<value_type>::open (argument[0]).with_direct_io (Stride::contiguous_along_axis (3));
+
+  for (size_t pair_index = 1; pair_index < argument.size(); ++pair_index) {
+    auto input2 = Image<value_type>::open (argument[pair_index]).with_direct_io (Stride::contiguous_along_axis (3));
+    evaluate_pair (input1, input2, mask1, mask2, use_mask1, use_mask2,
+                   space, interp, metric_type, nonormalisation, show_overlap);
+  }
+}
+
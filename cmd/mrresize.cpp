@@ -56,6 +56,11 @@ void usage ()
             "set the interpolation method to use when resizing (choices: nearest, linear, cubic, sinc. Default: cubic).")
   + Argument ("method").type_choice (interp_choices)
 
+  + Option ("antialias",
+            "apply Gaussian anti-aliasing filtering when down-sampling. Where the resize is a "
+            "pure axis-aligned down-sampling, the filtering and decimation are fused into a "
+            "single pass per axis, avoiding the full-resolution smoothed intermediate.")
+
   + DataType::options();
 }
 
@@ -105,6 +110,8 @@ void run () {
     resize_filter.set_interp_type (interp);
   }
 
+  resize_filter.set_antialiasing (get_options ("antialias").size());
+
   if (!resize_option_count)
     throw Exception ("please use either the -scale, -voxel, or -resolution option to resize the image");
   if (resize_option_count != 1)
@@ -13,6 +13,7 @@
 
 
 #include <iomanip>
+#include <mutex>
 
 #include "command.h"
 #include "datatype.h"
@@ -24,6 +25,7 @@
 
 #include "algo/histogram.h"
 #include "algo/loop.h"
+#include "algo/threaded_loop.h"
 #include "file/ofstream.h"
 
 
@@ -94,17 +96,45 @@ class Volume_loop
 
 
 
-void run_volume (Stats::Stats& stats, Image<complex_type>& data, Image<bool>& mask)
-{
-  if (mask.valid()) {
-    for (auto l = Loop(0,3) (data, mask); l; ++l) {
+// each thread accumulates into its own Stats instance, which is merged
+//   into the shared result on destruction
+class StatsKernel
+{ NOMEMALIGN
+  public:
+    StatsKernel (Stats::Stats& overall, const bool is_complex, const bool ignorezero) :
+        overall (overall),
+        local (is_complex, ignorezero) { }
+
+    ~StatsKernel () {
+      std::lock_guard<std::mutex> lock (mutex);
+      overall.merge (local);
+    }
+
+    void operator() (Image<complex_type>& data) {
+      local (data.value());
+    }
+    void operator() (Image<complex_type>& data, Image<bool>& mask) {
       if (mask.value())
-        stats (data.value());
+        local (data.value());
     }
-  } else {
-    for (auto l = Loop(0,3) (data); l; ++l)
-      stats (data.value());
-  }
+
+  private:
+    Stats::Stats& overall;
+    Stats::Stats local;
+
+    static std::mutex mutex;
+};
+std::mutex StatsKernel::mutex;
+
+
+
+
+void run_volume (Stats::Stats& stats, Image<complex_type>& data, Image<bool>& mask, const bool is_complex, const bool ignorezero)
+{
+  if (mask.valid())
+    ThreadedLoop (data, 0, 3).run (StatsKernel (stats, is_complex, ignorezero), data, mask);
+  else
+    ThreadedLoop (data, 0, 3).run (StatsKernel (stats, is_complex, ignorezero), data);
 }
 
 
@@ -139,14 +169,14 @@ void run ()
 
     Stats::Stats stats (is_complex, ignorezero);
     for (auto i = Volume_loop (data); i; ++i)
-      run_volume (stats, data, mask);
+      run_volume (stats, data, mask, is_complex, ignorezero);
     stats.print (data, fields);
 
   } else {
 
     for (auto i = Volume_loop (data); i; ++i) {
       Stats::Stats stats (is_complex, ignorezero);
-      run_volume (stats, data, mask);
+      run_volume (stats, data, mask, is_complex, ignorezero);
       stats.print (data, fields);
     }
 
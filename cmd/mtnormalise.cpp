@@ -12,9 +12,12 @@
  */
 
 
+#include <mutex>
+
 #include "command.h"
 #include "image.h"
 #include "algo/loop.h"
+#include "algo/threaded_loop.h"
 #include "transform.h"
 #include "math/least_squares.h"
 #include "algo/threaded_copy.h"
@@ -167,6 +170,66 @@ struct PolyBasisFunction<2> { MEMALIGN (PolyBasisFunction<2>)
 };
 
 
+// Accumulates the normal equations for the log-domain normalisation field
+// fit: each thread gathers its own partial basisᵀ·basis and basisᵀ·y sums
+// over the mask voxels it processes, which are merged into the shared system
+// on destruction. This avoids assembling the full num_voxels × n_basis_vecs
+// design matrix at every iteration of the main loop.
+template <int poly_order>
+class NormalEquationsKernel { MEMALIGN (NormalEquationsKernel<poly_order>)
+  public:
+    NormalEquationsKernel (const Transform& transform,
+                           const Eigen::VectorXd& balance_factors,
+                           const float log_norm_value,
+                           Eigen::MatrixXd& overall_AtA,
+                           Eigen::VectorXd& overall_Atb,
+                           std::mutex& mutex) :
+      transform (transform),
+      balance_factors (balance_factors),
+      log_norm_value (log_norm_value),
+      overall_AtA (overall_AtA),
+      overall_Atb (overall_Atb),
+      mutex (mutex),
+      AtA (Eigen::MatrixXd::Zero (overall_AtA.rows(), overall_AtA.cols())),
+      Atb (Eigen::VectorXd::Zero (overall_Atb.size())) { }
+
+    NormalEquationsKernel (const NormalEquationsKernel&) = default;
+
+    ~NormalEquationsKernel () {
+      std::lock_guard<std::mutex> lock (mutex);
+      overall_AtA += AtA;
+      overall_Atb += Atb;
+    }
+
+    void operator() (Image<bool>& mask, Image<float>& combined_tissue)
+    {
+      if (!mask.value())
+        return;
+      const Eigen::Vector3 vox (mask.index(0), mask.index(1), mask.index(2));
+      const Eigen::Vector3 pos = transform.voxel2scanner * vox;
+      const Eigen::VectorXd basis = basis_function (pos).col(0);
+      double sum = 0.0;
+      for (ssize_t j = 0; j < balance_factors.size(); ++j) {
+        combined_tissue.index(3) = j;
+        sum += balance_factors(j) * combined_tissue.value();
+      }
+      AtA.noalias() += basis * basis.transpose();
+      Atb.noalias() += (std::log(sum) - log_norm_value) * basis;
+    }
+
+  protected:
+    PolyBasisFunction<poly_order> basis_function;
+    const Transform& transform;
+    const Eigen::VectorXd& balance_factors;
+    const float log_norm_value;
+    Eigen::MatrixXd& overall_AtA;
+    Eigen::VectorXd& overall_Atb;
+    std::mutex& mutex;
+    Eigen::MatrixXd AtA;
+    Eigen::VectorXd Atb;
+};
+
+
 // Removes non-physical voxels from the mask
 FORCE_INLINE void refine_mask (Image<float>& summed,
   Image<bool>& initial_mask,
@@ -442,34 +505,26 @@ void run_primitive () {
     }
 
 
-    // Solve for normalisation field weights in the log domain
+    // Solve for normalisation field weights in the log domain, by threaded
+    // accumulation of the normal equations over the mask voxels
     Transform transform (mask);
-    Eigen::MatrixXd norm_field_basis (num_voxels, basis_function.n_basis_vecs);
-    Eigen::VectorXd y (num_voxels);
-    uint32_t index = 0;
-    for (auto i = Loop (0, 3) (mask, combined_tissue); i; ++i) {
-      if (mask.value()) {
-        Eigen::Vector3 vox (mask.index(0), mask.index(1), mask.index(2));
-        Eigen::Vector3 pos = transform.voxel2scanner * vox;
-        norm_field_basis.row (index) = basis_function (pos).col(0);
-
-        double sum = 0.0;
-        for (size_t j = 0; j < n_tissue_types; ++j) {
-          combined_tissue.index(3) = j;
-          sum += balance_factors(j) * combined_tissue.value() ;
-        }
-        y (index++) = std::log(sum) - log_norm_value;
-      }
+    Eigen::MatrixXd AtA (Eigen::MatrixXd::Zero (basis_function.n_basis_vecs, basis_function.n_basis_vecs));
+    Eigen::VectorXd Atb (Eigen::VectorXd::Zero (basis_function.n_basis_vecs));
+    {
+      std::mutex mutex;
+      NormalEquationsKernel<poly_order> kernel (transform, balance_factors, log_norm_value, AtA, Atb, mutex);
+      ThreadedLoop (mask, 0, 3).run (kernel, mask, combined_tissue);
     }
 
-    norm_field_weights = norm_field_basis.colPivHouseholderQr().solve(y);
+    norm_field_weights = AtA.ldlt().solve (Atb);
 
     // Generate normalisation field in the log domain
-    for (auto i = Loop (0, 3) (norm_field_log); i; ++i) {
-      Eigen::Vector3 vox (norm_field_log.index(0), norm_field_log.index(1), norm_field_log.index(2));
-      Eigen::Vector3 pos = transform.voxel2scanner * vox;
-      norm_field_log.value() = basis_function (pos).col(0).dot (norm_field_weights.col(0));
-    }
+    ThreadedLoop (norm_field_log, 0, 3).run (
+        [&] (ImageType& field) {
+          const Eigen::Vector3 vox (field.index(0), field.index(1), field.index(2));
+          const Eigen::Vector3 pos = transform.voxel2scanner * vox;
+          field.value() = basis_function (pos).col(0).dot (norm_field_weights.col(0));
+        }, norm_field_log);
 
     // Generate normalisation field in the image domain
     for (auto i = Loop (0, 3) (norm_field_log, norm_field_image); i; ++i)
@@ -55,28 +55,61 @@ void usage ()
 
 using value_type = float;
 
+// Number of voxels gathered into each batched transform
+#define BATCH_SIZE 256
+
 
 class SH2Amp { MEMALIGN(SH2Amp)
   public:
     template <class MatrixType>
-    SH2Amp (const MatrixType& dirs, const size_t lmax, bool nonneg) : 
-      transformer (dirs.template cast<value_type>(), lmax), 
+    SH2Amp (const MatrixType& dirs, const size_t lmax, bool nonneg) :
+      transformer (dirs.template cast<value_type>(), lmax),
       nonnegative (nonneg),
-      sh (transformer.n_SH()),
-      amp (transformer.n_amp()) { }
-    
+      sh (transformer.n_SH(), BATCH_SIZE),
+      amp (transformer.n_amp(), BATCH_SIZE),
+      pos (3, BATCH_SIZE),
+      filled (0) { }
+
+    ~SH2Amp () {
+      if (filled)
+        flush();
+    }
+
+    // Voxels are gathered into column batches, so that the transform runs as
+    //   a matrix-matrix product rather than one matrix-vector product per voxel
     void operator() (Image<value_type>& in, Image<value_type>& out) {
-      sh = in.row (3);
-      transformer.SH2A(amp, sh);
-      if (nonnegative)
-        amp = amp.cwiseMax(value_type(0.0));
-      out.row (3) = amp;
+      if (!out_image.valid())
+        out_image = out;
+      sh.col (filled) = in.row (3);
+      pos(0, filled) = in.index(0);
+      pos(1, filled) = in.index(1);
+      pos(2, filled) = in.index(2);
+      if (++filled == BATCH_SIZE)
+        flush();
     }
 
   private:
     const Math::SH::Transform<value_type> transformer;
     const bool nonnegative;
-    Eigen::Matrix<value_type, Eigen::Dynamic, 1> sh, amp;
+    Eigen::Matrix<value_type, Eigen::Dynamic, Eigen::Dynamic> sh, amp;
+    Eigen::Matrix<ssize_t, 3, Eigen::Dynamic> pos;
+    size_t filled;
+    Image<value_type> out_image;
+
+    void flush () {
+      auto amp_block = amp.leftCols (filled);
+      const auto sh_block = sh.leftCols (filled);
+      transformer.SH2A (amp_block, sh_block);
+      if (nonnegative)
+        amp_block = amp_block.cwiseMax (value_type(0.0));
+      for (size_t n = 0; n != filled; ++n) {
+        out_image.index(0) = pos(0, n);
+        out_image.index(1) = pos(1, n);
+        out_image.index(2) = pos(2, n);
+        out_image.row (3) = amp.col (n);
+      }
+      filled = 0;
+    }
 };
 
 
@@ -69,7 +69,15 @@ void usage ()
 
   + Option ("mask",
             "only perform computation within the specified binary brain mask image.")
-  + Argument ("image").type_image_in();
+  + Argument ("image").type_image_in()
+
+  + Option ("fast",
+            "initialise the Newton searches of each voxel from the peaks found in the "
+            "immediately preceding (adjacent) voxel where available, falling back to the "
+            "full seed set whenever this fails to recover the same number of peaks. "
+            "This substantially reduces computation time for dense whole-brain peak "
+            "extraction, at a small risk of missing peaks that emerge abruptly between "
+            "neighbouring voxels.");
 }
 
 
@@ -152,7 +160,8 @@ class Processor { MEMALIGN(Processor)
                int npeaks,
                vector<Direction> true_peaks,
                value_type threshold,
-               Image<value_type>* ipeaks_data) :
+               Image<value_type>* ipeaks_data,
+               bool warm_start) :
       dirs_vox (dirs_data),
       dirs (directions),
       lmax (lmax),
@@ -160,7 +169,10 @@ class Processor { MEMALIGN(Processor)
       true_peaks (true_peaks),
       threshold (threshold),
       peaks_out (npeaks),
-      ipeaks_vox (ipeaks_data) { }
+      ipeaks_vox (ipeaks_data),
+      warm_start (warm_start) {
+        prev_pos[0] = prev_pos[1] = prev_pos[2] = std::numeric_limits<ssize_t>::min();
+      }
 
     bool operator() (const Item& item) {
 
@@ -171,24 +183,65 @@ class Processor { MEMALIGN(Processor)
       if (check_input (item)) {
         for (auto l = Loop(3) (dirs_vox); l; ++l)
           dirs_vox.value() = NAN;
+        prev_peaks.clear();
         return true;
       }
 
       vector<Direction> all_peaks;
 
-      for (size_t i = 0; i < size_t(dirs.rows()); i++) {
-        Direction p (dirs (i,0), dirs (i,1));
-        p.a = Math::SH::get_peak (item.data, lmax, p.v);
-        if (std::isfinite (p.a)) {
-          for (size_t j = 0; j < all_peaks.size(); j++) {
-            if (std::abs (p.v.dot (all_peaks[j].v)) > DOT_THRESHOLD) {
-              p.a = NAN;
-              break;
+      // warm start: if the previous voxel processed by this thread is an
+      // immediate neighbour, its peaks are very likely close to this voxel's,
+      // so seed one search per previous peak; this only stands if every such
+      // search converges onto a distinct accepted peak, otherwise the full
+      // seed sweep below is performed as usual
+      bool warm_ok = false;
+      if (warm_start && prev_peaks.size() &&
+          std::abs (item.pos[0]-prev_pos[0]) + std::abs (item.pos[1]-prev_pos[1]) + std::abs (item.pos[2]-prev_pos[2]) == 1) {
+        warm_ok = true;
+        for (const auto& seed : prev_peaks) {
+          Direction p;
+          p.v = seed.v;
+          p.a = Math::SH::get_peak (item.data, lmax, p.v);
+          if (std::isfinite (p.a)) {
+            for (size_t j = 0; j < all_peaks.size(); j++) {
+              if (std::abs (p.v.dot (all_peaks[j].v)) > DOT_THRESHOLD) {
+                p.a = NAN;
+                break;
+              }
             }
           }
+          if (std::isfinite (p.a) && p.a >= threshold) {
+            all_peaks.push_back (p);
+          } else {
+            warm_ok = false;
+            all_peaks.clear();
+            break;
+          }
         }
-        if (std::isfinite (p.a) && p.a >= threshold) 
-          all_peaks.push_back (p);
+      }
+
+      if (!warm_ok) {
+        for (size_t i = 0; i < size_t(dirs.rows()); i++) {
+          Direction p (dirs (i,0), dirs (i,1));
+          p.a = Math::SH::get_peak (item.data, lmax, p.v);
+          if (std::isfinite (p.a)) {
+            for (size_t j = 0; j < all_peaks.size(); j++) {
+              if (std::abs (p.v.dot (all_peaks[j].v)) > DOT_THRESHOLD) {
+                p.a = NAN;
+                break;
+              }
+            }
+          }
+          if (std::isfinite (p.a) && p.a >= threshold)
+            all_peaks.push_back (p);
+        }
+      }
+
+      if (warm_start) {
+        prev_peaks = all_peaks;
+        prev_pos[0] = item.pos[0];
+        prev_pos[1] = item.pos[1];
+        prev_pos[2] = item.pos[2];
       }
 
       if (ipeaks_vox) {
@@ -252,6 +305,9 @@ class Processor { MEMALIGN(Processor)
     value_type threshold;
     vector<Direction> peaks_out;
     copy_ptr<Image<value_type> > ipeaks_vox;
+    const bool warm_start;
+    vector<Direction> prev_peaks;
+    ssize_t prev_pos[3];
 
     bool check_input (const Item& item) {
       if (ipeaks_vox) {
@@ -334,7 +390,7 @@ void run ()
 
   DataLoader loader (SH_data, mask_data.get());
   Processor processor (peaks, dirs, Math::SH::LforN (SH_data.size (3)),
-      npeaks, true_peaks, threshold, ipeaks_data.get());
+      npeaks, true_peaks, threshold, ipeaks_data.get(), get_options ("fast").size());
 
   Thread::run_queue (loader, Thread::batch (Item()), Thread::multi (processor));
 }
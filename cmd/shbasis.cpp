@@ -22,7 +22,10 @@
 #include "progressbar.h"
 #include "types.h"
 
+#include <mutex>
+
 #include "algo/loop.h"
+#include "algo/threaded_loop.h"
 
 #include "math/SH.h"
 
@@ -94,6 +97,39 @@ std::pair<float, float> get_regression (const vector<float>& ratios)
 
 
 
+// Accumulate the per-volume sums of squared intensities across threads;
+//   each copy gathers its own partial sums, merged on destruction.
+// Voxels where the DC term is zero or non-finite are masked out.
+template <typename value_type>
+class SqSumKernel { MEMALIGN(SqSumKernel<value_type>)
+  public:
+    SqSumKernel (Image<value_type>& image, Eigen::VectorXd& overall, std::mutex& mutex) :
+      image (image), overall (overall), mutex (mutex),
+      sums (Eigen::VectorXd::Zero (overall.size())) { }
+    SqSumKernel (const SqSumKernel&) = default;
+    ~SqSumKernel () {
+      std::lock_guard<std::mutex> lock (mutex);
+      overall += sums;
+    }
+    void operator() (Iterator& pos) {
+      assign_pos_of (pos, 0, 3).to (image);
+      image.index(3) = 0;
+      const value_type dc = image.value();
+      if (dc && std::isfinite (dc)) {
+        for (image.index(3) = 1; image.index(3) != image.size(3); ++image.index(3))
+          sums[image.index(3)] += Math::pow2 (double (image.value()));
+      }
+    }
+  protected:
+    Image<value_type> image;
+    Eigen::VectorXd& overall;
+    std::mutex& mutex;
+    Eigen::VectorXd sums;
+};
+
+
+
+
 template <typename value_type>
 void check_and_update (Header& H, const conv_t conversion)
 {
@@ -109,53 +145,32 @@ void check_and_update (Header& H, const conv_t conversion)
   // Open in read-write mode if there's a chance of modification
   auto image = H.get_image<value_type> (true);
 
-  // Need to mask out voxels where the DC term is zero
-  Header header_mask (H);
-  header_mask.ndim() = 3;
-  header_mask.datatype() = DataType::Bit;
-  auto mask = Image<bool>::scratch (header_mask);
-  size_t voxel_count = 0;
+  // Get sums independently for each volume, in a single threaded pass over
+  //   the image; voxels where the DC term is zero or non-finite are masked
+  //   out within the kernel itself
+  Eigen::VectorXd sums = Eigen::VectorXd::Zero (N);
   {
-    for (auto i = Loop ("Masking image based on DC term", image, 0, 3) (image, mask); i; ++i) {
-      const value_type value = image.value();
-      if (value && std::isfinite (value)) {
-        mask.value() = true;
-        ++voxel_count;
-      } else {
-        mask.value() = false;
-      }
-    }
+    std::mutex mutex;
+    SqSumKernel<value_type> kernel (image, sums, mutex);
+    ThreadedLoop ("Evaluating SH basis of image \"" + H.name() + "\"", image, 0, 3).run (kernel);
   }
 
-  // Get sums independently for each l
- 
   // Each order has a different power, and a different number of m!=0 volumes.
   // Therefore, calculate the mean-square intensity for the m==0 and m!=0
   // volumes independently, and report ratio for each harmonic order
-  std::unique_ptr<ProgressBar> progress;
-  if (App::log_level > 0 && App::log_level < 2)
-    progress.reset (new ProgressBar ("Evaluating SH basis of image \"" + H.name() + "\"", N-1));
-
   vector<float> ratios;
 
   for (size_t l = 2; l <= lmax; l += 2) {
 
     double mzero_sum = 0.0, mnonzero_sum = 0.0;
-    for (image.index(3) = ssize_t (Math::SH::NforL(l-2)); image.index(3) != ssize_t (Math::SH::NforL(l)); ++image.index(3)) {
-      double sum = 0.0;
-      for (auto i = Loop (image, 0, 3) (image, mask); i; ++i) {
-        if (mask.value())
-          sum += Math::pow2 (value_type(image.value()));
-      }
-      if (mzero_terms[image.index(3)]) {
-        mzero_sum += sum;
-        DEBUG ("Volume " + str(image.index(3)) + ", m==0, sum " + str(sum));
+    for (size_t v = Math::SH::NforL(l-2); v != Math::SH::NforL(l); ++v) {
+      if (mzero_terms[v]) {
+        mzero_sum += sums[v];
+        DEBUG ("Volume " + str(v) + ", m==0, sum " + str(sums[v]));
       } else {
-        mnonzero_sum += sum;
-        DEBUG ("Volume " + str(image.index(3)) + ", m!=0, sum " + str(sum));
+        mnonzero_sum += sums[v];
+        DEBUG ("Volume " + str(v) + ", m!=0, sum " + str(sums[v]));
       }
-      if (progress)
-      ++*progress;
     }
 
     const double mnonzero_MSoS = mnonzero_sum / (2.0 * l);
@@ -167,9 +182,6 @@ void check_and_update (Header& H, const conv_t conversion)
 
   }
 
-  if (progress)
-    progress = NULL;
-
   // First is ratio to be used for SH basis decision, second is gradient of regression
   std::pair<float, float> regression = std::make_pair (0.0f, 0.0f);
   size_t l_for_decision;
@@ -271,17 +283,17 @@ void check_and_update (Header& H, const conv_t conversion)
     WARN ("(m!=0 to m==0 power ratio changing by " + str(2.0*regression.second) + " per even order)");
   }
 
-  // Adjust the image data in-place if necessary
+  // Adjust the image data in-place if necessary; voxels are independent,
+  //   so the rescaling is distributed across threads
   if (multiplier && (multiplier != 1.0)) {
 
-    ProgressBar progress ("Modifying SH basis of image \"" + H.name() + "\"", N-1);
-    for (image.index(3) = 1; image.index(3) != ssize_t(N); ++image.index(3)) {
-      if (!mzero_terms[image.index(3)]) {
-        for (auto i = Loop (image, 0, 3) (image); i; ++i)
-          image.value() *= multiplier;
-      }
-      ++progress;
-    }
+    ThreadedLoop ("Modifying SH basis of image \"" + H.name() + "\"", image, 0, 3)
+      .run ([&] (Image<value_type>& v) {
+          for (v.index(3) = 1; v.index(3) != ssize_t(N); ++v.index(3)) {
+            if (!mzero_terms[v.index(3)])
+              v.value() *= multiplier;
+          }
+        }, image);
 
   } else if (multiplier && (conversion != NONE)) {
     INFO ("Image \"" + H.name() + "\" already in desired basis; nothing to do");
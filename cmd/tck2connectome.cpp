@@ -97,26 +97,39 @@ void execute (Image<node_t>& node_image, const node_t max_node_index, const std:
   Tractography::Properties properties;
   Tractography::Reader<float> reader (argument[0], properties);
 
+  // If assignment depends only on the streamline endpoints and the metric
+  //   does not inspect the intervening geometry, a sidecar track index (if
+  //   present) permits seeking directly to the endpoint vertices of each
+  //   track, leaving the bulk of the file untouched
+  if (tck2nodes->endpoints_sufficient() && !metric.requires_geometry()) {
+    if (reader.set_endpoints_only())
+      INFO ("track index found; reading streamline endpoints only");
+  }
+
   // Initialise classes in preparation for multi-threading
   Mapping::TrackLoader loader (reader, properties["count"].empty() ? 0 : to<size_t>(properties["count"]), "Constructing connectome");
   Tractography::Connectome::Mapper mapper (*tck2nodes, metric);
   Tractography::Connectome::Matrix<T> connectome (max_node_index, statistic, vector_output, track_assignments);
 
-  // Multi-threaded connectome construction
+  // Multi-threaded connectome construction; each thread accumulates into
+  //   its own copy of the connectome, merged on completion (the accumulator
+  //   must leave scope before the results are finalized)
   if (tck2nodes->provides_pair()) {
+    typename Tractography::Connectome::Matrix<T>::Accumulator accumulator (connectome);
     Thread::run_queue (
         loader,
         Thread::batch (Tractography::Streamline<float>()),
         Thread::multi (mapper),
         Thread::batch (Mapped_track_nodepair()),
-        connectome);
+        Thread::multi (accumulator));
   } else {
+    typename Tractography::Connectome::Matrix<T>::Accumulator accumulator (connectome);
     Thread::run_queue (
         loader,
         Thread::batch (Tractography::Streamline<float>()),
         Thread::multi (mapper),
         Thread::batch (Mapped_track_nodelist()),
-        connectome);
+        Thread::multi (accumulator));
   }
 
   connectome.finalize();
@@ -13,13 +13,17 @@
 
 
 #include <cstdio>
+#include <map>
 #include <sstream>
 #include "command.h"
+#include "thread_queue.h"
 #include "file/ofstream.h"
 #include "file/name_parser.h"
 #include "dwi/tractography/file.h"
 #include "dwi/tractography/properties.h"
 
+#define TCKCONVERT_BLOCK_SIZE 1024
+
 
 using namespace MR;
 using namespace App;
@@ -93,7 +97,37 @@ void usage ()
 }
 
 
-class VTKWriter: public WriterInterface<float> { MEMALIGN(VTKWriter)
+//! a run of consecutive tracks, tagged with its position in the stream
+/*! blocks are parsed, transformed and (where supported) formatted by the
+ * worker threads in whatever order they come off the queue; the tag allows
+ * the output stage to restore stream order before writing. Blocks travel
+ * through the queue as shared pointers so that re-ordering in the output
+ * stage does not copy the track data. */
+class TrackBlock { MEMALIGN(TrackBlock)
+  public:
+    size_t index = 0;
+    vector<Streamline<float>> tracks;
+    std::string formatted;
+};
+
+using BlockPtr = std::shared_ptr<TrackBlock>;
+
+
+//! optional extension for writers whose per-track output is independent of stream position
+/*! such writers can have their (expensive) per-vertex ASCII formatting
+ * performed by the worker threads into the block's buffer, leaving only a
+ * single bulk write per block to be performed serially and in order. */
+class BlockFormatter { NOMEMALIGN
+  public:
+    virtual ~BlockFormatter() { }
+    //! render the block's tracks into its buffer; called concurrently
+    virtual void format (TrackBlock&) const = 0;
+    //! commit a formatted block; called serially, in stream order
+    virtual void write (const TrackBlock&) = 0;
+};
+
+
+class VTKWriter: public WriterInterface<float>, public BlockFormatter { MEMALIGN(VTKWriter)
 public:
     VTKWriter(const std::string& file) : VTKout (file) {
         // create and write header of VTK output file:
@@ -120,6 +154,22 @@ public:
         return true;
     }
 
+    void format (TrackBlock& block) const override {
+        std::ostringstream stream;
+        for (const auto& tck : block.tracks)
+          for (const auto& pos : tck)
+            stream << pos[0] << " " << pos[1] << " " << pos[2] << "\n";
+        block.formatted = stream.str();
+    }
+
+    void write (const TrackBlock& block) override {
+        for (const auto& tck : block.tracks) {
+          track_list.push_back (std::pair<size_t,size_t> (current_index, current_index + tck.size()));
+          current_index += tck.size();
+        }
+        VTKout.write (block.formatted.data(), block.formatted.size());
+    }
+
     ~VTKWriter() {
         // write out list of tracks:
         VTKout << "LINES " << track_list.size() << " " << track_list.size() + current_index << "\n";
@@ -607,6 +657,87 @@ bool has_suffix(const std::string &str, const std::string &suffix)
 
 
 
+class BlockReader { MEMALIGN(BlockReader)
+  public:
+    BlockReader (ReaderInterface<float>& reader) : reader (reader), count (0) { }
+
+    bool operator() (BlockPtr& out) {
+      out.reset (new TrackBlock);
+      out->index = count++;
+      Streamline<float> tck;
+      while (out->tracks.size() < TCKCONVERT_BLOCK_SIZE && reader (tck))
+        out->tracks.push_back (std::move (tck));
+      return out->tracks.size();
+    }
+
+  private:
+    ReaderInterface<float>& reader;
+    size_t count;
+};
+
+
+
+class BlockProcessor { MEMALIGN(BlockProcessor)
+  public:
+    BlockProcessor (const transform_type& T, const bool apply_transform, const BlockFormatter* formatter) :
+        T (T.cast<float>()),
+        apply_transform (apply_transform),
+        formatter (formatter) { }
+
+    bool operator() (const BlockPtr& in, BlockPtr& out) const {
+      out = in;
+      if (apply_transform) {
+        for (auto& tck : out->tracks)
+          for (auto& pos : tck)
+            pos = T * pos;
+      }
+      if (formatter)
+        formatter->format (*out);
+      return true;
+    }
+
+  private:
+    const Eigen::Transform<float, 3, Eigen::AffineCompact> T;
+    const bool apply_transform;
+    const BlockFormatter* formatter;
+};
+
+
+
+class OrderedWriter { MEMALIGN(OrderedWriter)
+  public:
+    OrderedWriter (WriterInterface<float>& writer, BlockFormatter* formatter) :
+        writer (writer),
+        formatter (formatter),
+        next (0) { }
+
+    bool operator() (const BlockPtr& block) {
+      pending[block->index] = block;
+      // commit every block for which all predecessors have arrived;
+      // anything further ahead stays parked until the gap is filled
+      while (pending.size() && pending.begin()->first == next) {
+        BlockPtr b (pending.begin()->second);
+        pending.erase (pending.begin());
+        if (formatter) {
+          formatter->write (*b);
+        } else {
+          for (const auto& tck : b->tracks)
+            writer (tck);
+        }
+        ++next;
+      }
+      return true;
+    }
+
+  private:
+    WriterInterface<float>& writer;
+    BlockFormatter* formatter;
+    size_t next;
+    std::map<size_t, BlockPtr> pending;
+};
+
+
+
 
 
 void run ()
@@ -686,15 +817,13 @@ void run ()
     }
 
 
-    // Copy
-    Streamline<float> tck;
-    while ( (*reader)(tck) )
-    {
-        for (auto& pos : tck) {
-            pos = T.cast<float>() * pos;
-        }
-        (*writer)(tck);
-    }
+    // Convert; blocks of tracks are parsed, transformed and (where the
+    // writer supports it) formatted across threads, then written in order
+    BlockFormatter* formatter = dynamic_cast<BlockFormatter*> (writer.get());
+    BlockReader source (*reader);
+    BlockProcessor pipe (T, nopts, formatter);
+    OrderedWriter sink (*writer, formatter);
+    Thread::run_queue (source, BlockPtr(), Thread::multi (pipe), BlockPtr(), sink);
 
 }
 
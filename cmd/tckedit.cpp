@@ -25,6 +25,7 @@
 #include "dwi/tractography/roi.h"
 #include "dwi/tractography/weights.h"
 
+#include "dwi/tractography/editing/dedupe.h"
 #include "dwi/tractography/editing/editing.h"
 #include "dwi/tractography/editing/loader.h"
 #include "dwi/tractography/editing/receiver.h"
@@ -73,6 +74,12 @@ void usage ()
 
   + Option ("ends_only", "only test the ends of each streamline against the provided include/exclude ROIs")
 
+  + Option ("dedupe", "remove duplicate and near-duplicate streamlines: each streamline is resampled to a fixed "
+                      "number of points and quantised onto a grid of the specified spacing (in mm), and discarded if a "
+                      "previously-encountered streamline (in either orientation) produced the same signature. Note that "
+                      "this test is approximate: near-duplicates that straddle a grid boundary may be retained.")
+    + Argument ("tolerance").type_float (0.0)
+
   // TODO Input weights with multiple input files currently not supported
   + OptionGroup ("Options for handling streamline weights")
   + Tractography::TrackWeightsInOption
@@ -165,21 +172,54 @@ void run ()
   const bool inverse   = get_options ("inverse").size();
   const bool ends_only = get_options ("ends_only").size();
 
+  std::unique_ptr<Dedupe> dedupe;
+  auto opt = get_options ("dedupe");
+  if (opt.size())
+    dedupe.reset (new Dedupe (float (opt[0][0])));
+
   // Parameters that the output thread needs to be aware of
   const size_t number = get_option_value ("number", size_t(0));
   const size_t skip   = get_option_value ("skip",   size_t(0));
 
+  // If no selection or modification of any kind has been requested, the
+  //   operation reduces to a pure concatenation, and the raw streamline data
+  //   can be spliced together directly rather than decoding and re-encoding
+  //   every vertex. (The threshold keys are erased from the inherited
+  //   properties above, so their presence here indicates an explicit request.)
+  if (!inverse && !ends_only && !dedupe && !number && !skip
+      && !properties.include.size() && !properties.exclude.size() && !properties.mask.size()
+      && !properties.count ("min_dist") && !properties.count ("max_dist")
+      && !properties.count ("min_weight") && !properties.count ("max_weight")
+      && !get_options ("tck_weights_in").size() && !get_options ("tck_weights_out").size()) {
+    if (Editing::concatenate (input_file_list, output_path, properties))
+      return;
+  }
+
+  // Absent any operation that modifies accepted streamlines (mask cropping,
+  //   deduplication) or involves per-streamline weights, the selection
+  //   criteria can be evaluated directly against the memory-mapped input
+  //   data, and the raw vertex data of each accepted streamline spliced
+  //   straight into the output file
+  if (!dedupe && !properties.mask.size()
+      && !get_options ("tck_weights_in").size() && !get_options ("tck_weights_out").size()) {
+    if (Editing::filter (input_file_list, output_path, properties, inverse, ends_only, number, skip))
+      return;
+  }
+
   Loader loader (input_file_list);
-  Worker worker (properties, inverse, ends_only);
+  Worker worker (properties, inverse, ends_only, dedupe.get());
   // This needs to be run AFTER creation of the Worker class
   // (worker needs to be able to set max & min number of points based on step size in input file,
   //  receiver needs "output_step_size" field to have been updated before file creation)
   Receiver receiver (output_path, properties, number, skip);
 
+  // streamline lengths (and hence per-item processing cost) vary widely;
+  //   allow idle worker threads to take over the tail of their peers'
+  //   batches rather than idling through the drain phase
   Thread::run_queue (
-      loader, 
-      Thread::batch (Streamline<>()),
-      Thread::multi (worker), 
+      loader,
+      Thread::stealing_batch (Streamline<>()),
+      Thread::multi (worker),
       Thread::batch (Streamline<>()),
       receiver);
 
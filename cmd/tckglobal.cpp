@@ -14,12 +14,17 @@
 
 #include "command.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <limits>
 
 #include "math/SH.h"
 #include "image.h"
 #include "thread.h"
 #include "algo/threaded_copy.h"
+#include "file/path.h"
 
 #include "dwi/tractography/GT/particlegrid.h"
 #include "dwi/tractography/GT/gt.h"
@@ -159,6 +164,14 @@ void usage ()
   + Option ("etrend", "internal and external energy trend and cooling statistics.")
     + Argument ("stats").type_file_out()
 
+  + Option ("checkpoint", "Periodically save the state of the optimization (particle configuration "
+            "and annealing position) to the given file, every N iterations. If the file already "
+            "exists, the optimization resumes from the stored state rather than starting from "
+            "scratch, allowing long runs to survive preemption. The command must be invoked with "
+            "the same input data and parameters (in particular -niter and -length) when resuming.")
+    + Argument ("file").type_file_out()
+    + Argument ("every").type_integer (1)
+
 
   + OptionGroup("Advanced parameters, if you really know what you're doing")
   
@@ -309,13 +322,64 @@ void run ()
   EnergySumComputer* Esum = new EnergySumComputer(stats, Eint, properties.lam_int, Eext, properties.lam_ext / ( wmscale2 * properties.weight*properties.weight));
   
   MHSampler mhs (dwi, properties, stats, pgrid, Esum, mask);   // All EnergyComputers are recursively destroyed upon destruction of mhs, except for the shared data.
-  
-  
+
+
+  // Resume from checkpoint, if provided -------------------------------------------------
+
+  const char* checkpoint_magic = "MRtckglb";
+  std::string checkpoint_file;
+  uint64_t checkpoint_interval = 0;
+
+  opt = get_options("checkpoint");
+  if (opt.size()) {
+    checkpoint_file = std::string(opt[0][0]);
+    checkpoint_interval = uint64_t(opt[0][1]);
+    if (Path::exists(checkpoint_file)) {
+      INFO("Resuming global tractography from checkpoint file \"" + checkpoint_file + "\".");
+      std::ifstream in (checkpoint_file.c_str(), std::ios_base::in | std::ios_base::binary);
+      if (!in)
+        throw Exception("error opening checkpoint file \"" + checkpoint_file + "\": " + strerror(errno));
+      char magic[8];
+      in.read(magic, sizeof(magic));
+      if (!in.good() || memcmp(magic, checkpoint_magic, sizeof(magic)))
+        throw Exception("file \"" + checkpoint_file + "\" is not a tckglobal checkpoint file");
+      stats.load(in);
+      pgrid.load(in);
+      Eext->restore(pgrid);
+      INFO("Resumed at iteration " + str(stats.getIterations()) + " with "
+           + std::to_string(pgrid.getTotalCount()) + " particles.");
+    }
+  }
+
+
   INFO("Start MH sampler");
-  
-  auto t = Thread::run (Thread::multi(mhs), "MH sampler");
-  t.wait();
-  
+
+  if (checkpoint_file.empty()) {
+    auto t = Thread::run (Thread::multi(mhs), "MH sampler");
+    t.wait();
+  }
+  else {
+    // Run the sampler in bounded stretches, snapshotting the (consistent)
+    // state in between; the rename makes each checkpoint update atomic.
+    while (stats.getIterations() < niter) {
+      stats.setTargetIterations (stats.getIterations() + checkpoint_interval);
+      auto t = Thread::run (Thread::multi(mhs), "MH sampler");
+      t.wait();
+      const std::string tmpfile = checkpoint_file + ".tmp";
+      std::ofstream out (tmpfile.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+      if (!out)
+        throw Exception("error creating checkpoint file \"" + tmpfile + "\": " + strerror(errno));
+      out.write(checkpoint_magic, 8);
+      stats.save(out);
+      pgrid.save(out);
+      out.close();
+      if (!out)
+        throw Exception("error writing checkpoint file \"" + tmpfile + "\"");
+      if (std::rename(tmpfile.c_str(), checkpoint_file.c_str()))
+        throw Exception("error updating checkpoint file \"" + checkpoint_file + "\": " + strerror(errno));
+    }
+  }
+
   INFO("Final no. particles: " + std::to_string(pgrid.getTotalCount()));
   INFO("Final external energy: " + std::to_string(stats.getEextTotal()));
   INFO("Final internal energy: " + std::to_string(stats.getEintTotal()));
@@ -389,19 +389,36 @@ class Receiver_NoStatistic : private ReceiverBase { MEMALIGN(Receiver_NoStatisti
 
     bool operator() (std::pair<size_t, vector_type>& in)
     {
-      // Requires preservation of order
-      assert (in.first == ReceiverBase::received);
-      if (ascii)
-        (*ascii) << in.second.transpose() << "\n";
-      else
-        (*tsf) (in.second);
+      // Output requires preservation of order; worker threads deliver
+      // their batches in non-deterministic order, so buffer anything
+      // arriving early and flush whenever the next expected track is in hand
+      if (in.first != ReceiverBase::received) {
+        pending.emplace (in.first, std::move (in.second));
+        return true;
+      }
+      write (in.second);
       ++(*this);
+      auto it = pending.begin();
+      while (it != pending.end() && it->first == ReceiverBase::received) {
+        write (it->second);
+        ++(*this);
+        it = pending.erase (it);
+      }
       return true;
     }
 
   private:
     std::unique_ptr<File::OFStream> ascii;
     std::unique_ptr<DWI::Tractography::ScalarWriter<value_type>> tsf;
+    std::map<size_t, vector_type> pending;
+
+    void write (const vector_type& values)
+    {
+      if (ascii)
+        (*ascii) << values.transpose() << "\n";
+      else
+        (*tsf) (values);
+    }
 };
 
 
@@ -417,16 +434,11 @@ void execute_nostat (DWI::Tractography::Reader<value_type>& reader,
   MR::copy_ptr<TDI> no_tdi;
   SamplerNonPrecise<InterpType> sampler (image, stat_tck::NONE, no_tdi);
   Receiver_NoStatistic receiver (path, num_tracks, properties);
-  DWI::Tractography::Streamline<value_type> tck;
-  std::pair<size_t, vector_type> values;
-  size_t counter = 0;
-  while (reader (tck)) {
-    sampler (tck, values);
-    receiver (values);
-    ++counter;
-  }
-  if (counter != num_tracks)
-    WARN ("Expected " + str(num_tracks) + " tracks based on header; read " + str(counter));
+  Thread::run_queue (reader,
+                     Thread::batch (DWI::Tractography::Streamline<value_type>()),
+                     Thread::multi (sampler),
+                     Thread::batch (std::pair<size_t, vector_type>()),
+                     receiver);
 }
 
 template <class SamplerType>
@@ -28,6 +28,8 @@
 
 #include "dwi/tractography/SIFT2/tckfactor.h"
 
+#include "dwi/tractography/weights.h"
+
 
 
 
@@ -118,7 +120,9 @@ void usage ()
   ARGUMENTS
   + Argument ("in_tracks",   "the input track file").type_tracks_in()
   + Argument ("in_fod",      "input image containing the spherical harmonics of the fibre orientation distributions").type_image_in()
-  + Argument ("out_weights", "output text file containing the weighting factor for each streamline").type_file_out();
+  + Argument ("out_weights", "output file containing the weighting factor for each streamline "
+                             "(written in the binary streamline weights format if the path has the "
+                             TCK_WEIGHTS_SUFFIX " suffix, and as ASCII text otherwise)").type_file_out();
 
   OPTIONS
 
@@ -15,6 +15,7 @@
 #include "command.h"
 #include "memory.h"
 #include "progressbar.h"
+#include "thread_queue.h"
 #include "types.h"
 
 #include "file/ofstream.h"
@@ -71,16 +72,18 @@ void usage ()
 }
 
 
-// Store length and weight of each streamline
+// Store length, weight and index of each streamline
 class LW { NOMEMALIGN
   public:
-    LW (const float l, const float w) : length (l), weight (w) { }
-    LW () : length (NaN), weight (NaN) { }
+    LW (const float l, const float w, const uint64_t i = 0) : length (l), weight (w), index (i) { }
+    LW () : length (NaN), weight (NaN), index (0) { }
     bool operator< (const LW& that) const { return length < that.length; }
     float get_length() const { return length; }
     float get_weight() const { return weight; }
+    uint64_t get_index() const { return index; }
   private:
     float length, weight;
+    uint64_t index;
     friend LW operator+ (const LW&, const LW&);
     friend LW operator/ (const LW&, const double);
 };
@@ -97,63 +100,127 @@ LW operator/ (const LW& lw, const double div)
 }
 
 
-void run ()
-{
-
-  const bool weights_provided = get_options ("tck_weights_in").size();
-
-  float step_size = NaN;
-  size_t count = 0, header_count = 0;
-  float min_length = std::numeric_limits<float>::infinity();
-  float max_length = 0.0f;
-  double sum_lengths = 0.0, sum_weights = 0.0;
-  vector<double> histogram;
-  vector<LW> all_lengths;
-  all_lengths.reserve (header_count);
-
-  {
-    Tractography::Properties properties;
-    Tractography::Reader<float> reader (argument[0], properties);
-
-    if (properties.find ("count") != properties.end())
-      header_count = to<size_t> (properties["count"]);
+// Computes the length of each streamline; this is the only per-streamline
+// work, and is farmed out across threads
+class Worker { NOMEMALIGN
+  public:
+    Worker (const float step_size) : step_size (step_size) { }
+    bool operator() (const Streamline<>& tck, LW& out) const {
+      const float length = std::isfinite (step_size) ? tck.calc_length (step_size) : tck.calc_length();
+      out = LW (length, tck.weight, tck.index);
+      return true;
+    }
+  private:
+    const float step_size;
+};
 
-    step_size = get_step_size (properties);
 
-    if (!std::isfinite (step_size) || !step_size) {
-      INFO ("Streamline step size undefined in header; lengths will be calculated manually");
-      if (get_options ("histogram").size()) {
-        WARN ("Do not have streamline step size with which to construct histogram; histogram will be generated using 1mm bin widths");
+// Accumulates the statistics streamed out of the worker threads;
+// this stage runs single-threaded, so requires no locking
+class Receiver { NOMEMALIGN
+  public:
+    Receiver (const float step_size, const size_t header_count, const bool store_dump) :
+      count (0),
+      min_length (std::numeric_limits<float>::infinity()),
+      max_length (0.0f),
+      sum_lengths (0.0),
+      sum_weights (0.0),
+      progress ("Reading track file", header_count),
+      step_size (step_size),
+      store_dump (store_dump) {
+        all_lengths.reserve (header_count);
       }
-    }
-
-    std::unique_ptr<File::OFStream> dump;
-    auto opt = get_options ("dump");
-    if (opt.size())
-      dump.reset (new File::OFStream (std::string(opt[0][0]), std::ios_base::out | std::ios_base::trunc));
 
-    ProgressBar progress ("Reading track file", header_count);
-    Streamline<> tck;
-    while (reader (tck)) {
+    bool operator() (const LW& lw)
+    {
       ++count;
-      const float length = std::isfinite (step_size) ? tck.calc_length (step_size) : tck.calc_length();
+      const float length = lw.get_length();
       if (std::isfinite (length)) {
         min_length = std::min (min_length, length);
         max_length = std::max (max_length, length);
-        sum_lengths += tck.weight * length;
-        sum_weights += tck.weight;
-        all_lengths.push_back (LW (length, tck.weight));
+        sum_lengths += lw.get_weight() * length;
+        sum_weights += lw.get_weight();
+        all_lengths.push_back (lw);
         const size_t index = std::isfinite (step_size) ? std::round (length / step_size) : std::round (length);
         while (histogram.size() <= index)
           histogram.push_back (0.0);
-        histogram[index] += tck.weight;
+        histogram[index] += lw.get_weight();
       }
-      if (dump)
-        (*dump) << length << "\n";
+      if (store_dump)
+        dumped.push_back (lw);
       ++progress;
+      return true;
+    }
+
+    size_t count;
+    float min_length, max_length;
+    double sum_lengths, sum_weights;
+    vector<double> histogram;
+    vector<LW> all_lengths, dumped;
+    ProgressBar progress;
+
+  private:
+    const float step_size;
+    const bool store_dump;
+};
+
+
+void run ()
+{
+
+  const bool weights_provided = get_options ("tck_weights_in").size();
+
+  Tractography::Properties properties;
+  Tractography::Reader<float> reader (argument[0], properties);
+
+  size_t header_count = 0;
+  if (properties.find ("count") != properties.end())
+    header_count = to<size_t> (properties["count"]);
+
+  float step_size = get_step_size (properties);
+
+  if (!std::isfinite (step_size) || !step_size) {
+    INFO ("Streamline step size undefined in header; lengths will be calculated manually");
+    if (get_options ("histogram").size()) {
+      WARN ("Do not have streamline step size with which to construct histogram; histogram will be generated using 1mm bin widths");
     }
   }
 
+  std::unique_ptr<File::OFStream> dump;
+  auto opt = get_options ("dump");
+  if (opt.size())
+    dump.reset (new File::OFStream (std::string(opt[0][0]), std::ios_base::out | std::ios_base::trunc));
+
+  Worker worker (step_size);
+  Receiver receiver (step_size, header_count, bool(dump));
+
+  // measure streamlines across threads; reading and the statistics
+  // accumulation remain serial at either end of the queue
+  Thread::run_queue (reader,
+                     Thread::batch (Streamline<>()),
+                     Thread::multi (worker),
+                     Thread::batch (LW()),
+                     receiver);
+
+  receiver.progress.done();
+
+  if (dump) {
+    // worker threads deliver their batches in non-deterministic order;
+    // write the lengths out in the order the streamlines appear in the file
+    std::sort (receiver.dumped.begin(), receiver.dumped.end(),
+        [] (const LW& a, const LW& b) { return a.get_index() < b.get_index(); });
+    for (const auto& lw : receiver.dumped)
+      (*dump) << lw.get_length() << "\n";
+  }
+
+  const size_t count = receiver.count;
+  const float min_length = receiver.min_length;
+  const float max_length = receiver.max_length;
+  const double sum_lengths = receiver.sum_lengths;
+  const double sum_weights = receiver.sum_weights;
+  vector<double>& histogram (receiver.histogram);
+  vector<LW>& all_lengths (receiver.all_lengths);
+
   if (histogram.front() && !get_options ("ignorezero").size())
     WARN ("read " + str(histogram.front()) + " zero-length tracks");
   if (count != header_count)
@@ -179,7 +246,7 @@ void run ()
   stdev = std::sqrt (stdev / (((count - 1) / float(count)) * sum_weights));
 
   vector<std::string> fields;
-  auto opt = get_options ("output");
+  opt = get_options ("output");
   for (size_t n = 0; n < opt.size(); ++n)
     fields.push_back (opt[n][0]);
 
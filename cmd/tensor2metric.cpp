@@ -163,8 +163,7 @@ class Processor { MEMALIGN(Processor)
       }
       
       bool need_eigenvalues = value_img.valid() || vector_img.valid() || ad_img.valid() || rd_img.valid() || cl_img.valid() || cp_img.valid() || cs_img.valid();
-      
-      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
+
       if (need_eigenvalues || vector_img.valid()) {
         Eigen::Matrix3d M;
         M (0,0) = dt[0];
@@ -173,7 +172,10 @@ class Processor { MEMALIGN(Processor)
         M (0,1) = M (1,0) = dt[3];
         M (0,2) = M (2,0) = dt[4];
         M (1,2) = M (2,1) = dt[5];
-        es = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>(M, vector_img.valid() ? Eigen::ComputeEigenvectors : Eigen::EigenvaluesOnly);
+        // computeDirect() uses the closed-form solution for 3x3 symmetric
+        //   matrices, which is considerably faster than the default
+        //   iterative algorithm
+        es.computeDirect (M, vector_img.valid() ? Eigen::ComputeEigenvectors : Eigen::EigenvaluesOnly);
       }
       
       Eigen::Vector3d eigval;
@@ -260,6 +262,7 @@ class Processor { MEMALIGN(Processor)
     Image<value_type> vector_img;
     vector<int> vals;
     int modulate;
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
 };
 
 
@@ -54,12 +54,10 @@ void run ()
       throw Exception ("track scalar length mismatch");
 
     vector<value_type> tck_scalar_output (tck_scalar1.size());
-    for (size_t i = 0; i < tck_scalar1.size(); ++i) {
-      if (tck_scalar2[i] == 0.0)
-        tck_scalar_output[i] = 0;
-      else
-        tck_scalar_output[i] = tck_scalar1[i] / tck_scalar2[i];
-    }
+    Eigen::Map<const Eigen::Array<value_type, Eigen::Dynamic, 1>> in1 (tck_scalar1.data(), tck_scalar1.size());
+    Eigen::Map<const Eigen::Array<value_type, Eigen::Dynamic, 1>> in2 (tck_scalar2.data(), tck_scalar2.size());
+    Eigen::Map<Eigen::Array<value_type, Eigen::Dynamic, 1>> out (tck_scalar_output.data(), tck_scalar_output.size());
+    out = (in2 == value_type(0)).select (value_type(0), in1 / in2);
     writer (tck_scalar_output);
   }
 }
@@ -61,19 +61,28 @@ void run ()
   for (size_t c = 0; c < kernel.size(); c++)
     kernel[c] /= norm_factor;
 
+  // cumulative kernel sums, to renormalise the truncated kernel near the
+  // ends of each track without re-summing its taps per point
+  vector<float> kernel_cumsum (kernel.size() + 1, 0.0);
+  for (size_t c = 0; c < kernel.size(); ++c)
+    kernel_cumsum[c+1] = kernel_cumsum[c] + kernel[c];
+
+  const int iradius = int (radius);
+  Eigen::Map<const Eigen::Array<float, Eigen::Dynamic, 1>> kernel_map (kernel.data(), kernel.size());
+
   vector<value_type> tck_scalar;
   while (reader (tck_scalar)) {
-    vector<value_type> tck_scalars_smoothed (tck_scalar.size());
-
-    for (int i = 0; i < (int)tck_scalar.size(); ++i) {
-      float norm_factor = 0.0;
-      float value = 0.0;
-      for (int k = -(int)radius; k <= (int)radius; ++k) {
-        if (i + k >= 0 && i + k < (int)tck_scalar.size()) {
-          value += kernel[k + radius] * tck_scalar[i + k];
-          norm_factor += kernel[k + radius];
-        }
-      }
+    const int num_points = tck_scalar.size();
+    vector<value_type> tck_scalars_smoothed (num_points);
+    Eigen::Map<const Eigen::Array<value_type, Eigen::Dynamic, 1>> in (tck_scalar.data(), num_points);
+
+    for (int i = 0; i < num_points; ++i) {
+      const int lower = std::max (i - iradius, 0);
+      const int upper = std::min (i + iradius, num_points - 1);
+      const int offset = lower - i + iradius;
+      const int extent = upper - lower + 1;
+      const float value = (kernel_map.segment (offset, extent) * in.segment (lower, extent)).sum();
+      const float norm_factor = kernel_cumsum[offset + extent] - kernel_cumsum[offset];
       tck_scalars_smoothed[i] = value / norm_factor;
     }
     writer (tck_scalars_smoothed);
@@ -52,19 +52,12 @@ void run ()
   vector<value_type> tck_scalar;
   while (reader (tck_scalar)) {
     vector<value_type> tck_mask (tck_scalar.size());
-    for (size_t i = 0; i < tck_scalar.size(); ++i) {
-      if (invert) {
-        if (tck_scalar[i] > threshold)
-          tck_mask[i] = 0.0;
-        else
-          tck_mask[i] = 1.0;
-      } else {
-        if (tck_scalar[i] > threshold)
-          tck_mask[i] = 1.0;
-        else
-          tck_mask[i] = 0.0;
-      }
-    }
+    Eigen::Map<const Eigen::Array<value_type, Eigen::Dynamic, 1>> in (tck_scalar.data(), tck_scalar.size());
+    Eigen::Map<Eigen::Array<value_type, Eigen::Dynamic, 1>> out (tck_mask.data(), tck_mask.size());
+    if (invert)
+      out = value_type(1) - (in > threshold).cast<value_type>();
+    else
+      out = (in > threshold).cast<value_type>();
     writer (tck_mask);
   }
 }
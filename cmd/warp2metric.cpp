@@ -113,28 +113,52 @@ void run ()
 
   Adapter::Jacobian<Image<value_type> > jacobian (input);
 
-  for (auto i = Loop ("outputting warp metric(s)", jacobian, 0, 3) (jacobian); i; ++i) {
-    auto jacobian_matrix = jacobian.value();
-
-    if (fc_output_data.valid()) {
-      assign_pos_of (jacobian, 0, 3).to (fixel_template_index);
-      for (auto f = Fixel::Loop (fixel_template_index) (fixel_template_directions, fc_output_data); f; ++f) {
-        Eigen::Vector3f fixel_direction = fixel_template_directions.row(1);
-        fixel_direction.normalize();
-        Eigen::Vector3f fixel_direction_transformed = jacobian_matrix * fixel_direction;
-        fc_output_data.value() = jacobian_matrix.determinant() / fixel_direction_transformed.norm();
+  // process whole rows of voxels at a time: the adapter evaluates the
+  // finite differences for a full row in one vectorised sweep, and rows
+  // are distributed across threads
+  struct RowFunctor { NOMEMALIGN
+    Image<uint32_t> fixel_template_index;
+    Image<value_type> fixel_template_directions;
+    Image<value_type> fc_output_data;
+    Image<value_type> jmatrix_output;
+    Image<value_type> jdeterminant_output;
+    Adapter::Jacobian<Image<value_type>>::block_type block;
+    Eigen::Array<value_type, Eigen::Dynamic, 1> determinants;
+
+    void operator() (Adapter::Jacobian<Image<value_type>>& jacobian) {
+      jacobian.value_row (block);
+      if (fc_output_data.valid() || jdeterminant_output.valid())
+        determinants = Adapter::Jacobian<Image<value_type>>::determinant_row (block);
+
+      for (ssize_t x = 0; x < jacobian.size(0); ++x) {
+        jacobian.index(0) = x;
+        const Eigen::Map<const Eigen::Matrix<value_type,3,3>> jacobian_matrix (block.data() + 9*x);
+
+        if (fc_output_data.valid()) {
+          assign_pos_of (jacobian, 0, 3).to (fixel_template_index);
+          for (auto f = Fixel::Loop (fixel_template_index) (fixel_template_directions, fc_output_data); f; ++f) {
+            Eigen::Vector3f fixel_direction = fixel_template_directions.row(1);
+            fixel_direction.normalize();
+            Eigen::Vector3f fixel_direction_transformed = jacobian_matrix * fixel_direction;
+            fc_output_data.value() = determinants[x] / fixel_direction_transformed.norm();
+          }
+        }
+        if (jmatrix_output.valid()) {
+          assign_pos_of (jacobian, 0, 3).to (jmatrix_output);
+          for (size_t j = 0; j < 9; ++j) {
+            jmatrix_output.index(3) = j;
+            jmatrix_output.value() = block (j, x);
+          }
+        }
+        if (jdeterminant_output.valid()) {
+          assign_pos_of (jacobian, 0, 3).to (jdeterminant_output);
+          jdeterminant_output.value() = determinants[x];
+        }
       }
     }
-    if (jmatrix_output.valid()) {
-      assign_pos_of (jacobian, 0, 3).to (jmatrix_output);
-      for (size_t j = 0; j < 9; ++j) {
-        jmatrix_output.index(3) = j;
-        jmatrix_output.value() = jacobian_matrix.data()[j];
-      }
-    }
-    if (jdeterminant_output.valid()) {
-      assign_pos_of (jacobian, 0, 3).to (jdeterminant_output);
-      jdeterminant_output.value() = jacobian_matrix.determinant();
-    }
-  }
+  };
+
+  RowFunctor functor { fixel_template_index, fixel_template_directions, fc_output_data,
+                       jmatrix_output, jdeterminant_output, { }, { } };
+  ThreadedLoop ("outputting warp metric(s)", jacobian, 1, 3).run (functor, jacobian);
 }
@@ -16,10 +16,12 @@
 #define __algo_adapter_base_h__
 
 #include "image_helpers.h"
+#include "algo/loop.h"
 
 namespace MR
 {
   class Header;
+  template <typename ValueType> class Image;
 
   namespace Adapter
   {
@@ -29,6 +31,41 @@ namespace MR
         return AdapterType<ImageType> (parent, std::forward<Args> (args)...);
       }
 
+
+    //! \cond skip
+    namespace {
+
+      //! row-wise block copy from a coordinate-remapping adapter to a plain image
+      /* Copies one run at a time along \a axis, using the scanline fetch /
+       * store functions of the two Image buffers rather than per-voxel
+       * value() calls, so each run incurs a single conversion dispatch.
+       * The caller must have established that positions along \a axis map
+       * to a contiguous ascending span of the parent image's storage (see
+       * the eligibility checks in subset.h / extract.h), and that neither
+       * side uses direct IO. */
+      template <class AdapterType, typename ValueType>
+        void __block_copy_rows (AdapterType& source, Image<ValueType>& destination, const size_t axis)
+        {
+          const ssize_t row_length = source.size (axis);
+          vector<ValueType> row (row_length);
+          vector<size_t> outer_axes;
+          for (size_t n = 0; n < source.ndim(); ++n) {
+            if (n != axis)
+              outer_axes.push_back (n);
+          }
+          source.reset();
+          destination.reset();
+          for (auto l = Loop (outer_axes) (source, destination); l; ++l) {
+            source.index (axis) = 0;
+            destination.index (axis) = 0;
+            source.parent().buffer->get_values (row.data(), source.parent().offset(), row_length);
+            destination.buffer->set_values (row.data(), destination.offset(), row_length);
+          }
+        }
+
+    }
+    //! \endcond
+
     template <class AdapterType, class ImageType> 
       class Base : 
         public ImageBase<AdapterType, typename ImageType::value_type> 
@@ -15,6 +15,7 @@
 #ifndef __adapter_extract_h__
 #define __adapter_extract_h__
 
+#include "image.h"
 #include "adapter/base.h"
 
 namespace MR
@@ -158,6 +159,15 @@ namespace MR
           parent().index (axis) += indices[axis][current_pos[axis]] - indices[axis][prev];
         }
 
+        //! whether the index list along \a axis is a consecutive ascending run
+        bool contiguous (size_t axis) const {
+          for (ssize_t n = 1; n < sizes[axis]; ++n) {
+            if (indices[axis][n] != indices[axis][n-1] + 1)
+              return false;
+          }
+          return true;
+        }
+
       private:
         vector<size_t> current_pos;
         vector<vector<int> > indices;
@@ -165,7 +175,95 @@ namespace MR
         transform_type trans;
     };
 
+
+
+    //! \cond skip
+    namespace {
+
+      /* As for the Subset adapter (see subset.h), but additionally
+       * requiring that the index list along the parent's unit-stride axis
+       * is a consecutive ascending run, so that each row of the extraction
+       * maps to a contiguous span of the parent's storage; index lists
+       * along the other axes may be arbitrary, since those only determine
+       * where each run starts. Returns the axis along which to copy runs,
+       * or ndim() if the copy does not qualify. */
+      template <typename ValueType>
+        inline size_t __extract_block_copy_axis (const Extract<Image<ValueType>>& source, const Image<ValueType>& destination,
+            const size_t from_axis, const size_t to_axis)
+        {
+          if (from_axis != 0 || to_axis < source.ndim() || destination.ndim() != source.ndim())
+            return source.ndim();
+          if (source.parent().is_direct_io() || destination.is_direct_io())
+            return source.ndim();
+          size_t axis = source.ndim();
+          for (size_t n = 0; n < source.ndim(); ++n) {
+            if (destination.size (n) != source.size (n))
+              return source.ndim();
+            if (source.parent().stride (n) == 1)
+              axis = n;
+          }
+          if (axis == source.ndim() || destination.stride (axis) != 1 || !source.contiguous (axis))
+            return source.ndim();
+          return axis;
+        }
+
+    }
+    //! \endcond
+
   }
+
+
+
+  //! copy from an Extract adapter using contiguous-run block transfers where possible
+  template <typename ValueType>
+    inline void copy (Adapter::Extract<Image<ValueType>>& source, Image<ValueType>& destination,
+        size_t from_axis = 0, size_t to_axis = std::numeric_limits<size_t>::max())
+    {
+      const size_t axis = Adapter::__extract_block_copy_axis (source, destination, from_axis, to_axis);
+      if (axis < source.ndim()) {
+        Adapter::__block_copy_rows (source, destination, axis);
+        return;
+      }
+      for (auto i = Loop (source, from_axis, to_axis) (source, destination); i; ++i)
+        destination.value() = source.value();
+    }
+
+  //! see copy (Adapter::Extract&, Image&, size_t, size_t)
+  template <typename ValueType>
+    inline void threaded_copy (Adapter::Extract<Image<ValueType>>& source, Image<ValueType>& destination,
+        size_t from_axis = 0,
+        size_t to_axis = std::numeric_limits<size_t>::max(),
+        size_t num_axes_in_thread = 1)
+    {
+      const size_t axis = Adapter::__extract_block_copy_axis (source, destination, from_axis, to_axis);
+      if (axis < source.ndim()) {
+        Adapter::__block_copy_rows (source, destination, axis);
+        return;
+      }
+      ThreadedLoop (source, from_axis, to_axis, num_axes_in_thread)
+        .run (__copy_func(), source, destination);
+    }
+
+  //! see copy (Adapter::Extract&, Image&, size_t, size_t)
+  template <typename ValueType>
+    inline void threaded_copy_with_progress_message (
+        const std::string& message,
+        Adapter::Extract<Image<ValueType>>& source,
+        Image<ValueType>& destination,
+        size_t from_axis = 0,
+        size_t to_axis = std::numeric_limits<size_t>::max(),
+        size_t num_axes_in_thread = 1)
+    {
+      const size_t axis = Adapter::__extract_block_copy_axis (source, destination, from_axis, to_axis);
+      if (axis < source.ndim()) {
+        ProgressBar progress (message);
+        Adapter::__block_copy_rows (source, destination, axis);
+        return;
+      }
+      ThreadedLoop (message, source, from_axis, to_axis, num_axes_in_thread)
+        .run (__copy_func(), source, destination);
+    }
+
 }
 
 #endif
@@ -0,0 +1,182 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __adapter_fused_h__
+#define __adapter_fused_h__
+
+#include "adapter/base.h"
+#include "adapter/permute_axes.h"
+#include "adapter/subset.h"
+
+namespace MR
+{
+  namespace Adapter
+  {
+
+    //! a stack of coordinate-remapping adapters flattened to one mapping
+    /*! Each coordinate-remapping adapter in a chain (e.g. a PermuteAxes
+     * over a Subset) adds its own layer of index translation to every
+     * voxel access, so the cost of stacking them is multiplicative. The
+     * Fused adapter holds the composition of all such transforms as a
+     * single per-axis mapping (parent axis and starting index), so any
+     * depth of permutation / cropping collapses to one translation per
+     * access. Use the fuse() overloads below to flatten an existing
+     * adapter stack; further permuted() / cropped() operations can then
+     * be folded in directly. Adapters whose index mapping is not affine
+     * (e.g. Extract with arbitrary index lists) cannot be represented
+     * and are deliberately not handled. */
+    template <class ImageType>
+      class Fused :
+        public Base<Fused<ImageType>,ImageType>
+    { MEMALIGN(Fused<ImageType>)
+      public:
+
+        using base_type = Base<Fused<ImageType>, ImageType>;
+        using value_type = typename ImageType::value_type;
+
+        using base_type::name;
+        using base_type::parent;
+
+        //! identity view of the parent image
+        Fused (const ImageType& original) :
+          base_type (original),
+          transform_ (original.transform()) {
+            for (size_t n = 0; n < original.ndim(); ++n)
+              map_.push_back ({ n, 0, original.size(n) });
+            reset();
+          }
+
+        void reset () {
+          parent().reset();
+          for (auto& m : map_) {
+            if (m.axis == no_axis)
+              m.from = 0;
+            else
+              parent().index (m.axis) = m.from;
+          }
+        }
+
+        size_t ndim () const { return map_.size(); }
+        ssize_t size (size_t axis) const { return map_[axis].extent; }
+        ssize_t stride (size_t axis) const { return map_[axis].axis == no_axis ? 0 : parent().stride (map_[axis].axis); }
+        default_type spacing (size_t axis) const { return map_[axis].axis == no_axis ? 1.0 : parent().spacing (map_[axis].axis); }
+        const transform_type& transform () const { return transform_; }
+
+        ssize_t get_index (size_t axis) const {
+          const auto& m = map_[axis];
+          return m.axis == no_axis ? m.from : parent().index (m.axis) - m.from;
+        }
+        void move_index (size_t axis, ssize_t increment) {
+          auto& m = map_[axis];
+          if (m.axis == no_axis)
+            m.from += increment;
+          else
+            parent().index (m.axis) += increment;
+        }
+
+        //! fold an axis permutation into the mapping
+        /*! \a axes follows the PermuteAxes convention: each entry selects
+         * the axis of this view to appear at that position, with negative
+         * entries inserting new axes of extent one. */
+        Fused permuted (const vector<int>& axes) const {
+          for (size_t i = 0; i < map_.size(); ++i) {
+            bool retained = false;
+            for (auto a : axes)
+              if (a >= 0 && size_t(a) == i)
+                retained = true;
+            if (!retained && map_[i].extent != 1)
+              throw Exception ("omitted axis \"" + str(i) + "\" has dimension greater than 1");
+          }
+          Fused result (*this);
+          result.map_.clear();
+          for (auto a : axes) {
+            if (a < 0) {
+              result.map_.push_back ({ no_axis, 0, 1 });
+            } else {
+              if (size_t(a) >= map_.size())
+                throw Exception ("axis " + str(a) + " exceeds image dimensionality");
+              result.map_.push_back (map_[a]);
+            }
+          }
+          result.reset();
+          return result;
+        }
+
+        //! fold a rectangular crop into the mapping
+        Fused cropped (const vector<ssize_t>& from, const vector<ssize_t>& size) const {
+          assert (from.size() == ndim());
+          assert (size.size() == ndim());
+          Fused result (*this);
+          for (size_t n = 0; n < ndim(); ++n) {
+            if (from[n] + size[n] > map_[n].extent)
+              throw Exception ("dimensions requested for cropped view are out of bounds");
+            result.map_[n].from += from[n];
+            result.map_[n].extent = size[n];
+          }
+          for (size_t j = 0; j < 3; ++j)
+            for (size_t i = 0; i < 3; ++i)
+              result.transform_(i,3) += from[j] * spacing(j) * result.transform_(i,j);
+          result.reset();
+          return result;
+        }
+
+      protected:
+        static constexpr size_t no_axis = std::numeric_limits<size_t>::max();
+
+        //! mapping of one apparent axis onto the parent image
+        /* for inserted axes of extent one (axis == no_axis), \a from
+         * holds the current position instead of a starting index */
+        struct AxisMapping { NOMEMALIGN
+          size_t axis;
+          ssize_t from, extent;
+        };
+
+        vector<AxisMapping> map_;
+        transform_type transform_;
+    };
+
+
+
+    template <class ImageType>
+      Fused<ImageType> fuse (const ImageType& image);
+    template <class ImageType>
+      auto fuse (const PermuteAxes<ImageType>& adapter) -> decltype (fuse (std::declval<const ImageType&>()));
+    template <class ImageType>
+      auto fuse (const Subset<ImageType>& adapter) -> decltype (fuse (std::declval<const ImageType&>()));
+
+    //! wrap \a image in an identity Fused view
+    template <class ImageType>
+      inline Fused<ImageType> fuse (const ImageType& image) {
+        return Fused<ImageType> (image);
+      }
+
+    //! flatten a PermuteAxes adapter (and everything beneath it)
+    template <class ImageType>
+      inline auto fuse (const PermuteAxes<ImageType>& adapter) -> decltype (fuse (std::declval<const ImageType&>())) {
+        return fuse (adapter.parent()).permuted (adapter.permutation());
+      }
+
+    //! flatten a Subset adapter (and everything beneath it)
+    template <class ImageType>
+      inline auto fuse (const Subset<ImageType>& adapter) -> decltype (fuse (std::declval<const ImageType&>())) {
+        vector<ssize_t> size (adapter.ndim());
+        for (size_t n = 0; n < adapter.ndim(); ++n)
+          size[n] = adapter.size (n);
+        return fuse (adapter.parent()).cropped (adapter.from(), size);
+      }
+
+  }
+}
+
+#endif
@@ -55,6 +55,130 @@ namespace MR
         const bool wrt_scanner;
         Transform transform;
       };
+
+
+
+    //! computes all three gradient components in a single buffered pass
+    /*! Drop-in alternative to Gradient3D for callers that traverse the
+     * image in standard scanline order: rather than issuing six scattered
+     * single-voxel reads per position, the first access to each row loads
+     * the row and its four in-plane / through-plane neighbour rows into
+     * contiguous line buffers, and evaluates the finite-difference
+     * stencils for all three axes across the full row at once using
+     * vectorised Eigen array expressions. Subsequent accesses within the
+     * same row are served straight from the buffered results. Access at
+     * arbitrary positions remains valid (the row is simply recomputed),
+     * so out-of-order traversal degrades gracefully rather than failing. */
+    template <class ImageType>
+      class FusedGradient3D :
+        public Base<FusedGradient3D<ImageType>, ImageType>
+    { MEMALIGN(FusedGradient3D<ImageType>)
+
+      public:
+
+        using base_type = Base<FusedGradient3D<ImageType>, ImageType>;
+        using scalar_type = typename ImageType::value_type;
+        using value_type = Eigen::Matrix<scalar_type,3,1>;
+        using array_type = Eigen::Array<scalar_type,Eigen::Dynamic,1>;
+
+        using base_type::index;
+        using base_type::size;
+
+        FusedGradient3D (const ImageType& parent,
+                         bool wrt_scanner = false) :
+          base_type (parent),
+          wrt_scanner (wrt_scanner),
+          transform (parent),
+          row_position (parent.ndim(), -1),
+          centre (parent.size(0)),
+          lower (parent.size(0)),
+          upper (parent.size(0))
+        {
+          for (size_t axis = 0; axis != 3; ++axis)
+            gradient[axis].resize (parent.size(0));
+        }
+
+        value_type value ()
+        {
+          if (!row_is_current())
+            compute_row();
+          const ssize_t x = index(0);
+          value_type grad;
+          grad[0] = gradient[0][x];
+          grad[1] = gradient[1][x];
+          grad[2] = gradient[2][x];
+          if (wrt_scanner)
+            grad = transform.image2scanner.linear().template cast<scalar_type>() * grad;
+          return grad;
+        }
+
+      protected:
+        const bool wrt_scanner;
+        Transform transform;
+        // position along axes 1 and above for which the buffers are
+        //   valid; initialised to -1 so the first access always computes
+        vector<ssize_t> row_position;
+        array_type centre, lower, upper;
+        std::array<array_type,3> gradient;
+
+        bool row_is_current () const
+        {
+          for (size_t n = 1; n != row_position.size(); ++n)
+            if (index(n) != row_position[n])
+              return false;
+          return true;
+        }
+
+        //! read the full row along axis 0 at the current position
+        void load_row (array_type& data)
+        {
+          for (ssize_t x = 0; x != size(0); ++x) {
+            index(0) = x;
+            data[x] = base_type::value();
+          }
+        }
+
+        void compute_row ()
+        {
+          const ssize_t pos0 = index(0);
+          const ssize_t X = size(0);
+          load_row (centre);
+
+          if (X > 1) {
+            gradient[0].segment (1, X-2) = scalar_type(0.5) * (centre.segment (2, X-2) - centre.segment (0, X-2));
+            gradient[0][0] = centre[1] - centre[0];
+            gradient[0][X-1] = centre[X-1] - centre[X-2];
+          } else {
+            gradient[0][0] = scalar_type(0.0);
+          }
+
+          for (size_t axis = 1; axis != 3; ++axis) {
+            const ssize_t pos = index (axis);
+            if (size (axis) == 1) {
+              gradient[axis].setZero();
+            } else if (pos == 0) {
+              index (axis) = pos + 1;
+              load_row (upper);
+              gradient[axis] = upper - centre;
+            } else if (pos == size(axis) - 1) {
+              index (axis) = pos - 1;
+              load_row (lower);
+              gradient[axis] = centre - lower;
+            } else {
+              index (axis) = pos + 1;
+              load_row (upper);
+              index (axis) = pos - 1;
+              load_row (lower);
+              gradient[axis] = scalar_type(0.5) * (upper - lower);
+            }
+            index (axis) = pos;
+          }
+
+          index(0) = pos0;
+          for (size_t n = 1; n != row_position.size(); ++n)
+            row_position[n] = index(n);
+        }
+      };
   }
 }
 
@@ -32,11 +32,15 @@ namespace MR
 
           using base_type = Base<Jacobian<WarpType>, WarpType>;
           using value_type = Eigen::Matrix<typename WarpType::value_type, 3, 3>;
+          //! Jacobians for a full row of voxels, one per column in
+          //! column-major element order (i.e. matching value().data())
+          using block_type = Eigen::Matrix<typename WarpType::value_type, 9, Eigen::Dynamic>;
 
           using base_type::name;
           using base_type::size;
           using base_type::spacing;
           using base_type::index;
+          using base_type::parent;
 
           Jacobian (const WarpType& parent, bool wrt_scanner = true) :
             base_type (parent),
@@ -61,12 +65,115 @@ namespace MR
             return jacobian;
           }
 
+          //! compute the Jacobians for the entire row of voxels along axis 0
+          /*! at the current position along axes 1 & 2. The warp components
+           * for each of the five rows involved are gathered once into a
+           * structure-of-arrays buffer, and the finite differences (and the
+           * rotation into scanner space, if requested) are then evaluated
+           * across the whole row with vectorised array operations, rather
+           * than re-gathering the neighbourhood of every voxel as value()
+           * does. Column n of \a block holds the Jacobian at position n,
+           * in column-major element order. */
+          void value_row (block_type& block)
+          {
+            using vt = typename WarpType::value_type;
+            const ssize_t n = size(0);
+            block.resize (9, n);
+            const ssize_t pos[3] = { index(0), index(1), index(2) };
+            const ssize_t pos3 = index(3);
+
+            vt weight[3], half_weight[3];
+            for (size_t dim = 0; dim < 3; ++dim) {
+              weight[dim] = wrt_scanner ? vt(1.0) / vt(spacing(dim)) : vt(1.0);
+              half_weight[dim] = vt(0.5) * weight[dim];
+            }
+
+            // derivatives along the row axis: shifted differences within
+            // the centre row, one-sided at either end
+            read_row (centre);
+            for (size_t i = 0; i < 3; ++i) {
+              if (n > 2)
+                block.row(i).segment (1, n-2) = half_weight[0] * (centre.row(i).segment (2, n-2) - centre.row(i).segment (0, n-2));
+              block(i,0) = weight[0] * (centre(i,1) - centre(i,0));
+              block(i,n-1) = weight[0] * (centre(i,n-1) - centre(i,n-2));
+            }
+
+            // derivatives along the other two axes: whole-row differences
+            // between the neighbouring rows
+            for (size_t dim = 1; dim < 3; ++dim) {
+              if (pos[dim] == 0) {
+                parent().index(dim) = 1;
+                read_row (plus);
+                for (size_t i = 0; i < 3; ++i)
+                  block.row (3*dim + i) = weight[dim] * (plus.row(i) - centre.row(i));
+              }
+              else if (pos[dim] == size(dim) - 1) {
+                parent().index(dim) = pos[dim] - 1;
+                read_row (minus);
+                for (size_t i = 0; i < 3; ++i)
+                  block.row (3*dim + i) = weight[dim] * (centre.row(i) - minus.row(i));
+              }
+              else {
+                parent().index(dim) = pos[dim] + 1;
+                read_row (plus);
+                parent().index(dim) = pos[dim] - 1;
+                read_row (minus);
+                for (size_t i = 0; i < 3; ++i)
+                  block.row (3*dim + i) = half_weight[dim] * (plus.row(i) - minus.row(i));
+              }
+              parent().index(dim) = pos[dim];
+            }
+
+            if (wrt_scanner) {
+              // right-multiply every Jacobian by the image-to-scanner
+              // rotation, again sweeping across the row per element
+              const Eigen::Matrix<vt,3,3> linear = transform.scanner2image.linear().template cast<vt>();
+              for (size_t i = 0; i < 3; ++i) {
+                const Eigen::Matrix<vt,1,Eigen::Dynamic> c0 = block.row (i);
+                const Eigen::Matrix<vt,1,Eigen::Dynamic> c1 = block.row (3 + i);
+                const Eigen::Matrix<vt,1,Eigen::Dynamic> c2 = block.row (6 + i);
+                block.row (i)     = linear(0,0)*c0 + linear(1,0)*c1 + linear(2,0)*c2;
+                block.row (3 + i) = linear(0,1)*c0 + linear(1,1)*c1 + linear(2,1)*c2;
+                block.row (6 + i) = linear(0,2)*c0 + linear(1,2)*c1 + linear(2,2)*c2;
+              }
+            }
+
+            parent().index(0) = pos[0];
+            parent().index(3) = pos3;
+          }
+
+          //! vectorised determinants for a row of Jacobians from value_row()
+          static Eigen::Array<typename WarpType::value_type, Eigen::Dynamic, 1>
+            determinant_row (const block_type& m)
+          {
+            // cofactor expansion, evaluated across all columns at once
+            return ( m.row(0).array() * (m.row(4).array()*m.row(8).array() - m.row(7).array()*m.row(5).array())
+                   - m.row(3).array() * (m.row(1).array()*m.row(8).array() - m.row(7).array()*m.row(2).array())
+                   + m.row(6).array() * (m.row(1).array()*m.row(5).array() - m.row(4).array()*m.row(2).array()) ).transpose();
+          }
+
 
         protected:
           value_type jacobian;
           Gradient1D<WarpType> gradient1D;
           Transform transform;
           const bool wrt_scanner;
+          Eigen::Matrix<typename WarpType::value_type, 3, Eigen::Dynamic> centre, plus, minus;
+
+          //! gather the 3 warp components along axis 0 at the parent's
+          //! current position along the remaining axes
+          void read_row (Eigen::Matrix<typename WarpType::value_type, 3, Eigen::Dynamic>& buffer)
+          {
+            const ssize_t n = size(0);
+            buffer.resize (3, n);
+            for (size_t c = 0; c < 3; ++c) {
+              parent().index(3) = c;
+              for (ssize_t x = 0; x < n; ++x) {
+                parent().index(0) = x;
+                buffer(c,x) = parent().value();
+              }
+            }
+          }
       };
   }
 }
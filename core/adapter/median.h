@@ -82,23 +82,69 @@ namespace MR
             index(2) >= size(2)-extent[2] ? size(2) : index(2)+extent[2]+1
           };
 
-          values.clear();
-
-          for (index(2) = from[2]; index(2) < to[2]; ++index(2))
-            for (index(1) = from[1]; index(1) < to[1]; ++index(1))
-              for (index(0) = from[0]; index(0) < to[0]; ++index(0))
-                  values.push_back (base_type::value());
+          // when queried one voxel further along the first axis (as happens
+          //   for all but the first voxel of each row when driven by a
+          //   threaded or plain image copy), the kernel is updated by
+          //   removing the plane of values leaving the window and inserting
+          //   the plane entering it, rather than re-gathering and re-sorting
+          //   the full kernel:
+          if (index(0) == prev[0]+1 && index(1) == prev[1] && index(2) == prev[2]) {
+            for (index(2) = from[2]; index(2) < to[2]; ++index(2)) {
+              for (index(1) = from[1]; index(1) < to[1]; ++index(1)) {
+                for (index(0) = prev_from0; index(0) < from[0]; ++index(0))
+                  remove_value (base_type::value());
+                for (index(0) = prev_to0; index(0) < to[0]; ++index(0))
+                  insert_value (base_type::value());
+              }
+            }
+          }
+          else {
+            values.clear();
+            for (index(2) = from[2]; index(2) < to[2]; ++index(2))
+              for (index(1) = from[1]; index(1) < to[1]; ++index(1))
+                for (index(0) = from[0]; index(0) < to[0]; ++index(0))
+                  insert_value (base_type::value());
+          }
 
           index(0) = old_pos[0];
           index(1) = old_pos[1];
           index(2) = old_pos[2];
-
-            return Math::median (values);
+          prev[0] = old_pos[0];
+          prev[1] = old_pos[1];
+          prev[2] = old_pos[2];
+          prev_from0 = from[0];
+          prev_to0 = to[0];
+
+          // same conventions as Math::median() on the NaN-stripped kernel:
+          if (values.empty())
+            return std::numeric_limits<value_type>::quiet_NaN();
+          const size_t middle = values.size()/2;
+          value_type med_val = values[middle];
+          if (!(values.size()&1U))
+            med_val = (med_val + values[middle-1])/2.0;
+          return med_val;
         }
 
       protected:
         vector<int> extent;
+        // the current kernel contents, sorted, with any NaN values removed:
         vector<value_type> values;
+        ssize_t prev[3] = { -2, -2, -2 };
+        ssize_t prev_from0 = 0, prev_to0 = 0;
+
+        void insert_value (const value_type val) {
+          if (Math::not_a_number (val))
+            return;
+          values.insert (std::upper_bound (values.begin(), values.end(), val), val);
+        }
+
+        void remove_value (const value_type val) {
+          if (Math::not_a_number (val))
+            return;
+          const auto it = std::lower_bound (values.begin(), values.end(), val);
+          assert (it != values.end() && *it == val);
+          values.erase (it);
+        }
       };
 
   }
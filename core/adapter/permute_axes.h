@@ -74,6 +74,9 @@ next_axis:
 
           void reset () { parent().reset(); }
 
+          //! the (normalised) axis permutation, as passed to the constructor
+          const vector<int>& permutation () const { return axes_; }
+
           ssize_t get_index (size_t axis) const { const auto a = axes_[axis]; return a < 0 ? non_existent_axes[-1-a] : parent().index (a); }
           void move_index (size_t axis, ssize_t increment) {
             const auto a = axes_[axis];
@@ -196,7 +196,13 @@ namespace MR
             }
             return normalise<value_type> (sum, norm);
           }
-          interp.voxel (direct_transform * Vector3 (x[0], x[1], x[2]));
+          // the mapped position depends only on the first three axes, so
+          //   for 4D data the interpolator setup is re-used when volumes
+          //   are traversed innermost:
+          if (x[0] != pos_x[0] || x[1] != pos_x[1] || x[2] != pos_x[2]) {
+            interp.voxel (direct_transform * Vector3 (x[0], x[1], x[2]));
+            pos_x[0] = x[0]; pos_x[1] = x[1]; pos_x[2] = x[2];
+          }
           return interp.value();
         }
 
@@ -209,6 +215,7 @@ namespace MR
       private:
         Interpolator<ImageType> interp;
         ssize_t x[3];
+        ssize_t pos_x[3] = { -1, -1, -1 };
         const ssize_t dim[3];
         const default_type vox[3];
         bool oversampling;
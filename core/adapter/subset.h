@@ -33,6 +33,7 @@ namespace MR
 
         using base_type::name;
         using base_type::spacing;
+        using base_type::parent;
 
         template <class VectorType>
           Subset (const ImageType& original, const VectorType& from, const VectorType& size) :
@@ -59,16 +60,105 @@ namespace MR
         ssize_t size (size_t axis) const { return size_ [axis]; }
         const transform_type& transform() const { return transform_; }
 
+        //! the position of the subset's origin within the parent image
+        const vector<ssize_t>& from () const { return from_; }
+
         ssize_t get_index (size_t axis) const { return parent().index(axis)-from_[axis]; }
         void move_index (size_t axis, ssize_t increment) { parent().index(axis) += increment; }
 
       protected:
-        using base_type::parent;
         const vector<ssize_t> from_, size_;
         transform_type transform_;
     };
 
+
+
+    //! \cond skip
+    namespace {
+
+      /* A Subset over a plain indirect-IO image maps each position along
+       * the parent's unit-stride axis to a contiguous span of storage, so
+       * copies can proceed one full run at a time; this returns the axis
+       * along which to copy runs, or ndim() if the copy does not qualify
+       * (partial axis range, direct-IO access on either side, mismatched
+       * dimensions, or no forward unit-stride axis shared by both). */
+      template <typename ValueType>
+        inline size_t __subset_block_copy_axis (const Subset<Image<ValueType>>& source, const Image<ValueType>& destination,
+            const size_t from_axis, const size_t to_axis)
+        {
+          if (from_axis != 0 || to_axis < source.ndim() || destination.ndim() != source.ndim())
+            return source.ndim();
+          if (source.parent().is_direct_io() || destination.is_direct_io())
+            return source.ndim();
+          size_t axis = source.ndim();
+          for (size_t n = 0; n < source.ndim(); ++n) {
+            if (destination.size (n) != source.size (n))
+              return source.ndim();
+            if (source.parent().stride (n) == 1)
+              axis = n;
+          }
+          if (axis == source.ndim() || destination.stride (axis) != 1)
+            return source.ndim();
+          return axis;
+        }
+
+    }
+    //! \endcond
+
   }
+
+
+
+  //! copy from a Subset adapter using contiguous-run block transfers where possible
+  template <typename ValueType>
+    inline void copy (Adapter::Subset<Image<ValueType>>& source, Image<ValueType>& destination,
+        size_t from_axis = 0, size_t to_axis = std::numeric_limits<size_t>::max())
+    {
+      const size_t axis = Adapter::__subset_block_copy_axis (source, destination, from_axis, to_axis);
+      if (axis < source.ndim()) {
+        Adapter::__block_copy_rows (source, destination, axis);
+        return;
+      }
+      for (auto i = Loop (source, from_axis, to_axis) (source, destination); i; ++i)
+        destination.value() = source.value();
+    }
+
+  //! see copy (Adapter::Subset&, Image&, size_t, size_t)
+  template <typename ValueType>
+    inline void threaded_copy (Adapter::Subset<Image<ValueType>>& source, Image<ValueType>& destination,
+        size_t from_axis = 0,
+        size_t to_axis = std::numeric_limits<size_t>::max(),
+        size_t num_axes_in_thread = 1)
+    {
+      const size_t axis = Adapter::__subset_block_copy_axis (source, destination, from_axis, to_axis);
+      if (axis < source.ndim()) {
+        Adapter::__block_copy_rows (source, destination, axis);
+        return;
+      }
+      ThreadedLoop (source, from_axis, to_axis, num_axes_in_thread)
+        .run (__copy_func(), source, destination);
+    }
+
+  //! see copy (Adapter::Subset&, Image&, size_t, size_t)
+  template <typename ValueType>
+    inline void threaded_copy_with_progress_message (
+        const std::string& message,
+        Adapter::Subset<Image<ValueType>>& source,
+        Image<ValueType>& destination,
+        size_t from_axis = 0,
+        size_t to_axis = std::numeric_limits<size_t>::max(),
+        size_t num_axes_in_thread = 1)
+    {
+      const size_t axis = Adapter::__subset_block_copy_axis (source, destination, from_axis, to_axis);
+      if (axis < source.ndim()) {
+        ProgressBar progress (message);
+        Adapter::__block_copy_rows (source, destination, axis);
+        return;
+      }
+      ThreadedLoop (message, source, from_axis, to_axis, num_axes_in_thread)
+        .run (__copy_func(), source, destination);
+    }
+
 }
 
 #endif
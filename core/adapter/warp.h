@@ -84,10 +84,18 @@ namespace MR
 
 
         value_type value () {
-          Eigen::Vector3 pos = get_position();
-          if (std::isnan(pos[0]) || std::isnan(pos[1]) || std::isnan(pos[2]))
+          // the warp lookup and interpolator position depend only on the
+          //   first three axes, so for 4D data they are re-used when
+          //   volumes are traversed innermost:
+          if (x[0] != pos_x[0] || x[1] != pos_x[1] || x[2] != pos_x[2]) {
+            const Eigen::Vector3 pos = get_position();
+            pos_x[0] = x[0]; pos_x[1] = x[1]; pos_x[2] = x[2];
+            position_valid = ! (std::isnan(pos[0]) || std::isnan(pos[1]) || std::isnan(pos[2]));
+            if (position_valid)
+              interp.scanner (pos);
+          }
+          if (!position_valid)
             return value_when_out_of_bounds;
-          interp.scanner (pos);
           return interp.value();
         }
 
@@ -110,6 +118,8 @@ namespace MR
         Interpolator<ImageType> interp;
         WarpType warp;
         ssize_t x[3];
+        ssize_t pos_x[3] = { -1, -1, -1 };
+        bool position_valid = false;
         const ssize_t dim[3];
         const default_type vox[3];
         value_type value_when_out_of_bounds;
@@ -16,10 +16,12 @@
 #define __algo_histogram_h__
 
 #include <cmath>
+#include <mutex>
 
 #include "image_helpers.h"
 #include "types.h"
 #include "algo/loop.h"
+#include "algo/threaded_loop.h"
 
 namespace MR
 {
@@ -61,6 +63,15 @@ namespace MR
 
           void from_file (const std::string&);
 
+          //! combine the observations of another Calibrator into this one
+          /*! used to merge per-thread calibrators following a multi-threaded
+           * pass over the image; must be invoked before finalize() */
+          void merge (const Calibrator& that) {
+            min = std::min (min, that.min);
+            max = std::max (max, that.max);
+            data.insert (data.end(), that.data.begin(), that.data.end());
+          }
+
           void finalize (const size_t num_volumes, const bool is_integer);
 
           default_type get_bin_centre (const size_t i) const {
@@ -117,6 +128,14 @@ namespace MR
           }
 
 
+          //! combine the bin counts of another (identically-calibrated) histogram
+          /*! used to merge per-thread histograms following a multi-threaded
+           * pass over the image */
+          void merge (const Data& that) {
+            assert (that.list.size() == list.size());
+            list += that.list;
+          }
+
           size_t operator[] (const size_t index) const {
             assert (index < size_t(list.size()));
             return list[index];
@@ -140,12 +159,80 @@ namespace MR
       };
 
 
+      //! \cond skip
+      namespace {
+
+        // per-thread accumulation kernels for multi-threaded calibration &
+        //   histogram generation: each thread accumulates into its own local
+        //   copy, which is merged into the shared result on destruction
+
+        class CalibratorKernel { MEMALIGN (CalibratorKernel)
+          public:
+            CalibratorKernel (Calibrator& overall) :
+                overall (overall),
+                local (overall.get_num_bins(), overall.get_ignore_zero()) { }
+
+            ~CalibratorKernel () {
+              std::lock_guard<std::mutex> lock (mutex);
+              overall.merge (local);
+            }
+
+            template <class ImageType>
+            void operator() (ImageType& image) {
+              local (typename ImageType::value_type (image.value()));
+            }
+            template <class ImageType, class MaskType>
+            void operator() (ImageType& image, MaskType& mask) {
+              if (mask.value())
+                local (typename ImageType::value_type (image.value()));
+            }
+
+          protected:
+            Calibrator& overall;
+            Calibrator local;
+            static std::mutex mutex;
+        };
+        std::mutex CalibratorKernel::mutex;
+
+        class DataKernel { MEMALIGN (DataKernel)
+          public:
+            DataKernel (Data& overall) :
+                overall (overall),
+                local (overall.get_calibration()) { }
+
+            ~DataKernel () {
+              std::lock_guard<std::mutex> lock (mutex);
+              overall.merge (local);
+            }
+
+            template <class ImageType>
+            void operator() (ImageType& image) {
+              local (typename ImageType::value_type (image.value()));
+            }
+            template <class ImageType, class MaskType>
+            void operator() (ImageType& image, MaskType& mask) {
+              if (mask.value())
+                local (typename ImageType::value_type (image.value()));
+            }
+
+          protected:
+            Data& overall;
+            Data local;
+            static std::mutex mutex;
+        };
+        std::mutex DataKernel::mutex;
+
+      }
+      //! \endcond
+
+
+
+
       // Convenience functions for calibrating (& histograming) basic input images
       template <class ImageType>
       void calibrate (Calibrator& result, ImageType& image)
       {
-        for (auto l = Loop(image) (image); l; ++l)
-          result (image.value());
+        ThreadedLoop (image).run (CalibratorKernel (result), image);
         result.finalize (image.ndim() > 3 ? image.size(3) : 1, std::is_integral<typename ImageType::value_type>::value);
       }
 
@@ -158,10 +245,7 @@ namespace MR
         }
         if (!dimensions_match (image, mask))
           throw Exception ("Image and mask for histogram generation do not match");
-        for (auto l = Loop(image) (image, mask); l; ++l) {
-          if (mask.value())
-            result (image.value());
-        }
+        ThreadedLoop (image).run (CalibratorKernel (result), image, mask);
         result.finalize (image.ndim() > 3 ? image.size(3) : 1, std::is_integral<typename ImageType::value_type>::value);
       }
 
@@ -185,8 +269,7 @@ namespace MR
       Data generate (const Calibrator& calibrator, ImageType& image)
       {
         Data result (calibrator);
-        for (auto l = Loop(image) (image); l; ++l)
-          result (typename ImageType::value_type (image.value()));
+        ThreadedLoop (image).run (DataKernel (result), image);
         return result;
       }
 
@@ -196,10 +279,7 @@ namespace MR
         if (!mask.valid())
           return generate (calibrator, image);
         Data result (calibrator);
-        for (auto l = Loop(image) (image, mask); l; ++l) {
-          if (mask.value())
-            result (typename ImageType::value_type (image.value()));
-        }
+        ThreadedLoop (image).run (DataKernel (result), image, mask);
         return result;
       }
 
@@ -393,6 +393,89 @@ namespace MR
       FORCE_INLINE Run<ImageType...> operator() (ImageType&... images) const { return { axes, std::tie (images...) }; }
   };
 
+  /* edge length (in voxels) of the cubic tiles visited by TiledLoop(). A
+     tile of 16^3 single-precision values occupies 16 KiB, so even with the
+     one-voxel halo read by typical neighbourhood kernels the working set
+     remains resident in a 32 KiB L1 data cache. */
+  #define LOOP_TILE_EXTENT 16
+
+  //! tile-ordered traversal over a range of axes
+  /*! visits all positions within a cube of LOOP_TILE_EXTENT voxels per
+   * side before moving on to the next tile, with tiles themselves visited
+   * in axis-nested order. Neighbourhood operators traversing in plain
+   * scanline order revisit each off-row neighbour long after it was last
+   * loaded, evicting the working set on every row of a large volume;
+   * confining the traversal to tiles keeps those revisits cache-resident.
+   * Iteration covers exactly the same set of positions as
+   * Loop(axis_from, axis_to), only in a different order, so it is not
+   * suitable where output ordering matters (e.g. streamed writes). */
+  struct LoopAlongAxesTiled { NOMEMALIGN
+    const size_t from, to;
+    const ssize_t tile_extent;
+
+    template <class... ImageType>
+      struct Run { NOMEMALIGN
+        const size_t from, to;
+        const ssize_t tile_extent;
+        const std::tuple<ImageType&...> vox;
+        vector<ssize_t> origin;
+        bool ok;
+        FORCE_INLINE Run (const size_t axis_from, const size_t axis_to, const ssize_t tile_extent, const std::tuple<ImageType&...>& vox) :
+          from (axis_from),
+          to (std::min<size_t> (axis_to ? axis_to : std::get<0>(vox).ndim(), std::get<0>(vox).ndim())),
+          tile_extent (tile_extent), vox (vox), origin (to - from, 0), ok (true) {
+            for (size_t n = from; n < to; ++n)
+              apply (set_pos (n, 0), vox);
+          }
+        FORCE_INLINE operator bool() const { return ok; }
+        FORCE_INLINE void operator++() {
+          // advance within the current tile:
+          for (size_t axis = from; axis != to; ++axis) {
+            apply (inc_pos (axis), vox);
+            if (std::get<0>(vox).index(axis) < std::min (origin[axis-from] + tile_extent, std::get<0>(vox).size(axis)))
+              return;
+            apply (set_pos (axis, origin[axis-from]), vox);
+          }
+          // tile exhausted; move on to the next tile origin:
+          for (size_t axis = from; axis != to; ++axis) {
+            origin[axis-from] += tile_extent;
+            if (origin[axis-from] < std::get<0>(vox).size(axis)) {
+              for (size_t n = from; n != to; ++n)
+                apply (set_pos (n, origin[n-from]), vox);
+              return;
+            }
+            origin[axis-from] = 0;
+          }
+          ok = false;
+        }
+        FORCE_INLINE void operator++(int) { operator++(); }
+      };
+
+    template <class... ImageType>
+      FORCE_INLINE Run<ImageType...> operator() (ImageType&... images) const { return { from, to, tile_extent, std::tie (images...) }; }
+  };
+
+  struct LoopAlongAxesTiledProgress : public LoopAlongAxesTiled { NOMEMALIGN
+    const std::string text;
+    LoopAlongAxesTiledProgress (const std::string& text, const size_t from, const size_t to, const ssize_t tile_extent) :
+      LoopAlongAxesTiled ({ from, to, tile_extent }), text (text) { }
+
+    template <class... ImageType>
+      struct Run : public LoopAlongAxesTiled::Run<ImageType...> { NOMEMALIGN
+        MR::ProgressBar progress;
+        FORCE_INLINE Run (const std::string& text, const size_t from, const size_t to, const ssize_t tile_extent, const std::tuple<ImageType&...>& vox) :
+          LoopAlongAxesTiled::Run<ImageType...> (from, to, tile_extent, vox),
+          progress (text, MR::voxel_count (std::get<0>(vox), this->from, this->to)) { }
+        FORCE_INLINE void operator++() { LoopAlongAxesTiled::Run<ImageType...>::operator++(); ++progress; }
+        FORCE_INLINE void operator++(int) { operator++(); }
+      };
+
+    template <class... ImageType>
+      FORCE_INLINE Run<ImageType...> operator() (ImageType&... images) const { return { text, from, to, tile_extent, std::tie (images...) }; }
+  };
+
+
+
   struct LoopAlongDynamicAxesProgress : public LoopAlongDynamicAxes { NOMEMALIGN
       const std::string text;
       LoopAlongDynamicAxesProgress (const std::string& text, const vector<size_t>& axes) : 
@@ -413,6 +496,104 @@ namespace MR
 
 
 
+  //! loop over a set of axes, coalescing contiguous axes into flat runs
+  /*! At construction of the run (i.e. once all images taking part in the
+   * loop are known), adjacent axes of the traversal order are merged into
+   * a single flat inner iteration whenever every image stores them as one
+   * contiguous ascending block (stride of each subsequent axis equal to
+   * the stride of the innermost axis multiplied by the number of voxels
+   * merged so far). For plain images this typically collapses the whole
+   * spatial extent into one run, eliminating the per-voxel multi-axis
+   * index arithmetic that otherwise dominates memory-bound operations.
+   * Where no coalescing is possible, iteration is identical to the
+   * stride-ordered Loop() over the same axes.
+   *
+   * \warning while coalescing is active, only the index along the
+   * innermost axis is advanced (the indices along the other merged axes
+   * remain at zero, with the innermost index running beyond its nominal
+   * size); image data offsets remain correct throughout, but the loop
+   * body must therefore access the images through value() only, and must
+   * not inspect index(). */
+  struct LoopAlongContiguousAxes { NOMEMALIGN
+    const vector<size_t> axes;
+
+    //! \cond skip
+    struct check_contiguous { NOMEMALIGN
+      FORCE_INLINE check_contiguous (const size_t inner, const size_t axis, const ssize_t run_length) :
+        inner (inner), axis (axis), run_length (run_length), ok (true) { }
+      template <class ImageType>
+        FORCE_INLINE void operator() (ImageType& vox) { ok = ok && (vox.stride (axis) == vox.stride (inner) * run_length); }
+      const size_t inner, axis;
+      const ssize_t run_length;
+      bool ok;
+    };
+    //! \endcond
+
+    template <class... ImageType>
+      struct Run { NOMEMALIGN
+        const vector<size_t> axes;
+        const std::tuple<ImageType&...> vox;
+        const size_t from;
+        ssize_t run_length;
+        size_t num_coalesced;
+        bool ok;
+        FORCE_INLINE Run (const vector<size_t>& axes, const std::tuple<ImageType&...>& vox) :
+          axes (axes), vox (vox), from (axes[0]), run_length (std::get<0>(vox).size(from)), num_coalesced (1), ok (true) {
+            for (auto axis : axes)
+              apply (set_pos (axis, 0), vox);
+            while (num_coalesced < axes.size()) {
+              check_contiguous check (from, axes[num_coalesced], run_length);
+              apply (check, vox);
+              if (!check.ok)
+                break;
+              run_length *= std::get<0>(vox).size (axes[num_coalesced]);
+              ++num_coalesced;
+            }
+          }
+        FORCE_INLINE operator bool() const { return ok; }
+        FORCE_INLINE void operator++() {
+          apply (inc_pos (from), vox);
+          if (std::get<0>(vox).index(from) < run_length)
+            return;
+
+          apply (set_pos (from, 0), vox);
+          size_t n = num_coalesced;
+          while (n < axes.size()) {
+            apply (inc_pos (axes[n]), vox);
+            if (std::get<0>(vox).index(axes[n]) < std::get<0>(vox).size(axes[n]))
+              return;
+            apply (set_pos (axes[n], 0), vox);
+            ++n;
+          }
+          ok = false;
+        }
+        FORCE_INLINE void operator++(int) { operator++(); }
+      };
+
+    template <class... ImageType>
+      FORCE_INLINE Run<ImageType...> operator() (ImageType&... images) const { return { axes, std::tie (images...) }; }
+  };
+
+  struct LoopAlongContiguousAxesProgress : public LoopAlongContiguousAxes { NOMEMALIGN
+    const std::string text;
+    LoopAlongContiguousAxesProgress (const std::string& text, const vector<size_t>& axes) :
+      LoopAlongContiguousAxes ({ axes }), text (text) { }
+
+    template <class... ImageType>
+      struct Run : public LoopAlongContiguousAxes::Run<ImageType...> { NOMEMALIGN
+        MR::ProgressBar progress;
+        FORCE_INLINE Run (const std::string& text, const vector<size_t>& axes, const std::tuple<ImageType&...>& vox) :
+          LoopAlongContiguousAxes::Run<ImageType...> (axes, vox), progress (text, MR::voxel_count (std::get<0>(vox), axes)) { }
+        FORCE_INLINE void operator++() { LoopAlongContiguousAxes::Run<ImageType...>::operator++(); ++progress; }
+        FORCE_INLINE void operator++(int) { operator++(); }
+      };
+
+    template <class... ImageType>
+      FORCE_INLINE Run<ImageType...> operator() (ImageType&... images) const { return { text, axes, std::tie (images...) }; }
+  };
+
+
+
   FORCE_INLINE LoopAlongAxes Loop () { return { }; }
   FORCE_INLINE LoopAlongAxesProgress Loop (const std::string& progress_message) { return { progress_message }; }
   FORCE_INLINE LoopAlongSingleAxis Loop (size_t axis) { return { axis }; }
@@ -425,7 +606,21 @@ namespace MR
   FORCE_INLINE LoopAlongDynamicAxesProgress Loop (const std::string& progress_message, const vector<size_t>& axes) { return { progress_message, axes }; }
 
   template <class ImageType>
-    FORCE_INLINE LoopAlongDynamicAxes 
+    FORCE_INLINE LoopAlongContiguousAxes
+    FlatLoop (const ImageType& source, size_t axis_from = 0, size_t axis_to = std::numeric_limits<size_t>::max()) {
+      return { Stride::order (source, axis_from, axis_to) };
+    }
+  template <class ImageType>
+    FORCE_INLINE LoopAlongContiguousAxesProgress
+    FlatLoop (const std::string& progress_message, const ImageType& source, size_t axis_from = 0, size_t axis_to = std::numeric_limits<size_t>::max()) {
+      return { progress_message, Stride::order (source, axis_from, axis_to) };
+    }
+
+  FORCE_INLINE LoopAlongAxesTiled TiledLoop (size_t axis_from = 0, size_t axis_to = 3, ssize_t tile_extent = LOOP_TILE_EXTENT) { return { axis_from, axis_to, tile_extent }; }
+  FORCE_INLINE LoopAlongAxesTiledProgress TiledLoop (const std::string& progress_message, size_t axis_from = 0, size_t axis_to = 3, ssize_t tile_extent = LOOP_TILE_EXTENT) { return { progress_message, axis_from, axis_to, tile_extent }; }
+
+  template <class ImageType>
+    FORCE_INLINE LoopAlongDynamicAxes
     Loop (const ImageType& source, size_t axis_from = 0, size_t axis_to = std::numeric_limits<size_t>::max(), 
         typename std::enable_if<std::is_class<ImageType>::value && !std::is_same<ImageType, std::string>::value, int>::type = 0) {
       return { Stride::order (source, axis_from, axis_to) }; 
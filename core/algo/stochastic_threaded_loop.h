@@ -30,6 +30,17 @@ namespace MR
 
   namespace {
 
+    //! flattened index of the outer-loop position, used to key the
+    //! counter-based RNG: the skip/use decisions for a given chunk of
+    //! voxels then depend only on the seed and the position, not on
+    //! which thread happens to process it or on the thread count
+    FORCE_INLINE uint64_t __stochastic_stream_of (const Iterator& pos) {
+      uint64_t stream = 0;
+      for (size_t n = pos.ndim(); n-- != 0; )
+        stream = stream * uint64_t (pos.size(n)) + uint64_t (pos.index(n));
+      return stream;
+    }
+
 
     template <int N, class Functor, class... ImageType>
       struct StochasticThreadedLoopRunInner
@@ -38,22 +49,23 @@ namespace MR
         decltype (Loop (outer_axes)) loop;
         typename std::remove_reference<Functor>::type func;
         double density;
-        Math::RNG::Uniform<double> rng;
+        Math::PhiloxRNG rng;
+        std::uniform_real_distribution<double> uniform;
         std::tuple<ImageType...> vox;
 
         StochasticThreadedLoopRunInner (const vector<size_t>& outer_axes, const vector<size_t>& inner_axes,
             const Functor& functor, const double voxel_density, ImageType&... voxels) :
           outer_axes (outer_axes),
           loop (Loop (inner_axes)),
-          func (functor), 
-          density (voxel_density), 
-          rng (Math::RNG::Uniform<double>()),
+          func (functor),
+          density (voxel_density),
           vox (voxels...) { }
 
         void operator() (const Iterator& pos) {
           assign_pos_of (pos, outer_axes).to (vox);
+          rng.set_stream (__stochastic_stream_of (pos));
           for (auto i = unpack (loop, vox); i; ++i) {
-            if (rng() >= density){
+            if (uniform (rng) >= density){
               //DEBUG (str(pos) + " ...skipped inner");
               continue;
             }
@@ -71,7 +83,8 @@ namespace MR
         decltype (Loop (outer_axes)) loop;
         typename std::remove_reference<Functor>::type func;
         double density;
-        Math::RNG::Uniform<double> rng;
+        Math::PhiloxRNG rng;
+        std::uniform_real_distribution<double> uniform;
 
 
         StochasticThreadedLoopRunInner (const vector<size_t>& outer_axes, const vector<size_t>& inner_axes,
@@ -79,12 +92,12 @@ namespace MR
           outer_axes (outer_axes),
           loop (Loop (inner_axes)),
           func (functor),
-          density (voxel_density),
-          rng (Math::RNG::Uniform<double>()) {  }
+          density (voxel_density) {  }
 
         void operator() (Iterator& pos) {
+          rng.set_stream (__stochastic_stream_of (pos));
           for (auto i = loop (pos); i; ++i){
-            if (rng() >= density){
+            if (uniform (rng) >= density){
               // DEBUG (str(pos) + " ...skipped inner");
               continue;
             }
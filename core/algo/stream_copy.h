@@ -0,0 +1,250 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __algo_stream_copy_h__
+#define __algo_stream_copy_h__
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+#include "image.h"
+#include "thread.h"
+#include "adapter/subset.h"
+#include "algo/copy.h"
+#include "algo/threaded_copy.h"
+
+//! default amount of RAM (in bytes) devoted to each of the two slab buffers
+#define MRTRIX_STREAM_SLAB_BUFFER_SIZE 134217728
+
+namespace MR
+{
+
+  /* Streaming block-wise processing: rather than preloading an entire image
+   * (which for large 4D datasets can exceed available RAM), the image is
+   * windowed through a pair of bounded scratch buffers, each holding a slab
+   * of consecutive slices along the outermost (slowest-varying) axis. While
+   * one slab is being processed, a background thread prefetches the next one,
+   * so that processing runs in constant memory and I/O is overlapped with
+   * computation. */
+
+  //! \cond skip
+
+  namespace
+  {
+
+    // background loader: waits to be handed a scratch buffer and a slab
+    // position, fills the buffer from the source image, and signals
+    // completion; raising the quit flag terminates the thread:
+    template <class InputImageType, typename value_type>
+      class __SlabPrefetch { NOMEMALIGN
+        public:
+          __SlabPrefetch (const InputImageType& source, size_t axis) :
+            source (source), axis (axis), slab (nullptr), from (0), done (true), quit (false) { }
+
+          void request (Image<value_type>& buffer, ssize_t slab_from, ssize_t slab_size) {
+            std::lock_guard<std::mutex> lock (mutex);
+            slab = &buffer;
+            from = slab_from;
+            size = slab_size;
+            done = false;
+            cond.notify_all();
+          }
+
+          //! block until the pending request completes; rethrows any
+          //! exception raised on the prefetch thread
+          void wait () {
+            std::unique_lock<std::mutex> lock (mutex);
+            cond.wait (lock, [this]{ return done || error; });
+            if (error)
+              std::rethrow_exception (error);
+          }
+
+          void stop () {
+            std::lock_guard<std::mutex> lock (mutex);
+            quit = true;
+            cond.notify_all();
+          }
+
+          void execute () {
+            std::unique_lock<std::mutex> lock (mutex);
+            while (true) {
+              cond.wait (lock, [this]{ return quit || !done; });
+              if (quit)
+                return;
+              Image<value_type>& buffer (*slab);
+              const ssize_t slab_from = from, slab_size = size;
+              lock.unlock();
+
+              try {
+                InputImageType src (source);
+                vector<ssize_t> subset_from (src.ndim(), 0), subset_size;
+                for (size_t n = 0; n < src.ndim(); ++n)
+                  subset_size.push_back (src.size (n));
+                subset_from[axis] = slab_from;
+                subset_size[axis] = slab_size;
+                Adapter::Subset<InputImageType> src_slab (src, subset_from, subset_size);
+                if (slab_size == buffer.size (axis))
+                  copy (src_slab, buffer);
+                else {
+                  // final (partial) slab: only fill the used portion of the buffer:
+                  vector<ssize_t> buffer_from (buffer.ndim(), 0);
+                  Adapter::Subset<Image<value_type>> buffer_slab (buffer, buffer_from, subset_size);
+                  copy (src_slab, buffer_slab);
+                }
+              }
+              catch (...) {
+                // hand the exception over to the main thread, which will
+                // rethrow it from wait():
+                lock.lock();
+                error = std::current_exception();
+                cond.notify_all();
+                return;
+              }
+
+              lock.lock();
+              done = true;
+              cond.notify_all();
+            }
+          }
+
+        private:
+          const InputImageType& source;
+          const size_t axis;
+          Image<value_type>* slab;
+          ssize_t from, size;
+          bool done, quit;
+          std::exception_ptr error;
+          std::mutex mutex;
+          std::condition_variable cond;
+      };
+
+
+    // pick the number of slices per slab so that each of the two scratch
+    // buffers stays within the requested memory budget:
+    template <class HeaderType>
+      inline ssize_t __slab_size_for_budget (const HeaderType& header, size_t axis, size_t budget) {
+        size_t slice_count = 1;
+        for (size_t n = 0; n < header.ndim(); ++n)
+          if (n != axis)
+            slice_count *= header.size (n);
+        const size_t bytes_per_slice = footprint<typename HeaderType::value_type> (slice_count);
+        return std::max<ssize_t> (1, budget / bytes_per_slice);
+      }
+
+  }
+
+  //! \endcond
+
+
+
+
+  //! apply \a functor to bounded in-RAM slabs of \a source in turn
+  /*! the image is split into slabs of \a slab_size consecutive positions
+   * along its outermost axis (sized to fit the memory budget if \a slab_size
+   * is zero); each slab is loaded into a scratch buffer and passed to
+   * \code functor (slab, from, size) \endcode, where \a slab is an
+   * Image<value_type> holding the data, and \a from & \a size give the extent
+   * it covers along the slab axis (the buffer may extend beyond \a size for
+   * the final slab). While one slab is being processed, the next is
+   * prefetched by a background thread. */
+  template <class InputImageType, class Functor>
+    void stream_slabs (InputImageType& source, Functor&& functor, ssize_t slab_size = 0)
+    {
+      using value_type = typename InputImageType::value_type;
+      const size_t axis = source.ndim() - 1;
+      if (!slab_size)
+        slab_size = __slab_size_for_budget (source, axis, MRTRIX_STREAM_SLAB_BUFFER_SIZE);
+      slab_size = std::min (slab_size, source.size (axis));
+
+      Header slab_header (source);
+      slab_header.size (axis) = slab_size;
+      auto current = Image<value_type>::scratch (slab_header, "streaming slab buffer");
+      auto next = Image<value_type>::scratch (slab_header, "streaming slab buffer");
+
+      __SlabPrefetch<InputImageType,value_type> prefetch (source, axis);
+      auto prefetch_thread = Thread::run (prefetch, "slab prefetch");
+
+      try {
+        prefetch.request (next, 0, slab_size);
+        for (ssize_t from = 0; from < source.size (axis); from += slab_size) {
+          prefetch.wait();
+          std::swap (current, next);
+          const ssize_t next_from = from + slab_size;
+          if (next_from < source.size (axis))
+            prefetch.request (next, next_from, std::min (slab_size, source.size (axis) - next_from));
+          functor (current, from, std::min (slab_size, source.size (axis) - from));
+        }
+      }
+      catch (...) {
+        prefetch.stop();
+        throw;
+      }
+      prefetch.stop();
+    }
+
+
+
+
+  //! copy \a source to \a destination in constant memory
+  /*! equivalent to threaded_copy(), but windowing the source through bounded
+   * scratch slabs (see stream_slabs()) rather than relying on the whole
+   * dataset being resident; the next slab is prefetched while the current one
+   * is written out. Intended for images too large to preload. */
+  template <class InputImageType, class OutputImageType>
+    void stream_copy (InputImageType& source, OutputImageType& destination, ssize_t slab_size = 0)
+    {
+      check_dimensions (source, destination);
+      using value_type = typename InputImageType::value_type;
+      const size_t axis = source.ndim() - 1;
+      stream_slabs (source, [&] (Image<value_type>& slab, ssize_t from, ssize_t size) {
+          vector<ssize_t> subset_from (destination.ndim(), 0), subset_size;
+          for (size_t n = 0; n < destination.ndim(); ++n)
+            subset_size.push_back (destination.size (n));
+          subset_from[axis] = from;
+          subset_size[axis] = size;
+          Adapter::Subset<OutputImageType> dest_slab (destination, subset_from, subset_size);
+          vector<ssize_t> slab_from (slab.ndim(), 0);
+          Adapter::Subset<Image<value_type>> src_slab (slab, slab_from, subset_size);
+          threaded_copy (src_slab, dest_slab);
+          }, slab_size);
+    }
+
+
+
+  template <class InputImageType, class OutputImageType>
+    void stream_copy_with_progress_message (const std::string& message, InputImageType& source, OutputImageType& destination, ssize_t slab_size = 0)
+    {
+      check_dimensions (source, destination);
+      using value_type = typename InputImageType::value_type;
+      const size_t axis = source.ndim() - 1;
+      ProgressBar progress (message, source.size (axis));
+      stream_slabs (source, [&] (Image<value_type>& slab, ssize_t from, ssize_t size) {
+          vector<ssize_t> subset_from (destination.ndim(), 0), subset_size;
+          for (size_t n = 0; n < destination.ndim(); ++n)
+            subset_size.push_back (destination.size (n));
+          subset_from[axis] = from;
+          subset_size[axis] = size;
+          Adapter::Subset<OutputImageType> dest_slab (destination, subset_from, subset_size);
+          vector<ssize_t> slab_from (slab.ndim(), 0);
+          Adapter::Subset<Image<value_type>> src_slab (slab, slab_from, subset_size);
+          threaded_copy (src_slab, dest_slab);
+          progress += size;
+          }, slab_size);
+    }
+
+
+}
+
+#endif
@@ -17,6 +17,12 @@
 
 #include "algo/threaded_loop.h"
 
+/* number of positions along each of the two transposed axes processed per
+   tile in threaded_transpose_copy(). A tile this size touches at most 64
+   distinct cache lines of whichever image is being accessed along its slow
+   axis, so the working set stays resident in L1 for any data type. */
+#define TRANSPOSE_TILE_SIZE 64
+
 namespace MR
 {
 
@@ -30,6 +36,70 @@ namespace MR
         }
     };
 
+
+    //! the axis of smallest stride that actually needs traversing
+    /*! returns header.ndim() if no such axis exists. Axes of zero stride
+     * (as can occur e.g. for the inserted axes of an
+     * Adapter::PermuteAxes) and axes of extent 1 are skipped, since
+     * traversal order along these has no bearing on memory access. */
+    template <class HeaderType>
+      inline size_t __transpose_fastest_axis (const HeaderType& header)
+      {
+        size_t axis = header.ndim();
+        for (size_t n = 0; n < header.ndim(); ++n) {
+          if (header.size (n) > 1 && header.stride (n) &&
+              (axis == header.ndim() || std::abs (header.stride (n)) < std::abs (header.stride (axis))))
+            axis = n;
+        }
+        return axis;
+      }
+
+
+    // kernel for the blocked transpose copy: each invocation receives an
+    // outer-loop position, and copies the full plane spanned by the fastest
+    // axes of the source & destination, one TRANSPOSE_TILE_SIZE square tile
+    // at a time; within a tile, reads run along the source's fastest axis,
+    // while the writes are confined to a set of destination cache lines
+    // small enough to remain resident until the tile revisits them
+    template <class InputImageType, class OutputImageType>
+      class __TransposeCopyKernel { MEMALIGN(__TransposeCopyKernel<InputImageType,OutputImageType>)
+        public:
+          __TransposeCopyKernel (const InputImageType& source, const OutputImageType& destination,
+              const size_t axis_in, const size_t axis_out, const vector<size_t>& outer_axes) :
+            src (source),
+            dest (destination),
+            axis_in (axis_in),
+            axis_out (axis_out),
+            outer_axes (outer_axes) { }
+
+          void operator() (const Iterator& pos) {
+            assign_pos_of (pos, outer_axes).to (src, dest);
+            const ssize_t size_in = src.size (axis_in);
+            const ssize_t size_out = src.size (axis_out);
+            for (ssize_t out_from = 0; out_from < size_out; out_from += TRANSPOSE_TILE_SIZE) {
+              const ssize_t out_to = std::min (out_from + TRANSPOSE_TILE_SIZE, size_out);
+              for (ssize_t in_from = 0; in_from < size_in; in_from += TRANSPOSE_TILE_SIZE) {
+                const ssize_t in_to = std::min (in_from + TRANSPOSE_TILE_SIZE, size_in);
+                for (ssize_t out = out_from; out < out_to; ++out) {
+                  src.index (axis_out) = out;
+                  dest.index (axis_out) = out;
+                  for (ssize_t in = in_from; in < in_to; ++in) {
+                    src.index (axis_in) = in;
+                    dest.index (axis_in) = in;
+                    dest.value() = src.value();
+                  }
+                }
+              }
+            }
+          }
+
+        private:
+          InputImageType src;
+          OutputImageType dest;
+          const size_t axis_in, axis_out;
+          const vector<size_t>& outer_axes;
+      };
+
   }
 
   //! \endcond
@@ -102,8 +172,8 @@ namespace MR
 
   template <class InputImageType, class OutputImageType>
     inline void threaded_copy_with_progress (
-        InputImageType& source, 
-        OutputImageType& destination, 
+        InputImageType& source,
+        OutputImageType& destination,
         size_t from_axis = 0,
         size_t to_axis = std::numeric_limits<size_t>::max(),
         size_t num_axes_in_thread = 1)
@@ -112,6 +182,94 @@ namespace MR
           source, destination, from_axis, to_axis, num_axes_in_thread);
     }
 
+
+
+
+  //! copy between images whose data are laid out in different orders
+  /*! When the fastest axis of \a source differs from that of \a
+   * destination, a plain copy is effectively a transpose: traversing in
+   * either image's storage order strides through the other image by a
+   * large offset at every step, missing cache on almost every access once
+   * the data exceed the cache size. This version detects that situation
+   * and instead copies in square tiles spanning the two fastest axes (see
+   * __TransposeCopyKernel), with the remaining axes distributed across
+   * threads; both images are then accessed one full cache line at a time.
+   * If the fastest axes of the two images coincide, this simply delegates
+   * to threaded_copy(). */
+  template <class InputImageType, class OutputImageType>
+    inline void threaded_transpose_copy_with_progress_message (
+        const std::string& message,
+        InputImageType& source,
+        OutputImageType& destination)
+    {
+      const size_t axis_in = __transpose_fastest_axis (source);
+      const size_t axis_out = __transpose_fastest_axis (destination);
+      if (axis_in >= source.ndim() || axis_out >= destination.ndim() || axis_in == axis_out) {
+        // storage orders agree along the fastest axis (or there is nothing
+        // to traverse): the regular source-ordered copy is cache-friendly
+        threaded_copy_with_progress_message (message, source, destination);
+        return;
+      }
+
+      vector<size_t> outer_axes;
+      for (const auto axis : Stride::order (source))
+        if (axis != axis_in && axis != axis_out)
+          outer_axes.push_back (axis);
+
+      __TransposeCopyKernel<typename std::remove_reference<InputImageType>::type,
+        typename std::remove_reference<OutputImageType>::type>
+          kernel (source, destination, axis_in, axis_out, outer_axes);
+
+      if (outer_axes.empty()) {
+        // nothing to parallelise over: process the single plane in-place
+        ProgressBar progress (message);
+        Iterator pos (source);
+        kernel (pos);
+        return;
+      }
+
+      ThreadedLoop (message, source, outer_axes, vector<size_t>()).run_outer (kernel);
+    }
+
+  template <class InputImageType, class OutputImageType>
+    inline void threaded_transpose_copy (
+        InputImageType& source,
+        OutputImageType& destination)
+    {
+      const size_t axis_in = __transpose_fastest_axis (source);
+      const size_t axis_out = __transpose_fastest_axis (destination);
+      if (axis_in >= source.ndim() || axis_out >= destination.ndim() || axis_in == axis_out) {
+        threaded_copy (source, destination);
+        return;
+      }
+
+      vector<size_t> outer_axes;
+      for (const auto axis : Stride::order (source))
+        if (axis != axis_in && axis != axis_out)
+          outer_axes.push_back (axis);
+
+      __TransposeCopyKernel<typename std::remove_reference<InputImageType>::type,
+        typename std::remove_reference<OutputImageType>::type>
+          kernel (source, destination, axis_in, axis_out, outer_axes);
+
+      if (outer_axes.empty()) {
+        Iterator pos (source);
+        kernel (pos);
+        return;
+      }
+
+      ThreadedLoop (source, outer_axes, vector<size_t>()).run_outer (kernel);
+    }
+
+  template <class InputImageType, class OutputImageType>
+    inline void threaded_transpose_copy_with_progress (
+        InputImageType& source,
+        OutputImageType& destination)
+    {
+      threaded_transpose_copy_with_progress_message ("copying from \"" + shorten (source.name()) + "\" to \"" + shorten (destination.name()) + "\"",
+          source, destination);
+    }
+
 }
 
 #endif
@@ -16,6 +16,7 @@
 #define __algo_threaded_loop_h__
 
 #include "debug.h"
+#include "profile.h"
 #include "algo/loop.h"
 #include "algo/iterator.h"
 #include "thread.h"
@@ -307,17 +308,38 @@ namespace MR
         Iterator iterator;
         OuterLoopType outer_loop;
         vector<size_t> inner_axes;
+        bool guided_scheduling;
+
+        //! request guided scheduling of the outer loop axes
+        /*! By default, each thread acquires a single outer-loop position per
+         * lock of the loop mutex. With guided scheduling, threads instead
+         * claim runs of consecutive positions, starting at 1/(4 Nthreads) of
+         * the loop and shrinking as the loop drains. This reduces contention
+         * on the loop mutex for fine-grained loops, while the small final
+         * chunks keep the load balanced when the cost per position is highly
+         * non-uniform (e.g. processing restricted to a mask). */
+        ThreadedLoopRunOuter& guided (bool value = true) {
+          guided_scheduling = value;
+          return *this;
+        }
 
         //! invoke \a functor (const Iterator& pos) per voxel <em> in the outer axes only</em>
-        template <class Functor> 
+        template <class Functor>
           void run_outer (Functor&& functor)
           {
+            PROFILE ("threaded loop");
+
             if (Thread::number_of_threads() == 0) {
               for (auto i = outer_loop (iterator); i; ++i)
                 functor (iterator);
               return;
             }
 
+            if (guided_scheduling) {
+              run_outer_guided (functor);
+              return;
+            }
+
             std::mutex mutex;
 
             struct Shared { MEMALIGN(Shared)
@@ -345,12 +367,75 @@ namespace MR
               }
             } loop_thread = { shared, functor };
 
+            // dispatch into the process-wide pool of warm worker threads;
+            // fall back to spawning threads for re-entrant invocations:
+            if (Thread::__Pool::get().run (loop_thread, "loop threads"))
+              return;
+
             auto t = Thread::run (Thread::multi (loop_thread), "loop threads");
             t.wait();
           }
 
 
 
+        template <class Functor>
+          void run_outer_guided (Functor&& functor)
+          {
+            std::mutex mutex;
+
+            struct Shared { MEMALIGN(Shared)
+              Iterator& iterator;
+              decltype (outer_loop (iterator)) loop;
+              std::mutex& mutex;
+              const size_t nthreads;
+              size_t remaining;
+              //! hand out a run of consecutive outer-loop positions,
+              //! starting large and shrinking as the loop drains:
+              FORCE_INLINE size_t next_chunk (Iterator& pos) {
+                std::lock_guard<std::mutex> lock (mutex);
+                if (!remaining)
+                  return 0;
+                const size_t chunk = std::min (remaining, std::max<size_t> (1, remaining / (4*nthreads)));
+                assign_pos_of (iterator, loop.axes).to (pos);
+                for (size_t n = 0; n < chunk; ++n)
+                  ++loop;   // also ticks the progress bar if one is attached
+                remaining -= chunk;
+                return chunk;
+              }
+            } shared = { iterator, outer_loop (iterator), mutex,
+              Thread::number_of_threads(), size_t (voxel_count (iterator, outer_loop.axes)) };
+
+            struct PerThread { MEMALIGN(PerThread)
+              Shared& shared;
+              const vector<size_t>& axes;
+              typename std::remove_reference<Functor>::type func;
+              void execute () {
+                Iterator pos = shared.iterator;
+                size_t chunk;
+                while ((chunk = shared.next_chunk (pos))) {
+                  while (true) {
+                    func (pos);
+                    if (!--chunk)
+                      break;
+                    for (size_t n = 0; n < axes.size(); ++n) {
+                      if (++pos.index (axes[n]) < pos.size (axes[n]))
+                        break;
+                      pos.index (axes[n]) = 0;
+                    }
+                  }
+                }
+              }
+            } loop_thread = { shared, shared.loop.axes, functor };
+
+            if (Thread::__Pool::get().run (loop_thread, "guided loop threads"))
+              return;
+
+            auto t = Thread::run (Thread::multi (loop_thread), "guided loop threads");
+            t.wait();
+          }
+
+
+
         //! invoke \a functor (const Iterator& pos) per voxel <em> in the outer axes only</em>
         template <class Functor, class... ImageType>
           void run (Functor&& functor, ImageType&&... vox)
@@ -17,6 +17,7 @@
 
 #include "app.h"
 #include "debug.h"
+#include "profile.h"
 #include "progressbar.h"
 #include "file/path.h"
 #include "file/config.h"
@@ -1087,6 +1088,9 @@ namespace MR
 #endif
 
       srand (time (nullptr));
+
+      // enables the opt-in instrumentation layer if MRTRIX_PROFILE is set
+      Profile::init();
     }
 
 
@@ -88,6 +88,11 @@ namespace MR
           return *this;
         }
 
+        ArgumentList& operator+ (Argument&& argument) {
+          push_back (std::move (argument));
+          return *this;
+        }
+
         std::string syntax (int format) const;
     };
 
@@ -103,16 +108,31 @@ namespace MR
           return *this;
         }
 
+        OptionList& operator+ (OptionGroup&& option_group) {
+          push_back (std::move (option_group));
+          return *this;
+        }
+
         OptionList& operator+ (const Option& option) {
           back() + option;
           return *this;
         }
 
+        OptionList& operator+ (Option&& option) {
+          back() + std::move (option);
+          return *this;
+        }
+
         OptionList& operator+ (const Argument& argument) {
           back() + argument;
           return *this;
         }
 
+        OptionList& operator+ (Argument&& argument) {
+          back() + std::move (argument);
+          return *this;
+        }
+
         OptionGroup& back () {
           if (empty())
             push_back (OptionGroup());
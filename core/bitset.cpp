@@ -88,8 +88,17 @@ namespace MR {
   bool BitSet::full() const
   {
 
+    // the data pointer comes from new uint8_t[], which is guaranteed to be
+    //   suitably aligned for any fundamental type, so the bulk of the array
+    //   can be processed in 64-bit words rather than individual bytes
     const size_t bytes_to_test = (bits % 8) ? bytes - 1 : bytes;
-    for (size_t i = 0; i != bytes_to_test; ++i) {
+    const size_t words = bytes_to_test / sizeof (uint64_t);
+    const uint64_t* wdata = reinterpret_cast<const uint64_t*> (data);
+    for (size_t i = 0; i != words; ++i) {
+      if (wdata[i] != ~uint64_t(0))
+        return false;
+    }
+    for (size_t i = words * sizeof (uint64_t); i != bytes_to_test; ++i) {
       if (data[i] != 0xFF)
         return false;
     }
@@ -108,7 +117,13 @@ namespace MR {
   {
 
     const size_t bytes_to_test = (bits % 8) ? bytes - 1 : bytes;
-    for (size_t i = 0; i != bytes_to_test; ++i) {
+    const size_t words = bytes_to_test / sizeof (uint64_t);
+    const uint64_t* wdata = reinterpret_cast<const uint64_t*> (data);
+    for (size_t i = 0; i != words; ++i) {
+      if (wdata[i])
+        return false;
+    }
+    for (size_t i = words * sizeof (uint64_t); i != bytes_to_test; ++i) {
       if (data[i])
         return false;
     }
@@ -126,15 +141,65 @@ namespace MR {
 
   size_t BitSet::count () const
   {
+    if (!bytes)
+      return 0;
+    // hardware popcount over 64-bit words; any excess bits in the final
+    //   byte may be dirty (e.g. constructed with allocator=true, or
+    //   following operator~), and so must be masked out
+    const size_t bytes_to_count = (bits % 8) ? bytes - 1 : bytes;
+    const size_t words = bytes_to_count / sizeof (uint64_t);
+    const uint64_t* wdata = reinterpret_cast<const uint64_t*> (data);
     size_t count = 0;
-    for (size_t i = 0; i != bits; ++i) {
-      if (test (i))
-        ++count;
-    }
+    for (size_t i = 0; i != words; ++i)
+      count += __builtin_popcountll (wdata[i]);
+    for (size_t i = words * sizeof (uint64_t); i != bytes_to_count; ++i)
+      count += __builtin_popcount (data[i]);
+    if (bits % 8)
+      count += __builtin_popcount (data[bytes - 1] & uint8_t(~(0xFF << excess_bits())));
     return count;
   }
 
 
+  void BitSet::set_range (const size_t begin, const size_t end)
+  {
+    assert (end <= bits);
+    if (begin >= end)
+      return;
+    const size_t first_byte = begin >> 3;
+    const size_t last_byte = (end - 1) >> 3;
+    const uint8_t first_mask = 0xFF << (begin & 7);
+    const uint8_t last_mask = 0xFF >> (7 - ((end - 1) & 7));
+    if (first_byte == last_byte) {
+      data[first_byte] |= (first_mask & last_mask);
+      return;
+    }
+    data[first_byte] |= first_mask;
+    if (last_byte > first_byte + 1)
+      memset (data + first_byte + 1, 0xFF, last_byte - first_byte - 1);
+    data[last_byte] |= last_mask;
+  }
+
+
+  void BitSet::reset_range (const size_t begin, const size_t end)
+  {
+    assert (end <= bits);
+    if (begin >= end)
+      return;
+    const size_t first_byte = begin >> 3;
+    const size_t last_byte = (end - 1) >> 3;
+    const uint8_t first_mask = 0xFF << (begin & 7);
+    const uint8_t last_mask = 0xFF >> (7 - ((end - 1) & 7));
+    if (first_byte == last_byte) {
+      data[first_byte] &= ~(first_mask & last_mask);
+      return;
+    }
+    data[first_byte] &= ~first_mask;
+    if (last_byte > first_byte + 1)
+      memset (data + first_byte + 1, 0x00, last_byte - first_byte - 1);
+    data[last_byte] &= ~last_mask;
+  }
+
+
 
 
 
@@ -196,7 +261,12 @@ namespace MR {
   BitSet& BitSet::operator|= (const BitSet& that)
   {
     assert (bits == that.bits);
-    for (size_t i = 0; i != bytes; ++i)
+    uint64_t* lhs = reinterpret_cast<uint64_t*> (data);
+    const uint64_t* rhs = reinterpret_cast<const uint64_t*> (that.data);
+    const size_t words = bytes / sizeof (uint64_t);
+    for (size_t i = 0; i != words; ++i)
+      lhs[i] |= rhs[i];
+    for (size_t i = words * sizeof (uint64_t); i != bytes; ++i)
       data[i] |= that.data[i];
     return *this;
   }
@@ -205,7 +275,12 @@ namespace MR {
   BitSet& BitSet::operator&= (const BitSet& that)
   {
     assert (bits == that.bits);
-    for (size_t i = 0; i != bytes; ++i)
+    uint64_t* lhs = reinterpret_cast<uint64_t*> (data);
+    const uint64_t* rhs = reinterpret_cast<const uint64_t*> (that.data);
+    const size_t words = bytes / sizeof (uint64_t);
+    for (size_t i = 0; i != words; ++i)
+      lhs[i] &= rhs[i];
+    for (size_t i = words * sizeof (uint64_t); i != bytes; ++i)
       data[i] &= that.data[i];
     return *this;
   }
@@ -214,7 +289,12 @@ namespace MR {
   BitSet& BitSet::operator^= (const BitSet& that)
   {
     assert (bits == that.bits);
-    for (size_t i = 0; i != bytes; ++i)
+    uint64_t* lhs = reinterpret_cast<uint64_t*> (data);
+    const uint64_t* rhs = reinterpret_cast<const uint64_t*> (that.data);
+    const size_t words = bytes / sizeof (uint64_t);
+    for (size_t i = 0; i != words; ++i)
+      lhs[i] ^= rhs[i];
+    for (size_t i = words * sizeof (uint64_t); i != bytes; ++i)
       data[i] ^= that.data[i];
     return *this;
   }
@@ -247,7 +327,12 @@ namespace MR {
   BitSet BitSet::operator~() const
   {
     BitSet result (*this);
-    for (size_t i = 0; i != bytes; ++i)
+    uint64_t* out = reinterpret_cast<uint64_t*> (result.data);
+    const uint64_t* in = reinterpret_cast<const uint64_t*> (data);
+    const size_t words = bytes / sizeof (uint64_t);
+    for (size_t i = 0; i != words; ++i)
+      out[i] = ~in[i];
+    for (size_t i = words * sizeof (uint64_t); i != bytes; ++i)
       result.data[i] = ~data[i];
     return result;
   }
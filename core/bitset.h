@@ -149,6 +149,21 @@ namespace MR {
        * \returns the number of elements in the array set to true. */
       size_t count() const;
 
+      //! set all bits in the range [begin, end) to true
+      /*! Bulk equivalent of calling set() on every index in the half-open
+       * range [\a begin, \a end). The partial bytes at either end of the
+       * range are updated with masked operations, and the span in between
+       * with a single memset, so this is considerably faster than a per-bit
+       * loop for long ranges. Note that unlike the single-bit accessors,
+       * these range operations are not atomic: they must not race with
+       * concurrent writes to the same bytes from other threads. */
+      void set_range   (const size_t begin, const size_t end);
+
+      //! set all bits in the range [begin, end) to false
+      /*! Bulk equivalent of calling reset() on every index in the half-open
+       * range [\a begin, \a end); see set_range() for details. */
+      void reset_range (const size_t begin, const size_t end);
+
       //! convenience functions for performing boolean operations
       /*! Convenience function for performing boolean operations using BitSet
        * data. Each of these functions performs a particular boolean operation,
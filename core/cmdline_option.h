@@ -104,7 +104,7 @@ namespace MR
          * and description. If default arguments are used, the object corresponds
          * to the end-of-list specifier, as detailed in \ref command_line_parsing. */
         Argument (const char* name = nullptr, std::string description = std::string()) :
-          id (name), desc (description), type (Undefined), flags (None)
+          id (name), desc (std::move (description)), type (Undefined), flags (None)
         {
           memset (&limits, 0x00, sizeof (limits));
         }
@@ -318,13 +318,17 @@ namespace MR
       public:
         Option () : id (nullptr), flags (Optional) { }
 
-        Option (const char* name, const std::string& description) :
-          id (name), desc (description), flags (Optional) { }
+        Option (const char* name, std::string description) :
+          id (name), desc (std::move (description)), flags (Optional) { }
 
         Option& operator+ (const Argument& arg) {
           push_back (arg);
           return *this;
         }
+        Option& operator+ (Argument&& arg) {
+          push_back (std::move (arg));
+          return *this;
+        }
         operator bool () const {
           return id;
         }
@@ -394,17 +398,28 @@ namespace MR
         OptionGroup (const char* group_name = "OPTIONS") : name (group_name) { }
         const char* name;
 
-        OptionGroup& operator+ (const Option& option) { 
+        OptionGroup& operator+ (const Option& option) {
           push_back (option);
           return *this;
         }
 
-        OptionGroup& operator+ (const Argument& argument) { 
+        OptionGroup& operator+ (Option&& option) {
+          push_back (std::move (option));
+          return *this;
+        }
+
+        OptionGroup& operator+ (const Argument& argument) {
           assert (!empty());
           back() + argument;
           return *this;
         }
 
+        OptionGroup& operator+ (Argument&& argument) {
+          assert (!empty());
+          back() + std::move (argument);
+          return *this;
+        }
+
         Option& back () {
           if (empty())
             push_back (Option());
@@ -32,6 +32,14 @@ namespace MR
 
     void Config::init ()
     {
+      // parse once only: init() is reachable from more than one code path,
+      // and re-parsing would discard any entries set programmatically via
+      // set() in the meantime
+      static bool initialised = false;
+      if (initialised)
+        return;
+      initialised = true;
+
       const char* sysconf_location = getenv ("MRTRIX_CONFIGFILE");
       if (!sysconf_location) 
         sysconf_location = MRTRIX_SYS_CONFIG_FILE;
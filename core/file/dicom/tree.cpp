@@ -13,6 +13,7 @@
 
 
 #include "file/path.h"
+#include "thread_queue.h"
 #include "file/dicom/element.h"
 #include "file/dicom/quick_scan.h"
 #include "file/dicom/image.h"
@@ -52,34 +53,99 @@ namespace MR {
 
 
 
-      void Tree::read_dir (const std::string& filename, ProgressBar& progress)
+      void Tree::list_dir (const std::string& dirname, vector<std::string>& files, ProgressBar& progress)
       {
         try {
-          Path::Dir folder (filename);
+          Path::Dir folder (dirname);
           std::string entry;
           while ((entry = folder.read_name()).size()) {
-            std::string name (Path::join (filename, entry));
+            std::string name (Path::join (dirname, entry));
             if (Path::is_dir (name))
-              read_dir (name, progress);
-            else {
+              list_dir (name, files, progress);
+            else
+              files.push_back (name);
+            ++progress;
+          }
+        }
+        catch (Exception& E) {
+          throw Exception (E, "error opening DICOM folder \"" + dirname + "\": " + strerror (errno));
+        }
+      }
+
+
+
+
+      //! \cond skip
+      namespace {
+
+        // per-file parsing is independent, so the QuickScan stage is spread
+        // across threads; the single-threaded sink then merges the results
+        // into the Tree, so no locking of the Tree itself is needed:
+
+        class ScanSource { NOMEMALIGN
+          public:
+            ScanSource (const vector<std::string>& files) : files (files), index (0) { }
+            bool operator() (std::string& filename) {
+              if (index >= files.size())
+                return false;
+              filename = files[index++];
+              return true;
+            }
+          private:
+            const vector<std::string>& files;
+            size_t index;
+        };
+
+        class ScanFile { NOMEMALIGN
+          public:
+            bool operator() (const std::string& filename, QuickScan& reader) const {
               try {
-                read_file (name);
+                if (reader.read (filename)) {
+                  INFO ("error reading file \"" + filename + "\" - ignored");
+                  return false;
+                }
               }
               catch (Exception& E) {
                 E.display (3);
+                return false;
               }
+              if (! (reader.dim[0] && reader.dim[1] && reader.bits_alloc && reader.data)) {
+                INFO ("DICOM file \"" + filename + "\" does not seem to contain image data - ignored");
+                return false;
+              }
+              return true;
             }
-            ++progress;
-          }
-        }
-        catch (Exception& E) {
-          throw Exception (E, "error opening DICOM folder \"" + filename + "\": " + strerror (errno));
-        }
+        };
+
+        class TreeMerge { NOMEMALIGN
+          public:
+            TreeMerge (Tree& tree, ProgressBar& progress) : tree (tree), progress (progress) { }
+            bool operator() (const QuickScan& reader) {
+              tree.merge (reader);
+              ++progress;
+              return true;
+            }
+          private:
+            Tree& tree;
+            ProgressBar& progress;
+        };
+
       }
+      //! \endcond
 
 
 
 
+      void Tree::read_files (vector<std::string>& files, ProgressBar& progress)
+      {
+        ScanSource source (files);
+        ScanFile scanner;
+        TreeMerge merger (*this, progress);
+        Thread::run_queue (source, std::string(), Thread::multi (scanner), QuickScan(), merger);
+      }
+
+
+
 
       void Tree::read_file (const std::string& filename)
       {
@@ -94,6 +160,15 @@ namespace MR {
           return;
         }
 
+        merge (reader);
+      }
+
+
+
+
+      void Tree::merge (const QuickScan& reader)
+      {
+        const std::string& filename (reader.filename);
         std::shared_ptr<Patient> patient = find (reader.patient, reader.patient_ID, reader.patient_DOB);
         std::shared_ptr<Study> study = patient->find (reader.study, reader.study_ID, reader.study_date, reader.study_time);
         for (const auto& image_type : reader.image_type) {
@@ -116,8 +191,11 @@ namespace MR {
       void Tree::read (const std::string& filename)
       {
         ProgressBar progress ("scanning DICOM folder \"" + shorten (filename) + "\"", 0);
-        if (Path::is_dir (filename))
-          read_dir (filename, progress);
+        if (Path::is_dir (filename)) {
+          vector<std::string> files;
+          list_dir (filename, files, progress);
+          read_files (files, progress);
+        }
         else {
           try {
             read_file (filename);
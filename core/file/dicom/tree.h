@@ -22,15 +22,18 @@ namespace MR {
   namespace File {
     namespace Dicom {
 
-      class Series; 
+      class Series;
       class Patient;
+      class QuickScan;
 
       class Tree : public vector<std::shared_ptr<Patient>> { NOMEMALIGN
         public:
           std::string description;
           void read (const std::string& filename);
-          std::shared_ptr<Patient> find (const std::string& patient_name, const std::string& patient_ID = "", 
+          std::shared_ptr<Patient> find (const std::string& patient_name, const std::string& patient_ID = "",
               const std::string& patient_DOB = "");
+          //! merge the results of a successful QuickScan into the tree
+          void merge (const QuickScan& reader);
 
           void sort() {
             for (size_t npatient = 0; npatient < size(); ++npatient) {
@@ -41,7 +44,8 @@ namespace MR {
           }
 
         protected:
-          void read_dir (const std::string& filename, ProgressBar& progress);
+          void list_dir (const std::string& dirname, vector<std::string>& files, ProgressBar& progress);
+          void read_files (vector<std::string>& files, ProgressBar& progress);
           void read_file (const std::string& filename);
       }; 
 
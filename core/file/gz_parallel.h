@@ -0,0 +1,181 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+#ifndef __file_gz_parallel_h__
+#define __file_gz_parallel_h__
+
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <zlib.h>
+
+#include "exception.h"
+#include "progressbar.h"
+#include "thread_queue.h"
+
+//! size of the input blocks compressed as independent gzip members
+#define MRTRIX_GZ_BLOCK_SIZE 1048576
+
+namespace MR
+{
+  namespace File
+  {
+
+    /*! parallel block-based gzip compression.
+     *
+     * The input is split into fixed-size blocks, each deflated as an
+     * independent gzip member, with the members written out back-to-back in
+     * input order. Concatenated members are part of the gzip specification,
+     * so the output is a perfectly valid .gz file, decompressible by zlib &
+     * any external tool; the member boundaries additionally leave the door
+     * open to parallel decompression of files produced here. Compression of
+     * the blocks is spread across threads via Thread::run_queue().
+     *
+     * Note the converse operation is deliberately absent: a gzip file of
+     * unknown provenance is in general a single deflate stream, whose
+     * decompression is inherently serial. */
+    namespace GZParallel
+    {
+
+      //! \cond skip
+
+      //! deflate a single block as a self-contained gzip member
+      inline void deflate_member (const uint8_t* data, size_t size, std::string& out)
+      {
+        assert (size <= MRTRIX_GZ_BLOCK_SIZE);
+        z_stream strm;
+        memset (&strm, 0, sizeof (strm));
+        if (deflateInit2 (&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+          throw Exception ("error initialising deflate stream");
+        out.resize (deflateBound (&strm, size));
+        strm.next_in = const_cast<Bytef*> (data);
+        strm.avail_in = size;
+        strm.next_out = reinterpret_cast<Bytef*> (&out[0]);
+        strm.avail_out = out.size();
+        const int status = ::deflate (&strm, Z_FINISH);
+        if (status != Z_STREAM_END) {
+          deflateEnd (&strm);
+          throw Exception ("error compressing data block: " + str (status));
+        }
+        out.resize (strm.total_out);
+        deflateEnd (&strm);
+      }
+
+
+      namespace {
+
+        struct __Block { NOMEMALIGN
+          size_t index;
+          const uint8_t* data;
+          size_t size;
+        };
+
+        struct __Compressed { NOMEMALIGN
+          size_t index;
+          std::string data;
+        };
+
+        class __Source { NOMEMALIGN
+          public:
+            __Source (const uint8_t* data, size_t size) :
+              data (data), size (size), index (0), offset (0) { }
+            bool operator() (__Block& block) {
+              if (offset >= size)
+                return false;
+              block.index = index++;
+              block.data = data + offset;
+              block.size = std::min<size_t> (MRTRIX_GZ_BLOCK_SIZE, size - offset);
+              offset += block.size;
+              return true;
+            }
+          private:
+            const uint8_t* const data;
+            const size_t size;
+            size_t index, offset;
+        };
+
+        class __Deflate { NOMEMALIGN
+          public:
+            bool operator() (const __Block& block, __Compressed& out) const {
+              out.index = block.index;
+              deflate_member (block.data, block.size, out.data);
+              return true;
+            }
+        };
+
+        class __Sink { NOMEMALIGN
+          public:
+            __Sink (std::ostream& out, ProgressBar* progress) :
+              out (out), progress (progress), next (0) { }
+            bool operator() (__Compressed& item) {
+              pending[item.index].swap (item.data);
+              std::map<size_t,std::string>::iterator it;
+              while ((it = pending.find (next)) != pending.end()) {
+                out.write (it->second.data(), it->second.size());
+                pending.erase (it);
+                ++next;
+                if (progress)
+                  ++(*progress);
+              }
+              return out.good();
+            }
+          private:
+            std::ostream& out;
+            ProgressBar* progress;
+            size_t next;
+            std::map<size_t,std::string> pending;
+        };
+
+      }
+
+      //! \endcond
+
+
+      //! compress [ \a data, \a data + \a size ) onto stream \a out
+      /*! The data are deflated as a sequence of independent gzip members of
+       * MRTRIX_GZ_BLOCK_SIZE input bytes each, compressed across all
+       * available threads, and written to \a out in input order. If \a
+       * progress is provided, it is incremented once per block written. */
+      inline void deflate (std::ostream& out, const uint8_t* data, size_t size, ProgressBar* progress = nullptr)
+      {
+        if (Thread::number_of_threads() < 2 || size <= MRTRIX_GZ_BLOCK_SIZE) {
+          std::string compressed;
+          for (size_t offset = 0; offset < size; offset += MRTRIX_GZ_BLOCK_SIZE) {
+            deflate_member (data + offset, std::min<size_t> (MRTRIX_GZ_BLOCK_SIZE, size - offset), compressed);
+            out.write (compressed.data(), compressed.size());
+            if (progress)
+              ++(*progress);
+          }
+          if (!out.good())
+            throw Exception ("error writing compressed data");
+          return;
+        }
+
+        __Source source (data, size);
+        __Sink sink (out, progress);
+        Thread::run_queue (source, __Block(), Thread::multi (__Deflate()), __Compressed(), sink);
+        if (!out.good())
+          throw Exception ("error writing compressed data");
+      }
+
+      //! the number of gzip members that deflate() will produce for \a size input bytes
+      inline size_t num_blocks (size_t size)
+      {
+        return (size + MRTRIX_GZ_BLOCK_SIZE - 1) / MRTRIX_GZ_BLOCK_SIZE;
+      }
+
+    }
+  }
+}
+
+#endif
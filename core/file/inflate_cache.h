@@ -0,0 +1,139 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __file_inflate_cache_h__
+#define __file_inflate_cache_h__
+
+#include <cstdio>
+#include <fstream>
+#include <zlib.h>
+
+#include "exception.h"
+#include "mrtrix.h"
+#include "file/config.h"
+#include "file/path.h"
+#include "file/utils.h"
+
+namespace MR
+{
+  namespace File
+  {
+
+    //! on-disk cache of decompressed image data
+    /*! When enabled via the GZCacheDir config file entry, the raw
+     * decompressed contents of GZ-compressed images are stored on disk,
+     * keyed by the CRC and size of the compressed stream (i.e. by content,
+     * not by filename). Subsequent reads of the same compressed file can
+     * then load the cached raw data with a single sequential read, rather
+     * than inflating the stream again. Cache entries are written via a
+     * uniquely-named temporary file and renamed into place, so concurrent
+     * processes reading the same image cannot observe a partial entry. */
+    namespace InflateCache
+    {
+
+      //CONF option: GZCacheDir
+      //CONF default: (empty)
+      //CONF A directory in which to cache the decompressed contents of
+      //CONF GZ-compressed images (e.g. NIfTI *.nii.gz). When set, the first
+      //CONF read of a compressed image stores its raw decompressed data in
+      //CONF this directory, keyed by the CRC and size of the compressed
+      //CONF file; subsequent reads of the same content load the cached raw
+      //CONF data directly instead of inflating the stream again. Leave
+      //CONF empty (the default) to disable caching. Note that entries are
+      //CONF never evicted by MRtrix3 itself; point this at a scratch
+      //CONF location that is cleaned up periodically.
+      inline const std::string& directory ()
+      {
+        static const std::string dir = Config::get ("GZCacheDir", "");
+        return dir;
+      }
+
+      inline bool enabled ()
+      {
+        return directory().size();
+      }
+
+      //! the cache entry name for a given compressed file & segment
+      /*! computed from the CRC32 and size of the compressed stream, along
+       * with the offset and size of the decompressed segment of interest;
+       * returns an empty string if the file cannot be read. */
+      inline std::string name_for (const std::string& filename, int64_t start, int64_t bytes)
+      {
+        std::ifstream in (filename, std::ios::binary);
+        if (!in)
+          return std::string();
+        uLong crc = crc32 (0L, Z_NULL, 0);
+        int64_t size = 0;
+        char buf[65536];
+        while (in) {
+          in.read (buf, sizeof (buf));
+          const std::streamsize n = in.gcount();
+          if (n <= 0)
+            break;
+          crc = crc32 (crc, reinterpret_cast<const Bytef*> (buf), n);
+          size += n;
+        }
+        char entry[128];
+        std::snprintf (entry, sizeof (entry), "%08lx-%lld-%lld-%lld.raw",
+            static_cast<unsigned long> (crc),
+            static_cast<long long> (size),
+            static_cast<long long> (start),
+            static_cast<long long> (bytes));
+        return Path::join (directory(), entry);
+      }
+
+      //! load a cache entry into \a dest; returns false if absent or stale
+      inline bool fetch (const std::string& entry, uint8_t* dest, int64_t bytes)
+      {
+        std::ifstream in (entry, std::ios::binary);
+        if (!in)
+          return false;
+        in.read (reinterpret_cast<char*> (dest), bytes);
+        if (in.gcount() != bytes || in.peek() != std::ifstream::traits_type::eof()) {
+          DEBUG ("cache entry \"" + entry + "\" has unexpected size - ignored");
+          return false;
+        }
+        DEBUG ("image data loaded from cache entry \"" + entry + "\"");
+        return true;
+      }
+
+      //! store decompressed data as a cache entry (best effort)
+      /*! written via a temporary file and renamed into place; failures are
+       * reported at debug level only, since the cache is purely an
+       * optimisation. */
+      inline void store (const std::string& entry, const uint8_t* data, int64_t bytes)
+      {
+        try {
+          const std::string tmpfile = create_tempfile (0, "raw", directory());
+          std::ofstream out (tmpfile, std::ios::binary | std::ios::trunc);
+          out.write (reinterpret_cast<const char*> (data), bytes);
+          out.close();
+          if (!out.good() || std::rename (tmpfile.c_str(), entry.c_str())) {
+            unlink (tmpfile);
+            DEBUG ("error writing cache entry \"" + entry + "\" - skipped");
+            return;
+          }
+          DEBUG ("image data stored as cache entry \"" + entry + "\"");
+        }
+        catch (Exception& e) {
+          DEBUG ("error writing cache entry \"" + entry + "\" - skipped");
+        }
+      }
+
+    }
+  }
+}
+
+#endif
+
@@ -42,7 +42,8 @@ namespace MR
   {
 
     MMap::MMap (const Entry& entry, bool readwrite, bool preload, int64_t mapped_size) :
-      Entry (entry), addr (NULL), first (NULL), msize (mapped_size), readwrite (readwrite)
+      Entry (entry), addr (NULL), first (NULL), msize (mapped_size), readwrite (readwrite),
+      writeback_restricted (false), dirty_from (0), dirty_to (0)
     {
       DEBUG ("memory-mapping file \"" + Entry::name + "\"...");
 
@@ -198,12 +199,18 @@ namespace MR
       }
       else {
         if (readwrite) {
-          INFO ("writing back contents of mapped file \"" + Entry::name + "\"...");
-          File::OFStream out (Entry::name, std::ios::in | std::ios::out | std::ios::binary);
-          out.seekp (start, out.beg);
-          out.write ((char*) first, msize);
-          if (!out.good())
-            throw Exception ("error writing back contents of file \"" + Entry::name + "\": " + strerror(errno));
+          // when the caller has declared its modified regions, write back
+          //   only their span; otherwise the whole buffer
+          const int64_t from = writeback_restricted ? dirty_from : 0;
+          const int64_t size = writeback_restricted ? dirty_to - dirty_from : msize;
+          if (size > 0) {
+            INFO ("writing back contents of mapped file \"" + Entry::name + "\"...");
+            File::OFStream out (Entry::name, std::ios::in | std::ios::out | std::ios::binary);
+            out.seekp (start + from, out.beg);
+            out.write ((char*) first + from, size);
+            if (!out.good())
+              throw Exception ("error writing back contents of file \"" + Entry::name + "\": " + strerror(errno));
+          }
         }
         delete [] first;
       }
@@ -214,6 +221,27 @@ namespace MR
 
 
 
+    void MMap::advise (const Advice advice) const
+    {
+#ifndef MRTRIX_WINDOWS
+      if (!addr)
+        return;
+      int posix_advice = POSIX_MADV_NORMAL;
+      switch (advice) {
+        case Advice::Normal:     posix_advice = POSIX_MADV_NORMAL;     break;
+        case Advice::Sequential: posix_advice = POSIX_MADV_SEQUENTIAL; break;
+        case Advice::Random:     posix_advice = POSIX_MADV_RANDOM;     break;
+        case Advice::WillNeed:   posix_advice = POSIX_MADV_WILLNEED;   break;
+        case Advice::DontNeed:   posix_advice = POSIX_MADV_DONTNEED;   break;
+      }
+      if (posix_madvise (addr, start + msize, posix_advice))
+        DEBUG ("error passing access pattern advice for mapped file \"" + Entry::name + "\": " + strerror (errno));
+#endif
+    }
+
+
+
+
     bool MMap::changed () const
     {
       assert (fd >= 0);
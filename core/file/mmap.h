@@ -15,6 +15,7 @@
 #ifndef __file_mmap_h__
 #define __file_mmap_h__
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <cstdint>
@@ -53,6 +54,20 @@ namespace MR
         MMap (const Entry& entry, bool readwrite = false, bool preload = true, int64_t mapped_size = -1);
         ~MMap () noexcept (false);
 
+        //! expected access patterns for the mapped region
+        enum class Advice { Normal, Sequential, Random, WillNeed, DontNeed };
+
+        //! advise the kernel of the expected access pattern
+        /*! passes the expected access pattern for the mapped region on to
+         * the kernel (via posix_madvise()), allowing it to adjust its
+         * readahead behaviour accordingly: \c Sequential increases the
+         * readahead window, \c Random disables readahead, and \c WillNeed
+         * initiates asynchronous prefetch of the whole region. This is a
+         * hint only: it has no effect on platforms without posix_madvise(),
+         * or if the file is held in a delayed write-back RAM buffer rather
+         * than memory-mapped. */
+        void advise (const Advice advice) const;
+
         std::string name () const {
           return Entry::name;
         }
@@ -71,6 +86,30 @@ namespace MR
         }
         bool changed () const;
 
+        //! restrict delayed write-back to regions marked as modified
+        /*! by default, a read-write mapping held in a delayed write-back RAM
+         * buffer is written back in its entirety when the destructor is
+         * invoked. A caller that knows precisely which regions it will
+         * modify can invoke this method, and subsequently declare each
+         * modified region via mark_modified(); write-back will then cover
+         * only the span of the declared regions, so that sparse edits to
+         * large files no longer rewrite untouched data. This has no effect
+         * on a genuine memory-mapping, where the kernel already flushes
+         * modified pages only. */
+        void restrict_writeback () {
+          writeback_restricted = true;
+          dirty_from = msize;
+          dirty_to = 0;
+        }
+
+        //! declare the byte range [offset, offset+length) as modified
+        /*! see restrict_writeback(); offsets are relative to the start of
+         * the mapped region. */
+        void mark_modified (int64_t offset, int64_t length) {
+          dirty_from = std::min (dirty_from, offset);
+          dirty_to = std::max (dirty_to, offset + length);
+        }
+
         friend std::ostream& operator<< (std::ostream& stream, const MMap& m) {
           stream << "File::MMap { " << m.name() << " [" << m.fd << "], size: "
                  << m.size() << ", mapped " << (m.readwrite ? "RW" : "RO")
@@ -85,11 +124,15 @@ namespace MR
         int64_t   msize;       /**< The size of the file. */
         time_t    mtime;       /**< The modification time of the file at the last check. */
         bool      readwrite;
+        bool      writeback_restricted;
+        int64_t   dirty_from;  /**< Lower bound of the declared modified range (see restrict_writeback()). */
+        int64_t   dirty_to;    /**< Upper bound of the declared modified range. */
 
         void map ();
 
       private:
-        MMap (const MMap& mmap) : Entry (mmap), fd (0), addr (NULL), first (NULL), msize (0), mtime (0), readwrite (false) {
+        MMap (const MMap& mmap) : Entry (mmap), fd (0), addr (NULL), first (NULL), msize (0), mtime (0), readwrite (false),
+            writeback_restricted (false), dirty_from (0), dirty_to (0) {
           assert (0);
         }
     };
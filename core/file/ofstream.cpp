@@ -14,6 +14,7 @@
 
 #include "file/ofstream.h"
 
+#include "file/config.h"
 #include "file/utils.h"
 
 
@@ -23,6 +24,15 @@ namespace MR
   {
 
 
+  //CONF option: FileWriteBufferSize
+  //CONF default: 0 (use the system default)
+  //CONF The size (in bytes) of the user-space write buffer to install on
+  //CONF each output file stream. Streaming writers (e.g. track or
+  //CONF track scalar files) issue many small writes, which can collapse
+  //CONF throughput on network or parallel file systems; setting this to a
+  //CONF few megabytes coalesces them into large sequential transfers. The
+  //CONF value is rounded up to a whole number of 4kB blocks, so that
+  //CONF flushes of the full buffer remain block-aligned.
   void OFStream::open (const std::string& path, const std::ios_base::openmode mode)
   {
     if (!(mode & std::ios_base::app) && !(mode & std::ios_base::ate) && !(mode & std::ios_base::in)) {
@@ -30,6 +40,16 @@ namespace MR
         File::create (path);
     }
 
+    // a replacement stream buffer can only be installed before the file is
+    //   opened; the buffer itself must then outlive the stream's use of it
+    const int64_t config_size = File::Config::get_int ("FileWriteBufferSize", 0);
+    if (config_size > 0) {
+      const size_t buffer_size = 4096 * ((size_t (config_size) + 4095) / 4096);
+      if (!iobuf)
+        iobuf.reset (new char [buffer_size]);
+      rdbuf()->pubsetbuf (iobuf.get(), buffer_size);
+    }
+
     std::ofstream::open (path.c_str(), mode);
     if (std::ofstream::operator!())
       throw Exception ("error opening output file \"" + path + "\": " + std::strerror (errno));
@@ -17,6 +17,7 @@
 
 
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "types.h"
@@ -33,7 +34,12 @@ namespace MR
      * It ensures that if the user has not given the command permission to overwrite
      * output files, the presence of an existing file is first checked. It also removes the
      * necessity to explicitly convert a path expressed as a std::string to a
-     * c-style string. */
+     * c-style string.
+     *
+     * If the FileWriteBufferSize config file entry is set, a user-space write
+     * buffer of (at least) that size is installed on the stream before the
+     * file is opened, so that the many small writes issued by streaming
+     * writers are coalesced into large block-aligned transfers. */
     class OFStream : public std::ofstream { NOMEMALIGN
       public:
         OFStream() { }
@@ -43,6 +49,9 @@ namespace MR
 
         void open (const std::string& path, const std::ios_base::openmode mode = std::ios_base::out);
 
+      private:
+        std::unique_ptr<char[]> iobuf;
+
     };
 
 
@@ -19,6 +19,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include "debug.h"
 #include "app.h"
@@ -79,6 +80,30 @@ namespace MR
         return __tmpfile_prefix;
       }
 
+      const std::string __get_pipe_dir () {
+#ifndef MRTRIX_WINDOWS
+        // a tmpfs mount means piped images are handed between commands
+        // entirely in RAM, sharing the same physical pages rather than being
+        // written out to and read back from the filesystem:
+        if (Path::is_dir ("/dev/shm") && !access ("/dev/shm", W_OK))
+          return "/dev/shm";
+#endif
+        return tmpfile_dir();
+      }
+
+      //CONF option: PipeFileDir
+      //CONF default: `/dev/shm` (if present on Unix), TmpFileDir otherwise
+      //CONF The directory in which to create the temporary files backing
+      //CONF images piped between commands. By default a shared-memory
+      //CONF filesystem is used where available, so that piped images are
+      //CONF handed over in RAM without any filesystem traffic; set this
+      //CONF option to override the location (e.g. if `/dev/shm` is too small
+      //CONF to hold the images being piped).
+      inline const std::string& pipe_dir () {
+        static const std::string __pipe_dir = File::Config::get ("PipeFileDir", __get_pipe_dir());
+        return __pipe_dir;
+      }
+
       /* Config file options listed here so that they can be scraped by
        * generate_user_docs.sh and added to the list of config file options in
        * the documentation without modifying the script to read from the scripts
@@ -163,11 +188,11 @@ namespace MR
 
 
 
-    inline std::string create_tempfile (int64_t size = 0, const char* suffix = NULL)
+    inline std::string create_tempfile (int64_t size = 0, const char* suffix = NULL, const std::string& dir = std::string())
     {
       DEBUG ("creating temporary file of size " + str (size));
 
-      std::string filename (Path::join (tmpfile_dir(), tmpfile_prefix()) + "XXXXXX.");
+      std::string filename (Path::join (dir.size() ? dir : tmpfile_dir(), tmpfile_prefix()) + "XXXXXX.");
       int rand_index = filename.size() - 7;
       if (suffix) filename += suffix;
 
@@ -0,0 +1,515 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+#ifndef __file_zstd_h__
+#define __file_zstd_h__
+
+#ifdef MRTRIX_ZSTD_SUPPORT
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <zstd.h>
+
+#include "exception.h"
+#include "mrtrix.h"
+#include "progressbar.h"
+#include "raw.h"
+#include "thread_queue.h"
+
+//! size of the uncompressed input blocks compressed as independent zstd frames
+#define MRTRIX_ZSTD_FRAME_SIZE 1048576
+
+// not provided by older libzstd releases:
+#ifndef ZSTD_CLEVEL_DEFAULT
+# define ZSTD_CLEVEL_DEFAULT 3
+#endif
+
+namespace MR
+{
+  namespace File
+  {
+
+    /*! seekable block-based Zstandard compression.
+     *
+     * The input is split into fixed-size blocks, each compressed as an
+     * independent zstd frame, followed by a skippable frame holding a table
+     * of per-frame compressed & uncompressed sizes. This is the zstd
+     * "seekable format" (as produced by the reference contrib tools), so
+     * the output remains a perfectly valid .zst file for any external
+     * decompressor, while the frame table permits decompression of an
+     * arbitrary byte range without inflating everything that precedes it.
+     * Compression of the frames is spread across threads via
+     * Thread::run_queue(); bulk reads decompress the frames spanning the
+     * requested range across threads in the same manner. */
+    namespace Zstd
+    {
+
+      constexpr uint32_t skippable_frame_magic = 0x184D2A5EU;
+      constexpr uint32_t seek_table_magic = 0x8F92EAB1U;
+
+      //! one entry of the seek table, with running offsets filled in on read
+      struct Frame { NOMEMALIGN
+        uint64_t compressed_offset, uncompressed_offset;
+        uint32_t compressed_size, uncompressed_size;
+      };
+
+
+      //! \cond skip
+
+      //! compress a single block as a self-contained zstd frame
+      inline void compress_frame (const uint8_t* data, size_t size, std::string& out)
+      {
+        assert (size <= MRTRIX_ZSTD_FRAME_SIZE);
+        out.resize (ZSTD_compressBound (size));
+        const size_t retval = ZSTD_compress (&out[0], out.size(), data, size, ZSTD_CLEVEL_DEFAULT);
+        if (ZSTD_isError (retval))
+          throw Exception (std::string ("error compressing data block: ") + ZSTD_getErrorName (retval));
+        out.resize (retval);
+      }
+
+      //! decompress a single zstd frame into exactly \a dsize output bytes
+      inline void decompress_frame (const char* src, size_t csize, uint8_t* dst, size_t dsize)
+      {
+        const size_t retval = ZSTD_decompress (dst, dsize, src, csize);
+        if (ZSTD_isError (retval))
+          throw Exception (std::string ("error decompressing data block: ") + ZSTD_getErrorName (retval));
+        if (retval != dsize)
+          throw Exception ("compressed data block has unexpected size");
+      }
+
+      namespace {
+
+        struct __Block { NOMEMALIGN
+          size_t index;
+          const uint8_t* data;
+          size_t size;
+        };
+
+        struct __Compressed { NOMEMALIGN
+          size_t index;
+          size_t uncompressed_size;
+          std::string data;
+        };
+
+        class __Source { NOMEMALIGN
+          public:
+            __Source (const uint8_t* data, size_t size) :
+              data (data), size (size), index (0), offset (0) { }
+            bool operator() (__Block& block) {
+              if (offset >= size)
+                return false;
+              block.index = index++;
+              block.data = data + offset;
+              block.size = std::min<size_t> (MRTRIX_ZSTD_FRAME_SIZE, size - offset);
+              offset += block.size;
+              return true;
+            }
+          private:
+            const uint8_t* const data;
+            const size_t size;
+            size_t index, offset;
+        };
+
+        class __Compress { NOMEMALIGN
+          public:
+            bool operator() (const __Block& block, __Compressed& out) const {
+              out.index = block.index;
+              out.uncompressed_size = block.size;
+              compress_frame (block.data, block.size, out.data);
+              return true;
+            }
+        };
+
+        class __Sink { NOMEMALIGN
+          public:
+            __Sink (std::ostream& out, vector<Frame>& table, ProgressBar* progress) :
+              out (out), table (table), progress (progress), next (0) { }
+            bool operator() (__Compressed& item) {
+              pending[item.index] = std::move (item);
+              std::map<size_t,__Compressed>::iterator it;
+              while ((it = pending.find (next)) != pending.end()) {
+                out.write (it->second.data.data(), it->second.data.size());
+                table.push_back ({ 0, 0, uint32_t (it->second.data.size()), uint32_t (it->second.uncompressed_size) });
+                pending.erase (it);
+                ++next;
+                if (progress)
+                  ++(*progress);
+              }
+              return out.good();
+            }
+          private:
+            std::ostream& out;
+            vector<Frame>& table;
+            ProgressBar* progress;
+            size_t next;
+            std::map<size_t,__Compressed> pending;
+        };
+
+      }
+
+      //! \endcond
+
+
+      //! the number of zstd frames that Writer::append() will produce for \a size input bytes
+      inline size_t num_frames (size_t size)
+      {
+        return (size + MRTRIX_ZSTD_FRAME_SIZE - 1) / MRTRIX_ZSTD_FRAME_SIZE;
+      }
+
+
+
+      //! write a seekable zstd file, one fixed-size frame at a time
+      class Writer { NOMEMALIGN
+        public:
+          Writer (const std::string& filename) :
+            filename (filename),
+            out (filename, std::ios::binary | std::ios::trunc) {
+              if (!out)
+                throw Exception ("error opening file \"" + filename + "\": " + strerror (errno));
+            }
+
+          ~Writer () {
+            if (out.is_open()) {
+              try { close(); }
+              catch (Exception& e) { e.display(); }
+            }
+          }
+
+          //! compress [ \a data, \a data + \a size ) onto the output file
+          /*! blocks are compressed as independent frames across all available
+           * threads, and written out in input order; if \a progress is
+           * provided, it is incremented once per frame written. */
+          void append (const uint8_t* data, size_t size, ProgressBar* progress = nullptr)
+          {
+            if (Thread::number_of_threads() < 2 || size <= MRTRIX_ZSTD_FRAME_SIZE) {
+              std::string compressed;
+              for (size_t offset = 0; offset < size; offset += MRTRIX_ZSTD_FRAME_SIZE) {
+                const size_t block_size = std::min<size_t> (MRTRIX_ZSTD_FRAME_SIZE, size - offset);
+                compress_frame (data + offset, block_size, compressed);
+                out.write (compressed.data(), compressed.size());
+                table.push_back ({ 0, 0, uint32_t (compressed.size()), uint32_t (block_size) });
+                if (progress)
+                  ++(*progress);
+              }
+            } else {
+              __Source source (data, size);
+              __Sink sink (out, table, progress);
+              Thread::run_queue (source, __Block(), Thread::multi (__Compress()), __Compressed(), sink);
+            }
+            if (!out.good())
+              throw Exception ("error writing to file \"" + filename + "\": " + strerror (errno));
+          }
+
+          //! append the seek table as a skippable frame and close the file
+          void close ()
+          {
+            const uint32_t content_size = 8 * table.size() + 9;
+            uint8_t buffer[9];
+            Raw::store_LE<uint32_t> (skippable_frame_magic, buffer);
+            Raw::store_LE<uint32_t> (content_size, buffer, 1);
+            out.write (reinterpret_cast<const char*> (buffer), 8);
+            for (const auto& frame : table) {
+              Raw::store_LE<uint32_t> (frame.compressed_size, buffer);
+              Raw::store_LE<uint32_t> (frame.uncompressed_size, buffer, 1);
+              out.write (reinterpret_cast<const char*> (buffer), 8);
+            }
+            Raw::store_LE<uint32_t> (uint32_t (table.size()), buffer);
+            buffer[4] = 0;   // seek table descriptor: no per-frame checksums
+            Raw::store_LE<uint32_t> (seek_table_magic, buffer+5);
+            out.write (reinterpret_cast<const char*> (buffer), 9);
+            out.close();
+            if (!out.good())
+              throw Exception ("error writing to file \"" + filename + "\": " + strerror (errno));
+          }
+
+        private:
+          const std::string filename;
+          std::ofstream out;
+          vector<Frame> table;
+      };
+
+
+
+
+      //! random access to a seekable zstd file via its frame table
+      class Reader { NOMEMALIGN
+        public:
+          Reader (const std::string& filename) :
+            filename (filename),
+            in (filename, std::ios::binary),
+            position (0),
+            cached_frame (SIZE_MAX) {
+              if (!in)
+                throw Exception ("error opening file \"" + filename + "\": " + strerror (errno));
+              read_seek_table();
+            }
+
+          const std::string& name () const { return filename; }
+
+          //! total uncompressed size of the file contents
+          uint64_t size () const {
+            return table.size() ? table.back().uncompressed_offset + table.back().uncompressed_size : 0;
+          }
+
+          void seek (uint64_t offset) {
+            if (offset > size())
+              throw Exception ("seek beyond end of file \"" + filename + "\"");
+            position = offset;
+          }
+
+          //! decompress \a bytes from the current position, advancing it
+          void read (uint8_t* dst, size_t bytes)
+          {
+            while (bytes) {
+              if (position >= size())
+                throw Exception ("read beyond end of file \"" + filename + "\"");
+              load_frame (frame_at (position));
+              const Frame& frame = table[cached_frame];
+              const size_t within = position - frame.uncompressed_offset;
+              const size_t chunk = std::min<size_t> (bytes, frame.uncompressed_size - within);
+              memcpy (dst, cache.data() + within, chunk);
+              dst += chunk;
+              position += chunk;
+              bytes -= chunk;
+            }
+          }
+
+          //! read the next newline- (or EOF-) terminated line of text
+          std::string getline ()
+          {
+            std::string line;
+            while (position < size()) {
+              load_frame (frame_at (position));
+              const Frame& frame = table[cached_frame];
+              while (position < frame.uncompressed_offset + frame.uncompressed_size) {
+                const char c = cache[position - frame.uncompressed_offset];
+                ++position;
+                if (c == '\n') {
+                  if (line.size() && line.back() == '\r')
+                    line.pop_back();
+                  return line;
+                }
+                line += c;
+              }
+            }
+            return line;
+          }
+
+          //! decompress [ \a offset, \a offset + \a bytes ) directly into \a dst
+          /*! the frames spanning the requested range are decompressed across
+           * all available threads; if \a progress is provided, it is
+           * incremented once per frame decoded. */
+          void read_parallel (uint64_t offset, uint8_t* dst, size_t bytes, ProgressBar* progress = nullptr)
+          {
+            if (!bytes)
+              return;
+            if (offset + bytes > size())
+              throw Exception ("read beyond end of file \"" + filename + "\"");
+
+            if (Thread::number_of_threads() < 2) {
+              seek (offset);
+              read (dst, bytes);
+              if (progress)
+                *progress += frame_at (offset+bytes-1) - frame_at (offset) + 1;
+              return;
+            }
+
+            std::mutex mutex;
+            FrameSource source (*this, frame_at (offset), frame_at (offset+bytes-1));
+            FrameDecode decode (table, offset, dst, bytes, progress, mutex);
+            Thread::run_queue (source, CompressedFrame(), Thread::multi (decode));
+          }
+
+        private:
+          const std::string filename;
+          std::ifstream in;
+          vector<Frame> table;
+          uint64_t position;
+          size_t cached_frame;
+          vector<uint8_t> cache;
+
+          //! \cond skip
+
+          struct CompressedFrame { NOMEMALIGN
+            size_t index;
+            std::string data;
+          };
+
+          class FrameSource { NOMEMALIGN
+            public:
+              FrameSource (Reader& reader, size_t from, size_t to) :
+                reader (reader), next (from), to (to) { }
+              bool operator() (CompressedFrame& out) {
+                if (next > to)
+                  return false;
+                out.index = next;
+                reader.fetch_compressed (next, out.data);
+                ++next;
+                return true;
+              }
+            private:
+              Reader& reader;
+              size_t next, to;
+          };
+
+          //! decompresses each frame straight into its (disjoint) slice of the destination
+          class FrameDecode { NOMEMALIGN
+            public:
+              FrameDecode (const vector<Frame>& table, uint64_t offset, uint8_t* dst, size_t bytes, ProgressBar* progress, std::mutex& mutex) :
+                table (table), offset (offset), dst (dst), bytes (bytes), progress (progress), mutex (mutex) { }
+              bool operator() (const CompressedFrame& item) {
+                const Frame& frame = table[item.index];
+                if (frame.uncompressed_offset >= offset && frame.uncompressed_offset + frame.uncompressed_size <= offset + bytes) {
+                  decompress_frame (item.data.data(), item.data.size(), dst + (frame.uncompressed_offset - offset), frame.uncompressed_size);
+                } else {
+                  // frame only partially overlaps the requested range:
+                  vector<uint8_t> buffer (frame.uncompressed_size);
+                  decompress_frame (item.data.data(), item.data.size(), buffer.data(), frame.uncompressed_size);
+                  const uint64_t from = std::max<uint64_t> (frame.uncompressed_offset, offset);
+                  const uint64_t to = std::min<uint64_t> (frame.uncompressed_offset + frame.uncompressed_size, offset + bytes);
+                  memcpy (dst + (from - offset), buffer.data() + (from - frame.uncompressed_offset), to - from);
+                }
+                if (progress) {
+                  std::lock_guard<std::mutex> lock (mutex);
+                  ++(*progress);
+                }
+                return true;
+              }
+            private:
+              const vector<Frame>& table;
+              const uint64_t offset;
+              uint8_t* const dst;
+              const size_t bytes;
+              ProgressBar* const progress;
+              std::mutex& mutex;
+          };
+
+          //! \endcond
+
+          //! index of the frame containing uncompressed offset \a offset
+          size_t frame_at (uint64_t offset) const {
+            size_t lower = 0, upper = table.size();
+            while (upper - lower > 1) {
+              const size_t mid = (lower + upper) / 2;
+              if (table[mid].uncompressed_offset <= offset)
+                lower = mid;
+              else
+                upper = mid;
+            }
+            return lower;
+          }
+
+          //! read (but do not decompress) the compressed contents of frame \a n
+          void fetch_compressed (size_t n, std::string& data) {
+            data.resize (table[n].compressed_size);
+            in.seekg (table[n].compressed_offset);
+            in.read (&data[0], data.size());
+            if (!in.good())
+              throw Exception ("error reading from file \"" + filename + "\": " + strerror (errno));
+          }
+
+          void load_frame (size_t n) {
+            if (n == cached_frame)
+              return;
+            std::string compressed;
+            fetch_compressed (n, compressed);
+            cache.resize (table[n].uncompressed_size);
+            decompress_frame (compressed.data(), compressed.size(), cache.data(), cache.size());
+            cached_frame = n;
+          }
+
+          void read_seek_table ()
+          {
+            in.seekg (0, std::ios::end);
+            const int64_t file_size = in.tellg();
+            if (file_size < 17)
+              throw Exception ("file \"" + filename + "\" is not in seekable zstd format");
+
+            uint8_t footer[9];
+            in.seekg (file_size - 9);
+            in.read (reinterpret_cast<char*> (footer), 9);
+            if (!in.good() || Raw::fetch_LE<uint32_t> (footer+5) != seek_table_magic)
+              throw Exception ("file \"" + filename + "\" is missing the seekable zstd frame table");
+            const uint32_t num = Raw::fetch_LE<uint32_t> (footer);
+            const bool with_checksums = footer[4] & 0x80U;
+            const size_t entry_size = with_checksums ? 12 : 8;
+
+            const int64_t entries_start = file_size - 9 - int64_t (num) * entry_size;
+            if (entries_start < 8)
+              throw Exception ("malformed seekable zstd frame table in file \"" + filename + "\"");
+            uint8_t frame_header[8];
+            in.seekg (entries_start - 8);
+            in.read (reinterpret_cast<char*> (frame_header), 8);
+            if (!in.good() || Raw::fetch_LE<uint32_t> (frame_header) != skippable_frame_magic ||
+                Raw::fetch_LE<uint32_t> (frame_header, 1) != uint32_t (num) * entry_size + 9)
+              throw Exception ("malformed seekable zstd frame table in file \"" + filename + "\"");
+
+            vector<uint8_t> entries (size_t (num) * entry_size);
+            in.read (reinterpret_cast<char*> (entries.data()), entries.size());
+            if (!in.good())
+              throw Exception ("error reading from file \"" + filename + "\": " + strerror (errno));
+
+            table.resize (num);
+            uint64_t compressed_offset = 0, uncompressed_offset = 0;
+            for (size_t n = 0; n < num; ++n) {
+              table[n].compressed_offset = compressed_offset;
+              table[n].uncompressed_offset = uncompressed_offset;
+              table[n].compressed_size = Raw::fetch_LE<uint32_t> (entries.data() + n*entry_size);
+              table[n].uncompressed_size = Raw::fetch_LE<uint32_t> (entries.data() + n*entry_size + 4);
+              compressed_offset += table[n].compressed_size;
+              uncompressed_offset += table[n].uncompressed_size;
+            }
+            if (int64_t (compressed_offset) != entries_start - 8)
+              throw Exception ("malformed seekable zstd frame table in file \"" + filename + "\"");
+          }
+      };
+
+
+
+      //! read the next key/value line from a seekable zstd file
+      /* allows read_mrtrix_header() to operate on a Zstd::Reader, exactly
+       * as for the File::GZ overload in formats/mrtrix_utils.h (this one is
+       * found through argument-dependent lookup) */
+      inline bool next_keyvalue (Reader& zf, std::string& key, std::string& value)
+      {
+        key.clear(); value.clear();
+        std::string line = zf.getline();
+        line = strip (line.substr (0, line.find_first_of ('#')));
+        if (line.empty() || line == "END")
+          return false;
+
+        size_t colon = line.find_first_of (':');
+        if (colon == std::string::npos) {
+          INFO ("malformed key/value entry (\"" + line + "\") in file \"" + zf.name() + "\" - ignored");
+        } else {
+          key   = strip (line.substr (0, colon));
+          value = strip (line.substr (colon+1));
+          if (key.empty() || value.empty()) {
+            INFO ("malformed key/value entry (\"" + line + "\") in file \"" + zf.name() + "\" - ignored");
+            key.clear();
+            value.clear();
+          }
+        }
+        return true;
+      }
+
+    }
+  }
+}
+
+#endif
+
+#endif
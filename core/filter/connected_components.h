@@ -21,7 +21,6 @@
 
 #include "filter/base.h"
 
-#include <stack>
 #include <iostream>
 
 namespace MR
@@ -56,23 +55,21 @@ namespace MR
 
 
         // Perform connected components on the mask.
+        // Two-pass union-find: the first pass merges each node with its
+        //   already-visited neighbours, the second assigns consecutive
+        //   labels in order of each component's first node, matching the
+        //   labelling order of the previous depth-first implementation.
         const vector<vector<int> >& run (vector<cluster>& clusters,
                                                    vector<uint32_t>& labels) const {
           labels.resize (adjacent_indices.size(), 0);
-          uint32_t current_label = 1;
-          for (uint32_t i = 0; i < labels.size(); i++) {
-            // this node has not been already clustered
-            if (labels[i] == 0) {
-              cluster cluster;
-              cluster.label = current_label;
-              cluster.size = 0;
-              depth_first_search (i, cluster, labels);
-              clusters.push_back (cluster);
-              current_label++;
-            }
-          }
-          if (clusters.size() > std::numeric_limits<uint32_t>::max())
-            throw Exception ("The number of clusters is larger than can be labelled with an unsigned 32bit integer.");
+          vector<uint32_t> parent (adjacent_indices.size());
+          for (uint32_t i = 0; i < parent.size(); i++)
+            parent[i] = i;
+          for (uint32_t i = 0; i < parent.size(); i++)
+            for (size_t n = 0; n < adjacent_indices[i].size(); n++)
+              if (adjacent_indices[i][n] < i)
+                merge (parent, i, adjacent_indices[i][n]);
+          assign_labels (clusters, labels, parent);
           return mask_indices;
         }
 
@@ -84,20 +81,19 @@ namespace MR
                   const VectorType& data,
                   const float threshold) const {
           labels.resize (adjacent_indices.size(), 0);
-          uint32_t current_label = 1;
-          for (uint32_t i = 0; i < labels.size(); i++) {
-            // this node has not been already clustered and is above threshold
-            if (labels[i] == 0 && data[i] > threshold) {
-              cluster cluster;
-              cluster.label = current_label;
-              cluster.size = 0;
-              depth_first_search (i, cluster, labels, data, threshold);
-              clusters.push_back (cluster);
-              current_label++;
+          vector<uint32_t> parent (adjacent_indices.size());
+          for (uint32_t i = 0; i < parent.size(); i++)
+            parent[i] = i;
+          for (uint32_t i = 0; i < parent.size(); i++) {
+            if (!(data[i] > threshold))
+              continue;
+            for (size_t n = 0; n < adjacent_indices[i].size(); n++) {
+              const uint32_t j = adjacent_indices[i][n];
+              if (j < i && data[j] > threshold)
+                merge (parent, i, j);
             }
           }
-          if (clusters.size() > std::numeric_limits<uint32_t>::max())
-            throw Exception ("The number of clusters is larger than can be labelled with an unsigned 32bit integer.");
+          assign_labels (clusters, labels, parent, data, threshold);
         }
 
 
@@ -164,79 +160,76 @@ namespace MR
         }
 
 
-        bool next_neighbour (uint32_t& node, vector<uint32_t>& labels) const {
-          for (size_t n = 0; n < adjacent_indices[node].size(); n++) {
-            if (labels[adjacent_indices[node][n]] == 0) {
-              node = adjacent_indices[node][n];
-              return true;
-            }
+        // find the root of node i, halving the path as we go
+        static uint32_t find (vector<uint32_t>& parent, uint32_t i) {
+          while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
           }
-          return false;
+          return i;
         }
 
-
-        template <class VectorType>
-        bool next_neighbour (uint32_t& node,
-                             vector<uint32_t>& labels,
-                             const VectorType& data,
-                             const float threshold) const {
-          for (size_t n = 0; n < adjacent_indices[node].size(); n++) {
-            if (labels[adjacent_indices[node][n]] == 0 && data[adjacent_indices[node][n]] > threshold) {
-              node = adjacent_indices[node][n];
-              return true;
-            }
-          }
-          return false;
+        // merge the components containing nodes a & b; the larger root is
+        //   always attached beneath the smaller, so each component's root
+        //   is its lowest-numbered node
+        static void merge (vector<uint32_t>& parent, const uint32_t a, const uint32_t b) {
+          const uint32_t ra = find (parent, a);
+          const uint32_t rb = find (parent, b);
+          if (ra == rb)
+            return;
+          if (ra < rb)
+            parent[rb] = ra;
+          else
+            parent[ra] = rb;
         }
 
-
-        // use a non-recursive depth first search to agglomerate adjacent voxels
-        void depth_first_search (uint32_t root,
-                                 cluster& cluster,
-                                 vector<uint32_t>& labels) const {
-          uint32_t node = root;
-          std::stack<uint32_t> stack;
-          while (true) {
-            labels[node] = cluster.label;
-            stack.push (node);
-            cluster.size++;
-            if (next_neighbour (node, labels)) {
-              continue;
-            } else {
-              do {
-                if (stack.top() == root)
-                  return;
-                stack.pop();
-                node = stack.top();
-              } while (!next_neighbour (node, labels));
+        void assign_labels (vector<cluster>& clusters,
+                            vector<uint32_t>& labels,
+                            vector<uint32_t>& parent) const {
+          uint32_t current_label = 1;
+          for (uint32_t i = 0; i < labels.size(); i++) {
+            const uint32_t root = find (parent, i);
+            if (root == i) {
+              cluster cluster;
+              cluster.label = current_label++;
+              cluster.size = 0;
+              clusters.push_back (cluster);
+              labels[i] = cluster.label;
             }
+            // the root is the lowest-numbered node of the component,
+            //   so has already been labelled:
+            else
+              labels[i] = labels[root];
+            clusters[labels[i]-1].size++;
           }
+          if (clusters.size() > std::numeric_limits<uint32_t>::max())
+            throw Exception ("The number of clusters is larger than can be labelled with an unsigned 32bit integer.");
         }
 
-        // use a non-recursive depth first search to agglomerate adjacent voxels
         template <class VectorType>
-        void depth_first_search (uint32_t root,
-                                 cluster& cluster,
-                                 vector<uint32_t>& labels,
-                                 const VectorType& data,
-                                 const float threshold) const {
-          uint32_t node = root;
-          std::stack<uint32_t> stack;
-          while (true) {
-            labels[node] = cluster.label;
-            stack.push (node);
-            cluster.size++;
-            if (next_neighbour (node, labels, data, threshold)) {
+        void assign_labels (vector<cluster>& clusters,
+                            vector<uint32_t>& labels,
+                            vector<uint32_t>& parent,
+                            const VectorType& data,
+                            const float threshold) const {
+          uint32_t current_label = 1;
+          for (uint32_t i = 0; i < labels.size(); i++) {
+            if (!(data[i] > threshold))
               continue;
-            } else {
-              do {
-                if (stack.top() == root)
-                  return;
-                stack.pop();
-                node = stack.top();
-              } while (!next_neighbour (node, labels, data, threshold));
+            const uint32_t root = find (parent, i);
+            if (root == i) {
+              cluster cluster;
+              cluster.label = current_label++;
+              cluster.size = 0;
+              clusters.push_back (cluster);
+              labels[i] = cluster.label;
             }
+            else
+              labels[i] = labels[root];
+            clusters[labels[i]-1].size++;
           }
+          if (clusters.size() > std::numeric_limits<uint32_t>::max())
+            throw Exception ("The number of clusters is larger than can be labelled with an unsigned 32bit integer.");
         }
 
 
@@ -17,9 +17,9 @@
 
 #include "memory.h"
 #include "image.h"
-#include "algo/copy.h"
 #include "algo/loop.h"
 #include "filter/base.h"
+#include "filter/distance_transform.h"
 
 
 
@@ -67,21 +67,19 @@ namespace MR
         template <class InputImageType, class OutputImageType>
         void operator() (InputImageType& input, OutputImageType& output)
         {
-          std::shared_ptr <Image<bool> > in (new Image<bool> (Image<bool>::scratch (input)));
-          copy (input, *in);
-          std::shared_ptr <Image<bool> > out;
-          std::shared_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message, npass + 1) : nullptr);
-
-          for (unsigned int pass = 0; pass < npass; pass++) {
-            out = make_shared<Image<bool>> (Image<bool>::scratch (input));
-            for (auto l = Loop (*in) (*in, *out); l; ++l)
-              out->value() = dilate (*in);
-            if (pass < npass - 1)
-              in = out;
-            if (progress)
-              ++(*progress);
-          }
-          copy (*out, output);
+          std::shared_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message, 2) : nullptr);
+
+          // npass applications of the single-voxel-shell dilation are
+          // equivalent to thresholding the city-block distance to the mask,
+          // which is computed in six line sweeps regardless of npass:
+          auto dist = city_block_distance_transform (input, false, false);
+          if (progress)
+            ++(*progress);
+
+          for (auto l = Loop (dist) (dist, output); l; ++l)
+            output.value() = (dist.value() <= npass);
+          if (progress)
+            ++(*progress);
         }
 
 
@@ -93,19 +91,6 @@ namespace MR
 
       protected:
 
-        bool dilate (Image<bool>& in)
-        {
-          if (in.value()) return true;
-          bool val;
-          if (in.index(0) > 0) { in.index(0)--; val = in.value(); in.index(0)++; if (val) return true; }
-          if (in.index(1) > 0) { in.index(1)--; val = in.value(); in.index(1)++; if (val) return true; }
-          if (in.index(2) > 0) { in.index(2)--; val = in.value(); in.index(2)++; if (val) return true; }
-          if (in.index(0) < in.size(0)-1) { in.index(0)++; val = in.value(); in.index(0)--; if (val) return true; }
-          if (in.index(1) < in.size(1)-1) { in.index(1)++; val = in.value(); in.index(1)--; if (val) return true; }
-          if (in.index(2) < in.size(2)-1) { in.index(2)++; val = in.value(); in.index(2)--; if (val) return true; }
-          return false;
-        }
-
         unsigned int npass;
     };
     //! @}
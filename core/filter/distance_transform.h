@@ -0,0 +1,101 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __filter_distance_transform_h__
+#define __filter_distance_transform_h__
+
+#include <limits>
+
+#include "image.h"
+#include "algo/loop.h"
+#include "algo/threaded_loop.h"
+
+// marks voxels not yet reached from any source:
+#define DISTANCE_TRANSFORM_INF std::numeric_limits<uint32_t>::max()
+
+namespace MR
+{
+  namespace Filter
+  {
+
+    //! compute the city-block (L1) distance transform of a binary mask
+    /*! Each voxel of the returned scratch image holds the city-block
+     * distance, in voxels, to the nearest source voxel: mask voxels if \a
+     * from_background is false, background voxels otherwise. If \a
+     * border_is_source, the region outside the image bounds additionally
+     * acts as a source, i.e. the outermost voxels are at most one step away
+     * from one. The transform is computed exactly by forward & backward
+     * min-plus sweeps along each of the three spatial axes in turn, with
+     * the lines of each sweep processed in parallel; for images with more
+     * than three dimensions, the transform of each 3D volume is computed
+     * independently. */
+    template <class MaskImageType>
+      Image<uint32_t> city_block_distance_transform (MaskImageType& mask,
+                                                     const bool from_background,
+                                                     const bool border_is_source)
+      {
+        auto dist = Image<uint32_t>::scratch (mask, "city-block distance transform");
+
+        for (auto l = Loop (mask) (mask, dist); l; ++l)
+          dist.value() = (bool (mask.value()) != from_background) ? 0u : DISTANCE_TRANSFORM_INF;
+
+        class Sweep { MEMALIGN(Sweep)
+          public:
+            Sweep (const Image<uint32_t>& dist, const size_t axis, const bool border_is_source) :
+                dist (dist),
+                axis (axis),
+                border_is_source (border_is_source) { }
+
+            void operator() (const Iterator& pos) {
+              assign_pos_of (pos).to (dist);
+              uint32_t d = border_is_source ? 0 : DISTANCE_TRANSFORM_INF;
+              for (dist.index(axis) = 0; dist.index(axis) < dist.size(axis); ++dist.index(axis)) {
+                if (d != DISTANCE_TRANSFORM_INF)
+                  ++d;
+                d = std::min (uint32_t (dist.value()), d);
+                dist.value() = d;
+              }
+              d = border_is_source ? 0 : DISTANCE_TRANSFORM_INF;
+              for (dist.index(axis) = dist.size(axis)-1; dist.index(axis) >= 0; --dist.index(axis)) {
+                if (d != DISTANCE_TRANSFORM_INF)
+                  ++d;
+                d = std::min (uint32_t (dist.value()), d);
+                dist.value() = d;
+              }
+            }
+
+          protected:
+            Image<uint32_t> dist;
+            const size_t axis;
+            const bool border_is_source;
+        };
+
+        for (size_t axis = 0; axis != 3; ++axis) {
+          vector<size_t> axes = Stride::order (dist);
+          for (size_t n = 0; n < axes.size(); ++n) {
+            if (axes[n] == axis) {
+              axes.erase (axes.begin() + n);
+              break;
+            }
+          }
+          ThreadedLoop (dist, axes, 1).run (Sweep (dist, axis, border_is_source));
+        }
+
+        return dist;
+      }
+
+  }
+}
+
+#endif
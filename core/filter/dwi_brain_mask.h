@@ -15,6 +15,8 @@
 #ifndef __filter_dwi_brain_mask_h__
 #define __filter_dwi_brain_mask_h__
 
+#include <mutex>
+
 #include "memory.h"
 #include "image.h"
 #include "phase_encoding.h"
@@ -26,6 +28,7 @@
 #include "algo/histogram.h"
 #include "algo/copy.h"
 #include "algo/loop.h"
+#include "algo/threaded_loop.h"
 #include "dwi/gradient.h"
 
 
@@ -34,6 +37,54 @@ namespace MR
   namespace Filter
   {
 
+    //! \cond skip
+    namespace {
+
+      // computes the mean image of every shell in one pass over the input,
+      // gathering at the same time the per-shell intensity samples needed
+      // by the optimal threshold estimation; per-thread samples are merged
+      // into the shared vectors on destruction
+      class ShellMeansFunctor { NOMEMALIGN
+        public:
+          ShellMeansFunctor (const DWI::Shells& shells, vector<vector<double>>& overall, std::mutex& mutex) :
+            shells (shells), overall (overall), mutex (mutex), values (shells.count()) { }
+
+          ShellMeansFunctor (const ShellMeansFunctor&) = default;
+
+          ~ShellMeansFunctor () {
+            std::lock_guard<std::mutex> lock (mutex);
+            for (size_t s = 0; s != values.size(); ++s)
+              overall[s].insert (overall[s].end(), values[s].begin(), values[s].end());
+          }
+
+          template <class InputImageType, class MeanImageType>
+          void operator() (InputImageType& input, MeanImageType& shell_means) {
+            for (size_t s = 0; s != shells.count(); ++s) {
+              default_type sum = 0.0;
+              for (const auto v : shells[s].get_volumes()) {
+                input.index(3) = v;
+                const default_type value = input.value();
+                if (value > 0.0)
+                  sum += value;
+              }
+              const default_type mean = sum / default_type (shells[s].count());
+              shell_means.index(3) = s;
+              shell_means.value() = mean;
+              if (std::isfinite (mean))
+                values[s].push_back (mean);
+            }
+          }
+
+        protected:
+          const DWI::Shells& shells;
+          vector<vector<double>>& overall;
+          std::mutex& mutex;
+          vector<vector<double>> values;
+      };
+
+    }
+    //! \endcond
+
 
     /** \addtogroup Filters
       @{ */
@@ -78,43 +129,53 @@ namespace MR
 
             std::unique_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message) : nullptr);
 
-            // Loop over each shell, including b=0, in turn
             DWI::Shells shells (grad);
-            for (size_t s = 0; s != shells.count(); ++s) {
-              const DWI::Shell& shell (shells[s]);
-
-              auto shell_image = Image<value_type>::scratch (header, "mean b=" + str(size_t(std::round(shell.get_mean()))) + " image");
-
-              for (auto l = Loop (0, 3) (input, shell_image); l; ++l) {
-                default_type sum = 0.0;
-                for (vector<size_t>::const_iterator v = shell.get_volumes().begin(); v != shell.get_volumes().end(); ++v) {
-                  input.index(3) = *v;
-                  const value_type value = input.value();
-                  if (value > value_type(0))
-                    sum += value;
-                }
-                shell_image.value() = value_type(sum / default_type(shell.count()));
-              }
-              if (progress)
-                ++(*progress);
 
-              // Threshold the mean intensity image for this shell
-              OptimalThreshold threshold_filter (shell_image);
+            // Compute the mean image of every shell, including b=0, in a
+            // single fused threaded pass over the input, gathering at the
+            // same time the intensity samples needed for the per-shell
+            // threshold estimation, so the (typically very large) DWI data
+            // is only traversed once
+            Header header_shells (header);
+            header_shells.ndim() = 4;
+            header_shells.size(3) = shells.count();
+            auto shell_means = Image<value_type>::scratch (header_shells, "per-shell mean images");
+
+            vector<vector<double>> shell_values (shells.count());
+            {
+              std::mutex mutex;
+              ShellMeansFunctor functor (shells, shell_values, mutex);
+              ThreadedLoop (header, 0, 3).run (functor, input, shell_means);
+            }
+            if (progress)
+              ++(*progress);
 
-              auto shell_mask_voxel = Image<bool>::scratch (threshold_filter);
-              threshold_filter (shell_image, shell_mask_voxel);
+            // Estimate the optimal threshold for each shell from the
+            // samples gathered above
+            vector<value_type> thresholds (shells.count());
+            for (size_t s = 0; s != shells.count(); ++s) {
+              thresholds[s] = estimate_optimal_threshold (std::move (shell_values[s]));
               if (progress)
                 ++(*progress);
+            }
 
-              // Add this mask to the master
-              for (auto l = Loop (0, 3)(mask_image, shell_mask_voxel); l; ++l) {
-                if (shell_mask_voxel.value())
-                  mask_image.value() = true;
+            // Threshold each shell's mean image and combine into the master
+            // mask, again in a single pass
+            auto combine = [&thresholds] (Image<value_type>& means, Image<bool>& mask) {
+              bool within = false;
+              for (size_t s = 0; s != thresholds.size(); ++s) {
+                means.index(3) = s;
+                const value_type value = means.value();
+                if (std::isfinite (value) && value > thresholds[s]) {
+                  within = true;
+                  break;
+                }
               }
-              if (progress)
-                ++(*progress);
-
-            }
+              mask.value() = within;
+            };
+            ThreadedLoop (mask_image).run (combine, shell_means, mask_image);
+            if (progress)
+              ++(*progress);
 
             // The following operations apply to the mask as combined from all shells
             auto temp_image = Image<bool>::scratch (header, "temporary mask");
@@ -19,9 +19,9 @@
 #include "memory.h"
 #include "image.h"
 #include "image_helpers.h"
-#include "algo/copy.h"
 #include "algo/loop.h"
 #include "filter/base.h"
+#include "filter/distance_transform.h"
 
 namespace MR
 {
@@ -69,22 +69,20 @@ namespace MR
         template <class InputImageType, class OutputImageType>
         void operator() (InputImageType& input, OutputImageType& output)
         {
-          std::shared_ptr <Image<bool> > in = make_shared<Image<bool> > (Image<bool>::scratch (input));
-          copy (input, *in);
-          std::shared_ptr <Image<bool> > out;
-          std::shared_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message, npass + 1) : nullptr);
-
-          for (unsigned int pass = 0; pass < npass; pass++) {
-            out = make_shared<Image<bool> > (Image<bool>::scratch (input));
-            for (auto l = Loop (*in) (*in, *out); l; ++l)
-             out->value() = erode (*in);
-
-            if (pass < npass - 1)
-              in = out;
-            if (progress)
-              ++(*progress);
-          }
-          copy (*out, output);
+          std::shared_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message, 2) : nullptr);
+
+          // npass applications of the single-voxel-shell erosion are
+          // equivalent to thresholding the city-block distance to the
+          // background (with the image border acting as background),
+          // which is computed in six line sweeps regardless of npass:
+          auto dist = city_block_distance_transform (input, true, true);
+          if (progress)
+            ++(*progress);
+
+          for (auto l = Loop (dist) (dist, output); l; ++l)
+            output.value() = (dist.value() > npass);
+          if (progress)
+            ++(*progress);
         }
 
 
@@ -96,23 +94,6 @@ namespace MR
 
       protected:
 
-        bool erode (Image<bool>& in)
-        {
-          if (!in.value()) return false;
-          if (   (in.index(0) == 0) || (in.index(0) == in.size(0)-1)
-              || (in.index(1) == 0) || (in.index(1) == in.size(1)-1)
-              || (in.index(2) == 0) || (in.index(2) == in.size(2)-1))
-            return false;
-          bool val;
-          if (in.index(0) > 0) { in.index(0)--; val = in.value(); in.index(0)++; if (!val) return false; }
-          if (in.index(1) > 0) { in.index(1)--; val = in.value(); in.index(1)++; if (!val) return false; }
-          if (in.index(2) > 0) { in.index(2)--; val = in.value(); in.index(2)++; if (!val) return false; }
-          if (in.index(0) < in.size(0)-1) { in.index(0)++; val = in.value(); in.index(0)--; if (!val) return false; }
-          if (in.index(1) < in.size(1)-1) { in.index(1)++; val = in.value(); in.index(1)--; if (!val) return false; }
-          if (in.index(2) < in.size(2)-1) { in.index(2)++; val = in.value(); in.index(2)--; if (!val) return false; }
-          return true;
-        }
-
         unsigned int npass;
     };
     //! @}
@@ -84,37 +84,44 @@ namespace MR
         void operator() (InputComplexImageType& input, OutputComplexImageType& output)
         {
 
-          std::shared_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message, axes_to_process.size() + 2) : nullptr);
+          std::shared_ptr<ProgressBar> progress (message.size() ? new ProgressBar (message, axes_to_process.size() + (centre_zero_ ? 2 : 1)) : nullptr);
 
-            auto temp = Image<cdouble>::scratch (*this);
-            copy (input, temp);
+            // the transforms operate in-place in the output image (which
+            // necessarily stores complex values, as per the datatype set in
+            // the constructor), avoiding the full-size intermediate complex
+            // buffer previously allocated here:
+            copy (input, output);
             if (progress)
               ++(*progress);
 
             for (vector<size_t>::const_iterator axis = axes_to_process.begin(); axis != axes_to_process.end(); ++axis) {
-              vector<size_t> axes = Stride::order (temp);
+              vector<size_t> axes = Stride::order (output);
               for (size_t n = 0; n < axes.size(); ++n) {
                 if (axes[n] == *axis) {
                   axes.erase (axes.begin() + n);
                   break;
                 }
               }
-              FFTKernel<decltype(temp)> kernel (temp, *axis, inverse);
-              ThreadedLoop (temp, axes, 1).run (kernel);
+              FFTKernel<OutputComplexImageType> kernel (output, *axis, inverse);
+              ThreadedLoop (output, axes, 1).run (kernel);
               if (progress) ++(*progress);
             }
 
             if (centre_zero_) {
-              for (auto l = Loop (output)(output); l; ++l) {
-                assign_pos_of (output).to (temp);
-                for (vector<size_t>::const_iterator flip_axis = axes_to_process.begin(); flip_axis != axes_to_process.end(); ++flip_axis)
-                  temp.index(*flip_axis) = (temp.index(*flip_axis) >= (temp.size (*flip_axis) / 2)) ?
-                                           (temp.index(*flip_axis) - (temp.size (*flip_axis) / 2)) :
-                                           (temp.index(*flip_axis) + (temp.size (*flip_axis) / 2));
-                output.value() = temp.value();
+              // likewise performed in-place, one line at a time per
+              // transformed axis:
+              for (vector<size_t>::const_iterator axis = axes_to_process.begin(); axis != axes_to_process.end(); ++axis) {
+                vector<size_t> axes = Stride::order (output);
+                for (size_t n = 0; n < axes.size(); ++n) {
+                  if (axes[n] == *axis) {
+                    axes.erase (axes.begin() + n);
+                    break;
+                  }
+                }
+                ShiftKernel<OutputComplexImageType> kernel (output, *axis);
+                ThreadedLoop (output, axes, 1).run (kernel);
               }
-            } else {
-              copy (temp, output);
+              if (progress) ++(*progress);
             }
         }
 
@@ -155,6 +162,33 @@ namespace MR
             bool inverse;
         };
 
+        //! swap the two halves of each line along an axis, shifting the
+        //  zero-frequency component to the centre of the image
+        template <class ComplexImageType>
+        class ShiftKernel { MEMALIGN(ShiftKernel)
+          public:
+            ShiftKernel (const ComplexImageType& voxel, const size_t shift_axis) :
+                vox (voxel),
+                line (vox.size (shift_axis)),
+                axis (shift_axis) { }
+
+            void operator () (const Iterator& pos) {
+              assign_pos_of (pos).to (vox);
+              for (vox.index(axis) = 0; vox.index(axis) < vox.size(axis); ++vox.index(axis))
+                line[vox.index(axis)] = cdouble (vox.value());
+              const ssize_t halfway = vox.size (axis) / 2;
+              for (vox.index(axis) = 0; vox.index(axis) < vox.size(axis); ++vox.index(axis)) {
+                const ssize_t i = vox.index (axis);
+                vox.value() = typename ComplexImageType::value_type (line[(i >= halfway) ? (i - halfway) : (i + halfway)]);
+              }
+            }
+
+          protected:
+            ComplexImageType vox;
+            Eigen::Matrix<cdouble, Eigen::Dynamic, 1> line;
+            size_t axis;
+        };
+
     };
 
 
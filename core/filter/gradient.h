@@ -20,7 +20,7 @@
 #include "transform.h"
 #include "algo/loop.h"
 #include "algo/threaded_copy.h"
-#include "adapter/gradient1D.h"
+#include "adapter/gradient3D.h"
 #include "filter/base.h"
 #include "filter/smooth.h"
 
@@ -118,7 +118,7 @@ namespace MR
 
           const size_t num_volumes = (in.ndim() == 3) ? 1 : in.size(3);
 
-          std::unique_ptr<ProgressBar> progress (message.size() ?  new ProgressBar (message, 3 * num_volumes) : nullptr);
+          std::unique_ptr<ProgressBar> progress (message.size() ?  new ProgressBar (message, num_volumes) : nullptr);
 
           for (size_t vol = 0; vol < num_volumes; ++vol) {
             if (in.ndim() == 4) {
@@ -126,24 +126,15 @@ namespace MR
               out.index(4) = vol;
             }
 
-            Adapter::Gradient1D<decltype(smoothed)> gradient1D (smoothed, 0, wrt_scanner);
-            out.index(3) = 0;
-            threaded_copy (gradient1D, out, 0, 3, 2);
+            // all three gradient components (and the rotation to scanner
+            //   space, if requested) are computed in a single pass, rather
+            //   than re-traversing the smoothed image once per axis
+            Adapter::FusedGradient3D<decltype(smoothed)> gradient3D (smoothed, wrt_scanner);
+            ThreadedLoop (smoothed, 0, 3, 2).run (
+                [] (Adapter::FusedGradient3D<decltype(smoothed)>& gradient, OutputImageType& out) {
+                  out.row(3) = gradient.value();
+                }, gradient3D, out);
             if (progress) ++(*progress);
-            out.index(3) = 1;
-            gradient1D.set_axis (1);
-            threaded_copy (gradient1D, out, 0, 3, 2);
-            if (progress) ++(*progress);
-            out.index(3) = 2;
-            gradient1D.set_axis (2);
-            threaded_copy (gradient1D, out, 0, 3, 2);
-            if (progress) ++(*progress);
-
-            if (wrt_scanner) {
-              Transform transform (in);
-              for (auto l = Loop(0,3) (out); l; ++l)
-                out.row(3) = transform.image2scanner.linear() * Eigen::Vector3 (out.row(3));
-            }
           }
         }
 
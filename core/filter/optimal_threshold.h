@@ -15,6 +15,8 @@
 #ifndef __filter_optimal_threshold_h__
 #define __filter_optimal_threshold_h__
 
+#include <algorithm>
+
 #include "memory.h"
 #include "image.h"
 #include "algo/threaded_loop.h"
@@ -32,151 +34,116 @@ namespace MR
       //! \cond skip
       namespace {
 
-          class MeanStdFunctor { NOMEMALIGN
+          class GatherFunctor { NOMEMALIGN
             public:
-              MeanStdFunctor (double& overall_sum, double& overall_sum_sqr, size_t& overall_count) :
-                overall_sum (overall_sum), overall_sum_sqr (overall_sum_sqr), overall_count (overall_count),
-                sum (0.0), sum_sqr (0.0), count (0) { }
+              GatherFunctor (vector<double>& overall) :
+                overall (overall) { }
 
-              ~MeanStdFunctor () {
+              ~GatherFunctor () {
                 std::lock_guard<std::mutex> lock (mutex);
-                overall_sum += sum;
-                overall_sum_sqr += sum_sqr;
-                overall_count += count;
-              }
-
-              template <class ImageType, class MaskType>
-              void operator() (ImageType& vox, MaskType& mask) {
-                if (mask.value()) {
-                  double in = vox.value();
-                  if (std::isfinite(in)) {
-                    sum += in;
-                    sum_sqr += Math::pow2 (in);
-                    ++count;
-                  }
-                }
+                overall.insert (overall.end(), values.begin(), values.end());
               }
 
               template <class ImageType>
               void operator() (ImageType& vox) {
-                  double in = vox.value();
-                  if (std::isfinite(in)) {
-                    sum += in;
-                    sum_sqr += Math::pow2 (in);
-                    ++count;
-                  }
-              }
-
-              double& overall_sum;
-              double& overall_sum_sqr;
-              size_t& overall_count;
-              double sum, sum_sqr;
-              size_t count;
-
-              static std::mutex mutex;
-          };
-          std::mutex MeanStdFunctor::mutex;
-
-          class CorrelationFunctor { NOMEMALIGN
-            public:
-              CorrelationFunctor (double threshold, double& overall_sum, double& overall_mean_xy) : 
-                threshold (threshold), overall_sum (overall_sum), overall_mean_xy (overall_mean_xy),
-                sum (0), mean_xy (0.0) { }
-
-              ~CorrelationFunctor () {
-                std::lock_guard<std::mutex> lock (mutex);
-                overall_sum += sum;
-                overall_mean_xy += mean_xy;
-              }
-
-              template <class ImageType>
-              void operator() (ImageType& vox) {
-                double in = vox.value();
-                if (std::isfinite(in)) {
-                  if (in > threshold) {
-                    sum += 1;
-                    mean_xy += in;
-                  }
-                }
+                const double in = vox.value();
+                if (std::isfinite(in))
+                  values.push_back (in);
               }
 
               template <class ImageType, class MaskType>
               void operator() (ImageType& vox, MaskType& mask) {
-                if (mask.value()) {
-                  double in = vox.value();
-                  if (std::isfinite(in)) {
-                    if (in > threshold) {
-                      sum += 1;
-                      mean_xy += in;
-                    }
-                  }
-                }
+                if (mask.value())
+                  (*this) (vox);
               }
 
-              const double threshold;
-              double& overall_sum;
-              double& overall_mean_xy;
-              double sum;
-              double mean_xy;
+              vector<double>& overall;
+              vector<double> values;
 
               static std::mutex mutex;
           };
-          std::mutex CorrelationFunctor::mutex;
+          std::mutex GatherFunctor::mutex;
 
       }
       //! \endcond
 
 
+      //! the cost function at the core of the optimal threshold estimation,
+      //  operating on a set of pre-gathered finite intensities. Once sorted
+      //  and augmented with suffix sums, each threshold probe reduces to a
+      //  binary search rather than another full sweep over the data
+      class CorrelationCostFunction { NOMEMALIGN
+
+        public:
+          CorrelationCostFunction (vector<double>&& intensities) :
+            values (std::move (intensities)) {
+              init();
+            }
+
+          double operator() (double threshold) const {
+            const size_t index = std::upper_bound (values.begin(), values.end(), threshold) - values.begin();
+            const double sum = double (count - index);
+            const double mean_xy = suffix_sum[index] / count;
+
+            double covariance = mean_xy - (sum / count) * input_image_mean;
+            double mask_stdev = sqrt ((sum - double (sum * sum) / count) / count);
+
+            return -covariance / (input_image_stdev * mask_stdev);
+          }
+
+          double min_value () const { return values.front(); }
+          double max_value () const { return values.back(); }
+
+        protected:
+          CorrelationCostFunction () { }
+
+          void init () {
+            count = values.size();
+            std::sort (values.begin(), values.end());
+
+            // suffix_sum[i] is the sum of all values from index i onward
+            suffix_sum.resize (count + 1);
+            suffix_sum[count] = 0.0;
+            for (size_t i = count; i; --i)
+              suffix_sum[i-1] = suffix_sum[i] + values[i-1];
+
+            double sum_sqr = 0.0;
+            for (size_t i = 0; i != count; ++i)
+              sum_sqr += Math::pow2 (values[i]);
+
+            input_image_mean = suffix_sum[0] / count;
+            input_image_stdev = sqrt ((sum_sqr - suffix_sum[0] * input_image_mean) / count);
+          }
+
+          vector<double> values;
+          vector<double> suffix_sum;
+          size_t count;
+          double input_image_mean;
+          double input_image_stdev;
+      };
+
+
+
       template <class ImageType, class MaskType>
-        class ImageCorrelationCostFunction { NOMEMALIGN
+        class ImageCorrelationCostFunction : public CorrelationCostFunction { NOMEMALIGN
 
           public:
             using value_type = typename ImageType::value_type;
             using mask_value_type = typename MaskType::value_type;
 
-            ImageCorrelationCostFunction (ImageType& input, MaskType& mask) :
-                input (input),
-                mask (mask)
+            ImageCorrelationCostFunction (ImageType& input, MaskType& mask)
               {
-                double sum_sqr = 0.0, sum = 0.0;
-                count = 0;
-
+                // gather the (masked) finite intensities in a single threaded pass
                 if (mask.valid()) {
                   Adapter::Replicate<MaskType> replicated_mask (mask, input);
-                  ThreadedLoop (input).run (MeanStdFunctor (sum, sum_sqr, count), input, replicated_mask);
+                  ThreadedLoop (input).run (GatherFunctor (values), input, replicated_mask);
                 }
                 else {
-                  ThreadedLoop (input).run (MeanStdFunctor (sum, sum_sqr, count), input);
+                  ThreadedLoop (input).run (GatherFunctor (values), input);
                 }
 
-                input_image_mean = sum / count;
-                input_image_stdev = sqrt ((sum_sqr - sum * input_image_mean) / count);
+                init();
               }
-
-            value_type operator() (value_type threshold) const {
-              double sum = 0;
-              double mean_xy = 0.0;
-
-              if (mask.valid()) {
-                Adapter::Replicate<MaskType> replicated_mask (mask, input);
-                ThreadedLoop (input).run (CorrelationFunctor (threshold, sum, mean_xy), input, replicated_mask);
-              }
-              else
-                ThreadedLoop (input).run (CorrelationFunctor (threshold, sum, mean_xy), input);
-
-              mean_xy /= count;
-              double covariance = mean_xy - (sum / count) * input_image_mean;
-              double mask_stdev = sqrt ((sum - double (sum * sum) / count) / count);
-
-              return -covariance / (input_image_stdev * mask_stdev);
-            }
-
-          private:
-            ImageType& input;
-            MaskType& mask;
-            size_t count;
-            double input_image_mean;
-            double input_image_stdev;
         };
 
 
@@ -208,6 +175,20 @@ namespace MR
           return estimate_optimal_threshold (input, mask);
         }
 
+
+
+      //! as above, but operating on a set of pre-gathered finite intensities
+      inline default_type estimate_optimal_threshold (vector<double>&& values)
+      {
+        CorrelationCostFunction cost_function (std::move (values));
+
+        const default_type min = cost_function.min_value();
+        const default_type max = cost_function.max_value();
+
+        return Math::golden_section_search (cost_function, "optimising threshold",
+            min + 0.001*(max-min), (min+max)/2.0, max-0.001*(max-min));
+      }
+
       /** \addtogroup Filters
         @{ */
 
@@ -23,6 +23,7 @@
 #include "interp/cubic.h"
 #include "interp/sinc.h"
 #include "image.h"
+#include "transform.h"
 #include "algo/copy.h"
 
 namespace MR
@@ -57,7 +58,8 @@ namespace MR
         template <class HeaderType>
         Resize (const HeaderType& in) :
             Base (in),
-            interp_type (2) { } // Cubic
+            interp_type (2), // Cubic
+            antialias (false) { }
 
 
         void set_voxel_size (default_type size)
@@ -126,8 +128,47 @@ namespace MR
         }
 
 
+        //! apply anti-aliasing filtering when down-sampling
+        /*! when enabled, axes along which the image is down-sampled are
+         * low-pass filtered with a Gaussian kernel (stdev of half an output
+         * voxel width) before decimation, suppressing the aliasing otherwise
+         * introduced by sampling below the input bandwidth. For an
+         * axis-aligned pure down-sampling, the filtering and decimation are
+         * fused into a single polyphase pass per axis, so no full-resolution
+         * smoothed intermediate is materialised; otherwise the image is
+         * smoothed explicitly and resliced as usual. Disabled by default. */
+        void set_antialiasing (bool do_antialiasing) {
+          antialias = do_antialiasing;
+        }
+
+
         template <class InputImageType, class OutputImageType>
           void operator() (InputImageType& input, OutputImageType& output)
+          {
+            if (antialias) {
+              if (antialiased_resize (input, output))
+                return;
+              // not an axis-aligned pure down-sampling: smooth the
+              // down-sampled axes explicitly, then reslice as usual
+              Filter::Smooth smooth_filter (input);
+              vector<default_type> stdev (3, 0.0);
+              for (size_t d = 0; d < 3; ++d)
+                stdev[d] = spacing(d) > input.spacing(d) ? 0.5 * spacing(d) : 0.0;
+              smooth_filter.set_stdev (stdev);
+              auto smoothed = Image<float>::scratch (smooth_filter, "anti-aliasing filter buffer");
+              smooth_filter (input, smoothed);
+              reslice_dispatch (smoothed, output);
+              return;
+            }
+            reslice_dispatch (input, output);
+          }
+
+      protected:
+        int interp_type;
+        bool antialias;
+
+        template <class InputImageType, class OutputImageType>
+          void reslice_dispatch (InputImageType& input, OutputImageType& output)
           {
             switch (interp_type) {
             case 0:
@@ -149,8 +190,144 @@ namespace MR
             }
           }
 
-      protected:
-        int interp_type;
+        //! fused anti-aliased down-sampling
+        /*! each axis is processed in a single polyphase pass applying the
+         * anti-aliasing kernel and the decimation together, reading from the
+         * previous pass's (already decimated) buffer, so that no
+         * full-resolution intermediate exists at any point. Returns false
+         * without touching the output if the resize is not an axis-aligned
+         * pure down-sampling. */
+        template <class InputImageType, class OutputImageType>
+          bool antialiased_resize (InputImageType& input, OutputImageType& output)
+          {
+            for (size_t n = 3; n < std::min (input.ndim(), output.ndim()); ++n)
+              if (input.size (n) != output.size (n))
+                return false;
+            const transform_type M = Transform(input).scanner2voxel * Transform(output).voxel2scanner;
+            for (size_t i = 0; i < 3; ++i)
+              for (size_t j = 0; j < 3; ++j)
+                if (i != j && std::abs (M(i,j)) > 1.0e-6)
+                  return false;
+            vector<size_t> axes;
+            for (size_t d = 0; d < 3; ++d) {
+              if (M(d,d) > 1.000001)
+                axes.push_back (d);
+              else if (std::abs (M(d,d) - 1.0) > 1.0e-6 || std::abs (M(d,3)) > 1.0e-6 || input.size(d) != output.size(d))
+                return false;
+            }
+            if (axes.empty())
+              return false;
+
+            std::unique_ptr<ProgressBar> progress;
+            if (message.size())
+              progress.reset (new ProgressBar (message, axes.size()));
+
+            Image<float> current;
+            Header H (input);
+            H.datatype() = DataType::Float32;
+            for (size_t i = 0; i < axes.size(); ++i) {
+              const size_t d = axes[i];
+              const bool last = (i == axes.size() - 1);
+              H.size(d) = output.size (d);
+              if (i == 0 && last) {
+                polyphase_pass (input, output, d, M(d,d), M(d,3));
+              }
+              else if (i == 0) {
+                auto next = Image<float>::scratch (H, "anti-aliased down-sampling buffer");
+                polyphase_pass (input, next, d, M(d,d), M(d,3));
+                current = next;
+              }
+              else if (last) {
+                polyphase_pass (current, output, d, M(d,d), M(d,3));
+              }
+              else {
+                auto next = Image<float>::scratch (H, "anti-aliased down-sampling buffer");
+                polyphase_pass (current, next, d, M(d,d), M(d,3));
+                current = next;
+              }
+              if (progress)
+                ++(*progress);
+            }
+            return true;
+          }
+
+        template <class InputImageType, class OutputImageType>
+          void polyphase_pass (InputImageType& src, OutputImageType& dst,
+              const size_t axis, const default_type ratio, const default_type offset)
+          {
+            PolyphaseFunctor1D functor (axis, src.size (axis), dst.size (axis), ratio, offset);
+            vector<size_t> outer_axes;
+            for (size_t n = 0; n < dst.ndim(); ++n)
+              if (n != axis)
+                outer_axes.push_back (n);
+            ThreadedLoop (dst, outer_axes).run (functor, src, dst);
+          }
+
+        class PolyphaseFunctor1D { MEMALIGN (PolyphaseFunctor1D)
+          public:
+            PolyphaseFunctor1D (const size_t axis, const ssize_t in_size, const ssize_t out_size,
+                const default_type ratio, const default_type offset) :
+                axis (axis),
+                in_size (in_size),
+                out_size (out_size),
+                buffer (in_size),
+                from (out_size),
+                weights (out_size)
+            {
+              // kernel stdev of half an output voxel width (expressed here in
+              // input voxels), matching the smoothing convention applied ahead
+              // of sub-sampling elsewhere (see registration/multi_resolution_lmax.h)
+              const default_type stdev = 0.5 * ratio;
+              const ssize_t radius = std::ceil (2.0 * stdev);
+              for (ssize_t j = 0; j < out_size; ++j) {
+                const default_type x = ratio * j + offset;
+                const ssize_t start = std::max (ssize_t (std::ceil (x - radius)), ssize_t (0));
+                const ssize_t end = std::min (ssize_t (std::floor (x + radius)), in_size - 1);
+                from[j] = start;
+                Eigen::VectorXd& w (weights[j]);
+                w.resize (end - start + 1);
+                for (ssize_t k = start; k <= end; ++k)
+                  w[k-start] = exp (-((k-x) * (k-x)) / (2.0 * stdev * stdev));
+                w /= w.sum();
+              }
+            }
+
+            // the loop over the two images must not include the resampled
+            // axis: each invocation processes one full line along it
+            template <class InputImageType, class OutputImageType>
+              void operator() (InputImageType& in, OutputImageType& out)
+              {
+                for (ssize_t k = 0; k < in_size; ++k) {
+                  in.index (axis) = k;
+                  buffer[k] = in.value();
+                }
+                for (ssize_t j = 0; j < out_size; ++j) {
+                  out.index (axis) = j;
+                  default_type result = weights[j].dot (buffer.segment (from[j], weights[j].size()));
+                  if (!std::isfinite (result)) {
+                    // renormalise over the finite values only, as per Filter::Smooth
+                    result = 0.0;
+                    default_type sum_weights = 0.0;
+                    for (ssize_t k = 0; k < weights[j].size(); ++k) {
+                      const default_type value = buffer[from[j] + k];
+                      if (std::isfinite (value)) {
+                        sum_weights += weights[j][k];
+                        result += value * weights[j][k];
+                      }
+                    }
+                    result /= sum_weights;
+                  }
+                  out.value() = result;
+                }
+              }
+
+          private:
+            const size_t axis;
+            const ssize_t in_size, out_size;
+            Eigen::VectorXd buffer;
+            vector<ssize_t> from;
+            vector<Eigen::VectorXd> weights;
+        };
     };
     //! @}
   }
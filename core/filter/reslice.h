@@ -17,6 +17,7 @@
 
 #include "adapter/reslice.h"
 #include "algo/threaded_copy.h"
+#include "algo/threaded_loop.h"
 #include "datatype.h"
 
 namespace MR
@@ -24,6 +25,17 @@ namespace MR
   namespace Filter
   {
 
+  // TODO if there is a use for this elsewhere then we should have threaded_copy4D convenience functions
+  class CopyKernel4D { NOMEMALIGN
+    public:
+      template <class InputImageType, class OutputImageType>
+        FORCE_INLINE void operator() (InputImageType& in, OutputImageType& out) const {
+          out.row(3) = in.row(3);
+        }
+  };
+
+
+
     //! convenience function to regrid one Image onto another
     /*! This function resamples (regrids) the Image \a source onto the
      * Image& \a destination, using the templated interpolator class.
@@ -51,7 +63,12 @@ namespace MR
           const typename ImageTypeDestination::value_type value_when_out_of_bounds = Interp::Base<ImageTypeDestination>::default_out_of_bounds_value())
       {
         Adapter::Reslice<Interpolator, ImageTypeSource> interp (source, destination, transform, oversampling, value_when_out_of_bounds);
-        threaded_copy_with_progress_message ("reslicing \"" + source.name() + "\"", interp, destination, 0, source.ndim(), 2);
+        // for 4D data, process all volumes at each spatial position so that
+        //   the adapter can re-use the interpolator setup across volumes:
+        if (source.ndim() == 4 && destination.ndim() == 4)
+          ThreadedLoop ("reslicing \"" + source.name() + "\"", interp, 0, 3, 1).run (CopyKernel4D(), interp, destination);
+        else
+          threaded_copy_with_progress_message ("reslicing \"" + source.name() + "\"", interp, destination, 0, source.ndim(), 2);
       }
 
 
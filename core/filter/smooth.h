@@ -19,7 +19,6 @@
 #include "image.h"
 #include "algo/copy.h"
 #include "algo/threaded_copy.h"
-#include "adapter/gaussian1D.h"
 #include "filter/base.h"
 
 namespace MR
@@ -122,9 +121,12 @@ namespace MR
         template <class InputImageType, class OutputImageType, typename ValueType = float>
         void operator() (InputImageType& input, OutputImageType& output)
         {
-          std::shared_ptr <Image<ValueType> > in (make_shared<Image<ValueType> > (Image<ValueType>::scratch (input)));
-          threaded_copy (input, *in);
-          std::shared_ptr <Image<ValueType> > out;
+          // copy to scratch once, then run the per-scanline convolution
+          // engine in place along each axis; this avoids both the per-axis
+          // scratch images and the per-voxel kernel gather incurred when
+          // going through the adapter interface
+          auto in = Image<ValueType>::scratch (input);
+          threaded_copy (input, in);
 
           std::unique_ptr<ProgressBar> progress;
           if (message.size()) {
@@ -137,16 +139,21 @@ namespace MR
 
           for (size_t dim = 0; dim < 3; dim++) {
             if (stdev[dim] > 0) {
-              DEBUG ("creating scratch image for smoothing image along dimension " + str(dim));
-              out = make_shared<Image<ValueType> > (Image<ValueType>::scratch (input));
-              Adapter::Gaussian1D<Image<ValueType> > gaussian (*in, stdev[dim], dim, extent[dim], zero_boundary);
-              threaded_copy (gaussian, *out, 0, input.ndim(), 2);
-              in = out;
+              vector<size_t> axes (in.ndim(), dim);
+              size_t axdim = 1;
+              for (size_t i = 0; i < in.ndim(); ++i) {
+                if (stride_order[i] == dim)
+                  continue;
+                axes[axdim++] = stride_order[i];
+              }
+              DEBUG ("smoothing dimension " + str(dim) + " with stride order: " + str(axes));
+              SmoothFunctor1D<Image<ValueType> > smooth (in, stdev[dim], dim, extent[dim], zero_boundary);
+              ThreadedLoop (in, axes, 1).run (smooth, in);
               if (progress)
                 ++(*progress);
             }
           }
-          threaded_copy (*in, output);
+          threaded_copy (in, output);
         }
 
         //! Smooth the image in place
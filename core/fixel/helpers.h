@@ -92,26 +92,36 @@ namespace MR
     }
 
 
+    //! determine the number of fixels in an index image via a full scan
+    /*! only needed when the index image does not carry the fixel count in
+     * its header key-values: this opens the index image and traverses it in
+     * its entirety, so the result should be computed once and re-used
+     * rather than re-derived per data file. */
+    FORCE_INLINE uint32_t count_fixels_from_index (const std::string& index_path)
+    {
+      auto index_image = Image<uint32_t>::open (index_path);
+      index_image.index(3) = 1;
+      uint32_t num_fixels = 0;
+      uint32_t max_offset = 0;
+      for (auto i = MR::Loop (index_image, 0, 3) (index_image); i; ++i) {
+        if (index_image.value() > max_offset) {
+          max_offset = index_image.value();
+          index_image.index(3) = 0;
+          num_fixels = index_image.value();
+          index_image.index(3) = 1;
+        }
+      }
+      return (max_offset + num_fixels);
+    }
+
+
     template <class IndexHeaderType>
     FORCE_INLINE uint32_t get_number_of_fixels (IndexHeaderType& index_header) {
       check_index_image (index_header);
-      if (index_header.keyval().count (n_fixels_key)) {
+      if (index_header.keyval().count (n_fixels_key))
         return std::stoul (index_header.keyval().at(n_fixels_key));
-      } else {
-        auto index_image = Image<uint32_t>::open (index_header.name());
-        index_image.index(3) = 1;
-        uint32_t num_fixels = 0;
-        uint32_t max_offset = 0;
-        for (auto i = MR::Loop (index_image, 0, 3) (index_image); i; ++i) {
-          if (index_image.value() > max_offset) {
-            max_offset = index_image.value();
-            index_image.index(3) = 0;
-            num_fixels = index_image.value();
-            index_image.index(3) = 1;
-          }
-        }
-        return (max_offset + num_fixels);
-      }
+      else
+        return count_fixels_from_index (index_header.name());
     }
 
 
@@ -121,23 +131,10 @@ namespace MR
       bool fixels_match (false);
 
       if (is_index_image (index_header)) {
-        if (index_header.keyval().count (n_fixels_key)) {
+        if (index_header.keyval().count (n_fixels_key))
           fixels_match = std::stoul (index_header.keyval().at(n_fixels_key)) == (uint32_t)data_header.size(0);
-        } else {
-          auto index_image = Image<uint32_t>::open (index_header.name());
-          index_image.index(3) = 1;
-          uint32_t num_fixels = 0;
-          uint32_t max_offset = 0;
-          for (auto i = MR::Loop (index_image, 0, 3) (index_image); i; ++i) {
-            if (index_image.value() > max_offset) {
-              max_offset = index_image.value();
-              index_image.index(3) = 0;
-              num_fixels = index_image.value();
-              index_image.index(3) = 1;
-            }
-          }
-          fixels_match = (max_offset + num_fixels) == (uint32_t)data_header.size(0);
-        }
+        else
+          fixels_match = count_fixels_from_index (index_header.name()) == (uint32_t)data_header.size(0);
       }
 
       return fixels_match;
@@ -193,6 +190,11 @@ namespace MR
         throw InvalidFixelDirectoryException ("Could not find index image in directory " + fixel_directory_path);
 
       check_index_image (header);
+      // older index images do not store the fixel count in the header;
+      // derive it once here, so that downstream queries (and any images
+      // subsequently created from this header) need not re-scan the image
+      if (!header.keyval().count (n_fixels_key))
+        header.keyval()[n_fixels_key] = str (count_fixels_from_index (header.name()));
       return header;
     }
 
@@ -200,6 +202,9 @@ namespace MR
     FORCE_INLINE vector<Header> find_data_headers (const std::string &fixel_directory_path, const Header &index_header, const bool include_directions = false)
     {
       check_index_image (index_header);
+      // derive the fixel count once up front, rather than re-scanning the
+      // index image for every candidate data file in the directory
+      const uint32_t num_fixels = get_number_of_fixels (index_header);
       auto dir_walker = Path::Dir (fixel_directory_path);
       vector<std::string> file_names;
       {
@@ -215,7 +220,7 @@ namespace MR
           try {
             auto H = Header::open (Path::join (fixel_directory_path, fname));
             if (is_data_file (H)) {
-              if (fixels_match (index_header, H)) {
+              if ((uint32_t)H.size(0) == num_fixels) {
                 if (!is_directions_file (H) || include_directions)
                   data_headers.emplace_back (std::move (H));
               } else {
@@ -239,6 +244,7 @@ namespace MR
       Header header;
       check_fixel_directory (fixel_directory_path);
       Header index_header = Fixel::find_index_header (fixel_directory_path);
+      const uint32_t num_fixels = get_number_of_fixels (index_header);
 
       auto dir_walker = Path::Dir (fixel_directory_path);
       std::string fname;
@@ -248,7 +254,7 @@ namespace MR
         if (Path::has_suffix (fname, supported_sparse_formats)
               && is_directions_file (tmp_header = Header::open (full_path))) {
           if (is_directions_file (tmp_header)) {
-            if (fixels_match (index_header, tmp_header)) {
+            if ((uint32_t)tmp_header.size(0) == num_fixels) {
               if (directions_found == true)
                 throw Exception ("multiple directions files found in fixel image directory: " + fixel_directory_path);
               directions_found = true;
@@ -27,6 +27,11 @@ namespace MR
     Pipe          pipe_handler;
     MRtrix        mrtrix_handler;
     MRtrix_GZ     mrtrix_gz_handler;
+#ifdef MRTRIX_ZSTD_SUPPORT
+    MRtrix_Zstd   mrtrix_zstd_handler;
+#endif
+    MRtrix_Tiled  mrtrix_tiled_handler;
+    MRtrix_Mask   mrtrix_mask_handler;
     MRI           mri_handler;
     NIfTI1        nifti1_handler;
     NIfTI2        nifti2_handler;
@@ -51,6 +56,11 @@ namespace MR
       &dicom_handler,
       &mrtrix_handler,
       &mrtrix_gz_handler,
+#ifdef MRTRIX_ZSTD_SUPPORT
+      &mrtrix_zstd_handler,
+#endif
+      &mrtrix_tiled_handler,
+      &mrtrix_mask_handler,
       &nifti1_handler,
       &nifti2_handler,
       &nifti1_gz_handler,
@@ -73,6 +83,9 @@ namespace MR
       ".mih",
       ".mif",
       ".mif.gz",
+      ".mif.zst",
+      ".mifb",
+      ".mifm",
       ".img",
       ".nii",
       ".nii.gz",
@@ -91,6 +91,11 @@ namespace MR
     DECLARE_IMAGEFORMAT (DICOM, "DICOM");
     DECLARE_IMAGEFORMAT (MRtrix, "MRtrix");
     DECLARE_IMAGEFORMAT (MRtrix_GZ, "MRtrix (GZip compressed)");
+#ifdef MRTRIX_ZSTD_SUPPORT
+    DECLARE_IMAGEFORMAT (MRtrix_Zstd, "MRtrix (Zstandard compressed)");
+#endif
+    DECLARE_IMAGEFORMAT (MRtrix_Tiled, "MRtrix (tiled)");
+    DECLARE_IMAGEFORMAT (MRtrix_Mask, "MRtrix (run-length encoded mask)");
     DECLARE_IMAGEFORMAT (NIfTI1, "NIfTI-1.1");
     DECLARE_IMAGEFORMAT (NIfTI2, "NIfTI-2");
     DECLARE_IMAGEFORMAT (NIfTI1_GZ, "NIfTI-1.1 (GZip compressed)");
@@ -14,10 +14,14 @@
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <fstream>
+#include <limits>
 
 #include "header.h"
 #include "image_io/default.h"
+#include "image_io/overview.h"
 #include "formats/list.h"
+#include "file/config.h"
 #include "formats/mrtrix_utils.h"
 #include "file/ofstream.h"
 #include "file/utils.h"
@@ -51,7 +55,28 @@ namespace MR
       File::ParsedName::List list;
       auto num = list.parse_scan_check (fname);
 
-      std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Default (H));
+      std::unique_ptr<ImageIO::Base> io_handler;
+      if (list.size() == 1 && Path::has_suffix (H.name(), ".mif")) {
+        // if the file carries embedded overview levels (detected by matching
+        //   the file size against the cumulative level footprints), attach
+        //   the Overview handler, so that read-write access regenerates the
+        //   levels on close rather than leaving them stale:
+        std::ifstream in (list[0].name().c_str(), std::ios::binary | std::ios::ate);
+        const int64_t file_size = in ? int64_t (in.tellg()) : 0;
+        auto levels = ImageIO::Overview::levels (H, offset, std::numeric_limits<size_t>::max());
+        for (size_t n = levels.size(); n > 0; --n) {
+          int64_t count = 1;
+          for (const auto& s : levels[n-1].size)
+            count *= s;
+          if (file_size == levels[n-1].offset + footprint (count, H.datatype())) {
+            levels.resize (n);
+            io_handler.reset (new ImageIO::Overview (H, levels));
+            break;
+          }
+        }
+      }
+      if (!io_handler)
+        io_handler.reset (new ImageIO::Default (H));
       for (size_t n = 0; n < list.size(); ++n)
         io_handler->files.push_back (File::Entry (list[n].name(), offset));
 
@@ -100,12 +125,32 @@ namespace MR
 
       out.close();
 
-      std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Default (H));
+      std::unique_ptr<ImageIO::Base> io_handler;
       if (single_file) {
-        File::resize (H.name(), offset + footprint(H));
+        //CONF option: ImageOverviewLevels
+        //CONF default: 0 (none)
+        //CONF The number of downsampled overview levels (2x, 4x, 8x, ...)
+        //CONF to embed when writing single-file .mif images. Overviews are
+        //CONF appended after the image data section, allowing readers to
+        //CONF access a thumbnail-scale version of the image without reading
+        //CONF the full-resolution data; readers unaware of the convention
+        //CONF simply ignore the extra bytes.
+        const auto levels = ImageIO::Overview::levels (H, offset, std::max (0, File::Config::get_int ("ImageOverviewLevels", 0)));
+        int64_t end = offset + footprint(H);
+        if (levels.size()) {
+          int64_t count = 1;
+          for (const auto& s : levels.back().size)
+            count *= s;
+          end = levels.back().offset + footprint (count, H.datatype());
+          io_handler.reset (new ImageIO::Overview (H, levels));
+        }
+        else
+          io_handler.reset (new ImageIO::Default (H));
+        File::resize (H.name(), end);
         io_handler->files.push_back (File::Entry (H.name(), offset));
       }
       else {
+        io_handler.reset (new ImageIO::Default (H));
         std::string data_file (H.name().substr (0, H.name().size()-4) + ".dat");
         File::create (data_file, footprint(H));
         io_handler->files.push_back (File::Entry (data_file));
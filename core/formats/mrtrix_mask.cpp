@@ -0,0 +1,100 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "file/ofstream.h"
+#include "file/path.h"
+#include "file/utils.h"
+#include "file/key_value.h"
+#include "header.h"
+#include "image_io/mask.h"
+#include "formats/list.h"
+#include "formats/mrtrix_utils.h"
+
+namespace MR
+{
+  namespace Formats
+  {
+
+    std::unique_ptr<ImageIO::Base> MRtrix_Mask::read (Header& H) const
+    {
+      if (!Path::has_suffix (H.name(), ".mifm"))
+        return std::unique_ptr<ImageIO::Base>();
+
+      File::KeyValue kv (H.name(), "mrtrix mask image");
+
+      read_mrtrix_header (H, kv);
+
+      if (H.datatype() != DataType::Bit)
+        throw Exception ("mask image \"" + H.name() + "\" must use the Bit datatype");
+
+      std::string fname;
+      size_t offset;
+      get_mrtrix_file_path (H, "file", fname, offset);
+      if (fname != H.name())
+        throw Exception ("mask image \"" + H.name() + "\" must store the image data within the same file");
+
+      std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Mask (H));
+      io_handler->files.push_back (File::Entry (fname, offset));
+
+      return io_handler;
+    }
+
+
+
+
+
+    bool MRtrix_Mask::check (Header& H, size_t num_axes) const
+    {
+      if (!Path::has_suffix (H.name(), ".mifm"))
+        return false;
+
+      H.ndim() = num_axes;
+      for (size_t i = 0; i < H.ndim(); i++)
+        if (H.size (i) < 1)
+          H.size(i) = 1;
+
+      // the format stores binary data only:
+      H.datatype() = DataType::Bit;
+
+      return true;
+    }
+
+
+
+
+
+    std::unique_ptr<ImageIO::Base> MRtrix_Mask::create (Header& H) const
+    {
+      File::OFStream out (H.name(), std::ios::out | std::ios::binary);
+
+      out << "mrtrix mask image\n";
+
+      write_mrtrix_header (H, out);
+
+      int64_t offset = out.tellp() + int64_t(18);
+      offset += ((4 - (offset % 4)) % 4);
+      out << "file: . " << offset << "\nEND\n";
+
+      out.close();
+
+      File::resize (H.name(), offset);
+
+      std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Mask (H));
+      io_handler->files.push_back (File::Entry (H.name(), offset));
+
+      return io_handler;
+    }
+
+  }
+}
@@ -0,0 +1,155 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "header.h"
+#include "image_io/tiled.h"
+#include "formats/list.h"
+#include "formats/mrtrix_utils.h"
+#include "file/ofstream.h"
+#include "file/utils.h"
+#include "file/entry.h"
+#include "file/path.h"
+#include "file/key_value.h"
+#include "file/config.h"
+
+namespace MR
+{
+  namespace Formats
+  {
+
+    // mifb: MRtrix Image File, Bricked
+    // as for the mif format, but with the image data stored as fixed-size 3D
+    // bricks (see ImageIO::Tiled), so that spatially local access patterns
+    // map onto contiguous stretches of the file; bricks can optionally be
+    // zlib-compressed individually, preserving random access per brick.
+
+    //! \cond skip
+    namespace
+    {
+
+      void parse_brick_layout (Header& H, size_t& brick_edge, bool& compressed)
+      {
+        auto i = H.keyval().find ("brick");
+        if (i == H.keyval().end())
+          throw Exception ("missing \"brick\" specification for tiled MRtrix image \"" + H.name() + "\"");
+        brick_edge = to<size_t> (i->second);
+        if (brick_edge < 1)
+          throw Exception ("invalid brick size for tiled MRtrix image \"" + H.name() + "\"");
+        H.keyval().erase (i);
+
+        compressed = false;
+        i = H.keyval().find ("brick_compression");
+        if (i != H.keyval().end()) {
+          if (i->second == "zlib")
+            compressed = true;
+          else if (i->second != "none")
+            throw Exception ("unsupported brick compression \"" + i->second + "\" in tiled MRtrix image \"" + H.name() + "\"");
+          H.keyval().erase (i);
+        }
+      }
+
+    }
+    //! \endcond
+
+
+
+
+    std::unique_ptr<ImageIO::Base> MRtrix_Tiled::read (Header& H) const
+    {
+      if (!Path::has_suffix (H.name(), ".mifb"))
+        return std::unique_ptr<ImageIO::Base>();
+
+      File::KeyValue kv (H.name(), "mrtrix tiled image");
+
+      read_mrtrix_header (H, kv);
+
+      size_t brick_edge;
+      bool compressed;
+      parse_brick_layout (H, brick_edge, compressed);
+
+      std::string fname;
+      size_t offset;
+      get_mrtrix_file_path (H, "file", fname, offset);
+      if (fname != H.name())
+        throw Exception ("tiled MRtrix image \"" + H.name() + "\" must store the image data within the same file");
+
+      std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Tiled (H, brick_edge, compressed));
+      io_handler->files.push_back (File::Entry (fname, offset));
+
+      return io_handler;
+    }
+
+
+
+
+
+    bool MRtrix_Tiled::check (Header& H, size_t num_axes) const
+    {
+      if (!Path::has_suffix (H.name(), ".mifb"))
+        return false;
+
+      H.ndim() = num_axes;
+      for (size_t i = 0; i < H.ndim(); i++)
+        if (H.size (i) < 1)
+          H.size(i) = 1;
+
+      // bricks are byte-aligned:
+      if (H.datatype() == DataType::Bit)
+        H.datatype() = DataType::UInt8;
+
+      return true;
+    }
+
+
+
+
+    std::unique_ptr<ImageIO::Base> MRtrix_Tiled::create (Header& H) const
+    {
+      //CONF option: ImageBrickSize
+      //CONF default: 16
+      //CONF The brick edge length (in voxels) to use when writing tiled
+      //CONF (.mifb) images.
+      const size_t brick_edge = File::Config::get_int ("ImageBrickSize", 16);
+      //CONF option: ImageBrickCompression
+      //CONF default: 0 (false)
+      //CONF Whether to zlib-compress individual bricks when writing tiled
+      //CONF (.mifb) images.
+      const bool compressed = File::Config::get_bool ("ImageBrickCompression", false);
+
+      File::OFStream out (H.name(), std::ios::out | std::ios::binary);
+
+      out << "mrtrix tiled image\n";
+
+      write_mrtrix_header (H, out);
+
+      out << "brick: " << brick_edge << "\n";
+      out << "brick_compression: " << (compressed ? "zlib" : "none") << "\n";
+
+      int64_t offset = out.tellp() + int64_t(18);
+      offset += ((4 - (offset % 4)) % 4);
+      out << "file: . " << offset << "\nEND\n";
+
+      out.close();
+
+      File::resize (H.name(), offset);
+
+      std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Tiled (H, brick_edge, compressed));
+      io_handler->files.push_back (File::Entry (H.name(), offset));
+
+      return io_handler;
+    }
+
+
+  }
+}
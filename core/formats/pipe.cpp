@@ -58,7 +58,7 @@ namespace MR
       if (H.name() != "-")
         return false;
 
-      H.name() = File::create_tempfile (0, "mif");
+      H.name() = File::create_tempfile (0, "mif", File::pipe_dir());
 
       SignalHandler::mark_file_for_deletion (H.name());
 
@@ -12,6 +12,16 @@
  */
 
 
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <typeinfo>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "mrtrix.h"
 #include "header.h"
 #include "phase_encoding.h"
@@ -19,8 +29,17 @@
 #include "transform.h"
 #include "image_io/default.h"
 #include "image_io/scratch.h"
+#include "file/config.h"
 #include "file/name_parser.h"
+#include "file/path.h"
+#include "file/utils.h"
 #include "formats/list.h"
+#include "thread.h"
+
+/* minimum number of files in a numbered image sequence for which the
+   per-file header reads are performed in parallel; for smaller sequences
+   the cost of launching threads exceeds the latency hidden */
+#define HEADER_MULTI_FILE_PARALLEL_THRESHOLD 4
 
 namespace MR
 {
@@ -80,6 +99,296 @@ namespace MR
 
       return " with dimensions " + join (dims, "x") + ", voxel spacing " + join (vox, "x") + ", datatype " + H.datatype().specifier();
     }
+
+
+
+
+    //CONF option: HeaderCache
+    //CONF default: 0 (false)
+    //CONF Cache parsed image headers on disk, so that repeated invocations
+    //CONF against the same images (e.g. scripted pipelines running mrinfo /
+    //CONF mrconvert many times over) can skip the full format parse - most
+    //CONF notably the per-file scan of DICOM series. Cache entries record
+    //CONF the size and modification time of every file they reference, and
+    //CONF are ignored whenever any of these change.
+
+    //CONF option: HeaderCacheDir
+    //CONF default: ~/.cache/mrtrix-headers
+    //CONF Location of the on-disk header cache (see HeaderCache).
+
+    //! read the headers of the remaining members of a multi-file sequence
+    /* Each thread claims file indices from a shared counter, reads the
+     * header using a thread-local copy of the template, and deposits the
+     * result at its index so that the subsequent (order-dependent) merge
+     * can proceed serially. This hides the per-file round-trip latency
+     * when assembling long sequences from network storage. */
+    class MultiFileHeaderReader { NOMEMALIGN
+      public:
+        MultiFileHeaderReader (const Header& template_header,
+                               const Formats::Base* format,
+                               const File::ParsedName::List& list,
+                               vector<Header>& headers,
+                               vector<std::unique_ptr<ImageIO::Base>>& handlers,
+                               std::atomic<size_t>& next,
+                               std::mutex& mutex,
+                               std::unique_ptr<Exception>& error) :
+            template_header (template_header), format (format), list (list),
+            headers (headers), handlers (handlers), next (next), mutex (mutex), error (error) { }
+
+        void execute () {
+          size_t index;
+          while ((index = next.fetch_add (1)) < list.size()) {
+            try {
+              Header header (template_header);
+              header.name() = list[index].name();
+              handlers[index] = format->read (header);
+              if (!handlers[index])
+                throw Exception ("image specifier contains mixed format files");
+              headers[index] = std::move (header);
+            }
+            catch (Exception& E) {
+              std::lock_guard<std::mutex> lock (mutex);
+              if (!error)
+                error.reset (new Exception (E));
+              return;
+            }
+          }
+        }
+
+      private:
+        const Header& template_header;
+        const Formats::Base* format;
+        const File::ParsedName::List& list;
+        vector<Header>& headers;
+        vector<std::unique_ptr<ImageIO::Base>>& handlers;
+        std::atomic<size_t>& next;
+        std::mutex& mutex;
+        std::unique_ptr<Exception>& error;
+    };
+
+
+
+    bool header_cache_enabled ()
+    {
+      static const bool enabled = File::Config::get_bool ("HeaderCache", false);
+      return enabled;
+    }
+
+    std::string header_cache_path (const std::string& image_name)
+    {
+      std::string dir = File::Config::get ("HeaderCacheDir", "");
+      if (dir.empty()) {
+        const char* home = getenv ("HOME");
+        if (!home)
+          return std::string();
+        dir = Path::join (Path::join (home, ".cache"), "mrtrix-headers");
+      }
+      // the file name is only a lookup key; the image name is stored inside
+      //   the entry and verified on read, so hash collisions simply miss
+      std::ostringstream name;
+      name << std::hex << std::hash<std::string>() (image_name) << "-" << std::dec << image_name.size();
+      return Path::join (dir, name.str());
+    }
+
+    bool header_cache_stat (const std::string& path, int64_t& size, int64_t& mtime)
+    {
+      struct stat buf;
+      if (stat (path.c_str(), &buf))
+        return false;
+      size = int64_t (buf.st_size);
+      mtime = int64_t (buf.st_mtime);
+      return true;
+    }
+
+
+
+    //! attempt to restore a previously-parsed header from the on-disk cache
+    /* Returns a reconstructed IO handler only if a cache entry exists for
+     * this exact image name, and the size and modification time of every
+     * file it references are unchanged; any mismatch, parse error or
+     * unexpected content returns nullptr, falling back to the normal format
+     * handlers. Only headers backed by a plain ImageIO::Default handler are
+     * ever cached, so the handler can be reconstructed from the stored list
+     * of data file entries. */
+    std::unique_ptr<ImageIO::Base> read_header_cache (const std::string& image_name, Header& H, const char*& format)
+    {
+      const std::string cache_file = header_cache_path (image_name);
+      if (cache_file.empty() || !Path::exists (cache_file))
+        return { };
+      std::ifstream in (cache_file.c_str(), std::ios::binary);
+      if (!in)
+        return { };
+
+      std::string line;
+      auto next = [&] (const std::string& key) -> std::string {
+        if (!std::getline (in, line))
+          throw Exception ("truncated header cache entry");
+        if (line.compare (0, key.size()+2, key + ": "))
+          throw Exception ("malformed header cache entry");
+        return line.substr (key.size()+2);
+      };
+
+      try {
+        if (next ("magic") != "mrtrix header cache 1")
+          return { };
+        if (next ("image") != image_name)
+          return { };
+
+        const size_t num_checks = to<size_t> (next ("checks"));
+        for (size_t n = 0; n != num_checks; ++n) {
+          const std::string entry = next ("check");
+          const size_t s1 = entry.find (' ');
+          const size_t s2 = entry.find (' ', s1+1);
+          int64_t size = 0, mtime = 0;
+          if (!header_cache_stat (entry.substr (s2+1), size, mtime))
+            return { };
+          if (to<int64_t> (entry.substr (0, s1)) != size || to<int64_t> (entry.substr (s1+1, s2-s1-1)) != mtime)
+            return { };
+        }
+
+        H.name() = next ("name");
+        const size_t nd = to<size_t> (next ("ndim"));
+        H.ndim() = nd;
+        for (size_t n = 0; n != nd; ++n) {
+          const auto axis = split (next ("axis"), " ");
+          if (axis.size() != 3)
+            throw Exception ("malformed axis entry in header cache");
+          H.size(n) = to<ssize_t> (axis[0]);
+          H.spacing(n) = to<default_type> (axis[1]);
+          H.stride(n) = to<ssize_t> (axis[2]);
+        }
+
+        const auto M = split (next ("transform"), ",");
+        if (M.size() != 12)
+          throw Exception ("malformed transform entry in header cache");
+        for (size_t row = 0; row != 3; ++row)
+          for (size_t col = 0; col != 4; ++col)
+            H.transform().matrix() (row, col) = to<default_type> (M[4*row+col]);
+
+        H.datatype() = DataType::parse (next ("datatype"));
+        H.intensity_offset() = to<default_type> (next ("offset"));
+        H.intensity_scale() = to<default_type> (next ("scale"));
+
+        // format() must point at one of the static handler descriptions
+        const std::string format_string = next ("format");
+        for (const Formats::Base** handler = Formats::handlers; *handler; ++handler) {
+          if (format_string == (*handler)->description) {
+            format = (*handler)->description;
+            break;
+          }
+        }
+
+        const size_t num_keyvals = to<size_t> (next ("keyvals"));
+        for (size_t n = 0; n != num_keyvals; ++n) {
+          const std::string key = next ("key");
+          std::string& value = H.keyval()[key];
+          const size_t num_lines = to<size_t> (next ("lines"));
+          for (size_t l = 0; l != num_lines; ++l)
+            add_line (value, next ("value"));
+        }
+
+        const size_t num_files = to<size_t> (next ("files"));
+        std::unique_ptr<ImageIO::Base> io_handler (new ImageIO::Default (H));
+        for (size_t n = 0; n != num_files; ++n) {
+          const std::string entry = next ("file");
+          const size_t s = entry.find (' ');
+          io_handler->files.push_back (File::Entry (entry.substr (s+1), to<int64_t> (entry.substr (0, s))));
+        }
+
+        DEBUG ("header for image \"" + image_name + "\" restored from cache");
+        return io_handler;
+      }
+      catch (Exception& E) {
+        E.display (3);
+      }
+      catch (...) { }
+      return { };
+    }
+
+
+
+    //! store a freshly-parsed header in the on-disk cache
+    /* Failure to write is never allowed to affect the invoking command;
+     * entries are written to a temporary file and atomically renamed into
+     * place so that concurrent invocations cannot observe partial content. */
+    void write_header_cache (const std::string& image_name, const Header& H, const ImageIO::Base& io, const File::ParsedName::List& list)
+    {
+      if (typeid (io) != typeid (ImageIO::Default))
+        return;
+      const std::string cache_file = header_cache_path (image_name);
+      if (cache_file.empty())
+        return;
+
+      try {
+        // validation covers the named header file(s) as well as the data
+        //   files the handler maps; for DICOM, the named path is the series
+        //   directory, whose modification time changes when files are added
+        std::set<std::string> checks;
+        for (size_t n = 0; n != list.size(); ++n)
+          checks.insert (list[n].name());
+        for (const auto& entry : io.files)
+          checks.insert (entry.name);
+
+        const std::string dir = Path::dirname (cache_file);
+        if (!Path::is_dir (dir)) {
+          const std::string parent = Path::dirname (dir);
+          if (parent.size() && !Path::is_dir (parent))
+            File::mkdir (parent);
+          File::mkdir (dir);
+        }
+
+        const std::string tmp_file = cache_file + "-" + str(getpid());
+        std::ofstream out (tmp_file.c_str(), std::ios::binary);
+        if (!out)
+          throw Exception ("unable to write header cache entry for image \"" + image_name + "\"");
+
+        out << "magic: mrtrix header cache 1\n";
+        out << "image: " << image_name << "\n";
+        out << "checks: " << checks.size() << "\n";
+        for (const auto& path : checks) {
+          int64_t size = 0, mtime = 0;
+          if (!header_cache_stat (path, size, mtime))
+            throw Exception ("unable to stat \"" + path + "\" for header cache entry");
+          out << "check: " << size << " " << mtime << " " << path << "\n";
+        }
+
+        out << "name: " << H.name() << "\n";
+        out << "ndim: " << H.ndim() << "\n";
+        for (size_t n = 0; n != H.ndim(); ++n)
+          out << "axis: " << H.size(n) << " " << str(H.spacing(n), 17) << " " << H.stride(n) << "\n";
+        vector<std::string> M;
+        for (size_t row = 0; row != 3; ++row)
+          for (size_t col = 0; col != 4; ++col)
+            M.push_back (str (H.transform().matrix() (row, col), 17));
+        out << "transform: " << join (M, ",") << "\n";
+        out << "datatype: " << H.datatype().specifier() << "\n";
+        out << "offset: " << str(H.intensity_offset(), 17) << "\n";
+        out << "scale: " << str(H.intensity_scale(), 17) << "\n";
+        out << "format: " << (H.format() ? H.format() : "") << "\n";
+
+        out << "keyvals: " << H.keyval().size() << "\n";
+        for (const auto& item : H.keyval()) {
+          const auto lines = split_lines (item.second);
+          out << "key: " << item.first << "\n";
+          out << "lines: " << lines.size() << "\n";
+          for (const auto& value : lines)
+            out << "value: " << value << "\n";
+        }
+
+        out << "files: " << io.files.size() << "\n";
+        for (const auto& entry : io.files)
+          out << "file: " << entry.start << " " << entry.name << "\n";
+
+        out.close();
+        if (!out || std::rename (tmp_file.c_str(), cache_file.c_str()))
+          throw Exception ("unable to finalise header cache entry for image \"" + image_name + "\"");
+        DEBUG ("header for image \"" + image_name + "\" stored in cache");
+      }
+      catch (Exception& E) {
+        E.display (3);
+      }
+    }
+
   }
 
 
@@ -99,45 +408,76 @@ namespace MR
       File::ParsedName::List list;
       vector<int> num = list.parse_scan_check (image_name);
 
-      const Formats::Base** format_handler = Formats::handlers;
-      size_t item = 0;
-      H.name() = list[item].name();
+      std::unique_ptr<ImageIO::Base> cached_io;
+      if (header_cache_enabled())
+        cached_io = read_header_cache (image_name, H, H.format_);
 
-      for (; *format_handler; format_handler++) {
-        if ( (H.io = (*format_handler)->read (H)) )
-          break;
+      if (cached_io) {
+        H.io = std::move (cached_io);
       }
+      else {
 
-      if (!*format_handler)
-        throw Exception ("unknown format for image \"" + H.name() + "\"");
-      assert (H.io);
-
-      H.format_ = (*format_handler)->description;
+        const Formats::Base** format_handler = Formats::handlers;
+        size_t item = 0;
+        H.name() = list[item].name();
 
-      while (++item < list.size()) {
-        Header header (H);
-        std::unique_ptr<ImageIO::Base> io_handler;
-        header.name() = list[item].name();
-        if (!(io_handler = (*format_handler)->read (header)))
-          throw Exception ("image specifier contains mixed format files");
-        assert (io_handler);
-        H.merge (header);
-        H.io->merge (*io_handler);
-      }
+        for (; *format_handler; format_handler++) {
+          if ( (H.io = (*format_handler)->read (H)) )
+            break;
+        }
 
-      if (num.size()) {
-        int a = 0, n = 0;
-        for (size_t i = 0; i < H.ndim(); i++)
-          if (H.stride(i))
-            ++n;
-        H.axes_.resize (n + num.size());
+        if (!*format_handler)
+          throw Exception ("unknown format for image \"" + H.name() + "\"");
+        assert (H.io);
+
+        H.format_ = (*format_handler)->description;
+
+        if (list.size() >= HEADER_MULTI_FILE_PARALLEL_THRESHOLD && Thread::number_of_threads() > 1) {
+          // read the remaining headers in parallel, then merge in order
+          vector<Header> headers (list.size());
+          vector<std::unique_ptr<ImageIO::Base>> handlers (list.size());
+          std::atomic<size_t> next (1);
+          std::mutex mutex;
+          std::unique_ptr<Exception> error;
+          MultiFileHeaderReader reader (H, *format_handler, list, headers, handlers, next, mutex, error);
+          Thread::run (Thread::multi (reader), "multi-file header read").wait();
+          if (error)
+            throw *error;
+          while (++item < list.size()) {
+            H.merge (headers[item]);
+            H.io->merge (*handlers[item]);
+          }
+        }
+        else {
+          while (++item < list.size()) {
+            Header header (H);
+            std::unique_ptr<ImageIO::Base> io_handler;
+            header.name() = list[item].name();
+            if (!(io_handler = (*format_handler)->read (header)))
+              throw Exception ("image specifier contains mixed format files");
+            assert (io_handler);
+            H.merge (header);
+            H.io->merge (*io_handler);
+          }
+        }
 
-        for (size_t i = 0; i < num.size(); ++i) {
-          while (H.stride(a)) ++a;
-          H.size(a) = num[num.size()-1-i];
-          H.stride(a) = ++n;
+        if (num.size()) {
+          int a = 0, n = 0;
+          for (size_t i = 0; i < H.ndim(); i++)
+            if (H.stride(i))
+              ++n;
+          H.axes_.resize (n + num.size());
+
+          for (size_t i = 0; i < num.size(); ++i) {
+            while (H.stride(a)) ++a;
+            H.size(a) = num[num.size()-1-i];
+            H.stride(a) = ++n;
+          }
+          H.name() = image_name;
         }
-        H.name() = image_name;
+
+        if (header_cache_enabled())
+          write_header_cache (image_name, H, *H.io, list);
       }
 
       H.sanitise();
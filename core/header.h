@@ -339,6 +339,12 @@ namespace MR
       //! print out debugging information
       friend std::ostream& operator<< (std::ostream& stream, const Header& H);
 
+      // the overview machinery (image_io/overview.h) probes and redirects
+      //   the underlying IO handler directly
+      friend size_t overview_levels (const Header&);
+      friend Header overview (const Header&, size_t);
+      friend size_t select_overview (const Header&, ssize_t);
+
     protected:
       vector<Axis> axes_;
       transform_type transform_;
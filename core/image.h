@@ -15,6 +15,7 @@
 #ifndef __image_h__
 #define __image_h__
 
+#include <atomic>
 #include <functional>
 #include <type_traits>
 #include <tuple>
@@ -27,6 +28,10 @@
 #include "algo/copy.h"
 #include "algo/threaded_copy.h"
 
+/* granularity of the chunks of the byte range claimed by each thread in
+   the raw block-copy fast path between layout-compatible images */
+#define IMAGE_RAW_COPY_CHUNK_SIZE 16777216
+
 namespace MR
 {
 
@@ -219,8 +224,9 @@ namespace MR
         Buffer (Buffer&&) = default;
         Buffer& operator= (const Buffer&) = delete;
         Buffer& operator= (Buffer&&) = default;
-        Buffer (const Buffer& b) : 
-          Header (b), fetch_func (b.fetch_func), store_func (b.store_func) { }
+        Buffer (const Buffer& b) :
+          Header (b), fetch_func (b.fetch_func), store_func (b.store_func),
+          fetch_scanline (b.fetch_scanline), store_scanline (b.store_scanline) { }
 
 
         FORCE_INLINE ValueType get_value (size_t offset) const {
@@ -233,6 +239,28 @@ namespace MR
           store_func (val, io->segment (nseg), offset - nseg*io->segment_size(), intensity_offset(), intensity_scale());
         }
 
+        //! batched fetch of \a count consecutive (in storage order) values starting at \a offset
+        void get_values (ValueType* dest, size_t offset, size_t count) const {
+          while (count) {
+            const size_t nseg = offset / io->segment_size();
+            const size_t within = offset - nseg*io->segment_size();
+            const size_t n = std::min<size_t> (count, io->segment_size() - within);
+            fetch_scanline (dest, io->segment (nseg), within, n, intensity_offset(), intensity_scale());
+            dest += n; offset += n; count -= n;
+          }
+        }
+
+        //! batched store of \a count consecutive (in storage order) values starting at \a offset
+        void set_values (const ValueType* src, size_t offset, size_t count) const {
+          while (count) {
+            const size_t nseg = offset / io->segment_size();
+            const size_t within = offset - nseg*io->segment_size();
+            const size_t n = std::min<size_t> (count, io->segment_size() - within);
+            store_scanline (src, io->segment (nseg), within, n, intensity_offset(), intensity_scale());
+            src += n; offset += n; count -= n;
+          }
+        }
+
         std::unique_ptr<uint8_t[]> data_buffer;
         void* get_data_pointer ();
 
@@ -241,9 +269,12 @@ namespace MR
       protected:
         std::function<ValueType(const void*,size_t,default_type,default_type)> fetch_func;
         std::function<void(ValueType,void*,size_t,default_type,default_type)> store_func;
+        std::function<void(ValueType*,const void*,size_t,size_t,default_type,default_type)> fetch_scanline;
+        std::function<void(const ValueType*,void*,size_t,size_t,default_type,default_type)> store_scanline;
 
         void set_fetch_store_functions () {
           __set_fetch_store_functions (fetch_func, store_func, datatype());
+          __set_fetch_store_scanline_functions (fetch_scanline, store_scanline, datatype());
         }
     };
 
@@ -390,9 +421,23 @@ namespace MR
         if (buffer->get_io()) {
           if (buffer->get_io()->is_image_readwrite() && buffer->data_buffer) {
             auto data_buffer = std::move (buffer->data_buffer);
-            TmpImage<ValueType> src = { *buffer, data_buffer.get(), vector<ssize_t> (ndim(), 0), strides, Stride::offset (*this) };
-            Image<ValueType> dest (buffer);
-            threaded_copy_with_progress_message ("writing back direct IO buffer for \"" + name() + "\"", src, dest); 
+            if (strides == Stride::get (*buffer)) {
+              // identical element ordering in memory and on disk: write back
+              // scanline-by-scanline via the batched store functions:
+              const ValueType* src = reinterpret_cast<const ValueType*> (data_buffer.get());
+              const size_t nvox = voxel_count (*this);
+              const size_t scanline = size_t (size (0));
+              ProgressBar progress ("writing back direct IO buffer for \"" + name() + "\"", (nvox + scanline - 1) / scanline);
+              for (size_t offset = 0; offset < nvox; offset += scanline) {
+                buffer->set_values (src + offset, offset, std::min (scanline, nvox - offset));
+                ++progress;
+              }
+            }
+            else {
+              TmpImage<ValueType> src = { *buffer, data_buffer.get(), vector<ssize_t> (ndim(), 0), strides, Stride::offset (*this) };
+              Image<ValueType> dest (buffer);
+              threaded_transpose_copy_with_progress_message ("writing back direct IO buffer for \"" + name() + "\"", src, dest);
+            }
           }
         }
       }
@@ -432,10 +477,23 @@ namespace MR
         // no need to preload if data is zero anyway:
         memset (buffer->data_buffer.get(), 0, buffer_size);
       }
+      else if (with_strides == Stride::get (*this)) {
+        // identical element ordering on disk and in memory: this is a pure
+        // datatype conversion, most efficiently performed one scanline at a
+        // time via the batched (vectorisable) fetch functions:
+        ValueType* dest = reinterpret_cast<ValueType*> (buffer->data_buffer.get());
+        const size_t nvox = voxel_count (*this);
+        const size_t scanline = size_t (size (0));
+        ProgressBar progress ("preloading data for \"" + name() + "\"", (nvox + scanline - 1) / scanline);
+        for (size_t offset = 0; offset < nvox; offset += scanline) {
+          buffer->get_values (dest + offset, offset, std::min (scanline, nvox - offset));
+          ++progress;
+        }
+      }
       else {
         auto src (*this);
         TmpImage<ValueType> dest = { *buffer, buffer->data_buffer.get(), vector<ssize_t> (ndim(), 0), with_strides, Stride::offset (with_strides, *this) };
-        threaded_copy_with_progress_message ("preloading data for \"" + name() + "\"", src, dest); 
+        threaded_transpose_copy_with_progress_message ("preloading data for \"" + name() + "\"", src, dest);
       }
 
       return Image (buffer, with_strides);
@@ -453,7 +511,7 @@ namespace MR
 
       // try to dump file to mrtrix format if possible (direct IO)
       if (filename == "-")
-        filename = File::create_tempfile (0, "mif");
+        filename = File::create_tempfile (0, "mif", File::pipe_dir());
 
       DEBUG ("dumping image \"" + name() + "\" to file \"" + filename + "\"...");
 
@@ -540,6 +598,188 @@ namespace MR
     }
 
 
+
+
+  //! \cond skip
+
+  namespace
+  {
+
+    /* Copying between two images that share datatype, stride layout and
+     * intensity scaling does not need the per-voxel fetch / store
+     * conversion path: the stored bytes can be transferred verbatim. This
+     * checks whether a copy over axes [from_axis, to_axis) between these
+     * particular images qualifies. Direct-IO views qualify only when both
+     * sides are direct-IO and their (possibly reorganised) view strides
+     * agree; mixing a direct-IO view with a file-layout view would compare
+     * buffers with different internal organisation. */
+    template <typename ValueType>
+      inline bool __copy_is_raw_compatible (const Image<ValueType>& source, const Image<ValueType>& destination,
+          const size_t from_axis, const size_t to_axis)
+      {
+        if (!source.valid() || !destination.valid())
+          return false;
+        if (from_axis != 0 || to_axis < source.ndim() || source.ndim() != destination.ndim())
+          return false;
+
+        if (source.is_direct_io() && destination.is_direct_io()) {
+          for (size_t n = 0; n < source.ndim(); ++n) {
+            if (source.size(n) != destination.size(n) || source.stride(n) != destination.stride(n))
+              return false;
+          }
+          return true;
+        }
+        if (source.is_direct_io() || destination.is_direct_io())
+          return false;
+
+        if (!source.buffer->get_io() || !destination.buffer->get_io())
+          return false;
+        const Header& src (*source.buffer);
+        const Header& dest (*destination.buffer);
+        if (src.datatype() != dest.datatype() || src.datatype() == DataType::Bit)
+          return false;
+        if (src.intensity_offset() != dest.intensity_offset() || src.intensity_scale() != dest.intensity_scale())
+          return false;
+        for (size_t n = 0; n < src.ndim(); ++n) {
+          if (src.size(n) != dest.size(n) || src.stride(n) != dest.stride(n))
+            return false;
+        }
+        return true;
+      }
+
+
+    //! total number of bytes transferred by a raw copy between compatible images
+    template <typename ValueType>
+      inline size_t __raw_copy_bytes (const Image<ValueType>& source)
+      {
+        return source.is_direct_io() ?
+          sizeof (ValueType) * voxel_count (source) :
+          source.buffer->datatype().bytes() * voxel_count (source);
+      }
+
+
+    //! raw byte-level copy of [from_byte, from_byte+num_bytes) between compatible images
+    /* For indirect-IO images, the copy proceeds segment by segment on
+     * whichever side next reaches a segment boundary, so differing
+     * segmentations (e.g. a multi-file source and single-file destination)
+     * are handled transparently. */
+    template <typename ValueType>
+      inline void __raw_copy (const Image<ValueType>& source, Image<ValueType>& destination,
+          const size_t from_byte, const size_t num_bytes)
+      {
+        if (source.is_direct_io()) {
+          memcpy (reinterpret_cast<uint8_t*> (destination.address() - destination.offset()) + from_byte,
+                  reinterpret_cast<const uint8_t*> (source.address() - source.offset()) + from_byte, num_bytes);
+          return;
+        }
+        ImageIO::Base* in (source.buffer->get_io());
+        ImageIO::Base* out (destination.buffer->get_io());
+        const size_t value_bytes = source.buffer->datatype().bytes();
+        const size_t in_segment_bytes = in->segment_size() * value_bytes;
+        const size_t out_segment_bytes = out->segment_size() * value_bytes;
+        size_t offset = from_byte, remaining = num_bytes;
+        while (remaining) {
+          const size_t in_seg = offset / in_segment_bytes;
+          const size_t in_within = offset - in_seg*in_segment_bytes;
+          const size_t out_seg = offset / out_segment_bytes;
+          const size_t out_within = offset - out_seg*out_segment_bytes;
+          const size_t n = std::min (remaining, std::min (in_segment_bytes - in_within, out_segment_bytes - out_within));
+          memcpy (out->segment (out_seg) + out_within, in->segment (in_seg) + in_within, n);
+          offset += n;
+          remaining -= n;
+        }
+      }
+
+
+    // each thread claims chunks of the byte range from a shared counter;
+    // chunks are large enough to amortise the claim, small enough to
+    // balance load across threads towards the end of the range
+    template <typename ValueType>
+      class __RawCopyFunctor { NOMEMALIGN
+        public:
+          __RawCopyFunctor (const Image<ValueType>& source, Image<ValueType>& destination,
+              const size_t total_bytes, std::atomic<size_t>& next) :
+            source (source), destination (destination), total_bytes (total_bytes), next (next) { }
+          void execute () {
+            size_t from;
+            while ((from = next.fetch_add (size_t (IMAGE_RAW_COPY_CHUNK_SIZE))) < total_bytes)
+              __raw_copy (source, destination, from, std::min (size_t (IMAGE_RAW_COPY_CHUNK_SIZE), total_bytes - from));
+          }
+        private:
+          const Image<ValueType>& source;
+          Image<ValueType>& destination;
+          const size_t total_bytes;
+          std::atomic<size_t>& next;
+      };
+
+  }
+
+  //! \endcond
+
+
+
+  //! copy between layout-compatible images via raw block transfer
+  /*! Overloads the generic copy() / threaded_copy() algorithms for pairs of
+   * Image objects: when source and destination share datatype, strides and
+   * intensity scaling (the common case for straight format conversions),
+   * the copy degenerates into memcpy of the underlying buffers, turning
+   * the operation into a pure bandwidth transfer; otherwise the regular
+   * per-voxel path is taken. */
+  template <typename ValueType>
+    inline void copy (Image<ValueType>& source, Image<ValueType>& destination, size_t from_axis = 0, size_t to_axis = std::numeric_limits<size_t>::max())
+    {
+      if (__copy_is_raw_compatible (source, destination, from_axis, to_axis)) {
+        __raw_copy (source, destination, 0, __raw_copy_bytes (source));
+        return;
+      }
+      for (auto i = Loop (source, from_axis, to_axis) (source, destination); i; ++i)
+        destination.value() = source.value();
+    }
+
+
+  //! see copy (Image&, Image&, size_t, size_t)
+  template <typename ValueType>
+    inline void threaded_copy (Image<ValueType>& source, Image<ValueType>& destination,
+        size_t from_axis = 0,
+        size_t to_axis = std::numeric_limits<size_t>::max(),
+        size_t num_axes_in_thread = 1)
+    {
+      if (__copy_is_raw_compatible (source, destination, from_axis, to_axis)) {
+        const size_t total_bytes = __raw_copy_bytes (source);
+        if (total_bytes > size_t (IMAGE_RAW_COPY_CHUNK_SIZE) && Thread::number_of_threads() > 1) {
+          std::atomic<size_t> next (0);
+          __RawCopyFunctor<ValueType> func (source, destination, total_bytes, next);
+          Thread::run (Thread::multi (func), "raw image copy").wait();
+        }
+        else
+          __raw_copy (source, destination, 0, total_bytes);
+        return;
+      }
+      ThreadedLoop (source, from_axis, to_axis, num_axes_in_thread)
+        .run (__copy_func(), source, destination);
+    }
+
+
+  //! see copy (Image&, Image&, size_t, size_t)
+  template <typename ValueType>
+    inline void threaded_copy_with_progress_message (
+        const std::string& message,
+        Image<ValueType>& source,
+        Image<ValueType>& destination,
+        size_t from_axis = 0,
+        size_t to_axis = std::numeric_limits<size_t>::max(),
+        size_t num_axes_in_thread = 1)
+    {
+      if (__copy_is_raw_compatible (source, destination, from_axis, to_axis)) {
+        ProgressBar progress (message);
+        threaded_copy (source, destination, from_axis, to_axis, num_axes_in_thread);
+        return;
+      }
+      ThreadedLoop (message, source, from_axis, to_axis, num_axes_in_thread)
+        .run (__copy_func(), source, destination);
+    }
+
+
 }
 
 #endif
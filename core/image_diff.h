@@ -15,12 +15,61 @@
 #ifndef __image_check__h__
 #define __image_check__h__
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "image.h"
 #include "image_helpers.h"
 #include "algo/loop.h"
 
 namespace MR
 {
 
+  //! \cond skip
+
+  // fast path for the comparison functions below: if both images draw on
+  // byte-identical underlying data buffers (same datatype, layout, scaling
+  // and raw bytes), their values are identical, and any tolerance-based
+  // comparison is guaranteed to pass without inspecting values one by one.
+  // The generic overload (adapters, functors, etc.) simply reports no match;
+  // the Image overload compares the IO segments with memcmp.
+  template <class ImageType1, class ImageType2>
+    inline bool __image_buffers_identical (ImageType1&, ImageType2&) { return false; }
+
+  template <typename ValueType1, typename ValueType2>
+    inline bool __image_buffers_identical (Image<ValueType1>& in1, Image<ValueType2>& in2)
+    {
+      if (!in1.buffer || !in2.buffer)
+        return false;
+      const auto& buf1 (*in1.buffer);
+      const auto& buf2 (*in2.buffer);
+      const ImageIO::Base* io1 (buf1.get_io());
+      const ImageIO::Base* io2 (buf2.get_io());
+      if (!io1 || !io2)
+        return false;
+      if (!dimensions_match (buf1, buf2))
+        return false;
+      if (buf1.datatype()() != buf2.datatype()())
+        return false;
+      if (buf1.intensity_offset() != buf2.intensity_offset() ||
+          buf1.intensity_scale()  != buf2.intensity_scale())
+        return false;
+      if (Stride::get (buf1) != Stride::get (buf2))
+        return false;
+      if (io1->nsegments() != io2->nsegments() ||
+          io1->segment_size() != io2->segment_size())
+        return false;
+      const int64_t bytes = footprint (int64_t (io1->segment_size()), buf1.datatype());
+      for (size_t n = 0; n != io1->nsegments(); ++n)
+        if (memcmp (io1->segment (n), io2->segment (n), bytes))
+          return false;
+      return true;
+    }
+
+  //! \endcond
+
+
    //! check image headers are the same (dimensions, spacing & transform)
   template <class HeaderType1, class HeaderType2>
     inline void check_headers (HeaderType1& in1, HeaderType2& in2)
@@ -43,16 +92,31 @@ namespace MR
 
 
   //! check images are the same within a absolute tolerance
+  /*! comparison runs multi-threaded; once any thread encounters a mismatch,
+   * the first offending voxel is recorded and all threads skip the remainder
+   * of their work. */
   template <class ImageType1, class ImageType2>
     inline void check_images_abs (ImageType1& in1, ImageType2& in2, const double tol = 0.0)
     {
       check_headers (in1, in2);
+      if (__image_buffers_identical (in1, in2))
+        return;
+      std::atomic<bool> failed (false);
+      std::mutex mutex;
+      std::string message;
       ThreadedLoop (in1)
-      .run ([&tol] (const ImageType1& a, const ImageType2& b) {
-          if (std::abs (cdouble (a.value()) - cdouble (b.value())) > tol)
-            throw Exception ("images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within absolute precision of " + str(tol)
-                 + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ")");
+      .run ([&] (const ImageType1& a, const ImageType2& b) {
+          if (failed.load (std::memory_order_relaxed))
+            return;
+          if (std::abs (cdouble (a.value()) - cdouble (b.value())) > tol) {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (!failed.exchange (true))
+              message = "images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within absolute precision of " + str(tol)
+                 + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ")";
+          }
           }, in1, in2);
+      if (failed)
+        throw Exception (message);
     }
 
 
@@ -61,12 +125,24 @@ namespace MR
     inline void check_images_frac (ImageType1& in1, ImageType2& in2, const double tol = 0.0) {
 
       check_headers (in1, in2);
+      if (__image_buffers_identical (in1, in2))
+        return;
+      std::atomic<bool> failed (false);
+      std::mutex mutex;
+      std::string message;
       ThreadedLoop (in1)
-      .run ([&tol] (const ImageType1& a, const ImageType2& b) {
-          if (std::abs ((cdouble (a.value()) - cdouble (b.value())) / (0.5 * (cdouble (a.value()) + cdouble (b.value())))) > tol)
-          throw Exception ("images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within fractional precision of " + str(tol)
-               + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ")");
+      .run ([&] (const ImageType1& a, const ImageType2& b) {
+          if (failed.load (std::memory_order_relaxed))
+            return;
+          if (std::abs ((cdouble (a.value()) - cdouble (b.value())) / (0.5 * (cdouble (a.value()) + cdouble (b.value())))) > tol) {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (!failed.exchange (true))
+              message = "images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within fractional precision of " + str(tol)
+               + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ")";
+          }
           }, in1, in2);
+      if (failed)
+        throw Exception (message);
     }
 
   //! check images are the same within a tolerance defined by a third image
@@ -75,19 +151,38 @@ namespace MR
 
       check_headers (in1, in2);
       check_headers (in1, tol);
+      if (__image_buffers_identical (in1, in2))
+        return;
+      std::atomic<bool> failed (false);
+      std::mutex mutex;
+      std::string message;
       ThreadedLoop (in1)
-      .run ([] (const ImageType1& a, const ImageType2& b, const ImageTypeTol& t) {
-          if (std::abs (cdouble (a.value()) - cdouble (b.value())) > t.value())
-          throw Exception ("images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within precision of \"" + t.name() + "\""
-               + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ", tolerance " + str(t.value()) + ")");
+      .run ([&] (const ImageType1& a, const ImageType2& b, const ImageTypeTol& t) {
+          if (failed.load (std::memory_order_relaxed))
+            return;
+          if (std::abs (cdouble (a.value()) - cdouble (b.value())) > t.value()) {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (!failed.exchange (true))
+              message = "images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within precision of \"" + t.name() + "\""
+               + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ", tolerance " + str(t.value()) + ")";
+          }
           }, in1, in2, tol);
+      if (failed)
+        throw Exception (message);
     }
 
   //! check images are the same within a fractional tolerance relative to the maximum value in the voxel
   template <class ImageType1, class ImageType2>
     inline void check_images_voxel (ImageType1& in1, ImageType2& in2, const double tol = 0.0)
     {
-      auto func = [&tol] (decltype(in1)& a, decltype(in2)& b) {
+      if (__image_buffers_identical (in1, in2))
+        return;
+      std::atomic<bool> failed (false);
+      std::mutex mutex;
+      std::string message;
+      auto func = [&] (decltype(in1)& a, decltype(in2)& b) {
+        if (failed.load (std::memory_order_relaxed))
+          return;
         double maxa = 0.0, maxb = 0.0;
         for (auto l = Loop(3) (a, b); l; ++l) {
           maxa = std::max (maxa, std::abs (cdouble(a.value())));
@@ -95,13 +190,19 @@ namespace MR
         }
         const double threshold = tol * 0.5 * (maxa + maxb);
         for (auto l = Loop(3) (a, b); l; ++l) {
-          if (std::abs (cdouble (a.value()) - cdouble (b.value())) > threshold)
-            throw Exception ("images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within " + str(tol) + " of maximal voxel value"
-                           + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ")");
+          if (std::abs (cdouble (a.value()) - cdouble (b.value())) > threshold) {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (!failed.exchange (true))
+              message = "images \"" + a.name() + "\" and \"" + b.name() + "\" do not match within " + str(tol) + " of maximal voxel value"
+                           + " (" + str(cdouble (a.value())) + " vs " + str(cdouble (b.value())) + ")";
+            return;
+          }
         }
       };
 
       ThreadedLoop (in1, 0, 3).run (func, in1, in2);
+      if (failed)
+        throw Exception (message);
     }
 
     //! check image headers are the same (dimensions, spacing & transform)
@@ -123,10 +224,17 @@ namespace MR
      inline bool images_match_abs (ImageType1& in1, ImageType2& in2, const double tol = 0.0)
      {
        headers_match (in1, in2);
-       for (auto i = Loop (in1)(in1, in2); i; ++i)
-         if (std::abs (cdouble (in1.value()) - cdouble (in2.value())) > tol)
-           return false;
-       return true;
+       if (__image_buffers_identical (in1, in2))
+         return true;
+       std::atomic<bool> mismatch (false);
+       ThreadedLoop (in1)
+       .run ([&] (const ImageType1& a, const ImageType2& b) {
+           if (mismatch.load (std::memory_order_relaxed))
+             return;
+           if (std::abs (cdouble (a.value()) - cdouble (b.value())) > tol)
+             mismatch.store (true, std::memory_order_relaxed);
+           }, in1, in2);
+       return !mismatch;
      }
 
 
@@ -141,4 +249,3 @@ namespace MR
 
 
 
-
@@ -14,6 +14,7 @@
 
 #include "image_io/base.h"
 #include "header.h"
+#include "profile.h"
 
 namespace MR
 {
@@ -32,11 +33,16 @@ namespace MR
 
     bool Base::is_file_backed () const { return true; }
 
+    void Base::restrict_writeback () { }
+
+    void Base::mark_modified (int64_t, int64_t) { }
+
     void Base::open (const Header& header, size_t buffer_size)
     {
       if (addresses.size())
         return;
 
+      PROFILE ("image load");
       load (header, buffer_size);
       DEBUG ("image \"" + header.name() + "\" loaded");
     }
@@ -48,6 +54,7 @@ namespace MR
       if (addresses.empty())
         return;
 
+      PROFILE ("image write-back");
       unload (header);
       DEBUG ("image \"" + header.name() + "\" unloaded");
       addresses.clear();
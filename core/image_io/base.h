@@ -60,6 +60,19 @@ namespace MR
         bool is_image_new () const { return is_new; }
         bool is_image_readwrite () const { return writable; }
 
+        //! restrict write-back to regions declared via mark_modified()
+        /*! a caller performing sparse edits on a read-write image can invoke
+         * this method, and subsequently declare each modified byte range, so
+         * that handlers relying on a write-back buffer (rather than a
+         * genuine memory-mapping) no longer rewrite untouched data at close.
+         * The default implementation is a no-op: handlers that do not
+         * support partial write-back simply continue to write everything. */
+        virtual void restrict_writeback ();
+        //! declare the byte range [offset, offset+length) as modified
+        /*! see restrict_writeback(); offsets are relative to the start of
+         * the image data, in bytes. */
+        virtual void mark_modified (int64_t offset, int64_t length);
+
         void set_readwrite (bool readwrite) {
           writable = readwrite;
         }
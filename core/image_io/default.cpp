@@ -13,9 +13,11 @@
 
 
 #include <limits>
+#include <mutex>
 
 #include "app.h"
 #include "header.h"
+#include "thread_queue.h"
 #include "file/ofstream.h"
 #include "image_io/default.h"
 
@@ -24,6 +26,64 @@ namespace MR
   namespace ImageIO
   {
 
+    namespace {
+
+      // Write-back of a memory-backed image: this path is only taken when
+      //   the image comprises more files than can be memory-mapped
+      //   simultaneously, in which case each file can be written
+      //   independently; distribute them across threads rather than
+      //   flushing one file at a time
+      class WriteBackSource { NOMEMALIGN
+        public:
+          WriteBackSource (const size_t count) :
+              index (0),
+              count (count) { }
+          bool operator() (size_t& n) {
+            n = index++;
+            return n < count;
+          }
+        private:
+          size_t index;
+          const size_t count;
+      };
+
+      class WriteBackSink { NOMEMALIGN
+        public:
+          WriteBackSink (const vector<File::Entry>& files, const uint8_t* buffer, const int64_t bytes_per_segment, std::string& error) :
+              files (files),
+              buffer (buffer),
+              bytes_per_segment (bytes_per_segment),
+              error (error) { }
+
+          bool operator() (const size_t& n) {
+            try {
+              File::OFStream out (files[n].name, std::ios::out | std::ios::binary);
+              out.seekp (files[n].start, out.beg);
+              out.write ((char*) (buffer + n*bytes_per_segment), bytes_per_segment);
+              if (!out.good())
+                throw Exception ("error writing back contents of file \"" + files[n].name + "\": " + strerror(errno));
+            } catch (Exception& e) {
+              // defer to the calling thread; only the first error is reported
+              std::lock_guard<std::mutex> lock (mutex);
+              if (error.empty())
+                error = e[e.num()-1];
+            }
+            return true;
+          }
+
+        private:
+          const vector<File::Entry>& files;
+          const uint8_t* buffer;
+          const int64_t bytes_per_segment;
+          std::string& error;
+
+          static std::mutex mutex;
+      };
+      std::mutex WriteBackSink::mutex;
+
+    }
+
+
     void Default::load (const Header& header, size_t)
     {
       if (files.empty())
@@ -50,18 +110,77 @@ namespace MR
 
 
 
+    void Default::restrict_writeback ()
+    {
+      if (!writable)
+        return;
+      writeback_restricted = true;
+      dirty_from = files.size() * bytes_per_segment;
+      dirty_to = 0;
+      for (auto& m : mmaps)
+        m->restrict_writeback();
+    }
+
+
+
+
+    void Default::mark_modified (int64_t offset, int64_t length)
+    {
+      if (!writeback_restricted)
+        return;
+      dirty_from = std::min (dirty_from, offset);
+      dirty_to = std::max (dirty_to, offset + length);
+      if (mmaps.size()) {
+        // forward to each mapping the portion of the range it covers
+        const size_t first = offset / bytes_per_segment;
+        const size_t last = (offset + length - 1) / bytes_per_segment;
+        for (size_t n = first; n <= last && n < mmaps.size(); ++n) {
+          const int64_t from = std::max (offset - int64_t(n)*bytes_per_segment, int64_t(0));
+          const int64_t to = std::min (offset + length - int64_t(n)*bytes_per_segment, bytes_per_segment);
+          mmaps[n]->mark_modified (from, to - from);
+        }
+      }
+    }
+
+
+
+
     void Default::unload (const Header& header)
     {
       if (mmaps.empty() && addresses.size()) {
         assert (addresses[0].get());
 
-        if (writable) {
-          for (size_t n = 0; n < files.size(); n++) {
-            File::OFStream out (files[n].name, std::ios::out | std::ios::binary);
-            out.seekp (files[n].start, out.beg);
-            out.write ((char*) (addresses[0].get() + n*bytes_per_segment), bytes_per_segment);
+        if (writable && writeback_restricted) {
+          // sparse edits: rewrite only the span of declared modifications,
+          //   within whichever files it intersects
+          if (dirty_to > dirty_from) {
+            for (size_t n = 0; n < files.size(); ++n) {
+              const int64_t from = std::max (dirty_from - int64_t(n)*bytes_per_segment, int64_t(0));
+              const int64_t to = std::min (dirty_to - int64_t(n)*bytes_per_segment, bytes_per_segment);
+              if (to <= from)
+                continue;
+              File::OFStream out (files[n].name, std::ios::in | std::ios::out | std::ios::binary);
+              out.seekp (files[n].start + from, out.beg);
+              out.write ((char*) (addresses[0].get() + n*bytes_per_segment + from), to - from);
+              if (!out.good())
+                throw Exception ("error writing back contents of file \"" + files[n].name + "\": " + strerror(errno));
+            }
+          }
+        }
+        else if (writable) {
+          if (files.size() > 1) {
+            std::string error;
+            WriteBackSource source (files.size());
+            WriteBackSink sink (files, addresses[0].get(), bytes_per_segment, error);
+            Thread::run_queue (source, size_t(), Thread::multi (sink));
+            if (error.size())
+              throw Exception (error);
+          } else {
+            File::OFStream out (files[0].name, std::ios::out | std::ios::binary);
+            out.seekp (files[0].start, out.beg);
+            out.write ((char*) (addresses[0].get()), bytes_per_segment);
             if (!out.good())
-              throw Exception ("error writing back contents of file \"" + files[n].name + "\": " + strerror(errno));
+              throw Exception ("error writing back contents of file \"" + files[0].name + "\": " + strerror(errno));
           }
         }
       }
@@ -80,6 +199,10 @@ namespace MR
       addresses.resize (mmaps.size());
       for (size_t n = 0; n < files.size(); n++) {
         mmaps[n].reset (new File::MMap (files[n], writable, !is_new, bytes_per_segment));
+        // image data are predominantly traversed in storage order, so ask
+        //   for an enlarged readahead window; this is a considerable gain on
+        //   the first pass over a cold file on high-latency storage
+        mmaps[n]->advise (File::MMap::Advice::Sequential);
         addresses[n].reset (mmaps[n]->address());
       }
     }
@@ -100,6 +223,10 @@ namespace MR
       else {
         for (size_t n = 0; n < files.size(); n++) {
           File::MMap file (files[n], false, false, bytes_per_segment);
+          // the copy reads each file front to back exactly once; prefetch
+          //   the whole mapping asynchronously before walking it
+          file.advise (File::MMap::Advice::Sequential);
+          file.advise (File::MMap::Advice::WillNeed);
           memcpy (addresses[0].get() + n*bytes_per_segment, file.address(), bytes_per_segment);
         }
       }
@@ -27,15 +27,23 @@ namespace MR
     class Default : public Base
     { NOMEMALIGN
       public:
-        Default (const Header& header) : 
+        Default (const Header& header) :
           Base (header),
-          bytes_per_segment (0) { }
+          bytes_per_segment (0),
+          writeback_restricted (false),
+          dirty_from (0),
+          dirty_to (0) { }
         Default (Default&&) noexcept = default;
         Default& operator=(Default&&) = default;
 
+        virtual void restrict_writeback ();
+        virtual void mark_modified (int64_t offset, int64_t length);
+
       protected:
         vector<std::shared_ptr<File::MMap> > mmaps;
         int64_t bytes_per_segment;
+        bool writeback_restricted;
+        int64_t dirty_from, dirty_to;
 
         virtual void load (const Header&, size_t);
         virtual void unload (const Header&);
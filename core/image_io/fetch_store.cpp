@@ -127,12 +127,54 @@ namespace MR
         return round_func<RAMType> (scale_from_storage (Raw::fetch_BE<DiskType> (data, i), offset, scale));
       }
 
-    template <typename RAMType, typename DiskType> 
+    template <typename RAMType, typename DiskType>
       void __store_BE (RAMType val, void* data, size_t i, default_type offset, default_type scale) {
         return Raw::store_BE<DiskType> (round_func<DiskType> (scale_to_storage (val, offset, scale)), data, i);
       }
 
 
+
+    // batched versions of the above: the scalar fetch/store calls are fully
+    // inlined into tight loops over consecutive values, which the compiler
+    // can vectorise (the per-value std::function dispatch is hoisted out):
+
+    template <typename RAMType, typename DiskType>
+      void __fetch_scanline (RAMType* dest, const void* data, size_t i, size_t count, default_type offset, default_type scale) {
+        for (size_t n = 0; n < count; ++n)
+          dest[n] = __fetch<RAMType,DiskType> (data, i+n, offset, scale);
+      }
+
+    template <typename RAMType, typename DiskType>
+      void __store_scanline (const RAMType* src, void* data, size_t i, size_t count, default_type offset, default_type scale) {
+        for (size_t n = 0; n < count; ++n)
+          __store<RAMType,DiskType> (src[n], data, i+n, offset, scale);
+      }
+
+    template <typename RAMType, typename DiskType>
+      void __fetch_scanline_LE (RAMType* dest, const void* data, size_t i, size_t count, default_type offset, default_type scale) {
+        for (size_t n = 0; n < count; ++n)
+          dest[n] = __fetch_LE<RAMType,DiskType> (data, i+n, offset, scale);
+      }
+
+    template <typename RAMType, typename DiskType>
+      void __store_scanline_LE (const RAMType* src, void* data, size_t i, size_t count, default_type offset, default_type scale) {
+        for (size_t n = 0; n < count; ++n)
+          __store_LE<RAMType,DiskType> (src[n], data, i+n, offset, scale);
+      }
+
+    template <typename RAMType, typename DiskType>
+      void __fetch_scanline_BE (RAMType* dest, const void* data, size_t i, size_t count, default_type offset, default_type scale) {
+        for (size_t n = 0; n < count; ++n)
+          dest[n] = __fetch_BE<RAMType,DiskType> (data, i+n, offset, scale);
+      }
+
+    template <typename RAMType, typename DiskType>
+      void __store_scanline_BE (const RAMType* src, void* data, size_t i, size_t count, default_type offset, default_type scale) {
+        for (size_t n = 0; n < count; ++n)
+          __store_BE<RAMType,DiskType> (src[n], data, i+n, offset, scale);
+      }
+
+
   }
 
 
@@ -243,6 +285,113 @@ namespace MR
       }
     }
 
+
+
+
+  template <typename ValueType>
+    typename std::enable_if<is_data_type<ValueType>::value, void>::type __set_fetch_store_scanline_functions (
+        std::function<void(ValueType*,const void*,size_t,size_t,default_type,default_type)>& fetch_func,
+        std::function<void(const ValueType*,void*,size_t,size_t,default_type,default_type)>& store_func,
+        DataType datatype) {
+
+      switch (datatype()) {
+        case DataType::Bit:
+          fetch_func = __fetch_scanline<ValueType,bool>;
+          store_func = __store_scanline<ValueType,bool>;
+          return;
+        case DataType::Int8:
+          fetch_func = __fetch_scanline<ValueType,int8_t>;
+          store_func = __store_scanline<ValueType,int8_t>;
+          return;
+        case DataType::UInt8:
+          fetch_func = __fetch_scanline<ValueType,uint8_t>;
+          store_func = __store_scanline<ValueType,uint8_t>;
+          return;
+        case DataType::Int16LE:
+          fetch_func = __fetch_scanline_LE<ValueType,int16_t>;
+          store_func = __store_scanline_LE<ValueType,int16_t>;
+          return;
+        case DataType::UInt16LE:
+          fetch_func = __fetch_scanline_LE<ValueType,uint16_t>;
+          store_func = __store_scanline_LE<ValueType,uint16_t>;
+          return;
+        case DataType::Int16BE:
+          fetch_func = __fetch_scanline_BE<ValueType,int16_t>;
+          store_func = __store_scanline_BE<ValueType,int16_t>;
+          return;
+        case DataType::UInt16BE:
+          fetch_func = __fetch_scanline_BE<ValueType,uint16_t>;
+          store_func = __store_scanline_BE<ValueType,uint16_t>;
+          return;
+        case DataType::Int32LE:
+          fetch_func = __fetch_scanline_LE<ValueType,int32_t>;
+          store_func = __store_scanline_LE<ValueType,int32_t>;
+          return;
+        case DataType::UInt32LE:
+          fetch_func = __fetch_scanline_LE<ValueType,uint32_t>;
+          store_func = __store_scanline_LE<ValueType,uint32_t>;
+          return;
+        case DataType::Int32BE:
+          fetch_func = __fetch_scanline_BE<ValueType,int32_t>;
+          store_func = __store_scanline_BE<ValueType,int32_t>;
+          return;
+        case DataType::UInt32BE:
+          fetch_func = __fetch_scanline_BE<ValueType,uint32_t>;
+          store_func = __store_scanline_BE<ValueType,uint32_t>;
+          return;
+        case DataType::Int64LE:
+          fetch_func = __fetch_scanline_LE<ValueType,int64_t>;
+          store_func = __store_scanline_LE<ValueType,int64_t>;
+          return;
+        case DataType::UInt64LE:
+          fetch_func = __fetch_scanline_LE<ValueType,uint64_t>;
+          store_func = __store_scanline_LE<ValueType,uint64_t>;
+          return;
+        case DataType::Int64BE:
+          fetch_func = __fetch_scanline_BE<ValueType,int64_t>;
+          store_func = __store_scanline_BE<ValueType,int64_t>;
+          return;
+        case DataType::UInt64BE:
+          fetch_func = __fetch_scanline_BE<ValueType,uint64_t>;
+          store_func = __store_scanline_BE<ValueType,uint64_t>;
+          return;
+        case DataType::Float32LE:
+          fetch_func = __fetch_scanline_LE<ValueType,float>;
+          store_func = __store_scanline_LE<ValueType,float>;
+          return;
+        case DataType::Float32BE:
+          fetch_func = __fetch_scanline_BE<ValueType,float>;
+          store_func = __store_scanline_BE<ValueType,float>;
+          return;
+        case DataType::Float64LE:
+          fetch_func = __fetch_scanline_LE<ValueType,double>;
+          store_func = __store_scanline_LE<ValueType,double>;
+          return;
+        case DataType::Float64BE:
+          fetch_func = __fetch_scanline_BE<ValueType,double>;
+          store_func = __store_scanline_BE<ValueType,double>;
+          return;
+        case DataType::CFloat32LE:
+          fetch_func = __fetch_scanline_LE<ValueType,cfloat>;
+          store_func = __store_scanline_LE<ValueType,cfloat>;
+          return;
+        case DataType::CFloat32BE:
+          fetch_func = __fetch_scanline_BE<ValueType,cfloat>;
+          store_func = __store_scanline_BE<ValueType,cfloat>;
+          return;
+        case DataType::CFloat64LE:
+          fetch_func = __fetch_scanline_LE<ValueType,cdouble>;
+          store_func = __store_scanline_LE<ValueType,cdouble>;
+          return;
+        case DataType::CFloat64BE:
+          fetch_func = __fetch_scanline_BE<ValueType,cdouble>;
+          store_func = __store_scanline_BE<ValueType,cdouble>;
+          return;
+        default:
+          throw Exception ("invalid data type in image header");
+      }
+    }
+
 #undef MRTRIX_EXTERN
 #define MRTRIX_EXTERN
   __DEFINE_FETCH_STORE_FUNCTIONS;
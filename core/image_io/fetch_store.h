@@ -25,7 +25,7 @@ namespace MR
   template <typename ValueType>
     typename std::enable_if<!is_data_type<ValueType>::value, void>::type __set_fetch_store_functions (
         std::function<ValueType(const void*,size_t,default_type,default_type)>& /*fetch_func*/,
-        std::function<void(ValueType,void*,size_t,default_type,default_type)>& /*store_func*/, 
+        std::function<void(ValueType,void*,size_t,default_type,default_type)>& /*store_func*/,
         DataType /*datatype*/) { }
 
 
@@ -33,17 +33,44 @@ namespace MR
   template <typename ValueType>
     typename std::enable_if<is_data_type<ValueType>::value, void>::type __set_fetch_store_functions (
         std::function<ValueType(const void*,size_t,default_type,default_type)>& fetch_func,
-        std::function<void(ValueType,void*,size_t,default_type,default_type)>& store_func, 
+        std::function<void(ValueType,void*,size_t,default_type,default_type)>& store_func,
         DataType datatype);
 
 
-  // define fetch/store methods for all types using C++11 extern templates, 
+
+  /* batched equivalents of the above: each call converts \a count
+   * consecutive (in storage order) values starting at index \a i, via a
+   * tight per-datatype loop (including byte-swapping & int/float widening)
+   * that the compiler can vectorise - rather than one std::function
+   * indirection per value. The functions are selected once per buffer, from
+   * the same datatype switch as the scalar versions. */
+
+  template <typename ValueType>
+    typename std::enable_if<!is_data_type<ValueType>::value, void>::type __set_fetch_store_scanline_functions (
+        std::function<void(ValueType*,const void*,size_t,size_t,default_type,default_type)>& /*fetch_func*/,
+        std::function<void(const ValueType*,void*,size_t,size_t,default_type,default_type)>& /*store_func*/,
+        DataType /*datatype*/) { }
+
+
+
+  template <typename ValueType>
+    typename std::enable_if<is_data_type<ValueType>::value, void>::type __set_fetch_store_scanline_functions (
+        std::function<void(ValueType*,const void*,size_t,size_t,default_type,default_type)>& fetch_func,
+        std::function<void(const ValueType*,void*,size_t,size_t,default_type,default_type)>& store_func,
+        DataType datatype);
+
+
+  // define fetch/store methods for all types using C++11 extern templates,
   // to avoid massive recompile times...
 #define __DEFINE_FETCH_STORE_FUNCTION_FOR_TYPE(ValueType) \
   MRTRIX_EXTERN template void __set_fetch_store_functions<ValueType> ( \
       std::function<ValueType(const void*,size_t,default_type,default_type)>& fetch_func, \
         std::function<void(ValueType,void*,size_t,default_type,default_type)>& store_func, \
-        DataType datatype) 
+        DataType datatype); \
+  MRTRIX_EXTERN template void __set_fetch_store_scanline_functions<ValueType> ( \
+      std::function<void(ValueType*,const void*,size_t,size_t,default_type,default_type)>& fetch_func, \
+        std::function<void(const ValueType*,void*,size_t,size_t,default_type,default_type)>& store_func, \
+        DataType datatype)
 
 #define __DEFINE_FETCH_STORE_FUNCTIONS \
   __DEFINE_FETCH_STORE_FUNCTION_FOR_TYPE(bool); \
@@ -12,6 +12,8 @@
  */
 
 
+#include <cerrno>
+#include <fstream>
 #include <limits>
 
 #include "app.h"
@@ -19,6 +21,8 @@
 #include "header.h"
 #include "image_io/gz.h"
 #include "file/gz.h"
+#include "file/gz_parallel.h"
+#include "file/inflate_cache.h"
 
 #define BYTES_PER_ZCALL 524288
 
@@ -49,9 +53,21 @@ namespace MR
         ProgressBar progress ("uncompressing image \"" + header.name() + "\"",
             files.size() * bytes_per_segment / BYTES_PER_ZCALL);
         for (size_t n = 0; n < files.size(); n++) {
+          uint8_t* address = addresses[0].get() + n*bytes_per_segment;
+
+          // if the decompression cache is enabled, a previous read of the
+          // same compressed content may already be stored on disk:
+          std::string cache_entry;
+          if (File::InflateCache::enabled()) {
+            cache_entry = File::InflateCache::name_for (files[n].name, files[n].start, bytes_per_segment);
+            if (cache_entry.size() && File::InflateCache::fetch (cache_entry, address, bytes_per_segment)) {
+              progress += bytes_per_segment / BYTES_PER_ZCALL;
+              continue;
+            }
+          }
+
           File::GZ zf (files[n].name, "rb");
           zf.seek (files[n].start);
-          uint8_t* address = addresses[0].get() + n*bytes_per_segment;
           uint8_t* last = address + bytes_per_segment - BYTES_PER_ZCALL;
           while (address < last) {
             zf.read (reinterpret_cast<char*> (address), BYTES_PER_ZCALL);
@@ -60,6 +76,9 @@ namespace MR
           }
           last += BYTES_PER_ZCALL;
           zf.read (reinterpret_cast<char*> (address), last - address);
+
+          if (cache_entry.size())
+            File::InflateCache::store (cache_entry, addresses[0].get() + n*bytes_per_segment, bytes_per_segment);
         }
       }
 
@@ -79,24 +98,23 @@ namespace MR
         assert (addresses[0]);
 
         if (writable) {
+          // compression is distributed across threads, with each block
+          // deflated as an independent gzip member (see file/gz_parallel.h):
           ProgressBar progress ("compressing image \"" + header.name() + "\"",
-              files.size() * bytes_per_segment / BYTES_PER_ZCALL);
+              files.size() * File::GZParallel::num_blocks (bytes_per_segment));
           for (size_t n = 0; n < files.size(); n++) {
             assert (files[n].start == int64_t (lead_in_size));
-            File::GZ zf (files[n].name, "wb");
+            std::ofstream out (files[n].name, std::ios::binary | std::ios::trunc);
+            if (!out)
+              throw Exception ("error opening file \"" + files[n].name + "\": " + strerror (errno));
             if (lead_in)
-              zf.write (reinterpret_cast<const char*> (lead_in.get()), lead_in_size);
-            uint8_t* address = addresses[0].get() + n*bytes_per_segment;
-            uint8_t* last = address + bytes_per_segment - BYTES_PER_ZCALL;
-            while (address < last) {
-              zf.write (reinterpret_cast<const char*> (address), BYTES_PER_ZCALL);
-              address += BYTES_PER_ZCALL;
-              ++progress;
-            }
-            last += BYTES_PER_ZCALL;
-            zf.write (reinterpret_cast<const char*> (address), last - address);
+              File::GZParallel::deflate (out, lead_in.get(), lead_in_size);
+            File::GZParallel::deflate (out, addresses[0].get() + n*bytes_per_segment, bytes_per_segment, &progress);
             if (lead_out)
-              zf.write (reinterpret_cast<const char*> (lead_out.get()), lead_out_size);
+              File::GZParallel::deflate (out, lead_out.get(), lead_out_size);
+            out.close();
+            if (!out.good())
+              throw Exception ("error writing to file \"" + files[n].name + "\": " + strerror (errno));
           }
         }
 
@@ -0,0 +1,131 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "progressbar.h"
+#include "header.h"
+#include "raw.h"
+#include "image_io/mask.h"
+#include "file/mmap.h"
+#include "file/utils.h"
+
+namespace MR
+{
+  namespace ImageIO
+  {
+
+    void Mask::load (const Header& header, size_t)
+    {
+      assert (files.size() == 1);
+      assert (header.datatype() == DataType::Bit);
+
+      bytes_per_segment = (segsize + 7) / 8;
+      DEBUG ("loading mask image \"" + header.name() + "\"...");
+      addresses.resize (1);
+      addresses[0].reset (new uint8_t [bytes_per_segment]);
+      if (!addresses[0])
+        throw Exception ("failed to allocate memory for image \"" + header.name() + "\"");
+      memset (addresses[0].get(), 0, bytes_per_segment);
+
+      if (is_new)
+        return;
+
+      File::MMap mmap (files[0]);
+      const uint8_t* data = mmap.address();
+      const size_t num_runs = mmap.size() / sizeof (uint32_t);
+
+      size_t voxel = 0;
+      bool value = false;
+      for (size_t run = 0; run != num_runs; ++run, value = !value) {
+        const uint32_t length = Raw::fetch_LE<uint32_t> (data, run);
+        if (voxel + length > size_t (segsize))
+          throw Exception ("run-length data of mask image \"" + header.name() + "\" exceeds image dimensions");
+        if (value) {
+          for (uint32_t n = 0; n != length; ++n)
+            Raw::store_native<bool> (true, addresses[0].get(), voxel+n);
+        }
+        voxel += length;
+      }
+      // any remaining voxels constitute an implicit trailing clear run
+    }
+
+
+
+    void Mask::unload (const Header& header)
+    {
+      if (addresses.empty())
+        return;
+      assert (addresses.size() == 1);
+
+      if (writable) {
+        DEBUG ("packing mask image \"" + header.name() + "\"...");
+        std::fstream out (files[0].name.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        if (!out)
+          throw Exception ("error opening mask image \"" + header.name() + "\" for writing: " + strerror (errno));
+        out.seekp (files[0].start, out.beg);
+
+        uint8_t buffer[sizeof (uint32_t)];
+        int64_t written = 0;
+        uint64_t length = 0;
+        bool value = false;
+        for (int64_t voxel = 0; voxel != segsize; ++voxel) {
+          if (Raw::fetch_native<bool> (addresses[0].get(), voxel) == value) {
+            ++length;
+            continue;
+          }
+          // runs longer than a uint32 are split by zero-length
+          // runs of the opposite value:
+          while (length > std::numeric_limits<uint32_t>::max()) {
+            Raw::store_LE<uint32_t> (std::numeric_limits<uint32_t>::max(), buffer);
+            out.write (reinterpret_cast<const char*> (buffer), sizeof (uint32_t));
+            Raw::store_LE<uint32_t> (0, buffer);
+            out.write (reinterpret_cast<const char*> (buffer), sizeof (uint32_t));
+            written += 2;
+            length -= std::numeric_limits<uint32_t>::max();
+          }
+          Raw::store_LE<uint32_t> (uint32_t (length), buffer);
+          out.write (reinterpret_cast<const char*> (buffer), sizeof (uint32_t));
+          ++written;
+          value = !value;
+          length = 1;
+        }
+        if (value && length) {
+          // no need to store a trailing clear run; the decoder infers it
+          // from the image dimensions
+          while (length > std::numeric_limits<uint32_t>::max()) {
+            Raw::store_LE<uint32_t> (std::numeric_limits<uint32_t>::max(), buffer);
+            out.write (reinterpret_cast<const char*> (buffer), sizeof (uint32_t));
+            Raw::store_LE<uint32_t> (0, buffer);
+            out.write (reinterpret_cast<const char*> (buffer), sizeof (uint32_t));
+            written += 2;
+            length -= std::numeric_limits<uint32_t>::max();
+          }
+          Raw::store_LE<uint32_t> (uint32_t (length), buffer);
+          out.write (reinterpret_cast<const char*> (buffer), sizeof (uint32_t));
+          ++written;
+        }
+        if (!out.good())
+          throw Exception ("error writing mask image \"" + header.name() + "\": " + strerror (errno));
+        out.close();
+        File::resize (files[0].name, files[0].start + written * sizeof (uint32_t));
+      }
+
+      addresses[0].reset();
+    }
+
+  }
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __image_io_mask_h__
+#define __image_io_mask_h__
+
+#include "image_io/base.h"
+
+namespace MR
+{
+
+  namespace ImageIO
+  {
+
+    /*! access to binary masks stored as run-length encoded bit data
+     *
+     * The on-disk data section is a sequence of little-endian uint32 run
+     * lengths over the voxel stream in storage order, alternating between
+     * clear and set runs and always starting with a clear run (of length
+     * zero if the first voxel is set); runs longer than 2^32-1 voxels are
+     * split by a zero-length run of the opposite value. On load, the runs
+     * are expanded into a bit-packed RAM buffer identical to that of a
+     * native Bit-datatype image, so all in-RAM access operates as for any
+     * other format; the buffer is re-encoded on unload if the image was
+     * opened read/write. Mostly-empty masks therefore occupy a few bytes
+     * on disk rather than a full volume. */
+    class Mask : public Base
+    { NOMEMALIGN
+      public:
+        Mask (Mask&&) = default;
+        Mask (const Header& header) :
+          Base (header) { }
+
+      protected:
+        int64_t bytes_per_segment;
+
+        virtual void load (const Header&, size_t);
+        virtual void unload (const Header&);
+    };
+
+  }
+}
+
+#endif
@@ -13,10 +13,12 @@
 
 
 #include <limits>
+#include <mutex>
 
 #include "app.h"
 #include "progressbar.h"
 #include "header.h"
+#include "thread.h"
 #include "image_io/mosaic.h"
 
 namespace MR
@@ -43,29 +45,76 @@ namespace MR
         throw Exception ("failed to allocate memory for image \"" + header.name() + "\"");
 
       ProgressBar progress ("reformatting DICOM mosaic images", slices*files.size());
-      uint8_t* data = addresses[0].get();
-      for (size_t n = 0; n < files.size(); n++) {
-        File::MMap file (files[n], false, false, m_xdim * m_ydim * header.datatype().bytes());
-        size_t nx = 0, ny = 0;
-        for (size_t z = 0; z < slices; z++) {
-          size_t ox = nx*xdim;
-          size_t oy = ny*ydim;
-          for (size_t y = 0; y < ydim; y++) {
-            memcpy (data, file.address() + header.datatype().bytes() * (ox + m_xdim* (y+oy)), xdim * header.datatype().bytes());
-            data += xdim * header.datatype().bytes();
+      uint8_t* const data = addresses[0].get();
+
+      if (files.size() > 1 && Thread::number_of_threads() > 0) {
+        // each mosaic file maps onto its own contiguous segment of the
+        // output buffer, so files can be re-arranged concurrently; the
+        // work counter and progress updates share one mutex:
+        struct Shared { NOMEMALIGN
+          size_t next;
+          const size_t num;
+          const size_t slices;
+          ProgressBar& progress;
+          std::mutex mutex;
+          FORCE_INLINE bool get (size_t& n) {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (next >= num)
+              return false;
+            n = next++;
+            progress += slices;
+            return true;
           }
-          nx++;
-          if (nx >= m_xdim / xdim) {
-            nx = 0;
-            ny++;
+        } shared = { 0, files.size(), slices, progress };
+
+        struct ReformatThread { NOMEMALIGN
+          Mosaic& parent;
+          const Header& header;
+          uint8_t* const data;
+          const size_t bytes_per_segment;
+          Shared& shared;
+          void execute () {
+            size_t n;
+            while (shared.get (n))
+              parent.reformat (header, parent.files[n], data + n * bytes_per_segment);
           }
-          ++progress;
+        } worker = { *this, header, data, bytes_per_segment, shared };
+
+        auto threads = Thread::run (Thread::multi (worker), "mosaic reformat");
+        threads.wait();
+      }
+      else {
+        for (size_t n = 0; n < files.size(); n++) {
+          reformat (header, files[n], data + n * bytes_per_segment);
+          progress += slices;
         }
       }
 
       segsize = std::numeric_limits<size_t>::max();
     }
 
+
+
+    void Mosaic::reformat (const Header& header, const File::Entry& entry, uint8_t* data)
+    {
+      File::MMap file (entry, false, false, m_xdim * m_ydim * header.datatype().bytes());
+      const size_t row_bytes = xdim * header.datatype().bytes();
+      size_t nx = 0, ny = 0;
+      for (size_t z = 0; z < slices; z++) {
+        size_t ox = nx*xdim;
+        size_t oy = ny*ydim;
+        for (size_t y = 0; y < ydim; y++) {
+          memcpy (data, file.address() + header.datatype().bytes() * (ox + m_xdim* (y+oy)), row_bytes);
+          data += row_bytes;
+        }
+        nx++;
+        if (nx >= m_xdim / xdim) {
+          nx = 0;
+          ny++;
+        }
+      }
+    }
+
     void Mosaic::unload (const Header& header) { }
 
   }
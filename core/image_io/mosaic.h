@@ -37,6 +37,9 @@ namespace MR
 
         virtual void load (const Header&, size_t);
         virtual void unload (const Header&);
+
+        //! re-arrange the tiles of one mosaic file into \a data
+        void reformat (const Header& header, const File::Entry& entry, uint8_t* data);
     };
 
   }
@@ -0,0 +1,260 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "progressbar.h"
+#include "stride.h"
+#include "image_helpers.h"
+#include "image_io/overview.h"
+#include "image_io/fetch_store.h"
+#include "file/mmap.h"
+#include "file/path.h"
+#include "file/entry.h"
+
+namespace MR
+{
+  namespace ImageIO
+  {
+
+    namespace
+    {
+
+      inline int64_t level_footprint (const Overview::Level& level, DataType datatype)
+      {
+        int64_t count = 1;
+        for (const auto& s : level.size)
+          count *= s;
+        return footprint (count, datatype);
+      }
+
+
+      inline bool increment (vector<ssize_t>& index, const vector<ssize_t>& size)
+      {
+        for (size_t axis = 0; axis < index.size(); ++axis) {
+          if (++index[axis] < size[axis])
+            return true;
+          index[axis] = 0;
+        }
+        return false;
+      }
+
+    }
+
+
+
+
+    vector<Overview::Level> Overview::levels (const Header& header, int64_t data_offset, size_t max_levels)
+    {
+      vector<Level> result;
+      if (header.ndim() < 3 ||
+          header.datatype() == DataType::Bit ||
+          header.datatype().is_complex())
+        return result;
+
+      vector<ssize_t> size (header.ndim());
+      for (size_t axis = 0; axis != header.ndim(); ++axis)
+        size[axis] = header.size (axis);
+
+      int64_t offset = data_offset + footprint (header);
+      size_t factor = 1;
+      for (size_t l = 0; l < max_levels; ++l) {
+        if (size[0] < 2 && size[1] < 2 && size[2] < 2)
+          break;
+        for (size_t axis = 0; axis != 3; ++axis)
+          size[axis] = (size[axis]+1) / 2;
+        factor *= 2;
+        Level level;
+        level.factor = factor;
+        level.offset = offset;
+        level.size = size;
+        result.push_back (level);
+        offset += level_footprint (level, header.datatype());
+      }
+
+      return result;
+    }
+
+
+
+
+    void Overview::unload (const Header& header)
+    {
+      const bool generate = writable && addresses.size();
+      Default::unload (header);
+      if (!generate || levels_.empty())
+        return;
+
+      assert (files.size() == 1);
+      DEBUG ("generating overview levels for image \"" + header.name() + "\"...");
+
+      std::function<default_type(const void*,size_t,default_type,default_type)> fetch;
+      std::function<void(default_type,void*,size_t,default_type,default_type)> store;
+      __set_fetch_store_functions<default_type> (fetch, store, header.datatype());
+
+      int64_t num_out = 0;
+      for (const auto& level : levels_) {
+        int64_t count = 1;
+        for (const auto& s : level.size)
+          count *= s;
+        num_out += count;
+      }
+      ProgressBar progress ("generating overview levels for image \"" + Path::basename (header.name()) + "\"", num_out);
+
+      // main data section, flushed to disk by Default::unload() above:
+      File::MMap mmap (files[0], false, false, footprint (header));
+      const void* src_data = mmap.address();
+      auto src_strides = Stride::get_actual (Stride::get (header), header);
+      int64_t src_start = Stride::offset (src_strides, header);
+      vector<ssize_t> src_size (header.ndim());
+      for (size_t axis = 0; axis != header.ndim(); ++axis)
+        src_size[axis] = header.size (axis);
+
+      std::fstream out (files[0].name.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+      if (!out)
+        throw Exception ("error opening image \"" + header.name() + "\" to write overview levels: " + strerror (errno));
+
+      vector<uint8_t> prev, cur;
+      for (const auto& level : levels_) {
+
+        vector<ssize_t> out_strides (level.size.size());
+        ssize_t stride = 1;
+        for (size_t axis = 0; axis != level.size.size(); ++axis) {
+          out_strides[axis] = stride;
+          stride *= level.size[axis];
+        }
+        cur.resize (level_footprint (level, header.datatype()));
+
+        // each level is produced by 2x mean pooling of the previous one:
+        vector<ssize_t> index (level.size.size(), 0);
+        do {
+          int64_t src_base = src_start;
+          int64_t out_offset = 0;
+          for (size_t axis = 3; axis < index.size(); ++axis)
+            src_base += index[axis] * src_strides[axis];
+          for (size_t axis = 0; axis != index.size(); ++axis)
+            out_offset += index[axis] * out_strides[axis];
+
+          default_type sum = 0.0;
+          size_t count = 0;
+          for (ssize_t z = 2*index[2]; z != std::min (2*index[2]+2, src_size[2]); ++z)
+            for (ssize_t y = 2*index[1]; y != std::min (2*index[1]+2, src_size[1]); ++y)
+              for (ssize_t x = 2*index[0]; x != std::min (2*index[0]+2, src_size[0]); ++x) {
+                sum += fetch (src_data, src_base + x*src_strides[0] + y*src_strides[1] + z*src_strides[2], 0.0, 1.0);
+                ++count;
+              }
+          store (sum / count, cur.data(), out_offset, 0.0, 1.0);
+          ++progress;
+        } while (increment (index, level.size));
+
+        out.seekp (level.offset, out.beg);
+        out.write (reinterpret_cast<const char*> (cur.data()), cur.size());
+        if (!out.good())
+          throw Exception ("error writing overview levels of image \"" + header.name() + "\": " + strerror (errno));
+
+        prev = std::move (cur);
+        src_data = prev.data();
+        src_strides = out_strides;
+        src_start = 0;
+        src_size = level.size;
+      }
+    }
+
+  }
+
+
+
+
+
+
+  size_t overview_levels (const Header& H)
+  {
+    if (!H.valid() || !H.is_file_backed())
+      return 0;
+    if (H.io->files.size() != 1)
+      return 0;
+    if (!Path::has_suffix (H.name(), ".mif"))
+      return 0;
+
+    const File::Entry& entry (H.io->files[0]);
+    std::ifstream in (entry.name.c_str(), std::ios::binary | std::ios::ate);
+    if (!in)
+      return 0;
+    const int64_t file_size = in.tellg();
+
+    if (file_size == entry.start + footprint (H))
+      return 0;
+
+    const auto levels = ImageIO::Overview::levels (H, entry.start, std::numeric_limits<size_t>::max());
+    for (size_t n = 0; n != levels.size(); ++n)
+      if (file_size == levels[n].offset + ImageIO::level_footprint (levels[n], H.datatype()))
+        return n+1;
+
+    return 0;
+  }
+
+
+
+
+  Header overview (const Header& H, size_t level)
+  {
+    const size_t num = overview_levels (H);
+    if (level < 1 || level > num)
+      throw Exception ("no overview level " + str(level) + " available for image \"" + H.name() + "\"");
+
+    const auto levels = ImageIO::Overview::levels (H, H.io->files[0].start, level);
+    const auto& L = levels[level-1];
+
+    Header out (H);
+    for (size_t axis = 0; axis != 3; ++axis) {
+      out.size (axis) = L.size[axis];
+      out.spacing (axis) *= L.factor;
+    }
+    // shift the transform to the centre of the pooled blocks:
+    for (size_t i = 0; i != 3; ++i)
+      for (size_t j = 0; j != 3; ++j)
+        out.transform()(i,3) += out.transform()(i,j) * H.spacing(j) * 0.5 * (L.factor-1);
+
+    vector<ssize_t> strides (out.ndim());
+    for (size_t axis = 0; axis != out.ndim(); ++axis)
+      strides[axis] = axis+1;
+    Stride::set (out, strides);
+
+    out.io.reset (new ImageIO::Default (out));
+    out.io->files.push_back (File::Entry (H.name(), L.offset));
+
+    return out;
+  }
+
+
+
+
+  size_t select_overview (const Header& H, ssize_t min_extent)
+  {
+    const size_t num = overview_levels (H);
+    if (!num)
+      return 0;
+    const auto levels = ImageIO::Overview::levels (H, H.io->files[0].start, num);
+    for (size_t n = num; n > 0; --n) {
+      const auto& size = levels[n-1].size;
+      if (std::max ({ size[0], size[1], size[2] }) >= min_extent)
+        return n;
+    }
+    return 0;
+  }
+
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __image_io_overview_h__
+#define __image_io_overview_h__
+
+#include "header.h"
+#include "image_io/default.h"
+
+namespace MR
+{
+  namespace ImageIO
+  {
+
+    /*! handler for single-file MRtrix images carrying embedded overview levels
+     *
+     * Overview levels are downsampled copies of the image data (2x, 4x, 8x
+     * along the first three axes, by mean pooling) appended after the main
+     * data section of a .mif file, each stored in the image datatype with
+     * contiguous axis-0-fastest layout. Their offsets and dimensions are
+     * fully determined by the main header, so no additional header fields
+     * are needed: readers detect the number of embedded levels by matching
+     * the file size against the cumulative level footprints, and readers
+     * unaware of the convention simply ignore the trailing bytes.
+     *
+     * This handler behaves as ImageIO::Default for the main data section,
+     * and (re)generates the overview levels from it on unload. */
+    class Overview : public Default
+    { NOMEMALIGN
+      public:
+        struct Level { NOMEMALIGN
+          size_t factor;          //!< downsampling factor along axes 0-2
+          int64_t offset;         //!< byte offset of the level within the file
+          vector<ssize_t> size;   //!< image dimensions of the level
+        };
+
+        Overview (const Header& header, const vector<Level>& levels) :
+          Default (header),
+          levels_ (levels) { }
+        Overview (Overview&&) noexcept = default;
+
+        //! the overview levels that would follow the main data section
+        /*! compute up to \a max_levels successive 2x levels for an image with
+         * the dimensions & datatype of \a header, with its main data section
+         * starting at byte offset \a data_offset. Returns an empty list if
+         * the image is not eligible (fewer than 3 axes, or bit or complex
+         * datatype). Levels are no longer produced once all three spatial
+         * extents have collapsed to a single voxel. */
+        static vector<Level> levels (const Header& header, int64_t data_offset, size_t max_levels);
+
+      protected:
+        vector<Level> levels_;
+
+        virtual void unload (const Header&);
+    };
+
+  }
+
+
+  //! the number of overview levels embedded in the file backing \a H
+  /*! returns zero if \a H is not a single-file .mif image, or if its file
+   * size does not match any valid number of embedded levels. */
+  size_t overview_levels (const Header& H);
+
+  //! a Header providing access to embedded overview level \a level of \a H
+  /*! \a level ranges from 1 (2x downsampled) to overview_levels(H). The
+   * returned header has its dimensions, voxel sizes & transform adjusted to
+   * match the level, and is ready for use with Header::get_image(). */
+  Header overview (const Header& H, size_t level);
+
+  //! select the coarsest overview level sufficient for \a min_extent
+  /*! returns the highest level whose largest spatial extent is no smaller
+   * than \a min_extent voxels, or zero (i.e. full resolution) if \a H
+   * contains no overview levels or none is sufficient. */
+  size_t select_overview (const Header& H, ssize_t min_extent);
+
+}
+
+#endif
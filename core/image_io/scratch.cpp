@@ -12,41 +12,134 @@
  */
 
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 
 #include "image_io/scratch.h"
 #include "header.h"
+#include "thread.h"
+#include "file/config.h"
+#include "file/entry.h"
+#include "file/utils.h"
+
+/* minimum buffer size (in bytes) for which zero-initialisation is
+   performed in parallel; smaller buffers are cleared with a single
+   memset, which is cheaper than launching threads */
+#define SCRATCH_PARALLEL_ZERO_THRESHOLD 67108864
+
+/* granularity of the chunks of buffer claimed by each zeroing thread */
+#define SCRATCH_ZERO_CHUNK_SIZE 16777216
 
 namespace MR
 {
   namespace ImageIO
   {
 
+    namespace {
+
+      // Zeroing the buffer in parallel both speeds up initialisation of
+      //   very large scratch buffers (a single memset is limited to the
+      //   memory bandwidth available to one core), and - since pages are
+      //   physically placed on the memory of the CPU that first touches
+      //   them - distributes the buffer across the memory of all
+      //   participating CPUs, rather than leaving the entire allocation
+      //   on the socket of the allocating thread
+      class ZeroFunctor { NOMEMALIGN
+        public:
+          ZeroFunctor (uint8_t* buffer, const size_t size, std::atomic<size_t>& next) :
+              buffer (buffer), size (size), next (next) { }
+          void execute () {
+            size_t from;
+            while ((from = next.fetch_add (size_t (SCRATCH_ZERO_CHUNK_SIZE))) < size)
+              memset (buffer + from, 0, std::min (size_t (SCRATCH_ZERO_CHUNK_SIZE), size - from));
+          }
+        private:
+          uint8_t* const buffer;
+          const size_t size;
+          std::atomic<size_t>& next;
+      };
+
+
+      // process-wide tally of RAM-resident scratch bytes:
+      std::atomic<int64_t> total_scratch_bytes (0);
+
+      int64_t memory_budget ()
+      {
+        //CONF option: MemoryBudget
+        //CONF default: 0 (unlimited)
+        //CONF The approximate amount of RAM (in megabytes) that scratch
+        //CONF buffers are collectively allowed to occupy. Once the tally of
+        //CONF live scratch allocations would exceed this budget, further
+        //CONF scratch buffers are backed by memory-mapped temporary files
+        //CONF (created in the directory specified by TmpFileDir), so that
+        //CONF the kernel can page their least-recently-touched contents out
+        //CONF under memory pressure, trading a gradual slowdown for
+        //CONF termination by the OOM killer.
+        static const int64_t budget = int64_t (File::Config::get_int ("MemoryBudget", 0)) * 1048576;
+        return budget;
+      }
+
+    }
+
+
     bool Scratch::is_file_backed () const { return false; }
 
     void Scratch::load (const Header& header, size_t buffer_size)
     {
       assert (buffer_size);
+
+      const int64_t budget = memory_budget();
+      if (budget > 0 && total_scratch_bytes.load() + int64_t (buffer_size) > budget) {
+        INFO ("memory budget reached - backing scratch buffer for image \"" + header.name()
+            + "\" with a memory-mapped temporary file");
+        try {
+          spill_name = File::create_tempfile (buffer_size);
+          spill.reset (new File::MMap (File::Entry (spill_name), true, false, buffer_size));
+          // a freshly extended file maps as zero-filled pages, so no
+          // explicit zero-initialisation is needed
+          addresses.push_back (std::unique_ptr<uint8_t[]> (spill->address()));
+        } catch (Exception& E) {
+          throw Exception (E, "error spilling scratch buffer for image \"" + header.name() + "\" to file");
+        }
+        return;
+      }
+
       DEBUG ("allocating scratch buffer for image \"" + header.name() + "\"...");
       try {
         addresses.push_back (std::unique_ptr<uint8_t[]> (new uint8_t [buffer_size]));
-        memset (addresses[0].get(), 0, buffer_size);
+        if (buffer_size >= SCRATCH_PARALLEL_ZERO_THRESHOLD && Thread::number_of_threads() > 1) {
+          std::atomic<size_t> next (0);
+          ZeroFunctor func (addresses[0].get(), buffer_size, next);
+          Thread::run (Thread::multi (func), "zero scratch buffer").wait();
+        }
+        else
+          memset (addresses[0].get(), 0, buffer_size);
       } catch (...) {
         throw Exception ("Error allocating memory for scratch buffer");
       }
+      allocated_bytes = buffer_size;
+      total_scratch_bytes.fetch_add (int64_t (allocated_bytes));
     }
 
 
     void Scratch::unload (const Header& header)
     {
       if (addresses.size()) {
-        DEBUG ("deleting scratch buffer for image \"" + header.name() + "\"...");
-        addresses[0].reset();
+        if (spill) {
+          DEBUG ("unmapping & deleting spilled scratch buffer for image \"" + header.name() + "\"...");
+          addresses[0].release();
+          spill.reset();
+          File::unlink (spill_name);
+        }
+        else {
+          DEBUG ("deleting scratch buffer for image \"" + header.name() + "\"...");
+          addresses[0].reset();
+          total_scratch_bytes.fetch_sub (int64_t (allocated_bytes));
+          allocated_bytes = 0;
+        }
       }
     }
 
   }
 }
-
-
-
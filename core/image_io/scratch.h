@@ -16,6 +16,7 @@
 #define __image_io_scratch_h__
 
 #include "image_io/base.h"
+#include "file/mmap.h"
 
 namespace MR
 {
@@ -26,11 +27,17 @@ namespace MR
     class Scratch : public Base
     { NOMEMALIGN
       public:
-        Scratch (const Header& header) : Base (header) { }
+        Scratch (const Header& header) : Base (header), allocated_bytes (0) { }
 
         virtual bool is_file_backed () const;
 
       protected:
+        //! number of RAM-resident bytes registered with the memory governor
+        size_t allocated_bytes;
+        //! set if the buffer was spilled to a memory-mapped temporary file
+        std::unique_ptr<File::MMap> spill;
+        std::string spill_name;
+
         virtual void load (const Header&, size_t);
         virtual void unload (const Header&);
     };
@@ -14,8 +14,11 @@
 
 #ifdef MRTRIX_TIFF_SUPPORT
 
+#include <atomic>
+
 #include "header.h"
 #include "image_helpers.h"
+#include "thread.h"
 #include "file/tiff.h"
 #include "image_io/tiff.h"
 
@@ -24,15 +27,14 @@ namespace MR
   namespace ImageIO
   {
 
-    void TIFF::load (const Header& header, size_t)
-    {
-      DEBUG ("allocating buffer for TIFF image \"" + header.name() + "\"...");
-      addresses.resize (1);
-      addresses[0].reset (new uint8_t [footprint (header)]);
-      uint8_t* data = addresses[0].get();
+    namespace {
 
-      for (auto& entry : files) {
-        File::TIFF tif (entry.name);
+      // decode one TIFF file (all of its directories) into the preload
+      // buffer, starting at the supplied address; returns the address one
+      // past the last byte written:
+      uint8_t* __decode_tiff (const Header& header, const std::string& filename, uint8_t* data)
+      {
+        File::TIFF tif (filename);
 
         uint16 config (0);
         tif.read_and_check (TIFFTAG_PLANARCONFIG, config);
@@ -57,8 +59,69 @@ namespace MR
           }
 
         } while (tif.read_directory() != 0);
+
+        return data;
+      }
+
+    }
+
+
+    void TIFF::load (const Header& header, size_t)
+    {
+      DEBUG ("allocating buffer for TIFF image \"" + header.name() + "\"...");
+      addresses.resize (1);
+      addresses[0].reset (new uint8_t [footprint (header)]);
+      uint8_t* data = addresses[0].get();
+
+      if (files.size() > 1 && Thread::number_of_threads() > 0) {
+        // multi-file stacks are decoded concurrently: libtiff handles are
+        // independent per file, and each file's extent within the preload
+        // buffer is established beforehand by a quick scan of its
+        // directory structure (header reads only - no pixel data)
+        vector<int64_t> offsets (files.size() + 1);
+        offsets[0] = 0;
+        for (size_t n = 0; n < files.size(); ++n) {
+          File::TIFF tif (files[n].name);
+          uint16 config (0);
+          tif.read_and_check (TIFFTAG_PLANARCONFIG, config);
+          int64_t bytes_per_directory = int64_t (tif.scanline_size()) * header.size(1);
+          if (header.ndim() > 3 && config == PLANARCONFIG_SEPARATE)
+            bytes_per_directory *= header.size(3);
+          int64_t num_directories = 1;
+          while (tif.read_directory() != 0)
+            ++num_directories;
+          offsets[n+1] = offsets[n] + num_directories * bytes_per_directory;
+        }
+
+        if (offsets.back() == int64_t (footprint (header))) {
+
+          struct DecodeThread { NOMEMALIGN
+            const Header& header;
+            const vector<File::Entry>& files;
+            const vector<int64_t>& offsets;
+            uint8_t* const data;
+            std::atomic<size_t>& next;
+            void execute () {
+              for (size_t n = next++; n < files.size(); n = next++)
+                __decode_tiff (header, files[n].name, data + offsets[n]);
+            }
+          };
+
+          std::atomic<size_t> next (0);
+          DecodeThread decoder = { header, files, offsets, data, next };
+          auto threads = Thread::run (Thread::multi (decoder), "TIFF decode");
+          threads.wait();
+          return;
+        }
+
+        // layout differs from what the header implies (e.g. files with
+        // inconsistent directory structure): use the serial path below
+        DEBUG ("TIFF directory scan inconsistent with header for image \"" + header.name() + "\" - decoding serially");
       }
 
+      for (auto& entry : files)
+        data = __decode_tiff (header, entry.name, data);
+
     }
 
 
@@ -0,0 +1,225 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <zlib.h>
+
+#include "progressbar.h"
+#include "header.h"
+#include "raw.h"
+#include "stride.h"
+#include "image_io/tiled.h"
+#include "file/utils.h"
+
+namespace MR
+{
+  namespace ImageIO
+  {
+
+    //! \cond skip
+    namespace
+    {
+
+      // brick geometry, computed over the on-disk raster order: dim[0] is
+      // the extent of the fastest-varying axis, with any axes beyond the
+      // first three flattened into a volume count:
+      class __BrickLayout { NOMEMALIGN
+        public:
+          __BrickLayout (const Header& header, size_t brick_edge) :
+            edge (brick_edge),
+            value_bytes (header.datatype().bytes()),
+            nvol (1) {
+              const auto order = Stride::order (header);
+              for (size_t n = 0; n < 3; ++n)
+                dim[n] = n < header.ndim() ? header.size (order[n]) : 1;
+              for (size_t n = 3; n < header.ndim(); ++n)
+                nvol *= header.size (order[n]);
+              for (size_t n = 0; n < 3; ++n)
+                nbrick[n] = (dim[n] + edge - 1) / edge;
+            }
+
+          size_t brick_values () const { return edge * edge * edge; }
+          size_t brick_bytes () const { return brick_values() * value_bytes; }
+          size_t bricks_per_volume () const { return nbrick[0] * nbrick[1] * nbrick[2]; }
+          size_t num_bricks () const { return nvol * bricks_per_volume(); }
+          size_t data_bytes () const { return num_bricks() * brick_bytes(); }
+
+          // copy one brick between the flat scanline-ordered buffer and its
+          // packed representation, one contiguous run along the fastest
+          // axis at a time:
+          template <bool unpack>
+            void copy_brick (uint8_t* flat, uint8_t* brick, size_t vol, size_t bz, size_t by, size_t bx) const {
+              const size_t nx = std::min (edge, dim[0] - bx*edge);
+              const size_t ny = std::min (edge, dim[1] - by*edge);
+              const size_t nz = std::min (edge, dim[2] - bz*edge);
+              for (size_t z = 0; z < nz; ++z) {
+                for (size_t y = 0; y < ny; ++y) {
+                  uint8_t* f = flat + value_bytes * (bx*edge + dim[0] * (by*edge+y + dim[1] * (bz*edge+z + dim[2] * vol)));
+                  uint8_t* b = brick + value_bytes * edge * (y + edge*z);
+                  if (unpack)
+                    memcpy (f, b, nx * value_bytes);
+                  else
+                    memcpy (b, f, nx * value_bytes);
+                }
+              }
+            }
+
+          size_t edge, value_bytes, nvol;
+          size_t dim[3], nbrick[3];
+      };
+
+    }
+    //! \endcond
+
+
+
+
+    void Tiled::load (const Header& header, size_t)
+    {
+      assert (files.size() == 1);
+      if (header.datatype().bits() < 8)
+        throw Exception ("tiled image \"" + header.name() + "\" uses sub-byte datatype - not supported");
+
+      bytes_per_segment = header.datatype().bytes() * segsize;
+      if (bytes_per_segment > int64_t (std::numeric_limits<size_t>::max()))
+        throw Exception ("image \"" + header.name() + "\" is larger than maximum accessible memory");
+
+      DEBUG ("loading tiled image \"" + header.name() + "\"...");
+      addresses.resize (1);
+      addresses[0].reset (new uint8_t [bytes_per_segment]);
+      if (!addresses[0])
+        throw Exception ("failed to allocate memory for image \"" + header.name() + "\"");
+
+      if (is_new) {
+        memset (addresses[0].get(), 0, bytes_per_segment);
+        return;
+      }
+
+      const __BrickLayout layout (header, brick_edge);
+      ProgressBar progress ("unpacking tiled image \"" + header.name() + "\"", layout.num_bricks());
+
+      File::MMap mmap (files[0]);
+      const uint8_t* data = static_cast<const uint8_t*> (mmap.address());
+      vector<uint8_t> brick;
+      if (compressed)
+        brick.resize (layout.brick_bytes());
+
+      size_t nb = 0;
+      for (size_t vol = 0; vol < layout.nvol; ++vol) {
+        for (size_t bz = 0; bz < layout.nbrick[2]; ++bz) {
+          for (size_t by = 0; by < layout.nbrick[1]; ++by) {
+            for (size_t bx = 0; bx < layout.nbrick[0]; ++bx, ++nb) {
+              const uint8_t* src;
+              if (compressed) {
+                // offset table: num_bricks+1 little-endian uint64's,
+                // relative to the end of the table itself:
+                const size_t table_bytes = (layout.num_bricks()+1) * sizeof (uint64_t);
+                const uint64_t from = Raw::fetch_LE<uint64_t> (data, nb);
+                const uint64_t to = Raw::fetch_LE<uint64_t> (data, nb+1);
+                uLongf expanded = layout.brick_bytes();
+                if (::uncompress (brick.data(), &expanded, data + table_bytes + from, to - from) != Z_OK ||
+                    expanded != layout.brick_bytes())
+                  throw Exception ("error inflating brick " + str(nb) + " of tiled image \"" + header.name() + "\"");
+                src = brick.data();
+              }
+              else
+                src = data + nb * layout.brick_bytes();
+              layout.copy_brick<true> (addresses[0].get(), const_cast<uint8_t*> (src), vol, bz, by, bx);
+              ++progress;
+            }
+          }
+        }
+      }
+    }
+
+
+
+
+    void Tiled::unload (const Header& header)
+    {
+      if (addresses.empty())
+        return;
+      assert (addresses.size() == 1);
+
+      if (writable) {
+        const __BrickLayout layout (header, brick_edge);
+        ProgressBar progress ("packing tiled image \"" + header.name() + "\"", layout.num_bricks());
+
+        std::fstream out (files[0].name.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        if (!out)
+          throw Exception ("error opening tiled image \"" + header.name() + "\" for writing: " + strerror (errno));
+        out.seekp (files[0].start, out.beg);
+
+        vector<uint8_t> brick (layout.brick_bytes());
+
+        if (compressed) {
+          const size_t table_bytes = (layout.num_bricks()+1) * sizeof (uint64_t);
+          vector<uint8_t> table (table_bytes, 0);
+          vector<uint8_t> deflated (compressBound (layout.brick_bytes()));
+          out.seekp (files[0].start + table_bytes, out.beg);
+
+          uint64_t offset = 0;
+          size_t nb = 0;
+          for (size_t vol = 0; vol < layout.nvol; ++vol) {
+            for (size_t bz = 0; bz < layout.nbrick[2]; ++bz) {
+              for (size_t by = 0; by < layout.nbrick[1]; ++by) {
+                for (size_t bx = 0; bx < layout.nbrick[0]; ++bx, ++nb) {
+                  memset (brick.data(), 0, brick.size());
+                  layout.copy_brick<false> (addresses[0].get(), brick.data(), vol, bz, by, bx);
+                  uLongf compressed_size = deflated.size();
+                  if (::compress2 (deflated.data(), &compressed_size, brick.data(), brick.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+                    throw Exception ("error deflating brick " + str(nb) + " of tiled image \"" + header.name() + "\"");
+                  Raw::store_LE<uint64_t> (offset, table.data(), nb);
+                  out.write (reinterpret_cast<const char*> (deflated.data()), compressed_size);
+                  offset += compressed_size;
+                  ++progress;
+                }
+              }
+            }
+          }
+          Raw::store_LE<uint64_t> (offset, table.data(), layout.num_bricks());
+          out.seekp (files[0].start, out.beg);
+          out.write (reinterpret_cast<const char*> (table.data()), table_bytes);
+          if (!out.good())
+            throw Exception ("error writing tiled image \"" + header.name() + "\": " + strerror (errno));
+          out.close();
+          File::resize (files[0].name, files[0].start + table_bytes + offset);
+        }
+        else {
+          size_t nb = 0;
+          for (size_t vol = 0; vol < layout.nvol; ++vol) {
+            for (size_t bz = 0; bz < layout.nbrick[2]; ++bz) {
+              for (size_t by = 0; by < layout.nbrick[1]; ++by) {
+                for (size_t bx = 0; bx < layout.nbrick[0]; ++bx, ++nb) {
+                  memset (brick.data(), 0, brick.size());
+                  layout.copy_brick<false> (addresses[0].get(), brick.data(), vol, bz, by, bx);
+                  out.write (reinterpret_cast<const char*> (brick.data()), brick.size());
+                  ++progress;
+                }
+              }
+            }
+          }
+          if (!out.good())
+            throw Exception ("error writing tiled image \"" + header.name() + "\": " + strerror (errno));
+        }
+      }
+
+      addresses[0].reset();
+    }
+
+
+  }
+}
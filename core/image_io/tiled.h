@@ -0,0 +1,59 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __image_io_tiled_h__
+#define __image_io_tiled_h__
+
+#include "image_io/base.h"
+#include "file/mmap.h"
+
+namespace MR
+{
+
+  namespace ImageIO
+  {
+
+    /*! access to images stored as fixed-size 3D bricks
+     *
+     * The on-disk data are laid out as bricks of brick_edge^3 voxels over
+     * the three fastest-varying axes (padded up to the brick size at the
+     * image edges), scanned in raster order, with any higher axes looping
+     * over complete tiled volumes; each brick may additionally be
+     * zlib-compressed, in which case the data section starts with a table
+     * of per-brick byte offsets. On load, the bricks are unpacked into a
+     * flat scanline-ordered RAM buffer (so that all in-RAM access operates
+     * as for any other format), and re-packed on unload if the image was
+     * opened read/write. */
+    class Tiled : public Base
+    { NOMEMALIGN
+      public:
+        Tiled (Tiled&&) = default;
+        Tiled (const Header& header, size_t brick_edge, bool compressed) :
+          Base (header),
+          brick_edge (brick_edge),
+          compressed (compressed) { }
+
+      protected:
+        int64_t bytes_per_segment;
+        size_t  brick_edge;
+        bool    compressed;
+
+        virtual void load (const Header&, size_t);
+        virtual void unload (const Header&);
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,94 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+#ifdef MRTRIX_ZSTD_SUPPORT
+
+#include <cstring>
+#include <limits>
+
+#include "progressbar.h"
+#include "header.h"
+#include "image_io/zstd.h"
+#include "file/zstd.h"
+
+namespace MR
+{
+  namespace ImageIO
+  {
+
+    void Zstd::load (const Header& header, size_t)
+    {
+      if (files.empty())
+        throw Exception ("no files specified in header for image \"" + header.name() + "\"");
+
+      segsize /= files.size();
+      bytes_per_segment = (header.datatype().bits() * segsize + 7) / 8;
+      if (files.size() * bytes_per_segment > std::numeric_limits<size_t>::max())
+        throw Exception ("image \"" + header.name() + "\" is larger than maximum accessible memory");
+
+      DEBUG ("loading image \"" + header.name() + "\"...");
+      addresses.resize (header.datatype().bits() == 1 && files.size() > 1 ? files.size() : 1);
+      addresses[0].reset (new uint8_t [files.size() * bytes_per_segment]);
+      if (!addresses[0])
+        throw Exception ("failed to allocate memory for image \"" + header.name() + "\"");
+
+      if (is_new)
+        memset (addresses[0].get(), 0, files.size() * bytes_per_segment);
+      else {
+        ProgressBar progress ("uncompressing image \"" + header.name() + "\"",
+            files.size() * (File::Zstd::num_frames (bytes_per_segment) + 1));
+        for (size_t n = 0; n < files.size(); n++) {
+          // the seek table allows the data section to be located and
+          // decoded frame-by-frame across threads, without inflating
+          // anything that precedes it:
+          File::Zstd::Reader zf (files[n].name);
+          zf.read_parallel (files[n].start, addresses[0].get() + n*bytes_per_segment, bytes_per_segment, &progress);
+        }
+      }
+
+      if (addresses.size() > 1)
+        for (size_t n = 1; n < addresses.size(); n++)
+          addresses[n].reset (addresses[0].get() + n*bytes_per_segment);
+      else
+        segsize = std::numeric_limits<size_t>::max();
+    }
+
+
+
+    void Zstd::unload (const Header& header)
+    {
+      if (addresses.size()) {
+        assert (addresses[0]);
+
+        if (writable) {
+          // compression is distributed across threads, with each block
+          // stored as an independent zstd frame (see file/zstd.h):
+          ProgressBar progress ("compressing image \"" + header.name() + "\"",
+              files.size() * File::Zstd::num_frames (bytes_per_segment));
+          for (size_t n = 0; n < files.size(); n++) {
+            assert (files[n].start == int64_t (lead_in_size));
+            File::Zstd::Writer out (files[n].name);
+            if (lead_in)
+              out.append (lead_in.get(), lead_in_size);
+            out.append (addresses[0].get() + n*bytes_per_segment, bytes_per_segment, &progress);
+            out.close();
+          }
+        }
+
+      }
+    }
+
+  }
+}
+
+#endif
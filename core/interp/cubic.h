@@ -74,7 +74,8 @@ namespace MR
 
         SplineInterpBase (const ImageType& parent, value_type value_when_out_of_bounds = Base<ImageType>::default_out_of_bounds_value()) :
             Base<ImageType> (parent, value_when_out_of_bounds),
-            H { SplineType(PType), SplineType(PType), SplineType(PType) } { }
+            H { SplineType(PType), SplineType(PType), SplineType(PType) },
+            gathered (false) { }
 
       protected:
         SplineType H[3];
@@ -85,6 +86,44 @@ namespace MR
           if (x >= dim) return (dim-1);
           return x;
         }
+
+        //! the intensities of the 4x4x4 neighbourhood surrounding the current position
+        /*! The gather is skipped entirely when the neighbourhood matches
+         * that of the previous query, as commonly occurs for consecutive
+         * closely-spaced positions (e.g. reslicing to a finer voxel grid,
+         * or evaluating a registration metric across a pyramid level);
+         * this assumes the intensities of the underlying image do not
+         * change over the lifetime of the interpolator. */
+        const Eigen::Matrix<value_type, 64, 1>& gather () {
+          const ssize_t c[3] = { ssize_t (std::floor (P[0])-1), ssize_t (std::floor (P[1])-1), ssize_t (std::floor (P[2])-1) };
+          bool reuse = gathered && c[0] == gathered_from[0] && c[1] == gathered_from[1] && c[2] == gathered_from[2];
+          for (size_t n = 3; reuse && n < ImageType::ndim(); ++n)
+            reuse = (ImageType::index(n) == gathered_higher[n-3]);
+          if (!reuse) {
+            size_t i (0);
+            for (ssize_t z = 0; z < 4; ++z) {
+              ImageType::index(2) = clamp (c[2] + z, ImageType::size (2));
+              for (ssize_t y = 0; y < 4; ++y) {
+                ImageType::index(1) = clamp (c[1] + y, ImageType::size (1));
+                for (ssize_t x = 0; x < 4; ++x) {
+                  ImageType::index(0) = clamp (c[0] + x, ImageType::size (0));
+                  neighbourhood[i++] = ImageType::value ();
+                }
+              }
+            }
+            gathered_from[0] = c[0]; gathered_from[1] = c[1]; gathered_from[2] = c[2];
+            gathered_higher.resize (ImageType::ndim() > 3 ? ImageType::ndim()-3 : 0);
+            for (size_t n = 3; n < ImageType::ndim(); ++n)
+              gathered_higher[n-3] = ImageType::index(n);
+            gathered = true;
+          }
+          return neighbourhood;
+        }
+
+        Eigen::Matrix<value_type, 64, 1> neighbourhood;
+        ssize_t gathered_from[3];
+        vector<ssize_t> gathered_higher;
+        bool gathered;
     };
 
 
@@ -158,23 +197,7 @@ namespace MR
           if (Base<ImageType>::out_of_bounds)
             return Base<ImageType>::out_of_bounds_value;
 
-          ssize_t c[] = { ssize_t (std::floor (P[0])-1), ssize_t (std::floor (P[1])-1), ssize_t (std::floor (P[2])-1) };
-
-          Eigen::Matrix<value_type, 64, 1> coeff_vec;
-
-          size_t i(0);
-          for (ssize_t z = 0; z < 4; ++z) {
-            ImageType::index(2) = clamp (c[2] + z, ImageType::size (2));
-            for (ssize_t y = 0; y < 4; ++y) {
-              ImageType::index(1) = clamp (c[1] + y, ImageType::size (1));
-              for (ssize_t x = 0; x < 4; ++x) {
-                ImageType::index(0) = clamp (c[0] + x, ImageType::size (0));
-                coeff_vec[i++] = ImageType::value ();
-              }
-            }
-          }
-
-          return coeff_vec.dot (weights_vec);
+          return SplineBase::gather().dot (weights_vec);
         }
 
         //! Read interpolated values from volumes along axis >= 3
@@ -187,20 +210,28 @@ namespace MR
             return out_of_bounds_row;
           }
 
-          ssize_t c[] = { ssize_t (std::floor (P[0])-1), ssize_t (std::floor (P[1])-1), ssize_t (std::floor (P[2])-1) };
-
-          Eigen::Matrix<value_type, Eigen::Dynamic, 64> coeff_matrix ( ImageType::size(3), 64 );
-
-          size_t i(0);
-          for (ssize_t z = 0; z < 4; ++z) {
-            ImageType::index(2) = clamp (c[2] + z, ImageType::size (2));
-            for (ssize_t y = 0; y < 4; ++y) {
-              ImageType::index(1) = clamp (c[1] + y, ImageType::size (1));
-              for (ssize_t x = 0; x < 4; ++x) {
-                ImageType::index(0) = clamp (c[0] + x, ImageType::size (0));
-                coeff_matrix.col (i++) = ImageType::row (axis);
+          const ssize_t c[3] = { ssize_t (std::floor (P[0])-1), ssize_t (std::floor (P[1])-1), ssize_t (std::floor (P[2])-1) };
+
+          // as for the scalar gather, reuse the previous rows when queried
+          //   repeatedly within the same neighbourhood (e.g. successive
+          //   samples along a streamline):
+          if (!(row_gathered && axis == row_gathered_axis
+                && c[0] == row_gathered_from[0] && c[1] == row_gathered_from[1] && c[2] == row_gathered_from[2])) {
+            coeff_matrix.resize (ImageType::size(axis), 64);
+            size_t i(0);
+            for (ssize_t z = 0; z < 4; ++z) {
+              ImageType::index(2) = clamp (c[2] + z, ImageType::size (2));
+              for (ssize_t y = 0; y < 4; ++y) {
+                ImageType::index(1) = clamp (c[1] + y, ImageType::size (1));
+                for (ssize_t x = 0; x < 4; ++x) {
+                  ImageType::index(0) = clamp (c[0] + x, ImageType::size (0));
+                  coeff_matrix.col (i++) = ImageType::row (axis);
+                }
               }
             }
+            row_gathered_from[0] = c[0]; row_gathered_from[1] = c[1]; row_gathered_from[2] = c[2];
+            row_gathered_axis = axis;
+            row_gathered = true;
           }
 
           return coeff_matrix * weights_vec;
@@ -208,6 +239,10 @@ namespace MR
 
       protected:
         Eigen::Matrix<value_type, 64, 1> weights_vec;
+        Eigen::Matrix<value_type, Eigen::Dynamic, 64> coeff_matrix;
+        ssize_t row_gathered_from[3];
+        size_t row_gathered_axis;
+        bool row_gathered = false;
     };
 
 
@@ -288,23 +323,7 @@ namespace MR
           if (Base<ImageType>::out_of_bounds)
             return out_of_bounds_vec;
 
-          ssize_t c[] = { ssize_t (std::floor (P[0])-1), ssize_t (std::floor (P[1])-1), ssize_t (std::floor (P[2])-1) };
-
-          Eigen::Matrix<value_type, 1, 64> coeff_vec;
-
-          size_t i(0);
-          for (ssize_t z = 0; z < 4; ++z) {
-            ImageType::index(2) = clamp (c[2] + z, ImageType::size (2));
-            for (ssize_t y = 0; y < 4; ++y) {
-              ImageType::index(1) = clamp (c[1] + y, ImageType::size (1));
-              for (ssize_t x = 0; x < 4; ++x) {
-                ImageType::index(0) = clamp (c[0] + x, ImageType::size (0));
-                coeff_vec[i++] = ImageType::value ();
-              }
-            }
-          }
-
-          return coeff_vec * weights_matrix;
+          return SplineBase::gather().transpose() * weights_matrix;
         }
 
 
@@ -440,22 +459,7 @@ namespace MR
             return;
           }
 
-          ssize_t c[] = { ssize_t (std::floor (P[0])-1), ssize_t (std::floor (P[1])-1), ssize_t (std::floor (P[2])-1) };
-
-          Eigen::Matrix<value_type, 1, 64> coeff_vec;
-
-          size_t i(0);
-          for (ssize_t z = 0; z < 4; ++z) {
-            ImageType::index(2) = clamp (c[2] + z, ImageType::size (2));
-            for (ssize_t y = 0; y < 4; ++y) {
-              ImageType::index(1) = clamp (c[1] + y, ImageType::size (1));
-              for (ssize_t x = 0; x < 4; ++x) {
-                ImageType::index(0) = clamp (c[0] + x, ImageType::size (0));
-                coeff_vec[i++] = ImageType::value ();
-              }
-            }
-          }
-          Eigen::Matrix<value_type, 1, 4> grad_and_value (coeff_vec * weights_matrix);
+          Eigen::Matrix<value_type, 1, 4> grad_and_value (SplineBase::gather().transpose() * weights_matrix);
 
           gradient = grad_and_value.head(3);
           value = grad_and_value[3];
@@ -76,39 +76,148 @@ namespace MR
       }
 
 
+//! dispatch \a lmax to a compile-time-specialised instantiation of \a function
+/*! the harmonic degrees in routine use are forwarded to instantiations for
+ * which lmax is a compile-time constant: the Legendre recurrence factors then
+ * fold to constants, and the loops over (l,m) fully unroll into straight-line
+ * multiply-add code. Any other degree uses the generic runtime-lmax
+ * instantiation. */
+#define SH_DISPATCH_LMAX(function, lmax, ...) \
+  switch (lmax) { \
+    case 0:  return function<0>  (__VA_ARGS__); \
+    case 2:  return function<2>  (__VA_ARGS__); \
+    case 4:  return function<4>  (__VA_ARGS__); \
+    case 6:  return function<6>  (__VA_ARGS__); \
+    case 8:  return function<8>  (__VA_ARGS__); \
+    case 10: return function<10> (__VA_ARGS__); \
+    case 12: return function<12> (__VA_ARGS__); \
+    default: return function<-1> (__VA_ARGS__); \
+  }
 
-      //! form the SH->amplitudes matrix
-      /*! This computes the matrix \a SHT mapping spherical harmonic
-       * coefficients up to maximum harmonic degree \a lmax onto directions \a
-       * dirs (in spherical coordinates, with columns [ azimuth elevation ]). */
-      template <class MatrixType>
-        Eigen::Matrix<typename MatrixType::Scalar,Eigen::Dynamic, Eigen::Dynamic> init_transform (const MatrixType& dirs, const int lmax)
-        {
-          using namespace Eigen;
-          using value_type = typename MatrixType::Scalar;
-          if (dirs.cols() != 2)
-            throw Exception ("direction matrix should have 2 columns: [ azimuth elevation ]");
-          Matrix<value_type,Dynamic,Dynamic> SHT (dirs.rows(), NforL (lmax));
-          Matrix<value_type,Dynamic,1,0,64> AL (lmax+1);
-          for (ssize_t i = 0; i < dirs.rows(); i++) {
-            const value_type x = std::cos (dirs (i,1));
-            Legendre::Plm_sph (AL, lmax, 0, x);
+
+      namespace {
+
+        // Kernels behind init_transform() & value(): lmax is passed both as
+        //   template parameter and as function argument, with the template
+        //   parameter taking precedence when non-negative (see
+        //   SH_DISPATCH_LMAX above)
+
+        template <int FixedLmax, class MatrixType>
+          Eigen::Matrix<typename MatrixType::Scalar,Eigen::Dynamic, Eigen::Dynamic> __init_transform (const MatrixType& dirs, const int runtime_lmax)
+          {
+            using namespace Eigen;
+            using value_type = typename MatrixType::Scalar;
+            const int lmax = FixedLmax >= 0 ? FixedLmax : runtime_lmax;
+            assert (FixedLmax < 0 || FixedLmax == runtime_lmax);
+            if (dirs.cols() != 2)
+              throw Exception ("direction matrix should have 2 columns: [ azimuth elevation ]");
+            Matrix<value_type,Dynamic,Dynamic> SHT (dirs.rows(), NforL (lmax));
+            Matrix<value_type,Dynamic,1,0,64> AL (lmax+1);
+            for (ssize_t i = 0; i < dirs.rows(); i++) {
+              const value_type x = std::cos (dirs (i,1));
+              Legendre::Plm_sph (AL, lmax, 0, x);
+              for (int l = 0; l <= lmax; l+=2)
+                SHT (i,index (l,0)) = AL[l];
+              for (int m = 1; m <= lmax; m++) {
+                Legendre::Plm_sph (AL, lmax, m, x);
+                for (int l = ( (m&1) ? m+1 : m); l <= lmax; l+=2) {
+#ifndef USE_NON_ORTHONORMAL_SH_BASIS
+                  SHT(i, index(l, m)) = Math::sqrt2 * AL[l]*std::cos (m*dirs (i,0));
+                  SHT(i, index(l,-m)) = Math::sqrt2 * AL[l]*std::sin (m*dirs (i,0));
+#else
+                  SHT(i, index(l, m)) = AL[l]*std::cos (m*dirs (i,0));
+                  SHT(i, index(l,-m)) = AL[l]*std::sin (m*dirs (i,0));
+#endif
+                }
+              }
+            }
+            return SHT;
+          }
+
+
+
+        template <int FixedLmax, class VectorType>
+          inline typename VectorType::Scalar __value (const VectorType& coefs,
+              typename VectorType::Scalar cos_elevation,
+              typename VectorType::Scalar cos_azimuth,
+              typename VectorType::Scalar sin_azimuth,
+              const int runtime_lmax)
+          {
+            using value_type = typename VectorType::Scalar;
+            const int lmax = FixedLmax >= 0 ? FixedLmax : runtime_lmax;
+            assert (FixedLmax < 0 || FixedLmax == runtime_lmax);
+            value_type amplitude = 0.0;
+            Eigen::Matrix<value_type,Eigen::Dynamic,1,0,64> AL (lmax+1);
+            Legendre::Plm_sph (AL, lmax, 0, cos_elevation);
+            for (int l = 0; l <= lmax; l+=2)
+              amplitude += AL[l] * coefs[index (l,0)];
+            value_type c0 (1.0), s0 (0.0);
+            for (int m = 1; m <= lmax; m++) {
+              Legendre::Plm_sph (AL, lmax, m, cos_elevation);
+              value_type c = c0 * cos_azimuth - s0 * sin_azimuth;  // std::cos(m*azimuth)
+              value_type s = s0 * cos_azimuth + c0 * sin_azimuth;  // std::sin(m*azimuth)
+              for (int l = ( (m&1) ? m+1 : m); l <= lmax; l+=2) {
+#ifndef USE_NON_ORTHONORMAL_SH_BASIS
+                amplitude += AL[l] * Math::sqrt2 * (c * coefs[index (l,m)] + s * coefs[index (l,-m)]);
+#else
+                amplitude += AL[l] * (c * coefs[index (l,m)] + s * coefs[index (l,-m)]);
+#endif
+              }
+              c0 = c;
+              s0 = s;
+            }
+            return amplitude;
+          }
+
+
+
+        template <int FixedLmax, class VectorType>
+          inline typename VectorType::Scalar __value_plm (const VectorType& coefs,
+              typename VectorType::Scalar cos_elevation,
+              typename VectorType::Scalar cos_azimuth,
+              typename VectorType::Scalar sin_azimuth,
+              const Legendre::PrecomputedPlm<typename VectorType::Scalar>& plm)
+          {
+            using value_type = typename VectorType::Scalar;
+            const int lmax = FixedLmax >= 0 ? FixedLmax : plm.order();
+            assert (FixedLmax < 0 || FixedLmax == plm.order());
+            value_type amplitude = 0.0;
+            Eigen::Matrix<value_type,Eigen::Dynamic,1,0,64> AL (lmax+1);
+            const value_type sin_elevation = std::sqrt (std::max (value_type (0.0), value_type (1.0) - pow2 (cos_elevation)));
+            value_type pow_sin (1.0);
+            plm (AL, 0, cos_elevation, pow_sin);
             for (int l = 0; l <= lmax; l+=2)
-              SHT (i,index (l,0)) = AL[l];
+              amplitude += AL[l] * coefs[index (l,0)];
+            value_type c0 (1.0), s0 (0.0);
             for (int m = 1; m <= lmax; m++) {
-              Legendre::Plm_sph (AL, lmax, m, x);
+              pow_sin *= sin_elevation;
+              plm (AL, m, cos_elevation, pow_sin);
+              value_type c = c0 * cos_azimuth - s0 * sin_azimuth;  // std::cos(m*azimuth)
+              value_type s = s0 * cos_azimuth + c0 * sin_azimuth;  // std::sin(m*azimuth)
               for (int l = ( (m&1) ? m+1 : m); l <= lmax; l+=2) {
 #ifndef USE_NON_ORTHONORMAL_SH_BASIS
-                SHT(i, index(l, m)) = Math::sqrt2 * AL[l]*std::cos (m*dirs (i,0));
-                SHT(i, index(l,-m)) = Math::sqrt2 * AL[l]*std::sin (m*dirs (i,0));
+                amplitude += AL[l] * Math::sqrt2 * (c * coefs[index (l,m)] + s * coefs[index (l,-m)]);
 #else
-                SHT(i, index(l, m)) = AL[l]*std::cos (m*dirs (i,0));
-                SHT(i, index(l,-m)) = AL[l]*std::sin (m*dirs (i,0));
+                amplitude += AL[l] * (c * coefs[index (l,m)] + s * coefs[index (l,-m)]);
 #endif
               }
+              c0 = c;
+              s0 = s;
             }
+            return amplitude;
           }
-          return SHT;
+
+      }
+
+
+      //! form the SH->amplitudes matrix
+      /*! This computes the matrix \a SHT mapping spherical harmonic
+       * coefficients up to maximum harmonic degree \a lmax onto directions \a
+       * dirs (in spherical coordinates, with columns [ azimuth elevation ]). */
+      template <class MatrixType>
+        Eigen::Matrix<typename MatrixType::Scalar,Eigen::Dynamic, Eigen::Dynamic> init_transform (const MatrixType& dirs, const int lmax)
+        {
+          SH_DISPATCH_LMAX (__init_transform, lmax, dirs, lmax);
         }
 
 
@@ -172,10 +281,18 @@ namespace MR
               scale_degrees_forward (SHT, invert (filter));
               scale_degrees_inverse (iSHT, filter);
             }
+          //! transform amplitudes to SH coefficients
+          /*! \a amplitudes may be a single vector, or a matrix holding one
+           * voxel per column; in the latter case the whole batch is processed
+           * as a single matrix-matrix product, which is considerably faster
+           * than transforming the corresponding vectors one at a time. */
           template <class VectorType1, class VectorType2>
             void A2SH (VectorType1& sh, const VectorType2& amplitudes) const {
               sh.noalias() = iSHT * amplitudes;
             }
+          //! transform SH coefficients to amplitudes
+          /*! \a sh may be a single vector, or a matrix holding one voxel per
+           * column, as for A2SH(). */
           template <class VectorType1, class VectorType2>
             void SH2A (VectorType1& amplitudes, const VectorType2& sh) const {
               amplitudes.noalias() = SHT * sh;
@@ -208,28 +325,7 @@ namespace MR
             typename VectorType::Scalar sin_azimuth,
             int lmax)
         {
-          using value_type = typename VectorType::Scalar;
-          value_type amplitude = 0.0;
-          Eigen::Matrix<value_type,Eigen::Dynamic,1,0,64> AL (lmax+1);
-          Legendre::Plm_sph (AL, lmax, 0, cos_elevation);
-          for (int l = 0; l <= lmax; l+=2)
-            amplitude += AL[l] * coefs[index (l,0)];
-          value_type c0 (1.0), s0 (0.0);
-          for (int m = 1; m <= lmax; m++) {
-            Legendre::Plm_sph (AL, lmax, m, cos_elevation);
-            value_type c = c0 * cos_azimuth - s0 * sin_azimuth;  // std::cos(m*azimuth)
-            value_type s = s0 * cos_azimuth + c0 * sin_azimuth;  // std::sin(m*azimuth)
-            for (int l = ( (m&1) ? m+1 : m); l <= lmax; l+=2) {
-#ifndef USE_NON_ORTHONORMAL_SH_BASIS
-              amplitude += AL[l] * Math::sqrt2 * (c * coefs[index (l,m)] + s * coefs[index (l,-m)]);
-#else
-              amplitude += AL[l] * (c * coefs[index (l,m)] + s * coefs[index (l,-m)]);
-#endif
-            }
-            c0 = c;
-            s0 = s;
-          }
-          return amplitude;
+          SH_DISPATCH_LMAX (__value, lmax, coefs, cos_elevation, cos_azimuth, sin_azimuth, lmax);
         }
 
       template <class VectorType>
@@ -252,6 +348,32 @@ namespace MR
         }
 
 
+      //! as above, using precomputed recurrence coefficients
+      /*! evaluates the same exact amplitude as value(), but draws the
+       * recurrence factors from \a plm rather than recomputing them, leaving
+       * only multiply-add operations in the per-direction kernel. */
+      template <class VectorType>
+        inline typename VectorType::Scalar value (const VectorType& coefs,
+            typename VectorType::Scalar cos_elevation,
+            typename VectorType::Scalar cos_azimuth,
+            typename VectorType::Scalar sin_azimuth,
+            const Legendre::PrecomputedPlm<typename VectorType::Scalar>& plm)
+        {
+          SH_DISPATCH_LMAX (__value_plm, plm.order(), coefs, cos_elevation, cos_azimuth, sin_azimuth, plm);
+        }
+
+      template <class VectorType1, class VectorType2>
+        inline typename VectorType1::Scalar value (const VectorType1& coefs, const VectorType2& unit_dir,
+            const Legendre::PrecomputedPlm<typename VectorType1::Scalar>& plm)
+        {
+          using value_type = typename VectorType1::Scalar;
+          value_type rxy = std::sqrt ( pow2(unit_dir[1]) + pow2(unit_dir[0]) );
+          value_type cp = (rxy) ? unit_dir[0]/rxy : 1.0;
+          value_type sp = (rxy) ? unit_dir[1]/rxy : 0.0;
+          return value (coefs, value_type (unit_dir[2]), cp, sp, plm);
+        }
+
+
       template <class VectorType1, class VectorType2>
         inline VectorType1& delta (VectorType1& delta_vec, const VectorType2& unit_dir, int lmax)
         {
@@ -533,12 +655,14 @@ namespace MR
 
 
 
-      //! computes first and second order derivatives of SH series
-      /*! This is used primarily in the get_peak() function. */
-      template <class VectorType>
-        inline void derivatives (
+      namespace {
+
+        // kernel behind derivatives(), with lmax dispatched to a
+        //   compile-time constant as for value() (see SH_DISPATCH_LMAX)
+        template <int FixedLmax, class VectorType>
+        inline void __derivatives (
             const VectorType& sh,
-            const int lmax,
+            const int runtime_lmax,
             const typename VectorType::Scalar elevation,
             const typename VectorType::Scalar azimuth,
             typename VectorType::Scalar& amplitude,
@@ -550,6 +674,8 @@ namespace MR
             PrecomputedAL<typename VectorType::Scalar>* precomputer)
         {
           using value_type = typename VectorType::Scalar;
+          const int lmax = FixedLmax >= 0 ? FixedLmax : runtime_lmax;
+          assert (FixedLmax < 0 || FixedLmax == runtime_lmax);
           value_type sel = std::sin (elevation);
           value_type cel = std::cos (elevation);
           bool atpole = sel < 1e-4;
@@ -621,6 +747,29 @@ namespace MR
           }
         }
 
+      }
+
+
+      //! computes first and second order derivatives of SH series
+      /*! This is used primarily in the get_peak() function. */
+      template <class VectorType>
+        inline void derivatives (
+            const VectorType& sh,
+            const int lmax,
+            const typename VectorType::Scalar elevation,
+            const typename VectorType::Scalar azimuth,
+            typename VectorType::Scalar& amplitude,
+            typename VectorType::Scalar& dSH_del,
+            typename VectorType::Scalar& dSH_daz,
+            typename VectorType::Scalar& d2SH_del2,
+            typename VectorType::Scalar& d2SH_deldaz,
+            typename VectorType::Scalar& d2SH_daz2,
+            PrecomputedAL<typename VectorType::Scalar>* precomputer)
+        {
+          SH_DISPATCH_LMAX (__derivatives, lmax, sh, lmax, elevation, azimuth, amplitude,
+              dSH_del, dSH_daz, d2SH_del2, d2SH_deldaz, d2SH_daz2, precomputer);
+        }
+
 
 
       //! a class to hold the coefficients for an apodised point-spread function.
@@ -15,6 +15,7 @@
 #ifndef __math_constrained_least_squares_h__
 #define __math_constrained_least_squares_h__
 
+#include <algorithm>
 #include <set>
 #include "math/math.h"
 
@@ -109,15 +110,20 @@ namespace MR
                 // and normalise each row to help preconditioning (the norm of
                 // each row is irrelevant to the constraint itself):
                 B.noalias() = chol_HtH.template triangularView<Eigen::Lower>().transpose().template solve<Eigen::OnTheRight> (constraint_matrix);
-                for (ssize_t n = 0; n < B.rows(); ++n) 
+                for (ssize_t n = 0; n < B.rows(); ++n)
                   B.row(n).normalize();
+
+                // precompute the constraint Gram matrix; solvers gather the
+                // active submatrix from this, rather than recomputing the
+                // same inner products on every active-set update:
+                BtB.noalias() = B * B.transpose();
               }
 
             size_t num_parameters () const { return H.cols(); }
             size_t num_measurements () const { return H.rows(); }
             size_t num_constraints () const { return B.rows(); }
 
-            matrix_type H, chol_HtH, B, b2d;
+            matrix_type H, chol_HtH, B, b2d, BtB;
             value_type lambda_min_norm, tol;
             size_t max_niter;
         };
@@ -135,6 +141,7 @@ namespace MR
 
             Solver (const Problem<value_type>& problem) :
               P (problem),
+              warm_start (false),
               BtB (P.chol_HtH.rows(), P.chol_HtH.cols()),
               B (P.B.rows(), P.B.cols()),
               y_u (BtB.rows()),
@@ -145,7 +152,15 @@ namespace MR
               l (lambda.size()),
               active (lambda.size(), false) { }
 
-            size_t operator() (vector_type& x, const vector_type& b) 
+            //! re-use each solve's final active set to initialise the next
+            /*! appropriate when successive right-hand sides are similar (e.g.
+             * solving per-voxel problems in scan order), in which case few
+             * active-set iterations are needed to correct the initial guess;
+             * the solution is unaffected, since the problem is strictly
+             * convex. */
+            void set_warm_start (const bool i) { warm_start = i; }
+
+            size_t operator() (vector_type& x, const vector_type& b)
             {
 #ifdef MRTRIX_ICLS_DEBUG
               std::ofstream l_stream ("l.txt");
@@ -159,79 +174,30 @@ namespace MR
               // set all Lagrangian multipliers to zero:
               lambda.setZero();
               lambda_prev.setZero();
-              // set active set empty:
-              std::fill (active.begin(), active.end(), false);
-
-              // initial estimate of constraint values:
-              c = c_u;
-              // initial estimate of solution:
-              x = y_u;
 
               size_t min_c_index;
               size_t niter = 0;
 
+              if (warm_start && std::find (active.begin(), active.end(), true) != active.end()) {
+                // start from the previous solve's active set:
+                solve_active_set (x);
+                lambda_prev = lambda;
+                c = P.B * x;
+              }
+              else {
+                // set active set empty:
+                std::fill (active.begin(), active.end(), false);
+                // initial estimate of constraint values:
+                c = c_u;
+                // initial estimate of solution:
+                x = y_u;
+              }
+
               while (c.minCoeff (&min_c_index) < -P.tol) {
                 bool active_set_changed = !active[min_c_index];
                 active[min_c_index] = true;
 
-                while (1) {
-                  // form submatrix of active constraints:
-                  size_t num_active = 0;
-                  for (size_t n = 0; n < active.size(); ++n) {
-                    if (active[n]) {
-                      B.row (num_active) = P.B.row (n);
-                      l[num_active] = -c_u[n];
-                      ++num_active;
-                    }
-                  }
-                  auto B_active = B.topRows (num_active);
-                  auto l_active = l.head (num_active);
-
-                  BtB.resize (num_active, num_active);
-                  // solve for l in B*B'l = -c_u by Cholesky decomposition:
-                  BtB = B_active * B_active.transpose();
-                  BtB.diagonal().array() += P.lambda_min_norm;
-                  BtB.template selfadjointView<Eigen::Lower>().llt().solveInPlace (l_active);
-
-                  // update lambda values in full vector 
-                  // and identify worst offender if any lambda < 0
-                  // by projection from previous onto feasible 
-                  // subset (i.e. l>=0):
-                  value_type s_min = std::numeric_limits<value_type>::infinity();
-                  size_t s_min_index = 0;
-                  size_t a = 0;
-                  for (size_t n = 0; n < active.size(); ++n) {
-                    if (active[n]) {
-                      if (l_active[a] < 0.0) {
-                        value_type s = lambda_prev[n] / (lambda_prev[n] - l_active[a]);
-                        if (s < s_min) {
-                          s_min = s;
-                          s_min_index = n;
-                        }
-                      }
-                      lambda[n] = l_active[a];
-                      ++a;
-                    }
-                    else
-                      lambda[n] = 0.0;
-                  }
-
-                  // if no lambda < 0, proceed:
-                  if (!std::isfinite (s_min)) {
-                    // update solution vector:
-                    x = y_u + B_active.transpose() * l_active;
-                    break;
-                  }
-#ifdef MRTRIX_ICLS_DEBUG
-                l_stream << lambda << "\n";
-#endif
-
-                  // remove worst offending lambda from active set, 
-                  // and re-estimate remaining lambdas:
-                  if (active[s_min_index])
-                    active_set_changed = true;
-                  active[s_min_index] = false;
-                }
+                active_set_changed |= solve_active_set (x);
 
                 // store feasible subset of lambdas:
                 lambda_prev = lambda;
@@ -245,7 +211,7 @@ namespace MR
 #endif
 
                 ++niter;
-                if (!active_set_changed || niter > P.max_niter) 
+                if (!active_set_changed || niter > P.max_niter)
                   break;
 
                 // compute constraint values at updated solution:
@@ -261,9 +227,79 @@ namespace MR
 
           protected:
             const Problem<value_type>& P;
+            bool warm_start;
             matrix_type BtB, B;
             vector_type y_u, c, c_u, lambda, lambda_prev, l;
             vector<bool> active;
+            vector<size_t> active_idx;
+
+            //! solve for the multipliers of the current active set, update \a x
+            /*! iteratively drops constraints whose multipliers turn negative;
+             * returns whether any constraint was removed in the process. */
+            bool solve_active_set (vector_type& x)
+            {
+              bool active_set_changed = false;
+              while (1) {
+                // form submatrix of active constraints:
+                active_idx.clear();
+                for (size_t n = 0; n < active.size(); ++n) {
+                  if (active[n]) {
+                    B.row (active_idx.size()) = P.B.row (n);
+                    l[active_idx.size()] = -c_u[n];
+                    active_idx.push_back (n);
+                  }
+                }
+                const size_t num_active = active_idx.size();
+                auto B_active = B.topRows (num_active);
+                auto l_active = l.head (num_active);
+
+                BtB.resize (num_active, num_active);
+                // solve for l in B*B'l = -c_u by Cholesky decomposition,
+                // gathering the Gram submatrix from the precomputed P.BtB
+                // (only the lower triangle is referenced):
+                for (size_t i = 0; i < num_active; ++i)
+                  for (size_t j = 0; j <= i; ++j)
+                    BtB (i,j) = P.BtB (active_idx[i], active_idx[j]);
+                BtB.diagonal().array() += P.lambda_min_norm;
+                BtB.template selfadjointView<Eigen::Lower>().llt().solveInPlace (l_active);
+
+                // update lambda values in full vector
+                // and identify worst offender if any lambda < 0
+                // by projection from previous onto feasible
+                // subset (i.e. l>=0):
+                value_type s_min = std::numeric_limits<value_type>::infinity();
+                size_t s_min_index = 0;
+                size_t a = 0;
+                for (size_t n = 0; n < active.size(); ++n) {
+                  if (active[n]) {
+                    if (l_active[a] < 0.0) {
+                      value_type s = lambda_prev[n] / (lambda_prev[n] - l_active[a]);
+                      if (s < s_min) {
+                        s_min = s;
+                        s_min_index = n;
+                      }
+                    }
+                    lambda[n] = l_active[a];
+                    ++a;
+                  }
+                  else
+                    lambda[n] = 0.0;
+                }
+
+                // if no lambda < 0, proceed:
+                if (!std::isfinite (s_min)) {
+                  // update solution vector:
+                  x = y_u + B_active.transpose() * l_active;
+                  return active_set_changed;
+                }
+
+                // remove worst offending lambda from active set,
+                // and re-estimate remaining lambdas:
+                if (active[s_min_index])
+                  active_set_changed = true;
+                active[s_min_index] = false;
+              }
+            }
         };
 
 
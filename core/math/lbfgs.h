@@ -0,0 +1,292 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __math_lbfgs_h__
+#define __math_lbfgs_h__
+
+#include <deque>
+#include <limits>
+
+#include "math/gradient_descent.h"
+
+namespace MR
+{
+  namespace Math
+  {
+
+    //! \addtogroup Optimisation
+    // @{
+
+    //! Computes the minimum of a function using the L-BFGS quasi-Newton method.
+    /*! Limited-memory BFGS maintains a short history of parameter and
+     * gradient displacements, from which an approximation to the inverse
+     * Hessian is applied to the gradient via the standard two-loop
+     * recursion; step lengths are chosen by a Wolfe line search. Because
+     * curvature information accumulates across iterations, far fewer
+     * function evaluations are typically required to converge than with
+     * (Barzilai-Borwein) gradient descent - a substantial saving when each
+     * evaluation is a full pass over the image data, as in registration.
+     *
+     * The interface matches GradientDescent / GradientDescentBB, so the
+     * three can be used interchangeably. */
+    template <class Function, class UpdateFunctor=LinearUpdate>
+      class LBFGS
+      { MEMALIGN(LBFGS<Function,UpdateFunctor>)
+        public:
+          using value_type = typename Function::value_type;
+          using vector_type = Eigen::Matrix<value_type, Eigen::Dynamic, 1>;
+
+          LBFGS (Function& function, UpdateFunctor update_functor = LinearUpdate(), size_t history_size = 5, bool verbose = false) :
+            func (function),
+            update_func (update_functor),
+            history_size (history_size),
+            verbose (verbose),
+            delim (","),
+            niter (0),
+            x (func.size()),
+            x2 (func.size()),
+            g (func.size()),
+            g2 (func.size()),
+            d (func.size()),
+            nfeval (0) { }
+
+
+          value_type value () const throw () { return f; }
+          const vector_type& state () const throw () { return x; }
+          const vector_type& gradient () const throw ()  { return g; }
+          value_type step_size () const { return dt; }
+          value_type gradient_norm () const throw () { return normg; }
+          int function_evaluations () const throw () { return nfeval; }
+
+          void be_verbose (bool v) { verbose = v; }
+          void precondition (const vector_type& weights) {
+            preconditioner_weights = weights;
+          }
+
+          void run (const size_t max_iterations = 1000,
+            const value_type grad_tolerance = 1e-6,
+            std::streambuf* log_stream = nullptr) {
+            std::ostream log_os(log_stream? log_stream : nullptr);
+            if (log_os){
+              log_os << "#iteration" << delim << "feval" << delim << "cost" << delim << "stepsize";
+              for ( ssize_t a = 0 ; a < x.size() ; a++ )
+                  log_os << delim + "x_" + str(a+1) ;
+              for ( ssize_t a = 0 ; a < x.size() ; a++ )
+                  log_os << delim + "g_" + str(a+1) ;
+              log_os << "\n" << std::flush;
+            }
+            init (log_os);
+
+            const value_type gradient_tolerance (grad_tolerance * normg);
+
+            DEBUG ("L-BFGS iteration: init; cost: " + str(f));
+
+            while (niter < max_iterations) {
+              bool retval = iterate (log_os);
+              DEBUG ("L-BFGS iteration: " + str(niter) + "; cost: " + str(f));
+              if (verbose) {
+                CONSOLE ("iteration " + str (niter) + ": f = " + str (f) + ", |g| = " + str (normg) + ":");
+                CONSOLE ("  x = [ " + str(x.transpose()) + "]");
+              }
+
+              if (normg < gradient_tolerance) {
+                if (verbose)
+                  CONSOLE ("normg (" + str(normg) + ") < gradient tolerance (" + str(gradient_tolerance) + ")");
+                return;
+              }
+
+              if (!retval){
+                if (verbose)
+                  CONSOLE ("unchanged parameters");
+                return;
+              }
+            }
+          }
+
+          void init () {
+            std::ostream dummy (nullptr);
+            init (dummy);
+          }
+
+          void init (std::ostream& log_os) {
+            dt = func.init (x);
+            nfeval = 0;
+            niter = 0;
+            displacements.clear();
+            gradient_changes.clear();
+            rho.clear();
+            f = evaluate_func (x, g, verbose);
+            normg = g.norm();
+            assert (std::isfinite (f));
+            assert (std::isfinite (normg));
+            if (verbose) {
+              CONSOLE ("initialise: f = " + str (f) + ", |g| = " + str (normg) + ":");
+              CONSOLE ("  x = [ " + str(x.transpose()) + "]");
+            }
+            if (log_os) {
+              log_os << niter << delim << nfeval << delim << str(f) << delim << str(dt);
+              for (ssize_t i=0; i< x.size(); ++i){ log_os << delim << str(x(i)); }
+              for (ssize_t i=0; i< x.size(); ++i){ log_os << delim << str(g(i)); }
+              log_os << std::endl;
+            }
+          }
+
+          bool iterate () {
+            std::ostream dummy (nullptr);
+            return iterate (dummy);
+          }
+
+          bool iterate (std::ostream& log_os) {
+            assert (std::isfinite (normg));
+            if (normg == 0.0)
+              return false;
+
+            compute_direction ();
+
+            value_type dg = d.dot (g);
+            if (dg >= 0.0) {
+              // not a descent direction (stale curvature information):
+              // drop the history and restart along the steepest descent
+              displacements.clear();
+              gradient_changes.clear();
+              rho.clear();
+              d = -g;
+              dg = d.dot (g);
+            }
+
+            // Wolfe line search: unit step first (the natural quasi-Newton
+            // step), bracketing by bisection on failure; the first
+            // iteration has no curvature information, so scale as
+            // GradientDescent does
+            value_type step = displacements.empty() ? dt / normg : value_type (1.0);
+            value_type lo = 0.0, hi = 0.0;
+            bool accepted = false;
+            value_type f2 = f;
+
+            for (size_t attempt = 0; attempt < MAX_LINE_SEARCH_EVALUATIONS; ++attempt) {
+              negd = -d;
+              if (!update_func (x2, x, negd, step))
+                return false;
+              f2 = evaluate_func (x2, g2, verbose);
+
+              if (f2 > f + ARMIJO_CONSTANT * step * dg) {
+                // insufficient decrease: contract
+                hi = step;
+                step = 0.5 * (lo + hi);
+              }
+              else if (g2.dot (d) < CURVATURE_CONSTANT * dg) {
+                // decrease sufficient but curvature condition failed:
+                // the step is too short; extend
+                lo = step;
+                step = hi > 0.0 ? 0.5 * (lo + hi) : 2.0 * step;
+              }
+              else {
+                accepted = true;
+                break;
+              }
+
+              if (step <= 0.0 || !std::isfinite (step))
+                return false;
+            }
+
+            if (!accepted && f2 >= f)
+              return false;
+
+            // update the curvature history with this displacement
+            vector_type s = x2 - x;
+            vector_type y = g2 - g;
+            const value_type ys = y.dot (s);
+            if (ys > 0.0) {
+              // only curvature pairs with positive y's preserve positive
+              // definiteness of the inverse Hessian approximation
+              displacements.push_back (std::move (s));
+              gradient_changes.push_back (std::move (y));
+              rho.push_back (1.0 / ys);
+              if (displacements.size() > history_size) {
+                displacements.pop_front();
+                gradient_changes.pop_front();
+                rho.pop_front();
+              }
+            }
+
+            ++niter;
+            dt = step;
+            f = f2;
+            x.swap (x2);
+            g.swap (g2);
+            normg = g.norm();
+            if (log_os) {
+              log_os << niter << delim << nfeval << delim << str(f) << delim << str(dt);
+              for (ssize_t i=0; i< x.size(); ++i){ log_os << delim << str(x(i)); }
+              for (ssize_t i=0; i< x.size(); ++i){ log_os << delim << str(g(i)); }
+              log_os << std::endl;
+            }
+            return true;
+          }
+
+        protected:
+          static constexpr value_type ARMIJO_CONSTANT = 1.0e-4;
+          static constexpr value_type CURVATURE_CONSTANT = 0.9;
+          static constexpr size_t MAX_LINE_SEARCH_EVALUATIONS = 20;
+
+          Function& func;
+          UpdateFunctor update_func;
+          const size_t history_size;
+          bool verbose;
+          std::string delim;
+          size_t niter;
+          vector_type x, x2, g, g2, d, negd, preconditioner_weights;
+          std::deque<vector_type> displacements, gradient_changes;
+          std::deque<value_type> rho;
+          value_type f, dt, normg;
+          size_t nfeval;
+
+          //! apply the inverse Hessian approximation to the gradient
+          //! via the standard two-loop recursion
+          void compute_direction () {
+            d = -g;
+            const size_t m = displacements.size();
+            if (!m)
+              return;
+            vector_type alpha (m);
+            for (size_t i = m; i-- != 0; ) {
+              alpha[i] = rho[i] * displacements[i].dot (d);
+              d -= alpha[i] * gradient_changes[i];
+            }
+            // initial inverse Hessian scaling from the most recent pair
+            d *= 1.0 / (rho[m-1] * gradient_changes[m-1].squaredNorm());
+            for (size_t i = 0; i < m; ++i) {
+              const value_type beta = rho[i] * gradient_changes[i].dot (d);
+              d += (alpha[i] - beta) * displacements[i];
+            }
+          }
+
+          value_type evaluate_func (const vector_type& newx, vector_type& newg, bool verbose = false) {
+            nfeval++;
+            value_type cost = func (newx, newg);
+            if (!std::isfinite (cost))
+              throw Exception ("cost function is NaN or Inf!");
+            if (preconditioner_weights.size())
+              newg.array() *= preconditioner_weights.array();
+            if (verbose)
+              CONSOLE ("      << eval " + str(nfeval) + ", f = " + str (cost) + " >>");
+            return cost;
+          }
+
+      };
+    //! @}
+  }
+}
+
+#endif
@@ -122,6 +122,75 @@ namespace MR
 
 
 
+      //! precomputed recurrence coefficients for Plm_sph()
+      /*! The three-term recurrence in Plm_sph() computes a square root and a
+       * division per (l,m) term, which dominates the cost of exact
+       * per-direction SH evaluation. This class caches those factors for all
+       * (l,m) up to a given harmonic order, reducing each evaluation to the
+       * multiply-add operations of the recurrence itself, which the compiler
+       * is then free to vectorise. */
+      template <typename ValueType> class PrecomputedPlm
+      { MEMALIGN (PrecomputedPlm<ValueType>)
+        public:
+          PrecomputedPlm () : lmax (-1) { }
+          PrecomputedPlm (const int up_to_lmax) {
+            init (up_to_lmax);
+          }
+
+          bool operator! () const {
+            return lmax < 0;
+          }
+          operator bool () const {
+            return lmax >= 0;
+          }
+
+          void init (const int up_to_lmax) {
+            lmax = up_to_lmax;
+            cm.resize (lmax+1);
+            coef_a.resize (lmax+1, lmax+1);
+            coef_b.resize (lmax+1, lmax+1);
+            for (int m = 0; m <= lmax; ++m) {
+              cm[m] = 0.282094791773878;
+              if (m) cm[m] *= std::sqrt (ValueType (2*m+1) * Plm_sph_helper (ValueType (1.0), ValueType (2.0*m)));
+              if (m & 1) cm[m] = -cm[m];
+              ValueType f = std::sqrt (ValueType (2*m+3));
+              if (m+1 <= lmax)
+                coef_a (m+1, m) = f;
+              for (int n = m+2; n <= lmax; ++n) {
+                const ValueType f_next = std::sqrt (ValueType (4*pow2 (n)-1) / ValueType (pow2 (n)-pow2 (m)));
+                coef_a (n, m) = f_next;
+                coef_b (n, m) = f_next / f;
+                f = f_next;
+              }
+            }
+          }
+
+          int order () const { return lmax; }
+
+          //! evaluate the functions of order \a m at \a x = cos(elevation)
+          /*! equivalent to Plm_sph (array, lmax, m, x), with \a
+           * pow_sin_elevation holding sin(elevation) raised to the power \a m
+           * (most cheaply maintained as a running product when iterating over
+           * m, as in SH::value()). */
+          template <class VectorType>
+            void operator() (VectorType& array, const int m, const ValueType x, const ValueType pow_sin_elevation) const {
+              assert (m <= lmax);
+              array[m] = cm[m] * pow_sin_elevation;
+              if (lmax == m)
+                return;
+              array[m+1] = coef_a (m+1, m) * x * array[m];
+              for (int n = m+2; n <= lmax; ++n)
+                array[n] = coef_a (n, m) * x * array[n-1] - coef_b (n, m) * array[n-2];
+            }
+
+        protected:
+          int lmax;
+          Eigen::Matrix<ValueType, Eigen::Dynamic, 1> cm;
+          Eigen::Matrix<ValueType, Eigen::Dynamic, Eigen::Dynamic> coef_a, coef_b;
+      };
+
+
+
       //* compute derivatives of normalised associated Legendre functions
       /** \note this function expects the previously computed array of associated Legendre functions to be stored in \a array,
        * (as computed by Plm_sph (VectorType& array, const int lmax, const int m, const ValueType x))
@@ -56,6 +56,16 @@ namespace MR
           return current_seed++;
         }
 
+        //! the fixed process-wide seed, as used by counter-based generators
+        /*! unlike get_seed(), repeated calls return the same value, so that
+         * generators keyed by a (seed, stream) pair are reproducible
+         * irrespective of how many other generators have been constructed
+         * beforehand. */
+        static std::mt19937::result_type get_fixed_seed () {
+          static const std::mt19937::result_type seed = get_seed_private();
+          return seed;
+        }
+
       private:
         static std::mt19937::result_type get_seed_private () {
           const char* from_env = getenv ("MRTRIX_RNG_SEED");
@@ -77,6 +87,85 @@ namespace MR
     };
 
 
+    //! counter-based random number generator
+    /*! implements the Philox-4x32-10 keyed counter-based generator of
+     * Salmon et al. (SC'11). Rather than carrying a large mutable state as
+     * std::mt19937 does, each 128-bit output block is computed directly from
+     * a (seed, stream, counter) triplet, so the value drawn for a given
+     * position in a given stream is identical irrespective of the number of
+     * threads in use or the order in which generators were constructed.
+     * The per-draw cost is a handful of 32x32->64-bit multiplies and XORs,
+     * cheaper than the Mersenne Twister's state update in tight loops.
+     *
+     * The default constructor keys the generator using the same seed for
+     * all instances within the process (honouring the MRTRIX_RNG_SEED
+     * environment variable); callers are expected to assign each logical
+     * stream of draws a distinct stream index via the constructor or
+     * set_stream(). This class satisfies the C++11
+     * UniformRandomBitGenerator concept, and can therefore be used with
+     * the standard distributions. */
+    class PhiloxRNG { NOMEMALIGN
+      public:
+        using result_type = uint32_t;
+
+        PhiloxRNG (const uint64_t stream = 0) :
+            key0 (uint32_t (RNG::get_fixed_seed())),
+            key1 (uint32_t (uint64_t (RNG::get_fixed_seed()) >> 32)) {
+          set_stream (stream);
+        }
+        PhiloxRNG (const uint64_t seed, const uint64_t stream) :
+            key0 (uint32_t (seed)),
+            key1 (uint32_t (seed >> 32)) {
+          set_stream (stream);
+        }
+
+        //! select the stream of draws; also resets the counter to zero
+        void set_stream (const uint64_t stream) {
+          stream0 = uint32_t (stream);
+          stream1 = uint32_t (stream >> 32);
+          counter = 0;
+          available = 0;
+        }
+
+        static constexpr result_type min () { return 0u; }
+        static constexpr result_type max () { return 0xFFFFFFFFu; }
+
+        result_type operator() () {
+          if (!available)
+            generate();
+          return block[4 - available--];
+        }
+
+      private:
+        uint32_t key0, key1, stream0, stream1;
+        uint64_t counter;
+        uint32_t block[4];
+        int available;
+
+        void generate () {
+          uint32_t c0 = uint32_t (counter), c1 = uint32_t (counter >> 32);
+          uint32_t c2 = stream0, c3 = stream1;
+          uint32_t k0 = key0, k1 = key1;
+          for (int round = 0; ; ++round) {
+            const uint64_t p0 = uint64_t (0xD2511F53u) * c0;
+            const uint64_t p1 = uint64_t (0xCD9E8D57u) * c2;
+            const uint32_t t1 = c1, t3 = c3;
+            c0 = uint32_t (p1 >> 32) ^ t1 ^ k0;
+            c1 = uint32_t (p1);
+            c2 = uint32_t (p0 >> 32) ^ t3 ^ k1;
+            c3 = uint32_t (p0);
+            if (round == 9)
+              break;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+          }
+          block[0] = c0; block[1] = c1; block[2] = c2; block[3] = c3;
+          ++counter;
+          available = 4;
+        }
+    };
+
+
     template <typename ValueType>
       class RNG::Uniform { NOMEMALIGN
         public:
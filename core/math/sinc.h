@@ -17,6 +17,11 @@
 
 #include "math/math.h"
 
+// number of sub-voxel steps at which the windowed-sinc kernel weights are
+//   pre-evaluated; kernels at intermediate positions are obtained by
+//   linear interpolation between adjacent table rows
+#define SINC_KERNEL_TABLE_SIZE 512
+
 namespace MR
 {
   namespace Math
@@ -32,9 +37,47 @@ namespace MR
           max_offset_from_kernel_centre ((w-1) / 2),
           indices (w),
           weights (w),
+          table ((SINC_KERNEL_TABLE_SIZE+1) * w),
           current_pos (NAN)
         {
           assert (w % 2);
+          // pre-evaluate the (normalised) kernel over the range of
+          //   fractional offsets from the nearest voxel; the weights depend
+          //   on the query position only through this fraction:
+          for (size_t n = 0; n <= SINC_KERNEL_TABLE_SIZE; ++n) {
+            const value_type frac = (value_type(n) / value_type(SINC_KERNEL_TABLE_SIZE)) - 0.5;
+            value_type* const row = &table[n * window_size];
+            value_type sum_weights = 0.0;
+
+            for (size_t i = 0; i != window_size; ++i) {
+
+              const value_type offset = frac + value_type(max_offset_from_kernel_centre) - value_type(i);
+
+              const value_type sinc   = offset ? std::sin (Math::pi * offset) / (Math::pi * offset) : 1.0;
+
+              //const value_type hann_cos_term = Math::pi * offset / (value_type(max_offset_from_kernel_centre) + 0.5);
+              //const value_type hann_factor   = (std::abs (hann_cos_term) < Math::pi) ? 0.5 * (1.0 + std::cos (hann_cos_term)) : 0.0;
+              //const value_type this_weight   = hann_factor * sinc;
+
+              const value_type lanczos_sinc_term = std::abs (Math::pi * offset / (double(max_offset_from_kernel_centre) + 0.5));
+              value_type lanczos_factor = 0.0;
+              if (lanczos_sinc_term < Math::pi) {
+                if (lanczos_sinc_term)
+                  lanczos_factor = std::sin (lanczos_sinc_term) / lanczos_sinc_term;
+                else
+                  lanczos_factor = 1.0;
+              }
+              const value_type this_weight = lanczos_factor * sinc;
+
+              row[i]       = this_weight;
+              sum_weights += this_weight;
+
+            }
+
+            const value_type normalisation = 1.0 / sum_weights;
+            for (size_t i = 0; i != window_size; ++i)
+              row[i] *= normalisation;
+          }
         }
 
         template <class ImageType>
@@ -44,10 +87,8 @@ namespace MR
             return;
 
           const int kernel_centre = std::round (position);
-          value_type sum_weights = 0.0;
 
           for (size_t i = 0; i != window_size; ++i) {
-
             const int voxel = kernel_centre - max_offset_from_kernel_centre + i;
             if (voxel < 0)
               indices[i] = -voxel - 1;
@@ -55,33 +96,18 @@ namespace MR
               indices[i] = (2 * int(image.size (axis))) - voxel - 1;
             else
               indices[i] = voxel;
-
-            const value_type offset = position - (value_type)voxel;
-
-            const value_type sinc   = offset ? std::sin (Math::pi * offset) / (Math::pi * offset) : 1.0;
-
-            //const value_type hann_cos_term = Math::pi * offset / (value_type(max_offset_from_kernel_centre) + 0.5);
-            //const value_type hann_factor   = (std::abs (hann_cos_term) < Math::pi) ? 0.5 * (1.0 + std::cos (hann_cos_term)) : 0.0;
-            //const value_type this_weight   = hann_factor * sinc;
-
-            const value_type lanczos_sinc_term = std::abs (Math::pi * offset / (double(max_offset_from_kernel_centre) + 0.5));
-            value_type lanczos_factor = 0.0;
-            if (lanczos_sinc_term < Math::pi) {
-              if (lanczos_sinc_term)
-                lanczos_factor = std::sin (lanczos_sinc_term) / lanczos_sinc_term;
-              else
-                lanczos_factor = 1.0;
-            }
-            const value_type this_weight = lanczos_factor * sinc;
-
-            weights[i]  =  this_weight;
-            sum_weights += this_weight;
-
           }
 
-          const value_type normalisation = 1.0 / sum_weights;
+          // look up the kernel from the precomputed table, interpolating
+          //   linearly between the two nearest rows; each row is normalised,
+          //   so any convex combination of adjacent rows is too:
+          const value_type f = std::max (value_type ((position - value_type(kernel_centre) + 0.5) * value_type(SINC_KERNEL_TABLE_SIZE)), value_type(0.0));
+          const size_t n = std::min (size_t (std::floor (f)), size_t (SINC_KERNEL_TABLE_SIZE-1));
+          const value_type mu = f - value_type(n);
+          const value_type* const row = &table[n * window_size];
+          const value_type* const next = row + window_size;
           for (size_t i = 0; i != window_size; ++i)
-            weights[i] *= normalisation;
+            weights[i] = row[i] + mu * (next[i] - row[i]);
 
           current_pos = position;
 
@@ -124,6 +150,7 @@ namespace MR
         const size_t window_size, max_offset_from_kernel_centre;
         vector<size_t> indices;
         vector<value_type> weights;
+        vector<value_type> table;
         value_type  current_pos;
 
     };
@@ -47,7 +47,7 @@ namespace MR
         void ttest (matrix_type& tvalues,
                     const matrix_type& design,
                     const matrix_type& pinv_design,
-                    const matrix_type& measurements,
+                    const Eigen::Ref<const matrix_type>& measurements,
                     const matrix_type& scaled_contrasts,
                     matrix_type& betas,
                     matrix_type& residuals)
@@ -110,7 +110,6 @@ namespace MR
       void GLMTTest::operator() (const vector<size_t>& perm_labelling, vector_type& stats) const
       {
         stats = vector_type::Zero (y.rows());
-        matrix_type tvalues, betas, residuals, SX, pinvSX;
 
         SX.resize (X.rows(), X.cols());
         pinvSX.resize (pinvX.rows(), pinvX.cols());
@@ -122,8 +121,9 @@ namespace MR
         pinvSX.transposeInPlace();
         SX.transposeInPlace();
         for (ssize_t i = 0; i < y.rows(); i += GLM_BATCH_SIZE) {
-          const matrix_type tmp = y.block (i, 0, std::min (GLM_BATCH_SIZE, (int)(y.rows()-i)), y.cols());
-          GLM::ttest (tvalues, SX, pinvSX, tmp, scaled_contrasts, betas, residuals);
+          // mapping the block of the shared data matrix directly into the
+          //   GEMM avoids copying it once per permutation:
+          GLM::ttest (tvalues, SX, pinvSX, y.middleRows (i, std::min (GLM_BATCH_SIZE, (int)(y.rows()-i))), scaled_contrasts, betas, residuals);
           for (ssize_t n = 0; n < tvalues.rows(); ++n) {
             value_type val = tvalues(n,0);
             if (!std::isfinite (val))
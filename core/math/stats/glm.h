@@ -47,7 +47,7 @@ namespace MR
         void ttest (matrix_type& tvalues,
                     const matrix_type& design,
                     const matrix_type& pinv_design,
-                    const matrix_type& measurements,
+                    const Eigen::Ref<const matrix_type>& measurements,
                     const matrix_type& scaled_contrasts,
                     matrix_type& betas,
                     matrix_type& residuals);
@@ -123,6 +123,10 @@ namespace MR
         protected:
           const matrix_type& y;
           matrix_type X, pinvX, scaled_contrasts;
+          // scratch buffers for operator(); each thread holds its own copy
+          //   of this class, so these can be re-used across permutations
+          //   without any allocation in the inner loop:
+          mutable matrix_type SX, pinvSX, tvalues, betas, residuals;
       };
       //! @}
 
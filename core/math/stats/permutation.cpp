@@ -12,8 +12,11 @@
  */
 
 
+#include <unordered_set>
+
 #include "math/stats/permutation.h"
 #include "math/math.h"
+#include "math/rng.h"
 
 namespace MR
 {
@@ -49,6 +52,23 @@ namespace MR
 
 
 
+        namespace {
+
+          // hash functor allowing previously-generated shuffles to be looked
+          //   up in an unordered_set, rather than linearly scanned
+          struct LabellingHash { NOMEMALIGN
+            size_t operator() (const vector<size_t>& labelling) const {
+              size_t hash = labelling.size();
+              for (const auto i : labelling)
+                hash ^= i + 0x9e3779b97f4a7c15u + (hash << 6) + (hash >> 2);
+              return hash;
+            }
+          };
+
+        }
+
+
+
         void generate (const size_t num_perms,
                        const size_t num_subjects,
                        vector<vector<size_t> >& permutations,
@@ -58,16 +78,23 @@ namespace MR
           vector<size_t> default_labelling (num_subjects);
           for (size_t i = 0; i < num_subjects; ++i)
             default_labelling[i] = i;
+          // duplicate detection via hashed lookup: constant-time per
+          //   candidate shuffle, rather than a scan over all those generated
+          //   previously
+          std::unordered_set<vector<size_t>, LabellingHash> previous;
+          previous.reserve (num_perms);
+          Math::RNG rng;
           size_t p = 0;
           if (include_default) {
             permutations.push_back (default_labelling);
+            previous.insert (default_labelling);
             ++p;
           }
           for (;p < num_perms; ++p) {
             vector<size_t> permuted_labelling (default_labelling);
             do {
-              std::random_shuffle (permuted_labelling.begin(), permuted_labelling.end());
-            } while (is_duplicate (permuted_labelling, permutations));
+              std::shuffle (permuted_labelling.begin(), permuted_labelling.end(), rng);
+            } while (!previous.insert (permuted_labelling).second);
             permutations.push_back (permuted_labelling);
           }
         }
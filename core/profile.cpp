@@ -0,0 +1,93 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "profile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace MR
+{
+  namespace Profile
+  {
+
+    bool enabled = false;
+
+
+    namespace {
+
+      // Construct-on-first-use, since Region instances are function-local
+      //   statics and may register from any translation unit during
+      //   static or dynamic initialisation
+      std::mutex& registry_mutex () {
+        static std::mutex mutex;
+        return mutex;
+      }
+
+      vector<Region*>& registry () {
+        static vector<Region*> regions;
+        return regions;
+      }
+
+      // Written directly to stderr rather than through the console
+      //   machinery, since this runs from an at-exit handler
+      void print_report ()
+      {
+        std::map< std::string, std::pair<uint64_t, uint64_t> > totals;
+        {
+          std::lock_guard<std::mutex> lock (registry_mutex());
+          for (const Region* region : registry()) {
+            auto& entry = totals[region->name];
+            entry.first += region->count.load();
+            entry.second += region->nanoseconds.load();
+          }
+        }
+        fprintf (stderr, "mrtrix profile:\n");
+        for (const auto& entry : totals) {
+          const uint64_t count = entry.second.first;
+          const double seconds = entry.second.second * 1.0e-9;
+          if (count)
+            fprintf (stderr, "  %s: %llu calls, %.3f s total, %.3f ms per call\n",
+                entry.first.c_str(), (unsigned long long) count, seconds, 1.0e3 * seconds / count);
+        }
+      }
+
+    }
+
+
+    Region::Region (const char* name) :
+        name (name),
+        count (0),
+        nanoseconds (0)
+    {
+      std::lock_guard<std::mutex> lock (registry_mutex());
+      registry().push_back (this);
+    }
+
+
+    void init ()
+    {
+      const char* env = getenv ("MRTRIX_PROFILE");
+      enabled = env && *env;
+      if (enabled)
+        std::atexit (print_report);
+    }
+
+
+  }
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __profile_h__
+#define __profile_h__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "types.h"
+
+namespace MR
+{
+
+  /*! \brief lightweight opt-in instrumentation of the major processing stages
+   *
+   * When the MRTRIX_PROFILE environment variable is set to a non-empty
+   * string, scoped timers accumulate the wall-clock time spent within each
+   * annotated region, and a per-region breakdown is printed to the standard
+   * error stream when the command exits - allowing slow runs to be
+   * diagnosed from logs alone, without attaching an external profiler.
+   * When the variable is not set, the only cost of an annotated region is
+   * a test of a global flag.
+   *
+   * To annotate a region, place at the top of the relevant scope:
+   * \code
+   * PROFILE ("name of region");
+   * \endcode
+   * Regions sharing a name (e.g. multiple instantiations of the same
+   * template) are aggregated into a single entry in the report. All
+   * counters are atomic, so regions may be entered concurrently from
+   * multiple threads; times reported are summed across threads. */
+  namespace Profile
+  {
+
+    extern bool enabled;
+
+    //! per-call-site accumulator; declared as a function-local static by PROFILE()
+    class Region { NOMEMALIGN
+      public:
+        Region (const char* name);
+        const char* const name;
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> nanoseconds;
+    };
+
+    //! scoped timer adding its own lifetime to a Region
+    class Scope { NOMEMALIGN
+      public:
+        Scope (Region& region) : region (enabled ? &region : nullptr) {
+          if (this->region)
+            from = std::chrono::high_resolution_clock::now();
+        }
+        ~Scope () {
+          if (region) {
+            const uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::high_resolution_clock::now() - from).count();
+            region->nanoseconds.fetch_add (elapsed, std::memory_order_relaxed);
+            region->count.fetch_add (1, std::memory_order_relaxed);
+          }
+        }
+      private:
+        Region* const region;
+        std::chrono::high_resolution_clock::time_point from;
+    };
+
+    //! check the environment & install the at-exit report; invoked from App::init()
+    void init ();
+
+  }
+}
+
+#define PROFILE(name) \
+  static ::MR::Profile::Region __profile_region (name); \
+  ::MR::Profile::Scope __profile_scope (__profile_region)
+
+#endif
@@ -38,8 +38,9 @@ namespace MR
       ProgressInfo (ProgressInfo&& p) = delete; 
 
       FORCE_INLINE ProgressInfo (const std::string& text, size_t target, bool display_immediately = true) :
-        value (0), text (text), ellipsis ("... "), 
-        current_val (0), next_percent (0), next_time (0.0), multiplier (0.0), 
+        value (0), text (text), ellipsis ("... "),
+        current_val (0), next_percent (0), next_time (0.0), multiplier (0.0),
+        check_every (1), until_next_check (1), last_check_time (0.0),
         text_has_been_modified (false), data (nullptr) {
           set_max (target, display_immediately);
         }
@@ -75,6 +76,17 @@ namespace MR
       /*! if zero, the progressbar is used as a busy indicator */
       float multiplier;
 
+      //! number of increments between clock reads
+      /*! time-based updates only need the clock often enough to refresh
+       * the display every BUSY_INTERVAL; this is adapted to the observed
+       * increment rate so that tight per-item loops do not pay for a
+       * clock read on every increment. */
+      size_t check_every;
+      //! increments remaining until the next clock read
+      size_t until_next_check;
+      //! time of the last clock read, used to adapt \c check_every
+      double last_check_time;
+
       //! used for busy indicator.
       Timer timer;
 
@@ -116,32 +128,47 @@ namespace MR
 	}
       }
 
+      //! read the clock, and adapt the sampling rate to the increment rate
+      FORCE_INLINE double sample_time () {
+        const double time = timer.elapsed();
+        const double since_check = time - last_check_time;
+        last_check_time = time;
+        if (since_check < 0.5 * BUSY_INTERVAL)
+          check_every = std::min (2 * check_every, size_t (1) << 20);
+        else if (since_check > 2.0 * BUSY_INTERVAL && check_every > 1)
+          check_every /= 2;
+        until_next_check = check_every;
+        return time;
+      }
+
       //! update text displayed and optionally increment counter
-      template <class TextFunc> 
+      template <class TextFunc>
         FORCE_INLINE void update (TextFunc&& text_func, const bool increment = true) {
-          double time = timer.elapsed();
           if (increment && multiplier) {
             if (++current_val >= next_percent) {
               set_text (text_func());
               ellipsis.clear();
               value = std::round (current_val / multiplier);
               next_percent = std::ceil ((value+1) * multiplier);
-              next_time = time;
+              next_time = timer.elapsed();
               display_now();
               return;
             }
           }
-          if (time >= next_time) {
-            set_text (text_func());
-            ellipsis.clear();
-            if (multiplier)
-              next_time = time + BUSY_INTERVAL;
-            else {
-              value = time / BUSY_INTERVAL;
-              do { next_time += BUSY_INTERVAL; }
-              while (next_time <= time);
+          if (!--until_next_check) {
+            const double time = sample_time();
+            if (time >= next_time) {
+              set_text (text_func());
+              ellipsis.clear();
+              if (multiplier)
+                next_time = time + BUSY_INTERVAL;
+              else {
+                value = time / BUSY_INTERVAL;
+                do { next_time += BUSY_INTERVAL; }
+                while (next_time <= time);
+              }
+              display_now();
             }
-            display_now();
           }
         }
 
@@ -158,8 +185,8 @@ namespace MR
             display_now();
           }
         }
-        else {
-          double time = timer.elapsed();
+        else if (!--until_next_check) {
+          const double time = sample_time();
           if (time >= next_time) {
             value = time / BUSY_INTERVAL;
             do { next_time += BUSY_INTERVAL; }
@@ -173,6 +200,23 @@ namespace MR
         ++ (*this);
       }
 
+      //! increment the current value by \a n
+      /*! allows worker threads to accumulate progress in thread-local
+       * counters and flush them in batches, rather than updating the
+       * shared ProgressBar once per item. */
+      FORCE_INLINE void operator+= (size_t n) {
+        if (multiplier) {
+          current_val += n;
+          if (current_val >= next_percent) {
+            value = std::round (current_val / multiplier);
+            next_percent = std::ceil ((value+1) * multiplier);
+            display_now();
+          }
+        }
+        else
+          ++(*this);
+      }
+
       static void (*display_func) (ProgressInfo& p);
       static void (*done_func) (ProgressInfo& p);
 
@@ -295,6 +339,15 @@ namespace MR
         ++ (*this);
       }
 
+      //! increment the current value by \a n (batched updates)
+      FORCE_INLINE void operator+= (size_t n) {
+        if (show) {
+          if (!prog)
+            prog = std::unique_ptr<ProgressInfo> (new ProgressInfo (text, target));
+          (*prog) += n;
+        }
+      }
+
       FORCE_INLINE void done () {
         prog.reset();
       }
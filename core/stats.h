@@ -38,7 +38,7 @@ namespace MR
       public:
         Stats (const bool is_complex = false, const bool ignorezero = false) :
             mean (0.0, 0.0),
-            std (0.0, 0.0),
+            m2 (0.0, 0.0),
             min (INFINITY, INFINITY),
             max (-INFINITY, -INFINITY),
             count (0),
@@ -48,25 +48,48 @@ namespace MR
 
         void operator() (complex_type val) {
           if (std::isfinite (val.real()) && std::isfinite (val.imag()) && !(ignore_zero && val.real() == 0.0 && val.imag() == 0.0)) {
-            mean += val;
-            std += cdouble (val.real()*val.real(), val.imag()*val.imag());
+            // Welford's online algorithm: avoids the cancellation error of
+            //   the sum & sum-of-squares formulation when the spread of the
+            //   data is small relative to the mean
+            count++;
+            const double delta_real = val.real() - mean.real();
+            const double delta_imag = val.imag() - mean.imag();
+            mean += cdouble (delta_real / double(count), delta_imag / double(count));
+            m2 += cdouble (delta_real * (val.real() - mean.real()), delta_imag * (val.imag() - mean.imag()));
             if (min.real() > val.real()) min = complex_type (val.real(), min.imag());
             if (min.imag() > val.imag()) min = complex_type (min.real(), val.imag());
             if (max.real() < val.real()) max = complex_type (val.real(), max.imag());
             if (max.imag() < val.imag()) max = complex_type (max.real(), val.imag());
-            count++;
             if (!is_complex)
               values.push_back(val.real());
           }
         }
 
+        //! combine the accumulated statistics of another Stats into this one
+        /*! used to merge per-thread accumulators following a multi-threaded
+         * pass over the image; must be invoked before print() */
+        void merge (const Stats& that) {
+          if (!that.count)
+            return;
+          const size_t total = count + that.count;
+          const double delta_real = that.mean.real() - mean.real();
+          const double delta_imag = that.mean.imag() - mean.imag();
+          const double weight = double(count) * double(that.count) / double(total);
+          mean = (mean * double(count) + that.mean * double(that.count)) / double(total);
+          m2 += that.m2 + cdouble (delta_real*delta_real*weight, delta_imag*delta_imag*weight);
+          if (min.real() > that.min.real()) min = complex_type (that.min.real(), min.imag());
+          if (min.imag() > that.min.imag()) min = complex_type (min.real(), that.min.imag());
+          if (max.real() < that.max.real()) max = complex_type (that.max.real(), max.imag());
+          if (max.imag() < that.max.imag()) max = complex_type (max.real(), that.max.imag());
+          count = total;
+          values.insert (values.end(), that.values.begin(), that.values.end());
+        }
+
         template <class ImageType> void print (ImageType& ima, const vector<std::string>& fields) {
 
-          if (count) {
-            mean /= double (count);
-            std = complex_type (sqrt (std.real()/double(count) - mean.real()*mean.real()),
-                sqrt (std.imag()/double(count) - mean.imag()*mean.imag()));
-          }
+          const complex_type std = count ?
+              complex_type (sqrt (m2.real()/double(count)), sqrt (m2.imag()/double(count))) :
+              complex_type (0.0, 0.0);
 
           std::sort (values.begin(), values.end());
 
@@ -117,7 +140,7 @@ namespace MR
         }
 
       private:
-        cdouble mean, std;
+        cdouble mean, m2;
         complex_type min, max;
         size_t count;
         const bool is_complex, ignore_zero;
@@ -15,6 +15,11 @@
 #include <thread>
 #include <atomic>
 
+#ifdef __linux__
+# include <pthread.h>
+# include <sched.h>
+#endif
+
 #include "app.h"
 #include "thread.h"
 #include "file/config.h"
@@ -57,6 +62,36 @@ namespace MR
 
 
 
+    //CONF option: PinThreads
+    //CONF default: 0 (false)
+    //CONF Pin each worker thread to a fixed logical CPU, assigned
+    //CONF round-robin across those available. On multi-socket systems this
+    //CONF prevents the OS from migrating threads away from the socket whose
+    //CONF memory they first touched, avoiding cross-socket reads for the
+    //CONF remainder of the run. Leave disabled when sharing nodes between
+    //CONF jobs, since the CPUs are chosen without regard to other processes.
+
+    void set_thread_affinity (const size_t index)
+    {
+#ifdef __linux__
+      static const bool enabled = File::Config::get_bool ("PinThreads", false);
+      if (!enabled)
+        return;
+      const size_t num_cpus = std::thread::hardware_concurrency();
+      if (!num_cpus)
+        return;
+      cpu_set_t cpuset;
+      CPU_ZERO (&cpuset);
+      CPU_SET (index % num_cpus, &cpuset);
+      if (pthread_setaffinity_np (pthread_self(), sizeof (cpu_set_t), &cpuset))
+        DEBUG ("unable to set affinity of worker thread " + str(index));
+#else
+      (void) index;
+#endif
+    }
+
+
+
 
 
     void (*__Backend::previous_print_func) (const std::string& msg) = nullptr;
@@ -102,6 +137,73 @@ namespace MR
     __Backend* __Backend::backend = nullptr;
     std::mutex __Backend::mutex;
 
+
+
+
+    thread_local bool __Pool::is_worker = false;
+
+    __Pool& __Pool::get ()
+    {
+      static __Pool pool;
+      return pool;
+    }
+
+    __Pool::~__Pool ()
+    {
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        shutdown = true;
+      }
+      task_available.notify_all();
+      for (auto& worker : workers)
+        worker.join();
+    }
+
+    bool __Pool::available () const
+    {
+      // a worker must never dispatch back into its own pool: with all
+      // workers potentially blocked on the nested loop, this would deadlock.
+      return !is_worker && number_of_threads() > 0;
+    }
+
+    bool __Pool::dispatch (vector<Task>& tasks_in)
+    {
+      std::unique_lock<std::mutex> dispatch_lock (dispatch_mutex, std::try_to_lock);
+      if (!dispatch_lock.owns_lock())
+        return false;
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        while (workers.size() < number_of_threads())
+          workers.push_back (std::thread (&__Pool::work, this, workers.size()));
+        tasks = &tasks_in;
+        next_task = 0;
+        remaining = tasks_in.size();
+      }
+      task_available.notify_all();
+      std::unique_lock<std::mutex> lock (mutex);
+      tasks_done.wait (lock, [this]{ return remaining == 0; });
+      tasks = nullptr;
+      return true;
+    }
+
+    void __Pool::work (const size_t index)
+    {
+      is_worker = true;
+      set_thread_affinity (index);
+      std::unique_lock<std::mutex> lock (mutex);
+      while (true) {
+        task_available.wait (lock, [this]{ return shutdown || (tasks && next_task < tasks->size()); });
+        if (shutdown)
+          return;
+        Task& task = (*tasks)[next_task++];
+        lock.unlock();
+        task();
+        lock.lock();
+        if (--remaining == 0)
+          tasks_done.notify_all();
+      }
+    }
+
   }
 }
 
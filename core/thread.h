@@ -18,6 +18,9 @@
 #include <thread>
 #include <future>
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
 
 #include "debug.h"
 #include "mrtrix.h"
@@ -221,6 +224,82 @@ namespace MR
     }
 
 
+    //! \cond skip
+
+    size_t number_of_threads ();
+
+    //! process-wide reusable worker thread pool
+    /*! Commands that execute many short-lived threaded loops pay the cost of
+     * spawning and joining a fresh set of std::threads for every loop. This
+     * pool keeps a set of warm worker threads alive for the lifetime of the
+     * process, so that successive loops can be dispatched without touching
+     * the OS thread machinery. It is used internally by ThreadedLoop(); other
+     * code should continue to use Thread::run() & Thread::run_queue(), whose
+     * threads may block on one another and must therefore never be funnelled
+     * through a fixed-size pool. */
+    class __Pool { NOMEMALIGN
+      public:
+        using Task = std::function<void()>;
+
+        static __Pool& get ();
+
+        //! run \a functor's execute() method across the worker threads
+        /*! This makes number_of_threads() copies of \a functor (mirroring the
+         * semantics of Thread::run (Thread::multi (functor))), and blocks
+         * until all have completed. Returns \c false if the pool cannot
+         * service the request (re-entrant use from one of its own workers, or
+         * another dispatch already in flight), in which case the caller
+         * should fall back to Thread::run(). */
+        template <class Functor>
+          bool run (Functor& functor, const std::string& name = "unnamed") {
+            if (!available())
+              return false;
+            DEBUG ("dispatching threads \"" + name + "\" into thread pool...");
+            __thread_base base (name);
+            const size_t nthreads = number_of_threads();
+            vector<typename std::remove_reference<Functor>::type> functors ( (nthreads>0 ? nthreads-1 : 0), functor);
+            std::atomic<bool> exception_thrown (false);
+            vector<Task> tasks;
+            tasks.reserve (nthreads);
+            for (auto& f : functors)
+              tasks.push_back ([&f, &exception_thrown] {
+                  try { f.execute(); }
+                  catch (Exception& E) { exception_thrown = true; E.display(); }
+                  });
+            tasks.push_back ([&functor, &exception_thrown] {
+                try { functor.execute(); }
+                catch (Exception& E) { exception_thrown = true; E.display(); }
+                });
+            if (!dispatch (tasks))
+              return false;
+            if (exception_thrown)
+              throw Exception ("exception thrown from one or more threads \"" + name + "\"");
+            DEBUG ("threads \"" + name + "\" completed OK");
+            return true;
+          }
+
+      private:
+        __Pool () : tasks (nullptr), next_task (0), remaining (0), shutdown (false) { }
+        ~__Pool ();
+        __Pool (const __Pool&) = delete;
+        __Pool& operator= (const __Pool&) = delete;
+
+        bool available () const;
+        bool dispatch (vector<Task>& tasks);
+        void work (const size_t index);
+
+        std::mutex mutex, dispatch_mutex;
+        std::condition_variable task_available, tasks_done;
+        vector<std::thread> workers;
+        vector<Task>* tasks;
+        size_t next_task, remaining;
+        bool shutdown;
+
+        static thread_local bool is_worker;
+    };
+
+    //! \endcond
+
 
     /** \addtogroup thread_classes
      * @{ */
@@ -241,6 +320,15 @@ namespace MR
      * the -nthreads command-line option */
     size_t number_of_threads ();
 
+    //! pin the calling thread to a fixed logical CPU, if so configured
+    /*! if the PinThreads configuration file option is set, bind the calling
+     * thread to logical CPU ( \a index modulo the number available ). On
+     * multi-socket systems this keeps each worker on the socket whose memory
+     * it first touched, at the expense of ceding scheduling flexibility to
+     * the OS; it is a no-op on platforms without thread affinity support, or
+     * (by default) when the option is not set. */
+    void set_thread_affinity (const size_t index);
+
 
 
     //! used to request multiple threads of the corresponding functor
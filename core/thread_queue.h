@@ -16,10 +16,16 @@
 #define __mrtrix_thread_queue_h__
 
 #include <stack>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 
 #include "memory.h"
+#include "profile.h"
 #include "thread.h"
+#include "timer.h"
+#include "file/config.h"
 
 #define MRTRIX_QUEUE_DEFAULT_CAPACITY 128
 #define MRTRIX_QUEUE_DEFAULT_BATCH_SIZE 128
@@ -36,11 +42,12 @@ namespace MR
       /********************************************************************
        * convenience Functor classes for use in Thread::run_queue()
        ********************************************************************/
-      template <class Item> 
+      template <class Item>
         class __Batch { NOMEMALIGN
           public:
-            __Batch (size_t number) : num (number) { }
+            __Batch (size_t number, bool stealing = false) : num (number), stealing (stealing) { }
             size_t num;
+            bool stealing;
         };
 
 
@@ -76,6 +83,9 @@ namespace MR
               }
         };
 
+      template <class X> inline size_t __num_threads (const X& /*job*/) { return 1; }
+      template <class X> inline size_t __num_threads (const __Multi<X>& job) { return job.num; }
+
 
     }
 
@@ -361,6 +371,9 @@ namespace MR
           capacity (buffer_size),
           writer_count (0),
           reader_count (0),
+          push_count (0), pop_count (0),
+          push_wait_ns (0), pop_wait_ns (0),
+          occupancy_sum (0), occupancy_high_water (0),
           name (description) {
           assert (capacity > 0);
         }
@@ -373,6 +386,9 @@ namespace MR
           capacity (buffer_size),
           writer_count (0),
           reader_count (0),
+          push_count (0), pop_count (0),
+          push_wait_ns (0), pop_wait_ns (0),
+          occupancy_sum (0), occupancy_high_water (0),
           name (description) {
           assert (capacity > 0);
         }
@@ -521,6 +537,12 @@ namespace MR
                     << reader_count << " reader" << (reader_count > 1 ? "s" : "") << ", items waiting: " << size() << "\n";
         }
 
+        //! fraction of the queue's usable capacity currently occupied
+        double fill_ratio () {
+          std::lock_guard<std::mutex> lock (mutex);
+          return double (size()) / double (capacity - 1);
+        }
+
 
       private:
         std::mutex mutex;
@@ -530,6 +552,13 @@ namespace MR
         T** back;
         size_t capacity;
         size_t writer_count, reader_count;
+        // utilisation metrics, accumulated under the queue mutex when
+        //   profiling is enabled (see core/profile.h); note that where
+        //   batching is in use, one queue item corresponds to one batch
+        uint64_t push_count, pop_count;
+        uint64_t push_wait_ns, pop_wait_ns;
+        uint64_t occupancy_sum;
+        size_t occupancy_high_water;
         std::stack<T*,vector<T*> > item_stack;
         vector<std::unique_ptr<T>> items;
         std::string name;
@@ -560,10 +589,29 @@ namespace MR
           --reader_count;
           if (!reader_count) {
             DEBUG ("no readers left on queue \"" + name + "\"");
+            if (Profile::enabled)
+              report_utilisation();
             more_space.notify_all();
           }
         }
 
+        //! print the utilisation summary accumulated while profiling
+        /*! invoked with the queue mutex held, once the last reader has
+         * unregistered. A high mean fill level with significant push wait
+         * time indicates the consumer stage is the bottleneck; a low fill
+         * level with significant pop wait time indicates the producer is -
+         * guiding where additional threads (or larger batches, if the wait
+         * times are dominated by synchronisation) are best spent. */
+        void report_utilisation () const {
+          const size_t usable_capacity = capacity - 1;
+          std::cerr << "Thread::Queue \"" + name + "\": "
+                    + str (push_count) + " items pushed, " + str (pop_count) + " popped; "
+                    + "mean fill " + str (push_count ? double (occupancy_sum) / push_count : 0.0, 3)
+                    + ", high-water mark " + str (occupancy_high_water) + " of " + str (usable_capacity) + "; "
+                    + "time blocked: pushing " + str (1.0e-9 * push_wait_ns, 3) + " s, "
+                    + "popping " + str (1.0e-9 * pop_wait_ns, 3) + " s (summed across threads)\n";
+        }
+
         FORCE_INLINE bool empty () const {
           return (front == back);
         }
@@ -583,10 +631,26 @@ namespace MR
 
         FORCE_INLINE bool push (T*& item) {
           std::unique_lock<std::mutex> lock (mutex);
-          more_space.wait (lock, [this]{ return !(full() && reader_count); });
+          if (full() && reader_count) {
+            PROFILE ("thread queue: push wait");
+            if (Profile::enabled) {
+              Timer timer;
+              more_space.wait (lock, [this]{ return !(full() && reader_count); });
+              push_wait_ns += uint64_t (1.0e9 * timer.elapsed());
+            }
+            else
+              more_space.wait (lock, [this]{ return !(full() && reader_count); });
+          }
           if (!reader_count) return false;
           *back = item;
           back = inc (back);
+          if (Profile::enabled) {
+            ++push_count;
+            const size_t occupancy = size();
+            occupancy_sum += occupancy;
+            if (occupancy > occupancy_high_water)
+              occupancy_high_water = occupancy;
+          }
           if (item_stack.empty()) {
             item = new T;
             items.push_back (std::unique_ptr<T> (item));
@@ -604,11 +668,22 @@ namespace MR
           if (item)
             item_stack.push (item);
           item = nullptr;
-          more_data.wait (lock, [this]{ return !(empty() && writer_count); });
+          if (empty() && writer_count) {
+            PROFILE ("thread queue: pop wait");
+            if (Profile::enabled) {
+              Timer timer;
+              more_data.wait (lock, [this]{ return !(empty() && writer_count); });
+              pop_wait_ns += uint64_t (1.0e9 * timer.elapsed());
+            }
+            else
+              more_data.wait (lock, [this]{ return !(empty() && writer_count); });
+          }
           if (empty() && !writer_count)
             return false;
           item = *front;
           front = inc (front);
+          if (Profile::enabled)
+            ++pop_count;
           more_space.notify_one();
           return true;
         }
@@ -632,15 +707,66 @@ namespace MR
         using BatchType = vector<T>;
         using BatchQueue = Queue<BatchType>;
 
+        /* bookkeeping for the work-stealing mode: each Reader::Item publishes
+         * the range of items remaining in its current batch, packed into a
+         * single 64-bit atomic so that the owner can claim the next item with
+         * a simple compare-and-swap, while idle readers can atomically carve
+         * off the tail half of the range. The mutex is only ever taken on the
+         * slow path (batch replacement and stealing), never per item. */
+        class __StealSlot { NOMEMALIGN
+          public:
+            __StealSlot () : range (0), batch (nullptr) { }
+
+            static FORCE_INLINE uint64_t pack (uint64_t begin, uint64_t end) { return (begin << 32) | end; }
+            static FORCE_INLINE size_t begin (uint64_t r) { return r >> 32; }
+            static FORCE_INLINE size_t end (uint64_t r) { return r & 0xFFFFFFFFUL; }
+
+            //! claim the next item of the current batch (owner thread only)
+            FORCE_INLINE bool pop (size_t& index) {
+              uint64_t r = range.load (std::memory_order_acquire);
+              while (begin (r) < end (r)) {
+                if (range.compare_exchange_weak (r, pack (begin (r)+1, end (r)),
+                      std::memory_order_acq_rel, std::memory_order_acquire)) {
+                  index = begin (r);
+                  return true;
+                }
+              }
+              return false;
+            }
+
+            FORCE_INLINE size_t available () const {
+              const uint64_t r = range.load (std::memory_order_acquire);
+              return end (r) - begin (r);
+            }
+
+            //! publish a fresh batch; must hold this slot's mutex
+            void install (BatchType* new_batch, size_t size) {
+              batch = new_batch;
+              range.store (pack (0, size), std::memory_order_release);
+            }
+
+            //! retract the (exhausted) batch before it is recycled by the
+            //! underlying queue; must hold this slot's mutex
+            void retract () {
+              batch = nullptr;
+              range.store (0, std::memory_order_release);
+            }
+
+            std::atomic<uint64_t> range;
+            std::mutex mutex;
+            BatchType* batch;
+        };
+
       public:
         Queue (const __Batch<T>& item_type, const std::string& description = "unnamed", size_t buffer_size = MRTRIX_QUEUE_DEFAULT_CAPACITY) :
           batch_queue (description, buffer_size),
-          batch_size (item_type.num) { }
+          batch_size (item_type.num),
+          stealing (item_type.stealing) { }
 
 
         class Writer { NOMEMALIGN
           public:
-            Writer (Queue<__Batch<T>>& queue) : 
+            Writer (Queue<__Batch<T>>& queue) :
               batch_writer (queue.batch_queue), batch_size (queue.batch_size) { }
 
             class Item { NOMEMALIGN
@@ -684,45 +810,143 @@ namespace MR
 
         class Reader { NOMEMALIGN
           public:
-            Reader (Queue<__Batch<T>>& queue) : 
-              batch_reader (queue.batch_queue), batch_size (queue.batch_size) { }
+            Reader (Queue<__Batch<T>>& queue) :
+              batch_reader (queue.batch_queue), batch_size (queue.batch_size),
+              Q (queue.stealing ? &queue : nullptr) { }
 
             class Item { NOMEMALIGN
               public:
-                Item (const Reader& reader) : batch_item (reader.batch_reader), batch_size (reader.batch_size), n (0) { }
+                Item (const Reader& reader) :
+                  batch_item (reader.batch_reader), batch_size (reader.batch_size), n (0),
+                  Q (reader.Q), cur (nullptr), index (0) {
+                    if (Q)
+                      Q->register_slot (&slot);
+                  }
+                ~Item () {
+                  if (Q)
+                    Q->unregister_slot (&slot);
+                }
                 FORCE_INLINE bool read () {
-                  if (!batch_item) 
+                  if (Q)
+                    return read_stealing();
+
+                  if (!batch_item)
                     return batch_item.read();
 
                   if (++n >= batch_item->size()) {
-                    if (!batch_item.read()) 
+                    if (!batch_item.read())
                       return false;
                     n = 0;
                   }
                   return true;
                 }
                 FORCE_INLINE T& operator*() const throw ()   {
-                  return (*batch_item)[n];
+                  return Q ? (*cur)[index] : (*batch_item)[n];
                 }
                 FORCE_INLINE T* operator->() const throw ()  {
-                  return &((*batch_item)[n]);
+                  return &(operator*());
                 }
               private:
                 typename BatchQueue::Reader::Item batch_item;
                 const size_t batch_size;
                 size_t n;
+                Queue<__Batch<T>>* const Q;
+                BatchType* cur;
+                size_t index;
+                __StealSlot slot;
+                BatchType stolen;
+
+                bool read_stealing () {
+                  while (true) {
+                    if (slot.pop (index))
+                      return true;
+                    // current batch exhausted (or stolen bare): detach it
+                    // before the underlying queue recycles its storage:
+                    {
+                      std::lock_guard<std::mutex> lock (slot.mutex);
+                      slot.retract();
+                    }
+                    if (batch_item.read()) {
+                      std::lock_guard<std::mutex> lock (slot.mutex);
+                      cur = &*batch_item;
+                      slot.install (cur, cur->size());
+                      continue;
+                    }
+                    // upstream queue is done: grab the tail half of the
+                    // largest batch still being processed by a peer:
+                    if (!Q->steal (slot, stolen))
+                      return false;
+                    cur = &stolen;
+                  }
+                }
             };
           private:
             typename BatchQueue::Reader batch_reader;
             const size_t batch_size;
+            Queue<__Batch<T>>* const Q;
         };
 
         FORCE_INLINE void status () { batch_queue.status(); }
 
+        FORCE_INLINE double fill_ratio () { return batch_queue.fill_ratio(); }
+
 
       private:
         BatchQueue batch_queue;
         const size_t batch_size;
+        const bool stealing;
+        std::mutex slots_mutex;
+        vector<__StealSlot*> slots;
+
+        void register_slot (__StealSlot* slot) {
+          std::lock_guard<std::mutex> lock (slots_mutex);
+          slots.push_back (slot);
+        }
+
+        void unregister_slot (__StealSlot* slot) {
+          std::lock_guard<std::mutex> lock (slots_mutex);
+          slots.erase (std::find (slots.begin(), slots.end(), slot));
+        }
+
+        //! transfer the tail half of the fullest peer's in-flight batch into
+        //! \a stolen, and publish it in the thief's own slot. Holding
+        //! slots_mutex throughout serialises concurrent steals; this is of no
+        //! consequence since stealing only ever occurs once the upstream
+        //! queue has been drained.
+        bool steal (__StealSlot& thief, BatchType& stolen) {
+          std::lock_guard<std::mutex> lock (slots_mutex);
+          while (true) {
+            __StealSlot* victim = nullptr;
+            size_t most = 1;
+            for (auto* s : slots) {
+              if (s == &thief)
+                continue;
+              const size_t avail = s->available();
+              if (avail > most) {
+                most = avail;
+                victim = s;
+              }
+            }
+            if (!victim)
+              return false;
+            std::lock_guard<std::mutex> victim_lock (victim->mutex);
+            uint64_t r = victim->range.load (std::memory_order_acquire);
+            while (true) {
+              const size_t begin = __StealSlot::begin (r);
+              const size_t end = __StealSlot::end (r);
+              if (end - begin < 2)
+                break;   // shrunk in the meantime; rescan for another victim
+              const size_t take = (end - begin) / 2;
+              if (victim->range.compare_exchange_weak (r, __StealSlot::pack (begin, end-take),
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                stolen.assign (victim->batch->begin() + (end-take), victim->batch->begin() + end);
+                std::lock_guard<std::mutex> thief_lock (thief.mutex);
+                thief.install (&stolen, stolen.size());
+                return true;
+              }
+            }
+          }
+        }
     };
 
 
@@ -735,17 +959,156 @@ namespace MR
      * Thread::run_queue with functionality needed for use with Thread::Queue */
     namespace {
 
+       /* gates the number of threads actively processing items for one
+        * pipeline stage. Threads beyond the current limit park between
+        * items; the limit is adjusted at runtime by the __Balancer monitor
+        * thread. Parked threads remain registered with their queues, so the
+        * pipeline shutdown semantics are unaffected, and the timed wait
+        * guarantees they periodically recheck the queue state, so draining
+        * cannot stall on a parked thread. */
+       class __StageGate { NOMEMALIGN
+         public:
+           __StageGate (size_t num_threads) :
+             num (num_threads), limit (num_threads), next (0) { }
+
+           size_t assign_id () { return next++; }
+
+           FORCE_INLINE void check (size_t id) {
+             if (id < limit.load (std::memory_order_relaxed))
+               return;
+             std::unique_lock<std::mutex> lock (mutex);
+             while (id >= limit.load (std::memory_order_relaxed)) {
+               if (cond.wait_for (lock, std::chrono::milliseconds (100)) == std::cv_status::timeout)
+                 return;
+             }
+           }
+
+           void set_limit (size_t new_limit) {
+             new_limit = std::min (std::max<size_t> (new_limit, 1), num);
+             {
+               std::lock_guard<std::mutex> lock (mutex);
+               limit.store (new_limit, std::memory_order_relaxed);
+             }
+             cond.notify_all();
+           }
+
+           size_t get_limit () const { return limit.load (std::memory_order_relaxed); }
+
+           const size_t num;
+
+         private:
+           std::atomic<size_t> limit;
+           std::atomic<size_t> next;
+           std::mutex mutex;
+           std::condition_variable cond;
+       };
+
+
+       /* samples the fill level of the queues in a pipeline at regular
+        * intervals, and shifts active threads between the gated
+        * (multi-threaded) stages: a stage whose input queue is congested
+        * while its output queue is starved is the bottleneck, and is
+        * granted a thread parked from the stage with the most spare
+        * capacity. Run as its own (mostly sleeping) thread for the
+        * duration of the pipeline. */
+       class __Balancer { NOMEMALIGN
+         public:
+           __Balancer () : stop (false) { }
+
+           //! \a input / \a output provide the fill ratio of the queues
+           //! adjacent to the stage; pass nullptr at the pipeline ends
+           void add_stage (__StageGate* gate, std::function<double()> input, std::function<double()> output) {
+             stages.push_back ({ gate, input, output });
+           }
+
+           bool active () const { return stages.size(); }
+
+           void finish () { stop.store (true, std::memory_order_relaxed); }
+
+           void execute () {
+             while (!stop.load (std::memory_order_relaxed)) {
+               std::this_thread::sleep_for (std::chrono::milliseconds (100));
+               if (stop.load (std::memory_order_relaxed))
+                 return;
+               rebalance();
+             }
+           }
+
+         private:
+           struct Stage { NOMEMALIGN
+             __StageGate* gate;
+             std::function<double()> in, out;
+           };
+
+           vector<Stage> stages;
+           std::atomic<bool> stop;
+
+           // score > 0: input pressure exceeds output pressure - the stage
+           // cannot keep up; score < 0: the stage is waiting on its
+           // neighbours and has threads to spare
+           FORCE_INLINE double score (const Stage& stage) const {
+             return (stage.in ? stage.in() : 1.0) - (stage.out ? stage.out() : 0.0);
+           }
+
+           void rebalance () {
+             if (stages.size() == 1) {
+               // a single adjustable stage can only shed threads while its
+               // (fixed-thread-count) neighbours are the bottleneck, and
+               // reclaim them once the pressure reverses
+               const double s = score (stages[0]);
+               __StageGate* gate = stages[0].gate;
+               if (s > 0.5 && gate->get_limit() < gate->num)
+                 gate->set_limit (gate->get_limit() + 1);
+               else if (s < -0.5 && gate->get_limit() > 1)
+                 gate->set_limit (gate->get_limit() - 1);
+               return;
+             }
+             size_t busiest = 0, sparest = 0;
+             double max_score = -2.0, min_score = 2.0;
+             for (size_t n = 0; n < stages.size(); ++n) {
+               const double s = score (stages[n]);
+               if (s > max_score) { max_score = s; busiest = n; }
+               if (s < min_score) { min_score = s; sparest = n; }
+             }
+             if (busiest == sparest || max_score - min_score < 0.5)
+               return;
+             __StageGate* hot = stages[busiest].gate;
+             __StageGate* cold = stages[sparest].gate;
+             if (cold->get_limit() > 1)
+               cold->set_limit (cold->get_limit() - 1);
+             if (hot->get_limit() < hot->num)
+               hot->set_limit (hot->get_limit() + 1);
+           }
+       };
+
+
+       //! whether runtime rebalancing of pipeline stages is enabled
+       inline bool __rebalancing_enabled () {
+         //CONF option: ThreadQueueRebalancing
+         //CONF default: 0 (false)
+         //CONF Monitor the fill level of the queues in multi-threaded
+         //CONF pipelines at runtime, and park or resume threads of the
+         //CONF multi-threaded stages so that processing capacity follows
+         //CONF the bottleneck stage. Fixed per-stage thread counts are
+         //CONF used when disabled.
+         static const bool enabled = File::Config::get_bool ("ThreadQueueRebalancing", false);
+         return enabled;
+       }
+
 
        template <class Type, class Functor>
          class __Source { MEMALIGN(__Source<Type,Functor>)
            public:
-             __Source (Queue<Type>& queue, Functor& functor) :
-               writer (queue), func (__job<Functor>::functor (functor)) { }
+             __Source (Queue<Type>& queue, Functor& functor, __StageGate* gate = nullptr) :
+               writer (queue), func (__job<Functor>::functor (functor)), gate (gate) { }
 
              void execute () {
+               const size_t id = gate ? gate->assign_id() : 0;
                typename Queue<Type>::Writer::Item out (writer);
                do {
-                 if (!func (*out)) 
+                 if (gate)
+                   gate->check (id);
+                 if (!func (*out))
                    return;
                } while (out.write());
              }
@@ -753,20 +1116,24 @@ namespace MR
            private:
              typename Queue<Type>::Writer writer;
              typename __job<Functor>::member_type func;
+             __StageGate* const gate;
          };
 
 
        template <class Type1, class Functor, class Type2>
          class __Pipe { MEMALIGN(__Pipe<Type1,Functor,Type2>)
            public:
-             __Pipe (Queue<Type1>& queue_in, Functor& functor, Queue<Type2>& queue_out) :
-               reader (queue_in), writer (queue_out), func (__job<Functor>::functor (functor)) { }
+             __Pipe (Queue<Type1>& queue_in, Functor& functor, Queue<Type2>& queue_out, __StageGate* gate = nullptr) :
+               reader (queue_in), writer (queue_out), func (__job<Functor>::functor (functor)), gate (gate) { }
 
              void execute () {
+               const size_t id = gate ? gate->assign_id() : 0;
                typename Queue<Type1>::Reader::Item in (reader);
                typename Queue<Type2>::Writer::Item out (writer);
                do {
-                 do { if (!in.read()) return; } 
+                 if (gate)
+                   gate->check (id);
+                 do { if (!in.read()) return; }
                  while (!func (*in, *out));
                } while (out.write());
              }
@@ -775,6 +1142,7 @@ namespace MR
              typename Queue<Type1>::Reader reader;
              typename Queue<Type2>::Writer writer;
              typename __job<Functor>::member_type func;
+             __StageGate* const gate;
          };
 
 
@@ -782,20 +1150,24 @@ namespace MR
        template <class Type, class Functor>
          class __Sink { MEMALIGN(__Sink<Type,Functor>)
            public:
-             __Sink (Queue<Type>& queue, Functor& functor) :
-               reader (queue), func (__job<Functor>::functor (functor)) { }
+             __Sink (Queue<Type>& queue, Functor& functor, __StageGate* gate = nullptr) :
+               reader (queue), func (__job<Functor>::functor (functor)), gate (gate) { }
 
              void execute () {
+               const size_t id = gate ? gate->assign_id() : 0;
                typename Queue<Type>::Reader::Item in (reader);
                while (in.read()) {
                  if (!func (*in))
                    return;
+                 if (gate)
+                   gate->check (id);
                }
              }
 
            private:
              typename Queue<Type>::Reader reader;
              typename __job<Functor>::member_type func;
+             __StageGate* const gate;
          };
 
 
@@ -821,6 +1193,23 @@ namespace MR
       }
 
 
+    //! used to request batched processing with work-stealing between sinks
+    /*! Equivalent to Thread::batch(), but additionally allows a reader thread
+     * that has run out of work to take over the unprocessed tail of another
+     * reader's current batch. This evens out the drain phase of the pipeline
+     * when the cost of processing individual items is highly variable (e.g.
+     * streamlines of very different lengths), at the cost of a slightly more
+     * expensive per-item fetch; with uniform per-item cost, prefer
+     * Thread::batch().
+     * \sa Thread::batch()
+     * \sa Thread::run_queue() */
+    template <class Item>
+      inline __Batch<Item> stealing_batch (const Item&, size_t number = MRTRIX_QUEUE_DEFAULT_BATCH_SIZE)
+      {
+        return __Batch<Item> (number, true);
+      }
+
+
 
 
 
@@ -1022,14 +1411,37 @@ namespace MR
         }
 
          Queue<Type> queue (item_type, "source->sink", capacity);
-         __Source<Type,Source> source_functor (queue, source);
-         __Sink<Type,Sink>     sink_functor   (queue, sink);
+
+         __Balancer balancer;
+         std::unique_ptr<__StageGate> source_gate, sink_gate;
+         if (__rebalancing_enabled()) {
+           auto fill = [&queue]{ return queue.fill_ratio(); };
+           if (__num_threads (source) > 1) {
+             source_gate.reset (new __StageGate (__num_threads (source)));
+             balancer.add_stage (source_gate.get(), nullptr, fill);
+           }
+           if (__num_threads (sink) > 1) {
+             sink_gate.reset (new __StageGate (__num_threads (sink)));
+             balancer.add_stage (sink_gate.get(), fill, nullptr);
+           }
+         }
+
+         __Source<Type,Source> source_functor (queue, source, source_gate.get());
+         __Sink<Type,Sink>     sink_functor   (queue, sink, sink_gate.get());
 
         auto t1 = run (__job<Source>::get (source, source_functor), "source");
         auto t2 = run (__job<Sink>::get (sink, sink_functor), "sink");
 
+        std::unique_ptr<__single_thread> monitor;
+        if (balancer.active())
+          monitor.reset (new __single_thread (balancer, "queue monitor"));
+
         t1.wait();
         t2.wait();
+        if (monitor) {
+          balancer.finish();
+          monitor->wait();
+        }
       }
 
 
@@ -1102,17 +1514,44 @@ namespace MR
         Queue<Type1> queue1 (item_type1, "source->pipe", capacity);
         Queue<Type2> queue2 (item_type2, "pipe->sink", capacity);
 
-        __Source<Type1,Source>   source_functor (queue1, source);
-        __Pipe<Type1,Pipe,Type2> pipe_functor   (queue1, pipe, queue2);
-        __Sink<Type2,Sink>       sink_functor   (queue2, sink);
+        __Balancer balancer;
+        std::unique_ptr<__StageGate> source_gate, pipe_gate, sink_gate;
+        if (__rebalancing_enabled()) {
+          auto fill1 = [&queue1]{ return queue1.fill_ratio(); };
+          auto fill2 = [&queue2]{ return queue2.fill_ratio(); };
+          if (__num_threads (source) > 1) {
+            source_gate.reset (new __StageGate (__num_threads (source)));
+            balancer.add_stage (source_gate.get(), nullptr, fill1);
+          }
+          if (__num_threads (pipe) > 1) {
+            pipe_gate.reset (new __StageGate (__num_threads (pipe)));
+            balancer.add_stage (pipe_gate.get(), fill1, fill2);
+          }
+          if (__num_threads (sink) > 1) {
+            sink_gate.reset (new __StageGate (__num_threads (sink)));
+            balancer.add_stage (sink_gate.get(), fill2, nullptr);
+          }
+        }
+
+        __Source<Type1,Source>   source_functor (queue1, source, source_gate.get());
+        __Pipe<Type1,Pipe,Type2> pipe_functor   (queue1, pipe, queue2, pipe_gate.get());
+        __Sink<Type2,Sink>       sink_functor   (queue2, sink, sink_gate.get());
 
         auto t1 = run (__job<Source>::get (source, source_functor), "source");
         auto t2 = run (__job<Pipe>::get (pipe, pipe_functor), "pipe");
         auto t3 = run (__job<Sink>::get (sink, sink_functor), "sink");
 
+        std::unique_ptr<__single_thread> monitor;
+        if (balancer.active())
+          monitor.reset (new __single_thread (balancer, "queue monitor"));
+
         t1.wait();
         t2.wait();
         t3.wait();
+        if (monitor) {
+          balancer.finish();
+          monitor->wait();
+        }
       }
 
 
@@ -1149,20 +1588,52 @@ namespace MR
         Queue<Type2> queue2 (item_type2, "pipe->pipe", capacity);
         Queue<Type3> queue3 (item_type3, "pipe->sink", capacity);
 
-        __Source<Type1,Source>    source_functor (queue1, source);
-        __Pipe<Type1,Pipe1,Type2> pipe1_functor   (queue1, pipe1, queue2);
-        __Pipe<Type2,Pipe2,Type3> pipe2_functor   (queue2, pipe2, queue3);
-        __Sink<Type3,Sink>        sink_functor   (queue3, sink);
+        __Balancer balancer;
+        std::unique_ptr<__StageGate> source_gate, pipe1_gate, pipe2_gate, sink_gate;
+        if (__rebalancing_enabled()) {
+          auto fill1 = [&queue1]{ return queue1.fill_ratio(); };
+          auto fill2 = [&queue2]{ return queue2.fill_ratio(); };
+          auto fill3 = [&queue3]{ return queue3.fill_ratio(); };
+          if (__num_threads (source) > 1) {
+            source_gate.reset (new __StageGate (__num_threads (source)));
+            balancer.add_stage (source_gate.get(), nullptr, fill1);
+          }
+          if (__num_threads (pipe1) > 1) {
+            pipe1_gate.reset (new __StageGate (__num_threads (pipe1)));
+            balancer.add_stage (pipe1_gate.get(), fill1, fill2);
+          }
+          if (__num_threads (pipe2) > 1) {
+            pipe2_gate.reset (new __StageGate (__num_threads (pipe2)));
+            balancer.add_stage (pipe2_gate.get(), fill2, fill3);
+          }
+          if (__num_threads (sink) > 1) {
+            sink_gate.reset (new __StageGate (__num_threads (sink)));
+            balancer.add_stage (sink_gate.get(), fill3, nullptr);
+          }
+        }
+
+        __Source<Type1,Source>    source_functor (queue1, source, source_gate.get());
+        __Pipe<Type1,Pipe1,Type2> pipe1_functor   (queue1, pipe1, queue2, pipe1_gate.get());
+        __Pipe<Type2,Pipe2,Type3> pipe2_functor   (queue2, pipe2, queue3, pipe2_gate.get());
+        __Sink<Type3,Sink>        sink_functor   (queue3, sink, sink_gate.get());
 
         auto t1 = run (__job<Source>::get (source, source_functor), "source");
         auto t2 = run (__job<Pipe1>::get (pipe1, pipe1_functor), "pipe1");
         auto t3 = run (__job<Pipe2>::get (pipe2, pipe2_functor), "pipe2");
         auto t4 = run (__job<Sink>::get (sink, sink_functor), "sink");
 
+        std::unique_ptr<__single_thread> monitor;
+        if (balancer.active())
+          monitor.reset (new __single_thread (balancer, "queue monitor"));
+
         t1.wait();
         t2.wait();
         t3.wait();
         t4.wait();
+        if (monitor) {
+          balancer.finish();
+          monitor->wait();
+        }
       }
 
 
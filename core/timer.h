@@ -16,6 +16,7 @@
 #define __timer_h__
 
 #include <chrono>
+#include <cstdint>
 
 #define NOMEMALIGN
 
@@ -39,6 +40,20 @@ namespace MR
         return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count() * 1.0e-9;
       }
 
+      //! current value of the CPU cycle counter
+      /*! returns the time-stamp counter where one is available, falling back
+       * to the high-resolution clock tick count otherwise; useful for
+       * reporting per-item costs of fine-grained operations (see
+       * benchmarks/), but note the counter is not guaranteed to be
+       * synchronised across cores. */
+      static uint64_t current_cycle_count () {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#else
+        return uint64_t (std::chrono::high_resolution_clock::now().time_since_epoch().count());
+#endif
+      }
+
     protected:
       std::chrono::high_resolution_clock::time_point from;
   };
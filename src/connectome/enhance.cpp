@@ -15,10 +15,9 @@
 #include "connectome/enhance.h"
 #include "connectome/mat2vec.h"
 
+#include <numeric>
 #include <set>
 
-#include "progressbar.h"
-
 
 namespace MR {
   namespace Connectome {
@@ -37,35 +36,46 @@ namespace MR {
       value_type NBS::operator() (const vector_type& in, const value_type T, vector_type& out) const
       {
         out = vector_type::Zero (in.size());
-        value_type max_value = value_type(0);
-
-        for (ssize_t seed = 0; seed != in.size(); ++seed) {
-          if (std::isfinite (in[seed]) && in[seed] >= T && !out[seed]) {
-
-            BitSet visited (in.size());
-            visited[seed] = true;
-            vector<size_t> to_expand (1, seed);
-            size_t cluster_size = 0;
-
-            while (to_expand.size()) {
-
-              const uint32_t index = to_expand.back();
-              to_expand.pop_back();
-              cluster_size++;
-
-              for (vector<size_t>::const_iterator i = (*adjacency)[index].begin(); i != (*adjacency)[index].end(); ++i) {
-                if (!visited[*i] && std::isfinite(in[*i]) && in[*i] >= T) {
-                  visited[*i] = true;
-                  to_expand.push_back (*i);
-                }
-              }
 
-            }
+        // Two supra-threshold edges belong to the same cluster if and only if
+        //   they are joined by a path of supra-threshold edges, i.e. if their
+        //   node pairs lie within the same connected component of the
+        //   thresholded graph; identify those components with a union-find
+        //   over the nodes, rather than a breadth-first search over the much
+        //   larger edge-to-edge adjacency
+        vector<node_t> parent (num_nodes);
+        std::iota (parent.begin(), parent.end(), node_t(0));
+        auto find = [&parent] (node_t i)
+        {
+          while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+          }
+          return i;
+        };
+
+        for (ssize_t edge = 0; edge != in.size(); ++edge) {
+          if (std::isfinite (in[edge]) && in[edge] >= T) {
+            const node_t one = find ((*edges)[edge].first);
+            const node_t two = find ((*edges)[edge].second);
+            if (one != two)
+              parent[two] = one;
+          }
+        }
 
-            max_value = std::max (max_value, value_type(cluster_size));
-            for (ssize_t i = 0; i != in.size(); ++i)
-              out[i] += (visited[i] ? 1.0 : 0.0) * cluster_size;
+        // Cluster size = number of supra-threshold edges within the component
+        vector<size_t> counts (num_nodes, 0);
+        for (ssize_t edge = 0; edge != in.size(); ++edge) {
+          if (std::isfinite (in[edge]) && in[edge] >= T)
+            ++counts[find ((*edges)[edge].first)];
+        }
 
+        value_type max_value = value_type(0);
+        for (ssize_t edge = 0; edge != in.size(); ++edge) {
+          if (std::isfinite (in[edge]) && in[edge] >= T) {
+            const value_type cluster_size (counts[find ((*edges)[edge].first)]);
+            out[edge] = cluster_size;
+            max_value = std::max (max_value, cluster_size);
           }
         }
 
@@ -74,29 +84,14 @@ namespace MR {
 
 
 
-      void NBS::initialise (const node_t num_nodes)
+      void NBS::initialise (const node_t nodes)
       {
-        const Mat2Vec mat2vec (num_nodes);
-        const size_t num_edges = mat2vec.vec_size();
-        ProgressBar progress ("Pre-computing statistical correlation matrix...", num_edges);
-        adjacency.reset (new vector< vector<size_t> > (num_edges, vector<size_t>()));
-        for (node_t row = 0; row != num_nodes; ++row) {
-          for (node_t column = row; column != num_nodes; ++column) {
-
-            const size_t index = mat2vec (row, column);
-            vector<size_t>& vector = (*adjacency)[index];
-            vector.reserve (2 * (num_nodes-1));
-            // Should be able to expand from this edge to any other edge connected to either row or column
-            for (node_t r = 0; r != num_nodes; ++r) {
-              if (r != row)
-                vector.push_back (mat2vec (r, column));
-            }
-            for (node_t c = 0; c != num_nodes; ++c) {
-              if (c != column)
-                vector.push_back (mat2vec (row, c));
-            }
-            ++progress;
-          }
+        num_nodes = nodes;
+        const Mat2Vec mat2vec (nodes);
+        edges.reset (new vector< std::pair<node_t, node_t> > (mat2vec.vec_size()));
+        for (node_t row = 0; row != nodes; ++row) {
+          for (node_t column = row; column != nodes; ++column)
+            (*edges)[mat2vec (row, column)] = std::make_pair (row, column);
         }
       }
 
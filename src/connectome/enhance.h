@@ -17,8 +17,8 @@
 
 #include <memory>
 #include <stdint.h>
+#include <utility>
 
-#include "bitset.h"
 #include "types.h"
 
 #include "connectome/mat2vec.h"
@@ -71,7 +71,10 @@ namespace MR {
           value_type operator() (const vector_type&, const value_type, vector_type&) const override;
 
         protected:
-          std::shared_ptr< vector< vector<size_t> > > adjacency;
+          // Node pair corresponding to each edge of the vectorised connectome;
+          //   shared between all copies of the functor, and hence between threads
+          std::shared_ptr< vector< std::pair<node_t, node_t> > > edges;
+          node_t num_nodes;
           value_type threshold;
 
         private:
@@ -15,6 +15,7 @@
 #include "connectome/lut.h"
 
 #include <fstream>
+#include <unordered_map>
 
 
 
@@ -288,21 +289,23 @@ vector<node_t> get_lut_mapping (const LUT& in, const LUT& out)
 {
   if (in.empty())
     return vector<node_t>();
+  // hash the target LUT by node name once, rather than re-scanning it for
+  // every input node; a stored node value of 0 marks a name that appears
+  // against multiple target indices, making any mapping to it ill-formed
+  std::unordered_map<std::string, node_t> name2node;
+  for (const auto& node_out : out) {
+    const auto existing = name2node.insert (std::make_pair (node_out.second.get_name(), node_out.first));
+    if (!existing.second && existing.first->second != node_out.first)
+      existing.first->second = 0;
+  }
   vector<node_t> map (in.rbegin()->first + 1, 0);
   for (const auto& node_in : in) {
-    node_t target = 0;
-    for (const auto& node_out : out) {
-      if (node_out.second.get_name() == node_in.second.get_name()) {
-        if (target) {
-          throw Exception ("Cannot perform LUT conversion: Node " + str(node_in.first) + " (" + node_in.second.get_name() + ") has multiple possible targets");
-          return vector<node_t> ();
-        }
-        target = node_out.first;
-        break;
-      }
+    const auto target = name2node.find (node_in.second.get_name());
+    if (target != name2node.end()) {
+      if (!target->second)
+        throw Exception ("Cannot perform LUT conversion: Node " + str(node_in.first) + " (" + node_in.second.get_name() + ") has multiple possible targets");
+      map[node_in.first] = target->second;
     }
-    if (target)
-      map[node_in.first] = target;
   }
   return map;
 }
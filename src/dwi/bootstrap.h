@@ -35,20 +35,10 @@ namespace MR {
         using base_type::size;
         using base_type::index;
 
-        class IndexCompare { NOMEMALIGN
-          public:
-            bool operator() (const Eigen::Vector3i& a, const Eigen::Vector3i& b) const {
-              if (a[0] < b[0]) return true;
-              if (a[1] < b[1]) return true;
-              if (a[2] < b[2]) return true;
-              return false;
-            }
-        };
-
-
         Bootstrap (const ImageType& Image, const Functor& functor) :
           base_type (Image),
           func (functor),
+          generation (0),
           next_voxel (nullptr),
           last_voxel (nullptr) {
             assert (ndim() == 4);
@@ -71,9 +61,22 @@ namespace MR {
             }
           }
 
-        void clear () 
+        //! start a new bootstrap realisation
+        /*! previously generated voxel data are invalidated by bumping the
+         * generation tag rather than by deallocation: the slabs and the
+         * per-voxel lookup table are recycled across realisations, so no
+         * per-streamline allocation churn is incurred. */
+        void clear ()
         {
-          voxels.clear(); 
+          if (voxel_lookup.empty()) {
+            voxel_lookup.resize (size(0) * size(1) * size(2), nullptr);
+            voxel_tags.resize (voxel_lookup.size(), 0);
+          }
+          if (++generation == 0) {
+            // generation tag wrapped around: invalidate all entries explicitly
+            std::fill (voxel_tags.begin(), voxel_tags.end(), uint32_t(0));
+            generation = 1;
+          }
           if (voxel_buffer.empty())
             voxel_buffer.push_back (vector<value_type> (NUM_VOX_PER_CHUNK * size(3)));
           next_voxel = &voxel_buffer[0][0];
@@ -83,7 +86,9 @@ namespace MR {
 
       protected:
         Functor func;
-        std::map<Eigen::Vector3i,value_type*,IndexCompare> voxels;
+        vector<value_type*> voxel_lookup;
+        vector<uint32_t> voxel_tags;
+        uint32_t generation;
         vector<vector<value_type>> voxel_buffer;
         value_type* next_voxel;
         value_type* last_voxel;
@@ -106,15 +111,17 @@ namespace MR {
 
         value_type* get_voxel ()
         {
-          value_type*& data (voxels.insert (std::make_pair (Eigen::Vector3i (index(0), index(1), index(2)), nullptr)).first->second);
-          if (!data) {
-            data = allocate_voxel ();
-            ssize_t pos = index(3);
-            for (auto l = Loop(3)(*this); l; ++l)
-              data[index(3)] = base_type::value();
-            index(3) = pos;
-            func (data);
-          }
+          const size_t linear = index(0) + size(0) * (index(1) + size(1) * index(2));
+          if (voxel_tags[linear] == generation)
+            return voxel_lookup[linear];
+          value_type* data = allocate_voxel ();
+          ssize_t pos = index(3);
+          for (auto l = Loop(3)(*this); l; ++l)
+            data[index(3)] = base_type::value();
+          index(3) = pos;
+          func (data);
+          voxel_tags[linear] = generation;
+          voxel_lookup[linear] = data;
           return data;
         }
     };
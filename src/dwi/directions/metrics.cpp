@@ -0,0 +1,110 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "dwi/directions/metrics.h"
+
+#include "thread_queue.h"
+
+
+// Number of rows of the Gram matrix computed per matrix product; bounds the
+//   temporary to block_size x num_directions while keeping each product large
+//   enough to run at full matrix-multiplication throughput
+#define DIR_METRICS_BLOCK_SIZE 256
+
+
+namespace MR {
+  namespace DWI {
+    namespace Directions {
+
+
+
+      PairwiseMetrics pairwise_metrics (const Eigen::MatrixXd& directions)
+      {
+        const ssize_t num = directions.rows();
+        const Eigen::MatrixXd D = directions.leftCols (3);
+        const Eigen::ArrayXd norm2 = D.rowwise().squaredNorm();
+        const Eigen::ArrayXd inv_norm = norm2.sqrt().inverse();
+
+        PairwiseMetrics out;
+        out.NN_unipolar.assign (num, -1.0);
+        out.NN_bipolar .assign (num, -1.0);
+        out.E_unipolar .assign (num, 0.0);
+        out.E_bipolar  .assign (num, 0.0);
+
+        // Each block computes its rows of the Gram matrix as one matrix
+        //   product; a full row of dot products is available for every
+        //   direction in the block, so each block only ever writes to its
+        //   own rows of the output
+        const ssize_t num_blocks = (num + DIR_METRICS_BLOCK_SIZE - 1) / DIR_METRICS_BLOCK_SIZE;
+        ssize_t next_block = 0;
+        auto loader = [&] (ssize_t& block) { if (next_block == num_blocks) return false; block = next_block++; return true; };
+        auto worker = [&] (const ssize_t& block) {
+          const ssize_t from = block * DIR_METRICS_BLOCK_SIZE;
+          const ssize_t n = std::min (ssize_t (DIR_METRICS_BLOCK_SIZE), num - from);
+          const Eigen::MatrixXd G = D.middleRows (from, n) * D.transpose();
+          for (ssize_t r = 0; r != n; ++r) {
+            const ssize_t i = from + r;
+            double nn_unipolar = -1.0, nn_bipolar = -1.0, e_unipolar = 0.0, e_bipolar = 0.0;
+            for (ssize_t j = 0; j != num; ++j) {
+              if (j == i)
+                continue;
+              const double dot = G(r,j);
+              const double cos_angle = std::min (1.0, std::max (-1.0, dot * inv_norm[i] * inv_norm[j]));
+              nn_unipolar = std::max (nn_unipolar, cos_angle);
+              nn_bipolar  = std::max (nn_bipolar, std::abs (cos_angle));
+              // |a-b|^2 = |a|^2 + |b|^2 - 2 a.b, and similarly for |a+b|^2
+              const double e = 1.0 / std::sqrt (norm2[i] + norm2[j] - 2.0*dot);
+              e_unipolar += e;
+              e_bipolar  += e + 1.0 / std::sqrt (norm2[i] + norm2[j] + 2.0*dot);
+            }
+            out.NN_unipolar[i] = nn_unipolar;
+            out.NN_bipolar [i] = nn_bipolar;
+            out.E_unipolar [i] = e_unipolar;
+            out.E_bipolar  [i] = e_bipolar;
+          }
+          return true;
+        };
+        Thread::run_queue (loader, ssize_t(), Thread::multi (worker));
+
+        return out;
+      }
+
+
+
+      Eigen::VectorXd electrostatic_energy (const Eigen::MatrixXd& reference,
+                                            const Eigen::MatrixXd& candidates,
+                                            const double unipolar_weight,
+                                            const double bipolar_weight)
+      {
+        const Eigen::MatrixXd R = reference.leftCols (3);
+        const Eigen::MatrixXd C = candidates.leftCols (3);
+        Eigen::VectorXd E = Eigen::VectorXd::Zero (C.rows());
+        if (!R.rows())
+          return E;
+        const Eigen::MatrixXd G = R * C.transpose();
+        const Eigen::ArrayXd rnorm2 = R.rowwise().squaredNorm();
+        const Eigen::ArrayXd cnorm2 = C.rowwise().squaredNorm();
+        for (ssize_t j = 0; j != C.rows(); ++j) {
+          const Eigen::ArrayXd dist2 = rnorm2 + cnorm2[j];
+          E[j] = ((unipolar_weight + bipolar_weight) * (dist2 - 2.0*G.col(j).array()).sqrt().inverse()
+                                   + bipolar_weight  * (dist2 + 2.0*G.col(j).array()).sqrt().inverse()).sum();
+        }
+        return E;
+      }
+
+
+
+    }
+  }
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __dwi_directions_metrics_h__
+#define __dwi_directions_metrics_h__
+
+#include "types.h"
+
+namespace MR {
+  namespace DWI {
+    namespace Directions {
+
+
+      //! per-direction nearest-neighbour and electrostatic repulsion statistics
+      /*! NN_* hold the largest cosine between each direction and any other
+       * (i.e. the cosine of the nearest-neighbour angle); E_* hold the total
+       * electrostatic repulsion energy of each direction with respect to all
+       * others. The unipolar variants treat each direction as a point charge;
+       * the bipolar variants additionally interact with the antipodes. */
+      class PairwiseMetrics { MEMALIGN(PairwiseMetrics)
+        public:
+          vector<double> NN_unipolar, NN_bipolar, E_unipolar, E_bipolar;
+      };
+
+      //! compute pairwise statistics over a direction set
+      /*! only the first 3 columns of \a directions are used. All pairwise dot
+       * products are obtained as blocked matrix products over row blocks of
+       * the direction set, with blocks distributed across threads; distances
+       * and angles are then derived from the dot products and the per-row
+       * squared norms, so results match the direct pairwise evaluation to
+       * within floating-point rounding. */
+      PairwiseMetrics pairwise_metrics (const Eigen::MatrixXd& directions);
+
+      //! total electrostatic energy between each candidate direction and a reference set
+      /*! returns, for each row of \a candidates, the sum over all rows of
+       * \a reference of:
+       * \code
+       * (unipolar_weight + bipolar_weight) / |r - c| + bipolar_weight / |r + c|
+       * \endcode
+       * computed via a single matrix product between the two sets. */
+      Eigen::VectorXd electrostatic_energy (const Eigen::MatrixXd& reference,
+                                            const Eigen::MatrixXd& candidates,
+                                            const double unipolar_weight,
+                                            const double bipolar_weight);
+
+
+    }
+  }
+}
+
+#endif
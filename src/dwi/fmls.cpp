@@ -14,6 +14,12 @@
 
 #include "dwi/fmls.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "file/path.h"
+
 
 
 namespace MR {
@@ -89,6 +95,206 @@ namespace MR {
 
 
 
+      const App::OptionGroup FMLSCacheOption = App::OptionGroup ("FOD segmentation cache options")
+
+        + App::Option ("fmls_cache",
+            "cache the results of FOD segmentation (fixel directions, integrals and dixel masks) in the given file, "
+            "so that subsequent commands operating on the same FOD image can reload them rather than re-running the "
+            "segmentation. If the file already exists, and matches both the content of the input image (verified via "
+            "a content hash) and the segmentation settings, the cached results are used; otherwise the file is "
+            "(re-)generated.")
+        + App::Argument ("file").type_file_out();
+
+
+
+
+      namespace {
+
+        // 64-bit FNV-1a over the raw voxel values; cheap relative to
+        //   segmentation, and sufficient to detect a cache that was generated
+        //   from different image data
+        uint64_t content_hash (Image<float>& image)
+        {
+          uint64_t hash = 0xcbf29ce484222325ULL;
+          for (auto l = Loop ("computing image content hash", image) (image); l; ++l) {
+            const float value = image.value();
+            const uint8_t* const bytes = reinterpret_cast<const uint8_t*> (&value);
+            for (size_t k = 0; k != sizeof (float); ++k) {
+              hash ^= bytes[k];
+              hash *= 0x100000001b3ULL;
+            }
+          }
+          return hash;
+        }
+
+        template <typename X>
+        inline void cache_write (std::ostream& out, const X& value)
+        {
+          out.write (reinterpret_cast<const char*> (&value), sizeof (X));
+        }
+
+        template <typename X>
+        inline bool cache_read (std::istream& in, X& value)
+        {
+          return bool (in.read (reinterpret_cast<char*> (&value), sizeof (X)));
+        }
+
+        const char cache_magic[8] = { 'M', 'R', 'f', 'm', 'l', 's', 'c', '1' };
+
+      }
+
+
+
+
+      Cache::Cache (const std::string& target, Image<float>& fod, const Segmenter& fmls, Image<float> mask) :
+          path (target),
+          dirs (fmls.get_directions())
+      {
+        const uint64_t fod_hash = content_hash (fod);
+        const uint64_t mask_hash = mask.valid() ? content_hash (mask) : uint64_t(0);
+        const uint8_t flags = (fmls.get_create_null_lobe()    ? 1 : 0)
+                            | (fmls.get_create_lookup_table() ? 2 : 0)
+                            | (fmls.get_dilate_lookup_table() ? 4 : 0);
+
+        if (Path::exists (path)) {
+          in.reset (new std::ifstream (path.c_str(), std::ios_base::in | std::ios_base::binary));
+          char magic[8];
+          uint64_t file_fod_hash = 0, file_mask_hash = 0;
+          uint32_t file_num_dirs = 0, file_lmax = 0;
+          double file_integral = 0.0, file_peak_value = 0.0, file_merge_ratio = 0.0;
+          uint8_t file_flags = 0;
+          if (in->read (magic, sizeof (magic))
+              && !memcmp (magic, cache_magic, sizeof (magic))
+              && cache_read (*in, file_fod_hash)    && file_fod_hash  == fod_hash
+              && cache_read (*in, file_mask_hash)   && file_mask_hash == mask_hash
+              && cache_read (*in, file_num_dirs)    && file_num_dirs  == uint32_t(dirs.size())
+              && cache_read (*in, file_lmax)        && file_lmax      == uint32_t(fmls.get_lmax())
+              && cache_read (*in, file_integral)    && file_integral    == double(fmls.get_integral_threshold())
+              && cache_read (*in, file_peak_value)  && file_peak_value  == double(fmls.get_peak_value_threshold())
+              && cache_read (*in, file_merge_ratio) && file_merge_ratio == double(fmls.get_ratio_of_peak_value_to_merge())
+              && cache_read (*in, file_flags)       && file_flags     == flags)
+            return;
+          WARN ("FOD segmentation cache \"" + path + "\" does not match the input image or segmentation settings; re-segmenting");
+          in.reset();
+        }
+
+        out.reset (new std::ofstream ((path + ".tmp").c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc));
+        if (!*out)
+          throw Exception ("error creating FOD segmentation cache file \"" + path + ".tmp\": " + strerror (errno));
+        out->write (cache_magic, sizeof (cache_magic));
+        cache_write (*out, fod_hash);
+        cache_write (*out, mask_hash);
+        cache_write (*out, uint32_t (dirs.size()));
+        cache_write (*out, uint32_t (fmls.get_lmax()));
+        cache_write (*out, double (fmls.get_integral_threshold()));
+        cache_write (*out, double (fmls.get_peak_value_threshold()));
+        cache_write (*out, double (fmls.get_ratio_of_peak_value_to_merge()));
+        cache_write (*out, flags);
+      }
+
+
+
+
+      bool Cache::read (FOD_lobes& lobes)
+      {
+        assert (in);
+        int32_t vox[3];
+        if (!in->read (reinterpret_cast<char*> (vox), sizeof (vox)))
+          return false;
+        lobes.clear();
+        lobes.vox[0] = vox[0]; lobes.vox[1] = vox[1]; lobes.vox[2] = vox[2];
+        uint32_t num_lobes = 0, lut_size = 0;
+        cache_read (*in, num_lobes);
+        cache_read (*in, lut_size);
+        lobes.lut.resize (lut_size);
+        if (lut_size)
+          in->read (reinterpret_cast<char*> (&lobes.lut[0]), lut_size);
+        const size_t mask_bytes = (dirs.size() + 7) / 8;
+        vector<uint8_t> mask_data (mask_bytes);
+        for (uint32_t n = 0; n != num_lobes; ++n) {
+          FOD_lobe lobe ((Mask (dirs)));
+          uint8_t neg = 0;
+          double integral = 0.0, max_peak_value = 0.0, mean_dir[3];
+          uint32_t num_peaks = 0;
+          cache_read (*in, neg);
+          cache_read (*in, integral);
+          cache_read (*in, max_peak_value);
+          in->read (reinterpret_cast<char*> (mean_dir), sizeof (mean_dir));
+          lobe.neg = neg;
+          lobe.integral = integral;
+          lobe.max_peak_value = max_peak_value;
+          lobe.mean_dir = Eigen::Vector3 (mean_dir[0], mean_dir[1], mean_dir[2]);
+          cache_read (*in, num_peaks);
+          for (uint32_t p = 0; p != num_peaks; ++p) {
+            double peak_dir[3];
+            in->read (reinterpret_cast<char*> (peak_dir), sizeof (peak_dir));
+            lobe.peak_dirs.push_back (Eigen::Vector3 (peak_dir[0], peak_dir[1], peak_dir[2]));
+          }
+          in->read (reinterpret_cast<char*> (&mask_data[0]), mask_bytes);
+          for (size_t i = 0; i != dirs.size(); ++i) {
+            if (mask_data[i>>3] & (1<<(i&7)))
+              lobe.mask[i] = true;
+          }
+          lobes.push_back (lobe);
+        }
+        if (!in->good())
+          throw Exception ("premature end of FOD segmentation cache file \"" + path + "\"");
+        return true;
+      }
+
+
+
+
+      void Cache::store (const FOD_lobes& lobes)
+      {
+        assert (out);
+        if (!lobes.size())
+          return;
+        const int32_t vox[3] = { lobes.vox[0], lobes.vox[1], lobes.vox[2] };
+        out->write (reinterpret_cast<const char*> (vox), sizeof (vox));
+        cache_write (*out, uint32_t (lobes.size()));
+        cache_write (*out, uint32_t (lobes.lut.size()));
+        if (lobes.lut.size())
+          out->write (reinterpret_cast<const char*> (&lobes.lut[0]), lobes.lut.size());
+        const size_t mask_bytes = (dirs.size() + 7) / 8;
+        vector<uint8_t> mask_data (mask_bytes);
+        for (const FOD_lobe& lobe : lobes) {
+          cache_write (*out, uint8_t (lobe.is_negative() ? 1 : 0));
+          cache_write (*out, double (lobe.get_integral()));
+          cache_write (*out, double (lobe.get_max_peak_value()));
+          const double mean_dir[3] = { lobe.get_mean_dir()[0], lobe.get_mean_dir()[1], lobe.get_mean_dir()[2] };
+          out->write (reinterpret_cast<const char*> (mean_dir), sizeof (mean_dir));
+          cache_write (*out, uint32_t (lobe.num_peaks()));
+          for (size_t p = 0; p != lobe.num_peaks(); ++p) {
+            const double peak_dir[3] = { lobe.get_peak_dir(p)[0], lobe.get_peak_dir(p)[1], lobe.get_peak_dir(p)[2] };
+            out->write (reinterpret_cast<const char*> (peak_dir), sizeof (peak_dir));
+          }
+          std::fill (mask_data.begin(), mask_data.end(), uint8_t(0));
+          for (size_t i = 0; i != dirs.size(); ++i) {
+            if (lobe.get_mask()[i])
+              mask_data[i>>3] |= (1<<(i&7));
+          }
+          out->write (reinterpret_cast<const char*> (&mask_data[0]), mask_bytes);
+        }
+      }
+
+
+
+
+      void Cache::commit ()
+      {
+        assert (out);
+        out->close();
+        if (!*out)
+          throw Exception ("error writing FOD segmentation cache file \"" + path + ".tmp\"");
+        out.reset();
+        if (std::rename ((path + ".tmp").c_str(), path.c_str()))
+          throw Exception ("error committing FOD segmentation cache file \"" + path + "\": " + strerror (errno));
+      }
+
+
+
+
 
 
       IntegrationWeights::IntegrationWeights (const DWI::Directions::Set& dirs) :
@@ -191,7 +397,7 @@ namespace MR {
           for (uint32_t l = 0; l != out.size(); ++l) {
             if ((((i.first <= 0.0) &&  out[l].is_negative())
                   || ((i.first >  0.0) && !out[l].is_negative()))
-                && (out[l].get_mask().is_adjacent (i.second))) {
+                && (out[l].is_adjacent (i.second))) {
 
               adj_lobes.push_back (l);
 
@@ -15,6 +15,7 @@
 #ifndef __dwi_fmls_h__
 #define __dwi_fmls_h__
 
+#include <fstream> // Used for the segmentation cache
 #include <map> // Used for sorting FOD samples
 
 #include "memory.h"
@@ -53,17 +54,22 @@ namespace MR
 
 
       class Segmenter;
+      class Cache;
 
       // These are for configuring the FMLS segmenter at the command line, particularly for fod_metric command
       extern const App::OptionGroup FMLSSegmentOption;
       void load_fmls_thresholds (Segmenter&);
 
+      // For commands that support caching of the segmentation result (-fmls_cache)
+      extern const App::OptionGroup FMLSCacheOption;
+
 
       class FOD_lobe { MEMALIGN(FOD_lobe)
 
         public:
           FOD_lobe (const DWI::Directions::Set& dirs, const index_type seed, const default_type value, const default_type weight) :
               mask (dirs),
+              adjacency (dirs),
               values (Eigen::Array<default_type, Eigen::Dynamic, 1>::Zero (dirs.size())),
               max_peak_value (std::abs (value)),
               peak_dirs (1, dirs.get_dir (seed)),
@@ -72,6 +78,8 @@ namespace MR
               neg (value <= 0.0)
           {
             mask[seed] = true;
+            for (const auto& i : dirs.get_adj_dirs (seed))
+              adjacency[i] = true;
             values[seed] = value;
           }
 
@@ -79,6 +87,7 @@ namespace MR
           //   assigned to any other lobe in the voxel
           FOD_lobe (const DWI::Directions::Mask& i) :
               mask (i),
+              adjacency (i.get_dirs()),
               values (Eigen::Array<default_type, Eigen::Dynamic, 1>::Zero (i.size())),
               max_peak_value (0.0),
               integral (0.0),
@@ -89,6 +98,8 @@ namespace MR
           {
             assert ((value <= 0.0 && neg) || (value >= 0.0 && !neg));
             mask[bin] = true;
+            for (const auto& i : mask.get_dirs().get_adj_dirs (bin))
+              adjacency[i] = true;
             values[bin] = value;
             const Eigen::Vector3& dir = mask.get_dirs()[bin];
             const default_type multiplier = (mean_dir.dot (dir)) > 0.0 ? 1.0 : -1.0;
@@ -123,6 +134,7 @@ namespace MR
           {
             assert (neg == that.neg);
             mask |= that.mask;
+            adjacency |= that.adjacency;
             for (size_t i = 0; i != mask.size(); ++i)
               values[i] += that.values[i];
             if (that.max_peak_value > max_peak_value) {
@@ -137,6 +149,11 @@ namespace MR
           }
 
           const DWI::Directions::Mask& get_mask() const { return mask; }
+          //! test whether a direction adjoins this lobe
+          /*! the adjacency mask is maintained incrementally as directions are
+           * added, so this is a single bit test rather than a scan through
+           * the neighbours of direction \a bin */
+          bool is_adjacent (const index_type bin) const { return adjacency[bin]; }
           const Eigen::Array<default_type, Eigen::Dynamic, 1>& get_values() const { return values; }
           default_type get_max_peak_value() const { return max_peak_value; }
           size_t num_peaks() const { return peak_dirs.size(); }
@@ -147,7 +164,9 @@ namespace MR
 
 
         private:
+          friend class Cache; // Reconstructs lobes directly from a cache file
           DWI::Directions::Mask mask;
+          DWI::Directions::Mask adjacency; // all directions adjacent to any direction in the mask
           Eigen::Array<default_type, Eigen::Dynamic, 1> values;
           default_type max_peak_value;
           vector<Eigen::Vector3> peak_dirs;
@@ -238,6 +257,8 @@ namespace MR
           bool operator() (const SH_coefs&, FOD_lobes&) const;
 
 
+          const DWI::Directions::Set& get_directions    ()               const { return dirs; }
+          size_t       get_lmax                         ()               const { return lmax; }
           default_type get_integral_threshold           ()               const { return integral_threshold; }
           void         set_integral_threshold           (const default_type i) { integral_threshold = i; }
           default_type get_peak_value_threshold         ()               const { return peak_value_threshold; }
@@ -287,6 +308,69 @@ namespace MR
 
 
 
+      // Persistent cache of FOD segmentation results, shared across commands.
+      // The per-voxel lobe data (mean & peak directions, integrals, dixel masks
+      //   and direction lookup tables) are stored in a compact binary file, so
+      //   that subsequent commands operating on the same FOD image can reload
+      //   the segmentation rather than re-running it. The file header records a
+      //   content hash of the FOD image (and mask, if used) along with the
+      //   segmenter settings; a cache that does not match is discarded and
+      //   overwritten. Per-direction amplitudes and adjacency information are
+      //   deliberately not stored: no downstream consumer requires them once
+      //   segmentation is complete.
+      class Cache
+      { MEMALIGN (Cache)
+        public:
+          Cache (const std::string& path, Image<float>& fod, const Segmenter& fmls, Image<float> mask = Image<float>());
+
+          //! whether a valid matching cache was found, and lobes can be read back
+          bool ready () const { return bool (in); }
+
+          //! read the segmentation of the next cached voxel; returns false at end of file
+          bool read (FOD_lobes& out);
+
+          //! append the segmentation of one voxel to the cache being written
+          /*! voxels containing no lobes are skipped; this is only ever invoked
+           *  from the single-threaded sink end of the segmentation queue, and
+           *  hence requires no locking */
+          void store (const FOD_lobes& in);
+
+          //! finalise a cache being written, committing it to the target path
+          void commit ();
+
+        private:
+          const std::string path;
+          const DWI::Directions::Set& dirs;
+          std::unique_ptr<std::ifstream> in;
+          std::unique_ptr<std::ofstream> out;
+      };
+
+
+
+      //! Queue sink adapter that appends each segmented voxel to a Cache
+      //  before forwarding it to the actual sink
+      template <class Sink>
+      class CachingReceiver
+      { NOMEMALIGN
+        public:
+          CachingReceiver (Cache& cache, Sink& sink) :
+              cache (cache),
+              sink (sink) { }
+
+          bool operator() (const FOD_lobes& in)
+          {
+            cache.store (in);
+            return sink (in);
+          }
+
+        private:
+          Cache& cache;
+          Sink& sink;
+      };
+
+
+
+
     }
   }
 }
@@ -49,7 +49,12 @@ namespace MR {
                 for (auto l2 = Loop (3) (dwi); l2; ++l2) 
                   S(dwi.index(3), dwi.index(axis)) = dwi.value();
 
-              R.noalias() = H.selfadjointView<Eigen::Lower>() * S - S;
+              // Evaluate the product directly into the pre-allocated residual
+              //   workspace, then subtract in-place: writing the expression as
+              //   H*S - S would force Eigen to allocate a temporary for the
+              //   product on every row of voxels
+              R.noalias() = H.selfadjointView<Eigen::Lower>() * S;
+              R -= S;
 
               for (auto l = Loop (axis) (noise); l; ++l) {
                 R.col (noise.index (axis)).array() *= leverage.array();
@@ -15,6 +15,9 @@
 #ifndef __dwi_sdeconv_csd_h__
 #define __dwi_sdeconv_csd_h__
 
+#include <algorithm>
+#include <iterator>
+
 #include "app.h"
 #include "header.h"
 #include "dwi/gradient.h"
@@ -203,6 +206,14 @@ namespace MR
 #endif
               }
 
+              // factor the unconstrained normal matrix once; per-voxel solvers
+              //   copy this factor and apply rank-1 updates as constraints
+              //   enter or leave the active set, rather than refactoring from
+              //   scratch on every iteration
+              // (LLT only references the lower triangle, which is the only
+              //   part of Mt_M that has been filled in)
+              Mt_M_llt.compute (Mt_M);
+
               INFO ("constrained spherical deconvolution initialised successfully");
             }
 
@@ -214,6 +225,7 @@ namespace MR
             Eigen::VectorXd response, init_filter;
             Eigen::MatrixXd DW_dirs, HR_dirs;
             Eigen::MatrixXd rconv, HR_trans, M, Mt_M;
+            Eigen::LLT<Eigen::MatrixXd> Mt_M_llt;
             default_type neg_lambda, norm_lambda, threshold;
             vector<size_t> dwis;
             int lmax_response, lmax_data, lmax_cmdline, lmax;
@@ -247,6 +259,7 @@ namespace MR
             F.head (shared.rconv.rows()) = shared.rconv * DW_signals;
             F.tail (F.size()-shared.rconv.rows()).setZero();
             old_neg.assign (1, -1);
+            llt = shared.Mt_M_llt;
 
             Mt_b = shared.M.transpose() * DW_signals;
           }
@@ -261,16 +274,46 @@ namespace MR
           if (old_neg == neg)
             return true;
 
-          work.triangularView<Eigen::Lower>() = shared.Mt_M.triangularView<Eigen::Lower>();
+          // Successive active sets typically differ by only a few constraints,
+          //   so modify the existing Cholesky factor by rank-1 updates /
+          //   downdates rather than refactoring the full system; fall back to
+          //   a fresh factorisation when the active set has changed
+          //   substantially, or if a downdate fails numerically
+          added.clear();
+          removed.clear();
+          std::set_difference (neg.begin(), neg.end(), old_neg.begin(), old_neg.end(), std::back_inserter (added));
+          std::set_difference (old_neg.begin(), old_neg.end(), neg.begin(), neg.end(), std::back_inserter (removed));
+          // -1 is the sentinel planted by set(), not a real constraint
+          if (removed.size() && removed.front() == -1)
+            removed.erase (removed.begin());
+
+          bool factorised = false;
+          if (2 * (added.size() + removed.size()) < size_t (work.rows())) {
+            for (size_t i = 0; i < added.size() && llt.info() == Eigen::Success; ++i) {
+              HR_row = shared.HR_trans.row (added[i]);
+              llt.rankUpdate (HR_row, 1.0);
+            }
+            for (size_t i = 0; i < removed.size() && llt.info() == Eigen::Success; ++i) {
+              HR_row = shared.HR_trans.row (removed[i]);
+              llt.rankUpdate (HR_row, -1.0);
+            }
+            factorised = (llt.info() == Eigen::Success);
+          }
+
+          if (!factorised) {
+            work.triangularView<Eigen::Lower>() = shared.Mt_M.triangularView<Eigen::Lower>();
+
+            if (neg.size()) {
+              for (size_t i = 0; i < neg.size(); i++)
+                HR_T.row (i) = shared.HR_trans.row (neg[i]);
+              auto HR_T_view = HR_T.topRows (neg.size());
+              work.triangularView<Eigen::Lower>() += HR_T_view.transpose() * HR_T_view;
+            }
 
-          if (neg.size()) {
-            for (size_t i = 0; i < neg.size(); i++)
-              HR_T.row (i) = shared.HR_trans.row (neg[i]);
-            auto HR_T_view = HR_T.topRows (neg.size());
-            work.triangularView<Eigen::Lower>() += HR_T_view.transpose() * HR_T_view; 
+            llt.compute (work.triangularView<Eigen::Lower>());
           }
 
-          F.noalias() = llt.compute (work.triangularView<Eigen::Lower>()).solve (Mt_b);
+          F.noalias() = llt.solve (Mt_b);
 
           old_neg = neg;
 
@@ -284,9 +327,9 @@ namespace MR
 
       protected:
         Eigen::MatrixXd work, HR_T;
-        Eigen::VectorXd F, init_F, HR_amps, Mt_b;
+        Eigen::VectorXd F, init_F, HR_amps, Mt_b, HR_row;
         Eigen::LLT<Eigen::MatrixXd> llt;
-        vector<int> neg, old_neg;
+        vector<int> neg, old_neg, added, removed;
     };
 
 
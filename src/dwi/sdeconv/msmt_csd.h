@@ -246,7 +246,11 @@ namespace MR
           MSMT_CSD (const Shared& shared_data) :
               niter (0),
               shared (shared_data),
-              solver (shared.problem) { }
+              solver (shared.problem) {
+                // adjacent voxels present near-identical problems, so each
+                // solve starts from the previous voxel's active set
+                solver.set_warm_start (true);
+              }
 
           void operator() (const Eigen::VectorXd& data, Eigen::VectorXd& output) {
             niter = solver (output, data);
@@ -14,6 +14,8 @@
 
 #include "dwi/tractography/ACT/gmwmi.h"
 
+#include "algo/threaded_loop.h"
+
 
 namespace MR
 {
@@ -25,6 +27,39 @@ namespace MR
       {
 
 
+        Image<float> GMWMI_finder::generate_field (Image<float> data)
+        {
+          Header H (data);
+          H.size(3) = 2;
+          H.datatype() = DataType::Float32;
+          Stride::set (H, Stride::contiguous_along_axis (3, H));
+          auto field = Image<float>::scratch (H, "GM-WM interface field");
+          ThreadedLoop ("pre-computing GM-WM interface field", data, 0, 3).run (
+              [] (Image<float>& in, Image<float>& out)
+              {
+                in.index(3) = 0; const float cg = in.value();
+                in.index(3) = 1; const float sg = in.value();
+                in.index(3) = 2; const float w  = in.value();
+                in.index(3) = 3; const float c  = in.value();
+                in.index(3) = 4; const float p  = in.value();
+                float diff, sum;
+                if (std::isnan (cg) || std::isnan (sg) || std::isnan (w) || std::isnan (c) || std::isnan (p)) {
+                  // Invalid voxels must propagate through interpolation,
+                  //   just as they do for the raw tissue data
+                  diff = sum = NaN;
+                } else {
+                  const Tissues tissues (cg, sg, w, c, p);
+                  diff = tissues.get_gm() - tissues.get_wm();
+                  sum = tissues.get_cgm() + tissues.get_sgm() + tissues.get_wm() + tissues.get_csf() + tissues.get_path();
+                }
+                out.index(3) = 0; out.value() = diff;
+                out.index(3) = 1; out.value() = sum;
+              }, data, field);
+          return field;
+        }
+
+
+
         bool GMWMI_finder::find_interface (Eigen::Vector3f& p) const
         {
           Interp interp (interp_template);
@@ -55,8 +90,8 @@ namespace MR
 
         Eigen::Vector3f GMWMI_finder::find_interface (const vector< Eigen::Vector3f >& tck, const bool end) const
         {
-          Interp interp (interp_template);
-          return find_interface (tck, end, interp);
+          Interp field (field_template);
+          return find_interface (tck, end, field);
         }
 
 
@@ -66,10 +101,10 @@ namespace MR
         {
           if (tck.size() < 3)
             return;
-          Interp interp (interp_template);
-          const Eigen::Vector3f new_first_point = find_interface (tck, false, interp);
+          Interp field (field_template);
+          const Eigen::Vector3f new_first_point = find_interface (tck, false, field);
           tck[0] = new_first_point;
-          const Eigen::Vector3f new_last_point = find_interface (tck, true, interp);
+          const Eigen::Vector3f new_last_point = find_interface (tck, true, field);
           tck[tck.size() - 1] = new_last_point;
         }
 
@@ -79,23 +114,26 @@ namespace MR
 
         bool GMWMI_finder::find_interface (Eigen::Vector3f& p, Interp& interp) const {
 
-          Tissues tissues;
+          // The iterative search operates on the pre-computed (GM - WM) field;
+          //   the full tissue data are only interpolated in order to vet the
+          //   candidate point once the search has converged
+          Interp field (field_template);
 
+          Eigen::Vector2f values (0.0f, 0.0f);
           Eigen::Vector3f step (0.0, 0.0, 0.0);
           size_t gradient_iters = 0;
 
-          tissues = get_tissues (p, interp);
-
           do {
-            step = get_cf_min_step (p, interp);
+            step = get_cf_min_step (p, field);
             p += step;
-            tissues = get_tissues (p, interp);
-          } while (tissues.valid() && step.squaredNorm() && 
-              (std::abs (tissues.get_gm() - tissues.get_wm()) > GMWMI_ACCURACY) && 
+            values = get_field_values (p, field);
+          } while (field_valid (values) && step.squaredNorm() &&
+              (std::abs (values[0]) > GMWMI_ACCURACY) &&
               (++gradient_iters < GMWMI_MAX_ITERS_TO_FIND_BOUNDARY));
 
           // Make sure an appropriate cost function minimum has been found, and that
           //   this would be an acceptable termination point if it were processed by the tracking algorithm
+          const Tissues tissues = get_tissues (p, interp);
           if (!tissues.valid() || tissues.is_csf() || tissues.is_path() || !tissues.get_wm()
               || (std::abs (tissues.get_gm() - tissues.get_wm()) > GMWMI_ACCURACY)) {
 
@@ -107,7 +145,7 @@ namespace MR
           if (tissues.get_gm() >= tissues.get_wm())
             return true;
 
-          step = get_cf_min_step (p, interp);
+          step = get_cf_min_step (p, field);
           if (!step.allFinite())
             return true;
           if (!step.squaredNorm()) {
@@ -118,9 +156,9 @@ namespace MR
           do {
             step *= 1.5;
             p += step;
-            tissues = get_tissues (p, interp);
+            values = get_field_values (p, field);
 
-            if (tissues.valid() && (tissues.get_gm() >= tissues.get_wm()) && (tissues.get_gm() - tissues.get_wm() < GMWMI_ACCURACY))
+            if (field_valid (values) && (values[0] >= 0.0f) && (values[0] < GMWMI_ACCURACY))
               return true;
 
           } while (step.norm() < 0.5 * min_vox);
@@ -159,7 +197,7 @@ namespace MR
 
 
 
-        Eigen::Vector3f GMWMI_finder::get_cf_min_step (const Eigen::Vector3f& p, Interp& interp) const
+        Eigen::Vector3f GMWMI_finder::get_cf_min_step (const Eigen::Vector3f& p, Interp& field) const
         {
 
           Eigen::Vector3f grad (0.0, 0.0, 0.0);
@@ -168,16 +206,16 @@ namespace MR
 
             Eigen::Vector3f p_minus (p);
             p_minus[axis] -= 0.5 * GMWMI_PERTURBATION;
-            const Tissues v_minus = get_tissues (p_minus, interp);
+            const Eigen::Vector2f v_minus = get_field_values (p_minus, field);
 
             Eigen::Vector3f p_plus (p);
             p_plus[axis] += 0.5 * GMWMI_PERTURBATION;
-            const Tissues v_plus  = get_tissues (p_plus,  interp);
+            const Eigen::Vector2f v_plus  = get_field_values (p_plus,  field);
 
-            if (!v_minus.valid() || !v_plus.valid())
+            if (!field_valid (v_minus) || !field_valid (v_plus))
               return { 0.0, 0.0, 0.0 };
 
-            grad[axis] = (v_plus.get_gm() - v_plus.get_wm()) - (v_minus.get_gm() - v_minus.get_wm());
+            grad[axis] = v_plus[0] - v_minus[0];
 
           }
 
@@ -186,8 +224,9 @@ namespace MR
           if (!grad.squaredNorm())
             return { 0.0, 0.0, 0.0 };
 
-          const Tissues local_tissue = get_tissues (p, interp);
-          const float diff = local_tissue.get_gm() - local_tissue.get_wm();
+          const float diff = get_field_values (p, field)[0];
+          if (!std::isfinite (diff))
+            return { 0.0, 0.0, 0.0 };
 
           Eigen::Vector3f step = -grad * (diff / grad.squaredNorm());
 
@@ -202,7 +241,7 @@ namespace MR
 
 
 
-        Eigen::Vector3f GMWMI_finder::find_interface (const vector<Eigen::Vector3f>& tck, const bool end, Interp& interp) const
+        Eigen::Vector3f GMWMI_finder::find_interface (const vector<Eigen::Vector3f>& tck, const bool end, Interp& field) const
         {
 
           if (tck.size() == 0)
@@ -222,19 +261,15 @@ namespace MR
           const Eigen::Vector3f p_prev (end ? tck[last-1] : tck[1]);
 
           // Before proceeding, make sure that the interface lies somewhere in between these two points
-          if (!interp.scanner (p_end))
-            return p_end;
-          const Tissues t_end (interp);
-          if (!interp.scanner (p_prev))
-            return p_end;
-          const Tissues t_prev (interp);
-          if (! (((t_end.get_gm() > t_end.get_wm()) && (t_prev.get_gm() < t_prev.get_wm()))
-              || ((t_end.get_gm() < t_end.get_wm()) && (t_prev.get_gm() > t_prev.get_wm())))) {
+          const Eigen::Vector2f v_end  = get_field_values (p_end,  field);
+          const Eigen::Vector2f v_prev = get_field_values (p_prev, field);
+          if (! (((v_end[0] > 0.0f) && (v_prev[0] < 0.0f))
+              || ((v_end[0] < 0.0f) && (v_prev[0] > 0.0f)))) {
             return p_end;
           }
 
           // Also make sure that the existing endpoint doesn't already obey the criterion
-          if (t_end.get_gm() - t_end.get_wm() < GMWMI_ACCURACY)
+          if (v_end[0] < GMWMI_ACCURACY)
             return p_end;
 
           const Eigen::Vector3f curvature (end ? ((tck[last]-tck[last-1]) - (tck[last-1]-tck[last-2])) : ((tck[0]-tck[1]) - (tck[1]-tck[2])));
@@ -256,14 +291,15 @@ namespace MR
             const float mu =  0.5 * (min_mu + max_mu);
             hermite.set (mu);
             const Eigen::Vector3f p (hermite.value (domain));
-            interp.scanner (p);
-            const Tissues t (interp);
-            if (t.get_wm() > t.get_gm()) {
+            const Eigen::Vector2f v = get_field_values (p, field);
+            if (v[0] < 0.0f) {
               min_mu = mu;
             } else {
               max_mu = mu;
               p_best = p;
-              if (t.get_gm() - t.get_wm() < GMWMI_ACCURACY)
+              // A non-finite value (out-of-bounds / invalid sample) terminates
+              //   the search here, just as an invalid tissue set did previously
+              if (!(v[0] >= GMWMI_ACCURACY))
                 return p_best;
             }
           } while (++iters != GMWMI_MAX_ITERS_TO_FIND_BOUNDARY);
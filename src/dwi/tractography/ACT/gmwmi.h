@@ -54,15 +54,18 @@ namespace MR
           public:
             GMWMI_finder (const Image<float>& buffer) :
               interp_template (buffer),
-              min_vox (std::min (buffer.spacing(0), std::min (buffer.spacing(1), buffer.spacing(2)))) { }
+              min_vox (std::min (buffer.spacing(0), std::min (buffer.spacing(1), buffer.spacing(2)))),
+              field_template (generate_field (buffer)) { }
 
             GMWMI_finder (const Interp& interp) :
               interp_template (interp),
-              min_vox (std::min (interp.spacing(0), std::min (interp.spacing(1), interp.spacing(2)))) { }
+              min_vox (std::min (interp.spacing(0), std::min (interp.spacing(1), interp.spacing(2)))),
+              field_template (generate_field (interp)) { }
 
             GMWMI_finder (const GMWMI_finder& that) :
               interp_template (that.interp_template),
-              min_vox (that.min_vox) { }
+              min_vox (that.min_vox),
+              field_template (that.field_template) { }
 
 
             bool find_interface (Eigen::Vector3f&) const;
@@ -78,6 +81,13 @@ namespace MR
             const Interp interp_template;
             const float min_vox;
 
+            //! pre-computed two-volume field used by the iterative interface search:
+            //   volume 0 contains the (GM - WM) tissue difference, volume 1 the sum
+            //   of all five tissue fractions. Since interpolation is linear, sampling
+            //   these pre-computed volumes yields the same values as deriving them
+            //   from the five individually-interpolated tissue fractions
+            const Interp field_template;
+
 
             Tissues get_tissues (const Eigen::Vector3f& p, Interp& interp) const {
               if (!interp.scanner (p))
@@ -85,12 +95,26 @@ namespace MR
               return Tissues (interp);
             }
 
+            //! interpolated [ GM - WM, tissue sum ] from the pre-computed field
+            Eigen::Vector2f get_field_values (const Eigen::Vector3f& p, Interp& field) const {
+              if (!field.scanner (p))
+                return Eigen::Vector2f (NaN, NaN);
+              const Eigen::Matrix<float, Eigen::Dynamic, 1> values (field.row (3));
+              return Eigen::Vector2f (values[0], values[1]);
+            }
+
+            static bool field_valid (const Eigen::Vector2f& values) {
+              return (std::isfinite (values[1]) && values[1] >= TISSUE_SUM_THRESHOLD);
+            }
+
             bool find_interface (Eigen::Vector3f&, Interp&) const;
             Eigen::Vector3f get_normal (const Eigen::Vector3f&, Interp&) const;
             Eigen::Vector3f get_cf_min_step (const Eigen::Vector3f&, Interp&) const;
 
             Eigen::Vector3f find_interface (const vector<Eigen::Vector3f>&, const bool, Interp&) const;
 
+            static Image<float> generate_field (Image<float>);
+
 
             friend class Track_extender;
             friend class Tractography::Seeding::Dynamic_ACT_additions;
@@ -15,6 +15,8 @@
 #ifndef __dwi_tractography_act_tissues_h__
 #define __dwi_tractography_act_tissues_h__
 
+#include "types.h"
+
 
 // If the sum of tissue probabilities is below this threshold, the image is being exited, so a boolean flag is thrown
 // The values will however still be accessible
@@ -92,12 +94,14 @@ namespace MR
             template <class ImageType>
             bool set (ImageType& data)
             {
-              data.index(3) = 0; const float cg = data.value();
-              data.index(3) = 1; const float sg = data.value();
-              data.index(3) = 2; const float w  = data.value();
-              data.index(3) = 3; const float c  = data.value();
-              data.index(3) = 4; const float p  = data.value();
-              return set (cg, sg, w, c, p);
+              // Fetch all five tissue fractions in a single pass; in particular,
+              //   when data are accessed through an interpolator, this visits each
+              //   voxel in the interpolation neighbourhood only once, applying the
+              //   interpolation weights to all five channels together, rather than
+              //   re-walking the neighbourhood once per tissue
+              const Eigen::Matrix<float, Eigen::Dynamic, 1> values (data.row (3));
+              assert (values.size() == 5);
+              return set (values[0], values[1], values[2], values[3], values[4]);
             }
 
             void reset() {
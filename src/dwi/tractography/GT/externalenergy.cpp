@@ -14,6 +14,8 @@
 
 #include "dwi/tractography/GT/externalenergy.h"
 
+#include "dwi/tractography/GT/particlegrid.h"
+
 #include "dwi/gradient.h"
 #include "dwi/shells.h"
 #include "math/SH.h"
@@ -21,11 +23,14 @@
 #include "algo/loop.h"
 
 
+#define DELTA_LOOKUP_BINS 2048
+
+
 namespace MR {
   namespace DWI {
     namespace Tractography {
       namespace GT {
-        
+
         ExternalEnergyComputer::ExternalEnergyComputer(Stats& stat, const Image<float>& dwimage, const Properties& props)
           : EnergyComputer(stat),
             dwi(dwimage),
@@ -107,7 +112,10 @@ namespace MR {
           
           // Set NNLS solver ------------------------------------------------------------
           nnls = Math::ICLS::Problem<double>(Ak, Eigen::MatrixXd::Identity(nf+1, nf+1));
-          
+
+          // Precompute SH delta lookup table -------------------------------------------
+          initDeltaLookup();
+
           // Reset energy ---------------------------------------------------------------
           resetEnergy();
         }
@@ -136,6 +144,24 @@ namespace MR {
         }
         
         
+        void ExternalEnergyComputer::restore(ParticleGrid& pgrid)
+        {
+          DEBUG("Restore external energy from particle configuration.");
+          // Accumulate the TOD contribution of every particle, bypassing the
+          // energy evaluation of the staging machinery; a single resetEnergy()
+          // pass then recomputes the energy and isotropic fraction maps.
+          pgrid.forall ([this] (const Particle& par) {
+              add(par.getPosition(), par.getDirection(), 1.0);
+              for (size_t k = 0; k != changes_vox.size(); ++k) {
+                assign_pos_of(changes_vox[k], 0, 3).to(tod);
+                tod.row(3) = changes_tod[k];
+              }
+              clearChanges();
+            });
+          resetEnergy();
+        }
+
+
         void ExternalEnergyComputer::acceptChanges()
         {
           assert (changes_vox.size() == changes_tod.size());
@@ -168,14 +194,73 @@ namespace MR {
         }
         
         
+        void ExternalEnergyComputer::initDeltaLookup()
+        {
+          // Tabulate the azimuth-independent part of the SH delta function
+          // over elevation: row i holds the coefficients for theta = i*pi/N,
+          // evaluated with unit azimuthal factors. The associated Legendre
+          // terms are band-limited trigonometric polynomials in theta, so
+          // linear interpolation between adjacent rows is accurate to well
+          // below the noise floor, and each proposal direction then only
+          // costs a table fetch plus the (cheap) azimuthal recurrence,
+          // instead of the full set of Legendre recurrences.
+          Eigen::MatrixXd* table = new Eigen::MatrixXd (DELTA_LOOKUP_BINS+1, ncols);
+          Eigen::Matrix<double,Eigen::Dynamic,1,0,64> AL (lmax+1);
+          for (int i = 0; i <= DELTA_LOOKUP_BINS; ++i) {
+            const double z = std::cos (i * Math::pi / DELTA_LOOKUP_BINS);
+            Math::Legendre::Plm_sph (AL, lmax, 0, z);
+            for (int l = 0; l <= lmax; l += 2)
+              (*table)(i, Math::SH::index (l,0)) = AL[l];
+            for (int m = 1; m <= lmax; m++) {
+              Math::Legendre::Plm_sph (AL, lmax, m, z);
+              for (int l = ((m&1) ? m+1 : m); l <= lmax; l += 2) {
+#ifndef USE_NON_ORTHONORMAL_SH_BASIS
+                (*table)(i, Math::SH::index (l,m))  = AL[l] * Math::sqrt2;
+                (*table)(i, Math::SH::index (l,-m)) = AL[l] * Math::sqrt2;
+#else
+                (*table)(i, Math::SH::index (l,m))  = AL[l] * 2.0;
+                (*table)(i, Math::SH::index (l,-m)) = AL[l] * 2.0;
+#endif
+              }
+            }
+          }
+          delta_lookup.reset (table);
+        }
+
+
+        void ExternalEnergyComputer::deltaLookup(const Point_t &dir)
+        {
+          const double rxy = std::sqrt (Math::pow2 (double (dir[1])) + Math::pow2 (double (dir[0])));
+          const double cp = (rxy) ? dir[0]/rxy : 1.0;
+          const double sp = (rxy) ? dir[1]/rxy : 0.0;
+          const double theta = std::acos (std::min (1.0, std::max (-1.0, double (dir[2]))));
+          const double fbin = theta * (DELTA_LOOKUP_BINS / Math::pi);
+          const size_t bin = std::min (size_t (fbin), size_t (DELTA_LOOKUP_BINS-1));
+          const double f = fbin - bin;
+          d = ((1.0-f) * delta_lookup->row (bin) + f * delta_lookup->row (bin+1)).transpose();
+          // apply the azimuthal factors the table was built without:
+          double c0 (1.0), s0 (0.0);
+          for (int m = 1; m <= lmax; m++) {
+            const double c = c0 * cp - s0 * sp;
+            const double s = s0 * cp + c0 * sp;
+            for (int l = ((m&1) ? m+1 : m); l <= lmax; l += 2) {
+              d[Math::SH::index (l,m)]  *= c;
+              d[Math::SH::index (l,-m)] *= s;
+            }
+            c0 = c;
+            s0 = s;
+          }
+        }
+
+
         void ExternalEnergyComputer::add(const Point_t &pos, const Point_t &dir, const double factor)
         {
           Point_t p = T.cast<float>() * pos;
           Point_t v = Point_t(Math::floor<float>(p[0]), Math::floor<float>(p[1]), Math::floor<float>(p[2]));
           Point_t w = Point_t(hanning(p[0]-v[0]), hanning(p[1]-v[1]), hanning(p[2]-v[2]));
-          
-          Math::SH::delta(d, dir, lmax);
-          
+
+          deltaLookup(dir);
+
           Eigen::Vector3i x = v.cast<int>();
           add2vox(x, factor*(1.-w[0])*(1.-w[1])*(1.-w[2]));
           x[2]++;
@@ -28,7 +28,9 @@ namespace MR {
   namespace DWI {
     namespace Tractography {
       namespace GT {
-        
+
+        class ParticleGrid;
+
         class ExternalEnergyComputer : public EnergyComputer
         { MEMALIGN(ExternalEnergyComputer)
         public:
@@ -41,7 +43,11 @@ namespace MR {
           Image<float>& getEext() { return eext; }
           
           void resetEnergy();
-          
+
+          //! Re-derive the TOD image and energy maps from a particle configuration,
+          //  as restored from a checkpoint file.
+          void restore(ParticleGrid& pgrid);
+
           double stageAdd(const Point_t& pos, const Point_t& dir)
           {
             add(pos, dir, 1.0);
@@ -85,7 +91,11 @@ namespace MR {
           Eigen::VectorXd y, t, d, fk;
           
           Math::ICLS::Problem<double> nnls;
-          
+
+          //! azimuth-independent part of the SH delta function, tabulated
+          //  over elevation; shared (read-only) across clones
+          std::shared_ptr<const Eigen::MatrixXd> delta_lookup;
+
           vector<Eigen::Vector3i > changes_vox;
           vector<Eigen::VectorXd > changes_tod;
           vector<Eigen::VectorXd > changes_fiso;
@@ -93,8 +103,13 @@ namespace MR {
           
           
           void add(const Point_t& pos, const Point_t& dir, const double factor = 1.);
-          
+
           void add2vox(const Eigen::Vector3i& vox, const double w);
+
+          void initDeltaLookup();
+
+          //! evaluate the SH delta function along \a dir into \c d via the lookup table
+          void deltaLookup(const Point_t& dir);
           
           double eval();
           
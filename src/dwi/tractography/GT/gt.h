@@ -19,11 +19,13 @@
 #define FRAC_BURNIN 10
 #define FRAC_PHASEOUT 10
 
+#include <fstream>
 #include <iostream>
 #include <mutex>
 
 #include <Eigen/Dense>
 
+#include "exception.h"
 #include "progressbar.h"
 #include "types.h"
 
@@ -66,8 +68,8 @@ namespace MR {
         { MEMALIGN(Stats)
         public:
           
-          Stats(const double T0, const double T1, const uint64_t maxiter) 
-            : Text(T1), Tint(T0), EextTot(0.0), EintTot(0.0), n_iter(0), n_max(maxiter), 
+          Stats(const double T0, const double T1, const uint64_t maxiter)
+            : Text(T1), Tint(T0), EextTot(0.0), EintTot(0.0), n_iter(0), n_max(maxiter), n_target(maxiter),
               progress("running MH sampler", n_max/ITER_BIGSTEP)
           {
             for (int k = 0; k != 5; k++)
@@ -95,9 +97,59 @@ namespace MR {
               progress++;
               out << *this << std::endl;
             }
-            return (n_iter < n_max);
+            return (n_iter < n_target);
           }
-          
+
+
+          uint64_t getIterations() const {
+            return n_iter;
+          }
+
+          /**
+           * Set the iteration count at which the sampler threads should return,
+           * so that the optimisation can be run in bounded stretches with a
+           * consistent snapshot taken in between. Clamped to the total no.
+           * iterations; call again to launch the next stretch.
+           */
+          void setTargetIterations(uint64_t target) {
+            std::lock_guard<std::mutex> lock (mutex);
+            n_target = std::min(target, n_max);
+          }
+
+
+          //! Serialise the full optimisation state to a checkpoint stream.
+          void save(std::ostream& o) const {
+            auto write_u64 = [&](const uint64_t v) { o.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+            auto write_f64 = [&](const double v) { o.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+            write_u64(n_max);
+            write_u64(n_iter);
+            write_f64(Tint);
+            write_f64(EextTot);
+            write_f64(EintTot);
+            for (int k = 0; k != 5; k++)
+              write_u64(n_gen[k]);
+            for (int k = 0; k != 5; k++)
+              write_u64(n_acc[k]);
+          }
+
+          //! Restore the optimisation state from a checkpoint stream.
+          void load(std::istream& i) {
+            auto read_u64 = [&]() { uint64_t v = 0; i.read(reinterpret_cast<char*>(&v), sizeof(v)); return v; };
+            auto read_f64 = [&]() { double v = 0.0; i.read(reinterpret_cast<char*>(&v), sizeof(v)); return v; };
+            if (read_u64() != n_max)
+              throw Exception("checkpoint file was created with a different number of iterations (-niter)");
+            n_iter = read_u64();
+            Tint = read_f64();
+            EextTot = read_f64();
+            EintTot = read_f64();
+            for (int k = 0; k != 5; k++)
+              n_gen[k] = read_u64();
+            for (int k = 0; k != 5; k++)
+              n_acc[k] = read_u64();
+            for (uint64_t n = ITER_BIGSTEP; n <= n_iter; n += ITER_BIGSTEP)
+              progress++;
+          }
+
           
           // getters and setters ----------------------------------------------
           
@@ -200,10 +252,11 @@ namespace MR {
           double EextTot, EintTot;
           double alpha;
 
-          unsigned long n_gen[5];
-          unsigned long n_acc[5];
-          unsigned long n_iter;
+          uint64_t n_gen[5];
+          uint64_t n_acc[5];
+          uint64_t n_iter;
           const uint64_t n_max;
+          uint64_t n_target;
           
           ProgressBar progress;
           std::ofstream out;
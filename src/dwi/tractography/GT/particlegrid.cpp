@@ -14,6 +14,9 @@
 
 #include "dwi/tractography/GT/particlegrid.h"
 
+#include <limits>
+#include <unordered_map>
+
 namespace MR {
   namespace DWI {
     namespace Tractography {
@@ -31,16 +34,16 @@ namespace MR {
         {
           size_t gidx0 = pos2idx(p->getPosition());
           size_t gidx1 = pos2idx(pos);
-          std::remove (grid[gidx0].begin(), grid[gidx0].end(), p);
+          grid[gidx0].erase (std::remove (grid[gidx0].begin(), grid[gidx0].end(), p), grid[gidx0].end());
           p->setPosition(pos);
           p->setDirection(dir);
           grid[gidx1].push_back(p);
         }
-        
+
         void ParticleGrid::remove(Particle* p)
         {
           size_t gidx0 = pos2idx(p->getPosition());
-          std::remove (grid[gidx0].begin(), grid[gidx0].end(), p);
+          grid[gidx0].erase (std::remove (grid[gidx0].begin(), grid[gidx0].end(), p), grid[gidx0].end());
           pool.destroy(p);
         }
         
@@ -112,7 +115,112 @@ namespace MR {
             }
           }
         }
-        
+
+
+        namespace {
+          // Raw little-or-native-endian binary records; checkpoint files are
+          // only ever read back on the host that wrote them.
+          template <typename X>
+          inline void checkpoint_write(std::ostream& out, const X& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(X));
+          }
+          template <typename X>
+          inline void checkpoint_read(std::istream& in, X& value) {
+            in.read(reinterpret_cast<char*>(&value), sizeof(X));
+          }
+          constexpr uint64_t checkpoint_nolink = std::numeric_limits<uint64_t>::max();
+        }
+
+
+        void ParticleGrid::save(std::ostream& out)
+        {
+          std::lock_guard<std::mutex> lock (mutex);
+          checkpoint_write(out, Particle::L);
+          for (int a = 0; a != 3; a++)
+            checkpoint_write(out, uint64_t(dims[a]));
+          // Assign a file index to every particle, so that the connectivity
+          // can be stored independently of the memory layout of the pool.
+          std::unordered_map<const Particle*, uint64_t> index;
+          vector<const Particle*> particles;
+          for (const ParticleVectorType& gridvox : grid) {
+            for (const Particle* par : gridvox) {
+              index[par] = particles.size();
+              particles.push_back(par);
+            }
+          }
+          checkpoint_write(out, uint64_t(particles.size()));
+          for (const Particle* par : particles) {
+            for (int a = 0; a != 3; a++)
+              checkpoint_write(out, par->getPosition()[a]);
+            for (int a = 0; a != 3; a++)
+              checkpoint_write(out, par->getDirection()[a]);
+            checkpoint_write(out, par->hasPredecessor() ? index.at(par->getPredecessor()) : checkpoint_nolink);
+            checkpoint_write(out, par->hasSuccessor() ? index.at(par->getSuccessor()) : checkpoint_nolink);
+          }
+        }
+
+
+        void ParticleGrid::load(std::istream& in)
+        {
+          std::lock_guard<std::mutex> lock (mutex);
+          float length = 0.0f;
+          checkpoint_read(in, length);
+          if (length != Particle::L)
+            throw Exception("particle length in checkpoint file does not match -length");
+          for (int a = 0; a != 3; a++) {
+            uint64_t d = 0;
+            checkpoint_read(in, d);
+            if (d != dims[a])
+              throw Exception("checkpoint file does not match the dimensions of the input image");
+          }
+          uint64_t count = 0;
+          checkpoint_read(in, count);
+          vector<Particle*> particles;
+          particles.reserve(count);
+          vector<uint64_t> pred (count), succ (count);
+          Point_t pos, dir;
+          for (uint64_t i = 0; i != count; i++) {
+            for (int a = 0; a != 3; a++)
+              checkpoint_read(in, pos[a]);
+            for (int a = 0; a != 3; a++)
+              checkpoint_read(in, dir[a]);
+            checkpoint_read(in, pred[i]);
+            checkpoint_read(in, succ[i]);
+            Particle* par = pool.create(pos, dir);
+            grid[pos2idx(pos)].push_back(par);
+            particles.push_back(par);
+          }
+          if (!in.good())
+            throw Exception("premature end of checkpoint file");
+          // Re-establish the connectivity. Every link is stored from both ends;
+          // process it once, from the lower file index, and consume the matching
+          // slot on the other end so that each stored slot is used exactly once.
+          auto consume = [&](const uint64_t j, const uint64_t i) -> int {
+            if (pred[j] == i) {
+              pred[j] = checkpoint_nolink;
+              return -1;
+            }
+            if (succ[j] == i) {
+              succ[j] = checkpoint_nolink;
+              return +1;
+            }
+            throw Exception("invalid particle connectivity in checkpoint file");
+          };
+          for (uint64_t i = 0; i != count; i++) {
+            if (pred[i] != checkpoint_nolink && pred[i] > i) {
+              if (pred[i] >= count)
+                throw Exception("invalid particle connectivity in checkpoint file");
+              particles[i]->connectPredecessor(particles[pred[i]], consume(pred[i], i));
+            }
+            if (succ[i] != checkpoint_nolink && succ[i] > i) {
+              if (succ[i] >= count)
+                throw Exception("invalid particle connectivity in checkpoint file");
+              particles[i]->connectSuccessor(particles[succ[i]], consume(succ[i], i));
+            }
+          }
+        }
+
+
 
       }
     }
@@ -84,8 +84,25 @@ namespace MR {
           }
           
           void exportTracks(Tractography::Writer<float>& writer);
-          
-          
+
+          //! Serialise all particles and their connectivity to a checkpoint stream.
+          void save(std::ostream& out);
+
+          //! Restore the particle configuration from a checkpoint stream.
+          /*! The grid must be empty; derived quantities (TOD image, energy maps)
+           *  are not part of the snapshot and need to be recomputed afterwards. */
+          void load(std::istream& in);
+
+          //! Apply a functor to every particle in the grid.
+          template <class Functor>
+          void forall(Functor&& fun) {
+            std::lock_guard<std::mutex> lock (mutex);
+            for (ParticleVectorType& gridvox : grid)
+              for (Particle* par : gridvox)
+                fun(*par);
+          }
+
+
         protected:
           std::mutex mutex;
           ParticlePool pool;
@@ -15,97 +15,165 @@
 #ifndef __gt_particlepool_h__
 #define __gt_particlepool_h__
 
+#include <atomic>
 #include <deque>
 #include <stack>
 #include <mutex>
 
+#include "exception.h"
 #include "math/rng.h"
 
 #include "dwi/tractography/GT/particle.h"
 
+// Particles are allocated in fixed-size chunks, indexed through a fixed table
+//   of atomic pointers, so that concurrent readers never need a lock
+#define GT_PARTICLE_POOL_CHUNK_SHIFT 13   // 8192 particles per chunk
+#define GT_PARTICLE_POOL_MAX_CHUNKS 8192  // supports up to ~67M concurrent particles
+
+// Number of independent free-list stripes; recycling of destroyed particles
+//   rotates across these, so that sampler threads performing birth / death
+//   proposals rarely contend on the same lock
+#define GT_PARTICLE_POOL_STRIPES 16
+
 namespace MR {
   namespace DWI {
     namespace Tractography {
       namespace GT {
-        
+
         /**
          * @brief ParticlePool manages creation and deletion of particles,
          *        minimizing the no. calls to new/delete.
+         *
+         * Designed to scale with the number of sampler threads: particle
+         * storage is chunked and indexed through atomic pointers so that
+         * random() and size() never take a lock, and the free list of
+         * destroyed particles is striped across several independent stacks
+         * so that create() and destroy() rarely contend.
          */
         class ParticlePool
         { MEMALIGN(ParticlePool)
         public:
-          ParticlePool() { }
-          
+          ParticlePool() :
+              num_slots (0),
+              num_alive (0),
+              counter (0)
+          {
+            for (size_t n = 0; n != GT_PARTICLE_POOL_MAX_CHUNKS; ++n)
+              chunks[n].store (nullptr, std::memory_order_relaxed);
+          }
+
           ParticlePool(const ParticlePool&) = delete;
           ParticlePool& operator=(const ParticlePool&) = delete;
-          ~ParticlePool() { }
-          
+          ~ParticlePool() { clear(); }
+
           /**
            * @brief Creates a new particle and returns a pointer to its address.
            */
           Particle* create(const Point_t& pos, const Point_t& dir)
           {
-            std::lock_guard<std::mutex> lock (mutex);
-            if (avail.empty()) {
-              pool.emplace_back(pos, dir);
-              return &pool.back();
-            } else {
-              Particle* p = avail.top();
-              p->init(pos, dir);
-              avail.pop();
-              return p;
+            // First try to recycle a destroyed particle from one of the stripes
+            const size_t start = counter.fetch_add (1, std::memory_order_relaxed) % GT_PARTICLE_POOL_STRIPES;
+            for (size_t s = 0; s != GT_PARTICLE_POOL_STRIPES; ++s) {
+              Stripe& stripe = stripes[(start + s) % GT_PARTICLE_POOL_STRIPES];
+              std::lock_guard<std::mutex> lock (stripe.mutex);
+              if (!stripe.avail.empty()) {
+                Particle* p = stripe.avail.top();
+                stripe.avail.pop();
+                p->init (pos, dir);
+                num_alive.fetch_add (1, std::memory_order_relaxed);
+                return p;
+              }
+            }
+            // None available: claim a fresh slot
+            const size_t index = num_slots.fetch_add (1, std::memory_order_relaxed);
+            const size_t chunk = index >> GT_PARTICLE_POOL_CHUNK_SHIFT;
+            if (chunk >= GT_PARTICLE_POOL_MAX_CHUNKS)
+              throw Exception ("maximum number of particles in global tractography exceeded");
+            Particle* base = chunks[chunk].load (std::memory_order_acquire);
+            if (!base) {
+              std::lock_guard<std::mutex> lock (chunk_mutex);
+              base = chunks[chunk].load (std::memory_order_acquire);
+              if (!base) {
+                base = new Particle [size_t(1) << GT_PARTICLE_POOL_CHUNK_SHIFT];
+                chunks[chunk].store (base, std::memory_order_release);
+              }
             }
+            Particle* p = base + (index & ((size_t(1) << GT_PARTICLE_POOL_CHUNK_SHIFT) - 1));
+            p->init (pos, dir);
+            num_alive.fetch_add (1, std::memory_order_relaxed);
+            return p;
           }
-          
+
           /**
            * @brief Destroys the particle at pointer p.
            */
           void destroy(Particle* p) {
-            std::lock_guard<std::mutex> lock (mutex);
             p->finalize();
-            avail.push(p);
+            num_alive.fetch_sub (1, std::memory_order_relaxed);
+            Stripe& stripe = stripes[counter.fetch_add (1, std::memory_order_relaxed) % GT_PARTICLE_POOL_STRIPES];
+            std::lock_guard<std::mutex> lock (stripe.mutex);
+            stripe.avail.push (p);
           }
-          
+
           /**
            * @brief Return number of Particles in the pool.
            */
           inline size_t size() const {
-            return pool.size() - avail.size();
+            return num_alive.load (std::memory_order_relaxed);
           }
-          
+
           /**
            * @brief Select random particle from the pool (uniformly).
            */
           Particle* random() {
-            std::lock_guard<std::mutex> lock (mutex);
-            if (pool.size() > avail.size())
-            {
-              std::uniform_int_distribution<size_t> dist(0, pool.size()-1);
-              for (int k = 0; k != 5; ++k) {
-                Particle* p = &pool[dist(rng)];
-                if (p->isAlive())
-                  return p;
-              }
+            static thread_local Math::RNG rng;
+            const size_t n = num_slots.load (std::memory_order_acquire);
+            if (!n || !num_alive.load (std::memory_order_relaxed))
+              return nullptr;
+            std::uniform_int_distribution<size_t> dist(0, n-1);
+            for (int k = 0; k != 5; ++k) {
+              const size_t index = dist (rng);
+              Particle* base = chunks[index >> GT_PARTICLE_POOL_CHUNK_SHIFT].load (std::memory_order_acquire);
+              if (!base)
+                continue;
+              Particle* p = base + (index & ((size_t(1) << GT_PARTICLE_POOL_CHUNK_SHIFT) - 1));
+              if (p->isAlive())
+                return p;
             }
             return nullptr;
           }
-          
+
           /**
            * @brief Clear pool.
            */
           void clear() {
-            std::lock_guard<std::mutex> lock (mutex);
-            pool.clear();
-            std::stack<Particle*, deque<Particle*> > e {};
-            avail.swap(e);
+            std::lock_guard<std::mutex> lock (chunk_mutex);
+            for (size_t n = 0; n != GT_PARTICLE_POOL_MAX_CHUNKS; ++n) {
+              delete [] chunks[n].load (std::memory_order_acquire);
+              chunks[n].store (nullptr, std::memory_order_release);
+            }
+            num_slots.store (0, std::memory_order_relaxed);
+            num_alive.store (0, std::memory_order_relaxed);
+            for (size_t s = 0; s != GT_PARTICLE_POOL_STRIPES; ++s) {
+              std::lock_guard<std::mutex> stripe_lock (stripes[s].mutex);
+              std::stack<Particle*, deque<Particle*> > e {};
+              stripes[s].avail.swap(e);
+            }
           }
-          
+
         protected:
-          std::mutex mutex;
-          deque<Particle> pool;
-          std::stack<Particle*, deque<Particle*> > avail;
-          Math::RNG rng;
+          class Stripe
+          { MEMALIGN(Stripe)
+            public:
+              std::mutex mutex;
+              std::stack<Particle*, deque<Particle*> > avail;
+          };
+
+          std::atomic<Particle*> chunks[GT_PARTICLE_POOL_MAX_CHUNKS];
+          std::atomic<size_t> num_slots, num_alive;
+          std::atomic<size_t> counter;
+          std::mutex chunk_mutex;
+          Stripe stripes[GT_PARTICLE_POOL_STRIPES];
         };
 
       }
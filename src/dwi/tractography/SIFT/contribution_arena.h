@@ -0,0 +1,113 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __dwi_tractography_sift_contribution_arena_h__
+#define __dwi_tractography_sift_contribution_arena_h__
+
+
+#include <memory>
+#include <mutex>
+
+#include "exception.h"
+#include "types.h"
+#include "file/entry.h"
+#include "file/mmap.h"
+#include "file/utils.h"
+
+
+// Size of each temporary backing file; these are created sparse, so only
+//   those regions actually written to consume disk space
+#define SIFT_CONTRIBUTION_ARENA_CHUNK_SIZE 1073741824
+
+
+namespace MR
+{
+  namespace DWI
+  {
+    namespace Tractography
+    {
+      namespace SIFT
+      {
+
+
+
+      //! file-backed allocation arena for streamline contribution data
+      /*! When requested, the SIFT model stores the per-streamline fixel
+       * contribution data in temporary memory-mapped files rather than on the
+       * heap. This allocator hands out space from large file-backed chunks,
+       * so that under memory pressure the operating system can evict
+       * contribution pages to their backing files rather than swapping or
+       * failing outright; resident memory is therefore bounded independently
+       * of the number of streamlines. Allocations are never returned
+       * individually: the backing files are deleted when the arena itself is
+       * destroyed (i.e. when the model goes out of scope). */
+      class ContributionArena { NOMEMALIGN
+
+        public:
+          ContributionArena (const size_t chunk = SIFT_CONTRIBUTION_ARENA_CHUNK_SIZE) :
+            chunk_size (chunk),
+            capacity (0),
+            offset (0) { }
+
+          ContributionArena (const ContributionArena&) = delete;
+          ContributionArena& operator= (const ContributionArena&) = delete;
+
+          ~ContributionArena ()
+          {
+            vector<std::string> names;
+            for (const auto& chunk : chunks)
+              names.push_back (chunk->name());
+            chunks.clear();
+            for (const auto& name : names) {
+              try {
+                File::unlink (name);
+              } catch (Exception& e) {
+                e.display (2);
+              }
+            }
+          }
+
+          //! thread-safe; returns zero-initialised, 8-byte aligned storage
+          void* allocate (const size_t bytes)
+          {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (offset + bytes > capacity) {
+              capacity = std::max (chunk_size, bytes);
+              const std::string name = File::create_tempfile (capacity, "sift");
+              chunks.push_back (std::unique_ptr<File::MMap> (new File::MMap (File::Entry (name), true, false)));
+              offset = 0;
+            }
+            void* const retval = chunks.back()->address() + offset;
+            offset = (offset + bytes + 7) & ~size_t(7);
+            return retval;
+          }
+
+
+        private:
+          std::mutex mutex;
+          const size_t chunk_size;
+          size_t capacity, offset;
+          vector<std::unique_ptr<File::MMap>> chunks;
+
+      };
+
+
+
+      }
+    }
+  }
+}
+
+
+#endif
@@ -32,11 +32,14 @@ namespace MR
 
 
 
-      MT_gradient_vector_sorter::MT_gradient_vector_sorter (MT_gradient_vector_sorter::VecType& in, const track_t block_size)
+      MT_gradient_vector_sorter::MT_gradient_vector_sorter (MT_gradient_vector_sorter::VecType& in, const track_t block_size) :
+        data (in)
       {
         BlockSender source (in.size(), block_size);
         Sorter      pipe   (in);
-        Thread::run_queue (source, TrackIndexRange(), Thread::multi (pipe), VecItType(), *this);
+        Thread::run_queue (source, TrackIndexRange(), Thread::multi (pipe), SortedBlock(), *this);
+        std::sort (blocks.begin(), blocks.end(),
+            [] (const SortedBlock& a, const SortedBlock& b) { return a.start < b.start; });
       }
 
 
@@ -45,16 +48,32 @@ namespace MR
       MT_gradient_vector_sorter::VecItType MT_gradient_vector_sorter::get()
       {
         VecItType return_iterator (*candidates.begin());
-        VecItType incremented (*candidates.begin());
-        ++incremented;
         candidates.erase (candidates.begin());
+        VecItType incremented (return_iterator);
+        ++incremented;
+        if (incremented == data.end())
+          return return_iterator;
+        // if the next candidate from this block would step beyond the sorted
+        // prefix of its negative-gradient region, extend the prefix first;
+        // std::partial_sort() guarantees that everything beyond the prefix
+        // is no smaller than its contents, so sorting can proceed lazily
+        auto block = std::upper_bound (blocks.begin(), blocks.end(), incremented,
+            [] (const VecItType& it, const SortedBlock& b) { return it < b.start; });
+        assert (block != blocks.begin());
+        --block;
+        if (incremented == block->sorted_end && block->sorted_end != block->neg_end) {
+          const VecItType new_sorted_end = (block->neg_end - block->sorted_end > ssize_t(SIFT_GRADIENT_SORT_CHUNK)) ?
+              block->sorted_end + SIFT_GRADIENT_SORT_CHUNK : block->neg_end;
+          std::partial_sort (block->sorted_end, new_sorted_end, block->neg_end);
+          block->sorted_end = new_sorted_end;
+        }
         candidates.insert (incremented);
         return return_iterator;
       }
 
 
 
-      bool MT_gradient_vector_sorter::Sorter::operator() (const TrackIndexRange& in, VecItType& out) const
+      bool MT_gradient_vector_sorter::Sorter::operator() (const TrackIndexRange& in, SortedBlock& out) const
       {
         VecItType start      (data.begin() + in.first);
         VecItType from_end   (data.begin() + in.second);
@@ -65,8 +84,11 @@ namespace MR
             std::swap (*from_start, *from_end);
           }
         }
-        std::sort (start, from_start);
-        out = start;
+        out.start = start;
+        out.neg_end = from_start;
+        out.sorted_end = (from_start - start > ssize_t(SIFT_GRADIENT_SORT_CHUNK)) ?
+            start + SIFT_GRADIENT_SORT_CHUNK : from_start;
+        std::partial_sort (start, out.sorted_end, from_start);
         return true;
       }
 
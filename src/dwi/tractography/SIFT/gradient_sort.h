@@ -24,6 +24,12 @@
 #include "dwi/tractography/SIFT/types.h"
 
 
+// number of entries by which the sorted prefix of each block is extended;
+// only this many candidates per block are sorted up-front, with further
+// entries sorted on demand as candidates are consumed
+#define SIFT_GRADIENT_SORT_CHUNK 1024
+
+
 namespace MR
 {
   namespace DWI
@@ -70,7 +76,9 @@ namespace MR
       // * Gradient vector is split into blocks of equal size
       // * Within each block:
       //     - Non-negative gradients are pushed to the end of the block (no need to sort these)
-      //     - Negative gradients within the block are sorted fully
+      //     - The first SIFT_GRADIENT_SORT_CHUNK negative gradients within the block are sorted
+      //         (the remainder are guaranteed no smaller than the sorted prefix, and are only
+      //         sorted on demand if that many candidates are actually consumed from the block)
       //     - An iterator to the first entry in the sorted block is written to a set
       // * For streamline filtering, the candidate streamline is chosen from the beginning of this set.
       //     The entry in the set corresponding to the gradient vector is removed, but the iterator WITHIN THE BLOCK
@@ -89,21 +97,30 @@ namespace MR
           };
           using SetType = std::set<VecItType, Comparator>;
 
+          struct SortedBlock { NOMEMALIGN
+            VecItType start;       // first entry of the block
+            VecItType sorted_end;  // end of the sorted prefix of the negative-gradient region
+            VecItType neg_end;     // end of the negative-gradient region
+          };
+
 
         public:
           MT_gradient_vector_sorter (VecType& in, const track_t);
 
           VecItType get();
 
-          bool operator() (const VecItType& in)
+          bool operator() (const SortedBlock& in)
           {
-            candidates.insert (in);
+            blocks.push_back (in);
+            candidates.insert (in.start);
             return true;
           }
 
 
         private:
+          VecType& data;
           SetType candidates;
+          vector<SortedBlock> blocks;
 
 
           class BlockSender
@@ -136,7 +153,7 @@ namespace MR
                 data  (in) { }
               Sorter (const Sorter& that) :
                 data  (that.data) { }
-              bool operator() (const TrackIndexRange&, VecItType&) const;
+              bool operator() (const TrackIndexRange&, SortedBlock&) const;
             private:
               VecType& data;
           };
@@ -16,10 +16,14 @@
 #define __dwi_tractography_sift_model_h__
 
 
+#include <new>
+
 #include "app.h"
 #include "thread_queue.h"
 #include "types.h"
 
+#include "file/config.h"
+
 #include "dwi/fixel_map.h"
 
 #include "dwi/directions/set.h"
@@ -33,6 +37,7 @@
 #include "dwi/tractography/mapping/mapping.h"
 #include "dwi/tractography/mapping/voxel.h"
 
+#include "dwi/tractography/SIFT/contribution_arena.h"
 #include "dwi/tractography/SIFT/model_base.h"
 #include "dwi/tractography/SIFT/track_contribution.h"
 #include "dwi/tractography/SIFT/track_index_range.h"
@@ -66,6 +71,18 @@ namespace MR
               ModelBase<Fixel> (dwi, dirs)
           {
             Track_fixel_contribution::set_scaling (dwi);
+            //CONF option: SIFTContributionsOnDisk
+            //CONF default: 0 (false)
+            //CONF Whether the SIFT model should store the per-streamline
+            //CONF fixel contribution data in memory-mapped temporary files
+            //CONF rather than in RAM. This bounds resident memory usage
+            //CONF independently of the number of streamlines (at some cost
+            //CONF in speed), permitting tcksift / tcksift2 to process
+            //CONF tractograms that would otherwise exhaust physical memory.
+            if (File::Config::get_bool ("SIFTContributionsOnDisk", false)) {
+              INFO ("SIFT model will store streamline contributions in memory-mapped temporary files");
+              arena.reset (new ContributionArena());
+            }
           }
           Model (const Model& that) = delete;
 
@@ -91,6 +108,7 @@ namespace MR
         protected:
           std::string tck_file_path;
           vector<TrackContribution*> contributions;
+          std::unique_ptr<ContributionArena> arena; // If set, contributions reside in memory-mapped temporary files
 
           using Fixel_map<Fixel>::accessor;
           using Fixel_map<Fixel>::begin;
@@ -146,6 +164,10 @@ namespace MR
       template <class Fixel>
       Model<Fixel>::~Model ()
       {
+        // If backed by the arena, contributions are never freed individually:
+        //   the backing files are deleted along with the arena itself
+        if (arena)
+          return;
         for (vector<TrackContribution*>::iterator i = contributions.begin(); i != contributions.end(); ++i) {
           if (*i) {
             delete *i;
@@ -356,7 +378,13 @@ namespace MR
             }
           }
 
-          master.contributions[in.index] = new TrackContribution (masked_contributions, total_contribution, total_length);
+          if (master.arena) {
+            void* const mem = master.arena->allocate (sizeof (TrackContribution) + (masked_contributions.size() * sizeof (Track_fixel_contribution)));
+            master.contributions[in.index] = ::new (mem) TrackContribution (masked_contributions, total_contribution, total_length,
+                reinterpret_cast<Track_fixel_contribution*> (reinterpret_cast<uint8_t*> (mem) + sizeof (TrackContribution)));
+          } else {
+            master.contributions[in.index] = new TrackContribution (masked_contributions, total_contribution, total_length);
+          }
 
           TD_sum += total_contribution;
           for (vector<Track_fixel_contribution>::const_iterator i = masked_contributions.begin(); i != masked_contributions.end(); ++i)
@@ -389,8 +417,17 @@ namespace MR
                 total_contribution += this_cont[i].get_length() * master[new_index].get_weight();
               }
             }
-            TrackContribution* new_contribution = new TrackContribution (new_cont, total_contribution, this_cont.get_total_length());
-            delete master.contributions[track_index];
+            TrackContribution* new_contribution = nullptr;
+            if (master.arena) {
+              // The old record's space within the arena is simply abandoned;
+              //   fixel remapping runs at most once per execution
+              void* const mem = master.arena->allocate (sizeof (TrackContribution) + (new_cont.size() * sizeof (Track_fixel_contribution)));
+              new_contribution = ::new (mem) TrackContribution (new_cont, total_contribution, this_cont.get_total_length(),
+                  reinterpret_cast<Track_fixel_contribution*> (reinterpret_cast<uint8_t*> (mem) + sizeof (TrackContribution)));
+            } else {
+              new_contribution = new TrackContribution (new_cont, total_contribution, this_cont.get_total_length());
+              delete master.contributions[track_index];
+            }
             master.contributions[track_index] = new_contribution;
           }
         }
@@ -135,6 +135,13 @@ class Track_fixel_contribution
             total_contribution (c),
             total_length       (l) { }
 
+        // Construct over externally-managed storage (see Min_mem_array);
+        //   used when contribution data reside in a memory-mapped file
+        TrackContribution (const vector<Track_fixel_contribution>& in, const float c, const float l, Track_fixel_contribution* storage) :
+            Min_mem_array<Track_fixel_contribution> (in, storage),
+            total_contribution (c),
+            total_length       (l) { }
+
         TrackContribution () :
             Min_mem_array<Track_fixel_contribution> (),
             total_contribution (0.0),
@@ -12,6 +12,7 @@
  */
 
 
+#include <atomic>
 #include <mutex>
 
 #include "dwi/tractography/SIFT2/fixel_updater.h"
@@ -39,10 +40,22 @@ namespace MR {
 
       FixelUpdater::~FixelUpdater()
       {
-        std::lock_guard<std::mutex> lock (master.mutex);
-        for (size_t i = 0; i != master.fixels.size(); ++i) {
-          master.fixels[i].add_to_mean_coeff (fixel_coeff_sums[i]);
-          master.fixels[i].add_TD (fixel_TDs[i], fixel_counts[i]);
+        // Merge the per-thread accumulators one fixel block at a time, with
+        //   each thread starting at a different block, so that threads
+        //   finishing an epoch together can merge concurrently rather than
+        //   queueing on a single whole-array lock
+        static std::atomic<size_t> merge_counter (0);
+        const size_t start_block = merge_counter.fetch_add (1, std::memory_order_relaxed) % SIFT2_FIXEL_MERGE_BLOCKS;
+        const size_t block_size = (master.fixels.size() + SIFT2_FIXEL_MERGE_BLOCKS - 1) / SIFT2_FIXEL_MERGE_BLOCKS;
+        for (size_t b = 0; b != SIFT2_FIXEL_MERGE_BLOCKS; ++b) {
+          const size_t block = (start_block + b) % SIFT2_FIXEL_MERGE_BLOCKS;
+          const size_t from = block * block_size;
+          const size_t to = std::min (master.fixels.size(), from + block_size);
+          std::lock_guard<std::mutex> lock (master.fixel_merge_mutexes[block]);
+          for (size_t i = from; i < to; ++i) {
+            master.fixels[i].add_to_mean_coeff (fixel_coeff_sums[i]);
+            master.fixels[i].add_TD (fixel_TDs[i], fixel_counts[i]);
+          }
         }
       }
 
@@ -30,6 +30,8 @@
 
 #include "dwi/tractography/SIFT/track_index_range.h"
 
+#include "dwi/tractography/weights.h"
+
 
 
 
@@ -139,6 +141,39 @@ namespace MR {
 
 
 
+      // Each streamline's coefficient is independent of all others, so batches
+      //   of streamlines can be processed concurrently with no synchronisation
+      class AFCSACalculator
+      { MEMALIGN(AFCSACalculator)
+        public:
+          AFCSACalculator (TckFactor& tckfactor) :
+              master (tckfactor),
+              fixed_mu (tckfactor.mu()) { }
+
+          bool operator() (const SIFT::TrackIndexRange& range)
+          {
+            for (SIFT::track_t i = range.first; i != range.second; ++i) {
+              const SIFT::TrackContribution& tckcont = *master.contributions[i];
+              double sum_afd = 0.0;
+              for (size_t f = 0; f != tckcont.dim(); ++f) {
+                const size_t fixel_index = tckcont[f].get_fixel_index();
+                const Fixel& fixel = master.fixels[fixel_index];
+                const float length = tckcont[f].get_length();
+                sum_afd += fixel.get_weight() * fixel.get_FOD() * (length / fixel.get_orig_TD());
+              }
+              const double afcsa = sum_afd / tckcont.get_total_contribution();
+              master.coefficients[i] = std::log (afcsa / fixed_mu);
+            }
+            return true;
+          }
+
+        private:
+          TckFactor& master;
+          const double fixed_mu;
+      };
+
+
+
       void TckFactor::calc_afcsa()
       {
 
@@ -146,20 +181,10 @@ namespace MR {
 
         coefficients.resize (num_tracks(), 0.0);
 
-        const double fixed_mu = mu();
-
-        // Just do single-threaded for now
-        for (SIFT::track_t i = 0; i != num_tracks(); ++i) {
-          const SIFT::TrackContribution& tckcont = *contributions[i];
-          double sum_afd = 0.0;
-          for (size_t f = 0; f != tckcont.dim(); ++f) {
-            const size_t fixel_index = tckcont[f].get_fixel_index();
-            const Fixel& fixel = fixels[fixel_index];
-            const float length = tckcont[f].get_length();
-            sum_afd += fixel.get_weight() * fixel.get_FOD() * (length / fixel.get_orig_TD());
-          }
-          const double afcsa = sum_afd / tckcont.get_total_contribution();
-          coefficients[i] = std::log (afcsa / fixed_mu);
+        {
+          SIFT::TrackIndexRangeWriter writer (SIFT_TRACK_INDEX_BUFFER_SIZE, num_tracks());
+          AFCSACalculator worker (*this);
+          Thread::run_queue (writer, SIFT::TrackIndexRange(), Thread::multi (worker));
         }
 
         for (vector<Fixel>::iterator i = fixels.begin(); i != fixels.end(); ++i) {
@@ -325,7 +350,7 @@ namespace MR {
           decltype(coefficients) weights (coefficients.size());
           for (SIFT::track_t i = 0; i != num_tracks(); ++i)
             weights[i] = std::exp (coefficients[i]);
-          save_vector (weights, path);
+          save_weights (weights, path);
         } catch (...) {
           WARN ("Unable to assign memory for output factor file: \"" + Path::basename(path) + "\" not created");
         }
@@ -334,7 +359,7 @@ namespace MR {
 
       void TckFactor::output_coefficients (const std::string& path) const
       {
-        save_vector (coefficients, path);
+        save_weights (coefficients, path);
       }
 
 
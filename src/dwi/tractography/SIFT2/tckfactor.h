@@ -37,6 +37,11 @@
 
 #define SIFT2_MIN_TD_FRAC_DEFAULT 0.10
 
+// Number of blocks into which the fixel array is divided for merging of
+//   per-thread accumulators; threads lock and merge one block at a time, so
+//   those finishing an epoch together can merge different regions concurrently
+#define SIFT2_FIXEL_MERGE_BLOCKS 64
+
 #define SIFT2_MIN_ITERS_DEFAULT 10
 #define SIFT2_MAX_ITERS_DEFAULT 1000
 #define SIFT2_MIN_COEFF_DEFAULT (-std::numeric_limits<default_type>::infinity())
@@ -117,6 +122,7 @@ namespace MR {
           double data_scale_term;
 
 
+          friend class AFCSACalculator;
           friend class LineSearchFunctor;
           friend class CoefficientOptimiserBase;
           friend class CoefficientOptimiserGSS;
@@ -129,6 +135,10 @@ namespace MR {
           // For when multiple threads are trying to write their final information back
           std::mutex mutex;
 
+          // Per-block mutexes over the fixel array, permitting concurrent
+          //   merging of per-thread fixel accumulators (see FixelUpdater)
+          std::mutex fixel_merge_mutexes[SIFT2_FIXEL_MERGE_BLOCKS];
+
           void indicate_progress() { if (App::log_level) fprintf (stderr, "."); }
 
       };
@@ -0,0 +1,151 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __dwi_tractography_algorithms_amplitude_cache_h__
+#define __dwi_tractography_algorithms_amplitude_cache_h__
+
+#include <atomic>
+
+#include "image.h"
+#include "transform.h"
+#include "math/SH.h"
+#include "dwi/directions/set.h"
+#include "dwi/directions/predefined.h"
+
+
+#define AMPLITUDE_CACHE_NUM_DIRS 1281
+
+
+namespace MR
+{
+  namespace DWI
+  {
+    namespace Tractography
+    {
+      namespace Algorithms
+      {
+
+
+        //! shared, lazily-populated per-voxel FOD amplitude table
+        /*! Probabilistic tracking algorithms evaluate the FOD amplitude along
+         * many candidate directions per step, revisiting the same voxels
+         * thousands of times over a whole-brain run; evaluating the spherical
+         * harmonic series for every probe dominates their run time. This
+         * cache instead rasterises the FOD of each visited voxel onto a dense
+         * direction set (a 1281-direction icosahedral tessellation, ~5&deg;
+         * spacing) on first visit - a single matrix-vector product - and
+         * serves subsequent probes by table lookup: nearest tabulated
+         * direction, trilinearly interpolated across the 8 surrounding
+         * voxels. This trades memory (~5 kB per visited voxel) and a little
+         * angular resolution for a large cut in per-probe cost.
+         *
+         * The cache is shared across threads: each voxel's table is installed
+         * with an atomic compare-and-swap, so the fast path is a single
+         * atomic load and no locks are ever taken. */
+        class AmplitudeCache { MEMALIGN(AmplitudeCache)
+          public:
+            AmplitudeCache (const Image<float>& source) :
+              dirs (AMPLITUDE_CACHE_NUM_DIRS),
+              lmax (Math::SH::LforN (source.size(3))),
+              SHT (Math::SH::init_transform (Directions::tesselation_1281(), lmax).cast<float>()),
+              transform (source),
+              nvox (source.size(0) * source.size(1) * source.size(2)),
+              tables (new std::atomic<float*> [nvox]) {
+                dim[0] = source.size(0); dim[1] = source.size(1); dim[2] = source.size(2);
+                for (size_t n = 0; n < nvox; ++n)
+                  tables[n].store (nullptr, std::memory_order_relaxed);
+              }
+
+            ~AmplitudeCache () {
+              for (size_t n = 0; n < nvox; ++n)
+                delete [] tables[n].load (std::memory_order_relaxed);
+            }
+
+            //! the FOD amplitude at continuous scanner-space \a position along unit \a direction
+            /*! \a source must be a thread-local view of the same SH image the
+             * cache was constructed with; it is used to fetch the SH
+             * coefficients of any voxel not yet tabulated. Returns NaN
+             * outside the image, matching the interpolator convention. */
+            float amplitude (Image<float>& source, const Eigen::Vector3f& position, const Eigen::Vector3f& direction) const
+            {
+              const Eigen::Vector3 p = transform.scanner2voxel * position.cast<default_type>().eval();
+              for (size_t axis = 0; axis < 3; ++axis)
+                if (p[axis] < 0.0 || p[axis] > dim[axis]-1)
+                  return NaN;
+
+              const size_t d = dirs.select_direction (direction.cast<default_type>().eval());
+
+              ssize_t vox[3];
+              default_type frac[3];
+              for (size_t axis = 0; axis < 3; ++axis) {
+                vox[axis] = std::min (ssize_t (p[axis]), dim[axis]-2);
+                frac[axis] = p[axis] - vox[axis];
+              }
+
+              float amp = 0.0f;
+              for (size_t corner = 0; corner < 8; ++corner) {
+                const size_t cx = corner & 1, cy = (corner >> 1) & 1, cz = corner >> 2;
+                const default_type weight = (cx ? frac[0] : 1.0-frac[0]) * (cy ? frac[1] : 1.0-frac[1]) * (cz ? frac[2] : 1.0-frac[2]);
+                if (weight)
+                  amp += weight * table (source, vox[0]+cx, vox[1]+cy, vox[2]+cz)[d];
+              }
+              return amp;
+            }
+
+            size_t num_dirs () const { return dirs.size(); }
+
+          private:
+            const Directions::FastLookupSet dirs;
+            const size_t lmax;
+            const Eigen::MatrixXf SHT;
+            const Transform transform;
+            const size_t nvox;
+            ssize_t dim[3];
+            mutable std::unique_ptr<std::atomic<float*>[]> tables;
+
+            //! the amplitude table for a single voxel, rasterising it on first access
+            const float* table (Image<float>& source, ssize_t x, ssize_t y, ssize_t z) const
+            {
+              std::atomic<float*>& slot = tables[x + dim[0] * (y + dim[1] * z)];
+              float* entry = slot.load (std::memory_order_acquire);
+              if (entry)
+                return entry;
+
+              source.index(0) = x; source.index(1) = y; source.index(2) = z;
+              Eigen::VectorXf sh (SHT.cols());
+              for (ssize_t n = 0; n < SHT.cols(); ++n) {
+                source.index(3) = n;
+                sh[n] = source.value();
+              }
+
+              float* fresh = new float [dirs.size()];
+              Eigen::Map<Eigen::VectorXf> (fresh, dirs.size()) = SHT * sh;
+
+              float* expected = nullptr;
+              if (!slot.compare_exchange_strong (expected, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                // another thread rasterised this voxel in the meantime:
+                delete [] fresh;
+                return expected;
+              }
+              return fresh;
+            }
+        };
+
+
+      }
+    }
+  }
+}
+
+#endif
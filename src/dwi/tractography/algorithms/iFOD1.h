@@ -71,6 +71,8 @@ namespace MR
           properties.set (precomputed, "sh_precomputed");
           if (precomputed)
             precomputer.init (lmax);
+          else
+            plm.init (lmax);
 
         }
 
@@ -99,6 +101,7 @@ namespace MR
         size_t lmax, max_trials;
         float sin_max_angle;
         Math::SH::PrecomputedAL<float> precomputer;
+        Math::Legendre::PrecomputedPlm<float> plm;
 
         private:
         mutable double mean_samples, mean_truncations, max_max_truncation;
@@ -230,7 +233,7 @@ namespace MR
       {
         return (S.precomputer ?
             S.precomputer.value (values, d) :
-            Math::SH::value (values, d, S.lmax)
+            Math::SH::value (values, d, S.plm)
         );
       }
 
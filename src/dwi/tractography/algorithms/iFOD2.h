@@ -17,11 +17,13 @@
 
 #include <algorithm>
 
+#include "file/config.h"
 #include "math/SH.h"
 #include "dwi/tractography/tracking/method.h"
 #include "dwi/tractography/tracking/shared.h"
 #include "dwi/tractography/tracking/tractography.h"
 #include "dwi/tractography/tracking/types.h"
+#include "dwi/tractography/algorithms/amplitude_cache.h"
 #include "dwi/tractography/algorithms/calibrator.h"
 
 
@@ -77,6 +79,24 @@ namespace MR
                 properties.set (precomputed, "sh_precomputed");
                 if (precomputed)
                   precomputer.init (lmax);
+                else
+                  plm.init (lmax);
+
+                //CONF option: TckgenPrecomputedAmplitudes
+                //CONF default: 0 (false)
+                //CONF For the iFOD2 tractography algorithm, rasterise the FOD
+                //CONF of each visited voxel onto a dense direction set on
+                //CONF first visit, and serve subsequent rejection-sampling
+                //CONF probes by interpolated table lookup rather than
+                //CONF spherical harmonic evaluation. Trades memory (~5 kB per
+                //CONF visited voxel) and a little angular resolution for
+                //CONF speed.
+                bool precomputed_amplitudes = File::Config::get_bool ("TckgenPrecomputedAmplitudes", false);
+                properties.set (precomputed_amplitudes, "precomputed_amplitudes");
+                if (precomputed_amplitudes) {
+                  amp_cache.reset (new AmplitudeCache (source));
+                  INFO ("caching FOD amplitudes on " + str (amp_cache->num_dirs()) + " directions per visited voxel");
+                }
 
                 // num_samples is number of samples excluding first point
                 --num_samples;
@@ -126,6 +146,8 @@ namespace MR
                 size_t lmax, num_samples, max_trials;
                 float sin_max_angle, fod_power;
                 Math::SH::PrecomputedAL<float> precomputer;
+                Math::Legendre::PrecomputedPlm<float> plm;
+                std::unique_ptr<AmplitudeCache> amp_cache;
 
               private:
                 mutable double mean_samples, mean_truncations, max_max_truncation;
@@ -144,6 +166,7 @@ namespace MR
               MethodBase (shared),
               S (shared),
               source (S.source),
+              raw_source (S.source),
               mean_sample_num (0),
               num_sample_runs (0),
               num_truncations (0),
@@ -161,6 +184,7 @@ namespace MR
               MethodBase (that.S),
               S (that.S),
               source (S.source),
+              raw_source (S.source),
               calibrate_ratio (that.calibrate_ratio),
               mean_sample_num (0),
               num_sample_runs (0),
@@ -328,6 +352,8 @@ end_init:
           private:
             const Shared& S;
             Interpolator<Image<float>>::type source;
+            //! thread-local non-interpolating view, used to populate the amplitude cache
+            Image<float> raw_source;
             float calibrate_ratio, half_log_prob0, last_half_log_probN, half_log_prob0_seed;
             size_t mean_sample_num, num_sample_runs, num_truncations;
             float max_truncation;
@@ -347,12 +373,14 @@ end_init:
             {
               return (S.precomputer ?
                   S.precomputer.value (values, direction) :
-                  Math::SH::value (values, direction, S.lmax)
+                  Math::SH::value (values, direction, S.plm)
                   );
             }
 
             float FOD (const Eigen::Vector3f& position, const Eigen::Vector3f& direction)
             {
+              if (S.amp_cache)
+                return S.amp_cache->amplitude (raw_source, position, direction);
               if (!get_data (source, position))
                 return NaN;
               return FOD (direction);
@@ -61,6 +61,8 @@ class SDStream : public MethodBase { MEMALIGN(SDStream)
           properties.set (precomputed, "sh_precomputed");
           if (precomputed)
             precomputer = new Math::SH::PrecomputedAL<float> (lmax);
+          else
+            plm.init (lmax);
         }
 
         ~Shared () {
@@ -71,6 +73,7 @@ class SDStream : public MethodBase { MEMALIGN(SDStream)
         float dot_threshold;
         size_t lmax;
         Math::SH::PrecomputedAL<float>* precomputer;
+        Math::Legendre::PrecomputedPlm<float> plm;
 
     };
 
@@ -155,7 +158,7 @@ class SDStream : public MethodBase { MEMALIGN(SDStream)
       {
         return (S.precomputer ?
             S.precomputer->value (values, d) :
-            Math::SH::value (values, d, S.lmax)
+            Math::SH::value (values, d, S.plm)
         );
       }
 
@@ -14,7 +14,11 @@
 
 #include "dwi/tractography/connectome/extract.h"
 
+#include <mutex>
+#include <set>
+
 #include "bitset.h"
+#include "thread_queue.h"
 
 
 namespace MR {
@@ -92,6 +96,7 @@ WriterExemplars::WriterExemplars (const Tractography::Properties& properties, co
       for (size_t j = i; j != nodes.size(); ++j) {
         const node_t two = nodes[j];
         selectors.push_back (Selector (one, two));
+        pair2index.insert (std::make_pair (one < two ? NodePair (one, two) : NodePair (two, one), exemplars.size()));
         exemplars.push_back (Exemplar (length, std::make_pair (one, two), std::make_pair (COMs[one], COMs[two])));
       }
     }
@@ -102,6 +107,7 @@ WriterExemplars::WriterExemplars (const Tractography::Properties& properties, co
       for (node_t two = one; two != COMs.size(); ++two) {
         if (std::find (nodes.begin(), nodes.end(), one) != nodes.end() || std::find (nodes.begin(), nodes.end(), two) != nodes.end()) {
           selectors.push_back (Selector (one, two));
+          pair2index.insert (std::make_pair (NodePair (one, two), exemplars.size()));
           exemplars.push_back (Exemplar (length, std::make_pair (one, two), std::make_pair (COMs[one], COMs[two])));
         }
       }
@@ -113,17 +119,32 @@ WriterExemplars::WriterExemplars (const Tractography::Properties& properties, co
 
 bool WriterExemplars::operator() (const Tractography::Connectome::Streamline_nodepair& in)
 {
-  for (size_t index = 0; index != selectors.size(); ++index) {
-    if (selectors[index] (in.get_nodes()))
-      exemplars[index].add (in);
-  }
+  // A node pair can contribute to at most one exemplar, which can be found
+  //   directly from the lookup table; the selector is still consulted so
+  //   that the result is identical to testing against every selector
+  const size_t index = index_of (in.get_nodes().first, in.get_nodes().second);
+  if (index != exemplars.size() && selectors[index] (in.get_nodes()))
+    exemplars[index].add (in);
   return true;
 }
 
 bool WriterExemplars::operator() (const Tractography::Connectome::Streamline_nodelist& in)
 {
-  for (size_t index = 0; index != selectors.size(); ++index) {
-    if (selectors[index] (in.get_nodes()))
+  // A selector with a node pair matches any node list that contains both
+  //   nodes; hence the candidate exemplars are precisely those indexed by
+  //   pairs of nodes drawn from the list (duplicate entries in the list
+  //   must not result in duplicate contributions)
+  const vector<node_t>& nodes (in.get_nodes());
+  std::set<size_t> indices;
+  for (size_t i = 0; i != nodes.size(); ++i) {
+    for (size_t j = i; j != nodes.size(); ++j) {
+      const size_t index = index_of (nodes[i], nodes[j]);
+      if (index != exemplars.size())
+        indices.insert (index);
+    }
+  }
+  for (const size_t index : indices) {
+    if (selectors[index] (nodes))
       exemplars[index].add (in);
   }
   return true;
@@ -131,14 +152,15 @@ bool WriterExemplars::operator() (const Tractography::Connectome::Streamline_nod
 
 
 
-// TODO Multi-thread
 void WriterExemplars::finalize()
 {
+  // Exemplars are independent of one another, so can be finalized in parallel
   ProgressBar progress ("finalizing exemplars", exemplars.size());
-  for (vector<Exemplar>::iterator i = exemplars.begin(); i != exemplars.end(); ++i) {
-    i->finalize (step_size);
-    ++progress;
-  }
+  std::mutex mutex;
+  size_t next_index = 0;
+  auto loader = [&] (size_t& out) { if (next_index == exemplars.size()) return false; out = next_index++; return true; };
+  auto worker = [&] (const size_t& in) { exemplars[in].finalize (step_size); std::lock_guard<std::mutex> lock (mutex); ++progress; return true; };
+  Thread::run_queue (loader, size_t(), Thread::multi (worker));
 }
 
 
@@ -206,7 +228,8 @@ WriterExtraction::WriterExtraction (const Tractography::Properties& p, const vec
     properties (p),
     node_list (nodes),
     exclusive (exclusive),
-    keep_self (keep_self) { }
+    keep_self (keep_self),
+    streamline_count (0) { }
 
 
 
@@ -214,7 +237,8 @@ WriterExtraction::WriterExtraction (const Tractography::Properties& p, const vec
 void WriterExtraction::add (const node_t node, const std::string& path, const std::string weights_path = "")
 {
   selectors.emplace_back (Selector (node, keep_self));
-  writers.emplace_back (new Tractography::WriterUnbuffered<float> (path, properties));
+  generic_writers.push_back (writers.size());
+  writers.emplace_back (new Tractography::Writer<float> (path, properties, CONNECTOME_EXTRACT_WRITER_BUFFER_SIZE));
   if (weights_path.size())
     writers.back()->set_weights_path (weights_path);
 }
@@ -223,7 +247,8 @@ void WriterExtraction::add (const node_t node_one, const node_t node_two, const
 {
   if (keep_self || (node_one != node_two)) {
     selectors.emplace_back (Selector (node_one, node_two));
-    writers.emplace_back (new Tractography::WriterUnbuffered<float> (path, properties));
+    pair2writers[pair_key (node_one, node_two)].push_back (writers.size());
+    writers.emplace_back (new Tractography::Writer<float> (path, properties, CONNECTOME_EXTRACT_WRITER_BUFFER_SIZE));
     if (weights_path.size())
       writers.back()->set_weights_path (weights_path);
   }
@@ -232,7 +257,8 @@ void WriterExtraction::add (const node_t node_one, const node_t node_two, const
 void WriterExtraction::add (const vector<node_t>& list, const std::string& path, const std::string weights_path = "")
 {
   selectors.emplace_back (Selector (list, exclusive, keep_self));
-  writers.emplace_back (new Tractography::WriterUnbuffered<float> (path, properties));
+  generic_writers.push_back (writers.size());
+  writers.emplace_back (new Tractography::Writer<float> (path, properties, CONNECTOME_EXTRACT_WRITER_BUFFER_SIZE));
   if (weights_path.size())
     writers.back()->set_weights_path (weights_path);
 }
@@ -243,11 +269,14 @@ void WriterExtraction::clear()
 {
   selectors.clear();
   writers.clear();
+  pair2writers.clear();
+  generic_writers.clear();
+  streamline_count = 0;
 }
 
 
 
-bool WriterExtraction::operator() (const Connectome::Streamline_nodepair& in) const
+bool WriterExtraction::operator() (const Connectome::Streamline_nodepair& in)
 {
   if (exclusive) {
     // Make sure that both nodes are within the list of nodes of interest;
@@ -259,16 +288,25 @@ bool WriterExtraction::operator() (const Connectome::Streamline_nodepair& in) co
     }
     if (!first_in_list || !second_in_list) return true;
   }
-  for (size_t i = 0; i != file_count(); ++i) {
+  ++streamline_count;
+  // Exact-pair writers are found directly from the dispatch table; the
+  //   selector is still consulted so that the set of tracks written is
+  //   identical to testing against every selector
+  const auto it = pair2writers.find (pair_key (in.get_nodes().first, in.get_nodes().second));
+  if (it != pair2writers.end()) {
+    for (const size_t i : it->second) {
+      if (selectors[i] (in.get_nodes()))
+        (*writers[i]) (in);
+    }
+  }
+  for (const size_t i : generic_writers) {
     if (selectors[i] (in.get_nodes()))
       (*writers[i]) (in);
-    else
-      (*writers[i]) (empty_tck);
   }
   return true;
 }
 
-bool WriterExtraction::operator() (const Connectome::Streamline_nodelist& in) const
+bool WriterExtraction::operator() (const Connectome::Streamline_nodelist& in)
 {
   if (exclusive) {
     // Make sure _all_ nodes are within the list of nodes of interest;
@@ -280,17 +318,49 @@ bool WriterExtraction::operator() (const Connectome::Streamline_nodelist& in) co
     }
     if (!in_list.full()) return true;
   }
-  for (size_t i = 0; i != file_count(); ++i) {
-    if (selectors[i] (in.get_nodes()))
+  ++streamline_count;
+  // An exact-pair selector matches any node list containing both nodes;
+  //   the candidate writers are therefore those indexed by pairs of nodes
+  //   drawn from the list (duplicate entries in the list must not result
+  //   in duplicate writes)
+  const vector<node_t>& nodes (in.get_nodes());
+  std::set<size_t> indices;
+  for (size_t i = 0; i != nodes.size(); ++i) {
+    for (size_t j = i; j != nodes.size(); ++j) {
+      const auto it = pair2writers.find (pair_key (nodes[i], nodes[j]));
+      if (it != pair2writers.end())
+        indices.insert (it->second.begin(), it->second.end());
+    }
+  }
+  for (const size_t index : indices) {
+    if (selectors[index] (nodes))
+      (*writers[index]) (in);
+  }
+  for (const size_t i : generic_writers) {
+    if (selectors[i] (nodes))
       (*writers[i]) (in);
-    else
-      (*writers[i]) (empty_tck);
   }
   return true;
 }
 
 
 
+void WriterExtraction::finish()
+{
+  // Each output header records the total number of streamlines processed;
+  //   tally the non-contributing streamlines once per writer here, rather
+  //   than having submitted an empty track per non-match during processing.
+  //   The write-back buffers are then flushed in parallel; this is safe as
+  //   each writer owns a distinct file
+  size_t next_index = 0;
+  auto loader = [&] (size_t& out) { if (next_index == writers.size()) return false; out = next_index++; return true; };
+  auto worker = [&] (const size_t& in) { writers[in]->total_count = streamline_count; writers[in].reset(); return true; };
+  Thread::run_queue (loader, size_t(), Thread::multi (worker));
+  writers.clear();
+}
+
+
+
 
 
 
@@ -15,6 +15,8 @@
 #ifndef __dwi_tractography_connectome_extract_h__
 #define __dwi_tractography_connectome_extract_h__
 
+#include <map>
+#include <unordered_map>
 
 #include "file/ofstream.h"
 
@@ -24,6 +26,12 @@
 #include "dwi/tractography/connectome/exemplar.h"
 
 
+// Capacity (in bytes) of the write-back buffer of each output file during
+//   track extraction; kept small since one buffer is held per requested
+//   edge/node selection, which may number in the thousands
+#define CONNECTOME_EXTRACT_WRITER_BUFFER_SIZE 262144
+
+
 namespace MR {
 namespace DWI {
 namespace Tractography {
@@ -87,6 +95,15 @@ class WriterExemplars
     float step_size;
     vector<Selector> selectors;
     vector<Exemplar> exemplars;
+    // Map from (sorted) node pair to exemplar index, so that each incoming
+    //   streamline can be dispatched directly to the exemplar(s) it
+    //   contributes to, rather than testing it against every selector
+    std::map<NodePair, size_t> pair2index;
+
+    FORCE_INLINE size_t index_of (const node_t one, const node_t two) const {
+      const auto it = pair2index.find (one < two ? NodePair (one, two) : NodePair (two, one));
+      return (it == pair2index.end() ? exemplars.size() : it->second);
+    }
 };
 
 
@@ -109,8 +126,15 @@ class WriterExtraction
 
     void clear();
 
-    bool operator() (const Connectome::Streamline_nodepair&) const;
-    bool operator() (const Connectome::Streamline_nodelist&) const;
+    bool operator() (const Connectome::Streamline_nodepair&);
+    bool operator() (const Connectome::Streamline_nodelist&);
+
+    //! commit all output files; must be called once all streamlines have been processed
+    /*! tallies the non-contributing streamlines into each writer (so that
+     * the total_count header field still reflects the full size of the
+     * input), then flushes the per-writer write-back buffers in parallel
+     * (each writer owns a distinct file). */
+    void finish();
 
     size_t file_count() const { return writers.size(); }
 
@@ -121,8 +145,18 @@ class WriterExtraction
     const bool exclusive;
     const bool keep_self;
     vector< Selector > selectors;
-    vector< std::unique_ptr< Tractography::WriterUnbuffered<float> > > writers;
-    Tractography::Streamline<> empty_tck;
+    vector< std::unique_ptr< Tractography::Writer<float> > > writers;
+    // Dispatch table from (sorted) node pair to the writers whose selector
+    //   is that exact pair, so that each incoming streamline only touches
+    //   the writers it could contribute to; selectors that are not exact
+    //   pairs (single node, node list) are tested against every streamline
+    std::unordered_map<uint64_t, vector<size_t>> pair2writers;
+    vector<size_t> generic_writers;
+    uint64_t streamline_count;
+
+    FORCE_INLINE static uint64_t pair_key (const node_t one, const node_t two) {
+      return one < two ? (uint64_t(one) << 32) | uint64_t(two) : (uint64_t(two) << 32) | uint64_t(one);
+    }
 
 };
 
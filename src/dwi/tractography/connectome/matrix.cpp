@@ -38,39 +38,20 @@ const App::Option EdgeStatisticOption
 
 
 template <typename T>
-bool Matrix<T>::operator() (const Mapped_track_nodepair& in)
+bool Matrix<T>::Accumulator::operator() (const Mapped_track_nodepair& in)
 {
-  assert (in.get_first_node()  < mat2vec->mat_size());
-  assert (in.get_second_node() < mat2vec->mat_size());
-  assert (assignments_lists.empty());
-  if (is_vector()) {
-    assert (assignments_pairs.empty());
+  assert (in.get_first_node()  < master.mat2vec->mat_size());
+  assert (in.get_second_node() < master.mat2vec->mat_size());
+  if (master.is_vector()) {
     apply_data (in.get_second_node(), in.get_factor(), in.get_weight());
     inc_count (in.get_second_node(), in.get_weight());
-    if (track_assignments) {
-      if (in.get_track_index() == assignments_single.size()) {
-        assignments_single.push_back (in.get_second_node());
-      } else if (in.get_track_index() < assignments_single.size()) {
-        assignments_single[in.get_track_index()] = in.get_second_node();
-      } else {
-        assignments_single.resize (in.get_track_index() + 1, 0);
-        assignments_single[in.get_track_index()] = in.get_second_node();
-      }
-    }
+    if (master.track_assignments)
+      assignments_single.push_back (std::make_pair (in.get_track_index(), in.get_second_node()));
   } else {
-    assert (assignments_single.empty());
     apply_data (in.get_first_node(), in.get_second_node(), in.get_factor(), in.get_weight());
     inc_count (in.get_first_node(), in.get_second_node(), in.get_weight());
-    if (track_assignments) {
-      if (in.get_track_index() == assignments_pairs.size()) {
-        assignments_pairs.push_back (in.get_nodes());
-      } else if (in.get_track_index() < assignments_pairs.size()) {
-        assignments_pairs[in.get_track_index()] = in.get_nodes();
-      } else {
-        assignments_pairs.resize (in.get_track_index() + 1, std::make_pair<size_t, size_t> (0, 0));
-        assignments_pairs[in.get_track_index()] = in.get_nodes();
-      }
-    }
+    if (master.track_assignments)
+      assignments_pairs.push_back (std::make_pair (in.get_track_index(), in.get_nodes()));
   }
   return true;
 }
@@ -78,15 +59,13 @@ bool Matrix<T>::operator() (const Mapped_track_nodepair& in)
 
 
 template <typename T>
-bool Matrix<T>::operator() (const Mapped_track_nodelist& in)
+bool Matrix<T>::Accumulator::operator() (const Mapped_track_nodelist& in)
 {
-  assert (assignments_single.empty());
-  assert (assignments_pairs.empty());
   vector<node_t> list (in.get_nodes());
   for (vector<node_t>::const_iterator i = list.begin(); i != list.end(); ++i) {
     assert (*i < data.rows());
   }
-  if (is_vector()) {
+  if (master.is_vector()) {
     if (list.empty()) {
       apply_data (0, in.get_factor(), in.get_weight());
       inc_count (0, in.get_weight());
@@ -114,22 +93,55 @@ bool Matrix<T>::operator() (const Mapped_track_nodelist& in)
       }
     }
   }
-  if (track_assignments) {
+  if (master.track_assignments) {
     std::sort (list.begin(), list.end());
-    if (in.get_track_index() == assignments_lists.size()) {
-      assignments_lists.push_back (std::move (list));
-    } else if (in.get_track_index() < assignments_lists.size()) {
-      assignments_lists[in.get_track_index()] = std::move (list);
-    } else {
-      assignments_lists.resize (in.get_track_index() + 1, vector<node_t>());
-      assignments_lists[in.get_track_index()] = std::move (list);
-    }
+    assignments_lists.push_back (std::make_pair (in.get_track_index(), std::move (list)));
   }
   return true;
 }
 
 
 
+template <typename T>
+void Matrix<T>::merge (Accumulator& in)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  switch (statistic) {
+    case stat_edge::SUM:
+      data += in.data;
+      break;
+    case stat_edge::MEAN:
+      data += in.data;
+      counts += in.counts;
+      break;
+    case stat_edge::MIN:
+      data = data.cwiseMin (in.data);
+      break;
+    case stat_edge::MAX:
+      data = data.cwiseMax (in.data);
+      break;
+  }
+  if (track_assignments) {
+    for (const auto& i : in.assignments_single) {
+      if (i.first >= assignments_single.size())
+        assignments_single.resize (i.first + 1, 0);
+      assignments_single[i.first] = i.second;
+    }
+    for (const auto& i : in.assignments_pairs) {
+      if (i.first >= assignments_pairs.size())
+        assignments_pairs.resize (i.first + 1, NodePair (0, 0));
+      assignments_pairs[i.first] = i.second;
+    }
+    for (auto& i : in.assignments_lists) {
+      if (i.first >= assignments_lists.size())
+        assignments_lists.resize (i.first + 1, vector<node_t>());
+      assignments_lists[i.first] = std::move (i.second);
+    }
+  }
+}
+
+
+
 template <typename T>
 void Matrix<T>::finalize()
 {
@@ -255,18 +267,16 @@ void Matrix<T>::save (const std::string& path,
 
 
 template <typename T>
-void Matrix<T>::apply_data (const size_t index, const T value, const T weight)
+void Matrix<T>::Accumulator::apply_data (const size_t index, const T value, const T weight)
 {
-  T& target = data[index];
-  apply_data (target, value, weight);
+  master.apply_data (data[index], value, weight);
 }
 
 template <typename T>
-void Matrix<T>::apply_data (const size_t node_one, const size_t node_two, const T value, const T weight)
+void Matrix<T>::Accumulator::apply_data (const size_t node_one, const size_t node_two, const T value, const T weight)
 {
-  assert (mat2vec);
-  T& target = data[(*mat2vec) (node_one, node_two)];
-  apply_data (target, value, weight);
+  assert (master.mat2vec);
+  master.apply_data (data[(*master.mat2vec) (node_one, node_two)], value, weight);
 }
 
 template <typename T>
@@ -287,26 +297,30 @@ void Matrix<T>::apply_data (T& target, const T value, const T weight)
 }
 
 template <typename T>
-void Matrix<T>::inc_count (const size_t index, const T weight)
+void Matrix<T>::Accumulator::inc_count (const size_t index, const T weight)
 {
-  if (statistic != stat_edge::MEAN)
+  if (master.statistic != stat_edge::MEAN)
     return;
   assert (counts.size());
   counts[index] += weight;
 }
 
 template <typename T>
-void Matrix<T>::inc_count (const size_t node_one, const size_t node_two, const T weight)
+void Matrix<T>::Accumulator::inc_count (const size_t node_one, const size_t node_two, const T weight)
 {
-  if (statistic != stat_edge::MEAN)
+  if (master.statistic != stat_edge::MEAN)
     return;
   assert (counts.size());
-  assert (mat2vec);
-  counts[(*mat2vec) (node_one, node_two)] += weight;
+  assert (master.mat2vec);
+  counts[(*master.mat2vec) (node_one, node_two)] += weight;
 }
 
 
 
+template <typename T> std::mutex Matrix<T>::mutex;
+
+
+
 template class Matrix<float>;
 template class Matrix<double>;
 
@@ -15,6 +15,7 @@
 #ifndef __dwi_tractography_connectome_matrix_h__
 #define __dwi_tractography_connectome_matrix_h__
 
+#include <mutex>
 #include <set>
 
 #include "types.h"
@@ -73,8 +74,49 @@ class Matrix
         data = vector_type::Constant (vector_output ? (max_node_index + 1) : mat2vec->vec_size(), -std::numeric_limits<T>::infinity());
     }
 
-    bool operator() (const Mapped_track_nodepair&);
-    bool operator() (const Mapped_track_nodelist&);
+    //! per-thread accumulation of mapped tracks
+    /*! Each worker thread holds its own copy of the connectome data, into
+     * which its mapped tracks are accumulated without any locking; the
+     * local data are folded into the shared Matrix in the destructor, which
+     * is only invoked once the threads re-join. Streamline-to-node
+     * assignments are gathered as (track index, assignment) records, since
+     * the threads each see only a subset of the track indices. */
+    class Accumulator
+    { MEMALIGN(Accumulator)
+      public:
+        Accumulator (Matrix& master) :
+            master (master),
+            data (master.statistic == stat_edge::MIN ?
+                  vector_type::Constant (master.data.size(), std::numeric_limits<T>::infinity()) :
+                  (master.statistic == stat_edge::MAX ?
+                   vector_type::Constant (master.data.size(), -std::numeric_limits<T>::infinity()) :
+                   vector_type::Zero (master.data.size()))),
+            counts (master.statistic == stat_edge::MEAN ?
+                    vector_type::Zero (master.data.size()) :
+                    vector_type()) { }
+
+        Accumulator (const Accumulator& that) :
+            Accumulator (that.master) { }
+
+        ~Accumulator() { master.merge (*this); }
+
+        bool operator() (const Mapped_track_nodepair&);
+        bool operator() (const Mapped_track_nodelist&);
+
+      private:
+        Matrix& master;
+        vector_type data, counts;
+        vector<std::pair<size_t, node_t>> assignments_single;
+        vector<std::pair<size_t, NodePair>> assignments_pairs;
+        vector<std::pair<size_t, vector<node_t>>> assignments_lists;
+
+        FORCE_INLINE void apply_data (const size_t, const T, const T);
+        FORCE_INLINE void apply_data (const size_t, const size_t, const T, const T);
+        FORCE_INLINE void inc_count (const size_t, const T);
+        FORCE_INLINE void inc_count (const size_t, const size_t, const T);
+
+        friend class Matrix;
+    };
 
     void finalize();
 
@@ -99,11 +141,11 @@ class Matrix
     vector<NodePair> assignments_pairs;
     vector< vector<node_t> > assignments_lists;
 
-    FORCE_INLINE void apply_data (const size_t, const T, const T);
-    FORCE_INLINE void apply_data (const size_t, const size_t, const T, const T);
+    void merge (Accumulator&);
+
     FORCE_INLINE void apply_data (T&, const T, const T);
-    FORCE_INLINE void inc_count (const size_t, const T);
-    FORCE_INLINE void inc_count (const size_t, const size_t, const T);
+
+    static std::mutex mutex;
 
 };
 
@@ -89,6 +89,10 @@ class Metric { MEMALIGN(Metric)
     }
 
 
+    //! whether the metric inspects the full streamline geometry
+    //    (as opposed to only per-track quantities such as index and weight)
+    bool requires_geometry() const { return scale_by_length || scale_by_invlength; }
+
     void set_scale_length (const bool i = true) {
       if (i) assert (!scale_by_invlength);
       scale_by_length = i;
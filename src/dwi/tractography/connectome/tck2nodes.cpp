@@ -17,6 +17,8 @@
 
 #include "dwi/tractography/connectome/tck2nodes.h"
 
+#include "algo/threaded_loop.h"
+
 
 namespace MR {
 namespace DWI {
@@ -60,41 +62,51 @@ void Tck2nodes_radial::initialise_search ()
   radial_search.reserve (radial_search_map.size());
   for (auto i = radial_search_map.begin(); i != radial_search_map.end(); ++i)
     radial_search.push_back (i->second);
+
+  // Pre-compute the result of the radial search for every voxel, effectively
+  //   dilating the node labels into the surrounding search radius;
+  //   per-endpoint assignment then reduces to a single image lookup
+  // Since the offsets in radial_search are sorted by distance, the first
+  //   non-zero node encountered is the nearest to the voxel centre
+  Header H (nodes);
+  H.datatype() = DataType::from<node_t>();
+  lookup = Image<node_t>::scratch (H, "radial search node assignment lookup");
+  Image<node_t> in (nodes);
+  ThreadedLoop ("pre-computing radial search node assignments", lookup).run (
+      [this, in] (Image<node_t>& out) mutable
+      {
+        const voxel_type centre { int(out.index(0)), int(out.index(1)), int(out.index(2)) };
+        for (vector<voxel_type>::const_iterator offset = radial_search.begin(); offset != radial_search.end(); ++offset) {
+          const voxel_type this_voxel (centre + *offset);
+          assign_pos_of (this_voxel).to (in);
+          if (!is_out_of_bounds (in)) {
+            const node_t this_node = in.value();
+            if (this_node) {
+              out.value() = this_node;
+              return;
+            }
+          }
+        }
+        out.value() = 0;
+      }, lookup);
 }
 
 
 
 
-node_t Tck2nodes_radial::select_node (const Tractography::Streamline<>& tck, Image<node_t>& v, const bool end) const
+node_t Tck2nodes_radial::select_node (const Tractography::Streamline<>& tck, Image<node_t>&, const bool end) const
 {
-  default_type min_dist = max_dist;
-  node_t node = 0;
-
   const Eigen::Vector3 p = (end ? tck.back() : tck.front()).cast<default_type>();
   const Eigen::Vector3 v_float = transform->scanner2voxel * p;
   const voxel_type centre { int(std::round (v_float[0])), int(std::round (v_float[1])), int(std::round (v_float[2])) };
 
-  for (vector<voxel_type>::const_iterator offset = radial_search.begin(); offset != radial_search.end(); ++offset) {
-
-    const voxel_type this_voxel (centre + *offset);
-    const Eigen::Vector3 p_voxel (transform->voxel2scanner * this_voxel.matrix().cast<default_type>());
-    const default_type dist ((p - p_voxel).norm());
-
-    if (dist > min_dist + 2*max_add_dist)
-      return node;
-
-    if (dist < min_dist) {
-      assign_pos_of (this_voxel).to (v);
-      if (!is_out_of_bounds (v)) {
-        const node_t this_node = v.value();
-        if (this_node) {
-          node = this_node;
-          min_dist = dist;
-        }
-      }
-    }
-  }
-  return node;
+  // Construct a local handle to the pre-computed lookup image,
+  //   since this function may be executed concurrently
+  Image<node_t> v_lookup (lookup);
+  assign_pos_of (centre).to (v_lookup);
+  if (is_out_of_bounds (v_lookup))
+    return 0;
+  return v_lookup.value();
 }
 
 
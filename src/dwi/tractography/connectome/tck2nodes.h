@@ -67,6 +67,10 @@ class Tck2nodes_base { MEMALIGN(Tck2nodes_base)
 
     bool provides_pair() const { return pair; }
 
+    //! whether assignment depends only on the streamline endpoints
+    //    (permitting e.g. an endpoints-only read of the track file)
+    virtual bool endpoints_sufficient() const { return false; }
+
 
   protected:
     const Image<node_t> nodes;
@@ -109,6 +113,8 @@ class Tck2nodes_end_voxels : public Tck2nodes_base { MEMALIGN(Tck2nodes_end_voxe
 
     ~Tck2nodes_end_voxels() { }
 
+    bool endpoints_sufficient() const override { return true; }
+
   private:
     node_t select_node (const Tractography::Streamline<float>&, Image<node_t>&, const bool) const override;
 
@@ -119,6 +125,10 @@ class Tck2nodes_end_voxels : public Tck2nodes_base { MEMALIGN(Tck2nodes_end_voxe
 
 
 // Radial search
+// Rather than performing an outward radial search per streamline endpoint, the
+//   nearest node to every voxel within the search radius is pre-computed once
+//   (threaded) on construction, reducing each endpoint assignment to a single
+//   image lookup
 class Tck2nodes_radial : public Tck2nodes_base { MEMALIGN(Tck2nodes_radial)
 
   public:
@@ -133,16 +143,22 @@ class Tck2nodes_radial : public Tck2nodes_base { MEMALIGN(Tck2nodes_radial)
     Tck2nodes_radial (const Tck2nodes_radial& that) :
         Tck2nodes_base (that),
         radial_search  (that.radial_search),
+        lookup         (that.lookup),
         max_dist       (that.max_dist),
         max_add_dist   (that.max_add_dist) { }
 
     ~Tck2nodes_radial() { }
 
+    bool endpoints_sufficient() const override { return true; }
+
   private:
     node_t select_node (const Tractography::Streamline<>&, Image<node_t>&, const bool) const override;
 
     void initialise_search ();
     vector<voxel_type> radial_search;
+    // Scratch image storing, for each voxel, the node that a radial search
+    //   seeded from that voxel would select (0 if no node within reach)
+    Image<node_t> lookup;
     const default_type max_dist;
     // Distances are sub-voxel from the precise streamline termination point, so the search order is imperfect.
     //   This parameter controls when to stop the radial search because no voxel within the search space can be closer
@@ -0,0 +1,122 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#include "dwi/tractography/editing/dedupe.h"
+
+#include "exception.h"
+
+
+namespace MR {
+  namespace DWI {
+    namespace Tractography {
+      namespace Editing {
+
+
+
+
+        Dedupe::Dedupe (const float tolerance) :
+            tolerance (tolerance)
+        {
+          if (!(tolerance > 0.0f))
+            throw Exception ("streamline de-duplication tolerance must be positive");
+        }
+
+
+
+
+        bool Dedupe::operator() (const Streamline<>& tck) const
+        {
+          if (tck.empty())
+            return false;
+          const uint64_t sig = signature (tck);
+          std::lock_guard<std::mutex> lock (mutex);
+          return !signatures.insert (sig).second;
+        }
+
+
+
+
+        uint64_t Dedupe::signature (const Streamline<>& tck) const
+        {
+          // resample to a fixed number of points, equidistant in arc length
+          Eigen::Vector3f samples[DEDUPE_NUM_SAMPLES];
+          if (tck.size() == 1) {
+            for (size_t n = 0; n != DEDUPE_NUM_SAMPLES; ++n)
+              samples[n] = tck.front();
+          } else {
+            vector<float> cumulative (tck.size());
+            cumulative[0] = 0.0f;
+            for (size_t i = 1; i != tck.size(); ++i)
+              cumulative[i] = cumulative[i-1] + (tck[i] - tck[i-1]).norm();
+            const float total = cumulative.back();
+            size_t lower = 0;
+            for (size_t n = 0; n != DEDUPE_NUM_SAMPLES; ++n) {
+              const float target = total * (n / float(DEDUPE_NUM_SAMPLES-1));
+              while (lower < tck.size()-2 && cumulative[lower+1] < target)
+                ++lower;
+              const float seg_length = cumulative[lower+1] - cumulative[lower];
+              const float mu = seg_length > 0.0f ? std::min (1.0f, (target - cumulative[lower]) / seg_length) : 0.0f;
+              samples[n] = tck[lower] + mu * (tck[lower+1] - tck[lower]);
+            }
+          }
+
+          // quantise onto the grid
+          int32_t grid[DEDUPE_NUM_SAMPLES][3];
+          for (size_t n = 0; n != DEDUPE_NUM_SAMPLES; ++n) {
+            for (size_t axis = 0; axis != 3; ++axis)
+              grid[n][axis] = int32_t (std::floor (samples[n][axis] / tolerance));
+          }
+
+          // normalise orientation: a streamline & its reverse must hash
+          //   identically, so traverse in whichever direction compares
+          //   lexicographically smaller
+          bool reverse = false;
+          for (size_t n = 0; n != DEDUPE_NUM_SAMPLES/2; ++n) {
+            const size_t m = DEDUPE_NUM_SAMPLES-1-n;
+            bool resolved = false;
+            for (size_t axis = 0; axis != 3; ++axis) {
+              if (grid[n][axis] != grid[m][axis]) {
+                reverse = grid[n][axis] > grid[m][axis];
+                resolved = true;
+                break;
+              }
+            }
+            if (resolved)
+              break;
+          }
+
+          // FNV-1a over the quantised coordinates
+          uint64_t hash = 0xcbf29ce484222325u;
+          auto mix = [&hash] (const int32_t value) {
+            uint32_t bits (value);
+            for (size_t byte = 0; byte != 4; ++byte) {
+              hash = (hash ^ (bits & 0xffu)) * 0x100000001b3u;
+              bits >>= 8;
+            }
+          };
+          for (size_t n = 0; n != DEDUPE_NUM_SAMPLES; ++n) {
+            const size_t index = reverse ? DEDUPE_NUM_SAMPLES-1-n : n;
+            for (size_t axis = 0; axis != 3; ++axis)
+              mix (grid[index][axis]);
+          }
+          return hash;
+        }
+
+
+
+
+      }
+    }
+  }
+}
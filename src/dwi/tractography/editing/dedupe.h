@@ -0,0 +1,81 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __dwi_tractography_editing_dedupe_h__
+#define __dwi_tractography_editing_dedupe_h__
+
+#include <mutex>
+#include <unordered_set>
+
+#include "types.h"
+
+#include "dwi/tractography/streamline.h"
+
+
+/* number of points to which each streamline is resampled (equidistantly by
+   arc length) when deriving its spatial signature for duplicate detection */
+#define DEDUPE_NUM_SAMPLES 8
+
+
+namespace MR {
+  namespace DWI {
+    namespace Tractography {
+      namespace Editing {
+
+
+
+        //! in-memory index of streamline trajectories for duplicate removal
+        /*! For each streamline tested, a compact spatial signature is
+         * derived: the trajectory is resampled to a fixed number of points
+         * equidistant in arc length, those points are quantised onto a grid
+         * of the requested spacing, the orientation is normalised (so that a
+         * streamline and its reverse produce the same signature), and the
+         * result is hashed. A streamline is reported as a duplicate if its
+         * signature has been encountered before, in which case every sample
+         * point lies within the grid spacing of the corresponding point of a
+         * previously-indexed streamline.
+         *
+         * Note that this test is approximate: a pair of near-identical
+         * trajectories that happen to straddle a grid boundary will produce
+         * distinct signatures, and hence both be retained.
+         *
+         * A single instance is shared between all worker threads; signature
+         * derivation runs concurrently, with only the final set insertion
+         * performed under lock. */
+        class Dedupe
+        { NOMEMALIGN
+          public:
+            Dedupe (const float tolerance);
+
+            //! test & insert: returns true if a near-duplicate of this
+            //! streamline has already been indexed; thread-safe
+            bool operator() (const Streamline<>&) const;
+
+          private:
+            const float tolerance;
+            mutable std::unordered_set<uint64_t> signatures;
+            mutable std::mutex mutex;
+
+            uint64_t signature (const Streamline<>&) const;
+
+        };
+
+
+
+      }
+    }
+  }
+}
+
+#endif
@@ -14,6 +14,22 @@
 
 #include "dwi/tractography/editing/editing.h"
 
+#include <cinttypes>
+#include <fstream>
+#include <sstream>
+
+#include "progressbar.h"
+#include "file/key_value.h"
+#include "file/ofstream.h"
+#include "file/path.h"
+#include "dwi/tractography/file_base.h"
+#include "dwi/tractography/mapped_reader.h"
+
+
+// Size of the block copy / write coalescing buffer (in bytes) used when
+//   concatenating or filtering track files by raw data splicing
+#define CONCATENATE_BUFFER_SIZE 16777216
+
 
 namespace MR {
 namespace DWI {
@@ -120,6 +136,331 @@ void load_properties (Tractography::Properties& properties)
 
 
 
+namespace {
+
+  // Writes the output header and final barrier for a raw-splice operation
+  //   (concatenation or filtering), re-using the standard track file header
+  //   machinery; streamline data are appended either as the whole data
+  //   section of an input file, or as per-track raw vertex blocks
+  class RawWriter : public __WriterBase__<float>
+  { NOMEMALIGN
+    public:
+      RawWriter (const std::string& path, const Tractography::Properties& properties) :
+          __WriterBase__<float> (path)
+      {
+        File::OFStream out (name, std::ios::out | std::ios::binary | std::ios::trunc);
+        const_cast<Tractography::Properties&> (properties).set_timestamp();
+        const_cast<Tractography::Properties&> (properties).set_version_info();
+        create (out, properties, "tracks");
+        write_pos = out.tellp();
+        open_success = true;
+      }
+
+      void append (const std::string& path, const int64_t from, const int64_t size)
+      {
+        flush();
+        std::ifstream in (path.c_str(), std::ios::in | std::ios::binary);
+        if (!in)
+          throw Exception ("error opening track file \"" + path + "\": " + strerror (errno));
+        in.seekg (from);
+        File::OFStream out (name, std::ios::in | std::ios::out | std::ios::binary);
+        out.seekp (write_pos);
+        vector<char> buffer (CONCATENATE_BUFFER_SIZE);
+        int64_t remaining = size;
+        while (remaining) {
+          const int64_t n = std::min (remaining, int64_t(buffer.size()));
+          in.read (buffer.data(), n);
+          if (!in.good())
+            throw Exception ("error reading track file \"" + path + "\": " + strerror (errno));
+          out.write (buffer.data(), n);
+          remaining -= n;
+        }
+        verify_stream (out);
+        write_pos = out.tellp();
+      }
+
+      // append the raw vertex block of a single streamline, followed by its
+      //   delimiter triplet; writes are coalesced through an internal buffer
+      void append (const float* data, const size_t num_points)
+      {
+        const char* const bytes = reinterpret_cast<const char*> (data);
+        buffer.insert (buffer.end(), bytes, bytes + 3*num_points*sizeof(float));
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float delimiter[3] = { nan, nan, nan };
+        const char* const delimiter_bytes = reinterpret_cast<const char*> (delimiter);
+        buffer.insert (buffer.end(), delimiter_bytes, delimiter_bytes + sizeof (delimiter));
+        if (buffer.size() >= CONCATENATE_BUFFER_SIZE)
+          flush();
+      }
+
+      void finish (const uint64_t num_written, const uint64_t num_read)
+      {
+        flush();
+        count = num_written;
+        total_count = num_read;
+        File::OFStream out (name, std::ios::in | std::ios::out | std::ios::binary);
+        out.seekp (write_pos);
+        const float inf = std::numeric_limits<float>::infinity();
+        const float barrier[3] = { inf, inf, inf };
+        out.write (reinterpret_cast<const char*> (barrier), sizeof (barrier));
+        verify_stream (out);
+        update_counts (out);
+      }
+
+    private:
+      int64_t write_pos;
+      vector<char> buffer;
+
+      void flush ()
+      {
+        if (buffer.empty())
+          return;
+        File::OFStream out (name, std::ios::in | std::ios::out | std::ios::binary);
+        out.seekp (write_pos);
+        out.write (buffer.data(), buffer.size());
+        verify_stream (out);
+        write_pos = out.tellp();
+        buffer.clear();
+      }
+  };
+
+}
+
+
+
+bool concatenate (const vector<std::string>& inputs, const std::string& output, const Tractography::Properties& properties)
+{
+  if (!Path::has_suffix (output, ".tck"))
+    return false;
+
+  DataType required (DataType::from<float>());
+  required.set_byte_order_native();
+
+  struct Layout { std::string path; int64_t from, size; };
+  vector<Layout> layouts;
+  uint64_t num_tracks = 0;
+
+  for (const auto& path : inputs) {
+
+    if (!Path::has_suffix (path, ".tck"))
+      return false;
+
+    File::KeyValue kv (path, "mrtrix tracks");
+    DataType dtype (DataType::Undefined);
+    std::string data_file;
+    uint64_t this_count = 0;
+    bool have_count = false;
+    while (kv.next()) {
+      const std::string key = lowercase (kv.key());
+      if (key == "datatype")
+        dtype = DataType::parse (kv.value());
+      else if (key == "file")
+        data_file = kv.value();
+      else if (key == "count") {
+        this_count = to<uint64_t> (kv.value());
+        have_count = true;
+      }
+    }
+    if (dtype != required || !have_count)
+      return false;
+
+    // The streamline data must reside within the same file
+    std::istringstream file_stream (data_file);
+    std::string fname;
+    int64_t offset = 0;
+    file_stream >> fname >> offset;
+    if (fname != "." || offset <= 0)
+      return false;
+
+    std::ifstream in (path.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+      throw Exception ("error opening track file \"" + path + "\": " + strerror (errno));
+    in.seekg (0, std::ios::end);
+    const int64_t file_size = in.tellg();
+
+    // The data section must terminate with the end-of-file barrier,
+    //   which is not copied across (a single barrier is written once
+    //   all input files have been spliced)
+    float barrier[3];
+    const int64_t data_size = file_size - offset - int64_t(sizeof (barrier));
+    if (data_size < 0)
+      return false;
+    in.seekg (file_size - int64_t(sizeof (barrier)));
+    in.read (reinterpret_cast<char*> (barrier), sizeof (barrier));
+    if (!in.good() || !std::isinf (barrier[0]) || !std::isinf (barrier[1]) || !std::isinf (barrier[2]))
+      return false;
+
+    layouts.push_back ({ path, offset, data_size });
+    num_tracks += this_count;
+  }
+
+  INFO ("no streamline selection criteria provided; concatenating raw track file data");
+
+  RawWriter writer (output, properties);
+  {
+    ProgressBar progress ("concatenating track files", layouts.size());
+    for (const auto& i : layouts) {
+      writer.append (i.path, i.from, i.size);
+      ++progress;
+    }
+  }
+  writer.finish (num_tracks, num_tracks);
+  return true;
+}
+
+
+
+
+bool filter (const vector<std::string>& inputs, const std::string& output,
+             const Tractography::Properties& properties,
+             const bool inverse, const bool ends_only,
+             const uint64_t number, const uint64_t skip)
+{
+  if (!Path::has_suffix (output, ".tck"))
+    return false;
+  for (const auto& path : inputs) {
+    if (!Path::has_suffix (path, ".tck"))
+      return false;
+  }
+
+  // Map all inputs up front: if any file does not support zero-copy access,
+  //   fall back to the generic pipeline before the output file is created
+  vector<std::unique_ptr<MappedReader>> readers;
+  try {
+    for (const auto& path : inputs) {
+      Properties p;
+      readers.push_back (std::unique_ptr<MappedReader> (new MappedReader (path, p)));
+    }
+  } catch (Exception& e) {
+    DEBUG ("memory-mapped filtering not possible (" + e[0] + "); reverting to streamline-by-streamline processing");
+    return false;
+  }
+
+  // Mirror the length threshold handling of Worker::Thresholds, including
+  //   the error margin applied to account for floating-point imprecision in
+  //   the streamline length calculation
+  const float step_size = get_step_size (properties);
+  float max_length = std::numeric_limits<float>::infinity();
+  float min_length = 0.0f;
+  if (properties.find ("max_dist") != properties.end()) {
+    try {
+      max_length = to<float>(properties.find ("max_dist")->second);
+    } catch (...) { }
+  }
+  if (properties.find ("min_dist") != properties.end()) {
+    try {
+      min_length = to<float>(properties.find ("min_dist")->second);
+    } catch (...) { }
+  }
+  if (std::isfinite (step_size)) {
+    float error_margin = 0.1;
+    if (properties.find ("downsample_factor") != properties.end())
+      error_margin = 0.5 / to<float>(properties.find ("downsample_factor")->second);
+    max_length += error_margin * step_size;
+    min_length -= error_margin * step_size;
+  }
+
+  // In the absence of a streamline weights file every streamline carries
+  //   unit weight, so any weight thresholds resolve to a constant verdict
+  float max_weight = std::numeric_limits<float>::infinity();
+  float min_weight = 0.0f;
+  if (properties.find ("max_weight") != properties.end())
+    max_weight = to<float>(properties.find ("max_weight")->second);
+  if (properties.find ("min_weight") != properties.end())
+    min_weight = to<float>(properties.find ("min_weight")->second);
+  const bool weight_pass = (1.0f <= max_weight) && (1.0f >= min_weight);
+
+  // Equivalent to Streamline::calc_length(), operating on the mapped view
+  auto track_length = [step_size] (const MappedReader::Track& tck) -> float {
+    switch (tck.size()) {
+      case 0: return std::numeric_limits<float>::quiet_NaN();
+      case 1: return 0.0f;
+      case 2: return (tck[1]-tck[0]).norm();
+      case 3: return (tck[1]-tck[0]).norm() + (tck[2]-tck[1]).norm();
+      default: break;
+    }
+    const size_t size = tck.size();
+    const float step = std::isfinite (step_size) ? step_size : (tck[size/2 - 1]-tck[size/2]).norm();
+    return step*(size-3) + (tck[1]-tck[0]).norm() + (tck[size-1]-tck[size-2]).norm();
+  };
+
+  const bool have_rois = properties.include.size() || properties.exclude.size();
+  vector<bool> include_visited (properties.include.size(), false);
+
+  // Replicates the criteria evaluation of Worker::operator(), in the same
+  //   order; empty streamlines never get as far as the ROI tests, since the
+  //   NaN length returned for them fails the threshold comparisons
+  auto accept = [&] (const MappedReader::Track& tck) -> bool {
+    const float length = track_length (tck);
+    if (!((length <= max_length) && (length >= min_length) && weight_pass))
+      return false;
+    if (have_rois) {
+      include_visited.assign (properties.include.size(), false);
+      if (ends_only) {
+        for (size_t i = 0; i != 2; ++i) {
+          const Eigen::Vector3f p (tck[i ? tck.size()-1 : 0]);
+          properties.include.contains (p, include_visited);
+          if (properties.exclude.contains (p))
+            return false;
+        }
+      } else {
+        for (size_t n = 0; n != tck.size(); ++n) {
+          const Eigen::Vector3f p (tck[n]);
+          properties.include.contains (p, include_visited);
+          if (properties.exclude.contains (p))
+            return false;
+        }
+      }
+      for (const auto& i : include_visited) {
+        if (!i)
+          return false;
+      }
+    }
+    return true;
+  };
+
+  INFO ("selection criteria do not modify accepted streamlines; forwarding raw track data");
+
+  RawWriter writer (output, properties);
+  uint64_t num_read = 0, num_rejected = 0, num_written = 0, to_skip = skip;
+  {
+    ProgressBar progress ("       0 read,        0 written");
+    auto display_func = [&]() { return printf ("%8" PRIu64 " read, %8" PRIu64 " written", num_read, num_written); };
+
+    for (auto& reader : readers) {
+      MappedReader::Track tck;
+      while (!(number && (num_written == number)) && (*reader) (tck)) {
+        ++num_read;
+        // Empty streamlines are counted, but never written, regardless of
+        //   the criteria or the -inverse option
+        if (tck.empty() || (accept (tck) == inverse)) {
+          ++num_rejected;
+          progress.update (display_func);
+          continue;
+        }
+        if (to_skip) {
+          --to_skip;
+          progress.update (display_func);
+          continue;
+        }
+        writer.append (tck.data(), tck.size());
+        ++num_written;
+        progress.update (display_func);
+      }
+    }
+    progress.set_text (printf ("%8" PRIu64 " read, %8" PRIu64 " written", num_read, num_written));
+  }
+  writer.finish (num_written, num_read);
+
+  if (number && (num_written != number))
+    WARN ("User requested " + str(number) + " streamlines, but only " + str(num_written) + " were written to file");
+
+  return true;
+}
+
+
+
+
 }
 }
 }
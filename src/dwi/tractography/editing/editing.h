@@ -34,6 +34,35 @@ extern const App::OptionGroup WeightsOption;
 void load_properties (Tractography::Properties&);
 
 
+//! concatenate track files by raw data splicing
+/*! For use when no streamline selection or modification is taking place:
+ * writes a header based on \a properties, then copies the raw streamline
+ * data sections of the input files directly into the output, without
+ * decoding and re-encoding every vertex. Returns false (without having
+ * created the output file) if the files do not permit this fast path
+ * (non-.tck suffix, non-native datatype, missing track count, or a
+ * missing end-of-file barrier), in which case the caller should fall
+ * back to streamline-by-streamline processing. */
+bool concatenate (const vector<std::string>&, const std::string&, const Tractography::Properties&);
+
+
+//! filter track files by raw data splicing
+/*! For use when streamline selection criteria are provided, but accepted
+ * streamlines are propagated to the output unmodified (i.e. no mask
+ * cropping, and no involvement of per-streamline weights): the criteria
+ * (length thresholds, include / exclude ROIs, -inverse, -ends_only,
+ * -number, -skip) are evaluated directly against the memory-mapped input
+ * data, and the raw vertex block of each accepted streamline is forwarded
+ * straight to the output file, without decoding and re-encoding every
+ * vertex. Returns false (without having created the output file) if any
+ * input does not permit memory-mapped access (see MappedReader), in which
+ * case the caller should fall back to streamline-by-streamline
+ * processing. */
+bool filter (const vector<std::string>&, const std::string&, const Tractography::Properties&,
+             const bool inverse, const bool ends_only,
+             const uint64_t number, const uint64_t skip);
+
+
 
 }
 }
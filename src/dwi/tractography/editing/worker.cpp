@@ -37,6 +37,13 @@ namespace MR {
             return true;
           }
 
+          // Failing the uniqueness test counts as failing a criterion
+          if (dedupe && (*dedupe) (in)) {
+            if (inverse)
+              in.swap (out);
+            return true;
+          }
+
           // Assign to ROIs
           if (properties.include.size() || properties.exclude.size()) {
 
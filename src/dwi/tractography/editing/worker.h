@@ -23,6 +23,8 @@
 #include "dwi/tractography/properties.h"
 #include "dwi/tractography/streamline.h"
 
+#include "dwi/tractography/editing/dedupe.h"
+
 
 
 namespace MR {
@@ -37,10 +39,11 @@ namespace MR {
         { MEMALIGN(Worker)
 
           public:
-            Worker (Tractography::Properties& p, const bool inv, const bool end) :
+            Worker (Tractography::Properties& p, const bool inv, const bool end, const Dedupe* const dedupe = nullptr) :
               properties (p),
               inverse (inv),
               ends_only (end),
+              dedupe (dedupe),
               thresholds (p),
               include_visited (properties.include.size(), false) { }
 
@@ -48,6 +51,7 @@ namespace MR {
               properties (that.properties),
               inverse (that.inverse),
               ends_only (that.ends_only),
+              dedupe (that.dedupe),
               thresholds (that.thresholds),
               include_visited (properties.include.size(), false) { }
 
@@ -58,6 +62,8 @@ namespace MR {
           private:
             const Tractography::Properties& properties;
             const bool inverse, ends_only;
+            // shared between all copies of the Worker class
+            const Dedupe* const dedupe;
 
             class Thresholds
             { NOMEMALIGN
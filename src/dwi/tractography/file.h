@@ -24,8 +24,27 @@
 #include "file/key_value.h"
 #include "file/ofstream.h"
 #include "dwi/tractography/file_base.h"
+#include "dwi/tractography/mapped_reader.h"
 #include "dwi/tractography/properties.h"
 #include "dwi/tractography/streamline.h"
+#include "dwi/tractography/weights.h"
+
+
+// Suffix identifying the compressed track file format: each streamline is
+//   stored as a block comprising a point count, a first absolute position,
+//   and per-point deltas quantised to 16-bit integers, making files typically
+//   3-4x smaller than the float32 triplets of the .tck format
+#define TCK_COMPRESSED_SUFFIX ".tckz"
+// Default quantisation step (in mm) for the delta encoding; well below the
+//   step size of any realistic tracking run, so the worst-case positional
+//   error (half of this, per axis) is negligible. The value used is recorded
+//   in the file header
+#define TCK_COMPRESSED_QUANT_DEFAULT 0.001f
+// Reserved delta value flagging that the following point is stored as an
+//   absolute position (used when a delta exceeds the 16-bit range)
+#define TCK_COMPRESSED_ESCAPE (-32768)
+// End-of-data sentinel in place of a block's point count (endianness-neutral)
+#define TCK_COMPRESSED_BARRIER 0xFFFFFFFFu
 
 
 namespace MR
@@ -70,14 +89,24 @@ namespace MR
 
           //! open the \c file for reading and load header into \c properties
           Reader (const std::string& file, Properties& properties) :
-            current_index (0) {
-              open (file, "tracks", properties);
-              auto opt = App::get_options ("tck_weights_in");
-              if (opt.size()) {
-                weights_file.reset (new std::ifstream (str(opt[0][0]).c_str(), std::ios_base::in));
-                if (!weights_file->good())
-                  throw Exception ("Unable to open streamlines weights file " + str(opt[0][0]));
+            path (file),
+            current_index (0),
+            compressed (Path::has_suffix (file, TCK_COMPRESSED_SUFFIX)),
+            quant (TCK_COMPRESSED_QUANT_DEFAULT),
+            endpoints_only (false),
+            data_offset (0) {
+              open (file, compressed ? "compressed tracks" : "tracks", properties);
+              data_offset = in.tellg();
+              if (compressed) {
+                if (dtype != DataType::Float32LE)
+                  throw Exception ("compressed track files must use the Float32LE datatype");
+                const auto q = properties.find ("quantisation");
+                if (q != properties.end())
+                  quant = to<float> (q->second);
               }
+              auto opt = App::get_options ("tck_weights_in");
+              if (opt.size())
+                weights_file.reset (new WeightsReader (str(opt[0][0])));
             }
 
 
@@ -88,6 +117,12 @@ namespace MR
               if (!in.is_open())
                 return false;
 
+              if (compressed)
+                return read_next_compressed (tck);
+
+              if (endpoints_only)
+                return read_next_endpoints (tck);
+
               do {
                 auto p = get_next_point();
                 if (std::isinf (p[0])) {
@@ -101,25 +136,8 @@ namespace MR
                   return false;
                 }
 
-                if (std::isnan (p[0])) {
-                  tck.index = current_index++;
-
-                  if (weights_file) {
-
-                    (*weights_file) >> tck.weight;
-                    if (weights_file->fail()) {
-                      WARN ("Streamline weights file contains less entries than .tck file; only read " + str(current_index-1) + " streamlines");
-                      in.close();
-                      tck.clear();
-                      return false;
-                    }
-
-                  } else {
-                    tck.weight = 1.0;
-                  }
-
-                  return true;
-                }
+                if (std::isnan (p[0]))
+                  return assign_weight (tck);
 
                 tck.push_back (p);
               } while (in.good());
@@ -130,12 +148,156 @@ namespace MR
 
 
 
+            //! restrict reading to the first and last vertex of each streamline
+            /*! uses the sidecar track index (as written by
+             * MappedReader::save_index()) to seek directly to the endpoint
+             * vertices of each track, rather than streaming through every
+             * intervening vertex; intended for workloads (e.g. endpoint-based
+             * connectome assignment) where the interior of the streamline is
+             * irrelevant. The streamlines issued contain at most two vertices.
+             *
+             * Returns false - leaving the reader in its usual streaming mode -
+             * if the index is absent, does not match the data file, or the
+             * file format does not support seeking (compressed or non-float32
+             * data). */
+            bool set_endpoints_only ()
+            {
+              if (compressed)
+                return false;
+              if (dtype != DataType::Float32LE && dtype != DataType::Float32BE)
+                return false;
+              const std::string index_path = path + ".idx";
+              if (!Path::exists (index_path))
+                return false;
+              std::ifstream index (index_path.c_str(), std::ios::in | std::ios::binary);
+              if (!index)
+                return false;
+              // the data region size in float32 values, as recorded by the
+              //   scan from which the index was built
+              const int64_t current = in.tellg();
+              in.seekg (0, std::ios::end);
+              const uint64_t num_values = 3 * (uint64_t (int64_t (in.tellg()) - data_offset) / (3 * sizeof (float)));
+              in.seekg (current, std::ios::beg);
+              char file_magic [sizeof (MRTRIX_TCK_INDEX_MAGIC)];
+              uint64_t n_values = 0, n_tracks = 0;
+              index.read (file_magic, sizeof (file_magic));
+              index.read (reinterpret_cast<char*> (&n_values), sizeof (uint64_t));
+              index.read (reinterpret_cast<char*> (&n_tracks), sizeof (uint64_t));
+              if (!index.good() || memcmp (file_magic, MRTRIX_TCK_INDEX_MAGIC, sizeof (file_magic)) || n_values != num_values) {
+                WARN ("tracks index file \"" + index_path + "\" does not match tracks file; reading all vertices");
+                return false;
+              }
+              boundaries.resize (n_tracks + 1);
+              index.read (reinterpret_cast<char*> (boundaries.data()), boundaries.size() * sizeof (uint64_t));
+              if (!index.good() || boundaries.back() > num_values/3) {
+                WARN ("tracks index file \"" + index_path + "\" is truncated or corrupt; reading all vertices");
+                boundaries.clear();
+                return false;
+              }
+              endpoints_only = true;
+              return true;
+            }
+
+
         protected:
           using __ReaderBase__::in;
           using __ReaderBase__::dtype;
 
+          const std::string path;
           uint64_t current_index;
-          std::unique_ptr<std::ifstream> weights_file;
+          const bool compressed;
+          float quant;
+          std::unique_ptr<WeightsReader> weights_file;
+          bool endpoints_only;
+          int64_t data_offset;
+          vector<uint64_t> boundaries;
+
+          //! assign the index and weight of a freshly-read track
+          bool assign_weight (Streamline<ValueType>& tck)
+          {
+            tck.index = current_index++;
+
+            if (weights_file) {
+
+              if (!(*weights_file) (tck.weight)) {
+                WARN ("Streamline weights file contains less entries than .tck file; only read " + str(current_index-1) + " streamlines");
+                in.close();
+                tck.clear();
+                return false;
+              }
+
+            } else {
+              tck.weight = 1.0;
+            }
+
+            return true;
+          }
+
+          //! decode the next per-track block of the compressed format
+          bool read_next_compressed (Streamline<ValueType>& tck)
+          {
+            using namespace ByteOrder;
+
+            uint32_t n = 0;
+            in.read (reinterpret_cast<char*> (&n), sizeof (n));
+            if (in.eof() || n == TCK_COMPRESSED_BARRIER) {
+              in.close();
+              check_excess_weights();
+              return false;
+            }
+            n = LE (n);
+
+            float p[3];
+            in.read (reinterpret_cast<char*> (p), sizeof (p));
+            Eigen::Vector3f pos (LE (p[0]), LE (p[1]), LE (p[2]));
+            tck.push_back (pos.template cast<ValueType>());
+
+            for (uint32_t i = 1; i < n; ++i) {
+              int16_t d[3];
+              in.read (reinterpret_cast<char*> (d), sizeof (d));
+              if (LE (d[0]) == TCK_COMPRESSED_ESCAPE && LE (d[1]) == TCK_COMPRESSED_ESCAPE && LE (d[2]) == TCK_COMPRESSED_ESCAPE) {
+                in.read (reinterpret_cast<char*> (p), sizeof (p));
+                pos = { LE (p[0]), LE (p[1]), LE (p[2]) };
+              } else {
+                pos += quant * Eigen::Vector3f (LE (d[0]), LE (d[1]), LE (d[2]));
+              }
+              tck.push_back (pos.template cast<ValueType>());
+            }
+
+            if (!in.good()) {
+              in.close();
+              tck.clear();
+              return false;
+            }
+
+            return assign_weight (tck);
+          }
+
+          //! seek to and read only the endpoint vertices of the next track
+          bool read_next_endpoints (Streamline<ValueType>& tck)
+          {
+            if (current_index + 1 >= boundaries.size()) {
+              in.close();
+              check_excess_weights();
+              return false;
+            }
+            const uint64_t first = boundaries[current_index];
+            const uint64_t num_points = boundaries[current_index+1] - first - 1;
+            if (num_points) {
+              in.seekg (data_offset + int64_t (3 * sizeof (float) * first), std::ios::beg);
+              tck.push_back (get_next_point());
+              if (num_points > 1) {
+                in.seekg (data_offset + int64_t (3 * sizeof (float) * (first + num_points - 1)), std::ios::beg);
+                tck.push_back (get_next_point());
+              }
+            }
+            if (!in.good()) {
+              in.close();
+              tck.clear();
+              return false;
+            }
+            return assign_weight (tck);
+          }
 
           //! takes care of byte ordering issues
 
@@ -177,11 +339,7 @@ namespace MR
           //! Check that the weights file does not contain excess entries
           void check_excess_weights()
           {
-            if (!weights_file)
-              return;
-            float temp;
-            (*weights_file) >> temp;
-            if (!weights_file->fail())
+            if (weights_file && weights_file->has_excess())
               WARN ("Streamline weights file contains more entries than .tck file");
           }
 
@@ -224,10 +382,18 @@ namespace MR
 
           //! create a new track file with the specified properties
           WriterUnbuffered (const std::string& file, const Properties& properties) :
-              __WriterBase__<ValueType> (file) {
+              __WriterBase__<ValueType> (file),
+              compressed (Path::has_suffix (file, TCK_COMPRESSED_SUFFIX)),
+              quant (TCK_COMPRESSED_QUANT_DEFAULT),
+              weights_binary (false),
+              weights_count (0) {
+
+            if (!Path::has_suffix (name, ".tck") && !compressed)
+              throw Exception ("output track files must use the .tck or " TCK_COMPRESSED_SUFFIX " suffix");
 
-            if (!Path::has_suffix (name, ".tck"))
-              throw Exception ("output track files must use the .tck suffix");
+            // Compressed data are always stored as little-endian, regardless of ValueType
+            if (compressed)
+              dtype = DataType::Float32LE;
 
             File::OFStream out;
             try {
@@ -238,13 +404,20 @@ namespace MR
 
             const_cast<Properties&> (properties).set_timestamp();
             const_cast<Properties&> (properties).set_version_info();
+            if (compressed)
+              const_cast<Properties&> (properties)["quantisation"] = str (quant);
 
-            create (out, properties, "tracks");
+            create (out, properties, compressed ? "compressed tracks" : "tracks");
             barrier_addr = out.tellp();
 
-            vector_type x;
-            format_point (barrier(), x);
-            out.write (reinterpret_cast<char*> (&x[0]), sizeof (x));
+            if (compressed) {
+              const uint32_t b (TCK_COMPRESSED_BARRIER);
+              out.write (reinterpret_cast<const char*> (&b), sizeof (b));
+            } else {
+              vector_type x;
+              format_point (barrier(), x);
+              out.write (reinterpret_cast<char*> (&x[0]), sizeof (x));
+            }
             if (!out.good())
               throw Exception ("error writing tracks file \"" + name + "\": " + strerror (errno));
             open_success = true;
@@ -257,16 +430,24 @@ namespace MR
           //! append track to file
           bool operator() (const Streamline<ValueType>& tck) {
             if (tck.size()) {
-              // allocate buffer on the stack for performance:
-              NON_POD_VLA (buffer, vector_type, tck.size()+2);
-              for (size_t n = 0; n < tck.size(); ++n)
-                format_point (tck[n], buffer[n]);
-              format_point (delimiter(), buffer[tck.size()]);
-
-              commit (buffer, tck.size()+1);
+              if (compressed) {
+                vector<uint8_t> block;
+                block.reserve (2 * sizeof (uint32_t) + 3 * sizeof (float) + (3 * sizeof (int16_t) + 3 * sizeof (float)) * tck.size());
+                encode_track (tck, block, quant);
+                append_barrier (block);
+                commit_bytes (block.data(), block.size());
+              } else {
+                // allocate buffer on the stack for performance:
+                NON_POD_VLA (buffer, vector_type, tck.size()+2);
+                for (size_t n = 0; n < tck.size(); ++n)
+                  format_point (tck[n], buffer[n]);
+                format_point (delimiter(), buffer[tck.size()]);
+
+                commit (buffer, tck.size()+1);
+              }
 
               if (weights_name.size())
-                write_weights (str(tck.weight) + "\n");
+                write_weight (tck.weight);
 
               ++count;
             }
@@ -275,18 +456,69 @@ namespace MR
           }
 
 
+          //! the quantisation step used by the compressed format
+          /*! encoding performed outside of this class (see
+           * Tracking::EncodeKernel) must use this same value, since it is
+           * what the decoder will read from the file header */
+          float quantisation () const { return quant; }
+
+          //! delta-encode one track as a compressed per-track block
+          /*! each displacement is quantised against the position as it will be
+           * reconstructed by the decoder, so that rounding errors do not
+           * accumulate along the track; displacements that overflow the 16-bit
+           * range are stored verbatim, preceded by an escape triplet. */
+          template <class PointContainer>
+            static void encode_track (const PointContainer& tck, vector<uint8_t>& block, const float quant) {
+              append_bytes (block, uint32_t (tck.size()));
+              Eigen::Vector3f pos = tck.front().template cast<float>();
+              append_point (block, pos);
+              for (size_t n = 1; n < tck.size(); ++n) {
+                const Eigen::Vector3f target = tck[n].template cast<float>();
+                const Eigen::Vector3f delta = (target - pos) / quant;
+                const int32_t qx = int32_t (std::round (delta[0]));
+                const int32_t qy = int32_t (std::round (delta[1]));
+                const int32_t qz = int32_t (std::round (delta[2]));
+                if (std::abs (qx) <= 32767 && std::abs (qy) <= 32767 && std::abs (qz) <= 32767) {
+                  append_bytes (block, int16_t (qx));
+                  append_bytes (block, int16_t (qy));
+                  append_bytes (block, int16_t (qz));
+                  pos += quant * Eigen::Vector3f (qx, qy, qz);
+                } else {
+                  append_bytes (block, int16_t (TCK_COMPRESSED_ESCAPE));
+                  append_bytes (block, int16_t (TCK_COMPRESSED_ESCAPE));
+                  append_bytes (block, int16_t (TCK_COMPRESSED_ESCAPE));
+                  append_point (block, target);
+                  pos = target;
+                }
+              }
+            }
+
           //! set the path to the track weights
+          /*! selects the binary streamline weights format if \a path carries
+           * the TCK_WEIGHTS_SUFFIX suffix, and ASCII text otherwise */
           void set_weights_path (const std::string& path) {
             if (weights_name.size())
               throw Exception ("Cannot change output streamline weights file path");
             weights_name = path;
+            weights_binary = Path::has_suffix (path, TCK_WEIGHTS_SUFFIX);
             App::check_overwrite (weights_name);
             File::OFStream out (weights_name, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (weights_binary) {
+              out.write (TCK_WEIGHTS_MAGIC, sizeof (TCK_WEIGHTS_MAGIC));
+              const uint64_t zero = 0;
+              out.write (reinterpret_cast<const char*> (&zero), sizeof (uint64_t));
+              if (!out.good())
+                throw Exception ("error writing streamline weights file \"" + weights_name + "\": " + strerror (errno));
+            }
           }
 
         protected:
           std::string weights_name;
           int64_t barrier_addr;
+          const bool compressed;
+          const float quant;
+          bool weights_binary;
+          uint64_t weights_count;
 
           //! indicates end of track and start of new track
           vector_type delimiter () const { return { ValueType(NaN), ValueType(NaN), ValueType(NaN) }; }
@@ -310,6 +542,26 @@ namespace MR
               throw Exception ("error writing streamline weights file \"" + weights_name + "\": " + strerror (errno));
           }
 
+          //! append a single weight, in whichever format was selected
+          void write_weight (const float weight) {
+            if (weights_binary)
+              write_weights_binary (&weight, 1);
+            else
+              write_weights (str(weight) + "\n");
+          }
+
+          //! append a block of binary weights, and update the header entry count
+          void write_weights_binary (const float* data, const size_t num) {
+            File::OFStream out (weights_name, std::ios::in | std::ios::out | std::ios::binary);
+            out.seekp (0, std::ios::end);
+            out.write (reinterpret_cast<const char*> (data), num * sizeof (float));
+            weights_count += num;
+            out.seekp (sizeof (TCK_WEIGHTS_MAGIC), std::ios::beg);
+            out.write (reinterpret_cast<const char*> (&weights_count), sizeof (uint64_t));
+            if (!out.good())
+              throw Exception ("error writing streamline weights file \"" + weights_name + "\": " + strerror (errno));
+          }
+
 
           //! write track point data to file
           /*! \note \c buffer needs to be greater than \c num_points by one
@@ -332,6 +584,47 @@ namespace MR
           }
 
 
+          //! append raw little-endian bytes to a compressed encoding buffer
+          template <typename T>
+            static void append_bytes (vector<uint8_t>& block, const T value) {
+              const T v = ByteOrder::LE (value);
+              const uint8_t* const p = reinterpret_cast<const uint8_t*> (&v);
+              block.insert (block.end(), p, p + sizeof (T));
+            }
+
+          //! append an uncompressed float32 triplet to a compressed encoding buffer
+          static void append_point (vector<uint8_t>& block, const Eigen::Vector3f& p) {
+            append_bytes (block, float (p[0]));
+            append_bytes (block, float (p[1]));
+            append_bytes (block, float (p[2]));
+          }
+
+          //! append the end-of-data marker to a compressed encoding buffer
+          static void append_barrier (vector<uint8_t>& block) {
+            append_bytes (block, uint32_t (TCK_COMPRESSED_BARRIER));
+          }
+
+          //! write compressed track data to file
+          /*! \note \c data must end with the 4-byte barrier, which is written
+           * over the previous barrier once the remainder of the block has been
+           * committed, using the same protocol as commit(). */
+          void commit_bytes (const uint8_t* data, const size_t size) {
+            if (size <= sizeof (uint32_t) || !open_success)
+              return;
+
+            int64_t prev_barrier_addr = barrier_addr;
+
+            File::OFStream out (name, std::ios::in | std::ios::out | std::ios::binary | std::ios::ate);
+            out.write (reinterpret_cast<const char*> (data + sizeof (uint32_t)), size - sizeof (uint32_t));
+            verify_stream (out);
+            barrier_addr = int64_t (out.tellp()) - sizeof (uint32_t);
+            out.seekp (prev_barrier_addr, out.beg);
+            out.write (reinterpret_cast<const char*> (data), sizeof (uint32_t));
+            verify_stream (out);
+            update_counts (out);
+          }
+
+
           //! copy construction explicitly disabled
           WriterUnbuffered (const WriterUnbuffered&) = delete;
       };
@@ -363,7 +656,14 @@ namespace MR
           using WriterUnbuffered<ValueType>::delimiter;
           using WriterUnbuffered<ValueType>::format_point;
           using WriterUnbuffered<ValueType>::weights_name;
+          using WriterUnbuffered<ValueType>::weights_binary;
           using WriterUnbuffered<ValueType>::write_weights;
+          using WriterUnbuffered<ValueType>::write_weights_binary;
+          using WriterUnbuffered<ValueType>::compressed;
+          using WriterUnbuffered<ValueType>::quant;
+          using WriterUnbuffered<ValueType>::encode_track;
+          using WriterUnbuffered<ValueType>::append_barrier;
+          using WriterUnbuffered<ValueType>::commit_bytes;
           using vector_type = typename WriterUnbuffered<ValueType>::vector_type;
 
           //! create new RAM-buffered track file with specified properties
@@ -380,8 +680,12 @@ namespace MR
           Writer (const std::string& file, const Properties& properties, size_t default_buffer_capacity = 16777216) :
             WriterUnbuffered<ValueType> (file, properties),
             buffer_capacity (File::Config::get_int ("TrackWriterBufferSize", default_buffer_capacity) / sizeof (vector_type)),
-            buffer (new vector_type [buffer_capacity]),
-            buffer_size (0) { }
+            buffer (compressed ? nullptr : new vector_type [buffer_capacity]),
+            buffer_size (0)
+          {
+            if (compressed)
+              byte_buffer.reserve (buffer_capacity * sizeof (vector_type));
+          }
 
           Writer (const Writer& W) = delete;
 
@@ -393,16 +697,48 @@ namespace MR
           //! append track to file
           bool operator() (const Streamline<ValueType>& tck) {
             if (tck.size()) {
-              if (buffer_size + tck.size() + 2 > buffer_capacity)
-                commit ();
+              if (compressed) {
+                // upper bound on the encoded size of this track, plus the barrier
+                const size_t max_bytes = 2 * sizeof (uint32_t) + 3 * sizeof (float) + (3 * sizeof (int16_t) + 3 * sizeof (float)) * tck.size();
+                if (byte_buffer.size() + max_bytes > buffer_capacity * sizeof (vector_type))
+                  commit ();
+                encode_track (tck, byte_buffer, quant);
+              } else {
+                if (buffer_size + tck.size() + 2 > buffer_capacity)
+                  commit ();
+
+                for (const auto& i : tck)
+                  add_point (i);
+                add_point (delimiter());
+              }
 
-              for (const auto& i : tck)
-                add_point (i);
-              add_point (delimiter());
+              if (weights_name.size()) {
+                if (weights_binary)
+                  weights_binary_buffer.push_back (tck.weight);
+                else
+                  weights_buffer += str (tck.weight) + ' ';
+              }
 
-              if (weights_name.size())
-                weights_buffer += str (tck.weight) + ' ';
+              ++count;
+            }
+            ++total_count;
+            return true;
+          }
 
+          //! append a track already encoded via encode_track()
+          /*! used by sinks whose producer threads perform the delta encoding
+           * themselves (see Tracking::EncodeKernel), leaving the single write
+           * thread to do no more than append ready-made blocks to the buffer.
+           * An empty block denotes an empty track, which contributes to
+           * \c total_count only. Streamline weights are not supported through
+           * this interface. */
+          bool operator() (const vector<uint8_t>& block) {
+            assert (compressed);
+            assert (weights_name.empty());
+            if (block.size()) {
+              if (byte_buffer.size() + block.size() + sizeof (uint32_t) > buffer_capacity * sizeof (vector_type))
+                commit ();
+              byte_buffer.insert (byte_buffer.end(), block.begin(), block.end());
               ++count;
             }
             ++total_count;
@@ -413,8 +749,10 @@ namespace MR
         protected:
           const size_t buffer_capacity;
           std::unique_ptr<vector_type[]> buffer;
+          vector<uint8_t> byte_buffer;
           size_t buffer_size;
           std::string weights_buffer;
+          vector<float> weights_binary_buffer;
 
           //! add point to buffer and increment buffer_size accordingly
           void add_point (const vector_type& p) {
@@ -422,12 +760,27 @@ namespace MR
           }
 
           void commit () {
-            WriterUnbuffered<ValueType>::commit (buffer.get(), buffer_size);
-            buffer_size = 0;
+            if (compressed) {
+              if (byte_buffer.size()) {
+                append_barrier (byte_buffer);
+                commit_bytes (byte_buffer.data(), byte_buffer.size());
+                byte_buffer.clear();
+              }
+            } else {
+              WriterUnbuffered<ValueType>::commit (buffer.get(), buffer_size);
+              buffer_size = 0;
+            }
 
             if (weights_name.size()) {
-              write_weights (weights_buffer);
-              weights_buffer.clear();
+              if (weights_binary) {
+                if (weights_binary_buffer.size()) {
+                  write_weights_binary (weights_binary_buffer.data(), weights_binary_buffer.size());
+                  weights_binary_buffer.clear();
+                }
+              } else {
+                write_weights (weights_buffer);
+                weights_buffer.clear();
+              }
             }
           }
 
@@ -0,0 +1,218 @@
+/* Copyright (c) 2008-2017 the MRtrix3 contributors.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * MRtrix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * For more details, see http://www.mrtrix.org/.
+ */
+
+
+#ifndef __dwi_tractography_mapped_reader_h__
+#define __dwi_tractography_mapped_reader_h__
+
+//! magic signature of the sidecar track index file
+#define MRTRIX_TCK_INDEX_MAGIC "TCKIDX1"
+
+#include <cerrno>
+#include <cstring>
+
+#include "types.h"
+#include "memory.h"
+#include "file/entry.h"
+#include "file/mmap.h"
+#include "file/ofstream.h"
+#include "file/path.h"
+#include "dwi/tractography/file_base.h"
+#include "dwi/tractography/properties.h"
+#include "dwi/tractography/streamline.h"
+
+
+namespace MR
+{
+  namespace DWI
+  {
+    namespace Tractography
+    {
+
+
+      //! A memory-mapped random-access reader for streamlines data
+      /*! Unlike Tractography::Reader, which streams the file through buffered
+       * ifstream reads and copies every vertex into a fresh Streamline, this
+       * class maps the track data into memory via File::MMap and exposes each
+       * streamline as a zero-copy view (MappedReader::Track) directly over
+       * the mapped triplets. A single scan over the data on open builds a
+       * table of track boundaries, after which any track can be accessed in
+       * O(1) via operator[] - allowing e.g. deterministic sharding of a file
+       * across worker threads. The boundary table can also be saved as a
+       * sidecar index file (save_index()), which subsequent invocations will
+       * load in preference to re-scanning the data.
+       *
+       * Zero-copy access requires the on-disk datatype to match the in-memory
+       * layout: only Float32 tracks in native byte order (the format written
+       * by this package) are supported; anything else throws, in which case
+       * the streaming Tractography::Reader should be used instead.
+       *
+       * \note streamline weights (-tck_weights_in) are not handled by this
+       * class; each Track is returned with unit weight on conversion. */
+      class MappedReader : public __ReaderBase__
+      { NOMEMALIGN
+        public:
+
+          //! a zero-copy view of a single streamline over the mapped file
+          class Track
+          { NOMEMALIGN
+            public:
+              Track () : points (nullptr), num_points (0), track_index (0) { }
+              Track (const float* points, size_t num_points, uint64_t index) :
+                points (points), num_points (num_points), track_index (index) { }
+
+              size_t size () const { return num_points; }
+              bool empty () const { return !num_points; }
+              uint64_t index () const { return track_index; }
+              //! raw pointer to the first coordinate of the first vertex
+              const float* data () const { return points; }
+
+              Eigen::Map<const Eigen::Vector3f> operator[] (size_t n) const {
+                assert (n < num_points);
+                return Eigen::Map<const Eigen::Vector3f> (points + 3*n);
+              }
+
+              //! copy the vertex data into a regular Streamline
+              template <class ValueType>
+                void copy_to (Streamline<ValueType>& tck) const {
+                  tck.clear();
+                  tck.index = track_index;
+                  tck.weight = 1.0f;
+                  tck.reserve (num_points);
+                  for (size_t n = 0; n < num_points; ++n)
+                    tck.push_back ((*this)[n].template cast<ValueType>());
+                }
+
+            private:
+              const float* points;
+              size_t num_points;
+              uint64_t track_index;
+          };
+
+
+          //! open the \c file and map its track data into memory
+          MappedReader (const std::string& file, Properties& properties) :
+            current (0) {
+              open (file, "tracks", properties);
+              const int64_t data_offset = in.tellg();
+              close();
+
+              DataType native_dtype = DataType::from<float>();
+              native_dtype.set_byte_order_native();
+              if (dtype != native_dtype)
+                throw Exception ("memory-mapped access to tracks file \"" + file + "\" requires "
+                    + native_dtype.specifier() + " data (file is " + dtype.specifier() + "); use Tractography::Reader instead");
+
+              mmap.reset (new File::MMap (File::Entry (file, data_offset)));
+              num_values = 3 * (mmap->size() / ssize_t (3*sizeof(float)));
+
+              if (!load_index (file + ".idx"))
+                scan();
+            }
+
+
+          //! the number of streamlines in the file
+          size_t size () const { return boundaries.size() ? boundaries.size()-1 : 0; }
+
+          //! O(1) random access to the \a n th streamline in the file
+          Track operator[] (size_t n) const {
+            assert (n < size());
+            return { values() + 3*boundaries[n], size_t (boundaries[n+1] - boundaries[n] - 1), n };
+          }
+
+          //! fetch next track; returns false once all tracks have been issued
+          bool operator() (Track& track) {
+            if (current >= size())
+              return false;
+            track = operator[] (current++);
+            return true;
+          }
+
+          //! save the track boundary table as a sidecar index
+          /*! by convention, the index is stored alongside the tracks file,
+           * with the additional suffix ".idx"; it will be picked up
+           * automatically on the next open of the same file. */
+          void save_index (const std::string& path) const {
+            File::OFStream out (path, std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write (MRTRIX_TCK_INDEX_MAGIC, sizeof (MRTRIX_TCK_INDEX_MAGIC));
+            const uint64_t n_values = num_values, n_tracks = size();
+            out.write (reinterpret_cast<const char*> (&n_values), sizeof (uint64_t));
+            out.write (reinterpret_cast<const char*> (&n_tracks), sizeof (uint64_t));
+            out.write (reinterpret_cast<const char*> (boundaries.data()), boundaries.size() * sizeof (uint64_t));
+            if (!out.good())
+              throw Exception ("error writing tracks index file \"" + path + "\": " + strerror (errno));
+          }
+
+
+        protected:
+          std::unique_ptr<File::MMap> mmap;
+          size_t num_values;
+          vector<uint64_t> boundaries;
+          size_t current;
+
+          const float* values () const { return reinterpret_cast<const float*> (mmap->address()); }
+
+          //! single pass over the mapped data to locate the track boundaries
+          /*! boundaries[n] holds the index (in vertices) of the first vertex
+           * of track n; each track is followed by its NaN delimiter triplet,
+           * so track n spans [ boundaries[n], boundaries[n+1]-1 ). */
+          void scan () {
+            const float* const p = values();
+            boundaries.clear();
+            uint64_t start = 0;
+            for (uint64_t n = 0; 3*n < num_values; ++n) {
+              if (std::isinf (p[3*n]))
+                break;
+              if (std::isnan (p[3*n])) {
+                boundaries.push_back (start);
+                start = n+1;
+              }
+            }
+            // final entry is the fencepost: one past the last track's delimiter
+            boundaries.push_back (start);
+          }
+
+          bool load_index (const std::string& path) {
+            if (!Path::exists (path))
+              return false;
+            std::ifstream index (path, std::ios::in | std::ios::binary);
+            if (!index)
+              return false;
+            char file_magic [sizeof (MRTRIX_TCK_INDEX_MAGIC)];
+            uint64_t n_values = 0, n_tracks = 0;
+            index.read (file_magic, sizeof (file_magic));
+            index.read (reinterpret_cast<char*> (&n_values), sizeof (uint64_t));
+            index.read (reinterpret_cast<char*> (&n_tracks), sizeof (uint64_t));
+            if (!index.good() || memcmp (file_magic, MRTRIX_TCK_INDEX_MAGIC, sizeof (file_magic)) || n_values != num_values) {
+              WARN ("tracks index file \"" + path + "\" does not match tracks file; re-scanning data");
+              return false;
+            }
+            boundaries.resize (n_tracks + 1);
+            index.read (reinterpret_cast<char*> (boundaries.data()), boundaries.size() * sizeof (uint64_t));
+            if (!index.good() || boundaries.back() > num_values/3) {
+              WARN ("tracks index file \"" + path + "\" is truncated or corrupt; re-scanning data");
+              boundaries.clear();
+              return false;
+            }
+            return true;
+          }
+
+          MappedReader (const MappedReader&) = delete;
+      };
+
+
+    }
+  }
+}
+
+#endif
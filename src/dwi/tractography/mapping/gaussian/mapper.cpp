@@ -15,6 +15,13 @@
 #include "dwi/tractography/mapping/gaussian/mapper.h"
 
 
+// Kernel support of the along-track Gaussian smoothing, expressed as the
+//   value of (distance^2 / denominator) beyond which contributions are
+//   discarded; exp(-30) ~ 1e-13, so truncating there perturbs the smoothed
+//   factors by no more than double-precision rounding noise
+#define GAUSSIAN_SMOOTH_LOG_CUTOFF 30.0
+
+
 namespace MR {
   namespace DWI {
     namespace Tractography {
@@ -39,41 +46,42 @@ namespace MR {
           void TrackMapper::gaussian_smooth_factors (const Streamline<>& tck) const
           {
 
-            vector<default_type> unsmoothed (factors);
-
-            for (size_t i = 0; i != unsmoothed.size(); ++i) {
-
-              default_type sum = 0.0, norm = 0.0;
-
-              if (std::isfinite (unsmoothed[i])) {
-                sum  = unsmoothed[i];
-                norm = 1.0; // Gaussian is unnormalised -> e^0 = 1
-              }
-
-              default_type distance = 0.0;
-              for (size_t j = i; j--; ) { // Decrement AFTER null test, so loop runs with j = 0
-                distance += (tck[j] - tck[j+1]).norm();
-                if (std::isfinite (unsmoothed[j])) {
-                  const default_type this_weight = exp (-distance * distance / gaussian_denominator);
-                  norm += this_weight;
-                  sum  += this_weight * unsmoothed[j];
-                }
-              }
-              distance = 0.0;
-              for (size_t j = i + 1; j < unsmoothed.size(); ++j) {
-                distance += (tck[j] - tck[j-1]).norm();
-                if (std::isfinite (unsmoothed[j])) {
-                  const default_type this_weight = exp (-distance * distance / gaussian_denominator);
-                  norm += this_weight;
-                  sum  += this_weight * unsmoothed[j];
-                }
-              }
-
-              if (norm)
-                factors[i] = (sum / norm);
-              else
-                factors[i] = 0.0;
+            assert (gaussian_denominator > 0.0);
+            const size_t num_points = factors.size();
+            if (!num_points)
+              return;
+
+            // Cumulative arc length, finite-value mask and masked factor
+            //   values, gathered into contiguous arrays so that the kernel
+            //   evaluation at each point is one vectorised expression rather
+            //   than a scalar exponential per vertex pair
+            Eigen::ArrayXd sumlength (num_points), value (num_points), mask (num_points);
+            sumlength[0] = 0.0;
+            for (size_t i = 1; i != num_points; ++i)
+              sumlength[i] = sumlength[i-1] + (tck[i] - tck[i-1]).norm();
+            for (size_t i = 0; i != num_points; ++i) {
+              const bool finite = std::isfinite (factors[i]);
+              mask[i]  = finite ? 1.0 : 0.0;
+              value[i] = finite ? factors[i] : 0.0;
+            }
 
+            // Each evaluation is further restricted to the arc length range
+            //   within which the kernel weight is non-negligible; both window
+            //   boundaries only ever advance, so finding them is linear in
+            //   track length overall
+            const default_type support = std::sqrt (GAUSSIAN_SMOOTH_LOG_CUTOFF * gaussian_denominator);
+
+            size_t from = 0, to = 0;
+            for (size_t i = 0; i != num_points; ++i) {
+              while (sumlength[i] - sumlength[from] > support)
+                ++from;
+              while (to != num_points && sumlength[to] - sumlength[i] <= support)
+                ++to;
+              const size_t n = to - from;
+              const Eigen::ArrayXd distance = sumlength.segment (from, n) - sumlength[i];
+              const Eigen::ArrayXd weights = (-distance.square() / gaussian_denominator).exp() * mask.segment (from, n);
+              const default_type norm = weights.sum();
+              factors[i] = norm ? ((weights * value.segment (from, n)).sum() / norm) : 0.0;
             }
 
           }
@@ -77,9 +77,10 @@ namespace MR {
         {
           for (size_t i = 0; i != tck.size(); ++i) {
             if (interp.scanner (tck[i])) {
-              // Get the FOD at this (interploated) point
-              for (auto l = Loop (3) (interp); l; ++l) 
-                sh_coeffs[interp.index(3)] = interp.value();
+              // Get the FOD at this (interpolated) point; a single row() call
+              //   computes the spatial weights once and applies them across
+              //   all SH coefficients, rather than re-gathering per volume
+              sh_coeffs = interp.row (3).cast<default_type>();
               // Get the FOD amplitude along the streamline tangent
               const Eigen::Vector3 dir = (tck[(i == tck.size()-1) ? i : (i+1)] - tck[i ? (i-1) : 0]).cast<default_type>().normalized();
               factors.push_back (precomputer->value (sh_coeffs, dir));
@@ -31,6 +31,14 @@
 #include <typeinfo>
 
 
+// Sum-based greyscale statistics are accumulated via a fixed-size
+//   direct-mapped cache of small bricks, so that the scatter writes from
+//   voxelised streamlines land in cache-resident buffers and reach the
+//   full-size image in batches rather than as isolated random accesses
+#define MAP_WRITER_BRICK_SHIFT 2  // 4x4x4 voxel bricks
+#define MAP_WRITER_BRICK_SLOTS 4096
+
+
 namespace MR {
   namespace DWI {
     namespace Tractography {
@@ -144,12 +152,24 @@ namespace MR {
                 H_counts.ndim() = 3;
               counts.reset (new Image<float> (Image<float>::scratch (H_counts, "TWI streamline count buffer")));
             }
+
+            // Brick-buffered accumulation only applies to statistics that sum;
+            //   min / max must observe every update against the current value
+            num_bricks[0] = num_bricks[1] = num_bricks[2] = 0;
+            if (type == GREYSCALE && (voxel_statistic == V_SUM || voxel_statistic == V_MEAN)) {
+              for (size_t axis = 0; axis != 3; ++axis)
+                num_bricks[axis] = (header.size (axis) + (1 << MAP_WRITER_BRICK_SHIFT) - 1) >> MAP_WRITER_BRICK_SHIFT;
+              bricks.resize (MAP_WRITER_BRICK_SLOTS);
+            }
           }
 
           MapWriter (const MapWriter&) = delete;
 
           void finalise () {
 
+            for (auto& brick : bricks)
+              flush_brick (brick);
+
             auto loop = Loop (buffer, 0, 3);
             switch (voxel_statistic) {
 
@@ -247,6 +267,26 @@ namespace MR {
           private:
           Image<value_type> buffer;
 
+          // One slot of the direct-mapped accumulation cache: holds the
+          //   running value and weight sums for a single brick of voxels
+          class Brick
+          { NOMEMALIGN
+            public:
+              Brick () : key (-1) { }
+              ssize_t key; // packed brick coordinates; -1 if the slot is empty
+              default_type values [size_t(1) << (3 * MAP_WRITER_BRICK_SHIFT)];
+              default_type weights[size_t(1) << (3 * MAP_WRITER_BRICK_SHIFT)];
+          };
+
+          vector<Brick> bricks; // empty unless brick buffering is active
+          ssize_t num_bricks[3];
+
+          // Accumulate one voxel update into its brick, evicting any
+          //   previous occupant of the slot
+          template <class Elem> void brick_add (const Elem&, const default_type weight, const default_type factor);
+          // Commit a brick's accumulated sums to the image and mark it empty
+          void flush_brick (Brick&);
+
           // Template functions used so that the functors don't have to be written twice
           //   (once for standard TWI and one for Gaussian track-wise statistic)
           template <class Cont> void receive_greyscale (const Cont&);
@@ -293,7 +333,12 @@ namespace MR {
           void MapWriter<value_type>::receive_greyscale (const Cont& in)
           {
             assert (MapWriterBase::type == GREYSCALE);
-            for (const auto& i : in) { 
+            if (bricks.size()) {
+              for (const auto& i : in)
+                brick_add (i, in.weight * i.get_length(), get_factor (i, in));
+              return;
+            }
+            for (const auto& i : in) {
               assign_pos_of (i).to (buffer);
               const default_type factor = get_factor (i, in);
               const default_type weight = in.weight * i.get_length();
@@ -439,6 +484,55 @@ namespace MR {
 
 
 
+        template <typename value_type>
+          template <class Elem>
+          void MapWriter<value_type>::brick_add (const Elem& i, const default_type weight, const default_type factor)
+          {
+            const ssize_t key = (i[0] >> MAP_WRITER_BRICK_SHIFT)
+                + num_bricks[0] * ((i[1] >> MAP_WRITER_BRICK_SHIFT)
+                + num_bricks[1] *  (i[2] >> MAP_WRITER_BRICK_SHIFT));
+            Brick& brick = bricks[key % bricks.size()];
+            if (brick.key != key) {
+              flush_brick (brick);
+              brick.key = key;
+              for (size_t n = 0; n != (size_t(1) << (3 * MAP_WRITER_BRICK_SHIFT)); ++n)
+                brick.values[n] = brick.weights[n] = 0.0;
+            }
+            constexpr ssize_t mask = (1 << MAP_WRITER_BRICK_SHIFT) - 1;
+            const size_t offset = (i[0] & mask)
+                + ((i[1] & mask) << MAP_WRITER_BRICK_SHIFT)
+                + ((i[2] & mask) << (2 * MAP_WRITER_BRICK_SHIFT));
+            brick.values [offset] += weight * factor;
+            brick.weights[offset] += weight;
+          }
+
+
+
+        template <typename value_type>
+          void MapWriter<value_type>::flush_brick (Brick& brick)
+          {
+            if (brick.key < 0)
+              return;
+            const ssize_t origin[3] = { (brick.key % num_bricks[0]) << MAP_WRITER_BRICK_SHIFT,
+                                        ((brick.key / num_bricks[0]) % num_bricks[1]) << MAP_WRITER_BRICK_SHIFT,
+                                        (brick.key / (num_bricks[0] * num_bricks[1])) << MAP_WRITER_BRICK_SHIFT };
+            for (size_t n = 0; n != (size_t(1) << (3 * MAP_WRITER_BRICK_SHIFT)); ++n) {
+              if (!brick.values[n] && !brick.weights[n])
+                continue;
+              buffer.index(0) = origin[0] + (n & ((1 << MAP_WRITER_BRICK_SHIFT) - 1));
+              buffer.index(1) = origin[1] + ((n >> MAP_WRITER_BRICK_SHIFT) & ((1 << MAP_WRITER_BRICK_SHIFT) - 1));
+              buffer.index(2) = origin[2] + (n >> (2 * MAP_WRITER_BRICK_SHIFT));
+              add (brick.values[n], 1.0);
+              if (counts && voxel_statistic == V_MEAN) {
+                assign_pos_of (buffer, 0, 3).to (*counts);
+                counts->value() += brick.weights[n];
+              }
+            }
+            brick.key = -1;
+          }
+
+
+
         template <>
         inline void MapWriter<bool>::add (const default_type weight, const default_type factor)
         {
@@ -53,6 +53,7 @@ namespace MR {
             return false;
           if (in.size() == 1)
             return true;
+          out.reserve (3 + (in.size() - 2) / ratio);
           out.push_back (in.front());
           const size_t midpoint = in.size()/2;
           size_t index = (((midpoint - 1) % ratio) + 1);
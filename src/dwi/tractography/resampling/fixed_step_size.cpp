@@ -30,11 +30,14 @@ namespace MR {
           out.index = in.index;
           out.weight = in.weight;
           Math::Hermite<value_type> interp (hermite_tension);
-          // Extensions required to enable Hermite interpolation in last streamline segment at either end
-          Streamline<> temp (in);
-          const size_t s = temp.size();
-          temp.insert    (temp.begin(), temp[0] + (temp[0] - temp[ 1 ]));
-          temp.push_back (              temp[s] + (temp[s] - temp[s-1]));
+          // Extensions required to enable Hermite interpolation in last streamline segment at either end;
+          //   assembled in a single allocation rather than front-inserting into a copy of the whole track
+          const size_t s = in.size();
+          Streamline<> temp;
+          temp.reserve (s + 2);
+          temp.push_back (in[0] + (in[0] - in[1]));
+          temp.insert (temp.end(), in.begin(), in.end());
+          temp.push_back (in[s-1] + (in[s-1] - in[s-2]));
           const ssize_t midpoint = temp.size()/2;
           out.push_back (temp[midpoint]);
           // Generate from the midpoint to the start, reverse, then generate from midpoint to the end
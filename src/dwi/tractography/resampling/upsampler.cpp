@@ -34,16 +34,23 @@ namespace MR {
           out.clear();
           out.index = in.index;
           out.weight = in.weight;
-          Streamline<> in_padded (in);
-          interp_prepare (in_padded);
-          for (size_t i = 3; i < in_padded.size(); ++i) {
-            out.push_back (in_padded[i-2]);
-            increment (in_padded[i]);
+          // the output size is known exactly: each input segment yields its
+          //   leading vertex plus (ratio-1) interpolated vertices, with the
+          //   final vertex appended at the end
+          out.reserve ((in.size() - 1) * get_ratio() + 1);
+          // the ends of the track are extended virtually via the sliding
+          //   window in "data", rather than by shifting a padded copy of the
+          //   entire input
+          interp_prepare (in);
+          const size_t last = in.size() - 1;
+          for (size_t i = 0; i != last; ++i) {
+            out.push_back (in[i]);
+            increment (i+2 <= last ? in[i+2] : point_type (in[last] + (in[last] - in[last-1])));
             temp = M * data;
             for (ssize_t row = 0; row != temp.rows(); ++row)
               out.push_back (Eigen::Vector3f (temp.row (row)));
           }
-          out.push_back (in_padded[in_padded.size() - 2]);
+          out.push_back (in[last]);
           return true;
         }
 
@@ -69,19 +76,17 @@ namespace MR {
 
 
 
-        void Upsampler::interp_prepare (Streamline<>& in) const
+        void Upsampler::interp_prepare (const Streamline<>& in) const
         {
           assert (in.size() >= 2);
           // Abandoned curvature-based extrapolation - badly posed when step size is not guaranteed to be consistent,
           //   and probably makes little difference anyways
-          const size_t s = in.size();
-          in.insert    (in.begin(), in[0] + (in[0] - in[ 1 ]));
-          in.push_back (            in[s] + (in[s] - in[s-1]));
+          const point_type start_pad (in[0] + (in[0] - in[1]));
           for (size_t i = 0; i != 3; ++i) {
             data(0,i) = 0.0;
-            data(1,i) = (in[0])[i];
-            data(2,i) = (in[1])[i];
-            data(3,i) = (in[2])[i];
+            data(1,i) = start_pad[i];
+            data(2,i) = (in[0])[i];
+            data(3,i) = (in[1])[i];
           }
         }
 
@@ -56,7 +56,7 @@ namespace MR {
             Eigen::MatrixXf M;
             mutable Eigen::MatrixXf temp, data;
 
-            void interp_prepare (Streamline<>&) const;
+            void interp_prepare (const Streamline<>&) const;
             void increment (const point_type&) const;
 
         };
@@ -110,6 +110,75 @@ namespace MR {
       }
 
 
+
+
+      bool ROISet::merge (const size_t index)
+      {
+        const auto& mask = R[index].get_mask();
+        if (!mask || grid_rois.size() == 8 * sizeof (uint32_t))
+          return false;
+
+        ssize_t shift[3] = { 0, 0, 0 };
+        if (grid_rois.empty()) {
+
+          // First mask ROI defines the reference grid
+          grid_s2v.reset (new Mask::transform_type (*mask->scanner2voxel));
+          for (size_t axis = 0; axis != 3; ++axis)
+            grid_dim[axis] = mask->size (axis);
+          grid.assign (grid_dim[0] * grid_dim[1] * grid_dim[2], 0);
+
+        } else {
+
+          // The mapping from candidate mask voxels to grid voxels must be a
+          //   pure integer-voxel translation (this is what loading two masks
+          //   drawn on the same template produces, since each is cropped to
+          //   its own bounding box)
+          const Mask::transform_type M (*grid_s2v * *mask->voxel2scanner);
+          if ((M.linear() - Eigen::Matrix3f::Identity()).cwiseAbs().maxCoeff() > 1e-4f)
+            return false;
+          for (size_t axis = 0; axis != 3; ++axis) {
+            shift[axis] = std::round (M.translation()[axis]);
+            if (std::abs (M.translation()[axis] - shift[axis]) > 1e-4f)
+              return false;
+          }
+
+          // Grow the grid to cover the union of the two bounding boxes
+          ssize_t lower[3], upper[3];
+          bool resize = false;
+          for (size_t axis = 0; axis != 3; ++axis) {
+            lower[axis] = std::min (ssize_t(0), shift[axis]);
+            upper[axis] = std::max (grid_dim[axis], shift[axis] + ssize_t (mask->size (axis)));
+            if (lower[axis] || upper[axis] != grid_dim[axis])
+              resize = true;
+          }
+          if (resize) {
+            const ssize_t new_dim[3] = { upper[0]-lower[0], upper[1]-lower[1], upper[2]-lower[2] };
+            vector<uint32_t> new_grid (new_dim[0] * new_dim[1] * new_dim[2], 0);
+            for (ssize_t z = 0; z != grid_dim[2]; ++z)
+              for (ssize_t y = 0; y != grid_dim[1]; ++y)
+                for (ssize_t x = 0; x != grid_dim[0]; ++x)
+                  new_grid[(x-lower[0]) + new_dim[0] * ((y-lower[1]) + new_dim[1] * (z-lower[2]))] = grid[x + grid_dim[0] * (y + grid_dim[1] * z)];
+            grid.swap (new_grid);
+            grid_s2v.reset (new Mask::transform_type (Eigen::Translation3f (-lower[0], -lower[1], -lower[2]) * *grid_s2v));
+            for (size_t axis = 0; axis != 3; ++axis) {
+              shift[axis] -= lower[axis];
+              grid_dim[axis] = new_dim[axis];
+            }
+          }
+
+        }
+
+        const uint32_t bit = uint32_t(1) << grid_rois.size();
+        Mask image (*mask);
+        for (auto l = Loop (0,3) (image); l; ++l) {
+          if (image.value())
+            grid[(image.index(0)+shift[0]) + grid_dim[0] * ((image.index(1)+shift[1]) + grid_dim[1] * (image.index(2)+shift[2]))] |= bit;
+        }
+        grid_rois.push_back (index);
+        return true;
+      }
+
+
     }
   }
 }
@@ -107,6 +107,8 @@ namespace MR
             return stream;
           }
 
+          const std::shared_ptr<Mask>& get_mask () const { return mask; }
+
 
 
         private:
@@ -122,22 +124,33 @@ namespace MR
 
       class ROISet { MEMALIGN(ROISet)
         public:
-          ROISet () { }
+          ROISet () : grid_dim { 0, 0, 0 } { }
 
-          void clear () { R.clear(); }
+          void clear () { R.clear(); grid.clear(); grid_rois.clear(); slow_rois.clear(); grid_s2v.reset(); grid_dim[0] = grid_dim[1] = grid_dim[2] = 0; }
           size_t size () const { return (R.size()); }
           const ROI& operator[] (size_t i) const { return (R[i]); }
-          void add (const ROI& roi) { R.push_back (roi); }
+          void add (const ROI& roi) {
+            R.push_back (roi);
+            if (!merge (R.size()-1))
+              slow_rois.push_back (R.size()-1);
+          }
 
           bool contains (const Eigen::Vector3f& p) const {
-            for (size_t n = 0; n < R.size(); ++n)
-              if (R[n].contains (p)) return (true);
+            if (grid.size() && lookup (p))
+              return true;
+            for (size_t n = 0; n < slow_rois.size(); ++n)
+              if (R[slow_rois[n]].contains (p)) return (true);
             return false;
           }
 
           void contains (const Eigen::Vector3f& p, vector<bool>& retval) const {
-            for (size_t n = 0; n < R.size(); ++n)
-              if (R[n].contains (p)) retval[n] = true;
+            if (grid.size()) {
+              const uint32_t word = lookup (p);
+              for (size_t b = 0; b != grid_rois.size(); ++b)
+                if (word & (uint32_t(1) << b)) retval[grid_rois[b]] = true;
+            }
+            for (size_t n = 0; n < slow_rois.size(); ++n)
+              if (R[slow_rois[n]].contains (p)) retval[slow_rois[n]] = true;
           }
 
           friend inline std::ostream& operator<< (std::ostream& stream, const ROISet& R) {
@@ -151,6 +164,32 @@ namespace MR
 
         private:
           vector<ROI> R;
+
+          /* Combined occupancy grid for mask-image ROIs: one pass at setup
+           * merges all masks that lie on integer-voxel translations of a
+           * common voxel grid (i.e. masks drawn on the same template, however
+           * they may have been cropped on loading) into a packed per-voxel
+           * bitfield, so that a single voxel lookup per streamline point
+           * resolves membership of all such ROIs simultaneously. Spherical
+           * ROIs, and masks defined on an incompatible grid, retain the
+           * per-ROI test. */
+          std::shared_ptr<Mask::transform_type> grid_s2v;
+          ssize_t grid_dim[3];
+          vector<uint32_t> grid;
+          vector<size_t> grid_rois, slow_rois;
+
+          //! merge ROI \a index into the occupancy grid; false if it cannot be represented there
+          bool merge (const size_t index);
+
+          uint32_t lookup (const Eigen::Vector3f& p) const {
+            const Eigen::Vector3f v = *grid_s2v * p;
+            const ssize_t x = std::round (v[0]);
+            const ssize_t y = std::round (v[1]);
+            const ssize_t z = std::round (v[2]);
+            if (x < 0 || x >= grid_dim[0] || y < 0 || y >= grid_dim[1] || z < 0 || z >= grid_dim[2])
+              return 0;
+            return grid[x + grid_dim[0] * (y + grid_dim[1] * z)];
+          }
       };
 
 
@@ -15,6 +15,7 @@
 #ifndef __dwi_tractography_scalar_file_h__
 #define __dwi_tractography_scalar_file_h__
 
+#include <cstring>
 #include <map>
 
 #include "types.h"
@@ -63,14 +64,33 @@ namespace MR
 
 
 
+      //! class to handle reading track scalars from file
+      /*! This class implements a large read-ahead RAM buffer: the file is
+       * read in large blocks, with individual scalars decoded from that
+       * buffer. This minimises the number of read() calls, which would
+       * otherwise dominate runtime on large track scalar files. The size of
+       * the read-ahead buffer defaults to 16MB, and can be set in the config
+       * file using the TrackReaderBufferSize field (in bytes).
+       * */
       template <typename T = float> class ScalarReader : public __ReaderBase__
       { NOMEMALIGN
         public:
           using value_type = T;
 
-          ScalarReader (const std::string& file, Properties& properties) {
-            open (file, "track scalars", properties);
-          }
+          //CONF option: TrackReaderBufferSize
+          //CONF default: 16777216
+          //CONF The size of the read-ahead buffer (in bytes) to use when
+          //CONF reading track scalar files. MRtrix will read data from disk
+          //CONF in blocks of this size, and decode individual values from
+          //CONF that buffer, rather than issuing a read() call per value.
+
+          ScalarReader (const std::string& file, Properties& properties) :
+            buffer_capacity (File::Config::get_int ("TrackReaderBufferSize", 16777216)),
+            buffer (new uint8_t [buffer_capacity]),
+            buffer_size (0),
+            buffer_pos (0) {
+              open (file, "track scalars", properties);
+            }
 
           bool operator() (vector<value_type>& tck_scalar)
           {
@@ -78,21 +98,17 @@ namespace MR
 
             if (!in.is_open())
               return false;
-            do {
-              value_type val = get_next_scalar();
+
+            value_type val;
+            while (get_next_scalar (val)) {
               if (std::isinf (val)) {
                 in.close();
                 return false;
               }
-              if (in.eof()) {
-                in.close();
-                return false;
-              }
-
               if (std::isnan (val))
                 return true;
               tck_scalar.push_back (val);
-            } while (in.good());
+            }
 
             in.close();
             return false;
@@ -102,39 +118,77 @@ namespace MR
           using __ReaderBase__::in;
           using __ReaderBase__::dtype;
 
-          value_type get_next_scalar ()
+          const size_t buffer_capacity;
+          std::unique_ptr<uint8_t[]> buffer;
+          size_t buffer_size, buffer_pos;
+
+          //! refill the read-ahead buffer, preserving any partial trailing value
+          /*! returns false if no further data could be obtained. */
+          bool refill ()
+          {
+            const size_t remainder = buffer_size - buffer_pos;
+            if (remainder)
+              std::memmove (buffer.get(), buffer.get() + buffer_pos, remainder);
+            buffer_pos = 0;
+            buffer_size = remainder;
+            if (in.good()) {
+              in.read (reinterpret_cast<char*> (buffer.get()) + remainder, buffer_capacity - remainder);
+              buffer_size += in.gcount();
+            }
+            return buffer_size > remainder;
+          }
+
+          //! decode the next raw value from the buffer, refilling as required
+          template <typename X>
+          bool fetch (X& val)
+          {
+            if (buffer_pos + sizeof (X) > buffer_size) {
+              refill();
+              if (buffer_pos + sizeof (X) > buffer_size)
+                return false;
+            }
+            std::memcpy (&val, buffer.get() + buffer_pos, sizeof (X));
+            buffer_pos += sizeof (X);
+            return true;
+          }
+
+          bool get_next_scalar (value_type& val)
           {
             using namespace ByteOrder;
             switch (dtype()) {
               case DataType::Float32LE:
               {
-                float val;
-                in.read ((char*) &val, sizeof (val));
-                return (value_type (LE(val)));
+                float x;
+                if (!fetch (x)) return false;
+                val = value_type (LE(x));
+                return true;
               }
               case DataType::Float32BE:
               {
-                float val;
-                in.read ((char*) &val, sizeof (val));
-                return (value_type (BE(val)));
+                float x;
+                if (!fetch (x)) return false;
+                val = value_type (BE(x));
+                return true;
               }
               case DataType::Float64LE:
               {
-                double val;
-                in.read ((char*) &val, sizeof (val));
-                return (value_type (LE(val)));
+                double x;
+                if (!fetch (x)) return false;
+                val = value_type (LE(x));
+                return true;
               }
               case DataType::Float64BE:
               {
-                double val;
-                in.read ((char*) &val, sizeof (val));
-                return (value_type (BE(val)));
+                double x;
+                if (!fetch (x)) return false;
+                val = value_type (BE(x));
+                return true;
               }
               default:
                 assert (0);
                 break;
             }
-            return (value_type (NAN));
+            return false;
           }
 
           ScalarReader (const ScalarReader&) = delete;
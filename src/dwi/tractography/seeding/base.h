@@ -114,6 +114,16 @@ namespace MR
           virtual bool get_seed (Eigen::Vector3f&) const = 0;
           virtual bool get_seed (Eigen::Vector3f& p, Eigen::Vector3f&) { return get_seed (p); }
 
+          //! whether seed draws can be keyed by a global seed index
+          /*! seeders returning true must implement the index-keyed get_seed()
+           * overload below such that the seed produced is a pure function of
+           * \a index, allowing the seed stream to be partitioned
+           * deterministically and without overlap across independent
+           * processes (see List::set_shard()). */
+          virtual bool is_shardable() const { return false; }
+          //! index-keyed variant of get_seed(); see is_shardable()
+          virtual bool get_seed (Eigen::Vector3f& p, Eigen::Vector3f& d, const uint64_t) { return get_seed (p, d); }
+
           friend inline std::ostream& operator<< (std::ostream& stream, const Base& B) {
             stream << B.name;
             return (stream);
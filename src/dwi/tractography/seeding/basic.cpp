@@ -39,6 +39,19 @@ namespace MR
 
 
 
+        bool Sphere::get_seed (Eigen::Vector3f& p, Eigen::Vector3f&, const uint64_t index)
+        {
+          Math::PhiloxRNG prng (index);
+          std::uniform_real_distribution<float> uniform;
+          do {
+            p = { 2.0f*uniform(prng)-1.0f, 2.0f*uniform(prng)-1.0f, 2.0f*uniform(prng)-1.0f };
+          } while (p.squaredNorm() > 1.0f);
+          p = pos + rad*p;
+          return true;
+        }
+
+
+
 
 
         bool SeedMask::get_seed (Eigen::Vector3f& p) const
@@ -57,6 +70,23 @@ namespace MR
 
 
 
+        bool SeedMask::get_seed (Eigen::Vector3f& p, Eigen::Vector3f&, const uint64_t index)
+        {
+          Math::PhiloxRNG prng (index);
+          auto seed = mask;
+          do {
+            seed.index(0) = std::uniform_int_distribution<int>(0, mask.size(0)-1)(prng);
+            seed.index(1) = std::uniform_int_distribution<int>(0, mask.size(1)-1)(prng);
+            seed.index(2) = std::uniform_int_distribution<int>(0, mask.size(2)-1)(prng);
+          } while (!seed.value());
+          std::uniform_real_distribution<float> uniform;
+          p = { seed.index(0)+uniform(prng)-0.5f, seed.index(1)+uniform(prng)-0.5f, seed.index(2)+uniform(prng)-0.5f };
+          p = (*mask.voxel2scanner) * p;
+          return true;
+        }
+
+
+
 
 
 
@@ -192,6 +222,51 @@ namespace MR
 #else
           image = buf;
           voxel2scanner = Transform (image).voxel2scanner.cast<float>();
+
+          // Build a Walker alias table over the non-zero voxels, so that each
+          //   seed draw costs O(1) regardless of how small a fraction of the
+          //   image the seed region occupies; with rejection sampling, sparse
+          //   seed images would otherwise discard the vast majority of trials
+          vector<float> values;
+          double sum = 0.0;
+          for (auto i = Loop (0,3) (image); i; ++i) {
+            const float value = image.value();
+            if (value > 0.0f) {
+              voxels.push_back (uint32_t (image.index(0) + image.size(0) * (image.index(1) + image.size(1) * image.index(2))));
+              values.push_back (value);
+              sum += value;
+            }
+          }
+          const size_t num = voxels.size();
+          assert (num);
+          alias.resize (num);
+          cutoff.resize (num);
+          vector<double> scaled (num);
+          for (size_t n = 0; n != num; ++n)
+            scaled[n] = values[n] * num / sum;
+          vector<uint32_t> small, large;
+          for (uint32_t n = 0; n != num; ++n)
+            (scaled[n] < 1.0 ? small : large).push_back (n);
+          while (small.size() && large.size()) {
+            const uint32_t s = small.back(); small.pop_back();
+            const uint32_t l = large.back(); large.pop_back();
+            cutoff[s] = scaled[s];
+            alias[s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            (scaled[l] < 1.0 ? small : large).push_back (l);
+          }
+          // any slots left over at this point have probability 1.0 up to
+          //   floating-point round-off; they never defer to their alias
+          while (large.size()) {
+            cutoff[large.back()] = 1.0f;
+            alias[large.back()] = large.back();
+            large.pop_back();
+          }
+          while (small.size()) {
+            cutoff[small.back()] = 1.0f;
+            alias[small.back()] = small.back();
+            small.pop_back();
+          }
 #endif
         }
 
@@ -215,15 +290,44 @@ namespace MR
           } while (seed.value() < selector);
           p = interp.voxel2scanner * pos;
 #else
-          auto seed = image;
+          const size_t slot = std::uniform_int_distribution<size_t> (0, voxels.size()-1) (*rng);
+          const uint32_t voxel = (uniform (*rng) < cutoff[slot]) ? voxels[slot] : voxels[alias[slot]];
+          const uint32_t x = voxel % uint32_t (image.size(0));
+          const uint32_t y = (voxel / uint32_t (image.size(0))) % uint32_t (image.size(1));
+          const uint32_t z = voxel / uint32_t (image.size(0) * image.size(1));
+          p = { x+uniform(*rng)-0.5f, y+uniform(*rng)-0.5f, z+uniform(*rng)-0.5f };
+          p = voxel2scanner * p;
+#endif
+          return true;
+        }
+
+
+
+        bool Rejection::get_seed (Eigen::Vector3f& p, Eigen::Vector3f&, const uint64_t index)
+        {
+          Math::PhiloxRNG prng (index);
+          std::uniform_real_distribution<float> uniform;
+#ifdef REJECTION_SAMPLING_USE_INTERPOLATION
+          auto seed = interp;
           float selector;
+          Eigen::Vector3f pos;
           do {
-            seed.index(0) = std::uniform_int_distribution<int> (0, image.size(0)-1) (*rng);
-            seed.index(1) = std::uniform_int_distribution<int> (0, image.size(1)-1) (*rng);
-            seed.index(2) = std::uniform_int_distribution<int> (0, image.size(2)-1) (*rng);
-            selector = uniform (*rng) * max;
+            pos = {
+              uniform (prng) * (interp.size(0)-1),
+              uniform (prng) * (interp.size(1)-1),
+              uniform (prng) * (interp.size(2)-1)
+            };
+            seed.voxel (pos);
+            selector = uniform (prng) * max;
           } while (seed.value() < selector);
-          p = { seed.index(0)+uniform(*rng)-0.5f, seed.index(1)+uniform(*rng)-0.5f, seed.index(2)+uniform(*rng)-0.5f };
+          p = interp.voxel2scanner * pos;
+#else
+          const size_t slot = std::uniform_int_distribution<size_t> (0, voxels.size()-1) (prng);
+          const uint32_t voxel = (uniform (prng) < cutoff[slot]) ? voxels[slot] : voxels[alias[slot]];
+          const uint32_t x = voxel % uint32_t (image.size(0));
+          const uint32_t y = (voxel / uint32_t (image.size(0))) % uint32_t (image.size(1));
+          const uint32_t z = voxel / uint32_t (image.size(0) * image.size(1));
+          p = { x+uniform(prng)-0.5f, y+uniform(prng)-0.5f, z+uniform(prng)-0.5f };
           p = voxel2scanner * p;
 #endif
           return true;
@@ -52,6 +52,8 @@ namespace MR
               }
 
             virtual bool get_seed (Eigen::Vector3f& p) const override;
+            virtual bool is_shardable() const override { return true; }
+            virtual bool get_seed (Eigen::Vector3f& p, Eigen::Vector3f& d, const uint64_t index) override;
 
           private:
             Eigen::Vector3f pos;
@@ -71,6 +73,8 @@ namespace MR
               }
 
             virtual bool get_seed (Eigen::Vector3f& p) const override;
+            virtual bool is_shardable() const override { return true; }
+            virtual bool get_seed (Eigen::Vector3f& p, Eigen::Vector3f& d, const uint64_t index) override;
 
           private:
             Mask mask;
@@ -144,6 +148,8 @@ namespace MR
 
 
             virtual bool get_seed (Eigen::Vector3f& p) const override;
+            virtual bool is_shardable() const override { return true; }
+            virtual bool get_seed (Eigen::Vector3f& p, Eigen::Vector3f& d, const uint64_t index) override;
 
           private:
 #ifdef REJECTION_SAMPLING_USE_INTERPOLATION
@@ -151,6 +157,14 @@ namespace MR
 #else
             Image<float> image;
             transform_type voxel2scanner;
+            // Walker alias table over the non-zero voxels, built once at
+            //   construction, so that drawing a seed voxel proportional to
+            //   image intensity is O(1) regardless of how sparse the seed
+            //   image is: select a slot uniformly, then either that slot's
+            //   voxel or its alias depending on the slot's cutoff
+            vector<uint32_t> voxels;
+            vector<uint32_t> alias;
+            vector<float> cutoff;
 #endif
             float max;
 
@@ -70,6 +70,7 @@ namespace MR
           track_count (0),
           attempts (0),
           seeds (0),
+          current_mu (0.0),
 #ifdef DYNAMIC_SEED_DEBUGGING
           seed_output ("seeds.tck", Tractography::Properties()),
           test_fixel (0),
@@ -89,6 +90,7 @@ namespace MR
 
         // Prevent divide-by-zero at commencement
         SIFT::ModelBase<Fixel_TD_seed>::TD_sum = DYNAMIC_SEED_INITIAL_TD_SUM;
+        current_mu.store (mu(), std::memory_order_relaxed);
 
         // For small / unreliable fixels, don't modify the seeding probability during execution
         perform_fixel_masking();
@@ -183,7 +185,9 @@ namespace MR
 
             // Derive the new seed probability
             // TODO Functionalise this?
-            const float ratio = fixel.get_ratio (mu());
+            // Read the snapshot of mu() rather than calling it directly:
+            //   TD_sum is being modified concurrently by the track receiver thread
+            const float ratio = fixel.get_ratio (current_mu.load (std::memory_order_relaxed));
             const bool force_seed = !fixel.get_TD();
             const size_t current_trackcount = track_count.load (std::memory_order_relaxed);
             const float cumulative_prob = fixel.get_cumulative_prob (current_trackcount);
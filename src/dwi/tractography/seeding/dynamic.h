@@ -15,9 +15,11 @@
 #ifndef __dwi_tractography_seeding_dynamic_h__
 #define __dwi_tractography_seeding_dynamic_h__
 
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <queue>
-#include <atomic>
 
 #include "transform.h"
 #include "thread_queue.h"
@@ -78,36 +80,27 @@ namespace MR
             voxel (-1, -1, -1),
             TD (SIFT::FixelBase::TD),
             update (true),
-            old_prob (DYNAMIC_SEED_INITIAL_PROB),
-            applied_prob (old_prob),
-            track_count_at_last_update (0),
-            seed_count (0) {
-              updating.clear();
-            }
+            cumulative (pack (DYNAMIC_SEED_INITIAL_PROB, 0)),
+            applied_prob (DYNAMIC_SEED_INITIAL_PROB),
+            seed_count (0) { }
 
           Fixel_TD_seed (const Fixel_TD_seed& that) :
             SIFT::FixelBase (that),
             voxel (that.voxel),
             TD (double(that.TD)),
             update (that.update),
-            old_prob (that.old_prob),
-            applied_prob (that.applied_prob),
-            track_count_at_last_update (that.track_count_at_last_update),
-            seed_count (that.seed_count) { 
-              updating.clear();
-            }
+            cumulative (that.cumulative.load (std::memory_order_relaxed)),
+            applied_prob (that.applied_prob.load (std::memory_order_relaxed)),
+            seed_count (that.seed_count.load (std::memory_order_relaxed)) { }
 
           Fixel_TD_seed() :
             SIFT::FixelBase (),
             voxel (-1, -1, -1),
             TD (0.0),
             update (true),
-            old_prob (DYNAMIC_SEED_INITIAL_PROB),
-            applied_prob (old_prob),
-            track_count_at_last_update (0),
-            seed_count (0) { 
-              updating.clear();
-            }
+            cumulative (pack (DYNAMIC_SEED_INITIAL_PROB, 0)),
+            applied_prob (DYNAMIC_SEED_INITIAL_PROB),
+            seed_count (0) { }
 
 
           double         get_TD     ()                    const { return TD.load (std::memory_order_relaxed); }
@@ -140,28 +133,30 @@ namespace MR
 
           float get_cumulative_prob (const uint64_t track_count)
           {
-            while (updating.test_and_set (std::memory_order_acquire));
-            float cumulative_prob = old_prob;
-            if (track_count > track_count_at_last_update) {
-              cumulative_prob = ((track_count_at_last_update * old_prob) + ((track_count - track_count_at_last_update) * applied_prob)) / float(track_count);
-              old_prob = cumulative_prob;
-              track_count_at_last_update = track_count;
+            uint64_t expected = cumulative.load (std::memory_order_acquire);
+            while (true) {
+              const float    old_prob = unpack_prob  (expected);
+              const uint64_t count    = unpack_count (expected);
+              if (track_count <= count)
+                return old_prob;
+              const float cumulative_prob = ((count * old_prob) + ((track_count - count) * applied_prob.load (std::memory_order_relaxed))) / float(track_count);
+              if (cumulative.compare_exchange_weak (expected, pack (cumulative_prob, track_count),
+                    std::memory_order_acq_rel, std::memory_order_acquire))
+                return cumulative_prob;
             }
-            return cumulative_prob;
           }
 
           void update_prob (const float new_prob, const bool seed_drawn)
           {
-            applied_prob = new_prob;
+            applied_prob.store (new_prob, std::memory_order_release);
             if (seed_drawn)
-              ++seed_count;
-            updating.clear (std::memory_order_release);
+              seed_count.fetch_add (1, std::memory_order_relaxed);
           }
 
 
-          float get_old_prob()   const { return old_prob; }
-          float get_prob()       const { return applied_prob; }
-          size_t get_seed_count() const { return seed_count; }
+          float get_old_prob()   const { return unpack_prob (cumulative.load (std::memory_order_relaxed)); }
+          float get_prob()       const { return applied_prob.load (std::memory_order_relaxed); }
+          size_t get_seed_count() const { return seed_count.load (std::memory_order_relaxed); }
 
 
 
@@ -170,11 +165,30 @@ namespace MR
           std::atomic<double> TD; // Protect against concurrent reads & writes, though perfect thread concurrency is not necessary
           bool update; // For small / noisy fixels, exclude the seeding probability from being updated
 
-          // Multiple values to update - use an atomic boolean in a similar manner to a mutex, but with less overhead
-          std::atomic_flag updating;
-          float old_prob, applied_prob;
-          size_t track_count_at_last_update;
-          size_t seed_count;
+          /* Seeding statistics, kept lock-free so that seed drawing scales
+           * with thread count: the cumulative probability and the track count
+           * at which it was last updated must change together, so they are
+           * packed into a single 64-bit atomic and advanced by
+           * compare-and-swap; as for TD above, perfect inter-thread
+           * consistency of the remaining statistics is not necessary. */
+          std::atomic<uint64_t> cumulative;
+          std::atomic<float> applied_prob;
+          std::atomic<size_t> seed_count;
+
+          static uint64_t pack (const float prob, const uint64_t count)
+          {
+            uint32_t bits;
+            std::memcpy (&bits, &prob, sizeof (bits));
+            return (uint64_t(bits) << 32) | std::min (count, uint64_t (std::numeric_limits<uint32_t>::max()));
+          }
+          static float unpack_prob (const uint64_t value)
+          {
+            const uint32_t bits = value >> 32;
+            float prob;
+            std::memcpy (&prob, &bits, sizeof (prob));
+            return prob;
+          }
+          static uint64_t unpack_count (const uint64_t value) { return value & 0xFFFFFFFFu; }
 
       };
 
@@ -242,7 +256,12 @@ namespace MR
               return false;
 #endif
           }
-          return SIFT::ModelBase<Fixel_TD_seed>::operator() (i);
+          const bool retval = SIFT::ModelBase<Fixel_TD_seed>::operator() (i);
+          // Publish the updated proportionality coefficient for the seeding
+          //   threads: they must not read ModelBase::TD_sum directly, as it is
+          //   being modified concurrently by this function
+          current_mu.store (mu(), std::memory_order_release);
+          return retval;
         }
 
 
@@ -260,6 +279,10 @@ namespace MR
         // Want to know statistics on dynamic seeding sampling
         std::atomic<uint64_t> attempts, seeds;
 
+        // Snapshot of mu() for use by the seeding threads, updated whenever a
+        //   track is added to the model
+        std::atomic<default_type> current_mu;
+
 
 #ifdef DYNAMIC_SEED_DEBUGGING
         Tractography::Writer<float> seed_output;
@@ -51,6 +51,25 @@ namespace MR
           seeders.clear();
           total_volume = 0.0;
           total_count = 0.0;
+          shard_index = 0;
+          shard_count = 1;
+          shard_progress = 0;
+        }
+
+
+
+        void List::set_shard (const uint64_t index, const uint64_t count)
+        {
+          assert (count > 1);
+          assert (index < count);
+          if (is_finite())
+            throw Exception ("deterministic sharding is not supported with count-limited seed mechanisms: "
+                "these enumerate a fixed sequence of seeds rather than drawing an indexable random stream");
+          for (const auto& i : seeders)
+            if (!i->is_shardable())
+              throw Exception ("seed mechanism \"" + i->get_name() + "\" (" + i->get_type() + ") does not support deterministic sharding");
+          shard_index = index;
+          shard_count = count;
         }
 
 
@@ -59,6 +78,27 @@ namespace MR
         {
           std::uniform_real_distribution<float> uniform;
 
+          if (shard_count > 1) {
+
+            // global seed indices are assigned to this shard in strides of
+            // shard_count, so shards are disjoint by construction
+            const uint64_t index = shard_index + shard_count * shard_progress.fetch_add (1);
+            if (seeders.size() == 1)
+              return seeders.front()->get_seed (p, d, index);
+
+            // the seeder selection draws from the complement stream, so that
+            // it cannot collide with the seeder's own index-keyed draws
+            Math::PhiloxRNG prng (~index);
+            do {
+              float incrementer = 0.0;
+              const float sample = uniform (prng) * total_volume;
+              for (auto& i : seeders)
+                if ((incrementer += i->vol()) > sample)
+                  return i->get_seed (p, d, index);
+            } while (1);
+
+          }
+
           if (is_finite()) {
 
             for (auto& i : seeders)
@@ -16,6 +16,8 @@
 #define __dwi_tractography_seeding_list_h__
 
 
+#include <atomic>
+
 #include "types.h"
 
 #include "dwi/tractography/seeding/base.h"
@@ -39,7 +41,10 @@ namespace MR
         public:
           List() :
             total_volume (0.0),
-            total_count (0) { }
+            total_count (0),
+            shard_index (0),
+            shard_count (1),
+            shard_progress (0) { }
 
           List (const List&) = delete;
 
@@ -48,6 +53,16 @@ namespace MR
           void clear();
           bool get_seed (Eigen::Vector3f& p, Eigen::Vector3f& d);
 
+          //! restrict seeding to shard \a index of \a count
+          /*! the global seed stream is keyed by seed index using a
+           * counter-based RNG; this process then generates only the seeds
+           * whose index is congruent to \a index modulo \a count, so shards
+           * are reproducible and non-overlapping by construction. Only
+           * supported when all seed mechanisms are shardable (see
+           * Base::is_shardable()); throws otherwise. */
+          void set_shard (const uint64_t index, const uint64_t count);
+          bool is_sharded() const { return shard_count > 1; }
+
 
           size_t num_seeds() const { return seeders.size(); }
           const Base* operator[] (const size_t n) const { return seeders[n].get(); }
@@ -70,6 +85,8 @@ namespace MR
           vector<std::unique_ptr<Base>> seeders;
           float total_volume;
           uint32_t total_count;
+          uint64_t shard_index, shard_count;
+          std::atomic<uint64_t> shard_progress;
 
       };
 
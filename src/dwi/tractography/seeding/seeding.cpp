@@ -102,7 +102,17 @@ namespace MR
         + Argument ("dir").type_sequence_float()
 
       + Option ("output_seeds", "output the seed location of all successful streamlines to a file")
-        + Argument ("path").type_file_out();
+        + Argument ("path").type_file_out()
+
+      + Option ("shard", "process only one shard of a deterministically partitioned seed stream. "
+                         "The argument takes the form i/N (with 0 <= i < N): seed draws are keyed "
+                         "by their global seed index using a counter-based RNG, and this invocation "
+                         "generates only the seeds whose index is congruent to i modulo N. Shards "
+                         "produced with identical seeding options are therefore reproducible and "
+                         "non-overlapping regardless of thread count, and their output files can "
+                         "simply be concatenated. Only applicable to random (non-count-limited) "
+                         "seed mechanisms; any -seeds / -select limits apply per shard.")
+        + Argument ("spec").type_text();
 
 
 
@@ -187,6 +197,27 @@ namespace MR
 
         opt = get_options ("output_seeds");
         if (opt.size()) properties["seed_output"] = std::string (opt[0][0]);
+
+        opt = get_options ("shard");
+        if (opt.size()) {
+          const std::string spec (opt[0][0]);
+          const size_t slash = spec.find ('/');
+          if (slash == std::string::npos)
+            throw Exception ("-shard argument must take the form i/N");
+          uint64_t index (0), count (0);
+          try {
+            index = to<uint64_t> (spec.substr (0, slash));
+            count = to<uint64_t> (spec.substr (slash+1));
+          } catch (Exception& e) {
+            throw Exception (e, "-shard argument must take the form i/N");
+          }
+          if (count < 2 || index >= count)
+            throw Exception ("-shard argument must satisfy 0 <= i < N with N > 1");
+          if (properties.find ("seed_dynamic") != properties.end())
+            throw Exception ("-shard cannot be used with dynamic seeding: seed placement there depends on tracking feedback, and so cannot be keyed deterministically");
+          properties.seeds.set_shard (index, count);
+          properties["shard"] = spec;
+        }
       }
 
 
@@ -34,7 +34,10 @@
 
 #define MAX_NUM_SEED_ATTEMPTS 100000
 
-#define TRACKING_BATCH_SIZE 10
+// Number of tracks staged per producer before each queue hand-off; with
+//   short tracks and many threads, small batches leave the pipeline
+//   bottlenecked on queue synchronisation around the single write thread
+#define TRACKING_BATCH_SIZE 128
 
 
 
@@ -62,7 +65,19 @@ namespace MR
                 typename Method::Shared shared (diff_path, properties);
                 WriteKernel writer (shared, destination, properties);
                 Exec<Method> tracker (shared);
-                Thread::run_queue (Thread::multi (tracker), Thread::batch (GeneratedTrack(), TRACKING_BATCH_SIZE), writer);
+                if (Path::has_suffix (destination, TCK_COMPRESSED_SUFFIX)) {
+                  // delta-encode tracks within the multi-threaded stage, so
+                  //   that the write thread only appends ready-made blocks
+                  EncodeKernel encoder (writer.quantisation());
+                  Thread::run_queue (
+                      Thread::multi (tracker),
+                      Thread::batch (GeneratedTrack(), TRACKING_BATCH_SIZE),
+                      Thread::multi (encoder),
+                      Thread::batch (EncodedTrack(), TRACKING_BATCH_SIZE),
+                      writer);
+                } else {
+                  Thread::run_queue (Thread::multi (tracker), Thread::batch (GeneratedTrack(), TRACKING_BATCH_SIZE), writer);
+                }
 
               } else {
 
@@ -110,7 +125,8 @@ namespace MR
               S (shared),
               method (shared),
               track_excluded (false),
-              track_included (S.properties.include.size(), false) { }
+              track_included (S.properties.include.size(), false),
+              expected_track_size (0) { }
 
 
             bool operator() (GeneratedTrack& item) {
@@ -123,6 +139,7 @@ namespace MR
                 return true;
               }
               gen_track (item);
+              expected_track_size = std::max (expected_track_size, item.size());
               if (track_rejected (item)) {
                 item.clear();
                 item.set_status (GeneratedTrack::status_t::TRACK_REJECTED);
@@ -141,6 +158,7 @@ namespace MR
             Method method;
             bool track_excluded;
             vector<bool> track_included;
+            size_t expected_track_size;
 
 
             term_t iterate ()
@@ -180,6 +198,13 @@ namespace MR
             bool seed_track (GeneratedTrack& tck)
             {
               tck.clear();
+              // the queue recycles GeneratedTrack items with their vertex
+              // storage intact, so pre-reserving to the longest track length
+              // seen by this thread brings a freshly-allocated item up to its
+              // working capacity in a single allocation; in steady state the
+              // tracking loop then performs no heap allocations at all:
+              if (tck.capacity() < expected_track_size)
+                tck.reserve (expected_track_size);
               track_excluded = false;
               track_included.assign (track_included.size(), false);
               method.dir = { NaN, NaN, NaN };
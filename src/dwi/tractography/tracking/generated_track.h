@@ -57,6 +57,31 @@ namespace MR
         };
 
 
+
+        //! a generated track converted to its on-disk representation
+        /*! carries the per-track block produced by encode_track(), together
+         * with the metadata WriteKernel requires to maintain its counters and
+         * seed output; used as the inter-stage item type when encoding is
+         * performed in the multi-threaded tracker stage rather than at the
+         * write kernel (see EncodeKernel). An empty \c data block denotes an
+         * empty (seed-rejected) track. */
+        class EncodedTrack
+        { MEMALIGN(EncodedTrack)
+
+          public:
+
+            EncodedTrack() : num_points (0), seed_index (0), status (GeneratedTrack::status_t::INVALID) { }
+            void clear() { data.clear(); num_points = 0; seed_index = 0; status = GeneratedTrack::status_t::INVALID; }
+
+            vector<uint8_t> data;
+            size_t num_points;
+            size_t seed_index;
+            Eigen::Vector3f seed;
+            GeneratedTrack::status_t status;
+
+        };
+
+
       }
     }
   }
@@ -51,6 +51,32 @@ namespace MR
 
 
 
+          bool WriteKernel::operator() (const EncodedTrack& tck)
+          {
+            if (complete())
+              return false;
+            if (tck.num_points && output_seeds) {
+              const auto& p = tck.seed;
+              (*output_seeds) << str(writer.count) << "," << str(tck.seed_index) << "," << str(p[0]) << "," << str(p[1]) << "," << str(p[2]) << ",\n";
+            }
+            writer (tck.data);
+            switch (tck.status) {
+              case GeneratedTrack::status_t::INVALID: assert (0); break;
+              // Note intentiional lack of break usage
+              case GeneratedTrack::status_t::ACCEPTED: ++selected;
+              case GeneratedTrack::status_t::TRACK_REJECTED: ++streamlines;
+              case GeneratedTrack::status_t::SEED_REJECTED: ++seeds;
+            }
+            progress.update ([&](){ return printf ("%8" PRIu64 " seeds, %8" PRIu64 " streamlines, %8" PRIu64 " selected", seeds, streamlines, selected); }, always_increment ? true : tck.num_points);
+            if (early_exit (seeds, selected)) {
+              WARN ("Track generation terminating prematurely: Highly unlikely to reach target number of streamlines (p<" + str(TCKGEN_EARLY_EXIT_PROB_THRESHOLD,1) + ")");
+              return false;
+            }
+            return true;
+          }
+
+
+
       }
     }
   }
@@ -86,9 +86,12 @@ namespace MR
 
 
           bool operator() (const GeneratedTrack&);
+          bool operator() (const EncodedTrack&);
 
           bool complete() const { return ((S.max_num_tracks && selected >= S.max_num_tracks) || (S.max_num_seeds && seeds >= S.max_num_seeds)); }
 
+          float quantisation() const { return writer.quantisation(); }
+
 
         protected:
           const SharedBase& S;
@@ -102,6 +105,41 @@ namespace MR
 
 
 
+      //! encode generated tracks within the multi-threaded stage of the queue
+      /*! when writing the compressed track format, the delta encoding of each
+       * track is by far the most expensive part of committing it to file; if
+       * left to the single WriteKernel thread it serialises the pipeline at
+       * high thread counts. This kernel runs as an intermediate
+       * multi-threaded queue stage, converting batches of generated tracks
+       * into ready-made per-track blocks so that the write kernel need only
+       * append them. The quantisation step must be that reported by the
+       * writer, since it is what is recorded in the output file header. */
+      class EncodeKernel
+      { MEMALIGN(EncodeKernel)
+        public:
+
+          EncodeKernel (const float quant) : quant (quant) { }
+
+          bool operator() (const GeneratedTrack& in, EncodedTrack& out) const
+          {
+            out.clear();
+            out.status = in.get_status();
+            out.num_points = in.size();
+            if (in.size()) {
+              out.seed_index = in.get_seed_index();
+              out.seed = in[in.get_seed_index()];
+              out.data.reserve (sizeof (uint32_t) + 3 * sizeof (float) + 3 * sizeof (int16_t) * in.size());
+              Writer<>::encode_track (in, out.data, quant);
+            }
+            return true;
+          }
+
+        private:
+          const float quant;
+      };
+
+
+
 
       }
     }
@@ -24,11 +24,15 @@ namespace MR
       using namespace App;
 
       const Option TrackWeightsInOption
-      = Option ("tck_weights_in", "specify a text scalar file containing the streamline weights")
+      = Option ("tck_weights_in", "specify a scalar file containing the streamline weights "
+                                  "(either ASCII text, or the binary streamline weights format; "
+                                  "detected automatically)")
           + Argument ("path").type_file_in();
 
       const Option TrackWeightsOutOption
-      = Option ("tck_weights_out", "specify the path for an output text scalar file containing streamline weights")
+      = Option ("tck_weights_out", "specify the path for an output scalar file containing streamline weights "
+                                   "(written in the binary streamline weights format if the path has the "
+                                   TCK_WEIGHTS_SUFFIX " suffix, and as ASCII text otherwise)")
           + Argument ("path").type_file_out();
 
     }
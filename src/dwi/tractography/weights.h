@@ -15,7 +15,23 @@
 #ifndef __dwi_tractography_weights_h__
 #define __dwi_tractography_weights_h__
 
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
 #include "cmdline_option.h"
+#include "memory.h"
+#include "types.h"
+#include "math/math.h"
+#include "file/entry.h"
+#include "file/mmap.h"
+#include "file/ofstream.h"
+#include "file/path.h"
+
+//! magic signature of the binary streamline weights format
+#define TCK_WEIGHTS_MAGIC "TCKWGT1"
+//! suffix conventionally used to select the binary streamline weights format
+#define TCK_WEIGHTS_SUFFIX ".tckw"
 
 namespace MR
 {
@@ -28,6 +44,100 @@ namespace MR
       extern const App::Option TrackWeightsInOption;
       extern const App::Option TrackWeightsOutOption;
 
+
+
+      //! sequential reader for per-streamline weights files
+      /*! Transparently handles both the whitespace-separated ASCII format
+       * historically used for streamline weights, and the binary format
+       * (magic signature, uint64 entry count, packed native float32 values).
+       * ASCII data are streamed and parsed entry by entry; binary data are
+       * memory-mapped, so that loading weights for many millions of
+       * streamlines involves no parsing whatsoever. The format is detected
+       * from the file contents, not the file name. */
+      class WeightsReader
+      { NOMEMALIGN
+        public:
+          WeightsReader (const std::string& path) :
+              current (0),
+              count (0) {
+            std::ifstream in (path.c_str(), std::ios_base::in | std::ios_base::binary);
+            if (!in)
+              throw Exception ("Unable to open streamlines weights file " + path);
+            char magic [sizeof (TCK_WEIGHTS_MAGIC)];
+            in.read (magic, sizeof (magic));
+            if (in.good() && !memcmp (magic, TCK_WEIGHTS_MAGIC, sizeof (magic))) {
+              uint64_t n = 0;
+              in.read (reinterpret_cast<char*> (&n), sizeof (uint64_t));
+              if (!in.good())
+                throw Exception ("binary streamline weights file \"" + path + "\" has a truncated header");
+              in.close();
+              mmap.reset (new File::MMap (File::Entry (path, sizeof (magic) + sizeof (uint64_t))));
+              count = std::min (n, uint64_t (mmap->size() / sizeof (float)));
+              if (count < n)
+                WARN ("binary streamline weights file \"" + path + "\" is truncated");
+            } else {
+              in.close();
+              text.reset (new std::ifstream (path.c_str(), std::ios_base::in));
+              if (!text->good())
+                throw Exception ("Unable to open streamlines weights file " + path);
+            }
+          }
+
+          //! fetch the next weight; returns false once all entries have been issued
+          bool operator() (float& weight) {
+            if (text) {
+              (*text) >> weight;
+              return !text->fail();
+            }
+            if (current >= count)
+              return false;
+            weight = reinterpret_cast<const float*> (mmap->address())[current++];
+            return true;
+          }
+
+          //! whether the file contains entries beyond those already issued
+          bool has_excess () {
+            if (text) {
+              float temp;
+              (*text) >> temp;
+              return !text->fail();
+            }
+            return current < count;
+          }
+
+        private:
+          std::unique_ptr<File::MMap> mmap;
+          std::unique_ptr<std::ifstream> text;
+          uint64_t current, count;
+
+          WeightsReader (const WeightsReader&) = delete;
+      };
+
+
+
+      //! save a vector of per-streamline weights to file
+      /*! written in the binary format if \a path carries the
+       * TCK_WEIGHTS_SUFFIX suffix, and as ASCII text otherwise. */
+      template <class VectorType>
+        void save_weights (const VectorType& weights, const std::string& path)
+        {
+          if (!Path::has_suffix (path, TCK_WEIGHTS_SUFFIX)) {
+            save_vector (weights, path);
+            return;
+          }
+          File::OFStream out (path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+          out.write (TCK_WEIGHTS_MAGIC, sizeof (TCK_WEIGHTS_MAGIC));
+          const uint64_t count = weights.size();
+          out.write (reinterpret_cast<const char*> (&count), sizeof (uint64_t));
+          for (decltype(weights.size()) i = 0; i != weights.size(); ++i) {
+            const float f = weights[i];
+            out.write (reinterpret_cast<const char*> (&f), sizeof (float));
+          }
+          if (!out.good())
+            throw Exception ("error writing binary streamline weights file \"" + path + "\": " + strerror (errno));
+        }
+
+
     }
   }
 }
@@ -153,20 +153,48 @@ namespace MR
 
       void Image::update_texture2D (int plane, int slice)
       {
-        if (!texture2D[plane]) { // allocate:
-          texture2D[plane].gen (gl::TEXTURE_3D);
-          texture2D[plane].bind();
-        }
-        else
-          texture2D[plane].bind();
         gl::PixelStorei (gl::UNPACK_ALIGNMENT, 1);
-        texture2D[plane].set_interp (interpolation);
 
-        if (tex_positions[plane] == slice && volume_unchanged () && format_unchanged ())
+        if (texture2D[plane] && tex_positions[plane] == slice && volume_unchanged () && format_unchanged ()) {
+          texture2D[plane].bind();
+          texture2D[plane].set_interp (interpolation);
           return;
+        }
+
+        // A change of texture format invalidates all cached slices
+        if (!format_unchanged ())
+          tex_2d_cache.clear();
 
         tex_positions[plane] = slice;
 
+        const bool windowing_reset_required_on_hit = (!std::isfinite (display_range) || (display_range < 0.0f));
+
+        // Check whether this slice is already resident in texture memory;
+        //   NB: tex_positions along the higher axes have been refreshed by
+        //   volume_unchanged() above
+        vector<ssize_t> key (1, plane);
+        key.push_back (slice);
+        for (size_t n = 3; n < image.ndim(); ++n)
+          key.push_back (tex_positions[n]);
+
+        const auto cached = tex_2d_cache.find (key);
+        if (cached != tex_2d_cache.end()) {
+          cached->second.last_used = ++tex_2d_cache_clock;
+          slice_min[plane] = cached->second.value_min;
+          slice_max[plane] = cached->second.value_max;
+          if (!std::isfinite (value_min) || slice_min[plane] < value_min)
+            value_min = slice_min[plane];
+          if (!std::isfinite (value_max) || slice_max[plane] > value_max)
+            value_max = slice_max[plane];
+          texture2D[plane].cache_copy (cached->second.texture);
+          texture2D[plane].bind();
+          texture2D[plane].set_interp (interpolation);
+          min_max_set();
+          if (windowing_reset_required_on_hit)
+            set_windowing (slice_min[plane], slice_max[plane]);
+          return;
+        }
+
         int x, y;
         get_axes (plane, x, y);
         const ssize_t xsize = header().size (x), ysize = header().size (y);
@@ -296,7 +324,38 @@ namespace MR
         if (windowing_reset_required)
           set_windowing (slice_min[plane], slice_max[plane]);
 
+        // Upload into a fresh texture, and retain it in the slice cache so
+        //   that re-visiting this slice does not require re-extraction
+        CachedSlice& entry (tex_2d_cache[key]);
+        entry.texture.gen (gl::TEXTURE_3D);
+        entry.texture.bind();
+        entry.texture.set_interp (interpolation);
+        entry.value_min = slice_min[plane];
+        entry.value_max = slice_max[plane];
+        entry.last_used = ++tex_2d_cache_clock;
         gl::TexImage3D (gl::TEXTURE_3D, 0, internal_format, xsize, ysize, 1, 0, format, type, reinterpret_cast<void*> (&data[0]));
+        texture2D[plane].cache_copy (entry.texture);
+
+        //CONF option: MRViewMaxNumCachedSlices
+        //CONF default: 100
+        //CONF The maximum number of 2D image slices (per image, summed
+        //CONF across the three planes) to retain in texture memory for
+        //CONF rapid redisplay; the least recently displayed slice is
+        //CONF evicted once this limit is reached.
+        static const size_t max_cached_slices = File::Config::get_int ("MRViewMaxNumCachedSlices", 100);
+        if (tex_2d_cache.size() > max_cached_slices) {
+          auto oldest = tex_2d_cache.end();
+          for (auto it = tex_2d_cache.begin(); it != tex_2d_cache.end(); ++it) {
+            // Never evict a slice that is currently on display in any plane
+            const GLuint id (it->second.texture);
+            if (id == GLuint (texture2D[0]) || id == GLuint (texture2D[1]) || id == GLuint (texture2D[2]))
+              continue;
+            if (oldest == tex_2d_cache.end() || it->second.last_used < oldest->second.last_used)
+              oldest = it;
+          }
+          if (oldest != tex_2d_cache.end())
+            tex_2d_cache.erase (oldest);
+        }
       }
 
 
@@ -431,6 +490,8 @@ namespace MR
           if (cached_tex != tex_4d_cache.end()) {
             _texture.cache_copy (cached_tex->second);
             tex_positions[3] = vol_idx;
+            auto cached_occupancy = occupancy_4d_cache.find (vol_idx);
+            upload_occupancy (cached_occupancy != occupancy_4d_cache.end() ? cached_occupancy->second : vector<float>());
           } else {
             _texture.cache_copy(GL::Texture());
             tex_positions[3] = -1;
@@ -486,17 +547,30 @@ namespace MR
           value_min = std::numeric_limits<float>::infinity();
           value_max = -std::numeric_limits<float>::infinity();
 
+          // Brick-wise maximum absolute amplitude, accumulated alongside the
+          //   texture upload and expressed in the same normalised units as
+          //   the texels (integer types are normalised on pixel transfer)
+          occupancy_dims = { { (V.size(0) + occupancy_brick_size - 1) / occupancy_brick_size,
+                               (V.size(1) + occupancy_brick_size - 1) / occupancy_brick_size,
+                               (V.size(2) + occupancy_brick_size - 1) / occupancy_brick_size } };
+          vector<float> occupancy (occupancy_dims[0] * occupancy_dims[1] * occupancy_dims[2], 0.0f);
+          const float occupancy_norm = std::is_integral<ValueType>::value ? 1.0f / float (std::numeric_limits<ValueType>::max()) : 1.0f;
+
           for (V.index(2) = 0; V.index(2) < V.size(2); ++V.index(2)) {
 
             if (format == gl::RED) {
               auto p = data.begin();
+              float* occupancy_slab = &occupancy[(V.index(2) / occupancy_brick_size) * occupancy_dims[1] * occupancy_dims[0]];
 
               for (V.index(1) = 0; V.index(1) < V.size(1); ++V.index(1)) {
+                float* occupancy_row = occupancy_slab + (V.index(1) / occupancy_brick_size) * occupancy_dims[0];
                 for (V.index(0) = 0; V.index(0) < V.size(0); ++V.index(0)) {
                   ValueType val = *p = V.value();
                   if (std::isfinite (val)) {
                     value_min = std::min (value_min, float(val));
                     value_max = std::max (value_max, float(val));
+                    float& brick = occupancy_row[V.index(0) / occupancy_brick_size];
+                    brick = std::max (brick, occupancy_norm * float (abs_if_signed (val)));
                   }
                   ++p;
                 }
@@ -540,6 +614,13 @@ namespace MR
             upload_data ({ { 0, 0, V.index(2) } }, { { V.size(0), V.size(1), 1 } }, reinterpret_cast<void*> (&data[0]));
             ++progress;
           }
+
+          if (format == gl::RED) {
+            occupancy_4d_cache[image.ndim() > 3 ? size_t (image.index(3)) : 0] = occupancy;
+            upload_occupancy (occupancy);
+          } else {
+            upload_occupancy (vector<float>());
+          }
         }
 
 
@@ -575,6 +656,29 @@ namespace MR
           upload_data ({ { 0, 0, image.index(2) } }, { { image.size(0), image.size(1), 1 } }, reinterpret_cast<void*> (&data[0]));
           ++progress;
         }
+
+        upload_occupancy (vector<float>());
+      }
+
+
+
+      void Image::upload_occupancy (const vector<float>& data)
+      {
+        if (!_occupancy_texture)
+          _occupancy_texture.gen (gl::TEXTURE_3D, gl::NEAREST);
+        _occupancy_texture.bind();
+        if (data.size()) {
+          gl::TexImage3D (gl::TEXTURE_3D, 0, gl::R32F, occupancy_dims[0], occupancy_dims[1], occupancy_dims[2], 0, gl::RED, gl::FLOAT, data.data());
+        } else {
+          // A single texel holding the largest representable value ensures
+          //   the occupancy test can never pass, disabling skipping for
+          //   image types (RGB / complex) for which no per-brick occupancy
+          //   information is computed
+          const float value = std::numeric_limits<float>::max();
+          gl::TexImage3D (gl::TEXTURE_3D, 0, gl::R32F, 1, 1, 1, 0, gl::RED, gl::FLOAT, &value);
+        }
+        // restore the main image texture binding
+        bind();
       }
 
 
@@ -21,6 +21,7 @@
 #include "gui/mrview/volume.h"
 #include "interp/linear.h"
 #include "interp/nearest.h"
+#include <map>
 #include <unordered_map>
 
 
@@ -82,6 +83,11 @@ namespace MR
 
           void reset_windowing (const int, const bool);
 
+          //! coarse per-brick maximum absolute amplitude of the current
+          //   volume, used for empty-space skipping in the volume render mode
+          const GL::Texture& occupancy_texture () const { return _occupancy_texture; }
+          constexpr static int occupancy_brick_size = 8;
+
         protected:
           mutable MR::Interp::Linear <MR::Image<cfloat>> linear_interp;
           mutable MR::Interp::Nearest<MR::Image<cfloat>> nearest_interp;
@@ -90,6 +96,20 @@ namespace MR
           std::array<float, 3> slice_min, slice_max;
           std::unordered_map<size_t, GL::Texture> tex_4d_cache;
 
+          //! a single cached 2D slice texture, along with the intensity
+          //   range of the slice and a timestamp for least-recently-used
+          //   eviction
+          struct CachedSlice { MEMALIGN(CachedSlice)
+            GL::Texture texture;
+            float value_min, value_max;
+            uint64_t last_used;
+          };
+          // Keyed on { plane, slice, indices along any higher axes }; only
+          //   the slices intersected by recent browsing are retained, so
+          //   texture memory use remains bounded regardless of image size
+          std::map<vector<ssize_t>, CachedSlice> tex_2d_cache;
+          uint64_t tex_2d_cache_clock = 0;
+
         private:
           bool volume_unchanged ();
           bool format_unchanged ();
@@ -99,6 +119,13 @@ namespace MR
           void copy_texture_3D_complex ();
           void lookup_texture_4D_cache ();
           void update_texture_4D_cache ();
+          void upload_occupancy (const vector<float>&);
+
+          GL::Texture _occupancy_texture;
+          std::array<ssize_t,3> occupancy_dims;
+          // Occupancy data is retained per volume, so that switching between
+          //   cached 4D volumes restores the matching occupancy texture
+          std::unordered_map<size_t, vector<float>> occupancy_4d_cache;
 
           vector<std::string> _comments;
 
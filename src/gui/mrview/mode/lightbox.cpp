@@ -174,6 +174,46 @@ namespace MR
           }
         }
 
+        // Append the quad for one pane to the single-pass vertex batch.
+        // Texture coordinates are computed exactly as the per-slice render
+        // would (see Volume::set_vertices_for_slice_render); positions are
+        // expressed directly in normalised device coordinates of the full
+        // (x,y,w,h) viewport, since the batch is drawn with an identity MVP
+        void LightBox::batch_slice_quad (const Projection& slice_proj, GLint x, GLint y, GLint w, GLint h)
+        {
+          const float depth = slice_proj.depth_of (focus());
+
+          Eigen::Vector3f model[4];
+          model[0] = slice_proj.screen_to_model (slice_proj.x_position(), slice_proj.y_position() + slice_proj.height(), depth);
+          model[1] = slice_proj.screen_to_model (slice_proj.x_position(), slice_proj.y_position(), depth);
+          model[2] = slice_proj.screen_to_model (slice_proj.x_position() + slice_proj.width(), slice_proj.y_position(), depth);
+          model[3] = slice_proj.screen_to_model (slice_proj.x_position() + slice_proj.width(), slice_proj.y_position() + slice_proj.height(), depth);
+
+          const auto& header = image()->header();
+          const Eigen::Vector3f sizes (header.size(0), header.size(1), header.size(2));
+          Eigen::Vector3f tex[4];
+          for (size_t n = 0; n < 4; ++n) {
+            const Eigen::Vector3f v = (image()->transform().scanner2voxel.cast<float>() * model[n]) + Eigen::Vector3f { 0.5f, 0.5f, 0.5f };
+            tex[n] = { v[0]/sizes[0], v[1]/sizes[1], v[2]/sizes[2] };
+          }
+
+          const float left   = 2.f * (slice_proj.x_position() - x) / float(w) - 1.f;
+          const float right  = 2.f * (slice_proj.x_position() + slice_proj.width() - x) / float(w) - 1.f;
+          const float bottom = 2.f * (slice_proj.y_position() - y) / float(h) - 1.f;
+          const float top    = 2.f * (slice_proj.y_position() + slice_proj.height() - y) / float(h) - 1.f;
+          const Eigen::Vector3f ndc[4] = {
+            { left,  top,    0.f },
+            { left,  bottom, 0.f },
+            { right, bottom, 0.f },
+            { right, top,    0.f } };
+
+          // two triangles per pane
+          for (const size_t n : { 0, 1, 2, 0, 2, 3 }) {
+            batch_vertices.push_back (ndc[n]);
+            batch_vertices.push_back (tex[n]);
+          }
+        }
+
         void LightBox::draw_plane_primitive (int axis, Displayable::Shader& shader_program, Projection& with_projection)
         {
           ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
@@ -205,6 +245,38 @@ namespace MR
 
           bool rend_vols = render_volumes();
 
+          // When every pane samples the same volume texture, the image
+          //   component of the whole grid can be rendered in a single draw
+          //   call; tools and crosshairs are still rendered per pane. When
+          //   each pane displays a different volume the textures differ, so
+          //   the per-pane path is retained
+          const bool batched = visible && image() && !rend_vols;
+
+          if (batched) {
+            batch_vertices.clear();
+            ssize_t slice_idx = 0;
+            for(size_t row = 0; row < n_rows; ++row) {
+              for(size_t col = 0; col < n_cols; ++col, ++slice_idx) {
+                Projection& slice_proj = slices_proj_focusdelta[slice_idx].first;
+                slice_proj.set_viewport(window(), x + dw * col, y + h - (dh * (row+1)), dw, dh);
+                setup_projection (plane(), slice_proj);
+                float focus_delta = slices_proj_focusdelta[slice_idx].second;
+                Eigen::Vector3f slice_focus = move_in_out_displacement(focus_delta, slice_proj);
+                set_focus(orig_focus + slice_focus);
+                batch_slice_quad(slice_proj, x, y, w, h);
+              }
+            }
+            set_focus(orig_focus);
+            projection.set_viewport(window(), x, y, w, h);
+
+            gl::Disable (gl::BLEND);
+            gl::Disable (gl::DEPTH_TEST);
+            gl::DepthMask (gl::FALSE_);
+            gl::ColorMask (gl::TRUE_, gl::TRUE_, gl::TRUE_, gl::TRUE_);
+            image()->update_texture3D();
+            image()->render_batch (slice_shader, batch_vertices);
+          }
+
           ssize_t slice_idx = 0;
           for(size_t row = 0; row < n_rows; ++row) {
             for(size_t col = 0; col < n_cols; ++col, ++slice_idx) {
@@ -232,8 +304,18 @@ namespace MR
                 set_focus(orig_focus + slice_focus);
               }
 
-              if (render_plane)
-                draw_plane_primitive(plane(), slice_shader, slice_proj);
+              if (render_plane) {
+                if (batched) {
+                  // image already drawn in the single batched pass
+                  gl::Disable (gl::BLEND);
+                  gl::Disable (gl::DEPTH_TEST);
+                  gl::DepthMask (gl::FALSE_);
+                  gl::ColorMask (gl::TRUE_, gl::TRUE_, gl::TRUE_, gl::TRUE_);
+                  render_tools (slice_proj, false, plane(), slice (plane()));
+                }
+                else
+                  draw_plane_primitive(plane(), slice_shader, slice_proj);
+              }
 
               if(slice_idx == current_slice_index) {
                 // Drawing plane may alter the depth test state
@@ -77,6 +77,8 @@ namespace MR
             }
 
             void update_layout();
+            void batch_slice_quad(const Projection& slice_proj,
+                                  GLint x, GLint y, GLint w, GLint h);
             void update_volume_indices();
             void update_slices_focusdelta();
             void set_current_slice_index(ssize_t slice_index);
@@ -94,6 +96,9 @@ namespace MR
             static ssize_t current_slice_index;
             vector<ssize_t> volume_indices;
             vector<proj_focusdelta> slices_proj_focusdelta;
+            // interleaved {position, texture coordinate} pairs for the
+            //   single-pass rendering of the image component of all panes
+            vector<Eigen::Vector3f> batch_vertices;
 
             GL::VertexBuffer frame_VB;
             GL::VertexArrayObject frame_VAO;
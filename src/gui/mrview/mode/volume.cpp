@@ -90,6 +90,17 @@ namespace MR
               "in vec3 overlay_texcoord"+str(n) + ";\n";
           }
 
+          // Empty-space skipping is only applicable when the render
+          //   integrates the main image alone: overlays may contribute where
+          //   the image is empty, and clip plane highlights are drawn
+          //   irrespective of image content
+          const bool empty_space_skip = !clip.size() && !mode.overlays_for_3D.size();
+          if (empty_space_skip)
+            source +=
+              "uniform sampler3D occupancy_sampler;\n"
+              "uniform float occupancy_threshold;\n"
+              "uniform int occupancy_skip;\n";
+
           source +=
             "uniform sampler2D depth_sampler;\n"
             "uniform mat4 M;\n"
@@ -125,6 +136,17 @@ namespace MR
             "  for (int n = 0; n < nmax; ++n) {\n"
             "    coord += ray;\n";
 
+          // If the brick containing the current sample cannot contribute to
+          //   the integral, jump ahead; the skip distance is bounded by one
+          //   brick extent, so an occupied brick can never be stepped over
+          if (empty_space_skip)
+            source +=
+            "    if (texture (occupancy_sampler, coord).r < occupancy_threshold) {\n"
+            "      coord += float(occupancy_skip) * ray;\n"
+            "      n += occupancy_skip;\n"
+            "      continue;\n"
+            "    }\n";
+
           if (clip.size()) {
             source += std::string("    bool show = ") + ( AND ? "false" : "true" ) + ";\n";
             for (size_t n = 0; n < clip.size(); ++n)
@@ -481,6 +503,29 @@ namespace MR
           }
           GL_CHECK_ERROR;
 
+          if (!clip.size() && !overlays_for_3D.size()) {
+            gl::ActiveTexture (gl::TEXTURE2);
+            gl::BindTexture (gl::TEXTURE_3D, image()->occupancy_texture());
+            gl::Uniform1i (gl::GetUniformLocation (volume_shader, "occupancy_sampler"), 2);
+            // Texels below this amplitude cannot contribute to the integral;
+            //   expressed in the same normalised units as the texture data
+            //   (matching the alpha_offset / lower uniforms)
+            float threshold = image()->transparent_intensity / image()->scale_factor();
+            if (image()->use_discard_lower())
+              threshold = std::max (threshold, image()->lessthan / image()->scale_factor());
+            gl::Uniform1f (gl::GetUniformLocation (volume_shader, "occupancy_threshold"), threshold);
+            // The largest number of additional steps guaranteed not to jump
+            //   over an entire occupancy brick, given that one step has
+            //   already been taken before the occupancy test
+            float steps_per_brick = std::numeric_limits<float>::max();
+            for (size_t axis = 0; axis != 3; ++axis) {
+              if (ray[axis] != 0.0f)
+                steps_per_brick = std::min (steps_per_brick, (float (Image::occupancy_brick_size) / image()->header().size (axis)) / std::abs (ray[axis]));
+            }
+            gl::Uniform1i (gl::GetUniformLocation (volume_shader, "occupancy_skip"), std::max (0, int (steps_per_brick) - 1));
+          }
+          GL_CHECK_ERROR;
+
           for (int n = 0; n < overlays_for_3D.size(); ++n) {
             gl::ActiveTexture (gl::TEXTURE2 + n);
             gl::BindTexture (gl::TEXTURE_3D, overlays_for_3D[n]->texture());
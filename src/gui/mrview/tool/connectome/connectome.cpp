@@ -2447,29 +2447,9 @@ namespace MR
                   gl::DepthMask (gl::FALSE_);
               }
 
-              const GLuint node_colour_ID = gl::GetUniformLocation (node_shader, "node_colour");
-
-              GLuint node_alpha_ID = 0;
-              if (alpha)
-                node_alpha_ID = gl::GetUniformLocation (node_shader, "node_alpha");
-
-              const GLuint node_centre_ID = gl::GetUniformLocation (node_shader, "node_centre");
-              const GLuint node_size_ID = gl::GetUniformLocation (node_shader, "node_size");
-
               if (node_colour == node_colour_t::VECTOR_FILE && ColourMap::maps[node_colourmap_index].is_colour)
                 gl::Uniform3fv (gl::GetUniformLocation (node_shader, "colourmap_colour"), 1, node_fixed_colour.data());
 
-              if (node_geometry == node_geometry_t::SPHERE) {
-                sphere.vertex_buffer.bind (gl::ARRAY_BUFFER);
-                sphere_VAO.bind();
-                sphere.index_buffer.bind();
-              } else if (node_geometry == node_geometry_t::CUBE) {
-                cube.vertex_buffer.bind (gl::ARRAY_BUFFER);
-                cube.normals_buffer.bind (gl::ARRAY_BUFFER);
-                cube_VAO.bind();
-                cube.index_buffer.bind();
-              }
-
               GLuint specular_ID = 0;
               if (use_lighting()) {
                 gl::UniformMatrix4fv (gl::GetUniformLocation (node_shader, "MV"), 1, gl::FALSE_, projection.modelview());
@@ -2491,54 +2471,105 @@ namespace MR
                 }
               }
 
+              // Back-to-front ordering is only strictly required for correct
+              //   blending of transparent nodes, but is equally valid for
+              //   opaque rendering
               std::map<float, size_t> node_ordering;
               for (size_t i = 1; i <= num_nodes(); ++i)
                 node_ordering.insert (std::make_pair (projection.depth_of (nodes[i].get_com()), i));
 
-              for (auto it = node_ordering.rbegin(); it != node_ordering.rend(); ++it) {
-                const Node& node (nodes[it->second]);
-                if (node_visibility_given_selection (it->second)) {
-                  gl::Uniform3fv (node_colour_ID, 1, node_colour_given_selection (it->second).data());
-                  if (alpha)
-                    gl::Uniform1f (node_alpha_ID, node_alpha_given_selection (it->second) * node_fixed_alpha);
-                  gl::Uniform3fv (node_centre_ID, 1, node.get_com().data());
-                  gl::Uniform1f (node_size_ID, node_size_given_selection (it->second) * node_size_scale_factor);
-                  switch (node_geometry) {
-                    case node_geometry_t::SPHERE:
-                      if (alpha) {
-                        gl::CullFace (gl::FRONT);
-                        gl::Uniform1f  (specular_ID, (1.0 - node_alpha_given_selection (it->second) * node_fixed_alpha) * lighting.specular);
-                        gl::DrawElements (gl::TRIANGLES, sphere.num_indices, gl::UNSIGNED_INT, (void*)0);
-                        gl::CullFace (gl::BACK);
-                        gl::Uniform1f  (specular_ID, lighting.specular);
-                      }
-                      gl::DrawElements (gl::TRIANGLES, sphere.num_indices, gl::UNSIGNED_INT, (void*)0);
-                      break;
-                    case node_geometry_t::CUBE:
-                      if (alpha) {
-                        gl::CullFace (gl::FRONT);
-                        gl::Uniform1f  (specular_ID, (1.0 - node_alpha_given_selection (it->second) * node_fixed_alpha) * lighting.specular);
-                        gl::DrawElements (gl::TRIANGLES, cube.num_indices, gl::UNSIGNED_INT, (void*)0);
-                        gl::CullFace (gl::BACK);
-                        gl::Uniform1f  (specular_ID, lighting.specular);
-                      }
-                      gl::DrawElements (gl::TRIANGLES, cube.num_indices, gl::UNSIGNED_INT, (void*)0);
-                      break;
-                    case node_geometry_t::OVERLAY:
-                      assert (0);
-                      break;
-                    case node_geometry_t::MESH:
-                      if (alpha) {
-                        gl::CullFace (gl::FRONT);
-                        gl::Uniform1f  (specular_ID, (1.0 - node_alpha_given_selection (it->second) * node_fixed_alpha) * lighting.specular);
-                        node.render_mesh();
-                        gl::CullFace (gl::BACK);
-                        gl::Uniform1f  (specular_ID, lighting.specular);
-                      }
+              if (node_geometry == node_geometry_t::SPHERE || node_geometry == node_geometry_t::CUBE) {
+
+                // All nodes share one canonical mesh; rather than issuing
+                //   uniform updates and a draw call per node, stream the
+                //   per-node parameters as per-instance vertex attributes
+                //   and draw all nodes with a single instanced draw call
+                const size_t floats_per_instance = 8;
+                vector<GLfloat> instance_data;
+                instance_data.reserve (floats_per_instance * num_nodes());
+                GLsizei instance_count = 0;
+                for (auto it = node_ordering.rbegin(); it != node_ordering.rend(); ++it) {
+                  if (!node_visibility_given_selection (it->second))
+                    continue;
+                  const Node& node (nodes[it->second]);
+                  const Eigen::Array3f colour (node_colour_given_selection (it->second));
+                  for (size_t axis = 0; axis != 3; ++axis)
+                    instance_data.push_back (node.get_com()[axis]);
+                  instance_data.push_back (node_size_given_selection (it->second) * node_size_scale_factor);
+                  for (size_t i = 0; i != 3; ++i)
+                    instance_data.push_back (colour[i]);
+                  instance_data.push_back (alpha ? node_alpha_given_selection (it->second) * node_fixed_alpha : 1.0f);
+                  ++instance_count;
+                }
+
+                if (node_geometry == node_geometry_t::SPHERE) {
+                  sphere.vertex_buffer.bind (gl::ARRAY_BUFFER);
+                  sphere_VAO.bind();
+                  sphere.index_buffer.bind();
+                } else {
+                  cube.vertex_buffer.bind (gl::ARRAY_BUFFER);
+                  cube.normals_buffer.bind (gl::ARRAY_BUFFER);
+                  cube_VAO.bind();
+                  cube.index_buffer.bind();
+                }
+
+                node_instance_buffer.gen();
+                node_instance_buffer.bind (gl::ARRAY_BUFFER);
+                gl::BufferData (gl::ARRAY_BUFFER, instance_data.size() * sizeof (GLfloat), instance_data.size() ? &instance_data[0] : nullptr, gl::STREAM_DRAW);
+                const GLsizei stride = floats_per_instance * sizeof (GLfloat);
+                gl::EnableVertexAttribArray (2);
+                gl::VertexAttribPointer (2, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(0));
+                gl::EnableVertexAttribArray (3);
+                gl::VertexAttribPointer (3, 1, gl::FLOAT, gl::FALSE_, stride, (void*)(3*sizeof(GLfloat)));
+                gl::EnableVertexAttribArray (4);
+                gl::VertexAttribPointer (4, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(4*sizeof(GLfloat)));
+                gl::EnableVertexAttribArray (5);
+                gl::VertexAttribPointer (5, 1, gl::FLOAT, gl::FALSE_, stride, (void*)(7*sizeof(GLfloat)));
+                for (GLuint index = 2; index != 6; ++index)
+                  gl::VertexAttribDivisor (index, 1);
+
+                const GLsizei num_indices = (node_geometry == node_geometry_t::SPHERE) ? sphere.num_indices : cube.num_indices;
+                if (instance_count) {
+                  if (alpha) {
+                    gl::CullFace (gl::FRONT);
+                    gl::Uniform1f (gl::GetUniformLocation (node_shader, "reverse_pass"), 1.0f);
+                    gl::DrawElementsInstanced (gl::TRIANGLES, num_indices, gl::UNSIGNED_INT, (void*)0, instance_count);
+                    gl::CullFace (gl::BACK);
+                    gl::Uniform1f (gl::GetUniformLocation (node_shader, "reverse_pass"), 0.0f);
+                  }
+                  gl::DrawElementsInstanced (gl::TRIANGLES, num_indices, gl::UNSIGNED_INT, (void*)0, instance_count);
+                }
+
+              } else { // Per-node meshes; these cannot be instanced
+
+                assert (node_geometry == node_geometry_t::MESH);
+
+                const GLuint node_colour_ID = gl::GetUniformLocation (node_shader, "node_colour");
+                GLuint node_alpha_ID = 0;
+                if (alpha)
+                  node_alpha_ID = gl::GetUniformLocation (node_shader, "node_alpha");
+                const GLuint node_centre_ID = gl::GetUniformLocation (node_shader, "node_centre");
+                const GLuint node_size_ID = gl::GetUniformLocation (node_shader, "node_size");
+
+                for (auto it = node_ordering.rbegin(); it != node_ordering.rend(); ++it) {
+                  const Node& node (nodes[it->second]);
+                  if (node_visibility_given_selection (it->second)) {
+                    gl::Uniform3fv (node_colour_ID, 1, node_colour_given_selection (it->second).data());
+                    if (alpha)
+                      gl::Uniform1f (node_alpha_ID, node_alpha_given_selection (it->second) * node_fixed_alpha);
+                    gl::Uniform3fv (node_centre_ID, 1, node.get_com().data());
+                    gl::Uniform1f (node_size_ID, node_size_given_selection (it->second) * node_size_scale_factor);
+                    if (alpha) {
+                      gl::CullFace (gl::FRONT);
+                      gl::Uniform1f  (specular_ID, (1.0 - node_alpha_given_selection (it->second) * node_fixed_alpha) * lighting.specular);
                       node.render_mesh();
-                      break;
+                      gl::CullFace (gl::BACK);
+                      gl::Uniform1f  (specular_ID, lighting.specular);
+                    }
+                    node.render_mesh();
                   }
                 }
+
               }
 
               // Reset to defaults if we've been doing transparency
@@ -2585,18 +2616,14 @@ namespace MR
             if ((edge_geometry == edge_geometry_t::LINE || edge_geometry == edge_geometry_t::STREAMLINE) && edge_geometry_line_smooth_checkbox->isChecked())
               gl::Enable (gl::LINE_SMOOTH);
 
-            GLuint node_centre_one_ID = 0, node_centre_two_ID = 0, rot_matrix_ID = 0;
             if (edge_geometry == edge_geometry_t::CYLINDER) {
               cylinder.vertex_buffer.bind (gl::ARRAY_BUFFER);
               cylinder_VAO.bind();
               cylinder.index_buffer.bind();
-              node_centre_one_ID = gl::GetUniformLocation (edge_shader, "centre_one");
-              node_centre_two_ID = gl::GetUniformLocation (edge_shader, "centre_two");
-              rot_matrix_ID      = gl::GetUniformLocation (edge_shader, "rot_matrix");
             }
 
             GLuint radius_ID = 0;
-            if (edge_geometry == edge_geometry_t::CYLINDER || edge_geometry == edge_geometry_t::STREAMTUBE)
+            if (edge_geometry == edge_geometry_t::STREAMTUBE)
               radius_ID = gl::GetUniformLocation (edge_shader, "radius");
 
             GLuint specular_ID = 0;
@@ -2620,60 +2647,121 @@ namespace MR
               }
             }
 
-            const GLuint edge_colour_ID = gl::GetUniformLocation (edge_shader, "edge_colour");
-
-            GLuint edge_alpha_ID = 0;
-            if (alpha)
-              edge_alpha_ID = gl::GetUniformLocation (edge_shader, "edge_alpha");
-
             if ((edge_colour == edge_colour_t::CONNECTOME || edge_colour == edge_colour_t::MATRIX_FILE) && ColourMap::maps[edge_colourmap_index].is_colour)
               gl::Uniform3fv (gl::GetUniformLocation (edge_shader, "colourmap_colour"), 1, edge_fixed_colour.data());
 
+            // Back-to-front ordering is only strictly required for correct
+            //   blending of transparent edges, but is equally valid for
+            //   opaque rendering
             std::map<float, size_t> edge_ordering;
             for (size_t i = 0; i != num_edges(); ++i)
               edge_ordering.insert (std::make_pair (projection.depth_of (edges[i].get_com()), i));
 
-            for (auto it = edge_ordering.rbegin(); it != edge_ordering.rend(); ++it) {
-              const Edge& edge (edges[it->second]);
-              if (edge_visibility_given_selection (edge)) {
-                gl::Uniform3fv (edge_colour_ID, 1, edge_colour_given_selection (edge).data());
-                if (alpha)
-                  gl::Uniform1f (edge_alpha_ID, edge_alpha_given_selection (edge) * edge_fixed_alpha);
-                switch (edge_geometry) {
-                  case edge_geometry_t::LINE:
-                    gl::LineWidth (calc_line_width (edge_size_given_selection (edge) * edge_size_scale_factor, edge_geometry_line_smooth_checkbox->isChecked()));
-                    edge.render_line();
-                    break;
-                  case edge_geometry_t::CYLINDER:
-                    gl::Uniform3fv       (node_centre_one_ID, 1,        edge.get_node_centre(0).data());
-                    gl::Uniform3fv       (node_centre_two_ID, 1,        edge.get_node_centre(1).data());
-                    gl::UniformMatrix3fv (rot_matrix_ID,      1, false, edge.get_rot_matrix());
-                    gl::Uniform1f        (radius_ID,                    std::sqrt (edge_size_given_selection (edge) * edge_size_scale_factor / Math::pi));
-                    if (alpha) {
-                      gl::CullFace (gl::FRONT);
-                      gl::Uniform1f  (specular_ID, (1.0 - edge_alpha_given_selection (edge) * edge_fixed_alpha) * lighting.specular);
-                      gl::DrawElements (gl::TRIANGLES, cylinder.num_indices, gl::UNSIGNED_INT, (void*)0);
-                      gl::CullFace (gl::BACK);
-                      gl::Uniform1f  (specular_ID, lighting.specular);
-                    }
-                    gl::DrawElements (gl::TRIANGLES, cylinder.num_indices, gl::UNSIGNED_INT, (void*)0);
-                    break;
-                  case edge_geometry_t::STREAMLINE:
-                    gl::LineWidth (calc_line_width (edge_size_given_selection (edge) * edge_size_scale_factor, edge_geometry_line_smooth_checkbox->isChecked()));
-                    edge.render_streamline();
-                    break;
-                  case edge_geometry_t::STREAMTUBE:
-                    gl::Uniform1f (radius_ID, std::sqrt (edge_size_given_selection (edge) * edge_size_scale_factor / Math::pi));
-                    if (alpha) {
-                      gl::CullFace (gl::FRONT);
-                      gl::Uniform1f  (specular_ID, (1.0 - edge_alpha_given_selection (edge) * edge_fixed_alpha) * lighting.specular);
+            if (edge_geometry == edge_geometry_t::CYLINDER) {
+
+              // All edges share one canonical mesh; rather than issuing
+              //   uniform updates and a draw call per edge, stream the
+              //   per-edge parameters as per-instance vertex attributes
+              //   and draw all edges with a single instanced draw call
+              const size_t floats_per_instance = 20;
+              vector<GLfloat> instance_data;
+              instance_data.reserve (floats_per_instance * num_edges());
+              GLsizei instance_count = 0;
+              for (auto it = edge_ordering.rbegin(); it != edge_ordering.rend(); ++it) {
+                const Edge& edge (edges[it->second]);
+                if (!edge_visibility_given_selection (edge))
+                  continue;
+                for (size_t axis = 0; axis != 3; ++axis)
+                  instance_data.push_back (edge.get_node_centre(0)[axis]);
+                for (size_t axis = 0; axis != 3; ++axis)
+                  instance_data.push_back (edge.get_node_centre(1)[axis]);
+                const GLfloat* const rot_matrix = edge.get_rot_matrix();
+                for (size_t i = 0; i != 9; ++i)
+                  instance_data.push_back (rot_matrix[i]);
+                instance_data.push_back (std::sqrt (edge_size_given_selection (edge) * edge_size_scale_factor / Math::pi));
+                const Eigen::Array3f colour (edge_colour_given_selection (edge));
+                for (size_t i = 0; i != 3; ++i)
+                  instance_data.push_back (colour[i]);
+                instance_data.push_back (alpha ? edge_alpha_given_selection (edge) * edge_fixed_alpha : 1.0f);
+                ++instance_count;
+              }
+
+              edge_instance_buffer.gen();
+              edge_instance_buffer.bind (gl::ARRAY_BUFFER);
+              gl::BufferData (gl::ARRAY_BUFFER, instance_data.size() * sizeof (GLfloat), instance_data.size() ? &instance_data[0] : nullptr, gl::STREAM_DRAW);
+              const GLsizei stride = floats_per_instance * sizeof (GLfloat);
+              gl::EnableVertexAttribArray (2);
+              gl::VertexAttribPointer (2, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(0));
+              gl::EnableVertexAttribArray (3);
+              gl::VertexAttribPointer (3, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(3*sizeof(GLfloat)));
+              // A mat3 attribute occupies three consecutive locations,
+              //   one per column
+              gl::EnableVertexAttribArray (4);
+              gl::VertexAttribPointer (4, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(6*sizeof(GLfloat)));
+              gl::EnableVertexAttribArray (5);
+              gl::VertexAttribPointer (5, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(9*sizeof(GLfloat)));
+              gl::EnableVertexAttribArray (6);
+              gl::VertexAttribPointer (6, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(12*sizeof(GLfloat)));
+              gl::EnableVertexAttribArray (7);
+              gl::VertexAttribPointer (7, 1, gl::FLOAT, gl::FALSE_, stride, (void*)(15*sizeof(GLfloat)));
+              gl::EnableVertexAttribArray (8);
+              gl::VertexAttribPointer (8, 3, gl::FLOAT, gl::FALSE_, stride, (void*)(16*sizeof(GLfloat)));
+              gl::EnableVertexAttribArray (9);
+              gl::VertexAttribPointer (9, 1, gl::FLOAT, gl::FALSE_, stride, (void*)(19*sizeof(GLfloat)));
+              for (GLuint index = 2; index != 10; ++index)
+                gl::VertexAttribDivisor (index, 1);
+
+              if (instance_count) {
+                if (alpha) {
+                  gl::CullFace (gl::FRONT);
+                  gl::Uniform1f (gl::GetUniformLocation (edge_shader, "reverse_pass"), 1.0f);
+                  gl::DrawElementsInstanced (gl::TRIANGLES, cylinder.num_indices, gl::UNSIGNED_INT, (void*)0, instance_count);
+                  gl::CullFace (gl::BACK);
+                  gl::Uniform1f (gl::GetUniformLocation (edge_shader, "reverse_pass"), 0.0f);
+                }
+                gl::DrawElementsInstanced (gl::TRIANGLES, cylinder.num_indices, gl::UNSIGNED_INT, (void*)0, instance_count);
+              }
+
+            } else { // Per-edge geometries; these cannot be instanced
+
+              const GLuint edge_colour_ID = gl::GetUniformLocation (edge_shader, "edge_colour");
+
+              GLuint edge_alpha_ID = 0;
+              if (alpha)
+                edge_alpha_ID = gl::GetUniformLocation (edge_shader, "edge_alpha");
+
+              for (auto it = edge_ordering.rbegin(); it != edge_ordering.rend(); ++it) {
+                const Edge& edge (edges[it->second]);
+                if (edge_visibility_given_selection (edge)) {
+                  gl::Uniform3fv (edge_colour_ID, 1, edge_colour_given_selection (edge).data());
+                  if (alpha)
+                    gl::Uniform1f (edge_alpha_ID, edge_alpha_given_selection (edge) * edge_fixed_alpha);
+                  switch (edge_geometry) {
+                    case edge_geometry_t::LINE:
+                      gl::LineWidth (calc_line_width (edge_size_given_selection (edge) * edge_size_scale_factor, edge_geometry_line_smooth_checkbox->isChecked()));
+                      edge.render_line();
+                      break;
+                    case edge_geometry_t::CYLINDER:
+                      assert (0);
+                      break;
+                    case edge_geometry_t::STREAMLINE:
+                      gl::LineWidth (calc_line_width (edge_size_given_selection (edge) * edge_size_scale_factor, edge_geometry_line_smooth_checkbox->isChecked()));
+                      edge.render_streamline();
+                      break;
+                    case edge_geometry_t::STREAMTUBE:
+                      gl::Uniform1f (radius_ID, std::sqrt (edge_size_given_selection (edge) * edge_size_scale_factor / Math::pi));
+                      if (alpha) {
+                        gl::CullFace (gl::FRONT);
+                        gl::Uniform1f  (specular_ID, (1.0 - edge_alpha_given_selection (edge) * edge_fixed_alpha) * lighting.specular);
+                        edge.render_streamtube();
+                        gl::CullFace (gl::BACK);
+                        gl::Uniform1f  (specular_ID, lighting.specular);
+                      }
                       edge.render_streamtube();
-                      gl::CullFace (gl::BACK);
-                      gl::Uniform1f  (specular_ID, lighting.specular);
-                    }
-                    edge.render_streamtube();
+                  }
                 }
               }
+
             }
 
             // Reset to defaults if we've been doing transparency
@@ -279,6 +279,11 @@ namespace MR
             Shapes::Cylinder cylinder;
             GL::VertexArrayObject cylinder_VAO;
 
+            // Per-instance attribute data (re-filled on each draw call),
+            //   permitting all sphere / cube nodes and all cylinder edges
+            //   to each be drawn with a single instanced draw call
+            GL::VertexBuffer node_instance_buffer, edge_instance_buffer;
+
 
             // Settings related to slab cropping
             bool is_3D, crop_to_slab;
@@ -79,6 +79,11 @@ namespace MR
           const std::string GS_in  = is_3D ? "" : "_GSin";
           const std::string GS_out = is_3D ? "" : "_GSout";
 
+          // Sphere and cube geometries draw one canonical mesh per node via
+          //   instancing, with the per-node parameters supplied as
+          //   per-instance vertex attributes rather than uniforms
+          const bool instanced = (geometry == node_geometry_t::SPHERE || geometry == node_geometry_t::CUBE);
+
           vertex_shader_source =
               "layout (location = 0) in vec3 vertexPosition_modelspace;\n";
 
@@ -89,9 +94,24 @@ namespace MR
 
           vertex_shader_source +=
               "uniform mat4 MVP;\n"
-              "uniform mat4 MV;\n"
+              "uniform mat4 MV;\n";
+
+          if (instanced) {
+            vertex_shader_source +=
+              "layout (location = 2) in vec3 node_centre;\n"
+              "layout (location = 3) in float node_size;\n"
+              "layout (location = 4) in vec3 instance_colour;\n"
+              "layout (location = 5) in float instance_alpha;\n"
+              "out vec3 node_colour" + GS_in + ";\n";
+            if (use_alpha) {
+              vertex_shader_source +=
+              "out float node_alpha" + GS_in + ";\n";
+            }
+          } else {
+            vertex_shader_source +=
               "uniform vec3 node_centre;\n"
               "uniform float node_size;\n";
+          }
 
           if (geometry == node_geometry_t::SPHERE || geometry == node_geometry_t::CUBE || geometry == node_geometry_t::MESH) {
             vertex_shader_source +=
@@ -136,6 +156,15 @@ namespace MR
               break;
           }
 
+          if (instanced) {
+            vertex_shader_source +=
+              "  node_colour" + GS_in + " = instance_colour;\n";
+            if (use_alpha) {
+              vertex_shader_source +=
+              "  node_alpha" + GS_in + " = instance_alpha;\n";
+            }
+          }
+
           vertex_shader_source +=
               "  gl_Position = MVP * vec4 (pos, 1);\n";
 
@@ -168,6 +197,17 @@ namespace MR
                 "out vec3 normal" + GS_out + ";\n";
             }
 
+            if (instanced) {
+              geometry_shader_source +=
+                "in vec3 node_colour" + GS_in + "[3];\n"
+                "out vec3 node_colour" + GS_out + ";\n";
+              if (use_alpha) {
+                geometry_shader_source +=
+                "in float node_alpha" + GS_in + "[3];\n"
+                "out float node_alpha" + GS_out + ";\n";
+              }
+            }
+
             // Need to detect whether or not this triangle intersects the viewing plane
             // If it does, need to emit two vertices; one for each of the two interpolated
             //   points that intersect the viewing plane
@@ -180,7 +220,18 @@ namespace MR
                 "    float mu = depth[v1] / (depth[v1] - depth[v2]);\n"
                 "    if (mu >= 0.0 && mu <= 1.0) {\n"
                 "      gl_Position = gl_in[v1].gl_Position + (mu * (gl_in[v2].gl_Position - gl_in[v1].gl_Position));\n"
-                "      normal" + GS_out + " = normalize(((1.0 - mu) * normal" + GS_in + "[v1]) + (mu * normal" + GS_in + "[v2]));\n"
+                "      normal" + GS_out + " = normalize(((1.0 - mu) * normal" + GS_in + "[v1]) + (mu * normal" + GS_in + "[v2]));\n";
+
+            if (instanced) {
+              geometry_shader_source +=
+                "      node_colour" + GS_out + " = node_colour" + GS_in + "[v1];\n";
+              if (use_alpha) {
+                geometry_shader_source +=
+                "      node_alpha" + GS_out + " = node_alpha" + GS_in + "[v1];\n";
+              }
+            }
+
+            geometry_shader_source +=
                 "      EmitVertex();\n"
                 "    }\n"
                 "  }\n"
@@ -191,18 +242,39 @@ namespace MR
 
           // =================================================================
 
-          fragment_shader_source =
+          // These are constant per instance, so can be read from any vertex
+          const std::string FS_colour = "node_colour" + std::string (instanced ? GS_out : "");
+          const std::string FS_alpha  = "node_alpha"  + std::string (instanced ? GS_out : "");
+
+          if (instanced) {
+            fragment_shader_source =
+              "in vec3 " + FS_colour + ";\n";
+            if (use_alpha) {
+              fragment_shader_source +=
+              "in float " + FS_alpha + ";\n";
+            }
+          } else {
+            fragment_shader_source =
               "uniform vec3 node_colour;\n";
+            if (use_alpha) {
+              fragment_shader_source +=
+              "uniform float node_alpha;\n";
+            }
+          }
 
           if (use_alpha) {
             fragment_shader_source +=
-              "uniform float node_alpha;\n"
               "out vec4 color;\n";
           } else {
             fragment_shader_source +=
               "out vec3 color;\n";
           }
 
+          if (instanced && use_alpha && use_lighting) {
+            fragment_shader_source +=
+              "uniform float reverse_pass;\n";
+          }
+
           if (use_lighting) {
 
             fragment_shader_source +=
@@ -230,21 +302,29 @@ namespace MR
 
           if (use_alpha) {
             fragment_shader_source +=
-                "  color.rgb = node_colour;\n";
+                "  color.rgb = " + FS_colour + ";\n";
           } else {
             fragment_shader_source +=
-                "  color = node_colour;\n";
+                "  color = " + FS_colour + ";\n";
           }
 
           if (use_lighting) {
             fragment_shader_source +=
-              "  color *= ambient + diffuse * clamp (dot (normal" + GS_out + ", light_pos), 0, 1);\n"
+              "  color *= ambient + diffuse * clamp (dot (normal" + GS_out + ", light_pos), 0, 1);\n";
+            // When drawing the far surfaces of transparent nodes, the
+            //   specular component is attenuated according to opacity
+            if (instanced && use_alpha) {
+              fragment_shader_source +=
+              "  color += mix (specular, (1.0 - " + FS_alpha + ") * specular, reverse_pass) * pow (clamp (dot (reflect (-light_pos, normal" + GS_out + "), vec3(0.0,0.0,1.0)), 0, 1), shine);\n";
+            } else {
+              fragment_shader_source +=
               "  color += specular * pow (clamp (dot (reflect (-light_pos, normal" + GS_out + "), vec3(0.0,0.0,1.0)), 0, 1), shine);\n";
+            }
           }
 
           if (use_alpha) {
             fragment_shader_source +=
-              "  color.a = node_alpha;\n";
+              "  color.a = " + FS_alpha + ";\n";
           }
 
           fragment_shader_source +=
@@ -282,6 +362,11 @@ namespace MR
           const std::string GS_in  = is_3D ? "" : "_GSin";
           const std::string GS_out = is_3D ? "" : "_GSout";
 
+          // Cylinder geometry draws one canonical mesh per edge via
+          //   instancing, with the per-edge parameters supplied as
+          //   per-instance vertex attributes rather than uniforms
+          const bool instanced = (geometry == edge_geometry_t::CYLINDER);
+
           vertex_shader_source =
               "layout (location = 0) in vec3 vertexPosition_modelspace;\n"
               "uniform mat4 MVP;\n"
@@ -299,9 +384,17 @@ namespace MR
           if (geometry == edge_geometry_t::CYLINDER) {
             vertex_shader_source +=
               "layout (location = 1) in vec3 vertexNormal_modelspace;\n"
-              "uniform vec3 centre_one, centre_two;\n"
-              "uniform mat3 rot_matrix;\n"
-              "uniform float radius;\n";
+              "layout (location = 2) in vec3 centre_one;\n"
+              "layout (location = 3) in vec3 centre_two;\n"
+              "layout (location = 4) in mat3 rot_matrix;\n"
+              "layout (location = 7) in float radius;\n"
+              "layout (location = 8) in vec3 instance_colour;\n"
+              "layout (location = 9) in float instance_alpha;\n"
+              "out vec3 edge_colour" + GS_in + ";\n";
+            if (use_alpha) {
+              vertex_shader_source +=
+              "out float edge_alpha" + GS_in + ";\n";
+            }
             if (use_lighting) {
               vertex_shader_source +=
               "out vec3 normal" + GS_in + ";\n";
@@ -369,7 +462,12 @@ namespace MR
               "    offset[2] = 0.0;\n"
               "  }\n"
               "  offset = offset * rot_matrix;\n"
-              "  vec3 pos = centre + (radius * offset);\n";
+              "  vec3 pos = centre + (radius * offset);\n"
+              "  edge_colour" + GS_in + " = instance_colour;\n";
+              if (use_alpha) {
+              vertex_shader_source +=
+              "  edge_alpha" + GS_in + " = instance_alpha;\n";
+              }
               if (use_lighting) {
               vertex_shader_source +=
               "  normal" + GS_in + " = normalize (mat3(MV) * (vertexNormal_modelspace * rot_matrix));\n";
@@ -455,6 +553,17 @@ namespace MR
                 "out vec3 dir" + GS_out + ";\n";
             }
 
+            if (instanced) {
+              geometry_shader_source +=
+                "in vec3 edge_colour" + GS_in + "[3];\n"
+                "out vec3 edge_colour" + GS_out + ";\n";
+              if (use_alpha) {
+                geometry_shader_source +=
+                "in float edge_alpha" + GS_in + "[3];\n"
+                "out float edge_alpha" + GS_out + ";\n";
+              }
+            }
+
             geometry_shader_source +=
                 "void main() {\n";
 
@@ -494,6 +603,14 @@ namespace MR
                 geometry_shader_source +=
                 "      dir" + GS_out + " = normalize(((1.0 - mu) * dir" + GS_in + "[v1]) + (mu * dir" + GS_in + "[v2]));\n";
                 }
+                if (instanced) {
+                geometry_shader_source +=
+                "      edge_colour" + GS_out + " = edge_colour" + GS_in + "[v1];\n";
+                if (use_alpha) {
+                geometry_shader_source +=
+                "      edge_alpha" + GS_out + " = edge_alpha" + GS_in + "[v1];\n";
+                }
+                }
                 geometry_shader_source +=
                 "      EmitVertex();\n"
                 "    }\n"
@@ -509,18 +626,39 @@ namespace MR
 
           // =================================================================
 
-          fragment_shader_source =
+          // These are constant per instance, so can be read from any vertex
+          const std::string FS_colour = "edge_colour" + std::string (instanced ? GS_out : "");
+          const std::string FS_alpha  = "edge_alpha"  + std::string (instanced ? GS_out : "");
+
+          if (instanced) {
+            fragment_shader_source =
+              "in vec3 " + FS_colour + ";\n";
+            if (use_alpha) {
+              fragment_shader_source +=
+              "in float " + FS_alpha + ";\n";
+            }
+          } else {
+            fragment_shader_source =
               "uniform vec3 edge_colour;\n";
+            if (use_alpha) {
+              fragment_shader_source +=
+              "uniform float edge_alpha;\n";
+            }
+          }
 
           if (use_alpha) {
             fragment_shader_source +=
-              "uniform float edge_alpha;\n"
               "out vec4 color;\n";
           } else {
             fragment_shader_source +=
               "out vec3 color;\n";
           }
 
+          if (instanced && use_alpha && use_lighting) {
+            fragment_shader_source +=
+              "uniform float reverse_pass;\n";
+          }
+
           if (use_lighting) {
             fragment_shader_source +=
               "uniform float ambient, diffuse, specular, shine;\n"
@@ -565,10 +703,10 @@ namespace MR
 
             if (use_alpha) {
               fragment_shader_source +=
-              "  color.rgb = edge_colour;\n";
+              "  color.rgb = " + FS_colour + ";\n";
             } else {
               fragment_shader_source +=
-              "  color = edge_colour;\n";
+              "  color = " + FS_colour + ";\n";
             }
 
           }
@@ -576,8 +714,16 @@ namespace MR
           if (use_lighting) {
             if (geometry == edge_geometry_t::CYLINDER || geometry == edge_geometry_t::STREAMTUBE) {
               fragment_shader_source +=
-              "  color *= ambient + diffuse * clamp (dot (normal" + GS_out + ", light_pos), 0, 1);\n"
+              "  color *= ambient + diffuse * clamp (dot (normal" + GS_out + ", light_pos), 0, 1);\n";
+              // When drawing the far surfaces of transparent edges, the
+              //   specular component is attenuated according to opacity
+              if (instanced && use_alpha) {
+                fragment_shader_source +=
+              "  color += mix (specular, (1.0 - " + FS_alpha + ") * specular, reverse_pass) * pow (clamp (dot (reflect (-light_pos, normal" + GS_out + "), vec3(0.0,0.0,1.0)), 0, 1), shine);\n";
+              } else {
+                fragment_shader_source +=
               "  color += specular * pow (clamp (dot (reflect (-light_pos, normal" + GS_out + "), vec3(0.0,0.0,1.0)), 0, 1), shine);\n";
+              }
             } else { // Line and streamline
               fragment_shader_source +=
               "  vec3 t = normalize (tangent" + GS_out + ");\n"
@@ -595,7 +741,7 @@ namespace MR
 
           if (use_alpha) {
             fragment_shader_source +=
-              "  color.a = edge_alpha;\n";
+              "  color.a = " + FS_alpha + ";\n";
           }
 
           fragment_shader_source +=
@@ -37,7 +37,9 @@ namespace MR
           fixel_tool (fixel_tool),
           voxel_size_length_multipler (1.f),
           user_line_length_multiplier (1.f),
-          line_thickness (0.0015f)
+          line_thickness (0.0015f),
+          interp_grid_lock_to_grid (false),
+          interp_grid_dirty (true)
         {
           set_allowed_features (true, true, false);
           colourmap = 1;
@@ -281,6 +283,11 @@ namespace MR
           if (threshold_buffer_dirty)
             reload_threshold_buffer ();
 
+          // A change to any of the source buffers also invalidates the
+          //   derived crop-to-slice grid buffers
+          if (dir_buffer_dirty || value_buffer_dirty || colour_buffer_dirty || threshold_buffer_dirty)
+            interp_grid_dirty = true;
+
           dir_buffer_dirty = false;
           value_buffer_dirty = false;
           colour_buffer_dirty = false;
@@ -293,6 +300,24 @@ namespace MR
                                                const MR::Transform &transform)
         {
           ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+
+          // If neither the view nor any of the source buffers have changed
+          //   since the grid buffers were last generated, the data already on
+          //   the GPU remain valid; just rebind the vertex array state
+          if (!interp_grid_dirty
+              && !memcmp ((const GLfloat*) interp_grid_MVP, (const GLfloat*) projection.modelview_projection(), 16 * sizeof (GLfloat))
+              && interp_grid_target == Eigen::Vector3f (Window::main->target())
+              && interp_grid_focus == Eigen::Vector3f (Window::main->focus())
+              && interp_grid_lock_to_grid == fixel_tool.do_lock_to_grid) {
+            regular_grid_vao.bind ();
+            return;
+          }
+          interp_grid_MVP = projection.modelview_projection();
+          interp_grid_target = Window::main->target();
+          interp_grid_focus = Window::main->focus();
+          interp_grid_lock_to_grid = fixel_tool.do_lock_to_grid;
+          interp_grid_dirty = false;
+
           // Code below "inspired" by ODF::draw
           Eigen::Vector3f p (Window::main->target());
           p += projection.screen_normal() * (projection.screen_normal().dot (Window::main->focus() - p));
@@ -299,6 +299,16 @@ namespace MR
               float voxel_size_length_multipler;
               float user_line_length_multiplier;
               float line_thickness;
+
+              // View state for which the crop-to-slice grid buffers were
+              //   last generated, so that redraws that do not move the view
+              //   (e.g. threshold or scaling adjustments, which act entirely
+              //   through shader uniforms) can re-use the buffers already
+              //   resident on the GPU without any CPU-side geometry work
+              GL::mat4 interp_grid_MVP;
+              Eigen::Vector3f interp_grid_target, interp_grid_focus;
+              bool interp_grid_lock_to_grid;
+              bool interp_grid_dirty;
         };
 
 
@@ -331,35 +331,69 @@ namespace MR
             }
             Eigen::VectorXf r_del_daz;
 
-            for (int y = -ny; y <= ny; ++y) {
-              for (int x = -nx; x <= nx; ++x) {
-                Eigen::Vector3f p = pos + float(x)*x_dir + float(y)*y_dir;
-
-                // values gets shrunk by the previous get_values() call
-                if (settings->odf_type == odf_type_t::DIXEL && settings->dixel->dir_type == ODF_Item::DixelPlugin::dir_t::DW_SCHEME)
-                  values.resize (settings->image.header().size (3));
-
-                get_values (values, *settings, p, interpolation_box->isChecked());
-                if (!std::isfinite (values[0])) continue;
-
-                switch (settings->odf_type) {
-                  case odf_type_t::SH:
-                    if (values[0] == 0.0) continue;
-                    renderer->sh.compute_r_del_daz (r_del_daz, values.topRows (Math::SH::NforL (lmax)));
-                    renderer->sh.set_data (r_del_daz);
-                    break;
-                  case odf_type_t::TENSOR:
-                    renderer->tensor.set_data (values);
-                    break;
-                  case odf_type_t::DIXEL:
-                    renderer->dixel.set_data (values);
-                    break;
+            if (settings->odf_type == odf_type_t::SH) {
+
+              // Gather the SH coefficients of every glyph in the grid, and
+              //   apply the SH-to-amplitude transform to all of them in a
+              //   single matrix-matrix product; this is considerably faster
+              //   than the equivalent sequence of per-glyph matrix-vector
+              //   products, particularly at high levels of detail
+              const size_t nSH = Math::SH::NforL (lmax);
+              vector<Eigen::Vector3f> positions;
+              Eigen::MatrixXf SH_values ((2*nx+1) * size_t(2*ny+1), nSH);
+
+              for (int y = -ny; y <= ny; ++y) {
+                for (int x = -nx; x <= nx; ++x) {
+                  const Eigen::Vector3f p = pos + float(x)*x_dir + float(y)*y_dir;
+                  get_values (values, *settings, p, interpolation_box->isChecked());
+                  if (!std::isfinite (values[0]) || values[0] == 0.0) continue;
+                  SH_values.row (positions.size()) = values.topRows (nSH).transpose();
+                  positions.push_back (p);
                 }
+              }
 
+              SH_values.conservativeResize (positions.size(), nSH);
+              Eigen::MatrixXf r_del_daz_batch;
+              renderer->sh.compute_r_del_daz (r_del_daz_batch, SH_values);
+
+              for (size_t n = 0; n != positions.size(); ++n) {
+                r_del_daz = r_del_daz_batch.row (n);
+                renderer->sh.set_data (r_del_daz);
                 GL_CHECK_ERROR;
-                renderer->draw (p);
+                renderer->draw (positions[n]);
                 GL_CHECK_ERROR;
               }
+
+            } else {
+
+              for (int y = -ny; y <= ny; ++y) {
+                for (int x = -nx; x <= nx; ++x) {
+                  Eigen::Vector3f p = pos + float(x)*x_dir + float(y)*y_dir;
+
+                  // values gets shrunk by the previous get_values() call
+                  if (settings->odf_type == odf_type_t::DIXEL && settings->dixel->dir_type == ODF_Item::DixelPlugin::dir_t::DW_SCHEME)
+                    values.resize (settings->image.header().size (3));
+
+                  get_values (values, *settings, p, interpolation_box->isChecked());
+                  if (!std::isfinite (values[0])) continue;
+
+                  switch (settings->odf_type) {
+                    case odf_type_t::SH:
+                      break;
+                    case odf_type_t::TENSOR:
+                      renderer->tensor.set_data (values);
+                      break;
+                    case odf_type_t::DIXEL:
+                      renderer->dixel.set_data (values);
+                      break;
+                  }
+
+                  GL_CHECK_ERROR;
+                  renderer->draw (p);
+                  GL_CHECK_ERROR;
+                }
+              }
+
             }
 
             renderer->stop();
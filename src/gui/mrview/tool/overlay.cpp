@@ -15,12 +15,19 @@
 #include "gui/mrview/tool/overlay.h"
 
 #include "mrtrix.h"
+#include "gui/opengl/transformation.h"
 #include "gui/mrview/gui_image.h"
 #include "gui/mrview/window.h"
 #include "gui/mrview/mode/slice.h"
 #include "gui/dialog/file.h"
 #include "gui/mrview/tool/list_model_base.h"
 
+// Maximum number of overlay layers composited in a single draw call; kept
+//   comfortably below the minimum number of fragment shader texture image
+//   units the specification guarantees. Any further layers are rendered as
+//   additional composited passes
+#define MRVIEW_OVERLAY_COMPOSITE_MAX_LAYERS 8
+
 namespace MR
 {
   namespace GUI
@@ -35,7 +42,150 @@ namespace MR
         class Overlay::Item : public Image { MEMALIGN(Overlay::Item)
           public:
             Item (MR::Header&& H) : Image (std::move (H)) { }
-            Mode::Slice::Shader slice_shader; 
+            Mode::Slice::Shader slice_shader;
+        };
+
+
+        namespace {
+
+          // matrix mapping scanner-space positions directly onto the [0,1]^3
+          //   texture coordinates of an image, folding in the half-voxel
+          //   offset and grid size exactly as
+          //   Volume::set_vertices_for_slice_render does on the CPU
+          inline GL::mat4 get_scanner_to_tex_matrix (const ImageBase& image)
+          {
+            const auto M = image.transform().scanner2voxel.cast<float>();
+            GL::mat4 S2T;
+            for (size_t i = 0; i != 3; ++i) {
+              const float size = image.header().size (i);
+              for (size_t j = 0; j != 3; ++j)
+                S2T(i,j) = M(i,j) / size;
+              S2T(i,3) = (M(i,3) + 0.5f) / size;
+            }
+            S2T(3,0) = S2T(3,1) = S2T(3,2) = 0.0f;
+            S2T(3,3) = 1.0f;
+            return S2T;
+          }
+
+        }
+
+
+        // Shader sampling several overlay layers in a single pass over the
+        //   slice, rather than one full-screen pass per layer: the per-layer
+        //   logic of Mode::Slice::Shader is repeated inline with prefixed
+        //   uniforms (mirroring the overlay handling in the volume render
+        //   shader), and layers are blended back-to-front within the
+        //   fragment shader exactly as successive passes would be; the
+        //   accumulated colour is emitted premultiplied
+        class Overlay::CompositeShader : public Displayable::Shader { MEMALIGN(Overlay::CompositeShader)
+          public:
+            vector<Item*> layers;
+
+            std::string vertex_shader_source (const Displayable&) override
+            {
+              std::string source =
+                "layout(location = 0) in vec3 vertpos;\n"
+                "uniform mat4 MVP;\n";
+              for (size_t n = 0; n != layers.size(); ++n)
+                source +=
+                  "uniform mat4 layer"+str(n)+"_T;\n"
+                  "out vec3 layer"+str(n)+"_texcoord;\n";
+              source +=
+                "void main() {\n"
+                "  gl_Position = MVP * vec4 (vertpos,1);\n";
+              for (size_t n = 0; n != layers.size(); ++n)
+                source +=
+                  "  layer"+str(n)+"_texcoord = (layer"+str(n)+"_T * vec4 (vertpos,1)).xyz;\n";
+              source += "}\n";
+              return source;
+            }
+
+            std::string fragment_shader_source (const Displayable&) override
+            {
+              std::string source;
+              for (size_t n = 0; n != layers.size(); ++n)
+                source += layers[n]->declare_shader_variables ("layer"+str(n)+"_") +
+                  "uniform sampler3D layer"+str(n)+"_tex;\n"
+                  "in vec3 layer"+str(n)+"_texcoord;\n";
+
+              source +=
+                "out vec4 final_color;\n"
+                "void main() {\n"
+                "  float amplitude;\n"
+                "  vec4 color;\n"
+                "  final_color = vec4 (0.0);\n";
+
+              for (size_t n = 0; n != layers.size(); ++n) {
+                const Item* layer = layers[n];
+                const std::string p ("layer"+str(n)+"_");
+                source +=
+                  "  if ("+p+"texcoord.s >= 0.0 && "+p+"texcoord.s <= 1.0 &&\n"
+                  "      "+p+"texcoord.t >= 0.0 && "+p+"texcoord.t <= 1.0 &&\n"
+                  "      "+p+"texcoord.p >= 0.0 && "+p+"texcoord.p <= 1.0) {\n"
+                  "    color = texture ("+p+"tex, "+p+"texcoord.stp);\n"
+                  "    amplitude = " + std::string (ColourMap::maps[layer->colourmap].amplitude) + ";\n"
+                  "    if (!isnan(amplitude) && !isinf(amplitude)";
+
+                if (layer->use_discard_lower())
+                  source += " && amplitude >= "+p+"lower";
+
+                if (layer->use_discard_upper())
+                  source += " && amplitude <= "+p+"upper";
+
+                if (layer->use_transparency())
+                  source += " && amplitude >= "+p+"alpha_offset";
+
+                source += ") {\n";
+
+                if (layer->use_transparency())
+                  source += "      color.a = clamp ((amplitude - "+p+"alpha_offset) * "+p+"alpha_scale, 0, "+p+"alpha);\n";
+                else
+                  source += "      color.a = 1.0;\n";
+
+                if (!ColourMap::maps[layer->colourmap].special) {
+                  source += "      amplitude = clamp (";
+                  if (layer->scale_inverted())
+                    source += "1.0 -";
+                  source += " "+p+"scale * (amplitude - "+p+"offset), 0.0, 1.0);\n";
+                }
+
+                std::string mapping (ColourMap::maps[layer->colourmap].glsl_mapping);
+                replace (mapping, "scale", p+"scale");
+                replace (mapping, "offset", p+"offset");
+                replace (mapping, "colourmap_colour", p+"colourmap_colour");
+                source += "      " + mapping;
+
+                source +=
+                  "      final_color.rgb = color.a * color.rgb + (1.0 - color.a) * final_color.rgb;\n"
+                  "      final_color.a = color.a + (1.0 - color.a) * final_color.a;\n"
+                  "    }\n"
+                  "  }\n";
+              }
+
+              source += "}\n";
+              return source;
+            }
+
+            bool need_update (const Displayable& object) const override
+            {
+              if (layers.size() != layer_states.size())
+                return true;
+              for (size_t n = 0; n != layers.size(); ++n)
+                if (layers[n]->flags() != layer_states[n].first || layers[n]->colourmap != layer_states[n].second)
+                  return true;
+              return Displayable::Shader::need_update (object);
+            }
+
+            void update (const Displayable& object) override
+            {
+              layer_states.clear();
+              for (const auto& layer : layers)
+                layer_states.push_back ({ layer->flags(), layer->colourmap });
+              Displayable::Shader::update (object);
+            }
+
+          protected:
+            vector<std::pair<uint32_t, size_t>> layer_states;
         };
 
 
@@ -194,6 +344,9 @@ namespace MR
           }
 
 
+        Overlay::~Overlay () { }
+
+
         void Overlay::image_open_slot ()
         {
           vector<std::string> overlay_names = Dialog::File::get_images (this, "Select overlay images to open");
@@ -278,15 +431,36 @@ namespace MR
           }
 
           bool need_to_update = false;
+          vector<Item*> layers;
           for (int i = 0; i < image_list_model->rowCount(); ++i) {
             if (image_list_model->items[i]->show && !hide_all_button->isChecked()) {
               Overlay::Item* image = dynamic_cast<Overlay::Item*>(image_list_model->items[i].get());
               need_to_update |= !std::isfinite (image->intensity_min());
               image->transparent_intensity = image->opaque_intensity = image->intensity_min();
-              if (is_3D) 
+              if (is_3D)
                 window().get_current_mode()->overlays_for_3D.push_back (image);
               else
-                image->render3D (image->slice_shader, projection, projection.depth_of (window().focus()));
+                layers.push_back (image);
+            }
+          }
+
+          if (layers.size() == 1) {
+            layers.front()->render3D (layers.front()->slice_shader, projection, projection.depth_of (window().focus()));
+          }
+          else if (layers.size()) {
+            // composite all layers in as few passes as possible, so that
+            //   redraw cost no longer scales with the number of loaded
+            //   overlays; one shader is retained per batch so that a stable
+            //   layer configuration never triggers recompilation
+            const size_t num_batches = (layers.size() + MRVIEW_OVERLAY_COMPOSITE_MAX_LAYERS - 1) / MRVIEW_OVERLAY_COMPOSITE_MAX_LAYERS;
+            composite_shaders.resize (std::max (composite_shaders.size(), num_batches));
+            for (size_t batch = 0; batch != num_batches; ++batch) {
+              const size_t from = batch * MRVIEW_OVERLAY_COMPOSITE_MAX_LAYERS;
+              vector<Item*> subset (layers.begin() + from,
+                  layers.begin() + std::min (from + MRVIEW_OVERLAY_COMPOSITE_MAX_LAYERS, layers.size()));
+              if (!composite_shaders[batch])
+                composite_shaders[batch].reset (new CompositeShader);
+              draw_composited (subset, *composite_shaders[batch], projection, projection.depth_of (window().focus()));
             }
           }
 
@@ -303,6 +477,66 @@ namespace MR
         }
 
 
+        void Overlay::draw_composited (vector<Item*>& layers, CompositeShader& shader, const Projection& projection, float depth)
+        {
+          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          assert (layers.size());
+          shader.layers = layers;
+
+          for (size_t n = 0; n != layers.size(); ++n) {
+            gl::ActiveTexture (gl::TEXTURE0 + n);
+            gl::BindTexture (gl::TEXTURE_3D, layers[n]->texture());
+            layers[n]->update_texture3D();
+            layers[n]->texture().set_interp_on (layers[n]->interpolate());
+          }
+
+          // the first layer drives shader recompilation and uploads its own
+          //   uniforms; those of the remaining layers are uploaded explicitly
+          layers.front()->start (shader, layers.front()->scale_factor(), "layer0_");
+          projection.set (shader);
+
+          for (size_t n = 0; n != layers.size(); ++n) {
+            gl::Uniform1i (gl::GetUniformLocation (shader, ("layer"+str(n)+"_tex").c_str()), n);
+            gl::UniformMatrix4fv (gl::GetUniformLocation (shader, ("layer"+str(n)+"_T").c_str()), 1, gl::FALSE_,
+                get_scanner_to_tex_matrix (*layers[n]));
+            if (n)
+              layers[n]->set_shader_variables (shader, layers[n]->scale_factor(), "layer"+str(n)+"_");
+          }
+
+          // the shader emits premultiplied colour
+          gl::BlendFunc (gl::ONE, gl::ONE_MINUS_SRC_ALPHA);
+
+          Eigen::Vector3f corners[4];
+          corners[0] = projection.screen_to_model (projection.x_position(), projection.y_position()+projection.height(), depth);
+          corners[1] = projection.screen_to_model (projection.x_position(), projection.y_position(), depth);
+          corners[2] = projection.screen_to_model (projection.x_position()+projection.width(), projection.y_position(), depth);
+          corners[3] = projection.screen_to_model (projection.x_position()+projection.width(), projection.y_position()+projection.height(), depth);
+
+          if (!composite_VB || !composite_VAO) {
+            composite_VB.gen();
+            composite_VAO.gen();
+
+            composite_VB.bind (gl::ARRAY_BUFFER);
+            composite_VAO.bind();
+
+            gl::EnableVertexAttribArray (0);
+            gl::VertexAttribPointer (0, 3, gl::FLOAT, gl::FALSE_, sizeof(Eigen::Vector3f), (void*)0);
+          }
+          else {
+            composite_VB.bind (gl::ARRAY_BUFFER);
+            composite_VAO.bind();
+          }
+
+          gl::BufferData (gl::ARRAY_BUFFER, 4*sizeof(Eigen::Vector3f), &corners[0][0], gl::STREAM_DRAW);
+          gl::DrawArrays (gl::TRIANGLE_FAN, 0, 4);
+
+          layers.front()->stop (shader);
+          gl::BlendFunc (gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+          gl::ActiveTexture (gl::TEXTURE0);
+          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+        }
+
+
         size_t Overlay::visible_number_colourbars () {
            size_t total_visible(0);
 
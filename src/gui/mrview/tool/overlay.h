@@ -37,6 +37,7 @@ namespace MR
           public:
 
             Overlay (Dock* parent);
+            ~Overlay ();
 
             void draw (const Projection& projection, bool is_3D, int axis, int slice) override;
             void draw_colourbars () override;
@@ -74,6 +75,7 @@ namespace MR
           protected:
              class Item;
              class Model;
+             class CompositeShader;
              class InterpolateCheckBox : public QCheckBox
              { NOMEMALIGN
                public:
@@ -98,6 +100,11 @@ namespace MR
              InterpolateCheckBox* interpolate_check_box;
              QSlider *opacity_slider;
 
+             vector<std::unique_ptr<CompositeShader>> composite_shaders;
+             GL::VertexBuffer composite_VB;
+             GL::VertexArrayObject composite_VAO;
+
+             void draw_composited (vector<Item*>& layers, CompositeShader& shader, const Projection& projection, float depth);
              void update_selection ();
              void updateGL() { 
                window().get_current_mode()->update_overlays = true;
@@ -171,7 +171,10 @@ namespace MR
           tex_size (r.tex_size),
           slice_axes (r.slice_axes),
           before (std::move (r.before)),
-          after (std::move (r.after))
+          after (std::move (r.after)),
+          prev_rect_from (r.prev_rect_from),
+          prev_rect_to (r.prev_rect_to),
+          have_prev_rect (r.have_prev_rect)
         {
           assert (shared);
           ++(*shared);
@@ -196,12 +199,46 @@ namespace MR
           slice_axes = r.slice_axes;
           before = std::move (r.before);
           after = std::move (r.after);
+          prev_rect_from = r.prev_rect_from;
+          prev_rect_to = r.prev_rect_to;
+          have_prev_rect = r.have_prev_rect;
           return *this;
         }
 
 
 
 
+        void ROI_UndoEntry::upload (ROI_Item& roi, const vector<GLubyte>& data,
+                                    std::array<GLint,3> dirty_from, std::array<GLint,3> dirty_to)
+        {
+          for (size_t axis = 0; axis != 3; ++axis) {
+            dirty_from[axis] = std::max (dirty_from[axis], from[axis]);
+            dirty_to[axis] = std::min (dirty_to[axis], from[axis] + size[axis]);
+            if (dirty_from[axis] >= dirty_to[axis])
+              return;
+          }
+          // point at the first dirty voxel, and use the unpack strides to step
+          //   through the rows of the full slice buffer
+          const GLubyte* const ptr = &data[0]
+              + (dirty_from[0]-from[0])
+              + size_t(size[0]) * ((dirty_from[1]-from[1]) + size_t(size[1]) * (dirty_from[2]-from[2]));
+          MRView::GrabContext context;
+          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          roi.texture().bind();
+          gl::PixelStorei (gl::UNPACK_ALIGNMENT, 1);
+          gl::PixelStorei (gl::UNPACK_ROW_LENGTH, size[0]);
+          gl::PixelStorei (gl::UNPACK_IMAGE_HEIGHT, size[1]);
+          gl::TexSubImage3D (gl::TEXTURE_3D, 0, dirty_from[0], dirty_from[1], dirty_from[2],
+              dirty_to[0]-dirty_from[0], dirty_to[1]-dirty_from[1], dirty_to[2]-dirty_from[2],
+              gl::RED, gl::UNSIGNED_BYTE, (void*) ptr);
+          gl::PixelStorei (gl::UNPACK_ROW_LENGTH, 0);
+          gl::PixelStorei (gl::UNPACK_IMAGE_HEIGHT, 0);
+          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+        }
+
+
+
+
         void ROI_UndoEntry::draw_line (ROI_Item& roi, const Eigen::Vector3f& prev_pos, const Eigen::Vector3f& pos, const bool insert_mode_value)
         {
           const GLubyte value = insert_mode_value ? 1 : 0;
@@ -210,9 +247,16 @@ namespace MR
           const Eigen::Vector3f dir ((final_pos - p).normalized());
           Eigen::Array3i v (int(std::round (p[0])), int(std::round (p[1])), int(std::round (p[2])));
           const Eigen::Array3i final_vox (int(std::round (final_pos[0])), int(std::round (final_pos[1])), int(std::round (final_pos[2])));
+          std::array<GLint,3> dirty_from = { { std::numeric_limits<GLint>::max(), std::numeric_limits<GLint>::max(), std::numeric_limits<GLint>::max() } };
+          std::array<GLint,3> dirty_to   = { { std::numeric_limits<GLint>::min(), std::numeric_limits<GLint>::min(), std::numeric_limits<GLint>::min() } };
           do {
-            if (v[0] >= 0 && v[0] < roi.header().size(0) && v[1] >= 0 && v[1] < roi.header().size(1) && v[2] >= 0 && v[2] < roi.header().size(2))
+            if (v[0] >= 0 && v[0] < roi.header().size(0) && v[1] >= 0 && v[1] < roi.header().size(1) && v[2] >= 0 && v[2] < roi.header().size(2)) {
               after[v[0]-from[0] + size[0] * (v[1]-from[1] + size[1] * (v[2]-from[2]))] = value;
+              for (size_t axis = 0; axis != 3; ++axis) {
+                dirty_from[axis] = std::min (dirty_from[axis], GLint(v[axis]));
+                dirty_to[axis]   = std::max (dirty_to[axis],   GLint(v[axis]+1));
+              }
+            }
             if ((v - final_vox).abs().maxCoeff()) {
               Eigen::Array3i step (0, 0, 0);
               float min_multiplier = std::numeric_limits<float>::infinity();
@@ -233,11 +277,7 @@ namespace MR
             }
           } while ((v - final_vox).abs().maxCoeff());
 
-          MRView::GrabContext context;
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
-          roi.texture().bind();
-          gl::TexSubImage3D (gl::TEXTURE_3D, 0, from[0], from[1], from[2], size[0], size[1], size[2], gl::RED, gl::UNSIGNED_BYTE, (void*) (&after[0]));
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          upload (roi, after, dirty_from, dirty_to);
         }
 
 
@@ -279,11 +319,9 @@ namespace MR
 
           } } }
 
-          MRView::GrabContext context;
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
-          roi.texture().bind();
-          gl::TexSubImage3D (gl::TEXTURE_3D, 0, from[0], from[1], from[2], size[0], size[1], size[2], gl::RED, gl::UNSIGNED_BYTE, (void*) (&after[0]));
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          upload (roi, after,
+              { { GLint(a[0]), GLint(a[1]), GLint(a[2]) } },
+              { { GLint(b[0]), GLint(b[1]), GLint(b[2]) } });
         }
 
 
@@ -314,11 +352,9 @@ namespace MR
                     Math::pow2 (roi.header().spacing(2) * (vox[2]-k)) < radius_sq)
                   after[i-from[0] + size[0] * (j-from[1] + size[1] * (k-from[2]))] = value;
 
-          MRView::GrabContext context;
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
-          roi.texture().bind();
-          gl::TexSubImage3D (gl::TEXTURE_3D, 0, from[0], from[1], from[2], size[0], size[1], size[2], gl::RED, gl::UNSIGNED_BYTE, (void*) (&after[0]));
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          upload (roi, after,
+              { { GLint(a[0]), GLint(a[1]), GLint(a[2]) } },
+              { { GLint(b[0]), GLint(b[1]), GLint(b[2]) } });
         }
 
 
@@ -347,11 +383,22 @@ namespace MR
               for (int i = a[0]; i <= b[0]; ++i)
                 after[i-from[0] + size[0] * (j-from[1] + size[1] * (k-from[2]))] = value;
 
-          MRView::GrabContext context;
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
-          roi.texture().bind();
-          gl::TexSubImage3D (gl::TEXTURE_3D, 0, from[0], from[1], from[2], size[0], size[1], size[2], gl::RED, gl::UNSIGNED_BYTE, (void*) (&after[0]));
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          // a rectangle redrawn while dragging also reverts the voxels
+          //   covered on the previous event, so upload the union of the
+          //   current and previous extents
+          std::array<GLint,3> dirty_from = { { GLint(a[0]), GLint(a[1]), GLint(a[2]) } };
+          std::array<GLint,3> dirty_to   = { { GLint(b[0]+1), GLint(b[1]+1), GLint(b[2]+1) } };
+          if (have_prev_rect) {
+            for (size_t axis = 0; axis != 3; ++axis) {
+              dirty_from[axis] = std::min (dirty_from[axis], prev_rect_from[axis]);
+              dirty_to[axis]   = std::max (dirty_to[axis],   prev_rect_to[axis]);
+            }
+          }
+          prev_rect_from = { { GLint(a[0]), GLint(a[1]), GLint(a[2]) } };
+          prev_rect_to   = { { GLint(b[0]+1), GLint(b[1]+1), GLint(b[2]+1) } };
+          have_prev_rect = true;
+
+          upload (roi, after, dirty_from, dirty_to);
         }
 
 
@@ -369,6 +416,8 @@ namespace MR
           const bool existing_value = after[seed_index];
           if (existing_value == insert_mode_value) return;
           after[seed_index] = fill_value;
+          std::array<GLint,3> dirty_from = { { GLint(seed_voxel[0]), GLint(seed_voxel[1]), GLint(seed_voxel[2]) } };
+          std::array<GLint,3> dirty_to   = { { GLint(seed_voxel[0]+1), GLint(seed_voxel[1]+1), GLint(seed_voxel[2]+1) } };
           vector<std::array<int,3>> buffer (1, seed_voxel);
           while (buffer.size()) {
             const std::array<int,3> v (buffer.back());
@@ -386,16 +435,16 @@ namespace MR
                 const bool adj_value = after[adj_index];
                 if (adj_value != insert_mode_value) {
                   after[adj_index] = fill_value;
+                  for (size_t axis = 0; axis != 3; ++axis) {
+                    dirty_from[axis] = std::min (dirty_from[axis], GLint(adj[axis]));
+                    dirty_to[axis]   = std::max (dirty_to[axis],   GLint(adj[axis]+1));
+                  }
                   buffer.push_back (adj);
                 }
               }
             }
           }
-          MRView::GrabContext context;
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
-          roi.texture().bind();
-          gl::TexSubImage3D (gl::TEXTURE_3D, 0, from[0], from[1], from[2], size[0], size[1], size[2], gl::RED, gl::UNSIGNED_BYTE, (void*) (&after[0]));
-          ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+          upload (roi, after, dirty_from, dirty_to);
         }
 
 
@@ -61,6 +61,21 @@ namespace MR
           std::array<GLint,2> tex_size, slice_axes;
           vector<GLubyte> before, after;
 
+          //! extent of the rectangle uploaded by the previous draw_rectangle()
+          //  call for this entry; a redrawn rectangle must also re-upload the
+          //  region it previously covered
+          std::array<GLint,3> prev_rect_from, prev_rect_to;
+          bool have_prev_rect = false;
+
+          //! upload a sub-region of the slice buffer to the ROI texture
+          /*! \a dirty_from and \a dirty_to delimit (half-open, in voxel
+           * coordinates) the bounding box of the voxels modified by the
+           * current operation; only those rows of \a data are pushed via
+           * glTexSubImage3D, rather than re-uploading the whole slice on
+           * every brush event */
+          void upload (ROI_Item& roi, const vector<GLubyte>& data,
+                       std::array<GLint,3> dirty_from, std::array<GLint,3> dirty_to);
+
           class Shared
           { MEMALIGN(Shared)
             public:
@@ -283,6 +283,45 @@ namespace MR
 
 
 
+        Capture::FrameEncoder::~FrameEncoder()
+        {
+          {
+            std::lock_guard<std::mutex> lock (mutex);
+            stop = true;
+          }
+          condition.notify_all();
+          thread.join();
+        }
+
+
+        void Capture::FrameEncoder::enqueue (const QImage& image, const std::string& filename)
+        {
+          std::unique_lock<std::mutex> lock (mutex);
+          condition.wait (lock, [this] { return queue.size() < max_queued_frames; });
+          queue.emplace_back (image, filename);
+          condition.notify_all();
+        }
+
+
+        void Capture::FrameEncoder::execute()
+        {
+          std::unique_lock<std::mutex> lock (mutex);
+          while (queue.size() || !stop) {
+            condition.wait (lock, [this] { return queue.size() || stop; });
+            while (queue.size()) {
+              const std::pair<QImage, std::string> frame (std::move (queue.front()));
+              queue.pop_front();
+              condition.notify_all();
+              lock.unlock();
+              frame.first.save (frame.second.c_str());
+              lock.lock();
+            }
+          }
+        }
+
+
+
+
         void Capture::run (bool with_capture)
         {
           Window& win (window ());
@@ -338,12 +377,19 @@ namespace MR
             volume_inc = target_volume->value() / (float)frames_value;
           }
 
+          // Frame readback remains on the GUI thread (it requires the GL
+          //   context), but compression and file output are handed off to a
+          //   background thread, so rendering of the next frame can proceed
+          //   while the previous one is being encoded
+          if (with_capture)
+            encoder.reset (new FrameEncoder);
+
           for (size_t i = first_index; i < first_index + frames_value; ++i) {
             if (!is_playing)
               break;
 
             if (with_capture)
-              win.captureGL (Path::join (folder, prefix + printf ("%04d.png", i)));
+              encoder->enqueue (win.framegrab(), Path::join (folder, prefix + printf ("%04d.png", i)));
 
             // Rotation
             Math::Versorf orientation (win.orientation());
@@ -420,7 +466,10 @@ namespace MR
             start_index->setValue (i + 1);
             this->window().updateGL();
             qApp->processEvents();
-          } 
+          }
+
+          // Blocks until any frames still queued have been written
+          encoder.reset();
 
           is_playing = false;
         }
@@ -15,7 +15,11 @@
 #ifndef __gui_mrview_tool_screen_capture_h__
 #define __gui_mrview_tool_screen_capture_h__
 
+#include <condition_variable>
 #include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 #include "math/versor.h"
 
@@ -104,6 +108,29 @@ namespace MR
             constexpr static size_t max_cache_size = 1;
             std::deque<CaptureState> cached_state;
 
+            // Encodes and writes captured frames on a background thread,
+            //   so that the GUI thread never blocks on image compression
+            class FrameEncoder { NOMEMALIGN
+              public:
+                FrameEncoder() :
+                    stop (false),
+                    thread (&FrameEncoder::execute, this) { }
+                ~FrameEncoder();
+                void enqueue (const QImage&, const std::string& filename);
+              private:
+                // Bound the queue so that a long capture cannot accumulate
+                //   an arbitrary number of raw frames in memory if encoding
+                //   falls behind rendering
+                constexpr static size_t max_queued_frames = 8;
+                std::deque<std::pair<QImage, std::string>> queue;
+                std::mutex mutex;
+                std::condition_variable condition;
+                bool stop;
+                std::thread thread;
+                void execute();
+            };
+            std::unique_ptr<FrameEncoder> encoder;
+
             void run (bool with_capture);
             void cache_capture_state ();
         };
@@ -430,18 +430,18 @@ namespace MR
             gl::Disable (gl::DEPTH_TEST);
             gl::DepthMask (gl::TRUE_);
             gl::BlendColor (1.0, 1.0, 1.0,  tractography_tool.line_opacity / 0.5);
-            render_streamlines();
+            render_streamlines (transform);
             gl::BlendFunc (gl::CONSTANT_ALPHA, gl::ONE_MINUS_CONSTANT_ALPHA);
             gl::Enable (gl::DEPTH_TEST);
             gl::DepthMask (gl::TRUE_);
             gl::BlendColor (1.0, 1.0, 1.0, tractography_tool.line_opacity / 0.5);
-            render_streamlines();
+            render_streamlines (transform);
 
           } else {
             gl::Disable (gl::BLEND);
             gl::Enable (gl::DEPTH_TEST);
             gl::DepthMask (gl::TRUE_);
-            render_streamlines();
+            render_streamlines (transform);
           }
 
           if (tractography_tool.line_opacity < 1.0) {
@@ -457,14 +457,22 @@ namespace MR
 
 
 
-        inline void Tractogram::render_streamlines ()
+        inline void Tractogram::render_streamlines (const Projection& projection)
         {
           ASSERT_GL_MRVIEW_CONTEXT_IS_CURRENT;
+
+          if (should_update_stride)
+            update_stride();
+
           for (size_t buf = 0, N = vertex_buffers.size(); buf < N; ++buf) {
-            gl::BindVertexArray (vertex_array_objects[buf]);
 
-            if (should_update_stride)
-              update_stride();
+            // Skip buffers whose bounding box lies entirely outside the view;
+            //   when the vertex array state is stale it must nonetheless be
+            //   refreshed below, so culling is only applied once it is clean
+            if (!vao_dirty && !is_visible (bounding_boxes[buf], projection))
+              continue;
+
+            gl::BindVertexArray (vertex_array_objects[buf]);
 
             if (vao_dirty) {
 
@@ -512,12 +520,49 @@ namespace MR
 
 
 
+        inline bool Tractogram::is_visible (const std::pair<Eigen::Vector3f, Eigen::Vector3f>& box, const Projection& projection) const
+        {
+          const GL::mat4& MVP (projection.modelview_projection());
+
+          // Transform the eight corners of the bounding box into clip space;
+          //   the box is conservatively treated as visible unless all eight
+          //   corners fall beyond the same clip plane
+          GL::vec4 corners[8];
+          for (size_t n = 0; n != 8; ++n) {
+            const Eigen::Vector3f corner ((n&1U) ? box.second[0] : box.first[0],
+                                          (n&2U) ? box.second[1] : box.first[1],
+                                          (n&4U) ? box.second[2] : box.first[2]);
+            corners[n] = MVP * GL::vec4 (corner, 1.0f);
+          }
+
+          for (size_t axis = 0; axis != 3; ++axis) {
+            size_t num_below = 0, num_above = 0;
+            for (size_t n = 0; n != 8; ++n) {
+              if (corners[n][axis] < -corners[n][3]) ++num_below;
+              if (corners[n][axis] >  corners[n][3]) ++num_above;
+            }
+            if (num_below == 8 || num_above == 8)
+              return false;
+          }
+
+          return true;
+        }
+
+
+
+
         inline void Tractogram::update_stride ()
         {
           const float step_size = DWI::Tractography::get_step_size (properties);
           GLint new_stride = 1;
           if (std::isfinite (step_size)) {
-            new_stride = GLint (tractography_tool.line_thickness * original_fov / step_size);
+            // Screen-space error criterion: vertices can be skipped for as
+            //   long as the inter-vertex distance remains below the on-screen
+            //   footprint of the line thickness; the world-space distance to
+            //   which that corresponds scales with the field of view, so
+            //   zooming out permits coarser sampling, while zooming back in
+            //   restores the full vertex resolution
+            new_stride = GLint (tractography_tool.line_thickness * std::max (original_fov, float (window().FOV())) / step_size);
             new_stride = std::max (1, std::min (max_sample_stride, new_stride));
           }
 
@@ -888,6 +933,13 @@ namespace MR
           gl::BindBuffer (gl::ARRAY_BUFFER, vertexbuffer);
           gl::BufferData (gl::ARRAY_BUFFER, buffer.size() * sizeof(Eigen::Vector3f), &buffer[0][0], gl::STATIC_DRAW);
 
+          Eigen::Vector3f lower (buffer.front()), upper (buffer.front());
+          for (const auto& p : buffer) {
+            lower = lower.cwiseMin (p);
+            upper = upper.cwiseMax (p);
+          }
+          bounding_boxes.push_back (std::make_pair (lower, upper));
+
           vertex_array_objects.push_back (vertex_array_object);
           vertex_buffers.push_back (vertexbuffer);
           track_starts.push_back (starts);
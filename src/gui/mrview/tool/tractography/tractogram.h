@@ -138,6 +138,10 @@ namespace MR
             vector<vector<GLint> > original_track_sizes;
             vector<vector<GLint> > original_track_starts;
             vector<size_t> num_tracks_per_buffer;
+            // Axis-aligned bounding box (lower & upper corners) of the
+            //   streamline vertices within each buffer, used to skip whole
+            //   buffers that lie outside the current view
+            vector<std::pair<Eigen::Vector3f, Eigen::Vector3f> > bounding_boxes;
             GLint sample_stride;
             float line_thickness_screenspace;
             bool vao_dirty;
@@ -157,7 +161,9 @@ namespace MR
             void load_intensity_scalars_onto_GPU (vector<float>& buffer);
             void load_threshold_scalars_onto_GPU (vector<float>& buffer);
 
-            void render_streamlines ();
+            void render_streamlines (const Projection&);
+
+            bool is_visible (const std::pair<Eigen::Vector3f, Eigen::Vector3f>&, const Projection&) const;
 
             void update_stride ();
 
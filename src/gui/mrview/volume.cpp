@@ -30,6 +30,8 @@ namespace MR
         _texture.clear();
         vertex_buffer.clear();
         vertex_array_object.clear();
+        pixel_buffer[0].clear();
+        pixel_buffer[1].clear();
       }
 
       void Volume::allocate ()
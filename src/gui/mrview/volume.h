@@ -15,11 +15,14 @@
 #ifndef __gui_mrview_volume_h__
 #define __gui_mrview_volume_h__
 
+#include <cstring>
+
 #include "header.h"
 #include "transform.h"
 
 #include "file/config.h"
 #include "gui/opengl/gl.h"
+#include "gui/opengl/transformation.h"
 #include "gui/mrview/displayable.h"
 
 
@@ -45,7 +48,8 @@ namespace MR
               //CONF default: true
               //CONF Define default interplation setting for image and image overlay.
               interpolation (File::Config::get_bool("ImageInterpolation", true) ? gl::LINEAR : gl::NEAREST),
-              texture_mode_changed (true) { }
+              texture_mode_changed (true),
+              current_pixel_buffer (0) { }
 
           virtual ~Volume();
 
@@ -68,6 +72,25 @@ namespace MR
             stop (shader_program);
           }
 
+          //! render a batch of slice quads in a single draw call
+          /*! \a vertices interleaves {position, texture coordinate} pairs,
+           * with three pairs per triangle; positions must already be
+           * expressed in normalised device coordinates of the current
+           * viewport, since the modelview-projection matrix is set to
+           * identity. Used by modes that display many slices of the same
+           * volume per frame (see Mode::LightBox), replacing one full
+           * pipeline invocation per slice with a single pass. */
+          void render_batch (Displayable::Shader& shader_program, const vector<Eigen::Vector3f>& vertices) {
+            if (vertices.empty())
+              return;
+            assert (!(vertices.size() % 6));
+            start (shader_program, _scale_factor);
+            gl::UniformMatrix4fv (gl::GetUniformLocation (shader_program, "MVP"), 1, gl::FALSE_, GL::identity());
+            _texture.bind();
+            draw_batch_vertices (vertices);
+            stop (shader_program);
+          }
+
           void bind () {
             if (!_texture) { // allocate:
               _texture.gen (gl::TEXTURE_3D);
@@ -102,10 +125,39 @@ namespace MR
 
 
           inline void upload_data (const std::array<ssize_t,3>& x, const std::array<ssize_t,3>& size, const void* data) {
-            gl::TexSubImage3D (gl::TEXTURE_3D, 0,
-                x[0], x[1], x[2],
-                size[0], size[1], size[2],
-                format, type, data);
+            // Stream the data through a pair of pixel buffer objects, used in
+            //   alternation: the driver can then DMA the contents of one
+            //   buffer to the texture while the CPU is filling the other,
+            //   rather than stalling the GL thread for the duration of each
+            //   TexSubImage3D call
+            const GLsizeiptr num_bytes = size[0] * size[1] * size[2] * texel_size();
+            GL::VertexBuffer& pbo (pixel_buffer[current_pixel_buffer]);
+            current_pixel_buffer = 1 - current_pixel_buffer;
+            pbo.gen();
+            pbo.bind (gl::PIXEL_UNPACK_BUFFER);
+            // Orphan the previous contents so that mapping need not wait for
+            //   any in-flight transfer from this buffer to complete
+            gl::BufferData (gl::PIXEL_UNPACK_BUFFER, num_bytes, NULL, gl::STREAM_DRAW);
+            void* map = gl::MapBufferRange (gl::PIXEL_UNPACK_BUFFER, 0, num_bytes,
+                gl::MAP_WRITE_BIT | gl::MAP_INVALIDATE_BUFFER_BIT);
+            if (map) {
+              memcpy (map, data, num_bytes);
+              gl::UnmapBuffer (gl::PIXEL_UNPACK_BUFFER);
+              gl::TexSubImage3D (gl::TEXTURE_3D, 0,
+                  x[0], x[1], x[2],
+                  size[0], size[1], size[2],
+                  format, type, NULL);
+              gl::BindBuffer (gl::PIXEL_UNPACK_BUFFER, 0);
+            }
+            else {
+              // Mapping can legitimately fail (e.g. out of driver memory);
+              //   fall back to a synchronous upload
+              gl::BindBuffer (gl::PIXEL_UNPACK_BUFFER, 0);
+              gl::TexSubImage3D (gl::TEXTURE_3D, 0,
+                  x[0], x[1], x[2],
+                  size[0], size[1], size[2],
+                  format, type, data);
+            }
           }
 
         protected:
@@ -118,6 +170,20 @@ namespace MR
           GLenum type, format, internal_format;
           float _scale_factor;
           bool texture_mode_changed;
+          GL::VertexBuffer pixel_buffer[2];
+          size_t current_pixel_buffer;
+
+          //! size (in bytes) of a single texel, given the current format & type
+          size_t texel_size () const {
+            const size_t components = ( format == gl::RED ? 1 : ( format == gl::RG ? 2 : 3 ) );
+            size_t bytes_per_component;
+            switch (type) {
+              case gl::BYTE: case gl::UNSIGNED_BYTE: bytes_per_component = 1; break;
+              case gl::SHORT: case gl::UNSIGNED_SHORT: bytes_per_component = 2; break;
+              default: bytes_per_component = 4; break;
+            }
+            return components * bytes_per_component;
+          }
 
           Eigen::Vector3f pos[4], tex[4], z, im_z;
           Eigen::Vector3f vertices[8];
@@ -168,6 +234,34 @@ namespace MR
             gl::DrawArrays (gl::TRIANGLE_FAN, 0, 4);
           }
 
+          //! as for draw_vertices(), but for an arbitrary number of triangles
+          void draw_batch_vertices (const vector<Eigen::Vector3f>& batch)
+          {
+            if (!vertex_buffer || !vertex_array_object) {
+              assert (!vertex_buffer);
+              assert (!vertex_array_object);
+
+              vertex_buffer.gen();
+              vertex_array_object.gen();
+
+              vertex_buffer.bind (gl::ARRAY_BUFFER);
+              vertex_array_object.bind();
+
+              gl::EnableVertexAttribArray (0);
+              gl::VertexAttribPointer (0, 3, gl::FLOAT, gl::FALSE_, 2*sizeof(Eigen::Vector3f), (void*)0);
+
+              gl::EnableVertexAttribArray (1);
+              gl::VertexAttribPointer (1, 3, gl::FLOAT, gl::FALSE_, 2*sizeof(Eigen::Vector3f), (void*)(sizeof(Eigen::Vector3f)));
+            }
+            else {
+              vertex_buffer.bind (gl::ARRAY_BUFFER);
+              vertex_array_object.bind();
+            }
+
+            gl::BufferData (gl::ARRAY_BUFFER, batch.size()*sizeof(Eigen::Vector3f), &batch[0][0], gl::STREAM_DRAW);
+            gl::DrawArrays (gl::TRIANGLES, 0, batch.size()/2);
+          }
+
       };
 
 
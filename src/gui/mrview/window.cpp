@@ -15,6 +15,7 @@
 #include "app.h"
 #include "timer.h"
 #include "file/config.h"
+#include "image_io/overview.h"
 #include "header.h"
 #include "algo/copy.h"
 #include "gui/opengl/gl.h"
@@ -832,7 +833,23 @@ namespace MR
 
       void Window::add_images (vector<std::unique_ptr<MR::Header>>& list)
       {
+        //CONF option: MRViewUseOverviewLevels
+        //CONF default: true
+        //CONF Load the coarsest sufficient embedded overview level of an
+        //CONF image (if present) rather than the full-resolution data, when
+        //CONF the image is larger than the render target.
+        const bool use_overviews = File::Config::get_bool ("MRViewUseOverviewLevels", true);
         for (size_t i = 0; i < list.size(); ++i) {
+          if (use_overviews) {
+            try {
+              const size_t level = MR::select_overview (*list[i], std::max (glarea->width(), glarea->height()));
+              if (level) {
+                INFO ("loading " + str (size_t(1) << level) + "x overview level of image \"" + list[i]->name() + "\"");
+                *list[i] = MR::overview (*list[i], level);
+              }
+            }
+            catch (Exception& E) { E.display (3); }
+          }
           const std::string name = list[i]->name(); // Gets move-constructed out
           QAction* action = new Image (std::move (*list[i]));
           action->setText (shorten (name, 20, 0).c_str());
@@ -146,8 +146,12 @@ namespace MR
           bool show_orientation_labels () const { return show_orientation_labels_action->isChecked(); }
           bool show_colourbar () const { return show_colourbar_action->isChecked(); }
 
+          QImage framegrab () {
+            return glarea->grabFramebuffer();
+          }
+
           void captureGL (std::string filename) {
-            QImage image (glarea->grabFramebuffer());
+            QImage image (framegrab());
             image.save (filename.c_str());
           }
 
@@ -67,19 +67,21 @@ class Min_mem_array { MEMALIGN(Min_mem_array<T>)
     }
 
     Min_mem_array (const Min_mem_array& that) :
-      n (that.n),
-      d (new T[n])
+      n (that.dim()),
+      d (new T[that.dim()])
     {
-      memcpy (d, that.d, n * sizeof (T));
+      memcpy (d, that.d, dim() * sizeof (T));
     }
 
     virtual ~Min_mem_array()
     {
-      delete[] d;
+      if (d && owns())
+        delete[] d;
       d = NULL;
     }
 
     void add (const T& i) {
+      assert (owns());
       if (d) {
         T* new_data = new T[n + 1];
         memcpy (new_data, d, n * sizeof (T));
@@ -96,6 +98,7 @@ class Min_mem_array { MEMALIGN(Min_mem_array<T>)
 
     // Second version of add() which invokes copy constructors in the underlying data
     void add_copyconstruct (const T& i) {
+      assert (owns());
       if (d) {
         T* new_data = new T[n + 1];
         for (size_t a = 0; a != n; ++a)
@@ -114,7 +117,8 @@ class Min_mem_array { MEMALIGN(Min_mem_array<T>)
 
     void erase() {
       if (d) {
-        delete[] d;
+        if (owns())
+          delete[] d;
         d = NULL;
         n = 0;
       }
@@ -124,23 +128,23 @@ class Min_mem_array { MEMALIGN(Min_mem_array<T>)
     // Need to make sure change does not affect any existing code
     template <class C>
     void load (C& data) const {
-      for (size_t i = 0; i != n; ++i)
+      for (size_t i = 0; i != dim(); ++i)
         data.push_back (d[i]);
     }
 
-    size_t dim() const { return n; }
+    size_t dim() const { return n & ~external_storage_bit; }
 
     bool operator== (const Min_mem_array<T>& that) const {
-      return ((n == that.n) && !memcmp (d, that.d, n * sizeof (T)));
+      return ((dim() == that.dim()) && !memcmp (d, that.d, dim() * sizeof (T)));
     }
 
     bool operator< (const Min_mem_array<T>& that) const {
       // If one is empty and the other is not, one is 'less than' the other; but if both are empty, then '<' should return false
-      if (!n)
-        return that.n;
-      if (!that.n)
+      if (!dim())
+        return that.dim();
+      if (!that.dim())
         return false;
-      for (size_t i = 0; i != std::min (n, that.n); ++i) {
+      for (size_t i = 0; i != std::min (dim(), that.dim()); ++i) {
         if (d[i] < that.d[i])
           return true;
         if (d[i] > that.d[i])
@@ -149,33 +153,54 @@ class Min_mem_array { MEMALIGN(Min_mem_array<T>)
       }
       // If code reaches this point, then all of the elements up to the minimum of the two lengths are identical
       // Therefore, only return true for '<' if the length of that is longer than this (if they are equivalent in length, '<' does not hold so return false)
-      return (n < that.n);
+      return (dim() < that.dim());
     }
 
     T& operator[] (const size_t i) {
-      assert (i < n);
+      assert (i < dim());
       return d[i];
     }
 
     const T& operator[] (const size_t i) const {
-      assert (i < n);
+      assert (i < dim());
       return d[i];
     }
 
     Min_mem_array<T>& operator= (const Min_mem_array<T>& that) {
-      n = that.n;
-      if (d)
+      if (d && owns())
         delete[] d;
+      n = that.dim();
       d = new T[n];
       memcpy (d, that.d, n * sizeof (T));
       return (*this);
     }
 
 
+  protected:
+    // Construct over externally-managed storage, which must be able to hold
+    //   data.size() elements; the data are copied in, but the array does not
+    //   take ownership of the memory, and will never free it. This permits
+    //   packing many arrays into a single backing allocation (e.g. a
+    //   memory-mapped file).
+    template <class C>
+    Min_mem_array (const C& data, T* storage) :
+      n (data.size() | external_storage_bit),
+      d (storage)
+    {
+      size_t index = 0;
+      for (typename C::const_iterator i = data.begin(); i != data.end(); ++i, ++index)
+        d[index] = *i;
+    }
+
+
   private:
-    size_t n;
+    size_t n; // Most significant bit flags externally-managed storage
     T* d;
 
+    static constexpr size_t external_storage_bit = size_t(1) << (8 * sizeof (size_t) - 1);
+
+    bool owns() const { return !(n & external_storage_bit); }
+
 };
 
 
@@ -26,8 +26,8 @@ namespace MR
 
     const char* linear_metric_choices[] = { "diff", "ncc", nullptr };
     const char* linear_robust_estimator_choices[] = { "l1", "l2", "lp", nullptr };
-    const char* linear_optimisation_algo_choices[] = { "bbgd", "gd", nullptr };
-    const char* optim_algo_names[] = { "BBGD", "GD", nullptr };
+    const char* linear_optimisation_algo_choices[] = { "bbgd", "gd", "lbfgs", nullptr };
+    const char* optim_algo_names[] = { "BBGD", "GD", "LBFGS", nullptr };
 
     // define parameters of initialisation methods used for both, rigid and affine registration
     void parse_general_options (Registration::Linear& registration) {
@@ -79,6 +79,9 @@ namespace MR
         case 1:
           registration.set_stage_optimiser_default (Registration::OptimiserAlgoType::gd);
           break;
+        case 2:
+          registration.set_stage_optimiser_default (Registration::OptimiserAlgoType::lbfgs);
+          break;
         }
       }
 
@@ -91,6 +94,9 @@ namespace MR
         case 1:
           registration.set_stage_optimiser_first (Registration::OptimiserAlgoType::gd);
           break;
+        case 2:
+          registration.set_stage_optimiser_first (Registration::OptimiserAlgoType::lbfgs);
+          break;
         }
       }
 
@@ -103,6 +109,9 @@ namespace MR
         case 1:
           registration.set_stage_optimiser_last (Registration::OptimiserAlgoType::gd);
           break;
+        case 2:
+          registration.set_stage_optimiser_last (Registration::OptimiserAlgoType::lbfgs);
+          break;
         }
       }
 
@@ -185,13 +194,13 @@ namespace MR
       // choose parameter consensus criterion: maximum overlap, min cost
 
       + Option ("linstage.optimiser.first", "Cost function optimisation algorithm to use at first iteration of all stages. "
-        "Valid choices: bbgd (Barzilai-Borwein gradient descent) or gd (simple gradient descent). (Default: bbgd)")
+        "Valid choices: bbgd (Barzilai-Borwein gradient descent), gd (simple gradient descent) or lbfgs (limited-memory BFGS with Wolfe line search). (Default: bbgd)")
         + Argument ("algorithm").type_choice (linear_optimisation_algo_choices)
       + Option ("linstage.optimiser.last", "Cost function optimisation algorithm to use at last iteration of all stages (if there are more than one). "
-        "Valid choices: bbgd (Barzilai-Borwein gradient descent) or gd (simple gradient descent). (Default: bbgd)")
+        "Valid choices: bbgd (Barzilai-Borwein gradient descent), gd (simple gradient descent) or lbfgs (limited-memory BFGS with Wolfe line search). (Default: bbgd)")
         + Argument ("algorithm").type_choice (linear_optimisation_algo_choices)
       + Option ("linstage.optimiser.default", "Cost function optimisation algorithm to use at any stage iteration other than first or last iteration. "
-        "Valid choices: bbgd (Barzilai-Borwein gradient descent) or gd (simple gradient descent). (Default: bbgd)")
+        "Valid choices: bbgd (Barzilai-Borwein gradient descent), gd (simple gradient descent) or lbfgs (limited-memory BFGS with Wolfe line search). (Default: bbgd)")
         + Argument ("algorithm").type_choice (linear_optimisation_algo_choices)
 
       + Option ("linstage.diagnostics.prefix", "generate diagnostics images after every registration stage")
@@ -34,6 +34,7 @@
 #include "registration/transform/initialiser.h"
 #include "math/gradient_descent.h"
 #include "math/gradient_descent_bb.h"
+#include "math/lbfgs.h"
 // #include "math/check_gradient.h"
 #include "math/rng.h"
 #include "math/math.h"
@@ -54,7 +55,7 @@ namespace MR
 
     enum LinearMetricType {Diff, NCC};
     enum LinearRobustMetricEstimatorType {L1, L2, LP, None};
-    enum OptimiserAlgoType {bbgd, gd, none};
+    enum OptimiserAlgoType {bbgd, gd, lbfgs, none};
 
 
     struct StageSetting {  MEMALIGN(StageSetting)
@@ -390,15 +391,20 @@ namespace MR
             // calculate midway (affine average) space which will be constant for each resolution level
             midway_image_header = compute_minimum_average_header (im1_image, im2_image, transform, midspace_voxel_subsampling, midspace_padding);
 
+            // each smoothed / lmax-truncated level is computed at most once,
+            // regardless of how many stages share its parameters:
+            Registration::MultiResolutionCache<Im1ImageType> im1_pyramid;
+            Registration::MultiResolutionCache<Im2ImageType> im2_pyramid;
+
             for (size_t istage = 0; istage < stages.size(); istage++) {
               auto& stage = stages[istage];
 
               CONSOLE ("linear stage " + str(istage + 1) + "/"+str(stages.size()) + ", " + stage.info(do_reorientation));
 
               INFO ("smoothing image 1");
-              auto im1_smoothed = Registration::multi_resolution_lmax (im1_image, stage.scale_factor, do_reorientation, stage.fod_lmax);
+              auto im1_smoothed = im1_pyramid (im1_image, stage.scale_factor, do_reorientation, stage.fod_lmax);
               INFO ("smoothing image 2");
-              auto im2_smoothed = Registration::multi_resolution_lmax (im2_image, stage.scale_factor, do_reorientation, stage.fod_lmax);
+              auto im2_smoothed = im2_pyramid (im2_image, stage.scale_factor, do_reorientation, stage.fod_lmax);
 
               Filter::Resize midway_resize_filter (midway_image_header);
               midway_resize_filter.set_scale_factor (stage.scale_factor);
@@ -485,6 +491,15 @@ namespace MR
                   parameters.optimiser_update (optim, evaluate.overlap());
                   INFO ("    iteration: "+str(stage_iter)+"/"+str(stage.stage_iterations)+" GD iterations: "+
                   str(optim.function_evaluations())+" cost: "+str(optim.value())+" overlap: "+str(evaluate.overlap()));
+                } else if (stage.gd_max_iter > 0 and stage.optimisers[stage_iter - 1] == OptimiserAlgoType::lbfgs) {
+                  Math::LBFGS<Metric::Evaluate<MetricType, ParamType>, typename TransformType::UpdateType>
+                  optim (evaluate, *transform.get_gradient_descent_updator());
+                  optim.be_verbose (analyse_descent);
+                  optim.precondition (optimiser_weights);
+                  optim.run (stage.gd_max_iter, grad_tolerance, analyse_descent ? std::cout.rdbuf() : log_stream);
+                  parameters.optimiser_update (optim, evaluate.overlap());
+                  INFO ("    iteration: "+str(stage_iter)+"/"+str(stage.stage_iterations)+" L-BFGS iterations: "+
+                  str(optim.function_evaluations())+" cost: "+str(optim.value())+" overlap: "+str(evaluate.overlap()));
                 } else if (stage.gd_max_iter > 0) {
                   Math::GradientDescent<Metric::Evaluate<MetricType, ParamType>, typename TransformType::UpdateType>
                     optim (evaluate, *transform.get_gradient_descent_updator());
@@ -68,7 +68,8 @@ namespace MR
             Evaluate (const MetricType& metric_, ParamType& parameters, typename metric_requires_initialisation<U>::yes = 0) :
               metric (metric_),
               params (parameters),
-              iteration (1) {
+              iteration (1),
+              adaptive_density (0.0) {
                 // update number of volumes
                 metric.init (parameters.im1_image, parameters.im2_image);
             }
@@ -77,7 +78,8 @@ namespace MR
             Evaluate (const MetricType& metric, ParamType& parameters, typename metric_requires_initialisation<U>::no = 0) :
               metric (metric),
               params (parameters),
-              iteration (1) { }
+              iteration (1),
+              adaptive_density (0.0) { }
 
             //  metric_requires_precompute<U>::yes: operator() loops over processed_image instead of midway_image
             template <class U = MetricType>
@@ -119,14 +121,16 @@ namespace MR
             struct ThreadFunctor { MEMALIGN(ThreadFunctor)
               public:
                 ThreadFunctor (
+                    const vector<size_t>& outer_axes,
                     const vector<size_t>& inner_axes,
                     const default_type density,
                     const MetricType& metric,
                     const ParamType& parameters,
                     Eigen::VectorXd& overall_cost_function,
                     Eigen::VectorXd& overall_grad,
-                    Math::RNG& rng_engine,
+                    const vector<vector<size_t>>& index_buffers,
                     ssize_t* overlap_count = nullptr) :
+                  outer_axes (outer_axes),
                   inner_axes (inner_axes),
                   density (density),
                   metric (metric),
@@ -135,7 +139,7 @@ namespace MR
                   gradient (overall_grad.size()),
                   overall_cost_function (overall_cost_function),
                   overall_gradient (overall_grad),
-                  rng (rng_engine),
+                  index_buffers (index_buffers),
                   overlap_count (overlap_count)  {
                     gradient.setZero();
                     cost_function.setZero();
@@ -149,17 +153,25 @@ namespace MR
                 }
 
                 void operator() (const Iterator& iter) {
-                  auto engine = std::default_random_engine{static_cast<std::default_random_engine::result_type>(rng.get_seed())};
                   auto kern = ThreadKernel<MetricType, ParamType> (metric, params, cost_function, gradient, overlap_count);
                   Iterator iterator (iter);
                   assign_pos_of(iter).to(iterator);
-                  auto inner_loop = Random_loop<Iterator, std::default_random_engine>(iterator, engine, inner_axes[1], (float) iterator.size(inner_axes[1]) * density);
-                  for (auto j = inner_loop; j; ++j)
+                  // walk the scanline order precomputed for this slice:
+                  // no engine seeding or shuffling in the hot path
+                  size_t slice = 0;
+                  for (size_t n = outer_axes.size(); n-- != 0; )
+                    slice = slice * iter.size (outer_axes[n]) + iter.index (outer_axes[n]);
+                  const vector<size_t>& idx = index_buffers[slice % index_buffers.size()];
+                  const size_t max_cnt = std::min<size_t> (idx.size(), std::ceil (iterator.size(inner_axes[1]) * density));
+                  for (size_t j = 0; j < max_cnt; ++j) {
+                    iterator.index (inner_axes[1]) = idx[j];
                     for (auto k = Loop (inner_axes[0]) (iterator); k; ++k) {
                       kern (iterator);
                     }
+                  }
                 }
               protected:
+                vector<size_t> outer_axes;
                 vector<size_t> inner_axes;
                 default_type density;
                 MetricType metric;
@@ -168,7 +180,7 @@ namespace MR
                 Eigen::VectorXd gradient;
                 Eigen::VectorXd& overall_cost_function;
                 Eigen::VectorXd& overall_gradient;
-                Math::RNG rng;
+                const vector<vector<size_t>>& index_buffers;
                 ssize_t* overlap_count;
             };
 
@@ -183,17 +195,51 @@ namespace MR
                   ssize_t* overlap_count = nullptr) {
 
                 if (params.loop_density < 1.0) {
-                  DEBUG ("stochastic gradient descent, density: " + str(params.loop_density));
                   if (params.robust_estimate){
                     throw Exception ("TODO robust estimate not implemented");
                   } else {
+                    // variance-adaptive sample scheduling: each stage starts
+                    //   from a fraction of the requested density, and the
+                    //   sample is grown whenever successive gradient estimates
+                    //   cease to agree in direction, indicating that the
+                    //   optimisation has become noise-limited at the current
+                    //   sample size. Far-from-converged iterations are thereby
+                    //   served by cheap estimates, while the final iterations
+                    //   run at the full requested density
+                    if (adaptive_density <= 0.0)
+                      adaptive_density = 0.125 * params.loop_density;
+                    DEBUG ("stochastic gradient descent, density: " + str(adaptive_density) + " (requested: " + str(params.loop_density) + ")");
                     Math::RNG rng;
                     gradient.setZero();
                     auto loop = ThreadedLoop (params.midway_image, 0, 3, 2);
                     if (overlap_count)
                       *overlap_count = 0;
-                    ThreadFunctor functor (loop.inner_axes, params.loop_density, metric, params, cost, gradient, rng, overlap_count);
+                    // regenerate the shuffled scanline orders for this evaluation
+                    // up front; the loop threads then simply walk these buffers,
+                    // rather than seeding an engine (serialising on the seed
+                    // mutex) and shuffling within the hot path
+                    std::default_random_engine engine (static_cast<std::default_random_engine::result_type> (rng.get_seed()));
+                    vector<vector<size_t>> index_buffers (voxel_count (params.midway_image, loop.outer_loop.axes));
+                    for (auto& idx : index_buffers) {
+                      idx.resize (params.midway_image.size (loop.inner_axes[1]));
+                      std::iota (idx.begin(), idx.end(), 0);
+                      std::shuffle (idx.begin(), idx.end(), engine);
+                    }
+                    ThreadFunctor functor (loop.outer_loop.axes, loop.inner_axes, adaptive_density, metric, params, cost, gradient, index_buffers, overlap_count);
                     loop.run_outer (functor);
+                    // rescale to the requested density, so that the cost and
+                    //   gradient magnitudes seen by the optimiser do not vary
+                    //   with the current sample size
+                    const default_type rescale = params.loop_density / adaptive_density;
+                    cost *= rescale;
+                    gradient *= rescale;
+                    const default_type gradient_norm = gradient.norm();
+                    if (previous_gradient.size() && gradient_norm > 0.0 && previous_gradient.norm() > 0.0) {
+                      const default_type agreement = gradient.dot (previous_gradient) / (gradient_norm * previous_gradient.norm());
+                      if (agreement < 0.5)
+                        adaptive_density = std::min (2.0 * adaptive_density, params.loop_density);
+                    }
+                    previous_gradient = gradient;
                   }
                 }
                 else {
@@ -260,6 +306,10 @@ namespace MR
               size_t iteration;
               Eigen::MatrixXd directions;
               ssize_t overlap_count;
+              // state of the variance-adaptive sample scheduling for the
+              //   stochastic gradient descent path; see estimate()
+              default_type adaptive_density;
+              Eigen::VectorXd previous_gradient;
 
       };
     }
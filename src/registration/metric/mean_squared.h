@@ -95,12 +95,15 @@ namespace MR
 
               const ssize_t volumes = params.im1_image_interp->size(3);
 
-              Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 3> im1_grad (volumes, 3);
-              Eigen::Matrix<typename Im2Type::value_type, Eigen::Dynamic, 3> im2_grad (volumes, 3);
-              Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 1> im1_values (volumes);
-              Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 1> diff_values (volumes);
-              Eigen::Matrix<typename Im2Type::value_type, Eigen::Dynamic, 1> im2_values (volumes);
-
+              // the scratch buffers are members (the metric is copied per
+              //   thread), so no allocation occurs per sample:
+              if (im1_values.size() != volumes) {
+                im1_grad.resize (volumes, 3);
+                im2_grad.resize (volumes, 3);
+                im1_values.resize (volumes);
+                diff_values.resize (volumes);
+                im2_values.resize (volumes);
+              }
 
               params.im1_image_interp->value_and_gradient_row_wrt_scanner (im1_values, im1_grad);
               if (im1_values.hasNaN())
@@ -113,21 +116,21 @@ namespace MR
               const auto jacobian_vec = params.transformation.get_jacobian_vector_wrt_params (midway_point);
               diff_values = im1_values - im2_values;
 
-              for (ssize_t i = 0; i < volumes; ++i) {
-                const Eigen::Vector3d g = diff_values[i] * (im1_grad.row(i) + im2_grad.row(i));
-                gradient.segment<4>(0) += g(0) * jacobian_vec;
-                gradient.segment<4>(4) += g(1) * jacobian_vec;
-                gradient.segment<4>(8) += g(2) * jacobian_vec;
-              }
+              // the jacobian is common to all volumes, so the per-volume
+              //   contributions reduce to a single matrix-vector product:
+              const Eigen::Vector3d g = ((im1_grad + im2_grad).transpose() * diff_values).template cast<default_type>();
+              gradient.segment<4>(0) += g(0) * jacobian_vec;
+              gradient.segment<4>(4) += g(1) * jacobian_vec;
+              gradient.segment<4>(8) += g(2) * jacobian_vec;
 
               return diff_values.squaredNorm() / (default_type)volumes;
           }
 
           private:
-  //          Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 3> im1_grad;
-  //          Eigen::Matrix<typename Im2Type::value_type, Eigen::Dynamic, 3> im2_grad;
-  //          Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 1> im1_values, diff_values;
-  //          Eigen::Matrix<typename Im2Type::value_type, Eigen::Dynamic, 1> im2_values;
+            Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 3> im1_grad;
+            Eigen::Matrix<typename Im2Type::value_type, Eigen::Dynamic, 3> im2_grad;
+            Eigen::Matrix<typename Im1Type::value_type, Eigen::Dynamic, 1> im1_values, diff_values;
+            Eigen::Matrix<typename Im2Type::value_type, Eigen::Dynamic, 1> im2_values;
         };
 
       template <class Im1Type, class Im2Type>
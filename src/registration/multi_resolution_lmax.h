@@ -15,6 +15,8 @@
 #ifndef __registration_multi_resolution_lmax_h__
 #define __registration_multi_resolution_lmax_h__
 
+#include <map>
+
 #include "adapter/subset.h"
 #include "filter/smooth.h"
 
@@ -49,6 +51,34 @@ namespace MR
       smooth_filter (smoothed);
       return smoothed;
     }
+
+
+    //! memoises the output of multi_resolution_lmax() for one input image
+    /*! Registration stages frequently revisit the same (scale factor, lmax)
+     * combination — e.g. repeated linear stages at the same resolution, or
+     * non-linear levels re-using the scales of the linear phase — in which
+     * case the smoothed level computed previously is returned directly
+     * rather than re-smoothed. The cached levels live in scratch buffers
+     * shared by handle, so callers must treat them as read-only. */
+    template <class ImageType>
+    class MultiResolutionCache { MEMALIGN(MultiResolutionCache<ImageType>)
+      public:
+        ImageType operator() (ImageType& input,
+                              const default_type scale_factor,
+                              const bool do_reorientation = false,
+                              const int lmax = 0)
+        {
+          const std::pair<default_type,int> key (scale_factor, do_reorientation ? lmax : -1);
+          auto it = cache.find (key);
+          if (it == cache.end())
+            it = cache.insert (std::make_pair (key, multi_resolution_lmax (input, scale_factor, do_reorientation, lmax))).first;
+          return it->second;
+        }
+
+      protected:
+        std::map<std::pair<default_type,int>, ImageType> cache;
+    };
+
   }
 }
 #endif
@@ -104,6 +104,11 @@ namespace MR
             else
               fod_lmax.resize (scale_factor.size(), 0);
 
+            // each smoothed / lmax-truncated level is computed at most once,
+            // regardless of how many levels share its parameters:
+            Registration::MultiResolutionCache<Im1ImageType> im1_pyramid;
+            Registration::MultiResolutionCache<Im2ImageType> im2_pyramid;
+
             for (size_t level = 0; level < scale_factor.size(); level++) {
               if (is_initialised) {
                 if (do_reorientation) {
@@ -136,8 +141,8 @@ namespace MR
                                                                 + midway_image_header_resized.spacing(1)
                                                                 + midway_image_header_resized.spacing(2)) / 3.0);
 
-              auto im1_smoothed = Registration::multi_resolution_lmax (im1_image, scale_factor[level], do_reorientation, fod_lmax[level]);
-              auto im2_smoothed = Registration::multi_resolution_lmax (im2_image, scale_factor[level], do_reorientation, fod_lmax[level]);
+              auto im1_smoothed = im1_pyramid (im1_image, scale_factor[level], do_reorientation, fod_lmax[level]);
+              auto im2_smoothed = im2_pyramid (im2_image, scale_factor[level], do_reorientation, fod_lmax[level]);
 
               DEBUG ("Initialising scratch images");
               Header warped_header (midway_image_header_resized);
@@ -181,6 +186,17 @@ namespace MR
               default_type grad_step_altered = gradient_step * (field_header.spacing(0) + field_header.spacing(1) + field_header.spacing(2)) / 3.0;
               default_type cost = std::numeric_limits<default_type>::max();
               bool converged = false;
+              bool fields_updated = false;
+
+              // per-iteration scratch buffers, allocated once per level:
+              Image<default_type> im1_deform_field = Image<default_type>::scratch (field_header);
+              Image<default_type> im2_deform_field = Image<default_type>::scratch (field_header);
+              Im1MaskType im1_mask_warped;
+              if (im1_mask.valid())
+                im1_mask_warped = Im1MaskType::scratch (midway_image_header_resized);
+              Im1MaskType im2_mask_warped;
+              if (im2_mask.valid())
+                im2_mask_warped = Im1MaskType::scratch (midway_image_header_resized);
 
               while (!converged) {
                 if (iteration > 1) {
@@ -191,9 +207,6 @@ namespace MR
                   smooth_filter (*im2_update);
                 }
 
-                Image<default_type> im1_deform_field = Image<default_type>::scratch (field_header);
-                Image<default_type> im2_deform_field = Image<default_type>::scratch (field_header);
-
                 if (iteration > 1) {
                   DEBUG ("updating displacement field");
                   Warp::update_displacement_scaling_and_squaring (*im1_to_mid, *im1_update, *im1_to_mid_new, grad_step_altered);
@@ -227,15 +240,11 @@ namespace MR
                 }
 
                 DEBUG ("warping mask images");
-                Im1MaskType im1_mask_warped;
                 if (im1_mask.valid()) {
-                  im1_mask_warped = Im1MaskType::scratch (midway_image_header_resized);
                   LogLevelLatch level (0);
                   Filter::warp<Interp::Linear> (im1_mask, im1_mask_warped, im1_deform_field, 0.0);
                 }
-                Im1MaskType im2_mask_warped;
                 if (im2_mask.valid()) {
-                  im2_mask_warped = Im1MaskType::scratch (midway_image_header_resized);
                   LogLevelLatch level (0);
                   Filter::warp<Interp::Linear> (im2_mask, im2_mask_warped, im2_deform_field, 0.0);
                 }
@@ -260,18 +269,10 @@ namespace MR
                   if (iteration > 1) {
                     std::swap (im1_to_mid_new, im1_to_mid);
                     std::swap (im2_to_mid_new, im2_to_mid);
+                    fields_updated = true;
                   }
                   std::swap (im1_update_new, im1_update);
                   std::swap (im2_update_new, im2_update);
-
-                  DEBUG ("inverting displacement field");
-                  {
-                    LogLevelLatch level (0);
-                    Warp::invert_displacement (*im1_to_mid, *mid_to_im1);
-                    Warp::invert_displacement (*im2_to_mid, *mid_to_im2);
-                  }
-
-
                 } else {
                   converged = true;
                 }
@@ -282,6 +283,18 @@ namespace MR
                 if (++iteration > max_iter[level])
                   converged = true;
               }
+
+              // the inverse fields are not used during optimisation, so they
+              //   only need to be recomputed once the final displacement fields
+              //   for this level are known; the previous estimates serve as
+              //   initialisation for the fixed-point iterations. If no update
+              //   was accepted the existing inverses are still current.
+              if (fields_updated) {
+                DEBUG ("inverting displacement field");
+                LogLevelLatch log_level (0);
+                Warp::invert_displacement (*im1_to_mid, *mid_to_im1);
+                Warp::invert_displacement (*im2_to_mid, *mid_to_im2);
+              }
             }
             // Convert all warps to deformation field format for output
             Registration::Warp::displacement2deformation (*im1_to_mid, *im1_to_mid);
@@ -15,11 +15,20 @@
 #ifndef __registration_transform_reorient_h__
 #define __registration_transform_reorient_h__
 
+#include <array>
+
 #include "algo/threaded_loop.h"
 #include "math/SH.h"
 #include "math/least_squares.h"
 #include "adapter/jacobian.h"
 
+// Quantisation step applied to the elements of the local Jacobian when
+//   deciding whether the aPSF basis of the previous voxel can be reused
+//   during warp-based FOD reorientation; Jacobians matching to within this
+//   tolerance produce reorientation matrices that differ well below the
+//   accuracy of the aPSF fit itself
+#define REORIENT_JACOBIAN_QUANT 1.0e-4
+
 namespace MR
 {
   namespace Registration
@@ -126,7 +135,9 @@ namespace MR
                            directions (directions),
                            modulate (modulate),
                            FOD_to_aPSF_transform (Math::pinv (aPSF_weights_to_FOD_transform (n_SH, directions))),
-                           fod (n_SH) {}
+                           fod (n_SH),
+                           weights (directions.cols()),
+                           basis_valid (false) {}
 
 
           void operator() (FODImageType& image) {
@@ -134,24 +145,15 @@ namespace MR
             if (image.value() > 0) {  // only reorient voxels that contain a FOD
               for (size_t dim = 0; dim < 3; ++dim)
                 jacobian_adapter.index(dim) = image.index(dim);
-              Eigen::MatrixXd jacobian = jacobian_adapter.value().inverse().template cast<default_type>();
-              Eigen::MatrixXd transformed_directions = jacobian * directions;
-
-              if (modulate) {
-                Eigen::MatrixXd modulation_factors = transformed_directions.colwise().norm() / jacobian.determinant();
-                transformed_directions.colwise().normalize();
-
-                Eigen::MatrixXd temp = aPSF_weights_to_FOD_transform (n_SH, transformed_directions);
-                for (ssize_t i = 0; i < temp.cols(); ++i)
-                  temp.col(i) = temp.col(i) * modulation_factors(0,i);
-
-                transform.noalias() = temp * FOD_to_aPSF_transform;
-              } else {
-                transformed_directions.colwise().normalize();
-                transform.noalias() = aPSF_weights_to_FOD_transform (n_SH, transformed_directions) * FOD_to_aPSF_transform;
-              }
+              const Eigen::MatrixXd jacobian = jacobian_adapter.value().inverse().template cast<default_type>();
+              update_aPSF_basis (jacobian);
+              // apply the reorientation in aPSF weight space: projecting the
+              //   FOD onto its aPSF weights first replaces the per-voxel
+              //   assembly of the (n_SH x n_SH) transform with two
+              //   matrix-vector products
               fod = image.row(3);
-              fod = transform * fod;
+              weights.noalias() = FOD_to_aPSF_transform * fod;
+              fod.noalias() = aPSF_basis * weights;
               image.row(3) = fod;
             }
           }
@@ -161,8 +163,36 @@ namespace MR
             const Eigen::MatrixXd& directions;
             const bool modulate;
             const Eigen::MatrixXd FOD_to_aPSF_transform;
-            Eigen::MatrixXd transform;
+            Eigen::MatrixXd aPSF_basis;
             Eigen::VectorXd fod;
+            Eigen::VectorXd weights;
+            std::array<int64_t, 9> basis_key;
+            bool basis_valid;
+
+            //! rebuild the aPSF basis of the reoriented directions if required
+            /*! the Jacobian field of a smooth warp varies slowly, so runs of
+             * consecutive voxels frequently share a Jacobian to within
+             * quantisation; each thread holds on to the basis it built last,
+             * keyed by the quantised Jacobian elements, and rebuilds only
+             * when the key changes */
+            void update_aPSF_basis (const Eigen::MatrixXd& jacobian) {
+              std::array<int64_t, 9> key;
+              for (ssize_t i = 0; i != 9; ++i)
+                key[i] = int64_t (std::round (jacobian (i/3, i%3) / REORIENT_JACOBIAN_QUANT));
+              if (basis_valid && key == basis_key)
+                return;
+              Eigen::MatrixXd transformed_directions = jacobian * directions;
+              if (modulate) {
+                const Eigen::VectorXd modulation_factors = transformed_directions.colwise().norm() / jacobian.determinant();
+                transformed_directions.colwise().normalize();
+                aPSF_basis.noalias() = aPSF_weights_to_FOD_transform (n_SH, transformed_directions) * modulation_factors.asDiagonal();
+              } else {
+                transformed_directions.colwise().normalize();
+                aPSF_basis = aPSF_weights_to_FOD_transform (n_SH, transformed_directions);
+              }
+              basis_key = key;
+              basis_valid = true;
+            }
       };
 
 
@@ -136,29 +136,19 @@ namespace MR
               ProgressBar progress ("performing " + what + " search for best rotation", iterations);
               overlap_it.resize (iterations);
               cost_it.resize (iterations);
-              trafo_it.reserve (iterations);
+              trafo_it.resize (iterations);
 
               if (!global_search) {
                 gen_uniform_rotation_axes (local_search_directions, 180.0); // full sphere
                 az_el_to_cartesian();
               }
 
-              size_t iteration (0);
-              ssize_t cnt (0);
-              Eigen::Matrix<default_type, Eigen::Dynamic, 1> gradient (local_trafo.size());
-              Eigen::VectorXd cost = Eigen::VectorXd::Zero(1,1);
-              transform_type T;
-              {
-                ParamType parameters = get_parameters ();
-                // parameters.make_diagnostics_image ("/tmp/debugme"+str(iteration)+".mif", true); // REMOVEME
-                Metric::ThreadKernel<MetricType, ParamType> kernel (metric, parameters, cost, gradient, &cnt);
-                ThreadedLoop (parameters.midway_image, 0, 3).run (kernel);
-                assert (cnt > 0);
-                overlap_it[0] = cnt;
-                cost_it[0] = cost(0) / static_cast<default_type>(cnt);
-                T = parameters.transformation.get_transform();
-                trafo_it.push_back (T);
-              }
+              // candidate generation is stateful (shared RNG, direction and
+              // angle indices) so all candidate transformations are generated
+              // up front; their evaluations are independent and distributed
+              // across threads, each with its own transformation, parameters
+              // and metric state
+              trafo_it[0] = local_trafo.get_transform();
 
               transform_type Tc2, To, R0;
               Tc2.setIdentity();
@@ -167,32 +157,68 @@ namespace MR
               To.translation() = offset;
               Tc2.translation() = centre - 0.5 * offset;
 
-
-              while ( ++iteration < iterations ) {
-                ++progress;
+              for (size_t iteration = 1; iteration < iterations; ++iteration) {
                 if (global_search)
                   gen_random_quaternion ();
                 else
                   gen_local_quaternion ();
-
                 R0.linear() = quat.normalized().toRotationMatrix();
-                transform_type T = Tc2 * To * R0 * Tc2.inverse();
-
-                local_trafo.set_transform<decltype(T)>(T);
-                ParamType parameters = get_parameters ();
-                // parameters.make_diagnostics_image ("/tmp/debugme"+str(iteration)+".mif", true); // REMOVEME
-                cost.fill(0);
-                cnt = 0;
-                Metric::ThreadKernel<MetricType, ParamType> kernel (metric, parameters, cost, gradient, &cnt);
-                ThreadedLoop (parameters.midway_image, 0, 3).run (kernel);
-                DEBUG ("rotation search: iteration " + str(iteration) + " cost: " + str(cost) + " cnt: " + str(cnt));
-                // write_images ( "im1_" + str(iteration) + ".mif", "im2_" + str(iteration) + ".mif");
-                if (cnt == 0)
-                  WARN ("rotation search: overlap count is zero");
-                overlap_it[iteration] = cnt;
-                cost_it[iteration] = cost(0) / static_cast<default_type>(cnt);
-                trafo_it.push_back (T);
+                trafo_it[iteration] = Tc2 * To * R0 * Tc2.inverse();
               }
+
+              struct Shared { MEMALIGN(Shared)
+                size_t next_candidate;
+                const size_t iterations;
+                ProgressBar& progress;
+                std::mutex mutex;
+                FORCE_INLINE bool next (size_t& candidate) {
+                  std::lock_guard<std::mutex> lock (mutex);
+                  if (next_candidate >= iterations)
+                    return false;
+                  candidate = next_candidate++;
+                  ++progress;
+                  return true;
+                }
+              } shared = { 0, iterations, progress };
+
+              struct CandidateThread { MEMALIGN(CandidateThread)
+                ExhaustiveRotationSearch& parent;
+                Shared& shared;
+                void execute () {
+                  Registration::Transform::Rigid trafo;
+                  trafo.set_centre_without_transform_update (parent.centre);
+                  trafo.set_translation (parent.offset);
+                  Eigen::Matrix<default_type, Eigen::Dynamic, 1> gradient (trafo.size());
+                  Eigen::VectorXd cost = Eigen::VectorXd::Zero(1,1);
+                  Header midway_header;
+                  size_t candidate;
+                  while (shared.next (candidate)) {
+                    trafo.set_transform<transform_type> (parent.trafo_it[candidate]);
+                    ParamType parameters = parent.get_parameters (trafo, midway_header);
+                    cost.fill(0);
+                    ssize_t cnt = 0;
+                    {
+                      Metric::ThreadKernel<MetricType, ParamType> kernel (parent.metric, parameters, cost, gradient, &cnt);
+                      Iterator iter (parameters.midway_image);
+                      for (auto l = Loop (0, 3) (iter); l; ++l)
+                        kernel (iter);
+                    }
+                    DEBUG ("rotation search: iteration " + str(candidate) + " cost: " + str(cost) + " cnt: " + str(cnt));
+                    if (cnt == 0)
+                      WARN ("rotation search: overlap count is zero");
+                    parent.overlap_it[candidate] = cnt;
+                    parent.cost_it[candidate] = cost(0) / static_cast<default_type>(cnt);
+                  }
+                }
+              } worker = { *this, shared };
+
+              if (Thread::number_of_threads() == 0) {
+                worker.execute();
+              } else {
+                auto threads = Thread::run (Thread::multi (worker), "search threads");
+                threads.wait();
+              }
+
               // if (debug) {
               //   save_matrix(cost_it, "/tmp/cost_before.txt");
               //   save_matrix(overlap_it, "/tmp/overlap.txt");
@@ -205,8 +231,7 @@ namespace MR
                 cost_it = (overlap_it.array() > mean_overlap).select(cost_it, max_);
                 std::ptrdiff_t i;
                 min_cost = cost_it.minCoeff(&i);
-                T = trafo_it[i];
-                best_trafo = T;
+                best_trafo = trafo_it[i];
               }
               // if (debug) {
               //   save_matrix(cost_it, "/tmp/cost_after.txt");
@@ -224,11 +249,15 @@ namespace MR
 
           private:
             FORCE_INLINE ParamType get_parameters () {
+              return get_parameters (local_trafo, midway_image_header);
+            }
+
+            FORCE_INLINE ParamType get_parameters (Registration::Transform::Rigid& trafo, Header& midway_header) {
               // create resized midway image
               vector<Eigen::Transform<default_type, 3, Eigen::Projective>> init_transforms;
               {
-                Eigen::Transform<default_type, 3, Eigen::Projective> init_trafo_1 = local_trafo.get_transform_half_inverse();
-                Eigen::Transform<default_type, 3, Eigen::Projective> init_trafo_2 = local_trafo.get_transform_half();
+                Eigen::Transform<default_type, 3, Eigen::Projective> init_trafo_1 = trafo.get_transform_half_inverse();
+                Eigen::Transform<default_type, 3, Eigen::Projective> init_trafo_2 = trafo.get_transform_half();
                 init_transforms.push_back (init_trafo_1);
                 init_transforms.push_back (init_trafo_2);
               }
@@ -237,13 +266,13 @@ namespace MR
               vector<Header> headers;
               headers.push_back (Header (im1));
               headers.push_back (Header (im2));
-              midway_image_header = compute_minimum_average_header (headers, subsample, padding, init_transforms);
+              midway_header = compute_minimum_average_header (headers, subsample, padding, init_transforms);
 
-              Filter::Resize midway_resize_filter (midway_image_header);
+              Filter::Resize midway_resize_filter (midway_header);
               midway_resize_filter.set_scale_factor (image_scale_factor);
-              midway_resized_header = Header (midway_resize_filter);
+              Header midway_resized_header (midway_resize_filter);
 
-              ParamType parameters (local_trafo, im1, im2, midway_resized_header, mask1, mask2);
+              ParamType parameters (trafo, im1, im2, midway_resized_header, mask1, mask2);
               parameters.loop_density = 1.0;
               return parameters;
             }
@@ -311,7 +340,6 @@ namespace MR
             }
 
             Image<default_type> im1, im2, mask1, mask2, midway_image, midway_resized;
-            Header midway_resized_header;
             MetricType metric;
             Registration::Transform::Base& input_trafo;
             Registration::Transform::Init::LinearInitialisationParams& init_options;
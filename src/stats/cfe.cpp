@@ -74,8 +74,8 @@ namespace MR
         try {
           for (size_t i = 0; i < tract_fixel_indices.size(); i++) {
             for (size_t j = i + 1; j < tract_fixel_indices.size(); j++) {
-              connectivity_matrix[tract_fixel_indices[i]][tract_fixel_indices[j]].value++;
-              connectivity_matrix[tract_fixel_indices[j]][tract_fixel_indices[i]].value++;
+              add_connection (connectivity_matrix[tract_fixel_indices[i]], tract_fixel_indices[j]);
+              add_connection (connectivity_matrix[tract_fixel_indices[j]], tract_fixel_indices[i]);
             }
           }
           return true;
@@ -88,6 +88,19 @@ namespace MR
 
 
 
+      void TrackProcessor::add_connection (init_matrix_row_type& row, const index_type fixel_index)
+      {
+        const InitMatrixElement element (fixel_index);
+        const auto it = std::lower_bound (row.begin(), row.end(), element);
+        if (it == row.end() || fixel_index < it->index())
+          row.insert (it, element);
+        else
+          ++(*it);
+      }
+
+
+
+
 
 
 
@@ -44,11 +44,24 @@ namespace MR
       @{ */
 
 
-      class connectivity { NOMEMALIGN
+      // An element of the connectivity matrix as it is being built:
+      //   a fixel index and the number of streamlines connecting to it.
+      //   Each row is kept sorted by fixel index so that increments can use
+      //   a binary search; compared to a per-fixel std::map this stores the
+      //   same information in 8 bytes per entry rather than a heap node,
+      //   which is what permits whole-brain fixel templates to fit in RAM.
+      class InitMatrixElement { NOMEMALIGN
         public:
-          connectivity () : value (0.0) { }
-          connectivity (const connectivity_value_type v) : value (v) { }
-          connectivity_value_type value;
+          InitMatrixElement (const index_type fixel_index) :
+              fixel_index (fixel_index),
+              track_count (1) { }
+          FORCE_INLINE index_type index() const { return fixel_index; }
+          FORCE_INLINE uint32_t value() const { return track_count; }
+          FORCE_INLINE InitMatrixElement& operator++ () { track_count++; return *this; }
+          FORCE_INLINE bool operator< (const InitMatrixElement& that) const { return fixel_index < that.fixel_index; }
+        private:
+          index_type fixel_index;
+          uint32_t track_count;
       };
 
 
@@ -73,7 +86,8 @@ namespace MR
 
       // Different types are used depending on whether the connectivity matrix
       //   is in the process of being built, or whether it has been normalised
-      using init_connectivity_matrix_type = vector<std::map<index_type, connectivity>>;
+      using init_matrix_row_type = vector<InitMatrixElement>;
+      using init_connectivity_matrix_type = vector<init_matrix_row_type>;
       using norm_connectivity_matrix_type = vector<vector<NormMatrixElement>>;
 
 
@@ -94,6 +108,8 @@ namespace MR
           bool operator () (const SetVoxelDir& in);
 
         private:
+          void add_connection (init_matrix_row_type& row, const index_type fixel_index);
+
           Image<index_type> fixel_indexer;
           const vector<direction_type>& fixel_directions;
           Image<bool> fixel_mask;
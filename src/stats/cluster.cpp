@@ -15,6 +15,7 @@
 #include "stats/cluster.h"
 
 #include <algorithm>
+#include <numeric>
 
 namespace MR
 {
@@ -39,6 +40,105 @@ namespace MR
 
 
 
+
+      value_type ClusterSize::tfce_integrate (const value_type dH, const value_type E, const value_type H,
+                                              const vector_type& stats, vector_type& out) const
+      {
+        const size_t num_elements = stats.size();
+        out = vector_type::Zero (num_elements);
+
+        // the same sequence of thresholds as the generic implementation,
+        //   but swept from the top down
+        vector<value_type> thresholds;
+        const value_type max_stat = stats.maxCoeff();
+        for (value_type h = dH; (h-dH) < max_stat; h += dH)
+          thresholds.push_back (h);
+        if (thresholds.empty())
+          return 0.0;
+
+        // as the threshold sweeps downward, elements activate in order of
+        //   decreasing statistic and never deactivate, so the supra-threshold
+        //   clusters can be maintained incrementally using a union-find
+        //   forest rather than rebuilt at every threshold step
+        vector<uint32_t> order (num_elements);
+        std::iota (order.begin(), order.end(), 0);
+        std::sort (order.begin(), order.end(),
+                   [&stats] (const uint32_t a, const uint32_t b) { return stats[a] > stats[b]; });
+
+        const vector<vector<uint32_t> >& adjacency = connector.adjacent_indices;
+        assert (adjacency.size() == num_elements);
+
+        // no path compression is performed, so the forest encodes the full
+        //   merge history; the accumulated enhancement of each former root is
+        //   stored relative to that of the root it was merged beneath, which
+        //   keeps the sum along any element's path to the current root
+        //   invariant under merges
+        vector<uint32_t> parent (num_elements), csize (num_elements, 0);
+        vector<value_type> acc (num_elements, 0.0);
+        vector<bool> active (num_elements, false);
+        vector<uint32_t> roots;
+        auto find_root = [&parent] (uint32_t i) { while (parent[i] != i) i = parent[i]; return i; };
+
+        size_t next = 0;
+        for (size_t k = thresholds.size(); k != 0; --k) {
+          const value_type h = thresholds[k-1];
+
+          // activate elements above this threshold, merging with any
+          //   already-active neighbours (union by size, to bound the
+          //   depth of the forest)
+          while (next < num_elements && stats[order[next]] > h) {
+            const uint32_t i = order[next++];
+            parent[i] = i;
+            csize[i] = 1;
+            active[i] = true;
+            roots.push_back (i);
+            for (const uint32_t j : adjacency[i]) {
+              if (!active[j])
+                continue;
+              uint32_t ri = find_root (i);
+              uint32_t rj = find_root (j);
+              if (ri == rj)
+                continue;
+              if (csize[ri] < csize[rj])
+                std::swap (ri, rj);
+              acc[rj] -= acc[ri];
+              parent[rj] = ri;
+              csize[ri] += csize[rj];
+            }
+          }
+
+          // accumulate this threshold's contribution once per cluster,
+          //   rather than once per element
+          const value_type h_multiplier = std::pow (h, H);
+          size_t n = 0;
+          for (size_t r = 0; r != roots.size(); ++r) {
+            if (parent[roots[r]] != roots[r])
+              continue;   // merged beneath another root; drop from the list
+            acc[roots[r]] += std::pow (value_type (csize[roots[r]]), E) * h_multiplier;
+            roots[n++] = roots[r];
+          }
+          roots.resize (n);
+        }
+
+        // each element's enhancement is the sum of the accumulated values
+        //   along its path through the merge forest
+        value_type max_enhanced = 0.0;
+        for (size_t i = 0; i != num_elements; ++i) {
+          if (!active[i])
+            continue;
+          value_type sum = acc[i];
+          for (uint32_t n = i; parent[n] != n; ) {
+            n = parent[n];
+            sum += acc[n];
+          }
+          out[i] = sum;
+          max_enhanced = std::max (max_enhanced, sum);
+        }
+        return max_enhanced;
+      }
+
+
+
     }
   }
 }
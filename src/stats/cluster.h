@@ -49,6 +49,14 @@ namespace MR
 
           value_type operator() (const vector_type&, const value_type, vector_type&) const override;
 
+          //! incremental TFCE integration
+          /*! elements are sorted by statistic value once, and the
+           * supra-threshold clusters maintained via union-find as the
+           * threshold sweeps downward, instead of re-running the full
+           * connected-components analysis at every threshold step. */
+          value_type tfce_integrate (const value_type dH, const value_type E, const value_type H,
+                                     const vector_type&, vector_type&) const override;
+
 
         protected:
           const Filter::Connector& connector;
@@ -26,6 +26,7 @@ namespace MR
       PermutationStack::PermutationStack (const size_t num_permutations, const size_t num_samples, const std::string msg, const bool include_default) :
           num_permutations (num_permutations),
           counter (0),
+          end_index (num_permutations),
           progress (msg, num_permutations)
       {
         Math::Stats::Permutation::generate (num_permutations, num_samples, permutations, include_default);
@@ -35,13 +36,27 @@ namespace MR
           num_permutations (permutations.size()),
           permutations (permutations),
           counter (0),
+          end_index (permutations.size()),
           progress (msg, permutations.size()) { }
 
 
 
+      void PermutationStack::restore (const vector<vector<size_t> >& perms, const size_t completed)
+      {
+        assert (perms.size() == num_permutations);
+        assert (completed <= num_permutations);
+        permutations = perms;
+        while (counter < completed) {
+          ++counter;
+          ++progress;
+        }
+      }
+
+
+
       bool PermutationStack::operator() (Permutation& out)
       {
-        if (counter < num_permutations) {
+        if (counter < end_index) {
           out.index = counter;
           out.data = permutations[counter++];
           ++progress;
@@ -51,11 +51,25 @@ namespace MR
             return permutations[index];
           }
 
+          size_t num_subjects () const {
+            return permutations.size() ? permutations[0].size() : 0;
+          }
+
+          //! serve permutations only up to (but not including) index \a end;
+          //  permits processing the stack in segments, e.g. for checkpointing
+          void set_end (const size_t end) {
+            end_index = std::min (end, num_permutations);
+          }
+
+          //! replace the permutation set and completed count with state
+          //  loaded from a checkpoint file
+          void restore (const vector<vector<size_t> >& perms, const size_t completed);
+
           const size_t num_permutations;
 
         protected:
           vector< vector<size_t> > permutations;
-          size_t counter;
+          size_t counter, end_index;
           ProgressBar progress;
       };
 
@@ -12,6 +12,12 @@
  */
 
 
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+
+#include "file/ofstream.h"
+
 #include "stats/permtest.h"
 
 namespace MR
@@ -35,7 +41,13 @@ namespace MR
                                     "where each relabelling is defined as a column vector of size    m, and the number of columns, n, defines "
                                     "the number of permutations. Can be generated with the palm_quickperms function in PALM (http://fsl.fmrib.ox.ac.uk/fsl/fslwiki/PALM). "
                                     "Overrides the nperms option.")
-            + Argument ("file").type_file_in();
+            + Argument ("file").type_file_in()
+          + Option ("checkpoint", "periodically save the state of the permutation test to the specified file, "
+                                  "and resume from that file if it already exists. This allows long-running "
+                                  "permutation tests to survive interruption: the file stores the permutation set, "
+                                  "the null distribution values computed so far, and the uncorrected p-value counters, "
+                                  "and is updated every " + str(PERMTEST_CHECKPOINT_INTERVAL) + " permutations.")
+            + Argument ("file").type_text();
 
         if (include_nonstationarity) {
           result
@@ -56,6 +68,96 @@ namespace MR
 
 
 
+
+      void save_checkpoint (const std::string& filename,
+                            const PermutationStack& perm_stack,
+                            const size_t completed,
+                            const vector_type& perm_dist_pos,
+                            const std::shared_ptr<vector_type> perm_dist_neg,
+                            const vector<size_t>& uncorrected_count,
+                            const std::shared_ptr<vector<size_t>> uncorrected_count_neg)
+      {
+        const std::string tmp_filename = filename + ".tmp";
+        {
+          File::OFStream out (tmp_filename);
+          out.precision (std::numeric_limits<value_type>::max_digits10);
+          out << "mrtrix_permutation_checkpoint\n";
+          out << perm_stack.num_permutations << " " << perm_stack.num_subjects() << " "
+              << uncorrected_count.size() << " " << (perm_dist_neg ? 1 : 0) << "\n";
+          out << completed << "\n";
+          for (size_t p = 0; p != perm_stack.num_permutations; ++p) {
+            for (size_t i = 0; i != perm_stack.num_subjects(); ++i)
+              out << (i ? " " : "") << perm_stack[p][i];
+            out << "\n";
+          }
+          for (size_t p = 0; p != completed; ++p) {
+            out << perm_dist_pos[p];
+            if (perm_dist_neg)
+              out << " " << (*perm_dist_neg)[p];
+            out << "\n";
+          }
+          for (size_t i = 0; i != uncorrected_count.size(); ++i) {
+            out << uncorrected_count[i];
+            if (uncorrected_count_neg)
+              out << " " << (*uncorrected_count_neg)[i];
+            out << "\n";
+          }
+        }
+        if (std::rename (tmp_filename.c_str(), filename.c_str()))
+          throw Exception ("error renaming checkpoint file \"" + tmp_filename + "\" to \"" + filename + "\": " + strerror (errno));
+      }
+
+
+
+
+      size_t load_checkpoint (const std::string& filename,
+                              PermutationStack& perm_stack,
+                              vector_type& perm_dist_pos,
+                              std::shared_ptr<vector_type> perm_dist_neg,
+                              vector<size_t>& uncorrected_count,
+                              std::shared_ptr<vector<size_t>> uncorrected_count_neg)
+      {
+        std::ifstream in (filename.c_str());
+        if (!in)
+          throw Exception ("error opening checkpoint file \"" + filename + "\"");
+        std::string magic;
+        in >> magic;
+        if (magic != "mrtrix_permutation_checkpoint")
+          throw Exception ("file \"" + filename + "\" is not a permutation test checkpoint file");
+        size_t num_permutations (0), num_subjects (0), num_elements (0), completed (0);
+        int has_neg (0);
+        in >> num_permutations >> num_subjects >> num_elements >> has_neg >> completed;
+        if (!in ||
+            num_permutations != perm_stack.num_permutations ||
+            num_subjects != perm_stack.num_subjects() ||
+            num_elements != uncorrected_count.size() ||
+            bool(has_neg) != bool(perm_dist_neg) ||
+            completed > num_permutations)
+          throw Exception ("checkpoint file \"" + filename + "\" does not match the permutation test being performed");
+        vector<vector<size_t>> permutations (num_permutations, vector<size_t> (num_subjects));
+        for (size_t p = 0; p != num_permutations; ++p) {
+          for (size_t i = 0; i != num_subjects; ++i)
+            in >> permutations[p][i];
+        }
+        for (size_t p = 0; p != completed; ++p) {
+          in >> perm_dist_pos[p];
+          if (perm_dist_neg)
+            in >> (*perm_dist_neg)[p];
+        }
+        for (size_t i = 0; i != num_elements; ++i) {
+          in >> uncorrected_count[i];
+          if (uncorrected_count_neg)
+            in >> (*uncorrected_count_neg)[i];
+        }
+        if (!in)
+          throw Exception ("premature end of checkpoint file \"" + filename + "\"");
+        perm_stack.restore (permutations, completed);
+        CONSOLE ("resuming permutation test from checkpoint file \"" + filename + "\" (" + str(completed) + " of " + str(num_permutations) + " permutations already completed)");
+        return completed;
+      }
+
+
+
     }
   }
 }
@@ -22,6 +22,7 @@
 #include "progressbar.h"
 #include "thread.h"
 #include "thread_queue.h"
+#include "file/path.h"
 #include "math/math.h"
 #include "math/stats/permutation.h"
 #include "math/stats/typedefs.h"
@@ -33,6 +34,10 @@
 #define DEFAULT_NUMBER_PERMUTATIONS 5000
 #define DEFAULT_NUMBER_PERMUTATIONS_NONSTATIONARITY 5000
 
+// number of permutations processed between consecutive saves of the
+//   checkpoint file when the -checkpoint option is used
+#define PERMTEST_CHECKPOINT_INTERVAL 500
+
 
 namespace MR
 {
@@ -49,6 +54,30 @@ namespace MR
       const App::OptionGroup Options (const bool include_nonstationarity);
 
 
+      //! save the state of a partially-completed permutation test
+      /*! the file stores the permutation set, the per-permutation maximal
+       * statistics computed so far, and the uncorrected p-value counters;
+       * it is written to a temporary file and renamed into place so that an
+       * interruption mid-write cannot corrupt an existing checkpoint. */
+      void save_checkpoint (const std::string& filename,
+                            const PermutationStack& perm_stack,
+                            const size_t completed,
+                            const vector_type& perm_dist_pos,
+                            const std::shared_ptr<vector_type> perm_dist_neg,
+                            const vector<size_t>& uncorrected_count,
+                            const std::shared_ptr<vector<size_t>> uncorrected_count_neg);
+
+      //! restore the state of a permutation test from a checkpoint file
+      /*! returns the number of permutations already completed; throws if the
+       * file does not correspond to the test being performed. */
+      size_t load_checkpoint (const std::string& filename,
+                              PermutationStack& perm_stack,
+                              vector_type& perm_dist_pos,
+                              std::shared_ptr<vector_type> perm_dist_neg,
+                              vector<size_t>& uncorrected_count,
+                              std::shared_ptr<vector<size_t>> uncorrected_count_neg);
+
+
       /*! A class to pre-compute the empirical enhanced statistic image for non-stationarity correction */
       template <class StatsType>
         class PreProcessor { MEMALIGN (PreProcessor<StatsType>)
@@ -269,13 +298,35 @@ namespace MR
               if (perm_dist_neg)
                 global_uncorrected_pvalue_count_neg.reset (new vector<size_t> (stats_calculator.num_elements(), 0));
 
-              {
-                Processor<StatsType> processor (stats_calculator, enhancer,
-                                                empirical_enhanced_statistic,
-                                                default_enhanced_statistics, default_enhanced_statistics_neg,
-                                                perm_dist_pos, perm_dist_neg,
-                                                global_uncorrected_pvalue_count, global_uncorrected_pvalue_count_neg);
-                Thread::run_queue (perm_stack, Permutation(), Thread::multi (processor));
+              auto opt = App::get_options ("checkpoint");
+              const std::string checkpoint_file = opt.size() ? std::string (opt[0][0]) : std::string();
+              size_t completed = 0;
+              if (checkpoint_file.size() && Path::exists (checkpoint_file))
+                completed = load_checkpoint (checkpoint_file, perm_stack, perm_dist_pos, perm_dist_neg,
+                                             global_uncorrected_pvalue_count, global_uncorrected_pvalue_count_neg);
+
+              // when checkpointing, the stack is processed in segments; the
+              //   per-thread uncorrected p-value counters are merged into the
+              //   global counts when the processor copies go out of scope at
+              //   the end of each segment, so the saved state is complete up
+              //   to the last permutation served
+              while (completed < perm_stack.num_permutations) {
+                const size_t segment_end = checkpoint_file.size() ?
+                    std::min (completed + PERMTEST_CHECKPOINT_INTERVAL, perm_stack.num_permutations) :
+                    perm_stack.num_permutations;
+                perm_stack.set_end (segment_end);
+                {
+                  Processor<StatsType> processor (stats_calculator, enhancer,
+                                                  empirical_enhanced_statistic,
+                                                  default_enhanced_statistics, default_enhanced_statistics_neg,
+                                                  perm_dist_pos, perm_dist_neg,
+                                                  global_uncorrected_pvalue_count, global_uncorrected_pvalue_count_neg);
+                  Thread::run_queue (perm_stack, Permutation(), Thread::multi (processor));
+                }
+                completed = segment_end;
+                if (checkpoint_file.size() && completed < perm_stack.num_permutations)
+                  save_checkpoint (checkpoint_file, perm_stack, completed, perm_dist_pos, perm_dist_neg,
+                                   global_uncorrected_pvalue_count, global_uncorrected_pvalue_count_neg);
               }
 
               for (size_t i = 0; i < stats_calculator.num_elements(); ++i) {
@@ -41,13 +41,14 @@ namespace MR
 
 
 
-      value_type Wrapper::operator() (const vector_type& in, vector_type& out) const
+      value_type EnhancerBase::tfce_integrate (const value_type dH, const value_type E, const value_type H,
+                                               const vector_type& in, vector_type& out) const
       {
         out = vector_type::Zero (in.size());
         const value_type max_input_value = in.maxCoeff();
         for (value_type h = dH; (h-dH) < max_input_value; h += dH) {
           vector_type temp;
-          const value_type max = (*enhancer) (in, h, temp);
+          const value_type max = (*this) (in, h, temp);
           if (max) {
             const value_type h_multiplier = std::pow (h, H);
             for (size_t index = 0; index != size_t(in.size()); ++index)
@@ -59,6 +60,13 @@ namespace MR
 
 
 
+      value_type Wrapper::operator() (const vector_type& in, vector_type& out) const
+      {
+        return enhancer->tfce_integrate (dH, E, H, in, out);
+      }
+
+
+
     }
   }
 }
@@ -47,6 +47,14 @@ namespace MR
           //   makes TFCE integration cleaner
           virtual value_type operator() (const vector_type& /*input_statistics*/, const value_type /*threshold*/, vector_type& /*enhanced_statistics*/) const = 0;
 
+          //! perform the full TFCE integration over thresholds
+          /*! the default implementation evaluates the enhancer at each
+           * threshold step independently; derived classes may override this
+           * with an incremental implementation if the enhancement at
+           * successive thresholds can be computed more efficiently. */
+          virtual value_type tfce_integrate (const value_type dH, const value_type E, const value_type H,
+                                             const vector_type& input_statistics, vector_type& enhanced_statistics) const;
+
       };
 
 
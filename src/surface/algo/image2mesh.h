@@ -17,8 +17,10 @@
 
 #include <array>
 #include <map>
+#include <unordered_map>
 
 #include "image_helpers.h"
+#include "thread_queue.h"
 #include "transform.h"
 #include "types.h"
 
@@ -435,16 +437,44 @@ namespace MR
         {0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
         {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1} };
 
-      VertexList vertices;
-      TriangleList triangles;
-
       Transform transform (input_image);
 
-      ImageType voxel (input_image);
-      float in_vertex_values[8];
-      std::map< Vox, std::map<Vox, size_t> > input_vertex_pair_to_output_vertex_index_map;
-      Vox lower_corner;
-      for (lower_corner[2] = -1; lower_corner[2] != voxel.size(2); ++lower_corner[2]) {
+      // The two ends of any intersected cube edge are adjacent along precisely
+      //   one axis; keying each edge by the linear index of its lower end
+      //   within the one-voxel-padded grid together with that axis therefore
+      //   yields a unique integer per edge, allowing vertex de-duplication
+      //   through a single hash lookup rather than nested ordered maps
+      const uint64_t padded_dims[2] = { uint64_t(input_image.size(0)) + 2,
+                                        uint64_t(input_image.size(1)) + 2 };
+      auto edge_key = [&padded_dims] (const Vox& a, const Vox& b) -> uint64_t
+      {
+        const Vox base (std::min (a[0], b[0]), std::min (a[1], b[1]), std::min (a[2], b[2]));
+        const uint64_t axis = (a[0] != b[0]) ? 0 : ((a[1] != b[1]) ? 1 : 2);
+        return 3 * ((uint64_t(base[2]+1) * padded_dims[1] + uint64_t(base[1]+1)) * padded_dims[0] + uint64_t(base[0]+1)) + axis;
+      };
+
+      // Each XY layer of cube cells is processed independently; local vertex
+      //   indexing is converted to global indexing when the per-layer results
+      //   are concatenated in order afterwards, at which point vertices
+      //   generated on the edges shared between adjacent layers are merged
+      struct Slab { NOMEMALIGN
+        VertexList vertices;
+        vector<uint64_t> vertex_keys;
+        TriangleList triangles;
+      };
+      const size_t num_slabs = input_image.size(2) + 1;
+      vector<Slab> slabs (num_slabs);
+
+      auto loader = [&] (size_t& out) { static size_t i = 0; out = i++; return (out != num_slabs); };
+
+      auto worker = [&] (const size_t& slab_index)
+      {
+        ImageType voxel (input_image);
+        Slab& slab (slabs[slab_index]);
+        std::unordered_map<uint64_t, uint32_t> edge_to_local_vertex;
+        float in_vertex_values[8];
+        Vox lower_corner;
+        lower_corner[2] = ssize_t(slab_index) - 1;
         for (lower_corner[1] = -1; lower_corner[1] != voxel.size(1); ++lower_corner[1]) {
           for (lower_corner[0] = -1; lower_corner[0] != voxel.size(0); ++lower_corner[0]) {
 
@@ -481,27 +511,16 @@ namespace MR
                   vertex_positions[i] = lower_corner + neighbour_offsets[vertex_index];
                 }
                 // Has a vertex already been generated somewhere along this edge?
-                auto lookup_zero_it = input_vertex_pair_to_output_vertex_index_map.find (vertex_positions[0]);
-                if (lookup_zero_it == input_vertex_pair_to_output_vertex_index_map.end())
-                  lookup_zero_it = input_vertex_pair_to_output_vertex_index_map.insert (std::make_pair (vertex_positions[0], std::map<Vox, size_t>())).first;
-                auto lookup_one_it = input_vertex_pair_to_output_vertex_index_map.find (vertex_positions[1]);
-                if (lookup_one_it == input_vertex_pair_to_output_vertex_index_map.end())
-                  lookup_one_it = input_vertex_pair_to_output_vertex_index_map.insert (std::make_pair (vertex_positions[1], std::map<Vox, size_t>())).first;
-                auto& lookup_zero = lookup_zero_it->second;
-                auto& lookup_one  = lookup_one_it ->second;
-                auto existing_zero = lookup_zero.find (vertex_positions[1]);
-                if (existing_zero == lookup_zero.end()) {
-                  lookup_zero.insert (std::make_pair (vertex_positions[1], vertices.size()));
-                  lookup_one .insert (std::make_pair (vertex_positions[0], vertices.size()));
-                  edge_to_output_vertex[edge_index] = vertices.size();
+                auto existing = edge_to_local_vertex.insert (std::make_pair (edge_key (vertex_positions[0], vertex_positions[1]), uint32_t(slab.vertices.size())));
+                if (existing.second) {
                   // Calculate the precise position of this vertex, based on the
                   //   image intensities in the two relevant voxels
                   const default_type alpha = (threshold - in_vertex_values[vertex_indices[0]]) / (in_vertex_values[vertex_indices[1]] - in_vertex_values[vertex_indices[0]]);
                   const Vertex pos_voxelspace = vertex_positions[0].cast<default_type>() + (alpha * (vertex_positions[1] - vertex_positions[0]).cast<default_type>());
-                  vertices.push_back (transform.voxel2scanner * pos_voxelspace);
-                } else {
-                  edge_to_output_vertex[edge_index] = existing_zero->second;
+                  slab.vertices.push_back (transform.voxel2scanner * pos_voxelspace);
+                  slab.vertex_keys.push_back (existing.first->first);
                 }
+                edge_to_output_vertex[edge_index] = existing.first->second;
 
               }
             }
@@ -514,13 +533,36 @@ namespace MR
             //   to calculate the correct surface normals
             for (const int8_t* first_edge = cube_triangle_table[code]; *first_edge >= 0; first_edge += 3) {
               const uint32_t indices[3] { edge_to_output_vertex[*first_edge], edge_to_output_vertex[*(first_edge+2)], edge_to_output_vertex[*(first_edge+1)] };
-              triangles.push_back (Triangle (indices));
+              slab.triangles.push_back (Triangle (indices));
             }
 
-      } } } // Finished looping over all voxels in the input image
+        } } // Finished looping over one layer of cube cells
+        return true;
+      };
+
+      Thread::run_queue (loader, size_t(), Thread::multi (worker));
+
+      // Concatenate the per-layer results; since the layers were processed
+      //   and are merged in a fixed order, the output is deterministic
+      VertexList vertices;
+      TriangleList triangles;
+      std::unordered_map<uint64_t, uint32_t> edge_to_vertex;
+      for (const Slab& slab : slabs) {
+        vector<uint32_t> local_to_global (slab.vertices.size());
+        for (size_t i = 0; i != slab.vertices.size(); ++i) {
+          auto existing = edge_to_vertex.insert (std::make_pair (slab.vertex_keys[i], uint32_t(vertices.size())));
+          if (existing.second)
+            vertices.push_back (slab.vertices[i]);
+          local_to_global[i] = existing.first->second;
+        }
+        for (const Triangle& in : slab.triangles) {
+          const uint32_t indices[3] { local_to_global[in[0]], local_to_global[in[1]], local_to_global[in[2]] };
+          triangles.push_back (Triangle (indices));
+        }
+      }
 
       // Write the result to the output class
-      out.load (vertices, triangles);
+      out.load (std::move (vertices), std::move (triangles));
 
     }
 
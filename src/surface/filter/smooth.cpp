@@ -14,8 +14,12 @@
 
 #include "surface/filter/smooth.h"
 
+#include <algorithm>
+#include <map>
 #include <set>
+#include <utility>
 
+#include "thread_queue.h"
 #include "surface/utils.h"
 
 namespace MR
@@ -26,6 +30,36 @@ namespace MR
     {
 
 
+      namespace {
+
+        // Distribute an embarrassingly-parallel per-vertex computation
+        //   across threads, in blocks of vertices to keep the queue
+        //   overhead negligible
+        template <class Functor>
+        void parallel_for (const size_t num, Functor&& functor)
+        {
+          const size_t block_size = 1024;
+          size_t next = 0;
+          auto loader = [&] (std::pair<size_t, size_t>& out)
+          {
+            if (next == num)
+              return false;
+            out.first = next;
+            out.second = next = std::min (num, next + block_size);
+            return true;
+          };
+          auto worker = [&functor] (const std::pair<size_t, size_t>& in)
+          {
+            for (size_t i = in.first; i != in.second; ++i)
+              functor (i);
+            return true;
+          };
+          Thread::run_queue (loader, std::pair<size_t, size_t>(), Thread::multi (worker));
+        }
+
+      }
+
+
       void Smooth::operator() (const Mesh& in, Mesh& out) const
       {
         std::unique_ptr<ProgressBar> progress;
@@ -76,21 +110,36 @@ namespace MR
         // Now, we want to expand this selection outwards for each vertex
         // To do this, also want to produce a list for each polygon: containing those polygons
         //   that share a common edge (i.e. two vertices)
+        // Rather than testing all (T^2)/2 triangle pairs for a shared edge,
+        //   key each of the three vertex pairs of each triangle into a map;
+        //   triangles appearing under a common key are neighbours
         vector< vector<uint32_t> > poly_neighbours (T, vector<uint32_t>());
-        for (uint32_t i = 0; i != T; ++i) {
-          for (uint32_t j = i+1; j != T; ++j) {
-            if (in.triangles[i].shares_edge (in.triangles[j])) {
-              poly_neighbours[i].push_back (j);
-              poly_neighbours[j].push_back (i);
-
+        std::map< std::pair<uint32_t, uint32_t>, vector<uint32_t> > edge2poly;
+        for (uint32_t t = 0; t != T; ++t) {
+          for (uint32_t i = 0; i != 3; ++i) {
+            const uint32_t one ((in.triangles[t])[i]), two ((in.triangles[t])[(i+1)%3]);
+            edge2poly[std::minmax (one, two)].push_back (t);
+          }
+        }
+        for (const auto& edge : edge2poly) {
+          for (size_t i = 0; i != edge.second.size(); ++i) {
+            for (size_t j = i+1; j != edge.second.size(); ++j) {
+              const uint32_t one (edge.second[i]), two (edge.second[j]);
+              if (std::find (poly_neighbours[one].begin(), poly_neighbours[one].end(), two) == poly_neighbours[one].end()) {
+                poly_neighbours[one].push_back (two);
+                poly_neighbours[two].push_back (one);
+              }
             }
           }
         }
         if (progress) ++(*progress);
 
         // TODO Will want to develop a better heuristic for this
+        // Each vertex expands its own neighbourhood independently of all
+        //   others, so within each iteration the vertices can be
+        //   distributed across threads
         for (size_t iter = 0; iter != 8; ++iter) {
-          for (uint32_t v = 0; v != V; ++v) {
+          parallel_for (V, [&] (const size_t v) {
 
             // Find polygons at the outer edge of this expanding front, and add them to the neighbourhood for this vertex
             vector<uint32_t> next_front;
@@ -105,7 +154,7 @@ namespace MR
             }
             vert_polys_to_expand[v] = std::move (next_front);
 
-          }
+          });
         }
         if (progress) ++(*progress);
 
@@ -114,12 +163,12 @@ namespace MR
         // Need to perform a first mollification pass, where the polygon normals are
         //   smoothed but the vertices are not perturbed
         // However, in order to calculate these new normals, we need to calculate new vertex positions!
-        VertexList mollified_vertices;
+        VertexList mollified_vertices (V);
         // Use half standard spatial factor for mollification
         // Denominator = 2(SF/2)^2
         const default_type spatial_mollification_power_multiplier = -2.0 / Math::pow2 (spatial);
         // No need to normalise the Gaussian; have to explicitly normalise afterwards
-        for (uint32_t v = 0; v != V; ++v) {
+        parallel_for (V, [&] (const size_t v) {
 
           Vertex new_pos (0.0, 0.0, 0.0);
           default_type sum_weights = 0.0;
@@ -138,9 +187,9 @@ namespace MR
           }
 
           new_pos *= (1.0 / sum_weights);
-          mollified_vertices.push_back (new_pos);
+          mollified_vertices[v] = new_pos;
 
-        }
+        });
         if (progress) ++(*progress);
 
         // Have new vertices; compute polygon normals based on these vertices
@@ -154,7 +203,8 @@ namespace MR
         // Now perform the actual smoothing
         const default_type spatial_power_multiplier = -0.5 / Math::pow2 (spatial);
         const default_type influence_power_multiplier = -0.5 / Math::pow2 (influence);
-        for (size_t v = 0; v != V; ++v) {
+        out.vertices.resize (V);
+        parallel_for (V, [&] (const size_t v) {
 
           Vertex new_pos (0.0, 0.0, 0.0);
           default_type sum_weights = 0.0;
@@ -173,9 +223,9 @@ namespace MR
           }
 
           new_pos *= (1.0 / sum_weights);
-          out.vertices.push_back (new_pos);
+          out.vertices[v] = new_pos;
 
-        }
+        });
         if (progress) ++(*progress);
 
         out.triangles = in.triangles;
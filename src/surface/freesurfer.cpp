@@ -32,20 +32,19 @@ namespace MR
           throw Exception ("Error opening input file!");
 
         const int32_t num_vertices = get_BE<int32_t> (in);
-        vector<int32_t> vertices, vertex_labels;
-        vertices.reserve (num_vertices);
-        vertex_labels.reserve (num_vertices);
-        for (int32_t i = 0; i != num_vertices; ++i) {
-          vertices.push_back (get_BE<int32_t> (in));
-          vertex_labels.push_back (get_BE<int32_t> (in));
-        }
+        // (vertex index, label) pairs are stored interleaved; read the whole
+        //   block in one call rather than element by element
+        vector<int32_t> vertex_data (2 * size_t (num_vertices));
+        get_BE_array (in, vertex_data.data(), vertex_data.size());
+        if (!in.good())
+          throw Exception ("Error reading FreeSurfer annotation file \"" + Path::basename (path) + "\": Truncated vertex data");
 
         const int32_t colortable_present = get_BE<int32_t> (in);
         if (!in.good()) {
           WARN ("FreeSurfer annotation file \"" + Path::basename (path) + "\" does not contain colortable information");
           labels = label_vector_type::Zero (num_vertices);
-          for (size_t i = 0; i != vertices.size(); ++i)
-            labels[vertices[i]] = vertex_labels[i];
+          for (int32_t i = 0; i != num_vertices; ++i)
+            labels[vertex_data[2*i]] = vertex_data[2*i+1];
           return;
         }
         if (!colortable_present)
@@ -106,8 +105,8 @@ namespace MR
         }
 
         labels = label_vector_type::Zero (num_vertices);
-        for (size_t i = 0; i != vertices.size(); ++i)
-          labels[vertices[i]] = rgb2index[vertex_labels[i]];
+        for (int32_t i = 0; i != num_vertices; ++i)
+          labels[vertex_data[2*i]] = rgb2index[vertex_data[2*i+1]];
       }
 
 
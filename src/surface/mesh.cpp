@@ -14,10 +14,12 @@
 
 #include "surface/mesh.h"
 
+#include <cstring>
 #include <ios>
 #include <iostream>
 #include <string>
 
+#include "raw.h"
 #include "types.h"
 
 #include "surface/freesurfer.h"
@@ -164,25 +166,29 @@ namespace MR
               throw Exception ("Error in reading binary .vtk file: Unsupported datatype (\"" + line + "\"");
 
             vertices.reserve (num_vertices);
-            for (int i = 0; i != num_vertices; ++i) {
-
-              Vertex v;
-              if (is_ascii) {
+            if (is_ascii) {
+              for (int i = 0; i != num_vertices; ++i) {
                 std::getline (in, line);
+                Vertex v;
                 sscanf (line.c_str(), "%lf %lf %lf", &v[0], &v[1], &v[2]);
+                vertices.push_back (v);
+              }
+            } else {
+              // Read the whole block with a single call, then convert in memory
+              const size_t bytes_per_vertex = 3 * (is_double ? sizeof (double) : sizeof (float));
+              vector<char> buffer (num_vertices * bytes_per_vertex);
+              in.read (buffer.data(), buffer.size());
+              if (!in.good())
+                throw Exception ("Error in reading binary .vtk file: truncated POINTS data");
+              if (is_double) {
+                const double* data = reinterpret_cast<const double*> (buffer.data());
+                for (int i = 0; i != num_vertices; ++i, data += 3)
+                  vertices.push_back (Vertex (data[0], data[1], data[2]));
               } else {
-                if (is_double) {
-                  double data[3];
-                  in.read (reinterpret_cast<char*>(&data[0]), 3 * sizeof (double));
-                  v = { data[0], data[1], data[2] };
-                } else {
-                  float data[3];
-                  in.read (reinterpret_cast<char*>(&data[0]), 3 * sizeof (float));
-                  v = { data[0], data[1], data[2] };
-                }
+                const float* data = reinterpret_cast<const float*> (buffer.data());
+                for (int i = 0; i != num_vertices; ++i, data += 3)
+                  vertices.push_back (Vertex (data[0], data[1], data[2]));
               }
-              vertices.push_back (v);
-
             }
 
           } else if (line.substr (0, 8) == "POLYGONS") {
@@ -194,36 +200,59 @@ namespace MR
             const int num_elements = to<int> (line);
 
             int polygon_count = 0, element_count = 0;
-            while (polygon_count < num_polygons && element_count < num_elements) {
+            if (is_ascii) {
 
-              int vertex_count;
-              if (is_ascii) {
+              while (polygon_count < num_polygons && element_count < num_elements) {
+
+                int vertex_count;
                 std::getline (in, line);
                 sscanf (line.c_str(), "%u", &vertex_count);
-              } else {
-                in.read (reinterpret_cast<char*>(&vertex_count), sizeof (int));
-              }
 
-              if (vertex_count != 3 && vertex_count != 4)
-                throw Exception ("Could not parse file \"" + path + "\";  only suppport 3- and 4-vertex polygons");
+                if (vertex_count != 3 && vertex_count != 4)
+                  throw Exception ("Could not parse file \"" + path + "\";  only suppport 3- and 4-vertex polygons");
 
-              vector<unsigned int> t (vertex_count, 0);
+                vector<unsigned int> t (vertex_count, 0);
 
-              if (is_ascii) {
                 for (int index = 0; index != vertex_count; ++index) {
                   line = line.substr (line.find (' ') + 1); // Strip the previous value
                   sscanf (line.c_str(), "%u", &t[index]);
                 }
-              } else {
-                for (int index = 0; index != vertex_count; ++index)
-                  in.read (reinterpret_cast<char*>(&t[index]), sizeof (int));
+                if (vertex_count == 3)
+                  triangles.push_back (Polygon<3>(t));
+                else
+                  quads.push_back (Polygon<4>(t));
+                ++polygon_count;
+                element_count += 1 + vertex_count;
+
+              }
+
+            } else {
+
+              // Read the whole element block with a single call, then walk it in memory
+              vector<int> elements (num_elements);
+              in.read (reinterpret_cast<char*>(elements.data()), num_elements * sizeof (int));
+              if (!in.good())
+                throw Exception ("Error in reading binary .vtk file: truncated POLYGONS data");
+              triangles.reserve (triangles.size() + num_polygons);
+
+              while (polygon_count < num_polygons && element_count < num_elements) {
+
+                const int vertex_count = elements[element_count++];
+
+                if (vertex_count != 3 && vertex_count != 4)
+                  throw Exception ("Could not parse file \"" + path + "\";  only suppport 3- and 4-vertex polygons");
+                if (element_count + vertex_count > num_elements)
+                  break;
+
+                const vector<unsigned int> t (elements.begin() + element_count, elements.begin() + element_count + vertex_count);
+                element_count += vertex_count;
+                if (vertex_count == 3)
+                  triangles.push_back (Polygon<3>(t));
+                else
+                  quads.push_back (Polygon<4>(t));
+                ++polygon_count;
+
               }
-              if (vertex_count == 3)
-                triangles.push_back (Polygon<3>(t));
-              else
-                quads.push_back (Polygon<4>(t));
-              ++polygon_count;
-              element_count += 1 + vertex_count;
 
             }
             if (polygon_count != num_polygons || element_count != num_elements)
@@ -271,18 +300,38 @@ namespace MR
         uint32_t count;
         in.read (reinterpret_cast<char*>(&count), sizeof(uint32_t));
 
-        uint16_t attribute_byte_count;
         bool warn_attribute = false;
 
-        Eigen::Vector3f vertex, normal;
+        // Read all facet records with a single call, then parse in memory;
+        //   each record is 12 floats (normal and three vertices) followed by
+        //   a two-byte attribute count
+        static const size_t bytes_per_facet = 12 * sizeof (float) + sizeof (uint16_t);
+        const std::streampos data_start = in.tellg();
+        in.seekg (0, std::ios_base::end);
+        const size_t data_bytes = in.tellg() - data_start;
+        in.seekg (data_start);
+        if (data_bytes % bytes_per_facet)
+          throw Exception ("Error in parsing STL file");
+        const size_t num_facets = data_bytes / bytes_per_facet;
+        vector<char> buffer (data_bytes);
+        if (data_bytes) {
+          in.read (buffer.data(), data_bytes);
+          if (!in.good())
+            throw Exception ("Error in parsing STL file");
+        }
 
-        while (in.read (reinterpret_cast<char*>(normal.data()), 3 * sizeof(float))) {
+        vertices.reserve (3 * num_facets);
+        triangles.reserve (num_facets);
+        Eigen::Vector3f vertex, normal;
+        const char* record = buffer.data();
+        for (size_t facet = 0; facet != num_facets; ++facet, record += bytes_per_facet) {
+          memcpy (normal.data(), record, 3 * sizeof(float));
           for (size_t index = 0; index != 3; ++index) {
-            if (!in.read (reinterpret_cast<char*>(vertex.data()), 3 * sizeof(float)))
-              throw Exception ("Error in parsing STL file");
+            memcpy (vertex.data(), record + (3 + 3*index) * sizeof(float), 3 * sizeof(float));
             vertices.push_back (vertex.cast<default_type>());
           }
-          in.read (reinterpret_cast<char*>(&attribute_byte_count), sizeof(uint16_t));
+          uint16_t attribute_byte_count;
+          memcpy (&attribute_byte_count, record + 12 * sizeof(float), sizeof(uint16_t));
           if (attribute_byte_count)
             warn_attribute = true;
 
@@ -516,39 +565,46 @@ namespace MR
         }
         const int32_t num_vertices = FreeSurfer::get_BE<int32_t> (in);
         const int32_t num_polygons = FreeSurfer::get_BE<int32_t> (in);
+        // Read each block with a single call, converting from big-endian
+        //   within the memory buffer afterwards
+        vector<float> vertex_data (size_t(num_vertices) * 3);
+        FreeSurfer::get_BE_array (in, vertex_data.data(), vertex_data.size());
+        if (!in.good())
+          throw Exception ("Error reading FreeSurfer file: EOF reached");
         vertices.reserve (num_vertices);
-        for (int32_t i = 0; i != num_vertices; ++i) {
-          float temp[3];
-          for (size_t axis = 0; axis != 3; ++axis)
-            temp[axis] = FreeSurfer::get_BE<float> (in);
-          vertices.push_back (Vertex (temp[0], temp[1], temp[2]));
-        }
+        for (int32_t i = 0; i != num_vertices; ++i)
+          vertices.push_back (Vertex (vertex_data[3*i], vertex_data[3*i+1], vertex_data[3*i+2]));
+        vector<int32_t> polygon_data (size_t(num_polygons) * 3);
+        FreeSurfer::get_BE_array (in, polygon_data.data(), polygon_data.size());
         if (!in.good())
           throw Exception ("Error reading FreeSurfer file: EOF reached");
+        triangles.reserve (num_polygons);
         for (int32_t i = 0; i != num_polygons; ++i) {
-          std::array<int32_t, 3> temp;
-          for (size_t v = 0; v != 3; ++v)
-            temp[v] = FreeSurfer::get_BE<int32_t> (in);
+          const std::array<int32_t, 3> temp { { polygon_data[3*i], polygon_data[3*i+1], polygon_data[3*i+2] } };
           triangles.push_back (Triangle (temp));
         }
-        if (!in.good())
-          throw Exception ("Error reading FreeSurfer file: EOF reached");
 
       } else if (magic_number == FreeSurfer::quad_file_magic_number) {
 
         const int32_t num_vertices = FreeSurfer::get_int24_BE (in);
         const int32_t num_polygons = FreeSurfer::get_int24_BE (in);
+        vector<int16_t> vertex_data (size_t(num_vertices) * 3);
+        FreeSurfer::get_BE_array (in, vertex_data.data(), vertex_data.size());
+        if (!in.good())
+          throw Exception ("Error reading FreeSurfer file: EOF reached");
         vertices.reserve (num_vertices);
-        for (int32_t i = 0; i != num_vertices; ++i) {
-          int16_t temp[3];
-          for (size_t axis = 0; axis != 3; ++axis)
-            temp[axis] = FreeSurfer::get_BE<int16_t> (in);
-          vertices.push_back (Vertex (0.01 * temp[0], 0.01 * temp[1], 0.01 * temp[2]));
-        }
+        for (int32_t i = 0; i != num_vertices; ++i)
+          vertices.push_back (Vertex (0.01 * vertex_data[3*i], 0.01 * vertex_data[3*i+1], 0.01 * vertex_data[3*i+2]));
+        // quad vertex indices are stored as packed 24-bit integers
+        vector<uint8_t> polygon_data (size_t(num_polygons) * 4 * 3);
+        in.read (reinterpret_cast<char*> (polygon_data.data()), polygon_data.size());
+        if (!in.good())
+          throw Exception ("Error reading FreeSurfer file: EOF reached");
+        quads.reserve (num_polygons);
         for (int32_t i = 0; i != num_polygons; ++i) {
           std::array<int32_t, 4> temp;
           for (size_t v = 0; v != 4; ++v)
-            temp[v] = FreeSurfer::get_int24_BE (in);
+            temp[v] = FreeSurfer::fetch_int24_BE (polygon_data.data() + 12*i + 3*v);
           quads.push_back (Quad (temp));
         }
 
@@ -586,41 +642,43 @@ namespace MR
         const std::string str_datatype = is_double ? "double" : "float";
         const std::string points_header ("POINTS " + str(vertices.size()) + " " + str_datatype + "\n");
         out.write (points_header.c_str(), points_header.size());
-        for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i) {
-          //float temp[3];
-          //for (size_t id = 0; id != 3; ++id)
-          //  MR::putBE ((*i)[id], &temp[id]);
-          if (is_double) {
-            const double temp[3] { double((*i)[0]), double((*i)[1]), double((*i)[2]) };
-            out.write (reinterpret_cast<const char*>(temp), 3 * sizeof(double));
-          } else {
-            const float temp[3] { float((*i)[0]), float((*i)[1]), float((*i)[2]) };
-            out.write (reinterpret_cast<const char*>(temp), 3 * sizeof(float));
+        // Assemble each block in memory and commit it with a single write
+        if (is_double) {
+          vector<double> buffer;
+          buffer.reserve (3 * vertices.size());
+          for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i) {
+            for (size_t id = 0; id != 3; ++id)
+              buffer.push_back (double((*i)[id]));
+            ++progress;
           }
-          ++progress;
+          out.write (reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(double));
+        } else {
+          vector<float> buffer;
+          buffer.reserve (3 * vertices.size());
+          for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i) {
+            for (size_t id = 0; id != 3; ++id)
+              buffer.push_back (float((*i)[id]));
+            ++progress;
+          }
+          out.write (reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(float));
         }
         const std::string polygons_header ("POLYGONS " + str(triangles.size() + quads.size()) + " " + str(4*triangles.size() + 5*quads.size()) + "\n");
         out.write (polygons_header.c_str(), polygons_header.size());
-        const uint32_t num_points_triangle = 3;
+        vector<uint32_t> buffer;
+        buffer.reserve (4*triangles.size() + 5*quads.size());
         for (TriangleList::const_iterator i = triangles.begin(); i != triangles.end(); ++i) {
-          out.write (reinterpret_cast<const char*>(&num_points_triangle), sizeof(uint32_t));
-          //uint32_t temp[3];
-          //for (size_t id = 0; id != 3; ++id)
-          //  MR::putBE ((*i)[id], &temp[id]);
-          const uint32_t temp[3] { (*i)[0], (*i)[1], (*i)[2] };
-          out.write (reinterpret_cast<const char*>(temp), 3 * sizeof(uint32_t));
+          buffer.push_back (3);
+          for (size_t id = 0; id != 3; ++id)
+            buffer.push_back ((*i)[id]);
           ++progress;
         }
-        const uint32_t num_points_quad = 4;
         for (QuadList::const_iterator i = quads.begin(); i != quads.end(); ++i) {
-          out.write (reinterpret_cast<const char*>(&num_points_quad), sizeof(uint32_t));
-          //uint32_t temp[4];
-          //for (size_t id = 0; id != 4; ++id)
-          //  MR::putBE ((*i)[id], &temp[id]);
-          const uint32_t temp[4] { (*i)[0], (*i)[1], (*i)[2], (*i)[3] };
-          out.write (reinterpret_cast<const char*>(temp), 4 * sizeof(uint32_t));
+          buffer.push_back (4);
+          for (size_t id = 0; id != 4; ++id)
+            buffer.push_back ((*i)[id]);
           ++progress;
         }
+        out.write (reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(uint32_t));
 
       } else {
 
@@ -660,19 +718,23 @@ namespace MR
         out.write (header, 80);
         const uint32_t count = triangles.size();
         out.write (reinterpret_cast<const char*>(&count), sizeof(uint32_t));
-        const uint16_t attribute_byte_count = 0;
-        for (TriangleList::const_iterator i = triangles.begin(); i != triangles.end(); ++i) {
+        // Assemble all facet records in memory and commit them with a single
+        //   write; attribute byte counts remain zero-filled
+        static const size_t bytes_per_facet = 12 * sizeof(float) + sizeof(uint16_t);
+        vector<char> buffer (triangles.size() * bytes_per_facet, char(0));
+        char* record = buffer.data();
+        for (TriangleList::const_iterator i = triangles.begin(); i != triangles.end(); ++i, record += bytes_per_facet) {
           const Eigen::Vector3 n (normal (*this, *i));
           const float n_temp[3] { float(n[0]), float(n[1]), float(n[2]) };
-          out.write (reinterpret_cast<const char*>(&n_temp[0]), 3 * sizeof(float));
+          memcpy (record, n_temp, 3 * sizeof(float));
           for (size_t v = 0; v != 3; ++v) {
             const Vertex& p (vertices[(*i)[v]]);
             const float p_temp[3] { float(p[0]), float(p[1]), float(p[2]) };
-            out.write (reinterpret_cast<const char*>(&p_temp[0]), 3 * sizeof(float));
+            memcpy (record + (3 + 3*v) * sizeof(float), p_temp, 3 * sizeof(float));
           }
-          out.write (reinterpret_cast<const char*>(&attribute_byte_count), sizeof(uint16_t));
           ++progress;
         }
+        out.write (buffer.data(), buffer.size());
 
       } else {
 
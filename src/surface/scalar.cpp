@@ -68,13 +68,18 @@ namespace MR
       FreeSurfer::get_BE<int16_t> (in); // 'latency'
       const int32_t num_entries = FreeSurfer::get_int24_BE (in);
       Base::operator= (Base::Zero (num_entries));
+      // each entry is a packed 24-bit vertex index followed by a float value;
+      //   read the whole block in one call and decode from memory
+      vector<uint8_t> buffer (size_t(num_entries) * 7);
+      in.read (reinterpret_cast<char*> (buffer.data()), buffer.size());
+      if (!in.good())
+        throw Exception ("Error opening file \"" + path + "\" as FreeSurfer w-file: truncated file");
       for (int32_t i = 0; i != num_entries; ++i) {
-        const int32_t index = FreeSurfer::get_int24_BE (in);
-        const float value = FreeSurfer::get_BE<float> (in);
+        const uint8_t* const entry = buffer.data() + 7*i;
+        const int32_t index = FreeSurfer::fetch_int24_BE (entry);
+        const float value = Raw::fetch_BE<float> (entry + 3);
         if (size_t(index) >= mesh.num_vertices())
           throw Exception ("Error opening file \"" + path + "\" as FreeSurfer w-file: invalid vertex index (" + str(index) + ", mesh has " + str(mesh.num_vertices()) + ")");
-        if (!in.good())
-          throw Exception ("Error opening file \"" + path + "\" as FreeSurfer w-file: truncated file");
         (*this)[index] = value;
       }
     }
@@ -102,9 +107,11 @@ namespace MR
         if (vals_per_vertex != 1)
           throw Exception ("Error opening file \"" + path + "\" as Freesurfer curv file: Only support 1 value per vertex");
 
+        vector<float> data (num_vertices);
+        FreeSurfer::get_BE_array (in, data.data(), data.size());
         (*this).resize (num_vertices);
         for (int32_t i = 0; i != num_vertices; ++i)
-          (*this)[i] = FreeSurfer::get_BE<float> (in);
+          (*this)[i] = data[i];
 
       } else {
 
@@ -116,9 +123,11 @@ namespace MR
         if (size_t(num_faces) != mesh.num_polygons())
           throw Exception ("Error opening file \"" + path + "\" as Freesurfer curv file: Incorrect number of polygons (" + str(num_faces) + ", mesh has " + str(mesh.num_polygons()) + ")");
 
+        vector<int16_t> data (num_vertices);
+        FreeSurfer::get_BE_array (in, data.data(), data.size());
         (*this).resize (mesh.num_vertices());
         for (int32_t i = 0; i != num_vertices; ++i)
-          (*this)[i] = 0.01 * FreeSurfer::get_BE<int16_t> (in);
+          (*this)[i] = 0.01 * data[i];
 
       }
 